@@ -177,6 +177,8 @@ void Agent::handleAudioPacket(QSharedPointer<ReceivedMessage> message) {
 }
 
 static const QString AGENT_LOGGING_NAME = "agent";
+// the number of the busiest script functions in the stats
+static const int NUM_SCRIPT_PROFILE_STATS = 10;
 
 void Agent::run() {
     // Create ScriptEngines on threaded-assignment thread then move to main thread.
@@ -834,6 +836,14 @@ void Agent::processAgentAvatarAudio() {
     }
 }
 
+void Agent::sendStatsPacket() {
+    QJsonObject statsObject;
+    if (_scriptEngine) {
+        statsObject["script_profile"] = _scriptEngine->getProfilerStats(NUM_SCRIPT_PROFILE_STATS);
+    }
+    addPacketStatsAndSendStatsPacket(statsObject);
+}
+
 void Agent::aboutToFinish() {
     // our entity tree is going to go away so tell that to the EntityScriptingInterface
     DependencyManager::get<EntityScriptingInterface>()->setEntityTree(nullptr);
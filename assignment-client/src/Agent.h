@@ -69,6 +69,8 @@ public slots:
 
     Q_INVOKABLE virtual void stop() override;
 
+    void sendStatsPacket() override;
+
 private slots:
     void requestScript();
     void scriptRequestFinished();
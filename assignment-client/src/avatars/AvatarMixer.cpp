@@ -767,6 +767,7 @@ void AvatarMixer::sendStatsPacket() {
     statsObject["threads"] = _slavePool.numThreads();
     statsObject["trailing_mix_ratio"] = _trailingMixRatio;
     statsObject["throttling_ratio"] = _throttlingRatio;
+    statsObject["trait_blob_cache"] = _slaveSharedData.traitBlobCache->getStatsJSON();
 
 #ifdef DEBUG_EVENT_QUEUE
     QJsonObject qtStats;
@@ -233,6 +233,8 @@ void AvatarMixerClientData::processSetTraitsMessage(ReceivedMessage& message,
                     // Deferred for UX work. With no PoP check, no need to get the .fst.
                     _avatar->fetchAvatarFST();
                 }
+                // packed once here, after any replacement above, rather than for every listener
+                _avatar->setTraitBlob(traitType, slaveSharedData.traitBlobCache->insert(_avatar->packTrait(traitType)));
 
                 anyTraitsChanged = true;
             } else {
@@ -262,6 +264,7 @@ void AvatarMixerClientData::processSetTraitsMessage(ReceivedMessage& message,
                 if (packetTraitVersion > instanceVersionRef) {
                     if (traitSize == AvatarTraits::DELETED_TRAIT_SIZE) {
                         _avatar->processDeletedTraitInstance(traitType, instanceID);
+                        _avatar->setTraitInstanceBlob(traitType, instanceID, TraitBlobCache::BlobPointer());
                         // Mixer doesn't need deleted IDs.
                         _avatar->getAndClearRecentlyRemovedIDs();
 
@@ -274,6 +277,7 @@ void AvatarMixerClientData::processSetTraitsMessage(ReceivedMessage& message,
                         auto trait = message.read(traitSize);
                         if (sendingNode.getCanRezAvatarEntities()) {
                             _avatar->processTraitInstance(traitType, instanceID, trait);
+                            _avatar->setTraitInstanceBlob(traitType, instanceID, slaveSharedData.traitBlobCache->insert(trait));
                         }
                         
                         instanceVersionRef = packetTraitVersion;
@@ -305,6 +309,7 @@ void AvatarMixerClientData::emulateDeleteEntitiesTraitsMessage(const QList<QUuid
         auto& instanceVersionRef = _lastReceivedTraitVersions.getInstanceValueRef(traitType, entityID);
 
         _avatar->processDeletedTraitInstance(traitType, entityID);
+        _avatar->setTraitInstanceBlob(traitType, entityID, TraitBlobCache::BlobPointer());
         // Mixer doesn't need deleted IDs.
         _avatar->getAndClearRecentlyRemovedIDs();
 
@@ -141,8 +141,14 @@ qint64 AvatarMixerSlave::addChangedTraitsToBulkPacket(AvatarMixerClientData* lis
                 if (lastReceivedVersion > lastSentVersionRef) {
                     bytesWritten += addTraitsNodeHeader(listeningNodeData, sendingNodeData, traitsPacketList, bytesWritten);
                     // there is an update to this trait, add it to the traits packet
-                    bytesWritten += AvatarTraits::packVersionedTrait(traitType, traitsPacketList,
-                                                                     lastReceivedVersion, *sendingAvatar);
+                    auto traitBlob = sendingAvatar->getTraitBlob(traitType);
+                    if (traitBlob) {
+                        bytesWritten += AvatarTraits::packVersionedTraitData(traitType, traitsPacketList,
+                                                                             lastReceivedVersion, traitBlob->data);
+                    } else {
+                        bytesWritten += AvatarTraits::packVersionedTrait(traitType, traitsPacketList,
+                                                                         lastReceivedVersion, *sendingAvatar);
+                    }
                     // update the last sent version
                     lastSentVersionRef = lastReceivedVersion;
                     // Remember which versions we sent in this particular packet
@@ -197,8 +203,14 @@ qint64 AvatarMixerSlave::addChangedTraitsToBulkPacket(AvatarMixerClientData* lis
                     bytesWritten += addTraitsNodeHeader(listeningNodeData, sendingNodeData, traitsPacketList, bytesWritten);
 
                     // this instance version exists and has never been sent or is newer so we need to send it
-                    bytesWritten += AvatarTraits::packVersionedTraitInstance(traitType, instanceID, traitsPacketList,
-                                                                             receivedVersion, *sendingAvatar);
+                    auto traitBlob = sendingAvatar->getTraitInstanceBlob(traitType, instanceID);
+                    if (traitBlob) {
+                        bytesWritten += AvatarTraits::packVersionedTraitInstanceData(traitType, instanceID, traitsPacketList,
+                                                                                     receivedVersion, traitBlob->data);
+                    } else {
+                        bytesWritten += AvatarTraits::packVersionedTraitInstance(traitType, instanceID, traitsPacketList,
+                                                                                 receivedVersion, *sendingAvatar);
+                    }
 
                     if (sentInstanceIt != sentIDValuePairs.end()) {
                         sentInstanceIt->value = receivedVersion;
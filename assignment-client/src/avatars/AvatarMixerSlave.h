@@ -14,6 +14,8 @@
 
 #include <NodeList.h>
 
+#include "TraitBlobCache.h"
+
 class AvatarMixerClientData;
 
 class AvatarMixerSlaveStats {
@@ -100,6 +102,7 @@ struct SlaveSharedData {
     QStringList skeletonURLWhitelist;
     QUrl skeletonReplacementURL;
     EntityTreePointer entityTree;
+    std::shared_ptr<TraitBlobCache> traitBlobCache { std::make_shared<TraitBlobCache>() };
 };
 
 class AvatarMixerSlave {
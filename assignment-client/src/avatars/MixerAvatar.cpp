@@ -38,6 +38,23 @@ MixerAvatar::MixerAvatar() {
     connect(this, &MixerAvatar::startChallengeTimer, &_challengeTimer, static_cast<void(QTimer::*)()>(&QTimer::start));
 }
 
+TraitBlobCache::BlobPointer MixerAvatar::getTraitInstanceBlob(AvatarTraits::TraitType traitType,
+                                                             AvatarTraits::TraitInstanceID instanceID) const {
+    const auto& blobs = _traitInstanceBlobs[traitType - AvatarTraits::FirstInstancedTrait];
+    auto it = blobs.find(instanceID);
+    return it != blobs.end() ? it.value() : TraitBlobCache::BlobPointer();
+}
+
+void MixerAvatar::setTraitInstanceBlob(AvatarTraits::TraitType traitType, AvatarTraits::TraitInstanceID instanceID,
+                                       TraitBlobCache::BlobPointer blob) {
+    auto& blobs = _traitInstanceBlobs[traitType - AvatarTraits::FirstInstancedTrait];
+    if (blob) {
+        blobs[instanceID] = blob;
+    } else {
+        blobs.remove(instanceID);
+    }
+}
+
 const char* MixerAvatar::stateToName(VerifyState state) {
     return QMetaEnum::fromType<VerifyState>().valueToKey(state);
 }
@@ -14,8 +14,12 @@
 #ifndef hifi_MixerAvatar_h
 #define hifi_MixerAvatar_h
 
+#include <array>
+
 #include <AvatarData.h>
 
+#include "TraitBlobCache.h"
+
 class ResourceRequest;
 
 class MixerAvatar : public AvatarData {
@@ -48,6 +52,15 @@ public:
     const QUuid& getScreenshareZone() const { return _screenshareZone; }
     void setScreenshareZone(QUuid zone) { _screenshareZone = zone; }
 
+    // Encoded trait data relayed to other avatars, kept in step with the traits this avatar has processed.
+    // A null blob means the trait is packed from the avatar when sent.
+    TraitBlobCache::BlobPointer getTraitBlob(AvatarTraits::TraitType traitType) const { return _traitBlobs[traitType]; }
+    void setTraitBlob(AvatarTraits::TraitType traitType, TraitBlobCache::BlobPointer blob) { _traitBlobs[traitType] = blob; }
+    TraitBlobCache::BlobPointer getTraitInstanceBlob(AvatarTraits::TraitType traitType,
+                                                     AvatarTraits::TraitInstanceID instanceID) const;
+    void setTraitInstanceBlob(AvatarTraits::TraitType traitType, AvatarTraits::TraitInstanceID instanceID,
+                              TraitBlobCache::BlobPointer blob);
+
 private:
     bool _needsHeroCheck { false };
     static const char* stateToName(VerifyState state);
@@ -72,6 +85,8 @@ private:
     bool _needsIdentityUpdate { false };
     bool _inScreenshareZone { false };
     QUuid _screenshareZone;
+    std::array<TraitBlobCache::BlobPointer, AvatarTraits::NUM_SIMPLE_TRAITS> _traitBlobs;
+    std::array<QHash<AvatarTraits::TraitInstanceID, TraitBlobCache::BlobPointer>, AvatarTraits::NUM_INSTANCED_TRAITS> _traitInstanceBlobs;
 
     bool generateFSTHash();
     bool validateFSTHash(const QString& publicKey) const;
@@ -0,0 +1,76 @@
+//
+//  TraitBlobCache.cpp
+//  assignment-client/src/avatars
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TraitBlobCache.h"
+
+#include <QtCore/QCryptographicHash>
+
+TraitBlobCache::BlobPointer TraitBlobCache::insert(const QByteArray& data) {
+    if (data.isNull()) {
+        return BlobPointer();
+    }
+
+    QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& entry = _blobs[hash];
+    BlobPointer blob = entry.lock();
+    if (blob && blob->data == data) {
+        _hits++;
+        return blob;
+    }
+
+    _misses++;
+    blob = std::make_shared<const Blob>(Blob { hash, data });
+    if (!entry.lock()) {
+        entry = blob;
+    }
+    // else a hash collision with a live blob, which keeps its entry while this one goes uncached
+
+    if (++_insertsSincePrune >= PRUNE_INTERVAL) {
+        pruneExpired();
+    }
+    return blob;
+}
+
+void TraitBlobCache::pruneExpired() {
+    _insertsSincePrune = 0;
+    for (auto it = _blobs.begin(); it != _blobs.end();) {
+        if (it.value().expired()) {
+            it = _blobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+QJsonObject TraitBlobCache::getStatsJSON() const {
+    int numEntries = 0;
+    int numBlobs = 0;
+    qint64 numBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        numEntries = _blobs.size();
+        for (auto it = _blobs.cbegin(); it != _blobs.cend(); ++it) {
+            if (auto blob = it.value().lock()) {
+                numBlobs++;
+                numBytes += blob->data.size();
+            }
+        }
+    }
+
+    QJsonObject stats;
+    stats["entries"] = numEntries; // including the expired ones that haven't been pruned yet
+    stats["blobs"] = numBlobs;
+    stats["bytes"] = numBytes;
+    stats["hits"] = (qint64)_hits;
+    stats["misses"] = (qint64)_misses;
+    return stats;
+}
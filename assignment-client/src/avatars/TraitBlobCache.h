@@ -0,0 +1,55 @@
+//
+//  TraitBlobCache.h
+//  assignment-client/src/avatars
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+// Content-addressed storage for the encoded avatar traits relayed by the avatar mixer.
+
+#ifndef hifi_TraitBlobCache_h
+#define hifi_TraitBlobCache_h
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+
+// Each trait blob received by the mixer is hashed once and stored here, encoded exactly as it goes out on the wire.
+// Avatars sending identical traits (the same skeleton model URL, skeleton data or avatar entity data) share a
+// single blob, and bulk traits packets to every listener are built from the stored bytes instead of re-packing
+// the trait from the avatar each time.
+class TraitBlobCache {
+public:
+    struct Blob {
+        QByteArray hash;
+        QByteArray data;
+    };
+    using BlobPointer = std::shared_ptr<const Blob>;
+
+    // expired entries are swept out every this many inserts.
+    static const int PRUNE_INTERVAL = 256;
+
+    // returns the blob for data, shared with any other holder of the same data.
+    BlobPointer insert(const QByteArray& data);
+
+    QJsonObject getStatsJSON() const;
+
+private:
+    void pruneExpired();    // assumes _mutex is held
+
+    mutable std::mutex _mutex;
+    QHash<QByteArray, std::weak_ptr<const Blob>> _blobs;
+    int _insertsSincePrune { 0 };
+
+    std::atomic<uint64_t> _hits { 0 };
+    std::atomic<uint64_t> _misses { 0 };
+};
+
+#endif // hifi_TraitBlobCache_h
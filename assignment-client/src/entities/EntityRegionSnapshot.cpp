@@ -0,0 +1,225 @@
+//
+//  EntityRegionSnapshot.cpp
+//  assignment-client/src/entities
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityRegionSnapshot.h"
+
+#include <map>
+#include <tuple>
+
+#include <OctreePacketData.h>
+#include <SharedUtil.h>
+
+static const int NUM_ENTITIES_OFFSET = EntityRegionSnapshot::SECTION_HEADER_SIZE - sizeof(uint16_t);
+
+namespace {
+
+struct PendingRegion {
+    AACube cube;
+    bool isRoot;
+    std::vector<EntityItemPointer> entities;
+};
+
+using RegionKey = std::tuple<float, float, float, float>;
+
+RegionKey getRegionKey(const AACube& cube) {
+    const glm::vec3& corner = cube.getCorner();
+    return RegionKey(corner.x, corner.y, corner.z, cube.getScale());
+}
+
+void collectRegions(const EntityTreeElementPointer& element, int depth, size_t regionIndex, std::vector<PendingRegion>& regions) {
+    if (depth == EntityRegionSnapshot::REGION_DEPTH) {
+        regionIndex = regions.size();
+        regions.push_back({ element->getAACube(), false, {} });
+    }
+    element->forEachEntity([&](const EntityItemPointer& entity) {
+        regions[regionIndex].entities.push_back(entity);
+    });
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        EntityTreeElementPointer child = element->getChildAtIndex(i);
+        if (child) {
+            collectRegions(child, depth + 1, regionIndex, regions);
+        }
+    }
+}
+
+bool canReuseRegion(const EntityRegionSnapshot::Region& region, const std::vector<EntityRegionSnapshot::Entity>& entities) {
+    size_t numEntities = 0;
+    for (const auto& section : region.sections) {
+        numEntities += section.entities.size();
+    }
+    if (numEntities != entities.size()) {
+        return false;
+    }
+    auto entity = entities.begin();
+    for (const auto& section : region.sections) {
+        for (const auto& previous : section.entities) {
+            if (previous.key != entity->key || previous.version != entity->version || previous.entity.expired()) {
+                return false;
+            }
+            ++entity;
+        }
+    }
+    return true;
+}
+
+class SectionWriter {
+public:
+    SectionWriter(uint8_t childrenInTreeMask, std::vector<EntityRegionSnapshot::Section>& sections) :
+        _childrenInTreeMask(childrenInTreeMask),
+        _sections(sections)
+    {
+        start();
+    }
+
+    // returns false if the entity doesn't fit in a section of its own
+    bool append(const EntityItemPointer& entity, const EntityRegionSnapshot::Entity& snapshotEntity) {
+        if (tryAppend(entity)) {
+            _entities.push_back(snapshotEntity);
+            return true;
+        }
+        if (_entities.empty()) {
+            return false;
+        }
+        finish();
+        if (tryAppend(entity)) {
+            _entities.push_back(snapshotEntity);
+            return true;
+        }
+        return false;
+    }
+
+    void finish() {
+        if (_entities.empty()) {
+            return;
+        }
+        uint16_t numEntities = (uint16_t)_entities.size();
+        _packetData.updatePriorBytes(NUM_ENTITIES_OFFSET, (const unsigned char*)&numEntities, sizeof(numEntities));
+
+        EntityRegionSnapshot::Section section;
+        section.data = QByteArray((const char*)_packetData.getUncompressedData(), _packetData.getUncompressedSize());
+        int compressedSize = _packetData.getFinalizedSize();
+        if (compressedSize <= EntityRegionSnapshot::MAX_COMPRESSED_SECTION_SIZE) {
+            section.compressedData = QByteArray((const char*)_packetData.getFinalizedData(), compressedSize);
+        }
+        section.entities.swap(_entities);
+        _sections.push_back(std::move(section));
+        start();
+    }
+
+private:
+    void start() {
+        _packetData.changeSettings(true, EntityRegionSnapshot::MAX_SECTION_SIZE);
+        const uint8_t zeroByte = 0;
+        _packetData.appendValue(zeroByte); // octalcode
+        _packetData.appendValue(zeroByte); // colors
+        _packetData.appendValue(_childrenInTreeMask); // childrenInTreeMask
+        _packetData.appendValue(zeroByte); // childrenInBufferMask
+        uint16_t numEntities = 0;
+        _packetData.appendValue(numEntities);
+        _entities.clear();
+    }
+
+    bool tryAppend(const EntityItemPointer& entity) {
+        LevelDetails entityLevel = _packetData.startLevel();
+        EncodeBitstreamParams params;
+        if (entity->appendCachedEntityData(&_packetData, params, _extraEncodeData) == OctreeElement::COMPLETED) {
+            _packetData.endLevel(entityLevel);
+            return true;
+        }
+        _packetData.discardLevel(entityLevel);
+        _extraEncodeData->entities.clear();
+        return false;
+    }
+
+    OctreePacketData _packetData;
+    EntityTreeElementExtraEncodeDataPointer _extraEncodeData { new EntityTreeElementExtraEncodeData() };
+    uint8_t _childrenInTreeMask;
+    std::vector<EntityRegionSnapshot::Entity> _entities;
+    std::vector<EntityRegionSnapshot::Section>& _sections;
+};
+
+}
+
+EntityRegionSnapshotPointer EntityRegionSnapshot::build(const EntityTreePointer& tree, const EntityRegionSnapshotPointer& previous) {
+    auto snapshot = std::make_shared<EntityRegionSnapshot>();
+    snapshot->_buildTime = usecTimestampNow();
+
+    std::vector<PendingRegion> pendingRegions;
+    tree->withReadLock([&] {
+        EntityTreeElementPointer root = tree->getRoot();
+        if (!root) {
+            return;
+        }
+        snapshot->_treeChangedTime = root->getLastChanged();
+        for (int i = 0; i < NUMBER_OF_CHILDREN; ++i) {
+            if (root->getChildAtIndex(i)) {
+                snapshot->_childrenInTreeMask |= (1 << i);
+            }
+        }
+
+        pendingRegions.push_back({ root->getAACube(), true, {} });
+        collectRegions(root, 0, 0, pendingRegions);
+    });
+
+    // sections of unchanged regions are shared with the previous snapshot
+    std::map<RegionKey, const Region*> previousRegions;
+    if (previous && previous->_childrenInTreeMask == snapshot->_childrenInTreeMask) {
+        for (const auto& region : previous->_regions) {
+            previousRegions[getRegionKey(region.cube)] = &region;
+        }
+    }
+
+    for (const auto& pendingRegion : pendingRegions) {
+        if (pendingRegion.entities.empty()) {
+            continue;
+        }
+
+        std::vector<Entity> entities;
+        entities.reserve(pendingRegion.entities.size());
+        for (const auto& entity : pendingRegion.entities) {
+            // the timestamps are read before encoding, so an edit that lands in between is sent again by the traversal
+            quint64 lastEdited = entity->getLastEdited();
+            quint64 changedOnServer = entity->getLastChangedOnServer();
+            quint64 version = std::max(std::max(lastEdited, changedOnServer),
+                                       std::max(entity->getLastUpdated(), entity->getLastSimulated()));
+            entities.push_back({ entity, entity.get(), std::max(lastEdited, changedOnServer), version });
+        }
+
+        Region region;
+        region.cube = pendingRegion.cube;
+        region.isRoot = pendingRegion.isRoot;
+
+        auto previousRegion = previousRegions.find(getRegionKey(region.cube));
+        if (previousRegion != previousRegions.end() && previousRegion->second->isRoot == region.isRoot &&
+            canReuseRegion(*previousRegion->second, entities)) {
+            region.sections = previousRegion->second->sections;
+            snapshot->_numReusedRegions++;
+        } else {
+            SectionWriter writer(snapshot->_childrenInTreeMask, region.sections);
+            for (size_t i = 0; i < entities.size(); i++) {
+                // entities bigger than a packet are left to the regular traversal
+                writer.append(pendingRegion.entities[i], entities[i]);
+            }
+            writer.finish();
+        }
+
+        for (const auto& section : region.sections) {
+            snapshot->_numEntities += (int)section.entities.size();
+            snapshot->_numBytes += section.data.size() + section.compressedData.size();
+        }
+        snapshot->_numSections += (int)region.sections.size();
+        if (!region.sections.empty()) {
+            snapshot->_regions.push_back(std::move(region));
+        }
+    }
+
+    snapshot->_buildDuration = usecTimestampNow() - snapshot->_buildTime;
+    return snapshot;
+}
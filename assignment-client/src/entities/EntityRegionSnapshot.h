@@ -0,0 +1,90 @@
+//
+//  EntityRegionSnapshot.h
+//  assignment-client/src/entities
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityRegionSnapshot_h
+#define hifi_EntityRegionSnapshot_h
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QByteArray>
+
+#include <AACube.h>
+#include <EntityItem.h>
+#include <EntityTree.h>
+
+class EntityRegionSnapshot;
+using EntityRegionSnapshotPointer = std::shared_ptr<const EntityRegionSnapshot>;
+
+// Pre-built, compressed entity data sections for every region of the entity tree, rebuilt periodically by the EntityServer.
+// A client joining the domain is sent these sections in region priority order instead of having every entity in view
+// queued and encoded for it, after which its regular traversal only sends the entities that changed since they were
+// encoded here.  Sections use the same layout as the ones built by EntityTreeSendThread, so clients can't tell the difference.
+class EntityRegionSnapshot {
+public:
+    // octal code, colors, children in tree mask, children in buffer mask, number of entities
+    static const int SECTION_HEADER_SIZE = 4 * sizeof(uint8_t) + sizeof(uint16_t);
+    static const int CHILDREN_IN_TREE_MASK_OFFSET = 2;
+
+    // sections are sent in a packet of their own, leaving room for the section size and the compression overhead
+    static const int MAX_SECTION_SIZE =
+        MAX_OCTREE_PACKET_DATA_SIZE - sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE) - COMPRESS_PADDING;
+    static const int MAX_COMPRESSED_SECTION_SIZE = MAX_OCTREE_PACKET_DATA_SIZE - sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE);
+
+    struct Entity {
+        EntityItemWeakPointer entity;
+        EntityItem* key;            // for the send thread's known state, only valid while entity can be locked
+        quint64 knownTimestamp;     // the client has this entity up to date as long as it hasn't been edited since
+        quint64 version;            // latest of the entity's edited, updated, simulated and changed on server times
+    };
+
+    // one packet's worth of entities
+    struct Section {
+        QByteArray data;            // uncompressed section, including the header
+        QByteArray compressedData;  // as finalized by OctreePacketData, empty if it wouldn't fit in a packet
+        std::vector<Entity> entities;
+    };
+
+    struct Region {
+        AACube cube;
+        bool isRoot { false };      // entities stored above the region level, sent before any region
+        std::vector<Section> sections;
+    };
+
+    // builds a snapshot of tree, reusing the sections of the previous snapshot for regions that haven't changed.
+    // the tree is only read locked while the entities of each region are collected, not while they are encoded.
+    static EntityRegionSnapshotPointer build(const EntityTreePointer& tree, const EntityRegionSnapshotPointer& previous);
+
+    // depth of the octree elements that each region covers below the root
+    static const int REGION_DEPTH = 3;
+
+    uint64_t getTreeChangedTime() const { return _treeChangedTime; }
+    uint64_t getBuildTime() const { return _buildTime; }
+    uint64_t getBuildDuration() const { return _buildDuration; }
+    uint8_t getChildrenInTreeMask() const { return _childrenInTreeMask; }
+    const std::vector<Region>& getRegions() const { return _regions; }
+    int getNumEntities() const { return _numEntities; }
+    int getNumSections() const { return _numSections; }
+    int getNumReusedRegions() const { return _numReusedRegions; }
+    size_t getNumBytes() const { return _numBytes; }
+
+private:
+    uint64_t _treeChangedTime { 0 };
+    uint64_t _buildTime { 0 };
+    uint64_t _buildDuration { 0 };
+    uint8_t _childrenInTreeMask { 0 };
+    std::vector<Region> _regions;
+    int _numEntities { 0 };
+    int _numSections { 0 };
+    int _numReusedRegions { 0 };
+    size_t _numBytes { 0 };
+};
+
+#endif // hifi_EntityRegionSnapshot_h
@@ -70,6 +70,10 @@ EntityServer::~EntityServer() {
         _pruneDeletedEntitiesTimer->stop();
         _pruneDeletedEntitiesTimer->deleteLater();
     }
+    if (_regionSnapshotTimer) {
+        _regionSnapshotTimer->stop();
+        _regionSnapshotTimer->deleteLater();
+    }
 
     EntityTreePointer tree = std::static_pointer_cast<EntityTree>(_tree);
     tree->removeNewlyCreatedHook(this);
@@ -121,6 +125,11 @@ void EntityServer::beforeRun() {
     const int PRUNE_DELETED_MODELS_INTERVAL_MSECS = 1 * 1000; // once every second
     _pruneDeletedEntitiesTimer->start(PRUNE_DELETED_MODELS_INTERVAL_MSECS);
 
+    _regionSnapshotTimer = new QTimer();
+    connect(_regionSnapshotTimer, &QTimer::timeout, this, &EntityServer::updateRegionSnapshot);
+    const int REGION_SNAPSHOT_INTERVAL_MSECS = 5 * 1000;
+    _regionSnapshotTimer->start(REGION_SNAPSHOT_INTERVAL_MSECS);
+
     DomainHandler& domainHandler = DependencyManager::get<NodeList>()->getDomainHandler();
     connect(&domainHandler, &DomainHandler::settingsReceiveFail, this, &EntityServer::domainSettingsRequestFailed);
 }
@@ -306,6 +315,45 @@ void EntityServer::pruneDeletedEntities() {
     }
 }
 
+void EntityServer::updateRegionSnapshot() {
+    // edits that don't move entities between elements don't mark the tree as changed, rebuild once in a while regardless
+    const quint64 MAX_REGION_SNAPSHOT_AGE = 60 * USECS_PER_SECOND;
+
+    EntityTreePointer tree = std::static_pointer_cast<EntityTree>(_tree);
+    EntityRegionSnapshotPointer previous = getRegionSnapshot();
+    bool changed = false;
+    tree->withReadLock([&] {
+        EntityTreeElementPointer root = tree->getRoot();
+        changed = root && (!previous || root->getLastChanged() > previous->getTreeChangedTime() ||
+                           usecTimestampNow() - previous->getBuildTime() > MAX_REGION_SNAPSHOT_AGE);
+    });
+
+    EntityRegionSnapshotPointer snapshot;
+    if (changed) {
+        snapshot = EntityRegionSnapshot::build(tree, previous);
+    }
+
+    if (snapshot) {
+        std::lock_guard<std::mutex> lock(_regionSnapshotMutex);
+        _regionSnapshot = snapshot;
+    }
+}
+
+EntityRegionSnapshotPointer EntityServer::getRegionSnapshot() const {
+    std::lock_guard<std::mutex> lock(_regionSnapshotMutex);
+    return _regionSnapshot;
+}
+
+void EntityServer::trackInitialResultsSent(quint64 elapsedUsecs, bool usedRegionSnapshot) {
+    if (usedRegionSnapshot) {
+        _initialResultsFromSnapshot++;
+        _initialResultsFromSnapshotUsecs += elapsedUsecs;
+    } else {
+        _initialResultsFromTraversal++;
+        _initialResultsFromTraversalUsecs += elapsedUsecs;
+    }
+}
+
 void EntityServer::readAdditionalConfiguration(const QJsonObject& settingsSectionObject) {
     bool wantEditLogging = false;
     readOptionBool(QString("wantEditLogging"), settingsSectionObject, wantEditLogging);
@@ -347,6 +395,10 @@ void EntityServer::readAdditionalConfiguration(const QJsonObject& settingsSectio
     }
     
     auto entityEditFilters = DependencyManager::get<EntityEditFilters>();
+    if (_editThreads > 0) {
+        // the edit threads and the inbound packet processor all filter edits
+        entityEditFilters->setEnginePoolSize(_editThreads + 1);
+    }
     
     QString filterURL;
     if (readOptionString("entityEditFilter", settingsSectionObject, filterURL) && !filterURL.isEmpty()) {
@@ -416,6 +468,43 @@ QString EntityServer::serverSubclassStats() {
     statsString += QString().sprintf("       EntityItem size... %ld bytes\r\n", sizeof(EntityItem));
     statsString += "\r\n\r\n";
 
+    statsString += "<b>Entity Server Region Snapshot</b>\r\n";
+    EntityRegionSnapshotPointer snapshot = getRegionSnapshot();
+    if (snapshot) {
+        float snapshotAge = (float)(usecTimestampNow() - snapshot->getBuildTime()) / (float)USECS_PER_SECOND;
+        statsString += QString("       entities... %1\r\n").arg(locale.toString(snapshot->getNumEntities()));
+        statsString += QString("        regions... %1 (%2 reused)\r\n")
+            .arg(locale.toString((int)snapshot->getRegions().size())).arg(locale.toString(snapshot->getNumReusedRegions()));
+        statsString += QString("       sections... %1\r\n").arg(locale.toString(snapshot->getNumSections()));
+        statsString += QString("          bytes... %1\r\n").arg(locale.toString((quint64)snapshot->getNumBytes()));
+        statsString += QString("     build time... %1 msecs\r\n")
+            .arg(locale.toString((double)snapshot->getBuildDuration() / (double)USECS_PER_MSEC));
+        statsString += QString("            age... %1 seconds\r\n").arg(locale.toString(snapshotAge));
+    }
+    quint64 fromSnapshot = _initialResultsFromSnapshot;
+    quint64 fromTraversal = _initialResultsFromTraversal;
+    double averageFromSnapshot = fromSnapshot > 0 ?
+        (double)_initialResultsFromSnapshotUsecs / (double)(fromSnapshot * USECS_PER_MSEC) : 0.0;
+    double averageFromTraversal = fromTraversal > 0 ?
+        (double)_initialResultsFromTraversalUsecs / (double)(fromTraversal * USECS_PER_MSEC) : 0.0;
+    statsString += QString("initial results from snapshot... %1 (average %2 msecs)\r\n")
+        .arg(locale.toString(fromSnapshot)).arg(locale.toString(averageFromSnapshot));
+    statsString += QString("initial results from traversal.. %1 (average %2 msecs)\r\n")
+        .arg(locale.toString(fromTraversal)).arg(locale.toString(averageFromTraversal));
+    statsString += "\r\n\r\n";
+
+    statsString += "<b>Entity Server View Clusters</b>\r\n";
+    statsString += QString("       clusters... %1\r\n").arg(locale.toString(_viewClusters.getNumClusters()));
+    statsString += QString("     traversals... %1 shared, %2 published\r\n")
+        .arg(locale.toString(_viewClusters.getNumShared())).arg(locale.toString(_viewClusters.getNumPublished()));
+    statsString += QString("entities shared... %1\r\n").arg(locale.toString(_viewClusters.getNumEntitiesShared()));
+    statsString += "\r\n\r\n";
+
+    statsString += "<b>Entity Server Encoded Data Cache</b>\r\n";
+    statsString += QString("           hits... %1\r\n").arg(locale.toString(EntityItem::getEncodedDataCacheHits()));
+    statsString += QString("         misses... %1\r\n").arg(locale.toString(EntityItem::getEncodedDataCacheMisses()));
+    statsString += "\r\n\r\n";
+
     statsString += "<b>Entity Server Sending to Viewer Statistics</b>\r\n";
     statsString += "----- Viewer Node ID -----------------    ----- Entity ID ----------------------    "
                    "---------- Last Sent To ----------    ---------- Last Edited -----------\r\n";
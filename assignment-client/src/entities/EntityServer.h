@@ -14,13 +14,17 @@
 
 #include "../octree/OctreeServer.h"
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 #include <EntityItem.h>
 #include <EntityTree.h>
 #include <SimpleEntitySimulation.h>
 
+#include "EntityRegionSnapshot.h"
 #include "EntityServerConsts.h"
+#include "EntityViewClusters.h"
 
 /// Handles assignments of type EntityServer - sending entities to various clients.
 
@@ -59,6 +63,13 @@ public:
 
     virtual void aboutToFinish() override;
 
+    // latest snapshot of the tree for clients joining the domain, may be null
+    EntityRegionSnapshotPointer getRegionSnapshot() const;
+    void trackInitialResultsSent(quint64 elapsedUsecs, bool usedRegionSnapshot);
+
+    // traversal results of clients with very similar views
+    EntityViewClusters& getViewClusters() { return _viewClusters; }
+
 public slots:
     virtual void nodeAdded(SharedNodePointer node) override;
     virtual void nodeKilled(SharedNodePointer node) override;
@@ -72,10 +83,21 @@ protected:
 private slots:
     void handleEntityPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
     void domainSettingsRequestFailed();
+    void updateRegionSnapshot();
 
 private:
     SimpleEntitySimulationPointer _entitySimulation;
     QTimer* _pruneDeletedEntitiesTimer = nullptr;
+    QTimer* _regionSnapshotTimer = nullptr;
+
+    mutable std::mutex _regionSnapshotMutex;
+    EntityRegionSnapshotPointer _regionSnapshot;
+    std::atomic<quint64> _initialResultsFromSnapshot { 0 };
+    std::atomic<quint64> _initialResultsFromSnapshotUsecs { 0 };
+    std::atomic<quint64> _initialResultsFromTraversal { 0 };
+    std::atomic<quint64> _initialResultsFromTraversalUsecs { 0 };
+
+    EntityViewClusters _viewClusters;
 
     QReadWriteLock _viewerSendingStatsLock;
     QMap<QUuid, QMap<QUuid, ViewerSendingStats>> _viewerSendingStats;
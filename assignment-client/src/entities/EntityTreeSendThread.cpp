@@ -11,6 +11,9 @@
 
 #include "EntityTreeSendThread.h"
 
+#include <algorithm>
+#include <limits>
+
 #include <EntityNodeData.h>
 #include <EntityTypes.h>
 #include <OctreeUtils.h>
@@ -33,6 +36,12 @@ void EntityTreeSendThread::resetState() {
 
     _knownState.clear();
     _traversal.reset();
+    _visibleSetRecording.reset();
+
+    _regionSnapshot.reset();
+    _regionSnapshotSections.clear();
+    _nextRegionSnapshotSection = 0;
+    _usedRegionSnapshot = false;
 }
 
 void EntityTreeSendThread::preDistributionProcessing() {
@@ -110,8 +119,16 @@ bool EntityTreeSendThread::traverseTreeAndSendContents(SharedNodePointer node, O
 
         int32_t lodLevelOffset = nodeData->getBoundaryLevelAdjust() + (viewFrustumChanged ? LOW_RES_MOVING_ADJUST : NO_BOUNDARY_ADJUST);
         newView.lodScaleFactor = powf(2.0f, lodLevelOffset);
-        
-        startNewTraversal(newView, root, isFullScene);
+
+        // clients joining the domain can start from the region snapshot, unless they only want some of the entities
+        // or are allowed to see the private user data, which isn't part of it
+        bool allowRegionSnapshot = nodeData->wantReportInitialCompletion() && nodeData->getJSONParameters().isEmpty() &&
+            !node->getCanGetAndSetPrivateUserData();
+        if (nodeData->wantReportInitialCompletion() && _initialResultsStart == 0) {
+            _initialResultsStart = usecTimestampNow();
+        }
+
+        startNewTraversal(newView, root, isFullScene, allowRegionSnapshot);
 
         // When the viewFrustum changed the sort order may be incorrect, so we re-sort
         // and also use the opportunity to cull anything no longer in view
@@ -153,6 +170,12 @@ bool EntityTreeSendThread::traverseTreeAndSendContents(SharedNodePointer node, O
         #endif
         _traversal.traverse(TIME_BUDGET);
         OctreeServer::trackTreeTraverseTime((float)(usecTimestampNow() - startTime));
+
+        if (_visibleSetRecording && _traversal.finished()) {
+            // clients with a very similar view can start from what this traversal found
+            static_cast<EntityServer*>(_myServer)->getViewClusters().publish(_visibleSetRecording);
+            _visibleSetRecording.reset();
+        }
     }
 
     bool sendComplete = OctreeSendThread::traverseTreeAndSendContents(node, nodeData, viewFrustumChanged, isFullScene);
@@ -171,6 +194,13 @@ bool EntityTreeSendThread::traverseTreeAndSendContents(SharedNodePointer node, O
             sizeof(OCTREE_PACKET_SEQUENCE), true);
         initialCompletion->writePrimitive(OCTREE_PACKET_SEQUENCE(nodeData->getSequenceNumber()));
         DependencyManager::get<NodeList>()->sendPacket(std::move(initialCompletion), *node);
+
+        quint64 elapsed = usecTimestampNow() - _initialResultsStart;
+        static_cast<EntityServer*>(_myServer)->trackInitialResultsSent(elapsed, _usedRegionSnapshot);
+        qCDebug(entities) << "Sent initial entities to" << _nodeUuid << "in" << (elapsed / USECS_PER_MSEC) << "msecs"
+                          << (_usedRegionSnapshot ? "from region snapshot" : "");
+        _usedRegionSnapshot = false;
+        _initialResultsStart = 0;
     }
 
     return sendComplete;
@@ -226,9 +256,10 @@ bool EntityTreeSendThread::addDescendantsToExtraFlaggedEntities(const QUuid& fil
 }
 
 void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, EntityTreeElementPointer root,
-                                             bool forceFirstPass) {
+                                             bool forceFirstPass, bool allowRegionSnapshot) {
 
     DiffTraversal::Type type = _traversal.prepareNewTraversal(view, root, forceFirstPass);
+    _visibleSetRecording.reset();
     // there are three types of traversal:
     //
     //      (1) FirstTime = at login --> find everything in view
@@ -239,22 +270,20 @@ void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, En
 
     switch (type) {
         case DiffTraversal::First:
+            // Entities sent (or about to be sent) from the region snapshot are known, only look for what it doesn't cover.
+            // This also applies when the view changes before the initial results are complete.
+            if (_usedRegionSnapshot || (allowRegionSnapshot && queueRegionSnapshot(view))) {
+                _traversal.setScanCallback([this](DiffTraversal::VisibleElement& next) {
+                    scanUnknownOrChangedEntities(next);
+                });
+                break;
+            }
             // When we get to a First traversal, clear the _knownState
             _knownState.clear();
-            _traversal.setScanCallback([this](DiffTraversal::VisibleElement& next) {
-                next.element->forEachEntity([&](EntityItemPointer entity) {
-                    // Bail early if we've already checked this entity this frame
-                    if (_sendQueue.contains(entity.get())) {
-                        return;
-                    }
-                    const auto& view = _traversal.getCurrentView();
-                    float priority = view.computePriority(entity);
-
-                    if (priority != PrioritizedEntity::DO_NOT_SEND) {
-                        _sendQueue.emplace(entity, priority);
-                    }
-                });
-            });
+            if (queueSharedVisibleSet()) {
+                break;
+            }
+            startRecordingVisibleSet();
             break;
         case DiffTraversal::Repeat:
             _traversal.setScanCallback([this](DiffTraversal::VisibleElement& next) {
@@ -288,36 +317,234 @@ void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, En
             break;
         case DiffTraversal::Differential:
             assert(view.usesViewFrustums());
-            _traversal.setScanCallback([this] (DiffTraversal::VisibleElement& next) {
-                next.element->forEachEntity([&](EntityItemPointer entity) {
-                    // Bail early if we've already checked this entity this frame
-                    if (_sendQueue.contains(entity.get())) {
-                        return;
-                    }
-                    float priority = PrioritizedEntity::DO_NOT_SEND;
+            if (queueSharedVisibleSet()) {
+                break;
+            }
+            startRecordingVisibleSet();
+            break;
+    }
+}
 
-                    auto knownTimestamp = _knownState.find(entity.get());
-                    if (knownTimestamp == _knownState.end()) {
-                        const auto& view = _traversal.getCurrentView();
-                        priority = view.computePriority(entity);
+void EntityTreeSendThread::scanUnknownOrChangedEntities(DiffTraversal::VisibleElement& next) {
+    next.element->forEachEntity([&](EntityItemPointer entity) {
+        // Bail early if we've already checked this entity this frame
+        if (_sendQueue.contains(entity.get())) {
+            return;
+        }
+        float priority = PrioritizedEntity::DO_NOT_SEND;
 
-                    } else if (entity->getLastEdited() > knownTimestamp->second ||
-                               entity->getLastChangedOnServer() > knownTimestamp->second) {
-                        // it is known and it changed --> put it on the queue with any priority
-                        // TODO: sort these correctly
-                        priority = PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY;
-                    }
+        auto knownTimestamp = _knownState.find(entity.get());
+        if (knownTimestamp == _knownState.end()) {
+            const auto& view = _traversal.getCurrentView();
+            priority = view.computePriority(entity);
 
-                    if (priority != PrioritizedEntity::DO_NOT_SEND) {
-                        _sendQueue.emplace(entity, priority);
-                    }
-                });
-            });
-            break;
+        } else if (entity->getLastEdited() > knownTimestamp->second ||
+                   entity->getLastChangedOnServer() > knownTimestamp->second) {
+            // it is known and it changed --> put it on the queue with any priority
+            // TODO: sort these correctly
+            priority = PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY;
+        }
+
+        if (priority != PrioritizedEntity::DO_NOT_SEND) {
+            _sendQueue.emplace(entity, priority);
+        }
+    });
+}
+
+bool EntityTreeSendThread::queueSharedVisibleSet() {
+    const auto& view = _traversal.getCurrentView();
+    auto visibleSet = static_cast<EntityServer*>(_myServer)->getViewClusters().find(view);
+    if (!visibleSet) {
+        return false;
+    }
+
+    uint64_t sharedStartTime = visibleSet->view.startTime;
+    for (const auto& visibleEntity : visibleSet->entities) {
+        EntityItemPointer entity = visibleEntity.entity.lock();
+        if (!entity || entity->isDead() || _sendQueue.contains(entity.get())) {
+            continue;
+        }
+        float priority = PrioritizedEntity::DO_NOT_SEND;
+
+        auto knownTimestamp = _knownState.find(entity.get());
+        if (knownTimestamp == _knownState.end()) {
+            priority = EntityViewClusters::computeSharedPriority(visibleEntity, entity, view, sharedStartTime);
+        } else if (entity->getLastEdited() > knownTimestamp->second ||
+                   entity->getLastChangedOnServer() > knownTimestamp->second) {
+            priority = PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY;
+        }
+
+        if (priority != PrioritizedEntity::DO_NOT_SEND) {
+            _sendQueue.emplace(entity, priority);
+        }
     }
+
+    // the next traversal finds what changed since the shared one started
+    _traversal.completeFromSharedTraversal(sharedStartTime);
+    return true;
+}
+
+void EntityTreeSendThread::startRecordingVisibleSet() {
+    auto recording = std::make_shared<EntityViewClusters::VisibleSet>();
+    recording->view = _traversal.getCurrentView();
+    _visibleSetRecording = recording;
+
+    _traversal.setScanCallback([this, recording](DiffTraversal::VisibleElement& next) {
+        const auto& view = _traversal.getCurrentView();
+        next.element->forEachEntity([&](EntityItemPointer entity) {
+            // everything in view is recorded, even what this client already knows about
+            float priority = view.computePriority(entity);
+            if (priority != PrioritizedEntity::DO_NOT_SEND) {
+                recording->entities.push_back({ entity, entity.get(), priority });
+            }
+
+            // Bail early if we've already checked this entity this frame
+            if (_sendQueue.contains(entity.get())) {
+                return;
+            }
+
+            auto knownTimestamp = _knownState.find(entity.get());
+            if (knownTimestamp != _knownState.end()) {
+                if (entity->getLastEdited() <= knownTimestamp->second &&
+                    entity->getLastChangedOnServer() <= knownTimestamp->second) {
+                    return;
+                }
+                // it is known and it changed --> put it on the queue with any priority
+                // TODO: sort these correctly
+                priority = PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY;
+            }
+
+            if (priority != PrioritizedEntity::DO_NOT_SEND) {
+                _sendQueue.emplace(entity, priority);
+            }
+        });
+    });
+}
+
+bool EntityTreeSendThread::queueRegionSnapshot(const DiffTraversal::View& view) {
+    EntityRegionSnapshotPointer snapshot = static_cast<EntityServer*>(_myServer)->getRegionSnapshot();
+    if (!snapshot) {
+        return false;
+    }
+
+    // entities stored above the region level are big enough to be seen from anywhere, send them first
+    std::vector<std::pair<float, const EntityRegionSnapshot::Region*>> regions;
+    for (const auto& region : snapshot->getRegions()) {
+        float priority = region.isRoot ? std::numeric_limits<float>::max() : view.computePriority(region.cube);
+        if (priority != PrioritizedEntity::DO_NOT_SEND) {
+            regions.emplace_back(priority, &region);
+        }
+    }
+    if (regions.empty()) {
+        return false;
+    }
+    std::stable_sort(regions.begin(), regions.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    _regionSnapshotSections.clear();
+    _nextRegionSnapshotSection = 0;
+    for (const auto& region : regions) {
+        for (const auto& section : region.second->sections) {
+            _regionSnapshotSections.push_back(&section);
+            for (const auto& snapshotEntity : section.entities) {
+                if (!snapshotEntity.entity.expired()) {
+                    _knownState[snapshotEntity.key] = snapshotEntity.knownTimestamp;
+                }
+            }
+        }
+    }
+    _regionSnapshot = snapshot;
+    _usedRegionSnapshot = true;
+    return true;
+}
+
+void EntityTreeSendThread::queueRegionSnapshotSectionEntities(const EntityRegionSnapshot::Section& section) {
+    // the section can't be sent as it is, fall back to sending its entities like any other
+    for (const auto& snapshotEntity : section.entities) {
+        _knownState.erase(snapshotEntity.key);
+        EntityItemPointer entity = snapshotEntity.entity.lock();
+        if (entity && !entity->isDead() && !_sendQueue.contains(entity.get())) {
+            float priority = _traversal.getCurrentView().computePriority(entity);
+            if (priority != PrioritizedEntity::DO_NOT_SEND) {
+                _sendQueue.emplace(entity, priority);
+            }
+        }
+    }
+}
+
+bool EntityTreeSendThread::buildNextRegionSnapshotPayload(EncodeBitstreamParams& params) {
+    quint64 encodeStart = usecTimestampNow();
+
+    // sections are precompressed, so each one goes out on its own
+    if (_packetData.hasContent()) {
+        params.stopReason = EncodeBitstreamParams::DIDNT_FIT;
+        OctreeServer::trackEncodeTime(OctreeServer::SKIP_TIME);
+        return true;
+    }
+
+    EntityTreeElementPointer root = std::dynamic_pointer_cast<EntityTreeElement>(_myServer->getOctree()->getRoot());
+    uint8_t childrenInTreeMask = 0;
+    for (int32_t i = 0; i < NUMBER_OF_CHILDREN; ++i) {
+        if (root->getChildAtIndex(i)) {
+            childrenInTreeMask |= (1 << i);
+        }
+    }
+
+    while (hasRegionSnapshotSections()) {
+        const EntityRegionSnapshot::Section& section = *_regionSnapshotSections[_nextRegionSnapshotSection++];
+
+        // entities deleted since the snapshot was built must not be sent
+        bool isCurrent = params.includeExistsBits && !section.compressedData.isEmpty();
+        std::vector<EntityItemPointer> entities;
+        entities.reserve(section.entities.size());
+        for (const auto& snapshotEntity : section.entities) {
+            EntityItemPointer entity = snapshotEntity.entity.lock();
+            if (!entity || entity->isDead()) {
+                isCurrent = false;
+                break;
+            }
+            entities.push_back(entity);
+        }
+        if (!isCurrent) {
+            queueRegionSnapshotSectionEntities(section);
+            continue;
+        }
+
+        if (childrenInTreeMask == _regionSnapshot->getChildrenInTreeMask()) {
+            _packetData.loadPrecompressedContent(section.data, section.compressedData);
+        } else {
+            // the client removes the children of its root that aren't in the mask, so the section has to be up to date
+            QByteArray data = section.data;
+            data[EntityRegionSnapshot::CHILDREN_IN_TREE_MASK_OFFSET] = (char)childrenInTreeMask;
+            OctreePacketData packetData(true);
+            packetData.appendRawData(data);
+            if (packetData.getFinalizedSize() > EntityRegionSnapshot::MAX_COMPRESSED_SECTION_SIZE) {
+                queueRegionSnapshotSectionEntities(section);
+                continue;
+            }
+            QByteArray compressedData((const char*)packetData.getFinalizedData(), packetData.getFinalizedSize());
+            _packetData.loadPrecompressedContent(data, compressedData);
+        }
+
+        for (size_t i = 0; i < entities.size(); i++) {
+            params.trackSend(entities[i]->getID(), section.entities[i].knownTimestamp);
+        }
+
+        params.stopReason = EncodeBitstreamParams::DIDNT_FIT;
+        OctreeServer::trackEncodeTime((float)(usecTimestampNow() - encodeStart));
+        return true;
+    }
+
+    // everything has been sent, the snapshot can go
+    _regionSnapshot.reset();
+    _regionSnapshotSections.clear();
+    _nextRegionSnapshotSection = 0;
+    return false;
 }
 
 bool EntityTreeSendThread::traverseTreeAndBuildNextPacketPayload(EncodeBitstreamParams& params, const QJsonObject& jsonFilters) {
+    if (hasRegionSnapshotSections() && buildNextRegionSnapshotPayload(params)) {
+        return true;
+    }
     if (_sendQueue.empty()) {
         params.stopReason = EncodeBitstreamParams::FINISHED;
         OctreeServer::trackEncodeTime(OctreeServer::SKIP_TIME);
@@ -377,7 +604,7 @@ bool EntityTreeSendThread::traverseTreeAndBuildNextPacketPayload(EncodeBitstream
                     // Record explicitly filtered-in entity so that extra entities can be flagged.
                     entityNodeData->insertSentFilteredEntity(entityID);
                 }
-                OctreeElement::AppendState appendEntityState = entity->appendEntityData(&_packetData, params, _extraEncodeData, entityNode->getCanGetAndSetPrivateUserData());
+                OctreeElement::AppendState appendEntityState = entity->appendCachedEntityData(&_packetData, params, _extraEncodeData, entityNode->getCanGetAndSetPrivateUserData());
 
                 if (appendEntityState != OctreeElement::COMPLETED) {
                     if (appendEntityState == OctreeElement::PARTIAL) {
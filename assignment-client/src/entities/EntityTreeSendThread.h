@@ -20,6 +20,8 @@
 #include <EntityPriorityQueue.h>
 #include <shared/ConicalViewFrustum.h>
 
+#include "EntityRegionSnapshot.h"
+#include "EntityViewClusters.h"
 
 class EntityNodeData;
 class EntityItem;
@@ -42,16 +44,37 @@ private:
     bool addAncestorsToExtraFlaggedEntities(const QUuid& filteredEntityID, EntityItem& entityItem, EntityNodeData& nodeData);
     bool addDescendantsToExtraFlaggedEntities(const QUuid& filteredEntityID, EntityItem& entityItem, EntityNodeData& nodeData);
 
-    void startNewTraversal(const DiffTraversal::View& viewFrustum, EntityTreeElementPointer root, bool forceFirstPass = false);
+    void startNewTraversal(const DiffTraversal::View& viewFrustum, EntityTreeElementPointer root, bool forceFirstPass = false,
+                           bool allowRegionSnapshot = false);
+    void scanUnknownOrChangedEntities(DiffTraversal::VisibleElement& next);
+
+    // queues the entities of a recent traversal of a very similar view instead of traversing the tree
+    bool queueSharedVisibleSet();
+    // the new traversal records everything in view, to be shared when it finishes
+    void startRecordingVisibleSet();
     bool traverseTreeAndBuildNextPacketPayload(EncodeBitstreamParams& params, const QJsonObject& jsonFilters) override;
 
+    // queues the sections of the server's region snapshot in view, and marks their entities as known
+    bool queueRegionSnapshot(const DiffTraversal::View& view);
+    bool hasRegionSnapshotSections() const { return _nextRegionSnapshotSection < _regionSnapshotSections.size(); }
+    bool buildNextRegionSnapshotPayload(EncodeBitstreamParams& params);
+    void queueRegionSnapshotSectionEntities(const EntityRegionSnapshot::Section& section);
+
     void preDistributionProcessing() override;
-    bool hasSomethingToSend(OctreeQueryNode* nodeData) override { return !_sendQueue.empty(); }
+    bool hasSomethingToSend(OctreeQueryNode* nodeData) override { return !_sendQueue.empty() || hasRegionSnapshotSections(); }
     bool shouldStartNewTraversal(OctreeQueryNode* nodeData, bool viewFrustumChanged) override { return viewFrustumChanged || _traversal.finished(); }
 
     DiffTraversal _traversal;
     EntityPriorityQueue _sendQueue;
     std::unordered_map<EntityItem*, uint64_t> _knownState;
+    std::shared_ptr<EntityViewClusters::VisibleSet> _visibleSetRecording;
+
+    // initial entity load from the server's region snapshot
+    EntityRegionSnapshotPointer _regionSnapshot; // keeps the queued sections alive
+    std::vector<const EntityRegionSnapshot::Section*> _regionSnapshotSections;
+    size_t _nextRegionSnapshotSection { 0 };
+    bool _usedRegionSnapshot { false };
+    quint64 _initialResultsStart { 0 };
 
     // packet construction stuff
     EntityTreeElementExtraEncodeDataPointer _extraEncodeData { new EntityTreeElementExtraEncodeData() };
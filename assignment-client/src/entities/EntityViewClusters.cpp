@@ -0,0 +1,75 @@
+//
+//  EntityViewClusters.cpp
+//  assignment-client/src/entities
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityViewClusters.h"
+
+#include <algorithm>
+
+#include <SharedUtil.h>
+
+EntityViewClusters::VisibleSetPointer EntityViewClusters::find(const DiffTraversal::View& view) {
+    uint64_t now = usecTimestampNow();
+    VisibleSetPointer result;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& visibleSet : _visibleSets) {
+            if (now - visibleSet->view.startTime < MAX_VISIBLE_SET_AGE && visibleSet->view.isVerySimilar(view) &&
+                (!result || visibleSet->view.startTime > result->view.startTime)) {
+                result = visibleSet;
+            }
+        }
+    }
+    if (result) {
+        _numShared++;
+        _numEntitiesShared += result->entities.size();
+    }
+    return result;
+}
+
+void EntityViewClusters::publish(const VisibleSetPointer& visibleSet) {
+    uint64_t now = usecTimestampNow();
+    std::lock_guard<std::mutex> lock(_mutex);
+    removeExpiredSets(now);
+
+    // the new set replaces the older ones of its cluster
+    _visibleSets.erase(std::remove_if(_visibleSets.begin(), _visibleSets.end(), [&](const VisibleSetPointer& other) {
+        return other->view.startTime <= visibleSet->view.startTime && other->view.isVerySimilar(visibleSet->view);
+    }), _visibleSets.end());
+
+    if ((int)_visibleSets.size() >= MAX_VISIBLE_SETS) {
+        auto oldest = std::min_element(_visibleSets.begin(), _visibleSets.end(),
+            [](const VisibleSetPointer& a, const VisibleSetPointer& b) { return a->view.startTime < b->view.startTime; });
+        _visibleSets.erase(oldest);
+    }
+    _visibleSets.push_back(visibleSet);
+    _numPublished++;
+}
+
+float EntityViewClusters::computeSharedPriority(const VisibleEntity& visibleEntity, const EntityItemPointer& entity,
+                                               const DiffTraversal::View& view, uint64_t sharedStartTime) {
+    if (entity->getLastEdited() > sharedStartTime || entity->getLastChangedOnServer() > sharedStartTime) {
+        return view.computePriority(entity);
+    }
+    return visibleEntity.priority;
+}
+
+int EntityViewClusters::getNumClusters() const {
+    uint64_t now = usecTimestampNow();
+    std::lock_guard<std::mutex> lock(_mutex);
+    return (int)std::count_if(_visibleSets.begin(), _visibleSets.end(), [&](const VisibleSetPointer& visibleSet) {
+        return now - visibleSet->view.startTime < MAX_VISIBLE_SET_AGE;
+    });
+}
+
+void EntityViewClusters::removeExpiredSets(uint64_t now) {
+    _visibleSets.erase(std::remove_if(_visibleSets.begin(), _visibleSets.end(), [&](const VisibleSetPointer& visibleSet) {
+        return now - visibleSet->view.startTime >= MAX_VISIBLE_SET_AGE;
+    }), _visibleSets.end());
+}
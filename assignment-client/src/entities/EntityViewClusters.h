@@ -0,0 +1,73 @@
+//
+//  EntityViewClusters.h
+//  assignment-client/src/entities
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityViewClusters_h
+#define hifi_EntityViewClusters_h
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <DiffTraversal.h>
+#include <EntityItem.h>
+#include <NumericalConstants.h>
+
+// Results of full traversals of the entity tree, shared between the send threads of clients with very similar views
+// and the same LOD.  When many clients stand in the same place, as at an event, the first of them to traverse the tree
+// records the entities in view with their priorities, and the others queue those instead of traversing the tree
+// themselves.  What each client has been sent, its json filters and its private data are still handled by its own
+// send thread, and its next traversal picks up whatever changed since the shared one started.
+class EntityViewClusters {
+public:
+    struct VisibleEntity {
+        EntityItemWeakPointer entity;
+        EntityItem* key;            // for the send thread's known state, only valid while entity can be locked
+        float priority;
+    };
+
+    // the entities in view of a traversal that started at view.startTime
+    struct VisibleSet {
+        DiffTraversal::View view;
+        std::vector<VisibleEntity> entities;
+    };
+    using VisibleSetPointer = std::shared_ptr<const VisibleSet>;
+
+    // older sets aren't shared, the traversals that follow them would have too many changes to catch up with
+    static const uint64_t MAX_VISIBLE_SET_AGE = USECS_PER_SECOND / 2;
+    static const int MAX_VISIBLE_SETS = 64;
+
+    // the latest recent set of a view very similar to this one, or null
+    VisibleSetPointer find(const DiffTraversal::View& view);
+    void publish(const VisibleSetPointer& visibleSet);
+
+    // The priority to queue an entity of a set shared at sharedStartTime with, for a client viewing from view that
+    // doesn't know about the entity.  Entities edited since the shared traversal may have moved, so they are
+    // prioritized again.
+    static float computeSharedPriority(const VisibleEntity& visibleEntity, const EntityItemPointer& entity,
+                                       const DiffTraversal::View& view, uint64_t sharedStartTime);
+
+    int getNumClusters() const;
+    quint64 getNumPublished() const { return _numPublished; }
+    quint64 getNumShared() const { return _numShared; }
+    quint64 getNumEntitiesShared() const { return _numEntitiesShared; }
+
+private:
+    void removeExpiredSets(uint64_t now);
+
+    mutable std::mutex _mutex;
+    std::vector<VisibleSetPointer> _visibleSets;
+
+    std::atomic<quint64> _numPublished { 0 };
+    std::atomic<quint64> _numShared { 0 };
+    std::atomic<quint64> _numEntitiesShared { 0 };
+};
+
+#endif // hifi_EntityViewClusters_h
@@ -11,8 +11,12 @@
 
 #include "OctreeInboundPacketProcessor.h"
 
+#include <algorithm>
 #include <limits>
 
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+
 #include <NumericalConstants.h>
 #include <udt/PacketHeaders.h>
 #include <PerfStat.h>
@@ -20,8 +24,18 @@
 #include "OctreeServer.h"
 #include "OctreeServerConsts.h"
 
-static QUuid DEFAULT_NODE_ID_REF;
 const quint64 TOO_LONG_SINCE_LAST_NACK = 1 * USECS_PER_SECOND;
+const int MAX_EDIT_PACKETS_PER_BATCH = 64;
+const int MAX_AUTOMATIC_EDIT_THREADS = 4;
+
+class EditThreadRunnable : public QRunnable {
+public:
+    EditThreadRunnable(std::function<void()> function) : _function(std::move(function)) {}
+    void run() override { _function(); }
+
+private:
+    std::function<void()> _function;
+};
 
 OctreeInboundPacketProcessor::OctreeInboundPacketProcessor(OctreeServer* myServer) :
     _myServer(myServer),
@@ -34,6 +48,17 @@ OctreeInboundPacketProcessor::OctreeInboundPacketProcessor(OctreeServer* myServe
     _lastNackTime(usecTimestampNow()),
     _shuttingDown(false)
 {
+    _lastEditWindowAt = usecTimestampNow();
+    setNumEditThreads(0);
+}
+
+void OctreeInboundPacketProcessor::setNumEditThreads(int numEditThreads) {
+    if (numEditThreads <= 0) {
+        numEditThreads = std::min(MAX_AUTOMATIC_EDIT_THREADS, std::max(1, QThread::idealThreadCount() - 1));
+    }
+    _numEditThreads = numEditThreads;
+    // this thread prepares edits too
+    _editThreadPool.setMaxThreadCount(std::max(1, numEditThreads - 1));
 }
 
 void OctreeInboundPacketProcessor::resetStats() {
@@ -42,6 +67,10 @@ void OctreeInboundPacketProcessor::resetStats() {
     _totalLockWaitTime = 0;
     _totalElementsInPacket = 0;
     _totalPackets = 0;
+    _totalEditLatency = 0;
+    _maxEditLatency = 0;
+    _totalEditBatches = 0;
+    _editsPerSecond.reset();
     _lastNackTime = usecTimestampNow();
 
     QWriteLocker locker(&_senderStatsLock);
@@ -59,6 +88,8 @@ uint32_t OctreeInboundPacketProcessor::getMaxWait() const {
 }
 
 void OctreeInboundPacketProcessor::preProcess() {
+    updateEditWindow();
+
     // check if it's time to send a nack. If yes, do so
     quint64 now = usecTimestampNow();
     if (now - _lastNackTime >= TOO_LONG_SINCE_LAST_NACK) {
@@ -76,6 +107,21 @@ void OctreeInboundPacketProcessor::midProcess() {
     }
 }
 
+void OctreeInboundPacketProcessor::postProcess() {
+    processEditBatch();
+}
+
+void OctreeInboundPacketProcessor::updateEditWindow() {
+    quint64 now = usecTimestampNow();
+    quint64 sinceLastWindow = now - _lastEditWindowAt;
+    if (sinceLastWindow > USECS_PER_SECOND) {
+        float secondsSinceLastWindow = (float)sinceLastWindow / USECS_PER_SECOND;
+        _editsPerSecond.updateAverage((float)_lastWindowEdits / secondsSinceLastWindow);
+        _lastEditWindowAt = now;
+        _lastWindowEdits = 0;
+    }
+}
+
 void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
     if (_shuttingDown) {
         qDebug() << "OctreeInboundPacketProcessor::processPacket() while shutting down... ignoring incoming packet";
@@ -92,6 +138,12 @@ void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage>
 
     // Ask our tree subclass if it can handle the incoming packet...
     PacketType packetType = message->getType();
+    bool isEditPacket = _myServer->getOctree()->handlesEditPacketType(packetType);
+
+    if (!isEditPacket) {
+        // apply the edits received before this packet first
+        processEditBatch();
+    }
     
     if (packetType == PacketType::ChallengeOwnership) {
         _myServer->getOctree()->withWriteLock([&] {
@@ -105,12 +157,15 @@ void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage>
         _myServer->getOctree()->withWriteLock([&] {
             _myServer->getOctree()->processChallengeOwnershipReplyPacket(*message, sendingNode);
         });
-    } else if (_myServer->getOctree()->handlesEditPacketType(packetType)) {
+    } else if (isEditPacket) {
         PerformanceWarning warn(debugProcessPacket, "processPacket KNOWN TYPE", debugProcessPacket);
         _receivedPacketCount++;
 
-        unsigned short int sequence;
-        message->readPrimitive(&sequence);
+        EditPacket packet;
+        packet.message = message;
+        packet.sendingNode = sendingNode;
+
+        message->readPrimitive(&packet.sequence);
 
         quint64 sentAt;
         message->readPrimitive(&sentAt);
@@ -124,18 +179,16 @@ void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage>
             sentAt = arrivedAt;
         }
 
-        quint64 transitTime = arrivedAt - sentAt;
-        int editsInPacket = 0;
-        quint64 processTime = 0;
-        quint64 lockWaitTime = 0;
+        packet.arrivedAt = arrivedAt;
+        packet.transitTime = arrivedAt - sentAt;
 
         if (debugProcessPacket || _myServer->wantsDebugReceiving()) {
             qDebug() << "PROCESSING THREAD: got '" << packetType << "' packet - " << _receivedPacketCount << " command from client";
             qDebug() << "    receivedBytes=" << message->getSize();
-            qDebug() << "         sequence=" << sequence;
+            qDebug() << "         sequence=" << packet.sequence;
             qDebug() << "           sentAt=" << sentAt << " usecs";
             qDebug() << "        arrivedAt=" << arrivedAt << " usecs";
-            qDebug() << "      transitTime=" << transitTime << " usecs";
+            qDebug() << "      transitTime=" << packet.transitTime << " usecs";
             qDebug() << "      sendingNode->getClockSkewUsec()=" << sendingNode->getClockSkewUsec() << " usecs";
 
 
@@ -143,7 +196,7 @@ void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage>
 
         if (debugProcessPacket) {
             qDebug() << "    numBytesPacketHeader=" << NLPacket::totalHeaderSize(packetType);
-            qDebug() << "    sizeof(sequence)=" << sizeof(sequence);
+            qDebug() << "    sizeof(sequence)=" << sizeof(packet.sequence);
             qDebug() << "    sizeof(sentAt)=" << sizeof(sentAt);
             qDebug() << "    atByte (in payload)=" << message->getPosition();
             qDebug() << "    payload size=" << message->getSize();
@@ -152,77 +205,135 @@ void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage>
                 qDebug() << "    ----- UNEXPECTED ---- got a packet without any edit details!!!! --------";
             }
         }
-        
-        const unsigned char* editData = nullptr;
-        
-        while (message->getBytesLeftToRead() > 0) {
 
-            editData = reinterpret_cast<const unsigned char*>(message->getRawMessage() + message->getPosition());
+        // the edits are applied with the rest of the batch, see postProcess()
+        _editBatch.push_back(std::move(packet));
+        if ((int)_editBatch.size() >= MAX_EDIT_PACKETS_PER_BATCH) {
+            processEditBatch();
+        }
+    } else {
+        qDebug("unknown packet ignored... packetType=%hhu", (unsigned char)packetType);
+    }
+}
+
+void OctreeInboundPacketProcessor::prepareEditPacket(EditPacket& packet) {
+    quint64 startPrepare = usecTimestampNow();
+    OctreePointer tree = _myServer->getOctree();
+    ReceivedMessage& message = *packet.message;
 
-            int maxSize = message->getBytesLeftToRead();
+    tree->withReadLock([&] {
+        while (message.getBytesLeftToRead() > 0) {
+            const unsigned char* editData =
+                reinterpret_cast<const unsigned char*>(message.getRawMessage() + message.getPosition());
+            int maxSize = message.getBytesLeftToRead();
 
-            if (debugProcessPacket) {
-                qDebug() << " --- inside while loop ---";
-                qDebug() << "    maxSize=" << maxSize;
-                qDebug("OctreeInboundPacketProcessor::processPacket() %hhu "
-                       "payload=%p payloadLength=%lld editData=%p payloadPosition=%lld maxSize=%d",
-                       (unsigned char)packetType, message->getRawMessage(), message->getSize(), editData,
-                        message->getPosition(), maxSize);
+            Octree::PreparedEditPointer edit = tree->prepareEditPacketData(message, editData, maxSize, packet.sendingNode);
+            if (!edit) {
+                break;
             }
-
-            quint64 startProcess, startLock = usecTimestampNow();
-            int editDataBytesRead;
-            _myServer->getOctree()->withWriteLock([&] {
-                startProcess = usecTimestampNow();
-                editDataBytesRead =
-                    _myServer->getOctree()->processEditPacketData(*message, editData, maxSize, sendingNode);
-            });
-            quint64 endProcess = usecTimestampNow();
-
-            if (debugProcessPacket) {
-                qDebug() << "OctreeInboundPacketProcessor::processPacket() after processEditPacketData()..."
-                    << "editDataBytesRead=" << editDataBytesRead;
+            int editDataBytesRead = edit->bytesRead;
+            packet.edits.push_back(std::move(edit));
+            if (editDataBytesRead <= 0) {
+                break;
             }
 
-            editsInPacket++;
-            quint64 thisProcessTime = endProcess - startProcess;
-            quint64 thisLockWaitTime = startProcess - startLock;
-            processTime += thisProcessTime;
-            lockWaitTime += thisLockWaitTime;
-
             // skip to next edit record in the packet
-            message->seek(message->getPosition() + editDataBytesRead);
+            message.seek(message.getPosition() + editDataBytesRead);
+        }
+    });
+
+    packet.prepareTime = usecTimestampNow() - startPrepare;
+}
+
+void OctreeInboundPacketProcessor::processEditBatch() {
+    if (_editBatch.empty()) {
+        return;
+    }
+    if (_shuttingDown) {
+        _editBatch.clear();
+        return;
+    }
 
-            if (debugProcessPacket) {
-                qDebug() << "    editDataBytesRead=" << editDataBytesRead;
-                qDebug() << "    AFTER processEditPacketData payload position=" << message->getPosition();
-                qDebug() << "    AFTER processEditPacketData payload size=" << message->getSize();
+    bool debugProcessPacket = _myServer->wantsVerboseDebug();
+    OctreePointer tree = _myServer->getOctree();
+    bool prepareEdits = tree->canPrepareEdits();
+    int numPackets = (int)_editBatch.size();
+
+    if (prepareEdits) {
+        // the packets are handed out one at a time to the edit threads, this thread takes its share too
+        std::atomic<int> nextPacket { 0 };
+        auto prepareEditPackets = [&] {
+            for (int i = nextPacket++; i < numPackets; i = nextPacket++) {
+                prepareEditPacket(_editBatch[i]);
             }
+        };
+        int numHelpers = std::min(_numEditThreads, numPackets) - 1;
+        for (int i = 0; i < numHelpers; i++) {
+            _editThreadPool.start(new EditThreadRunnable(prepareEditPackets));
+        }
+        prepareEditPackets();
+        _editThreadPool.waitForDone();
+    }
 
+    // apply every edit of the batch, in the order they were received, under a single write lock
+    std::vector<quint64> appliedAt(numPackets);
+    quint64 startLock = usecTimestampNow();
+    quint64 startApply = startLock;
+    tree->withWriteLock([&] {
+        startApply = usecTimestampNow();
+        for (int i = 0; i < numPackets; i++) {
+            EditPacket& packet = _editBatch[i];
+            ReceivedMessage& message = *packet.message;
+            if (prepareEdits) {
+                for (auto& edit : packet.edits) {
+                    tree->applyPreparedEdit(message, *edit, packet.sendingNode);
+                }
+                packet.numEdits = (int)packet.edits.size();
+            } else {
+                while (message.getBytesLeftToRead() > 0) {
+                    const unsigned char* editData =
+                        reinterpret_cast<const unsigned char*>(message.getRawMessage() + message.getPosition());
+                    int maxSize = message.getBytesLeftToRead();
+                    int editDataBytesRead = tree->processEditPacketData(message, editData, maxSize, packet.sendingNode);
+                    packet.numEdits++;
+                    if (editDataBytesRead <= 0) {
+                        break;
+                    }
+                    message.seek(message.getPosition() + editDataBytesRead);
+                }
+            }
+            appliedAt[i] = usecTimestampNow();
+        }
+    });
+
+    // the wait for the write lock is shared by all the packets of the batch
+    quint64 lockWaitTime = (startApply - startLock) / numPackets;
+    int editsInBatch = 0;
+    for (int i = 0; i < numPackets; i++) {
+        EditPacket& packet = _editBatch[i];
+        quint64 applyTime = appliedAt[i] - (i == 0 ? startApply : appliedAt[i - 1]);
+        quint64 processTime = packet.prepareTime + applyTime;
+        quint64 latency = packet.transitTime + (appliedAt[i] - packet.arrivedAt);
+
+        _totalEditLatency += latency * packet.numEdits;
+        if (packet.numEdits > 0 && latency > _maxEditLatency) {
+            _maxEditLatency = latency;
         }
+        editsInBatch += packet.numEdits;
 
         if (debugProcessPacket) {
-            qDebug("OctreeInboundPacketProcessor::processPacket() DONE LOOPING FOR %hhu "
-                   "payload=%p payloadLength=%lld editData=%p payloadPosition=%lld",
-                   (unsigned char)packetType, message->getRawMessage(), message->getSize(), editData, message->getPosition());
+            qDebug() << "OctreeInboundPacketProcessor::processEditBatch() packet" << i << "of" << numPackets
+                << "edits=" << packet.numEdits << "processTime=" << processTime << "latency=" << latency;
         }
 
         // Make sure our Node and NodeList knows we've heard from this node.
-        QUuid& nodeUUID = DEFAULT_NODE_ID_REF;
-        if (sendingNode) {
-            nodeUUID = sendingNode->getUUID();
-            if (debugProcessPacket) {
-                qDebug() << "sender has uuid=" << nodeUUID;
-            }
-        } else {
-            if (debugProcessPacket) {
-                qDebug() << "sender has no known nodeUUID.";
-            }
-        }
-        trackInboundPacket(nodeUUID, sequence, transitTime, editsInPacket, processTime, lockWaitTime);
-    } else {
-        qDebug("unknown packet ignored... packetType=%hhu", (unsigned char)packetType);
+        QUuid nodeUUID = packet.sendingNode ? packet.sendingNode->getUUID() : QUuid();
+        trackInboundPacket(nodeUUID, packet.sequence, packet.transitTime, packet.numEdits, processTime, lockWaitTime);
     }
+
+    _lastWindowEdits += editsInBatch;
+    _totalEditBatches++;
+    _editBatch.clear();
 }
 
 void OctreeInboundPacketProcessor::trackInboundPacket(const QUuid& nodeUUID, unsigned short int sequence, quint64 transitTime,
@@ -14,7 +14,13 @@
 #ifndef hifi_OctreeInboundPacketProcessor_h
 #define hifi_OctreeInboundPacketProcessor_h
 
+#include <vector>
+
+#include <QtCore/QThreadPool>
+
+#include <Octree.h>
 #include <ReceivedPacketProcessor.h>
+#include <SimpleMovingAverage.h>
 
 #include "SequenceNumberStats.h"
 
@@ -55,11 +61,18 @@ typedef QHash<QUuid, SingleSenderStats>::const_iterator NodeToSenderStatsMapCons
 
 /// Handles processing of incoming network packets for the octee servers. As with other ReceivedPacketProcessor classes
 /// the user is responsible for reading inbound packets and adding them to the processing queue by calling queueReceivedPacket()
+///
+/// Edit packets are processed in batches: the edits of all the packets of a batch are decoded and checked against the
+/// permissions and edit filters on several threads, then applied in order under a single write lock of the tree.
 class OctreeInboundPacketProcessor : public ReceivedPacketProcessor {
     Q_OBJECT
 public:
     OctreeInboundPacketProcessor(OctreeServer* myServer);
 
+    /// number of threads, including this one, that prepare the edits of a batch. 0 picks a number from the cores.
+    void setNumEditThreads(int numEditThreads);
+    int getNumEditThreads() const { return _numEditThreads; }
+
     quint64 getAverageTransitTimePerPacket() const { return _totalPackets == 0 ? 0 : _totalTransitTime / _totalPackets; }
     quint64 getAverageProcessTimePerPacket() const { return _totalPackets == 0 ? 0 : _totalProcessTime / _totalPackets; }
     quint64 getAverageLockWaitTimePerPacket() const { return _totalPackets == 0 ? 0 : _totalLockWaitTime / _totalPackets; }
@@ -70,6 +83,13 @@ public:
     quint64 getAverageLockWaitTimePerElement() const
                 { return _totalElementsInPacket == 0 ? 0 : _totalLockWaitTime / _totalElementsInPacket; }
 
+    /// time from an edit being sent to it being applied to the tree
+    quint64 getAverageEditLatency() const { return _totalElementsInPacket == 0 ? 0 : _totalEditLatency / _totalElementsInPacket; }
+    quint64 getMaxEditLatency() const { return _maxEditLatency; }
+    float getEditsPerSecond() const { return _editsPerSecond.getAverage(); }
+    float getAveragePacketsPerBatch() const
+                { return _totalEditBatches == 0 ? 0.0f : (float)_totalPackets / (float)_totalEditBatches; }
+
     void resetStats();
 
     NodeToSenderStatsMap getSingleSenderStats() { QReadLocker locker(&_senderStatsLock); return _singleSenderStats; }
@@ -83,11 +103,26 @@ protected:
     virtual uint32_t getMaxWait() const override;
     virtual void preProcess() override;
     virtual void midProcess() override;
+    virtual void postProcess() override;
 
 private:
     int sendNackPackets();
 
 private:
+    struct EditPacket {
+        QSharedPointer<ReceivedMessage> message;
+        SharedNodePointer sendingNode;
+        unsigned short int sequence { 0 };
+        quint64 arrivedAt { 0 };
+        quint64 transitTime { 0 };
+        quint64 prepareTime { 0 };
+        int numEdits { 0 };
+        std::vector<Octree::PreparedEditPointer> edits;
+    };
+
+    void prepareEditPacket(EditPacket& packet);
+    void processEditBatch();
+    void updateEditWindow();
     void trackInboundPacket(const QUuid& nodeUUID, unsigned short int sequence, quint64 transitTime,
             int elementsInPacket, quint64 processTime, quint64 lockWaitTime);
 
@@ -99,6 +134,17 @@ private:
     std::atomic<uint64_t> _totalLockWaitTime;
     std::atomic<uint64_t> _totalElementsInPacket;
     std::atomic<uint64_t> _totalPackets;
+    std::atomic<uint64_t> _totalEditLatency { 0 };
+    std::atomic<uint64_t> _maxEditLatency { 0 };
+    std::atomic<uint64_t> _totalEditBatches { 0 };
+
+    std::vector<EditPacket> _editBatch;
+    QThreadPool _editThreadPool;
+    int _numEditThreads { 1 };
+
+    quint64 _lastEditWindowAt { 0 };
+    int _lastWindowEdits { 0 };
+    SimpleMovingAverage _editsPerSecond;
     
     NodeToSenderStatsMap _singleSenderStats;
     QReadWriteLock _senderStatsLock;
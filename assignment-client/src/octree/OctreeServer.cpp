@@ -315,6 +315,7 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         } else if (url.path() == "/resetStats") {
             _octreeInboundPacketProcessor->resetStats();
             _tree->resetEditStats();
+            _tree->resetLockWaitStats();
             resetSendingStats();
             showStats = true;
         } else if ((url.path() == PERSIST_FILE_DOWNLOAD_PATH) || (url.path() == PERSIST_FILE_DOWNLOAD_PATH + "/")) {
@@ -657,6 +658,10 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         quint64 averageLockWaitTimePerElement = _octreeInboundPacketProcessor->getAverageLockWaitTimePerElement();
         quint64 totalElementsProcessed = _octreeInboundPacketProcessor->getTotalElementsProcessed();
         quint64 totalPacketsProcessed = _octreeInboundPacketProcessor->getTotalPacketsProcessed();
+        float editsPerSecond = _octreeInboundPacketProcessor->getEditsPerSecond();
+        quint64 averageEditLatency = _octreeInboundPacketProcessor->getAverageEditLatency();
+        quint64 maxEditLatency = _octreeInboundPacketProcessor->getMaxEditLatency();
+        float averagePacketsPerBatch = _octreeInboundPacketProcessor->getAveragePacketsPerBatch();
 
         quint64 averageDecodeTime = _tree->getAverageDecodeTime();
         quint64 averageLookupTime = _tree->getAverageLookupTime();
@@ -675,6 +680,10 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
             .arg(locale.toString(incomingPPS, 'f', FLOAT_PRECISION).rightJustified(COLUMN_WIDTH, ' '));
         statsString += QString("    Packets Queue Processing OUT: %1 PPS \r\n")
             .arg(locale.toString(processedPPS, 'f', FLOAT_PRECISION).rightJustified(COLUMN_WIDTH, ' '));
+        // the fraction of the inbound thread spent processing edits
+        float editLoad = 100.0f * processedPPS * (float)averageProcessTimePerPacket / (float)USECS_PER_SECOND;
+        statsString += QString("                       Edit Load: %1 %\r\n")
+            .arg(locale.toString(editLoad, 'f', FLOAT_PRECISION).rightJustified(COLUMN_WIDTH, ' '));
 
         statsString += QString("           Total Inbound Packets: %1 packets\r\n")
             .arg(locale.toString((uint)totalPacketsProcessed).rightJustified(COLUMN_WIDTH, ' '));
@@ -692,6 +701,14 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
             .arg(locale.toString((uint)averageProcessTimePerElement).rightJustified(COLUMN_WIDTH, ' '));
         statsString += QString("  Average Wait Lock Time/Element: %1 usecs\r\n")
             .arg(locale.toString((uint)averageLockWaitTimePerElement).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("                 Edits Processed: %1 edits/sec\r\n")
+            .arg(locale.toString(editsPerSecond, 'f', FLOAT_PRECISION).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("            Average Edit Latency: %1 usecs\r\n")
+            .arg(locale.toString((qulonglong)averageEditLatency).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("                Max Edit Latency: %1 usecs\r\n")
+            .arg(locale.toString((qulonglong)maxEditLatency).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString().sprintf("      Average Packets/Edit Batch: %f packets/batch (%d edit threads)\r\n",
+                                         (double)averagePacketsPerBatch, _octreeInboundPacketProcessor->getNumEditThreads());
 
         statsString += QString("             Average Decode Time: %1 usecs\r\n")
             .arg(locale.toString((uint)averageDecodeTime).rightJustified(COLUMN_WIDTH, ' '));
@@ -706,6 +723,24 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         statsString += QString("            Average Filter Time: %1 usecs\r\n")
             .arg(locale.toString((uint)averageFilterTime).rightJustified(COLUMN_WIDTH, ' '));
 
+        // how long the edits, the send threads and the persist thread waited on each other for the tree lock
+        Octree::LockWaitStats writeLockWaits = _tree->getWriteLockWaitStats();
+        Octree::LockWaitStats readLockWaits = _tree->getReadLockWaitStats();
+        statsString += QString("\r\n              Tree Write Locks: %1 locks, %2 waited\r\n")
+            .arg(locale.toString((qulonglong)writeLockWaits.numLocks).rightJustified(COLUMN_WIDTH, ' '))
+            .arg(locale.toString((qulonglong)writeLockWaits.numWaits));
+        statsString += QString("   Average Tree Write Lock Wait: %1 usecs\r\n")
+            .arg(locale.toString((qulonglong)writeLockWaits.getAverageWaitUsecs()).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("       Max Tree Write Lock Wait: %1 usecs\r\n")
+            .arg(locale.toString((qulonglong)writeLockWaits.maxWaitUsecs).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("               Tree Read Locks: %1 locks, %2 waited\r\n")
+            .arg(locale.toString((qulonglong)readLockWaits.numLocks).rightJustified(COLUMN_WIDTH, ' '))
+            .arg(locale.toString((qulonglong)readLockWaits.numWaits));
+        statsString += QString("    Average Tree Read Lock Wait: %1 usecs\r\n")
+            .arg(locale.toString((qulonglong)readLockWaits.getAverageWaitUsecs()).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("        Max Tree Read Lock Wait: %1 usecs\r\n")
+            .arg(locale.toString((qulonglong)readLockWaits.maxWaitUsecs).rightJustified(COLUMN_WIDTH, ' '));
+
 
         int senderNumber = 0;
         NodeToSenderStatsMap allSenderStats = _octreeInboundPacketProcessor->getSingleSenderStats();
@@ -1098,6 +1133,10 @@ void OctreeServer::readConfiguration() {
     qDebug("packetsPerSecondTotalMax=%d _packetsTotalPerInterval=%d",
                     packetsPerSecondTotalMax, _packetsTotalPerInterval);
 
+    // threads that decode and check the incoming edits before they are applied, 0 picks a number from the cores
+    readOptionInt(QString("editThreads"), settingsSectionObject, _editThreads);
+    qDebug("editThreads=%d", _editThreads);
+
 
     readAdditionalConfiguration(settingsSectionObject);
 }
@@ -1228,6 +1267,7 @@ void OctreeServer::beginRunning() {
 
     // set up our OctreeServerPacketProcessor
     _octreeInboundPacketProcessor = new OctreeInboundPacketProcessor(this);
+    _octreeInboundPacketProcessor->setNumEditThreads(_editThreads);
     _octreeInboundPacketProcessor->initialize(true);
 
     // Convert now to tm struct for local timezone
@@ -1475,6 +1515,13 @@ void OctreeServer::sendStatsPacket() {
         dataArray2["1. packetQueue"] = (double)_octreeInboundPacketProcessor->packetsToProcessCount();
         dataArray2["2. totalPackets"] = (double)_octreeInboundPacketProcessor->getTotalPacketsProcessed();
         dataArray2["3. totalElements"] = (double)_octreeInboundPacketProcessor->getTotalElementsProcessed();
+        dataArray2["4. editsPerSecond"] = (double)_octreeInboundPacketProcessor->getEditsPerSecond();
+        dataArray2["5. packetsPerEditBatch"] = (double)_octreeInboundPacketProcessor->getAveragePacketsPerBatch();
+        dataArray2["6. avgEditLatency"] = (double)_octreeInboundPacketProcessor->getAverageEditLatency();
+        dataArray2["7. maxEditLatency"] = (double)_octreeInboundPacketProcessor->getMaxEditLatency();
+        dataArray2["8. incomingPPS"] = (double)_octreeInboundPacketProcessor->getIncomingPPS();
+        dataArray2["9. editLoadPercent"] = 100.0 * (double)_octreeInboundPacketProcessor->getProcessedPPS() *
+            (double)_octreeInboundPacketProcessor->getAverageProcessTimePerPacket() / (double)USECS_PER_SECOND;
 
         timingArray2["1. avgTransitTimePerPacket"] = (double)_octreeInboundPacketProcessor->getAverageTransitTimePerPacket();
         timingArray2["2. avgProcessTimePerPacket"] = (double)_octreeInboundPacketProcessor->getAverageProcessTimePerPacket();
@@ -1482,6 +1529,12 @@ void OctreeServer::sendStatsPacket() {
         timingArray2["4. avgProcessTimePerElement"] = (double)_octreeInboundPacketProcessor->getAverageProcessTimePerElement();
         timingArray2["5. avgLockWaitTimePerElement"] = (double)_octreeInboundPacketProcessor->getAverageLockWaitTimePerElement();
     }
+    if (_tree) {
+        timingArray2["6. avgTreeWriteLockWait"] = (double)_tree->getWriteLockWaitStats().getAverageWaitUsecs();
+        timingArray2["7. maxTreeWriteLockWait"] = (double)_tree->getWriteLockWaitStats().maxWaitUsecs;
+        timingArray2["8. avgTreeReadLockWait"] = (double)_tree->getReadLockWaitStats().getAverageWaitUsecs();
+        timingArray2["9. maxTreeReadLockWait"] = (double)_tree->getReadLockWaitStats().maxWaitUsecs;
+    }
 
     QJsonObject statsObject3;
     statsObject3["data"] = dataArray2;
@@ -11,8 +11,11 @@
 
 #include "EntityScriptServer.h"
 
+#include <algorithm>
 #include <mutex>
 
+#include <QtCore/QJsonArray>
+
 #include <AudioConstants.h>
 #include <AudioInjectorManager.h>
 #include <ClientServerUtils.h>
@@ -54,6 +57,11 @@ void messageHandler(QtMsgType type, const QMessageLogContext& context, const QSt
 
 int EntityScriptServer::_entitiesScriptEngineCount = 0;
 
+// the number of entity scripts with the longest run times in the stats
+const int NUM_SCRIPT_RUN_TIME_STATS = 10;
+// the number of the busiest script functions of each shard in the stats
+const int NUM_SCRIPT_PROFILE_STATS = 10;
+
 EntityScriptServer::EntityScriptServer(ReceivedMessage& message) : ThreadedAssignment(message) {
     qInstallMessageHandler(messageHandler);
 
@@ -130,7 +138,7 @@ void EntityScriptServer::handleEntityScriptGetStatusPacket(QSharedPointer<Receiv
         replyPacketList->writePrimitive(messageID);
 
         EntityScriptDetails details;
-        if (_entitiesScriptEngine->getEntityScriptDetails(entityID, details)) {
+        if (_entityScriptShards && _entityScriptShards->engineForEntity(entityID)->getEntityScriptDetails(entityID, details)) {
             replyPacketList->writePrimitive(true);
             replyPacketList->writePrimitive(details.status);
             replyPacketList->writeString(details.errorInfo);
@@ -159,6 +167,23 @@ void EntityScriptServer::handleSettings() {
 
     auto entityScriptServerSettings = settingsObject[ENTITY_SCRIPT_SERVER_SETTINGS_KEY].toObject();
 
+    static const QString SCRIPT_THREADS_OPTION = "script_threads";
+    int scriptThreads = std::max(0, entityScriptServerSettings[SCRIPT_THREADS_OPTION].toInt(0));
+    if (scriptThreads != _scriptThreads) {
+        _scriptThreads = scriptThreads;
+        int numShards = EntityScriptShards::getNumShardsToRun(_scriptThreads);
+        if (_entityScriptShards && _entityScriptShards->getNumShards() != numShards && !_shuttingDown) {
+            // entities are assigned to shards by their number, so every script has to move
+            qDebug() << "Restarting the entity scripts on" << numShards << "script threads";
+            stopEntitiesScriptEngines();
+            resetEntitiesScriptEngine();
+
+            for (const auto& entityID : EntityScriptShards::getEntitiesWithServerScripts(_entityViewer.getTree())) {
+                checkAndCallPreload(entityID);
+            }
+        }
+    }
+
     static const QString MAX_ENTITY_PPS_OPTION = "max_total_entity_pps";
     static const QString ENTITY_PPS_PER_SCRIPT = "entity_pps_per_script";
 
@@ -174,8 +199,18 @@ void EntityScriptServer::handleSettings() {
                 .arg(_maxEntityPPS).arg(_entityPPSPerScript);
 }
 
+int EntityScriptServer::getNumRunningEntityScripts() const {
+    int numRunningScripts = 0;
+    if (_entityScriptShards) {
+        for (int i = 0; i < _entityScriptShards->getNumShards(); i++) {
+            numRunningScripts += _entityScriptShards->getEngine(i)->getNumRunningEntityScripts();
+        }
+    }
+    return numRunningScripts;
+}
+
 void EntityScriptServer::updateEntityPPS() {
-    int numRunningScripts = _entitiesScriptEngine->getNumRunningEntityScripts();
+    int numRunningScripts = getNumRunningEntityScripts();
     int pps;
     if (std::numeric_limits<int>::max() / _entityPPSPerScript < numRunningScripts) {
         qWarning() << QString("Integer multiplication would overflow, clamping to maxint: %1 * %2").arg(numRunningScripts).arg(_entityPPSPerScript);
@@ -236,7 +271,7 @@ void EntityScriptServer::pushLogs() {
 
 void EntityScriptServer::handleEntityScriptCallMethodPacket(QSharedPointer<ReceivedMessage> receivedMessage, SharedNodePointer senderNode) {
 
-    if (_entitiesScriptEngine && _entityViewer.getTree() && !_shuttingDown) {
+    if (_entityScriptShards && _entityViewer.getTree() && !_shuttingDown) {
         auto entityID = QUuid::fromRfc4122(receivedMessage->read(NUM_BYTES_RFC4122_UUID));
 
         auto method = receivedMessage->readString();
@@ -250,7 +285,8 @@ void EntityScriptServer::handleEntityScriptCallMethodPacket(QSharedPointer<Recei
             params << paramString;
         }
 
-        _entitiesScriptEngine->callEntityScriptMethod(entityID, method, params, senderNode->getUUID());
+        // queued for the shard of the entity
+        _entityScriptShards->callEntityScriptMethod(entityID, method, params, senderNode->getUUID());
     }
 }
 
@@ -445,54 +481,78 @@ void EntityScriptServer::selectAudioFormat(const QString& selectedCodecName) {
 }
 
 void EntityScriptServer::resetEntitiesScriptEngine() {
-    auto engineName = QString("about:Entities %1").arg(++_entitiesScriptEngineCount);
-    auto newEngine = scriptEngineFactory(ScriptEngine::ENTITY_SERVER_SCRIPT, NO_SCRIPT, engineName);
-
-    auto webSocketServerConstructorValue = newEngine->newFunction(WebSocketServerClass::constructor);
-    newEngine->globalObject().setProperty("WebSocketServer", webSocketServerConstructorValue);
+    auto scriptEngines = DependencyManager::get<ScriptEngines>().data();
 
-    newEngine->registerGlobalObject("SoundCache", DependencyManager::get<SoundCacheScriptingInterface>().data());
-    newEngine->registerGlobalObject("AvatarList", DependencyManager::get<AvatarHashMap>().data());
+    std::vector<ScriptEnginePointer> engines;
+    int numShards = EntityScriptShards::getNumShardsToRun(_scriptThreads);
+    for (int shard = 0; shard < numShards; shard++) {
+        auto engineName = QString("about:Entities %1").arg(++_entitiesScriptEngineCount);
+        auto newEngine = scriptEngineFactory(ScriptEngine::ENTITY_SERVER_SCRIPT, NO_SCRIPT, engineName);
+
+        auto webSocketServerConstructorValue = newEngine->newFunction(WebSocketServerClass::constructor);
+        newEngine->globalObject().setProperty("WebSocketServer", webSocketServerConstructorValue);
+
+        newEngine->registerGlobalObject("SoundCache", DependencyManager::get<SoundCacheScriptingInterface>().data());
+        newEngine->registerGlobalObject("AvatarList", DependencyManager::get<AvatarHashMap>().data());
+
+        // connect this script engines printedMessage signal to the global ScriptEngines these various messages
+        connect(newEngine.data(), &ScriptEngine::printedMessage, scriptEngines, &ScriptEngines::onPrintedMessage);
+        connect(newEngine.data(), &ScriptEngine::errorMessage, scriptEngines, &ScriptEngines::onErrorMessage);
+        connect(newEngine.data(), &ScriptEngine::warningMessage, scriptEngines, &ScriptEngines::onWarningMessage);
+        connect(newEngine.data(), &ScriptEngine::infoMessage, scriptEngines, &ScriptEngines::onInfoMessage);
+
+        // the tree is updated once a frame, not once per shard
+        if (shard == 0) {
+            connect(newEngine.data(), &ScriptEngine::update, this, [this] {
+                _entityViewer.queryOctree();
+                _entityViewer.getTree()->preUpdate();
+                _entityViewer.getTree()->update();
+            });
+        }
 
-    // connect this script engines printedMessage signal to the global ScriptEngines these various messages
-    auto scriptEngines = DependencyManager::get<ScriptEngines>().data();
-    connect(newEngine.data(), &ScriptEngine::printedMessage, scriptEngines, &ScriptEngines::onPrintedMessage);
-    connect(newEngine.data(), &ScriptEngine::errorMessage, scriptEngines, &ScriptEngines::onErrorMessage);
-    connect(newEngine.data(), &ScriptEngine::warningMessage, scriptEngines, &ScriptEngines::onWarningMessage);
-    connect(newEngine.data(), &ScriptEngine::infoMessage, scriptEngines, &ScriptEngines::onInfoMessage);
-
-    connect(newEngine.data(), &ScriptEngine::update, this, [this] {
-        _entityViewer.queryOctree();
-        _entityViewer.getTree()->preUpdate();
-        _entityViewer.getTree()->update();
-    });
+        scriptEngines->runScriptInitializers(newEngine);
+        newEngine->runInThread();
+        engines.push_back(newEngine);
+    }
 
-    scriptEngines->runScriptInitializers(newEngine);
-    newEngine->runInThread();
-    auto newEngineSP = qSharedPointerCast<EntitiesScriptEngineProvider>(newEngine);
+    auto newShards = QSharedPointer<EntityScriptShards>::create(engines);
     // On the entity script server, these are the same
-    DependencyManager::get<EntityScriptingInterface>()->setPersistentEntitiesScriptEngine(newEngineSP);
-    DependencyManager::get<EntityScriptingInterface>()->setNonPersistentEntitiesScriptEngine(newEngineSP);
+    DependencyManager::get<EntityScriptingInterface>()->setPersistentEntitiesScriptEngine(newShards);
+    DependencyManager::get<EntityScriptingInterface>()->setNonPersistentEntitiesScriptEngine(newShards);
 
-    if (_entitiesScriptEngine) {
-        disconnect(_entitiesScriptEngine.data(), &ScriptEngine::entityScriptDetailsUpdated,
-                   this, &EntityScriptServer::updateEntityPPS);
+    if (_entityScriptShards) {
+        for (int i = 0; i < _entityScriptShards->getNumShards(); i++) {
+            disconnect(_entityScriptShards->getEngine(i).data(), &ScriptEngine::entityScriptDetailsUpdated,
+                       this, &EntityScriptServer::updateEntityPPS);
+        }
     }
 
-    _entitiesScriptEngine.swap(newEngine);
-    connect(_entitiesScriptEngine.data(), &ScriptEngine::entityScriptDetailsUpdated,
-            this, &EntityScriptServer::updateEntityPPS);
+    _entityScriptShards.swap(newShards);
+    for (int i = 0; i < _entityScriptShards->getNumShards(); i++) {
+        connect(_entityScriptShards->getEngine(i).data(), &ScriptEngine::entityScriptDetailsUpdated,
+                this, &EntityScriptServer::updateEntityPPS);
+    }
+    _lastScriptRunTimes.clear();
 }
 
-
-void EntityScriptServer::clear() {
-    // unload and stop the engine
-    if (_entitiesScriptEngine) {
+void EntityScriptServer::stopEntitiesScriptEngines() {
+    if (_entityScriptShards) {
         // do this here (instead of in deleter) to avoid marshalling unload signals back to this thread
-        _entitiesScriptEngine->unloadAllEntityScripts();
-        _entitiesScriptEngine->stop();
-        _entitiesScriptEngine->waitTillDoneRunning();
+        for (int i = 0; i < _entityScriptShards->getNumShards(); i++) {
+            const auto& engine = _entityScriptShards->getEngine(i);
+            engine->unloadAllEntityScripts();
+            engine->stop();
+        }
+        // the shards wind down at the same time
+        for (int i = 0; i < _entityScriptShards->getNumShards(); i++) {
+            _entityScriptShards->getEngine(i)->waitTillDoneRunning();
+        }
     }
+}
+
+void EntityScriptServer::clear() {
+    // unload and stop the engines
+    stopEntitiesScriptEngines();
 
     _entityViewer.clear();
 
@@ -503,8 +563,11 @@ void EntityScriptServer::clear() {
 }
 
 void EntityScriptServer::shutdownScriptEngine() {
-    if (_entitiesScriptEngine) {
-        _entitiesScriptEngine->disconnectNonEssentialSignals(); // disconnect all slots/signals from the script engine, except essential
+    if (_entityScriptShards) {
+        for (int i = 0; i < _entityScriptShards->getNumShards(); i++) {
+            // disconnect all slots/signals from the script engine, except essential
+            _entityScriptShards->getEngine(i)->disconnectNonEssentialSignals();
+        }
     }
     _shuttingDown = true;
 
@@ -513,7 +576,7 @@ void EntityScriptServer::shutdownScriptEngine() {
     auto scriptEngines = DependencyManager::get<ScriptEngines>();
     scriptEngines->shutdownScripting();
 
-    _entitiesScriptEngine.clear();
+    _entityScriptShards.clear();
 
     auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
     // our entity tree is going to go away so tell that to the EntityScriptingInterface
@@ -531,8 +594,8 @@ void EntityScriptServer::addingEntity(const EntityItemID& entityID) {
 }
 
 void EntityScriptServer::deletingEntity(const EntityItemID& entityID) {
-    if (_entityViewer.getTree() && !_shuttingDown && _entitiesScriptEngine) {
-        _entitiesScriptEngine->unloadEntityScript(entityID, true);
+    if (_entityViewer.getTree() && !_shuttingDown && _entityScriptShards) {
+        _entityScriptShards->engineForEntity(entityID)->unloadEntityScript(entityID, true);
     }
 }
 
@@ -543,20 +606,21 @@ void EntityScriptServer::entityServerScriptChanging(const EntityItemID& entityID
 }
 
 void EntityScriptServer::checkAndCallPreload(const EntityItemID& entityID, bool forceRedownload) {
-    if (_entityViewer.getTree() && !_shuttingDown && _entitiesScriptEngine) {
+    if (_entityViewer.getTree() && !_shuttingDown && _entityScriptShards) {
 
         EntityItemPointer entity = _entityViewer.getTree()->findEntityByEntityItemID(entityID);
+        const auto& engine = _entityScriptShards->engineForEntity(entityID);
         EntityScriptDetails details;
-        bool isRunning = _entitiesScriptEngine->getEntityScriptDetails(entityID, details);
+        bool isRunning = engine->getEntityScriptDetails(entityID, details);
         if (entity && (forceRedownload || !isRunning || details.scriptText != entity->getServerScripts())) {
             if (isRunning) {
-                _entitiesScriptEngine->unloadEntityScript(entityID, true);
+                engine->unloadEntityScript(entityID, true);
             }
 
             QString scriptUrl = entity->getServerScripts();
             if (!scriptUrl.isEmpty()) {
                 scriptUrl = DependencyManager::get<ResourceManager>()->normalizeURL(scriptUrl);
-                _entitiesScriptEngine->loadEntityScript(entityID, scriptUrl, forceRedownload);
+                engine->loadEntityScript(entityID, scriptUrl, forceRedownload);
             }
         }
     }
@@ -572,12 +636,34 @@ void EntityScriptServer::sendStatsPacket() {
     statsObject["octree_stats"] = octreeStats;
 
     QJsonObject scriptEngineStats;
-    int numberRunningScripts = 0;
-    const auto scriptEngine = _entitiesScriptEngine;
-    if (scriptEngine) {
-        numberRunningScripts = scriptEngine->getNumRunningEntityScripts();
+    scriptEngineStats["number_running_scripts"] = getNumRunningEntityScripts();
+    const auto shards = _entityScriptShards;
+    if (shards) {
+        QJsonArray shardStats;
+        for (int i = 0; i < shards->getNumShards(); i++) {
+            QJsonObject stats;
+            stats["running_scripts"] = shards->getEngine(i)->getNumRunningEntityScripts();
+            stats["queued_calls"] = (double)shards->getNumQueuedCalls(i);
+
+            // the timers fired since the last stats packet
+            const auto& engine = shards->getEngine(i);
+            ScriptEngine::TimerStats timerStats = engine->getTimerStats();
+            engine->resetTimerStats();
+            QJsonObject timers;
+            timers["count"] = timerStats.numTimers;
+            timers["fired"] = (double)timerStats.numFiredTimers;
+            if (timerStats.numFiredTimers > 0) {
+                timers["overhead_usecs_per_timer"] = (double)timerStats.overheadUsecs / timerStats.numFiredTimers;
+                timers["average_jitter_msecs"] = (double)timerStats.totalLatenessMsecs / timerStats.numFiredTimers;
+            }
+            timers["max_jitter_msecs"] = (double)timerStats.maxLatenessMsecs;
+            stats["timers"] = timers;
+            stats["profile"] = engine->getProfilerStats(NUM_SCRIPT_PROFILE_STATS);
+            shardStats.append(stats);
+        }
+        scriptEngineStats["shards"] = shardStats;
+        scriptEngineStats["slowest_scripts"] = getScriptRunTimeStats();
     }
-    scriptEngineStats["number_running_scripts"] = numberRunningScripts;
     statsObject["script_engine_stats"] = scriptEngineStats;
     
 
@@ -610,6 +696,44 @@ void EntityScriptServer::sendStatsPacket() {
     addPacketStatsAndSendStatsPacket(statsObject);
 }
 
+QJsonObject EntityScriptServer::getScriptRunTimeStats() {
+    // the run time of each script since the last stats packet
+    QHash<EntityItemID, quint64> runTimes;
+    for (int i = 0; i < _entityScriptShards->getNumShards(); i++) {
+        runTimes.unite(_entityScriptShards->getEngine(i)->getEntityScriptRunTimes());
+    }
+    quint64 now = usecTimestampNow();
+    quint64 interval = _lastScriptRunTimesUpdate > 0 ? now - _lastScriptRunTimesUpdate : 0;
+    _lastScriptRunTimesUpdate = now;
+
+    std::vector<std::pair<quint64, EntityItemID>> intervalRunTimes;
+    for (auto iter = runTimes.cbegin(); iter != runTimes.cend(); ++iter) {
+        quint64 runTime = iter.value() - std::min(iter.value(), _lastScriptRunTimes.value(iter.key()));
+        if (runTime > 0) {
+            intervalRunTimes.emplace_back(runTime, iter.key());
+        }
+    }
+    _lastScriptRunTimes = runTimes;
+
+    int numStats = std::min(NUM_SCRIPT_RUN_TIME_STATS, (int)intervalRunTimes.size());
+    std::partial_sort(intervalRunTimes.begin(), intervalRunTimes.begin() + numStats, intervalRunTimes.end(),
+        [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    QJsonObject slowestScripts;
+    for (int i = 0; i < numStats; i++) {
+        const auto& entityID = intervalRunTimes[i].second;
+        QJsonObject scriptStats;
+        scriptStats["shard"] = _entityScriptShards->shardForEntity(entityID);
+        scriptStats["run_time_msecs"] = (double)intervalRunTimes[i].first / USECS_PER_MSEC;
+        if (interval > 0) {
+            // the share of one core the script used
+            scriptStats["cpu_percent"] = 100.0 * (double)intervalRunTimes[i].first / (double)interval;
+        }
+        slowestScripts[uuidStringWithoutCurlyBraces(entityID)] = scriptStats;
+    }
+    return slowestScripts;
+}
+
 void EntityScriptServer::handleOctreePacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
     auto packetType = message->getType();
 
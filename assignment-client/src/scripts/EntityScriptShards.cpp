@@ -0,0 +1,85 @@
+//
+//  EntityScriptShards.cpp
+//  assignment-client/src/scripts
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityScriptShards.h"
+
+#include <algorithm>
+
+#include <QtCore/QThread>
+
+int EntityScriptShards::getNumShardsToRun(int scriptThreads) {
+    if (scriptThreads > 0) {
+        return scriptThreads;
+    }
+    return std::max(1, std::min(MAX_AUTOMATIC_SHARDS, QThread::idealThreadCount() - 1));
+}
+
+std::vector<EntityItemID> EntityScriptShards::getEntitiesWithServerScripts(const EntityTreePointer& tree) {
+    std::vector<EntityItemID> entityIDs;
+    if (tree) {
+        for (const auto& entity : tree->getCurrentEpoch()->entities) {
+            if (!entity->getServerScripts().isEmpty()) {
+                entityIDs.push_back(entity->getEntityItemID());
+            }
+        }
+    }
+    return entityIDs;
+}
+
+EntityScriptShards::EntityScriptShards(const std::vector<ScriptEnginePointer>& engines) {
+    assert(!engines.empty());
+    for (const auto& engine : engines) {
+        auto shard = std::make_shared<Shard>();
+        shard->engine = engine;
+        _shards.push_back(shard);
+    }
+}
+
+int EntityScriptShards::shardForEntity(const EntityItemID& entityID) const {
+    return (int)(qHash(entityID) % (uint)_shards.size());
+}
+
+void EntityScriptShards::callEntityScriptMethod(const EntityItemID& entityID, const QString& methodName,
+                                                const QStringList& params, const QUuid& remoteCallerID) {
+    const ShardPointer& shard = _shards[shardForEntity(entityID)];
+    if (QThread::currentThread() == shard->engine->thread()) {
+        // a call between entities of the same shard runs right away, as it does with a single engine
+        shard->engine->callEntityScriptMethod(entityID, methodName, params, remoteCallerID);
+        return;
+    }
+
+    shard->calls.push({ entityID, methodName, params, remoteCallerID });
+    shard->numQueuedCalls++;
+
+    // the queue is emptied by a single event, however many calls were queued before it runs
+    if (!shard->isRunScheduled.exchange(true)) {
+        std::weak_ptr<Shard> weakShard = shard;
+        QMetaObject::invokeMethod(shard->engine.data(), [weakShard] {
+            auto shard = weakShard.lock();
+            if (shard) {
+                runQueuedCalls(*shard);
+            }
+        }, Qt::QueuedConnection);
+    }
+}
+
+void EntityScriptShards::runQueuedCalls(Shard& shard) {
+    // calls queued from now on schedule another run
+    shard.isRunScheduled = false;
+
+    QueuedCall call;
+    while (shard.calls.try_pop(call)) {
+        shard.engine->callEntityScriptMethod(call.entityID, call.methodName, call.params, call.remoteCallerID);
+    }
+}
+
+QFuture<QVariant> EntityScriptShards::getLocalEntityScriptDetails(const EntityItemID& entityID) {
+    return engineForEntity(entityID)->getLocalEntityScriptDetails(entityID);
+}
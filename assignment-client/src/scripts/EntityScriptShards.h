@@ -0,0 +1,74 @@
+//
+//  EntityScriptShards.h
+//  assignment-client/src/scripts
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityScriptShards_h
+#define hifi_EntityScriptShards_h
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <EntitiesScriptEngineProvider.h>
+#include <EntityTree.h>
+#include <ScriptEngine.h>
+#include <TBBHelpers.h>
+
+// Routes calls into server entity scripts to the script engine that runs them.  The script of an entity always runs on
+// the shard picked by a hash of the entity's ID, each shard with its own engine and thread, so a slow script only holds
+// up the scripts that share its shard.  Calls from other threads, including those the scripts of other shards make, go
+// through a lock-free queue and run in batches on the shard's thread.  Those calls are asynchronous: they return before
+// the method runs.
+class EntityScriptShards : public EntitiesScriptEngineProvider {
+public:
+    // shards run when the number isn't set in the domain settings
+    static const int MAX_AUTOMATIC_SHARDS = 4;
+
+    // the number of shards for the script_threads setting, 0 picks it from the number of cores
+    static int getNumShardsToRun(int scriptThreads);
+    // the entities whose scripts are preloaded on newly started shards
+    static std::vector<EntityItemID> getEntitiesWithServerScripts(const EntityTreePointer& tree);
+
+    EntityScriptShards(const std::vector<ScriptEnginePointer>& engines);
+
+    int getNumShards() const { return (int)_shards.size(); }
+    int shardForEntity(const EntityItemID& entityID) const;
+    const ScriptEnginePointer& getEngine(int shard) const { return _shards[shard]->engine; }
+    const ScriptEnginePointer& engineForEntity(const EntityItemID& entityID) const { return getEngine(shardForEntity(entityID)); }
+
+    // calls queued from other threads, since the shard was created
+    quint64 getNumQueuedCalls(int shard) const { return _shards[shard]->numQueuedCalls; }
+
+    // runs the method right away when called from the thread of the entity's shard, queues it otherwise
+    void callEntityScriptMethod(const EntityItemID& entityID, const QString& methodName,
+                                const QStringList& params = QStringList(), const QUuid& remoteCallerID = QUuid()) override;
+    QFuture<QVariant> getLocalEntityScriptDetails(const EntityItemID& entityID) override;
+
+private:
+    struct QueuedCall {
+        EntityItemID entityID;
+        QString methodName;
+        QStringList params;
+        QUuid remoteCallerID;
+    };
+
+    struct Shard {
+        ScriptEnginePointer engine;
+        tbb::concurrent_queue<QueuedCall> calls;
+        std::atomic<bool> isRunScheduled { false };
+        std::atomic<quint64> numQueuedCalls { 0 };
+    };
+    using ShardPointer = std::shared_ptr<Shard>;
+
+    static void runQueuedCalls(Shard& shard);
+
+    std::vector<ShardPointer> _shards;
+};
+
+#endif // hifi_EntityScriptShards_h
@@ -218,6 +218,11 @@ Item {
                         visible: root.expanded;
                         text: "Entity Servers In: " + root.entityPacketsInKbps + " kbps";
                     }
+                    StatText {
+                        visible: root.expanded;
+                        text: "Entity Servers Out: " + root.entityPacketsOutPPS + " pps, " +
+                            root.entityUpdatesOutPerSecond + " updates/s, error x" + root.entityUpdateErrorScale.toFixed(1);
+                    }
                     StatText {
                         visible: root.expanded;
                         text: "Downloads: " + root.downloads + "/" + root.downloadLimit +
@@ -140,6 +140,9 @@ Item {
                     StatText {
                         text: root.networkGraphText
                     }
+                    StatText {
+                        text: root.clipCacheText
+                    }
                     StatText {
                         text: "Alpha Values:--------------------------------------------------------------------------"
                     }
@@ -259,6 +259,11 @@ Item {
                         visible: root.expanded;
                         text: "Entity Servers In: " + root.entityPacketsInKbps + " kbps";
                     }
+                    StatText {
+                        visible: root.expanded;
+                        text: "Entity Servers Out: " + root.entityPacketsOutPPS + " pps, " +
+                            root.entityUpdatesOutPerSecond + " updates/s, error x" + root.entityUpdateErrorScale.toFixed(1);
+                    }
                     StatText {
                         visible: !root.expanded
                         text: "Octree Elements Server: " + root.serverElements +
@@ -298,6 +303,10 @@ Item {
                         text: "Processing: " + root.processing +
                               ", Pending: " + root.processingPending;
                     }
+                    StatText {
+                        visible: root.expanded && root.jobQueues.length > 0;
+                        text: "Jobs (running/queued):\n" + root.jobQueues;
+                    }
                     StatText {
                         visible: root.expanded && root.downloadUrls.length > 0;
                         text: "Download URLs:"
@@ -94,6 +94,7 @@
 #include <gpu/Batch.h>
 #include <gpu/Context.h>
 #include <InfoView.h>
+#include <JobScheduler.h>
 #include <input-plugins/InputPlugin.h>
 #include <controllers/UserInputMapper.h>
 #include <controllers/InputRecorder.h>
@@ -337,6 +338,9 @@ static const int WATCHDOG_TIMER_TIMEOUT = 100;
 
 static const float INITIAL_QUERY_RADIUS = 10.0f;  // priority radius for entities before physics enabled
 
+static const std::string SHAPE_CACHE_DIRNAME = "shape_cache";
+static const std::string SHAPE_CACHE_EXT = "shape";
+
 static const QString DESKTOP_LOCATION = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
 
 Setting::Handle<int> maxOctreePacketsPerSecond{"maxOctreePPS", DEFAULT_MAX_OCTREE_PPS};
@@ -2826,6 +2830,8 @@ void Application::cleanupBeforeQuit() {
     getEntities()->shutdown(); // tell the entities system we're shutting down, so it will stop running scripts
 
     // Clear any queued processing (I/O, FBX/OBJ/Texture parsing)
+    JobScheduler::getInstance().cancelAll();
+    JobScheduler::getInstance().waitForDone();
     QThreadPool::globalInstance()->clear();
     QThreadPool::globalInstance()->waitForDone();
 
@@ -5696,8 +5702,12 @@ void Application::init() {
         return atan2(maxSize, distance);
     });
 
+    auto shapeCache = std::make_shared<ShapeCache>(SHAPE_CACHE_DIRNAME, SHAPE_CACHE_EXT);
+    shapeCache->initialize();
+    _shapeManager.setShapeCache(shapeCache);
     ObjectMotionState::setShapeManager(&_shapeManager);
     _physicsEngine->init();
+    setMultithreadedPhysics(Menu::getInstance()->isOptionChecked(MenuOption::PhysicsMultithreaded));
 
     EntityTreePointer tree = getEntities()->getTree();
     _entitySimulation->init(tree, _physicsEngine, &_entityEditSender);
@@ -6623,6 +6633,13 @@ void Application::update(float deltaTime) {
                         // we have a better idea of which objects we own or should own.
                         auto& collisionEvents = _physicsEngine->getCollisionEvents();
 
+                        // owned objects far from every avatar, including ours, send coarser updates
+                        std::vector<glm::vec3> viewerPositions;
+                        for (const auto& avatar : avatarManager->getHashCopy()) {
+                            viewerPositions.push_back(avatar->getWorldPosition());
+                        }
+                        _entitySimulation->setViewerPositions(viewerPositions);
+
                         getEntities()->getTree()->withWriteLock([&] {
                             PROFILE_RANGE(simulation_physics, "HandleChanges");
                             PerformanceTimer perfTimer("handleChanges");
@@ -9157,6 +9174,11 @@ void Application::switchDisplayMode() {
     _previousHMDWornStatus = currentHMDWornStatus;
 }
 
+void Application::setMultithreadedPhysics(bool value) {
+    // 0 picks the number of threads from the number of cores
+    _physicsEngine->setNumSimulationThreads(value ? 0 : 1);
+}
+
 void Application::setShowBulletWireframe(bool value) {
     _physicsEngine->setShowBulletWireframe(value);
 }
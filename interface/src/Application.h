@@ -264,6 +264,7 @@ public:
     bool isAboutToQuit() const { return _aboutToQuit; }
     bool isPhysicsEnabled() const { return _physicsEnabled; }
     PhysicsEnginePointer getPhysicsEngine() { return _physicsEngine; }
+    const EntityUpdateBudget& getEntityUpdateBudget() const { return _entitySimulation->getUpdateBudget(); }
 
     // the isHMDMode is true whenever we use the interface from an HMD and not a standard flat display
     // rendering of several elements depend on that
@@ -539,6 +540,7 @@ private slots:
     void handleSandboxStatus(QNetworkReply* reply);
     void switchDisplayMode();
 
+    void setMultithreadedPhysics(bool value);
     void setShowBulletWireframe(bool value);
     void setShowBulletAABBs(bool value);
     void setShowBulletContactPoints(bool value);
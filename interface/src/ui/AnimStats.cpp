@@ -9,6 +9,7 @@
 #include "AnimStats.h"
 
 #include <avatar/AvatarManager.h>
+#include <AnimClipCache.h>
 #include <OffscreenUi.h>
 #include "Menu.h"
 
@@ -109,6 +110,19 @@ void AnimStats::updateStats(bool force) {
     _networkGraphText = QString("Network Graph: %1").arg(networkGraphActive ? "enabled" : "disabled");
     emit networkGraphTextChanged();
 
+    // print shared clip cache hit rates, these cover every avatar, not just ours.
+    auto clipCacheStats = AnimClipCache::getInstance().getStats();
+    auto hitRate = [](uint64_t hits, uint64_t misses) {
+        uint64_t total = hits + misses;
+        return QString::number(total > 0 ? (100.0f * (float)hits / (float)total) : 0.0f, 'f', 1);
+    };
+    _clipCacheText = QString("Clip Cache: frames %1% (%2 sets), samples %3% (%4 live)").
+        arg(hitRate(clipCacheStats.frameHits, clipCacheStats.frameMisses)).
+        arg(clipCacheStats.numFrameSets).
+        arg(hitRate(clipCacheStats.sampleHits, clipCacheStats.sampleMisses)).
+        arg(clipCacheStats.numSamples);
+    emit clipCacheTextChanged();
+
     // update animation debug alpha values
     QStringList newAnimAlphaValues;
     qint64 now = usecTimestampNow();
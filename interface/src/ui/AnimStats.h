@@ -28,6 +28,7 @@ class AnimStats : public QQuickItem {
     Q_PROPERTY(QString overrideJointText READ overrideJointText NOTIFY overrideJointTextChanged)
     Q_PROPERTY(QString flowText READ flowText NOTIFY flowTextChanged)
     Q_PROPERTY(QString networkGraphText READ networkGraphText NOTIFY networkGraphTextChanged)
+    Q_PROPERTY(QString clipCacheText READ clipCacheText NOTIFY clipCacheTextChanged)
 
 public:
     static AnimStats* getInstance();
@@ -49,6 +50,7 @@ public:
     QString overrideJointText() const { return _overrideJointText; }
     QString flowText() const { return _flowText; }
     QString networkGraphText() const { return _networkGraphText; }
+    QString clipCacheText() const { return _clipCacheText; }
 
 public slots:
     void forceUpdateStats() { updateStats(true); }
@@ -67,6 +69,7 @@ signals:
     void overrideJointTextChanged();
     void flowTextChanged();
     void networkGraphTextChanged();
+    void clipCacheTextChanged();
 
 private:
     QStringList _animAlphaValues;
@@ -88,6 +91,7 @@ private:
     QString _overrideJointText;
     QString _flowText;
     QString _networkGraphText;
+    QString _clipCacheText;
 };
 
 #endif // hifi_AnimStats_h
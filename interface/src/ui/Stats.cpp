@@ -22,6 +22,7 @@
 #include <Application.h>
 #include <AudioClient.h>
 #include <GeometryCache.h>
+#include <JobScheduler.h>
 #include <LODManager.h>
 #include <OffscreenUi.h>
 #include <PerfStat.h>
@@ -288,6 +289,12 @@ void Stats::updateStats(bool force) {
         }
 
         STAT_UPDATE(entityPacketsInKbps, octreeServerCount ? totalEntityKbps / octreeServerCount : -1);
+        {
+            const EntityUpdateBudget& entityUpdateBudget = qApp->getEntityUpdateBudget();
+            STAT_UPDATE(entityPacketsOutPPS, (int)entityUpdateBudget.getPacketsPerSecond());
+            STAT_UPDATE(entityUpdatesOutPerSecond, (int)entityUpdateBudget.getUpdatesPerSecond());
+            STAT_UPDATE_FLOAT(entityUpdateErrorScale, entityUpdateBudget.getErrorScale(), 0.1f);
+        }
 
         auto loadingRequests = ResourceCache::getLoadingRequests();
         STAT_UPDATE(downloads, loadingRequests.size());
@@ -295,6 +302,20 @@ void Stats::updateStats(bool force) {
         STAT_UPDATE(downloadsPending, (int)ResourceCache::getPendingRequestCount());
         STAT_UPDATE(processing, DependencyManager::get<StatTracker>()->getStat("Processing").toInt());
         STAT_UPDATE(processingPending, DependencyManager::get<StatTracker>()->getStat("PendingProcessing").toInt());
+        {
+            QStringList jobQueues;
+            auto& jobScheduler = JobScheduler::getInstance();
+            for (int i = 0; i < JobScheduler::NUM_CATEGORIES; i++) {
+                auto category = (JobScheduler::Category)i;
+                auto jobStats = jobScheduler.getStats(category);
+                if (jobStats.running > 0 || jobStats.queued > 0 || jobStats.blocked > 0) {
+                    jobQueues << QString("%1: %2/%3, wait %4ms").arg(JobScheduler::getCategoryName(category))
+                        .arg(jobStats.running).arg(jobStats.queued + jobStats.blocked)
+                        .arg(QString::number(jobStats.averageWaitMsecs, 'f', 1));
+                }
+            }
+            STAT_UPDATE(jobQueues, jobQueues.join("\n"));
+        }
 
         // See if the active download urls have changed
         bool shouldUpdateUrls = _downloads != _downloadUrls.size();
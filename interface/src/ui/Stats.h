@@ -202,6 +202,14 @@ private: \
  *     second. (Multiply by the number of entity servers to get the total amount of data being received.)
  *     <code>-1</code> if not connected to an entity server.
  *     <em>Read-only.</em>
+ * @property {number} entityPacketsOutPPS - The number of entity edit packets being sent to entity servers, per second.
+ *     <em>Read-only.</em>
+ * @property {number} entityUpdatesOutPerSecond - The number of physics updates and ownership bids of simulated entities
+ *     being sent to entity servers, per second. Several of them are packed in each packet.
+ *     <em>Read-only.</em>
+ * @property {number} entityUpdateErrorScale - How many times the nominal dead reckoning error simulated entities are
+ *     allowed before sending an update, to keep within the upstream budget. <code>1</code> when within budget.
+ *     <em>Read-only.</em>
  *
  * @property {number} downloads - The number of downloads in progress.
  *     <em>Read-only.</em>
@@ -216,6 +224,9 @@ private: \
  *     <em>Read-only.</em>
  * @property {number} processingPending - The number of completed downloads waiting to be processed.
  *     <em>Read-only.</em>
+ * @property {string} jobQueues - Description of the background job queues, per category: the number of jobs running,
+ *     queued, and the average time jobs wait in the queue.
+ *     <em>Read-only.</em>
  * @property {number} triangles - The number of triangles in the rendered scene.
  *     <em>Read-only.</em>
  * @property {number} drawcalls - The number of draw calls made for the rendered scene.
@@ -524,6 +535,9 @@ class Stats : public QQuickItem {
     STATS_PROPERTY(QString, audioNoiseGate, QString())
     STATS_PROPERTY(QVector2D, audioInjectors, QVector2D());
     STATS_PROPERTY(int, entityPacketsInKbps, 0)
+    STATS_PROPERTY(int, entityPacketsOutPPS, 0)
+    STATS_PROPERTY(int, entityUpdatesOutPerSecond, 0)
+    STATS_PROPERTY(float, entityUpdateErrorScale, 1.0f)
 
     STATS_PROPERTY(int, downloads, 0)
     STATS_PROPERTY(int, downloadLimit, 0)
@@ -531,6 +545,7 @@ class Stats : public QQuickItem {
     Q_PROPERTY(QStringList downloadUrls READ downloadUrls NOTIFY downloadUrlsChanged)
     STATS_PROPERTY(int, processing, 0)
     STATS_PROPERTY(int, processingPending, 0)
+    STATS_PROPERTY(QString, jobQueues, QString())
     STATS_PROPERTY(int, triangles, 0)
     STATS_PROPERTY(quint32 , drawcalls, 0)
     STATS_PROPERTY(int, materialSwitches, 0)
@@ -1063,6 +1078,27 @@ signals:
      */
     void entityPacketsInKbpsChanged();
 
+    /*@jsdoc
+     * Triggered when the value of the <code>entityPacketsOutPPS</code> property changes.
+     * @function Stats.entityPacketsOutPPSChanged
+     * @returns {Signal}
+     */
+    void entityPacketsOutPPSChanged();
+
+    /*@jsdoc
+     * Triggered when the value of the <code>entityUpdatesOutPerSecond</code> property changes.
+     * @function Stats.entityUpdatesOutPerSecondChanged
+     * @returns {Signal}
+     */
+    void entityUpdatesOutPerSecondChanged();
+
+    /*@jsdoc
+     * Triggered when the value of the <code>entityUpdateErrorScale</code> property changes.
+     * @function Stats.entityUpdateErrorScaleChanged
+     * @returns {Signal}
+     */
+    void entityUpdateErrorScaleChanged();
+
     /*@jsdoc
      * Triggered when the value of the <code>downloads</code> property changes.
      * @function Stats.downloadsChanged
@@ -1105,6 +1141,13 @@ signals:
      */
     void processingPendingChanged();
 
+    /*@jsdoc
+     * Triggered when the value of the <code>jobQueues</code> property changes.
+     * @function Stats.jobQueuesChanged
+     * @returns {Signal}
+     */
+    void jobQueuesChanged();
+
     /*@jsdoc
      * Triggered when the value of the <code>triangles</code> property changes.
      * @function Stats.trianglesChanged
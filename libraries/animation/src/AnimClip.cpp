@@ -263,48 +263,63 @@ const AnimPoseVec& AnimClip::evaluate(const AnimVariantMap& animVars, const Anim
     // poll network anim to see if it's finished loading yet.
     if (_blendType == AnimBlendType_Normal) {
         if (_networkAnim && _networkAnim->isLoaded() && _skeleton) {
-            // loading is complete, copy & retarget animation.
-            _anim = copyAndRetargetFromNetworkAnim(_networkAnim, _skeleton);
+            // loading is complete, copy & retarget animation, unless another clip already did for this skeleton.
+            AnimationPointer networkAnim = _networkAnim;
+            AnimSkeleton::ConstPointer skeleton = _skeleton;
+            _contentHash = networkAnim->getContentHash();
+            _anim = AnimClipCache::getInstance().getFrames(getFramesKey(false), [&] {
+                return copyAndRetargetFromNetworkAnim(networkAnim, skeleton);
+            });
 
             // we no longer need the actual animation resource anymore.
             _networkAnim.reset();
 
             // mirrorAnim will be re-built on demand, if needed.
-            _mirrorAnim.clear();
+            _mirrorAnim.reset();
 
             _poses.resize(_skeleton->getNumJoints());
         }
     } else {
         // an additive blend type
         if (_networkAnim && _networkAnim->isLoaded() && _baseNetworkAnim && _baseNetworkAnim->isLoaded() && _skeleton) {
-            // loading is complete, copy & retarget animation.
-            _anim = copyAndRetargetFromNetworkAnim(_networkAnim, _skeleton);
+            // loading is complete, copy & retarget animation, unless another clip already did for this skeleton.
+            AnimationPointer networkAnim = _networkAnim;
+            AnimationPointer baseNetworkAnim = _baseNetworkAnim;
+            AnimSkeleton::ConstPointer skeleton = _skeleton;
+            AnimBlendType blendType = _blendType;
+            float baseFrame = _baseFrame;
+            _contentHash = networkAnim->getContentHash();
+            _baseContentHash = baseNetworkAnim->getContentHash();
+            _anim = AnimClipCache::getInstance().getFrames(getFramesKey(false), [&] {
+                auto anim = copyAndRetargetFromNetworkAnim(networkAnim, skeleton);
+
+                // copy & retarget baseAnim!
+                auto baseAnim = copyAndRetargetFromNetworkAnim(baseNetworkAnim, skeleton);
+
+                if (blendType == AnimBlendType_AddAbsolute) {
+                    bakeAbsoluteDeltaAnim(anim, baseAnim[(int)baseFrame], skeleton);
+                } else {
+                    // AnimBlendType_AddRelative
+                    bakeRelativeDeltaAnim(anim, baseAnim[(int)baseFrame]);
+                }
+                return anim;
+            });
 
             // we no longer need the actual animation resource anymore.
             _networkAnim.reset();
 
             // mirrorAnim will be re-built on demand, if needed.
             // TODO: handle mirrored relative animations.
-            _mirrorAnim.clear();
+            _mirrorAnim.reset();
 
             _poses.resize(_skeleton->getNumJoints());
-
-            // copy & retarget baseAnim!
-            auto baseAnim = copyAndRetargetFromNetworkAnim(_baseNetworkAnim, _skeleton);
-
-            if (_blendType == AnimBlendType_AddAbsolute) {
-                bakeAbsoluteDeltaAnim(_anim, baseAnim[(int)_baseFrame], _skeleton);
-            } else {
-                // AnimBlendType_AddRelative
-                bakeRelativeDeltaAnim(_anim, baseAnim[(int)_baseFrame]);
-            }
         }
     }
 
-    if (_anim.size()) {
+    if (_anim && _anim->size()) {
 
         // lazy creation of mirrored animation frames.
-        if (_mirrorFlag && _anim.size() != _mirrorAnim.size()) {
+        if (_mirrorFlag && !_mirrorAnim) {
             buildMirrorAnim();
         }
 
@@ -318,15 +333,12 @@ const AnimPoseVec& AnimClip::evaluate(const AnimVariantMap& animVars, const Anim
 
         // It can be quite possible for the user to set _startFrame and _endFrame to
         // values before or past valid ranges.  We clamp the frames here.
-        int frameCount = (int)_anim.size();
+        int frameCount = (int)_anim->size();
         prevIndex = std::min(std::max(0, prevIndex), frameCount - 1);
         nextIndex = std::min(std::max(0, nextIndex), frameCount - 1);
 
-        const AnimPoseVec& prevFrame = _mirrorFlag ? _mirrorAnim[prevIndex] : _anim[prevIndex];
-        const AnimPoseVec& nextFrame = _mirrorFlag ? _mirrorAnim[nextIndex] : _anim[nextIndex];
         float alpha = glm::fract(_frame);
-
-        ::blend(_poses.size(), &prevFrame[0], &nextFrame[0], alpha, &_poses[0]);
+        AnimClipCache::getInstance().sample(_mirrorFlag ? _mirrorAnim : _anim, prevIndex, nextIndex, alpha, _poses, this);
     }
 
     processOutputJoints(triggersOut);
@@ -342,14 +354,24 @@ void AnimClip::setCurrentFrameInternal(float frame) {
 }
 
 void AnimClip::buildMirrorAnim() {
-    assert(_skeleton);
+    assert(_skeleton && _anim);
+
+    AnimClipCache::FramesPointer anim = _anim;
+    AnimSkeleton::ConstPointer skeleton = _skeleton;
+    _mirrorAnim = AnimClipCache::getInstance().getFrames(getFramesKey(true), [&] {
+        AnimClipCache::Frames mirrorAnim;
+        mirrorAnim.reserve(anim->size());
+        for (auto& relPoses : *anim) {
+            mirrorAnim.push_back(relPoses);
+            skeleton->mirrorRelativePoses(mirrorAnim.back());
+        }
+        return mirrorAnim;
+    });
+}
 
-    _mirrorAnim.clear();
-    _mirrorAnim.reserve(_anim.size());
-    for (auto& relPoses : _anim) {
-        _mirrorAnim.push_back(relPoses);
-        _skeleton->mirrorRelativePoses(_mirrorAnim.back());
-    }
+AnimClipCache::FramesKey AnimClip::getFramesKey(bool mirror) const {
+    assert(_skeleton);
+    return { _skeleton->getHash(), _url, _contentHash, (int)_blendType, _baseURL, _baseContentHash, _baseFrame, mirror };
 }
 
 const AnimPoseVec& AnimClip::getPosesInternal() const {
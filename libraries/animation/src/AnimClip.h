@@ -13,6 +13,7 @@
 
 #include <string>
 #include "AnimationCache.h"
+#include "AnimClipCache.h"
 #include "AnimNode.h"
 
 // Playback a single animation timeline.
@@ -62,6 +63,7 @@ protected:
     virtual void setCurrentFrameInternal(float frame) override;
 
     void buildMirrorAnim();
+    AnimClipCache::FramesKey getFramesKey(bool mirror) const;
 
     // for AnimDebugDraw rendering
     virtual const AnimPoseVec& getPosesInternal() const override;
@@ -71,11 +73,12 @@ protected:
 
     AnimPoseVec _poses;
 
-    // _anim[frame][joint]
-    std::vector<AnimPoseVec> _anim;
-    std::vector<AnimPoseVec> _mirrorAnim;
+    // (*_anim)[frame][joint], shared with every other clip playing the same animation on the same skeleton.
+    AnimClipCache::FramesPointer _anim;
+    AnimClipCache::FramesPointer _mirrorAnim;
 
     QString _url;
+    uint64_t _contentHash { 0 }; // of the animation _anim was built from
     float _startFrame;
     float _endFrame;
     float _timeScale;
@@ -84,6 +87,7 @@ protected:
     float _frame;
     AnimBlendType _blendType;
     QString _baseURL;
+    uint64_t _baseContentHash { 0 };
     float _baseFrame;
 
     QString _startFrameVar;
@@ -0,0 +1,168 @@
+//
+//  AnimClipCache.cpp
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AnimClipCache.h"
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+#include "AnimUtil.h"
+
+// samples that haven't been used by any clip for this long are evicted.
+static const uint64_t SAMPLE_EXPIRY_USECS = 250 * USECS_PER_MSEC;
+static const uint64_t PRUNE_PERIOD_USECS = 100 * USECS_PER_MSEC;
+
+AnimClipCache& AnimClipCache::getInstance() {
+    static AnimClipCache instance;
+    return instance;
+}
+
+AnimClipCache::FramesPointer AnimClipCache::findFrames(const FramesKey& key) {
+    std::lock_guard<std::mutex> lock(_framesMutex);
+    auto iter = _frames.find(key);
+    if (iter != _frames.end()) {
+        FramesPointer frames = iter->second.lock();
+        if (!frames) {
+            _frames.erase(iter);
+        }
+        return frames;
+    }
+    return FramesPointer();
+}
+
+AnimClipCache::FramesPointer AnimClipCache::insertFrames(const FramesKey& key, FramesPointer frames) {
+    std::lock_guard<std::mutex> lock(_framesMutex);
+    // frames are rarely built, drop the ones no clip uses anymore while we're at it
+    for (auto iter = _frames.begin(); iter != _frames.end();) {
+        if (iter->second.expired()) {
+            iter = _frames.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    auto& entry = _frames[key];
+    FramesPointer existing = entry.lock();
+    if (existing) {
+        // another clip finished building the same frames first, share those.
+        return existing;
+    }
+    entry = frames;
+    return frames;
+}
+
+void AnimClipCache::sample(const FramesPointer& frames, int prevIndex, int nextIndex, float alpha, AnimPoseVec& posesOut,
+        const void* user) {
+    assert(frames && prevIndex >= 0 && nextIndex >= 0 && prevIndex < (int)frames->size() && nextIndex < (int)frames->size());
+
+    const AnimPoseVec& prevFrame = (*frames)[prevIndex];
+    const AnimPoseVec& nextFrame = (*frames)[nextIndex];
+    size_t numPoses = std::min(posesOut.size(), prevFrame.size());
+    if (numPoses == 0) {
+        return;
+    }
+
+    if (!_enabled || prevIndex == nextIndex) {
+        ::blend(numPoses, &prevFrame[0], &nextFrame[0], alpha, &posesOut[0]);
+        return;
+    }
+
+    int samplesPerFrame = _samplesPerFrame;
+    int step = (int)(alpha * (float)samplesPerFrame + 0.5f);
+    uint64_t now = usecTimestampNow();
+    SampleKey key { frames.get(), prevIndex, nextIndex, step, samplesPerFrame };
+    SampleShard& shard = getShard(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (now - shard.lastPruneTime > PRUNE_PERIOD_USECS) {
+            shard.prune(now);
+        }
+
+        Sample& sample = shard.samples[key];
+        if (!sample.frames) {
+            sample.frames = frames;
+        } else if (sample.lastUser != user) {
+            sample.lastShared = now;
+        }
+        sample.lastUser = user;
+        sample.lastUsed = now;
+
+        // a clip alone at this point of the frames keeps its exact alpha, so slowed down clips don't move in steps
+        bool isShared = sample.lastShared != 0 && now - sample.lastShared <= SAMPLE_EXPIRY_USECS;
+        if (!isShared) {
+            _sampleMisses++;
+            ::blend(numPoses, &prevFrame[0], &nextFrame[0], alpha, &posesOut[0]);
+            return;
+        }
+        if (!sample.poses.empty()) {
+            _sampleHits++;
+            const AnimPoseVec& poses = sample.poses;
+            std::copy(poses.begin(), poses.begin() + std::min(numPoses, poses.size()), posesOut.begin());
+            return;
+        }
+    }
+    _sampleMisses++;
+
+    // on either end of the quantization range no blend is needed at all.
+    if (step <= 0) {
+        std::copy(prevFrame.begin(), prevFrame.begin() + numPoses, posesOut.begin());
+    } else if (step >= samplesPerFrame) {
+        std::copy(nextFrame.begin(), nextFrame.begin() + numPoses, posesOut.begin());
+    } else {
+        float quantizedAlpha = (float)step / (float)samplesPerFrame;
+        ::blend(numPoses, &prevFrame[0], &nextFrame[0], quantizedAlpha, &posesOut[0]);
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.samples.find(key);
+    if (iter != shard.samples.end() && iter->second.poses.empty()) {
+        iter->second.poses.assign(posesOut.begin(), posesOut.begin() + numPoses);
+    }
+}
+
+AnimClipCache::SampleShard& AnimClipCache::getShard(const SampleKey& key) {
+    // the clips at different points of the same frames use different shards
+    size_t hash = std::hash<const Frames*>()(key.frames) ^ ((size_t)key.prevIndex * 0x9e3779b9u);
+    return _sampleShards[hash % NUM_SAMPLE_SHARDS];
+}
+
+void AnimClipCache::SampleShard::prune(uint64_t now) {
+    // assumes mutex is held
+    lastPruneTime = now;
+    for (auto iter = samples.begin(); iter != samples.end();) {
+        if (now - iter->second.lastUsed > SAMPLE_EXPIRY_USECS) {
+            iter = samples.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+AnimClipCache::Stats AnimClipCache::getStats() const {
+    Stats stats;
+    stats.frameHits = _frameHits;
+    stats.frameMisses = _frameMisses;
+    stats.sampleHits = _sampleHits;
+    stats.sampleMisses = _sampleMisses;
+    {
+        std::lock_guard<std::mutex> lock(_framesMutex);
+        stats.numFrameSets = (int)_frames.size();
+    }
+    for (auto& shard : _sampleShards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.numSamples += (int)shard.samples.size();
+    }
+    return stats;
+}
+
+void AnimClipCache::resetStats() {
+    _frameHits = 0;
+    _frameMisses = 0;
+    _sampleHits = 0;
+    _sampleMisses = 0;
+}
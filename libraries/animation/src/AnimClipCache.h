@@ -0,0 +1,158 @@
+//
+//  AnimClipCache.h
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AnimClipCache_h
+#define hifi_AnimClipCache_h
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include <QString>
+
+#include "AnimNode.h"
+
+// Process wide cache of AnimClip data, shared between every Rig.
+// Crowds of avatars with the same skeleton tend to play the same clips (idle, walk, sit...)
+// so both the retargeted animation frames and the per-frame clip samples can be shared:
+//   * retargeted frames are keyed by (skeleton, url, content, blend type, base url, base content, base frame, mirror) and
+//     live as long as any AnimClip uses them.  The content hashes keep a refreshed animation from getting stale frames.
+//   * clip samples are keyed by (frames, frame index, quantized frame fraction) and are evicted shortly after they stop being used.
+//     They are split between shards with a lock of their own, so that the clips of a crowd don't all wait on one lock.
+// Each avatar still evaluates its own state machines, IK and overlay nodes on top of the shared samples.
+class AnimClipCache {
+public:
+    using Frames = std::vector<AnimPoseVec>;
+    using FramesPointer = std::shared_ptr<const Frames>;
+
+    struct FramesKey {
+        uint64_t skeletonHash;
+        QString url;
+        uint64_t contentHash;
+        int blendType;
+        QString baseURL;
+        uint64_t baseContentHash;
+        float baseFrame;
+        bool mirror;
+
+        bool operator<(const FramesKey& other) const {
+            return std::tie(skeletonHash, url, contentHash, blendType, baseURL, baseContentHash, baseFrame, mirror) <
+                std::tie(other.skeletonHash, other.url, other.contentHash, other.blendType, other.baseURL,
+                         other.baseContentHash, other.baseFrame, other.mirror);
+        }
+    };
+
+    struct Stats {
+        uint64_t frameHits { 0 };
+        uint64_t frameMisses { 0 };
+        uint64_t sampleHits { 0 };
+        uint64_t sampleMisses { 0 };
+        int numFrameSets { 0 };
+        int numSamples { 0 };
+    };
+
+    static AnimClipCache& getInstance();
+
+    // returns the shared frames for key, or builds them with buildFrames() if no other clip has them.
+    template <typename F>
+    FramesPointer getFrames(const FramesKey& key, F buildFrames);
+
+    // fills posesOut with the blend of frames[prevIndex] and frames[nextIndex] at alpha, for user (the calling clip).
+    // While other users play the same frames at nearly the same point, alpha is quantized to 1 / getSamplesPerFrame()
+    // so that they all share one sample.  A clip no other user is at is blended exactly.
+    void sample(const FramesPointer& frames, int prevIndex, int nextIndex, float alpha, AnimPoseVec& posesOut,
+        const void* user);
+
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    bool isEnabled() const { return _enabled; }
+
+    // number of distinct samples kept between two animation frames, higher is more accurate but shares less.
+    void setSamplesPerFrame(int samplesPerFrame) { _samplesPerFrame = std::max(1, samplesPerFrame); }
+    int getSamplesPerFrame() const { return _samplesPerFrame; }
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    AnimClipCache() {}
+
+    FramesPointer findFrames(const FramesKey& key);
+    FramesPointer insertFrames(const FramesKey& key, FramesPointer frames);
+
+    struct SampleKey {
+        const Frames* frames;
+        int prevIndex;
+        int nextIndex;
+        int step;
+        int samplesPerFrame;
+
+        bool operator<(const SampleKey& other) const {
+            return std::tie(frames, prevIndex, nextIndex, step, samplesPerFrame) <
+                std::tie(other.frames, other.prevIndex, other.nextIndex, other.step, other.samplesPerFrame);
+        }
+    };
+
+    struct Sample {
+        FramesPointer frames; // keeps the frames alive, so the SampleKey pointer can't be reused while this sample exists
+        AnimPoseVec poses; // empty until the sample is shared
+        const void* lastUser { nullptr };
+        uint64_t lastUsed { 0 };
+        uint64_t lastShared { 0 }; // the last time a user other than the previous one asked for the sample
+    };
+
+    class SampleShard {
+    public:
+        void prune(uint64_t now);
+
+        std::mutex mutex;
+        std::map<SampleKey, Sample> samples;
+        uint64_t lastPruneTime { 0 };
+    };
+
+    static const int NUM_SAMPLE_SHARDS = 64;
+    SampleShard& getShard(const SampleKey& key);
+
+    mutable std::mutex _framesMutex;
+    std::map<FramesKey, std::weak_ptr<const Frames>> _frames;
+    mutable std::array<SampleShard, NUM_SAMPLE_SHARDS> _sampleShards;
+
+    std::atomic<bool> _enabled { true };
+    std::atomic<int> _samplesPerFrame { 4 };
+
+    std::atomic<uint64_t> _frameHits { 0 };
+    std::atomic<uint64_t> _frameMisses { 0 };
+    std::atomic<uint64_t> _sampleHits { 0 };
+    std::atomic<uint64_t> _sampleMisses { 0 };
+};
+
+template <typename F>
+AnimClipCache::FramesPointer AnimClipCache::getFrames(const FramesKey& key, F buildFrames) {
+    if (_enabled) {
+        FramesPointer frames = findFrames(key);
+        if (frames) {
+            _frameHits++;
+            return frames;
+        }
+    }
+    _frameMisses++;
+
+    // build outside of the lock, retargeting can be slow.
+    FramesPointer frames = std::make_shared<const Frames>(buildFrames());
+    if (_enabled) {
+        return insertFrames(key, frames);
+    }
+    return frames;
+}
+
+#endif // hifi_AnimClipCache_h
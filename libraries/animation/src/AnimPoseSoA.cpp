@@ -0,0 +1,318 @@
+//
+//  AnimPoseSoA.cpp
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AnimPoseSoA.h"
+
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
+#include <GLMHelpers.h>
+#include "AnimUtil.h"
+
+static const float UNIFORM_SCALE_EPSILON = 0.0001f;
+
+static inline AnimPose loadPose(int stride, const float* src, int i) {
+    return AnimPose(glm::vec3(src[AnimPoseSoA::ScaleX * stride + i], src[AnimPoseSoA::ScaleY * stride + i], src[AnimPoseSoA::ScaleZ * stride + i]),
+                    glm::quat(src[AnimPoseSoA::RotW * stride + i], src[AnimPoseSoA::RotX * stride + i],
+                              src[AnimPoseSoA::RotY * stride + i], src[AnimPoseSoA::RotZ * stride + i]),
+                    glm::vec3(src[AnimPoseSoA::TransX * stride + i], src[AnimPoseSoA::TransY * stride + i], src[AnimPoseSoA::TransZ * stride + i]));
+}
+
+static inline void storePose(int stride, float* dst, int i, const AnimPose& pose) {
+    dst[AnimPoseSoA::RotX * stride + i] = pose.rot().x;
+    dst[AnimPoseSoA::RotY * stride + i] = pose.rot().y;
+    dst[AnimPoseSoA::RotZ * stride + i] = pose.rot().z;
+    dst[AnimPoseSoA::RotW * stride + i] = pose.rot().w;
+    dst[AnimPoseSoA::TransX * stride + i] = pose.trans().x;
+    dst[AnimPoseSoA::TransY * stride + i] = pose.trans().y;
+    dst[AnimPoseSoA::TransZ * stride + i] = pose.trans().z;
+    dst[AnimPoseSoA::ScaleX * stride + i] = pose.scale().x;
+    dst[AnimPoseSoA::ScaleY * stride + i] = pose.scale().y;
+    dst[AnimPoseSoA::ScaleZ * stride + i] = pose.scale().z;
+}
+
+//
+// portable reference code
+//
+
+static void blendPoses_ref(int numPoses, int stride, const float* a, const float* b, float alpha, float* result) {
+    for (int i = 0; i < numPoses; i++) {
+        AnimPose aPose = loadPose(stride, a, i);
+        AnimPose bPose = loadPose(stride, b, i);
+        ::blend(1, &aPose, &bPose, alpha, &aPose);
+        storePose(stride, result, i, aPose);
+    }
+}
+
+static void blendPosesMasked_ref(int numPoses, int stride, const float* a, const float* b, const float* weights, float alpha,
+                                 float* result) {
+    for (int i = 0; i < numPoses; i++) {
+        AnimPose aPose = loadPose(stride, a, i);
+        AnimPose bPose = loadPose(stride, b, i);
+        ::blend(1, &aPose, &bPose, weights[i] * alpha, &aPose);
+        storePose(stride, result, i, aPose);
+    }
+}
+
+static void blendAddPoses_ref(int numPoses, int stride, const float* a, const float* b, float alpha, float* result) {
+    for (int i = 0; i < numPoses; i++) {
+        AnimPose aPose = loadPose(stride, a, i);
+        AnimPose bPose = loadPose(stride, b, i);
+        ::blendAdd(1, &aPose, &bPose, alpha, &aPose);
+        storePose(stride, result, i, aPose);
+    }
+}
+
+// joints[k] has the parent parents[k], which isn't in joints.  Root joints, with a negative parent, use rootPose,
+// stored as a single pose with a stride of 1.
+static void relativeToAbsolute_ref(int numJoints, const int* joints, const int* parents, int stride, const float* rootPose,
+                                   float* data) {
+    for (int k = 0; k < numJoints; k++) {
+        AnimPose parent = parents[k] < 0 ? loadPose(1, rootPose, 0) : loadPose(stride, data, parents[k]);
+        AnimPose child = loadPose(stride, data, joints[k]);
+
+        // with uniform scale, parent * child is a plain TRS composition.
+        glm::quat rot = glm::normalize(parent.rot() * child.rot());
+        glm::vec3 trans = parent.trans() + parent.rot() * (parent.scale() * child.trans());
+        storePose(stride, data, joints[k], AnimPose(child.scale() * parent.scale(), rot, trans));
+    }
+}
+
+static void absoluteToRelative_ref(int numJoints, const int* joints, const int* parents, int stride, const float* rootPose,
+                                   float* data) {
+    for (int k = 0; k < numJoints; k++) {
+        AnimPose parent = parents[k] < 0 ? loadPose(1, rootPose, 0) : loadPose(stride, data, parents[k]);
+        AnimPose child = loadPose(stride, data, joints[k]);
+
+        // absolute rotations are normalized, so the conjugate is the inverse
+        glm::quat invRot = glm::conjugate(parent.rot());
+        glm::quat rot = glm::normalize(invRot * child.rot());
+        glm::vec3 trans = invRot * ((child.trans() - parent.trans()) / parent.scale());
+        storePose(stride, data, joints[k], AnimPose(child.scale() / parent.scale(), rot, trans));
+    }
+}
+
+static void posesToMatrices_ref(int numPoses, int stride, const float* src, float (*matrices)[16]) {
+    for (int i = 0; i < numPoses; i++) {
+        glm::mat4 m = loadPose(stride, src, i);
+        memcpy(matrices[i], glm::value_ptr(m), sizeof(float) * 16);
+    }
+}
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+//
+// Runtime CPU dispatch
+//
+#include <CPUDetect.h>
+
+void blendPoses_AVX2(int numPoses, int stride, const float* a, const float* b, float alpha, float* result);
+void blendPosesMasked_AVX2(int numPoses, int stride, const float* a, const float* b, const float* weights, float alpha,
+                           float* result);
+void blendAddPoses_AVX2(int numPoses, int stride, const float* a, const float* b, float alpha, float* result);
+void posesToMatrices_AVX2(int numPoses, int stride, const float* src, float (*matrices)[16]);
+void relativeToAbsolute_AVX2(int numJoints, const int* joints, const int* parents, int stride, const float* rootPose,
+                             float* data);
+void absoluteToRelative_AVX2(int numJoints, const int* joints, const int* parents, int stride, const float* rootPose,
+                             float* data);
+
+static void blendPoses(int numPoses, int stride, const float* a, const float* b, float alpha, float* result) {
+    static auto f = cpuSupportsAVX2() ? blendPoses_AVX2 : blendPoses_ref;
+    (*f)(numPoses, stride, a, b, alpha, result); // dispatch
+}
+
+static void blendPosesMasked(int numPoses, int stride, const float* a, const float* b, const float* weights, float alpha,
+                             float* result) {
+    static auto f = cpuSupportsAVX2() ? blendPosesMasked_AVX2 : blendPosesMasked_ref;
+    (*f)(numPoses, stride, a, b, weights, alpha, result); // dispatch
+}
+
+static void blendAddPoses(int numPoses, int stride, const float* a, const float* b, float alpha, float* result) {
+    static auto f = cpuSupportsAVX2() ? blendAddPoses_AVX2 : blendAddPoses_ref;
+    (*f)(numPoses, stride, a, b, alpha, result); // dispatch
+}
+
+static void posesToMatrices(int numPoses, int stride, const float* src, float (*matrices)[16]) {
+    static auto f = cpuSupportsAVX2() ? posesToMatrices_AVX2 : posesToMatrices_ref;
+    (*f)(numPoses, stride, src, matrices); // dispatch
+}
+
+static void relativeToAbsolute(int numJoints, const int* joints, const int* parents, int stride, const float* rootPose,
+                               float* data) {
+    static auto f = cpuSupportsAVX2() ? relativeToAbsolute_AVX2 : relativeToAbsolute_ref;
+    (*f)(numJoints, joints, parents, stride, rootPose, data); // dispatch
+}
+
+static void absoluteToRelative(int numJoints, const int* joints, const int* parents, int stride, const float* rootPose,
+                               float* data) {
+    static auto f = cpuSupportsAVX2() ? absoluteToRelative_AVX2 : absoluteToRelative_ref;
+    (*f)(numJoints, joints, parents, stride, rootPose, data); // dispatch
+}
+
+#else   // portable reference code
+static auto& blendPoses = blendPoses_ref;
+static auto& blendPosesMasked = blendPosesMasked_ref;
+static auto& blendAddPoses = blendAddPoses_ref;
+static auto& posesToMatrices = posesToMatrices_ref;
+static auto& relativeToAbsolute = relativeToAbsolute_ref;
+static auto& absoluteToRelative = absoluteToRelative_ref;
+#endif
+
+namespace {
+
+// The joints of a skeleton ordered by their depth, so that the parents of the joints of a level are all in the levels
+// above it.  The joints of a level can then be converted in any order, eight at a time.
+class JointLevels {
+public:
+    void build(const std::vector<int>& parentIndices, int numJoints) {
+        depths.resize(numJoints);
+        levelOffsets.assign(1, 0);
+        for (int i = 0; i < numJoints; i++) {
+            int parentIndex = parentIndices[i];
+            assert(parentIndex < i);
+            int depth = parentIndex < 0 ? 0 : depths[parentIndex] + 1;
+            depths[i] = depth;
+            if (depth + 2 > (int)levelOffsets.size()) {
+                levelOffsets.resize(depth + 2, 0);
+            }
+            levelOffsets[depth + 1]++;
+        }
+        for (size_t level = 1; level < levelOffsets.size(); level++) {
+            levelOffsets[level] += levelOffsets[level - 1];
+        }
+
+        joints.resize(numJoints);
+        parents.resize(numJoints);
+        nextOffsets.assign(levelOffsets.begin(), levelOffsets.end() - 1);
+        for (int i = 0; i < numJoints; i++) {
+            int offset = nextOffsets[depths[i]]++;
+            joints[offset] = i;
+            parents[offset] = parentIndices[i];
+        }
+    }
+
+    int getNumLevels() const { return (int)levelOffsets.size() - 1; }
+
+    std::vector<int> joints;
+    std::vector<int> parents;       // parents[k] is the parent of joints[k]
+    std::vector<int> levelOffsets;  // the joints of level l are in [levelOffsets[l], levelOffsets[l + 1])
+
+private:
+    std::vector<int> depths;
+    std::vector<int> nextOffsets;
+};
+
+// rebuilt for every conversion, which is cheap next to the conversion itself
+thread_local JointLevels jointLevels;
+
+}
+
+void AnimPoseSoA::resize(int numPoses) {
+    int stride = (numPoses + SIMD_WIDTH - 1) & ~(SIMD_WIDTH - 1);
+    if (stride != _stride) {
+        // the padding must always hold identity poses, so that kernels can safely process whole blocks.
+        _data.assign(NumComponents * stride, 0.0f);
+        std::fill(_data.begin() + RotW * stride, _data.begin() + (RotW + 1) * stride, 1.0f);
+        std::fill(_data.begin() + ScaleX * stride, _data.end(), 1.0f);
+        _stride = stride;
+    }
+    _size = numPoses;
+}
+
+void AnimPoseSoA::setPoses(const AnimPose* poses, int numPoses) {
+    resize(numPoses);
+    for (int i = 0; i < numPoses; i++) {
+        storePose(_stride, _data.data(), i, poses[i]);
+    }
+}
+
+void AnimPoseSoA::getPoses(AnimPose* posesOut) const {
+    for (int i = 0; i < _size; i++) {
+        posesOut[i] = loadPose(_stride, _data.data(), i);
+    }
+}
+
+void AnimPoseSoA::getPoses(AnimPoseVec& posesOut) const {
+    posesOut.resize(_size);
+    getPoses(posesOut.data());
+}
+
+AnimPose AnimPoseSoA::getPose(int index) const {
+    assert(index >= 0 && index < _size);
+    return loadPose(_stride, _data.data(), index);
+}
+
+void AnimPoseSoA::setPose(int index, const AnimPose& pose) {
+    assert(index >= 0 && index < _size);
+    storePose(_stride, _data.data(), index, pose);
+}
+
+bool AnimPoseSoA::isUniformPositiveScale(const glm::vec3& scale) {
+    return scale.x > 0.0f && fabsf(scale.x - scale.y) <= UNIFORM_SCALE_EPSILON * scale.x &&
+        fabsf(scale.x - scale.z) <= UNIFORM_SCALE_EPSILON * scale.x;
+}
+
+bool AnimPoseSoA::hasUniformPositiveScale() const {
+    const float* sx = stream(ScaleX);
+    const float* sy = stream(ScaleY);
+    const float* sz = stream(ScaleZ);
+    for (int i = 0; i < _size; i++) {
+        if (!isUniformPositiveScale(glm::vec3(sx[i], sy[i], sz[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AnimPoseSoA::convertRelativeToAbsolute(const std::vector<int>& parentIndices, const AnimPose& rootPose) {
+    float root[NumComponents];
+    storePose(1, root, 0, rootPose);
+    jointLevels.build(parentIndices, std::min(_size, (int)parentIndices.size()));
+
+    // parents first
+    for (int level = 0; level < jointLevels.getNumLevels(); level++) {
+        int offset = jointLevels.levelOffsets[level];
+        relativeToAbsolute(jointLevels.levelOffsets[level + 1] - offset, &jointLevels.joints[offset],
+                           &jointLevels.parents[offset], _stride, root, _data.data());
+    }
+}
+
+void AnimPoseSoA::convertAbsoluteToRelative(const std::vector<int>& parentIndices, const AnimPose& rootPose) {
+    float root[NumComponents];
+    storePose(1, root, 0, rootPose);
+    jointLevels.build(parentIndices, std::min(_size, (int)parentIndices.size()));
+
+    // children first, so that their parents are still absolute
+    for (int level = jointLevels.getNumLevels() - 1; level >= 0; level--) {
+        int offset = jointLevels.levelOffsets[level];
+        absoluteToRelative(jointLevels.levelOffsets[level + 1] - offset, &jointLevels.joints[offset],
+                           &jointLevels.parents[offset], _stride, root, _data.data());
+    }
+}
+
+void AnimPoseSoA::buildMatrices(glm::mat4* matricesOut) const {
+    static_assert(sizeof(glm::mat4) == 16 * sizeof(float), "glm::mat4 size doesn't match.");
+    posesToMatrices(_size, _stride, _data.data(), (float(*)[16])matricesOut);
+}
+
+void blend(const AnimPoseSoA& a, const AnimPoseSoA& b, float alpha, AnimPoseSoA& result) {
+    assert(a.size() == b.size());
+    result.resize(a.size());
+    blendPoses(a.size(), a.stride(), a.data(), b.data(), alpha, result.data());
+}
+
+void blendMasked(const AnimPoseSoA& a, const AnimPoseSoA& b, const float* weights, float alpha, AnimPoseSoA& result) {
+    assert(a.size() == b.size());
+    result.resize(a.size());
+    blendPosesMasked(a.size(), a.stride(), a.data(), b.data(), weights, alpha, result.data());
+}
+
+void blendAdd(const AnimPoseSoA& a, const AnimPoseSoA& b, float alpha, AnimPoseSoA& result) {
+    assert(a.size() == b.size());
+    result.resize(a.size());
+    blendAddPoses(a.size(), a.stride(), a.data(), b.data(), alpha, result.data());
+}
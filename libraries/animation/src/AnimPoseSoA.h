@@ -0,0 +1,91 @@
+//
+//  AnimPoseSoA.h
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AnimPoseSoA
+#define hifi_AnimPoseSoA
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "AnimPose.h"
+
+// Structure-of-arrays storage for a set of AnimPoses.
+// Each pose component (rotation x,y,z,w, translation x,y,z and scale x,y,z) lives in its own contiguous stream,
+// so that blending and matrix generation can process eight joints at a time with AVX2.
+// All streams share the same stride, which is padded to a multiple of SIMD_WIDTH.
+class AnimPoseSoA {
+public:
+    enum Component {
+        RotX = 0,
+        RotY,
+        RotZ,
+        RotW,
+        TransX,
+        TransY,
+        TransZ,
+        ScaleX,
+        ScaleY,
+        ScaleZ,
+        NumComponents
+    };
+
+    static const int SIMD_WIDTH = 8;
+    // below this many poses, transposing into AnimPoseSoA costs more than the simd kernels save.
+    static const int MIN_SOA_POSES = 16;
+
+    AnimPoseSoA() {}
+    explicit AnimPoseSoA(const AnimPoseVec& poses) { setPoses(poses.data(), (int)poses.size()); }
+
+    void resize(int numPoses);
+    int size() const { return _size; }
+    int stride() const { return _stride; }
+
+    void setPoses(const AnimPose* poses, int numPoses);
+    void setPoses(const AnimPoseVec& poses) { setPoses(poses.data(), (int)poses.size()); }
+    void getPoses(AnimPose* posesOut) const;
+    void getPoses(AnimPoseVec& posesOut) const;
+
+    AnimPose getPose(int index) const;
+    void setPose(int index, const AnimPose& pose);
+
+    float* data() { return _data.data(); }
+    const float* data() const { return _data.data(); }
+    float* stream(Component component) { return _data.data() + component * _stride; }
+    const float* stream(Component component) const { return _data.data() + component * _stride; }
+
+    // true if every pose has a positive, uniform scale.
+    // AnimPose composition through glm::mat4 reduces to plain TRS composition in that case.
+    bool hasUniformPositiveScale() const;
+    static bool isUniformPositiveScale(const glm::vec3& scale);
+
+    // poses start off relative and leave in absolute frame.
+    // parentIndices[i] must be less than i, or -1 for root joints, which are transformed by rootPose.
+    // The joints are converted a level of the skeleton at a time, as the joints of a level don't depend on each other.
+    // NOTE: only valid when both hasUniformPositiveScale() and rootPose have uniform, positive scale.
+    void convertRelativeToAbsolute(const std::vector<int>& parentIndices, const AnimPose& rootPose);
+
+    // the inverse of convertRelativeToAbsolute(), with the same restrictions.
+    void convertAbsoluteToRelative(const std::vector<int>& parentIndices, const AnimPose& rootPose);
+
+    // equivalent to static_cast<glm::mat4>(getPose(i)) for each pose.
+    void buildMatrices(glm::mat4* matricesOut) const;
+
+private:
+    std::vector<float> _data;
+    int _size { 0 };
+    int _stride { 0 };
+};
+
+// SoA equivalents of the blend functions in AnimUtil.h.
+// a, b and result must all have the same size, result may alias a or b.
+void blend(const AnimPoseSoA& a, const AnimPoseSoA& b, float alpha, AnimPoseSoA& result);
+void blendMasked(const AnimPoseSoA& a, const AnimPoseSoA& b, const float* weights, float alpha, AnimPoseSoA& result);
+void blendAdd(const AnimPoseSoA& a, const AnimPoseSoA& b, float alpha, AnimPoseSoA& result);
+
+#endif
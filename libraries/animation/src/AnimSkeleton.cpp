@@ -13,8 +13,10 @@
 #include <glm/gtx/transform.hpp>
 
 #include <GLMHelpers.h>
+#include <HashKey.h>
 
 #include "AnimationLogging.h"
+#include "AnimPoseSoA.h"
 
 AnimSkeleton::AnimSkeleton(const HFMModel& hfmModel) {
 
@@ -87,6 +89,27 @@ int AnimSkeleton::getChainDepth(int jointIndex) const {
     }
 }
 
+uint64_t AnimSkeleton::computeHash() const {
+    // hash the exact bits, nearly identical skeletons must not share retargeted animations.
+    HashKey::Hasher hasher;
+    auto hashFloats = [&](const float* data, int count) {
+        for (int i = 0; i < count; i++) {
+            hasher.hashUint64(glm::floatBitsToUint(data[i]));
+        }
+    };
+    for (int i = 0; i < _jointsSize; i++) {
+        hasher.hashUint64(qHash(_joints[i].name));
+        hasher.hashUint64((uint64_t)(int64_t)_parentIndices[i]);
+        const AnimPose& pose = _relativeDefaultPoses[i];
+        hashFloats(&pose.rot().x, 4);
+        hashFloats(&pose.trans().x, 3);
+        hashFloats(&pose.scale().x, 3);
+    }
+    hashFloats(&_geometryOffset[0][0], 16);
+    uint64_t hash = hasher.getHash64();
+    return hash != 0 ? hash : 1;
+}
+
 const AnimPose& AnimSkeleton::getRelativeDefaultPose(int jointIndex) const {
     return _relativeDefaultPoses[jointIndex];
 }
@@ -130,8 +153,26 @@ AnimPose AnimSkeleton::getAbsolutePose(int jointIndex, const AnimPoseVec& relati
     }
 }
 
+// With uniform scale, the conversions between relative and absolute poses are plain TRS compositions, done in SoA form
+// a level of the skeleton at a time, instead of going through a glm::mat4 multiply and decomposition per joint.
+static AnimPoseSoA* getUniformScaleSoAPoses(const AnimPoseVec& poses) {
+    static thread_local AnimPoseSoA soaPoses;
+    if ((int)poses.size() < AnimPoseSoA::MIN_SOA_POSES) {
+        return nullptr;
+    }
+    soaPoses.setPoses(poses);
+    return soaPoses.hasUniformPositiveScale() ? &soaPoses : nullptr;
+}
+
 void AnimSkeleton::convertRelativePosesToAbsolute(AnimPoseVec& poses) const {
     // poses start off relative and leave in absolute frame
+    AnimPoseSoA* soaPoses = getUniformScaleSoAPoses(poses);
+    if (soaPoses) {
+        soaPoses->convertRelativeToAbsolute(_parentIndices, AnimPose::identity);
+        soaPoses->getPoses(poses);
+        return;
+    }
+
     int lastIndex = std::min((int)poses.size(), _jointsSize);
     for (int i = 0; i < lastIndex; ++i) {
         int parentIndex = _parentIndices[i];
@@ -143,6 +184,13 @@ void AnimSkeleton::convertRelativePosesToAbsolute(AnimPoseVec& poses) const {
 
 void AnimSkeleton::convertAbsolutePosesToRelative(AnimPoseVec& poses) const {
     // poses start off absolute and leave in relative frame
+    AnimPoseSoA* soaPoses = getUniformScaleSoAPoses(poses);
+    if (soaPoses) {
+        soaPoses->convertAbsoluteToRelative(_parentIndices, AnimPose::identity);
+        soaPoses->getPoses(poses);
+        return;
+    }
+
     int lastIndex = std::min((int)poses.size(), _jointsSize);
     for (int i = lastIndex - 1; i >= 0; --i) {
         int parentIndex = _parentIndices[i];
@@ -294,6 +342,9 @@ void AnimSkeleton::buildSkeletonFromJoints(const std::vector<HFMJoint>& joints,
             _mirrorMap.push_back(i);
         }
     }
+
+    // the skeleton doesn't change after this, hash it now so that any thread can read it
+    _hash = computeHash();
 }
 
 void AnimSkeleton::dump(bool verbose) const {
@@ -49,6 +49,7 @@ public:
     int getParentIndex(int jointIndex) const {
         return _parentIndices[jointIndex];
     }
+    const std::vector<int>& getParentIndices() const { return _parentIndices; }
 
     std::vector<int> getChildrenOfJoint(int jointIndex) const;
 
@@ -70,10 +71,15 @@ public:
     void dump(const AnimPoseVec& poses) const;
 
     std::vector<int> lookUpJointIndices(const std::vector<QString>& jointNames) const;
+
+    // identifies skeletons with the same joints, hierarchy, default poses and geometry offset.
+    // used to share retargeted animation data between avatars with the same skeleton.
+    uint64_t getHash() const { return _hash; }
     const HFMCluster getClusterBindMatricesOriginalValues(const int meshIndex, const int clusterIndex) const { return _clusterBindMatrixOriginalValues[meshIndex][clusterIndex]; }
 
 protected:
     void buildSkeletonFromJoints(const std::vector<HFMJoint>& joints, const QMap<int, glm::quat> jointOffsets);
+    uint64_t computeHash() const;
 
     std::vector<HFMJoint> _joints;
     std::vector<int> _parentIndices;
@@ -88,6 +94,7 @@ protected:
     QHash<QString, int> _jointIndicesByName;
     std::vector<std::vector<HFMCluster>> _clusterBindMatrixOriginalValues;
     glm::mat4 _geometryOffset;
+    uint64_t _hash { 0 };
 
     // no copies
     AnimSkeleton(const AnimSkeleton&) = delete;
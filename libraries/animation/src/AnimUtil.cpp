@@ -9,13 +9,25 @@
 //
 
 #include "AnimUtil.h"
+#include "AnimPoseSoA.h"
 #include <GLMHelpers.h>
 #include <NumericalConstants.h>
 #include <DebugDraw.h>
 
+// scratch buffers for the SoA blend path, blending can happen on the main thread as well as agent threads.
+static thread_local AnimPoseSoA soaScratchA;
+static thread_local AnimPoseSoA soaScratchB;
+
 // TODO: use restrict keyword
-// TODO: excellent candidate for simd vectorization.
 void blend(size_t numPoses, const AnimPose* a, const AnimPose* b, float alpha, AnimPose* result) {
+    if (numPoses >= (size_t)AnimPoseSoA::MIN_SOA_POSES) {
+        soaScratchA.setPoses(a, (int)numPoses);
+        soaScratchB.setPoses(b, (int)numPoses);
+        ::blend(soaScratchA, soaScratchB, alpha, soaScratchA);
+        soaScratchA.getPoses(result);
+        return;
+    }
+
     for (size_t i = 0; i < numPoses; i++) {
         const AnimPose& aPose = a[i];
         const AnimPose& bPose = b[i];
@@ -51,8 +63,29 @@ void blend4(size_t numPoses, const AnimPose* a, const AnimPose* b, const AnimPos
     }
 }
 
+void blendMasked(size_t numPoses, const AnimPose* a, const AnimPose* b, const float* weights, float alpha, AnimPose* result) {
+    if (numPoses >= (size_t)AnimPoseSoA::MIN_SOA_POSES) {
+        soaScratchA.setPoses(a, (int)numPoses);
+        soaScratchB.setPoses(b, (int)numPoses);
+        ::blendMasked(soaScratchA, soaScratchB, weights, alpha, soaScratchA);
+        soaScratchA.getPoses(result);
+        return;
+    }
+
+    for (size_t i = 0; i < numPoses; i++) {
+        ::blend(1, &a[i], &b[i], weights[i] * alpha, &result[i]);
+    }
+}
+
 // additive blend
 void blendAdd(size_t numPoses, const AnimPose* a, const AnimPose* b, float alpha, AnimPose* result) {
+    if (numPoses >= (size_t)AnimPoseSoA::MIN_SOA_POSES) {
+        soaScratchA.setPoses(a, (int)numPoses);
+        soaScratchB.setPoses(b, (int)numPoses);
+        ::blendAdd(soaScratchA, soaScratchB, alpha, soaScratchA);
+        soaScratchA.getPoses(result);
+        return;
+    }
 
     const glm::vec3 IDENTITY_SCALE = glm::vec3(1.0f);
     const glm::quat IDENTITY_ROT = glm::quat();
@@ -22,6 +22,9 @@ void blend3(size_t numPoses, const AnimPose* a, const AnimPose* b, const AnimPos
 // blend between four sets of poses
 void blend4(size_t numPoses, const AnimPose* a, const AnimPose* b, const AnimPose* c, const AnimPose* d, float* alphas, AnimPose* result);
 
+// blend with a per-pose weight, each pose is blended by weights[i] * alpha
+void blendMasked(size_t numPoses, const AnimPose* a, const AnimPose* b, const float* weights, float alpha, AnimPose* result);
+
 // additive blending
 void blendAdd(size_t numPoses, const AnimPose* a, const AnimPose* b, float alpha, AnimPose* result);
 
@@ -11,10 +11,11 @@
 
 #include "AnimationCache.h"
 
+#include <QCryptographicHash>
 #include <QRunnable>
-#include <QThreadPool>
 
 #include <shared/QtHelpers.h>
+#include <JobScheduler.h>
 #include <Trace.h>
 #include <StatTracker.h>
 #include <Profile.h>
@@ -128,15 +129,20 @@ const QVector<HFMAnimationFrame>& Animation::getFramesReference() const {
 }
 
 void Animation::downloadFinished(const QByteArray& data) {
+    // the hash goes with the model once it is parsed
+    QByteArray digest = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    memcpy(&_downloadedContentHash, digest.constData(), sizeof(_downloadedContentHash));
+
     // parse the animation/fbx file on a background thread.
     AnimationReader* animationReader = new AnimationReader(_url, data);
     connect(animationReader, SIGNAL(onSuccess(HFMModel::Pointer)), SLOT(animationParseSuccess(HFMModel::Pointer)));
     connect(animationReader, SIGNAL(onError(int, QString)), SLOT(animationParseError(int, QString)));
-    QThreadPool::globalInstance()->start(animationReader);
+    JobScheduler::getInstance().submit(JobScheduler::Category::Animation, animationReader);
 }
 
 void Animation::animationParseSuccess(HFMModel::Pointer hfmModel) {
     _hfmModel = hfmModel;
+    _contentHash = _downloadedContentHash;
     finishedLoading(true);
 }
 
@@ -51,13 +51,16 @@ class Animation : public Resource {
 
 public:
 
-    Animation(const Animation& other) : Resource(other), _hfmModel(other._hfmModel) {}
+    Animation(const Animation& other) : Resource(other), _hfmModel(other._hfmModel), _contentHash(other._contentHash) {}
     Animation(const QUrl& url) : Resource(url) {}
 
     QString getType() const override { return "Animation"; }
 
     const HFMModel& getHFMModel() const { return *_hfmModel; }
 
+    // identifies the contents the animation was loaded from, which change when the resource is refreshed
+    uint64_t getContentHash() const { return _contentHash; }
+
     virtual bool isLoaded() const override;
 
     Q_INVOKABLE QStringList getJointNames() const;
@@ -76,6 +79,8 @@ protected slots:
 private:
     
     HFMModel::Pointer _hfmModel;
+    uint64_t _contentHash { 0 };
+    uint64_t _downloadedContentHash { 0 };
 };
 
 /// Reads geometry in a worker thread.
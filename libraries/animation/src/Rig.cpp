@@ -28,6 +28,7 @@
 #include "AnimClip.h"
 #include "AnimInverseKinematics.h"
 #include "AnimOverlay.h"
+#include "AnimPoseSoA.h"
 #include "AnimSkeleton.h"
 #include "AnimStateMachine.h"
 #include "AnimUtil.h"
@@ -1710,8 +1711,9 @@ void Rig::updateAnimations(float deltaTime, const glm::mat4& rootTransform, cons
                 alpha = _computeNetworkAnimation ? (_networkAnimState.blendTime / TOTAL_BLEND_TIME) : (1.0f - (_networkAnimState.blendTime / TOTAL_BLEND_TIME));
                 alpha = glm::clamp(alpha, 0.0f, 1.0f);
                 size_t numJoints = std::min(_networkPoseSet._relativePoses.size(), _internalPoseSet._relativePoses.size());
-                for (size_t i = 0; i < numJoints; i++) {
-                    _networkPoseSet._relativePoses[i].blend(_internalPoseSet._relativePoses[i], alpha);
+                if (numJoints > 0) {
+                    ::blend(numJoints, &_internalPoseSet._relativePoses[0], &_networkPoseSet._relativePoses[0], alpha,
+                            &_networkPoseSet._relativePoses[0]);
                 }
             }
         }
@@ -2557,6 +2559,17 @@ void Rig::buildAbsoluteRigPoses(const AnimPoseVec& relativePoses, AnimPoseVec& a
 
     absolutePosesOut.resize(relativePoses.size());
     AnimPose geometryToRigTransform(_geometryToRigTransform);
+
+    // fast path: with uniform scale, the absolute poses can be built with plain TRS composition in SoA form,
+    // instead of going through a glm::mat4 multiply and decomposition per joint.
+    static thread_local AnimPoseSoA soaPoses;
+    soaPoses.setPoses(relativePoses);
+    if (AnimPoseSoA::isUniformPositiveScale(geometryToRigTransform.scale()) && soaPoses.hasUniformPositiveScale()) {
+        soaPoses.convertRelativeToAbsolute(_animSkeleton->getParentIndices(), geometryToRigTransform);
+        soaPoses.getPoses(absolutePosesOut);
+        return;
+    }
+
     for (int i = 0; i < (int)relativePoses.size(); i++) {
         int parentIndex = _animSkeleton->getParentIndex(i);
         if (parentIndex == -1) {
@@ -2595,6 +2608,15 @@ glm::mat4 Rig::getJointTransform(int jointIndex) const {
     }
 }
 
+void Rig::getJointTransforms(std::vector<glm::mat4>& transformsOut) const {
+    static thread_local AnimPoseSoA soaPoses;
+    soaPoses.setPoses(_internalPoseSet._absolutePoses);
+    transformsOut.resize(_internalPoseSet._absolutePoses.size());
+    if (!transformsOut.empty()) {
+        soaPoses.buildMatrices(&transformsOut[0]);
+    }
+}
+
 AnimPose Rig::getJointPose(int jointIndex) const {
     if (isIndexValid(jointIndex)) {
         return _internalPoseSet._absolutePoses[jointIndex];
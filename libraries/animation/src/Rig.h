@@ -190,6 +190,9 @@ public:
     glm::mat4 getJointTransform(int jointIndex) const;
     AnimPose getJointPose(int jointIndex) const;
 
+    // rig space, all joints at once. cheaper than calling getJointTransform() for every joint.
+    void getJointTransforms(std::vector<glm::mat4>& transformsOut) const;
+
     // Start or stop animations as needed.
     void computeMotionAnimationState(float deltaTime, const glm::vec3& worldPosition, const glm::vec3& worldVelocity,
                                      const glm::quat& worldRotation, CharacterControllerState ccState, float sensorToWorldScale);
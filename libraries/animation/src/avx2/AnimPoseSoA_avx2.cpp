@@ -0,0 +1,386 @@
+//
+//  AnimPoseSoA_avx2.cpp
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifdef __AVX2__
+
+#include <immintrin.h>
+
+//
+// Pose streams are laid out as in AnimPoseSoA:
+// [rotX, rotY, rotZ, rotW, transX, transY, transZ, scaleX, scaleY, scaleZ], each stream is stride floats long.
+// stride is a multiple of 8, and the padding is filled with identity poses.
+//
+
+enum { ROT_X = 0, ROT_Y, ROT_Z, ROT_W, TRANS_X, TRANS_Y, TRANS_Z, SCALE_X, SCALE_Y, SCALE_Z, NUM_COMPONENTS };
+
+static inline __m256 lerp8(__m256 a, __m256 b, __m256 alpha) {
+    // a + alpha * (b - a)
+    return _mm256_fmadd_ps(alpha, _mm256_sub_ps(b, a), a);
+}
+
+// normalize a quaternion, returns identity for zero length quaternions, as glm::normalize does.
+static inline void normalize8(__m256& x, __m256& y, __m256& z, __m256& w) {
+    __m256 len2 = _mm256_mul_ps(x, x);
+    len2 = _mm256_fmadd_ps(y, y, len2);
+    len2 = _mm256_fmadd_ps(z, z, len2);
+    len2 = _mm256_fmadd_ps(w, w, len2);
+
+    __m256 mask = _mm256_cmp_ps(len2, _mm256_setzero_ps(), _CMP_LE_OQ);
+    __m256 rcp = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(len2));
+
+    x = _mm256_blendv_ps(_mm256_mul_ps(x, rcp), _mm256_setzero_ps(), mask);
+    y = _mm256_blendv_ps(_mm256_mul_ps(y, rcp), _mm256_setzero_ps(), mask);
+    z = _mm256_blendv_ps(_mm256_mul_ps(z, rcp), _mm256_setzero_ps(), mask);
+    w = _mm256_blendv_ps(_mm256_mul_ps(w, rcp), _mm256_set1_ps(1.0f), mask);
+}
+
+// r = a * b, as glm multiplies quaternions
+static inline void quatMul8(__m256 ax, __m256 ay, __m256 az, __m256 aw, __m256 bx, __m256 by, __m256 bz, __m256 bw,
+                            __m256& rx, __m256& ry, __m256& rz, __m256& rw) {
+    rw = _mm256_mul_ps(aw, bw);
+    rw = _mm256_fnmadd_ps(ax, bx, rw);
+    rw = _mm256_fnmadd_ps(ay, by, rw);
+    rw = _mm256_fnmadd_ps(az, bz, rw);
+
+    rx = _mm256_mul_ps(aw, bx);
+    rx = _mm256_fmadd_ps(ax, bw, rx);
+    rx = _mm256_fmadd_ps(ay, bz, rx);
+    rx = _mm256_fnmadd_ps(az, by, rx);
+
+    ry = _mm256_mul_ps(aw, by);
+    ry = _mm256_fnmadd_ps(ax, bz, ry);
+    ry = _mm256_fmadd_ps(ay, bw, ry);
+    ry = _mm256_fmadd_ps(az, bx, ry);
+
+    rz = _mm256_mul_ps(aw, bz);
+    rz = _mm256_fmadd_ps(ax, by, rz);
+    rz = _mm256_fnmadd_ps(ay, bx, rz);
+    rz = _mm256_fmadd_ps(az, bw, rz);
+}
+
+// v = q * v for a unit quaternion q, as glm rotates vectors: v + 2 * (w * (q x v) + q x (q x v))
+static inline void rotate8(__m256 qx, __m256 qy, __m256 qz, __m256 qw, __m256& vx, __m256& vy, __m256& vz) {
+    __m256 uvx = _mm256_fmsub_ps(qy, vz, _mm256_mul_ps(qz, vy));
+    __m256 uvy = _mm256_fmsub_ps(qz, vx, _mm256_mul_ps(qx, vz));
+    __m256 uvz = _mm256_fmsub_ps(qx, vy, _mm256_mul_ps(qy, vx));
+
+    __m256 uuvx = _mm256_fmsub_ps(qy, uvz, _mm256_mul_ps(qz, uvy));
+    __m256 uuvy = _mm256_fmsub_ps(qz, uvx, _mm256_mul_ps(qx, uvz));
+    __m256 uuvz = _mm256_fmsub_ps(qx, uvy, _mm256_mul_ps(qy, uvx));
+
+    const __m256 two = _mm256_set1_ps(2.0f);
+    vx = _mm256_fmadd_ps(two, _mm256_fmadd_ps(qw, uvx, uuvx), vx);
+    vy = _mm256_fmadd_ps(two, _mm256_fmadd_ps(qw, uvy, uuvy), vy);
+    vz = _mm256_fmadd_ps(two, _mm256_fmadd_ps(qw, uvz, uuvz), vz);
+}
+
+// same as ::blend() for 8 poses, with a separate alpha per pose.
+static inline void blend8(int stride, const float* a, const float* b, __m256 alpha, float* result) {
+
+    // scale and translation are linear
+    for (int c = TRANS_X; c < NUM_COMPONENTS; c++) {
+        __m256 va = _mm256_loadu_ps(a + c * stride);
+        __m256 vb = _mm256_loadu_ps(b + c * stride);
+        _mm256_storeu_ps(result + c * stride, lerp8(va, vb, alpha));
+    }
+
+    // rotation uses safeLerp()
+    __m256 ax = _mm256_loadu_ps(a + ROT_X * stride);
+    __m256 ay = _mm256_loadu_ps(a + ROT_Y * stride);
+    __m256 az = _mm256_loadu_ps(a + ROT_Z * stride);
+    __m256 aw = _mm256_loadu_ps(a + ROT_W * stride);
+    __m256 bx = _mm256_loadu_ps(b + ROT_X * stride);
+    __m256 by = _mm256_loadu_ps(b + ROT_Y * stride);
+    __m256 bz = _mm256_loadu_ps(b + ROT_Z * stride);
+    __m256 bw = _mm256_loadu_ps(b + ROT_W * stride);
+
+    __m256 dot = _mm256_mul_ps(ax, bx);
+    dot = _mm256_fmadd_ps(ay, by, dot);
+    dot = _mm256_fmadd_ps(az, bz, dot);
+    dot = _mm256_fmadd_ps(aw, bw, dot);
+
+    // flip the sign of b when dot < 0
+    __m256 sign = _mm256_and_ps(dot, _mm256_set1_ps(-0.0f));
+    bx = _mm256_xor_ps(bx, sign);
+    by = _mm256_xor_ps(by, sign);
+    bz = _mm256_xor_ps(bz, sign);
+    bw = _mm256_xor_ps(bw, sign);
+
+    __m256 rx = lerp8(ax, bx, alpha);
+    __m256 ry = lerp8(ay, by, alpha);
+    __m256 rz = lerp8(az, bz, alpha);
+    __m256 rw = lerp8(aw, bw, alpha);
+    normalize8(rx, ry, rz, rw);
+
+    _mm256_storeu_ps(result + ROT_X * stride, rx);
+    _mm256_storeu_ps(result + ROT_Y * stride, ry);
+    _mm256_storeu_ps(result + ROT_Z * stride, rz);
+    _mm256_storeu_ps(result + ROT_W * stride, rw);
+}
+
+void blendPoses_AVX2(int numPoses, int stride, const float* a, const float* b, float alpha, float* result) {
+    __m256 alpha8 = _mm256_set1_ps(alpha);
+    for (int i = 0; i < numPoses; i += 8) {     // padding is identity, so the last block is always safe
+        blend8(stride, a + i, b + i, alpha8, result + i);
+    }
+}
+
+void blendPosesMasked_AVX2(int numPoses, int stride, const float* a, const float* b, const float* weights, float alpha,
+                           float* result) {
+    __m256 alpha8 = _mm256_set1_ps(alpha);
+    int i = 0;
+    for (; i < numPoses - 7; i += 8) {  // blocks of 8
+        blend8(stride, a + i, b + i, _mm256_mul_ps(_mm256_loadu_ps(weights + i), alpha8), result + i);
+    }
+    if (i < numPoses) {                 // remainder, weights are not padded
+        float tail[8] = { 0.0f };
+        for (int j = 0; j < numPoses - i; j++) {
+            tail[j] = weights[i + j];
+        }
+        blend8(stride, a + i, b + i, _mm256_mul_ps(_mm256_loadu_ps(tail), alpha8), result + i);
+    }
+}
+
+void blendAddPoses_AVX2(int numPoses, int stride, const float* a, const float* b, float alpha, float* result) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 alpha8 = _mm256_set1_ps(alpha);
+    const __m256 oneMinusAlpha = _mm256_set1_ps(1.0f - alpha);
+
+    for (int i = 0; i < numPoses; i += 8) {
+        const float* pa = a + i;
+        const float* pb = b + i;
+        float* pr = result + i;
+
+        // scale = a.scale * lerp(1, b.scale, alpha)
+        for (int c = SCALE_X; c <= SCALE_Z; c++) {
+            __m256 va = _mm256_loadu_ps(pa + c * stride);
+            __m256 vb = _mm256_loadu_ps(pb + c * stride);
+            _mm256_storeu_ps(pr + c * stride, _mm256_mul_ps(va, lerp8(one, vb, alpha8)));
+        }
+
+        // trans = a.trans + alpha * b.trans
+        for (int c = TRANS_X; c <= TRANS_Z; c++) {
+            __m256 va = _mm256_loadu_ps(pa + c * stride);
+            __m256 vb = _mm256_loadu_ps(pb + c * stride);
+            _mm256_storeu_ps(pr + c * stride, _mm256_fmadd_ps(alpha8, vb, va));
+        }
+
+        // delta = lerp(identity, b.rot, alpha), with b.rot flipped to positive w
+        __m256 dx = _mm256_loadu_ps(pb + ROT_X * stride);
+        __m256 dy = _mm256_loadu_ps(pb + ROT_Y * stride);
+        __m256 dz = _mm256_loadu_ps(pb + ROT_Z * stride);
+        __m256 dw = _mm256_loadu_ps(pb + ROT_W * stride);
+        __m256 sign = _mm256_and_ps(dw, _mm256_set1_ps(-0.0f));
+        dx = _mm256_mul_ps(_mm256_xor_ps(dx, sign), alpha8);
+        dy = _mm256_mul_ps(_mm256_xor_ps(dy, sign), alpha8);
+        dz = _mm256_mul_ps(_mm256_xor_ps(dz, sign), alpha8);
+        dw = _mm256_fmadd_ps(_mm256_xor_ps(dw, sign), alpha8, oneMinusAlpha);
+
+        // rot = normalize(a.rot * delta)
+        __m256 ax = _mm256_loadu_ps(pa + ROT_X * stride);
+        __m256 ay = _mm256_loadu_ps(pa + ROT_Y * stride);
+        __m256 az = _mm256_loadu_ps(pa + ROT_Z * stride);
+        __m256 aw = _mm256_loadu_ps(pa + ROT_W * stride);
+
+        __m256 rx, ry, rz, rw;
+        quatMul8(ax, ay, az, aw, dx, dy, dz, dw, rx, ry, rz, rw);
+        normalize8(rx, ry, rz, rw);
+
+        _mm256_storeu_ps(pr + ROT_X * stride, rx);
+        _mm256_storeu_ps(pr + ROT_Y * stride, ry);
+        _mm256_storeu_ps(pr + ROT_Z * stride, rz);
+        _mm256_storeu_ps(pr + ROT_W * stride, rw);
+    }
+}
+
+//
+// Conversions between relative and absolute poses, for joints whose parents aren't among them: joints[k] has the parent
+// parents[k], or rootPose when parents[k] is negative.  rootPose is a single pose with a stride of 1.  As the joints are
+// scattered across the streams, they are gathered eight at a time and written back one by one.
+//
+
+class JointBlock {
+public:
+    JointBlock(int numJoints, const int* joints, const int* parents, int stride, const float* rootPose, const float* data) :
+        _count(numJoints < 8 ? numJoints : 8),
+        _stride(stride) {
+        // the lanes past the end of the joints read the first joint again, and are never written back
+        alignas(32) int jointIndices[8];
+        alignas(32) int parentIndices[8];
+        for (int k = 0; k < 8; k++) {
+            jointIndices[k] = joints[k < _count ? k : 0];
+            parentIndices[k] = parents[k < _count ? k : 0];
+        }
+        _joints = joints;
+        __m256i jointIndices8 = _mm256_load_si256((const __m256i*)jointIndices);
+        __m256i parentIndices8 = _mm256_load_si256((const __m256i*)parentIndices);
+        __m256 isRoot = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_setzero_si256(), parentIndices8));
+        parentIndices8 = _mm256_max_epi32(parentIndices8, _mm256_setzero_si256());
+
+        for (int c = 0; c < NUM_COMPONENTS; c++) {
+            child[c] = _mm256_i32gather_ps(data + c * stride, jointIndices8, 4);
+            parent[c] = _mm256_blendv_ps(_mm256_i32gather_ps(data + c * stride, parentIndices8, 4),
+                                         _mm256_set1_ps(rootPose[c]), isRoot);
+        }
+    }
+
+    void write(float* data) const {
+        for (int c = 0; c < NUM_COMPONENTS; c++) {
+            alignas(32) float values[8];
+            _mm256_store_ps(values, result[c]);
+            float* stream = data + c * _stride;
+            for (int k = 0; k < _count; k++) {
+                stream[_joints[k]] = values[k];
+            }
+        }
+    }
+
+    __m256 child[NUM_COMPONENTS];
+    __m256 parent[NUM_COMPONENTS];
+    __m256 result[NUM_COMPONENTS];
+
+private:
+    int _count;
+    int _stride;
+    const int* _joints;
+};
+
+// same as relativeToAbsolute_ref() in AnimPoseSoA.cpp
+void relativeToAbsolute_AVX2(int numJoints, const int* joints, const int* parents, int stride, const float* rootPose,
+                             float* data) {
+    for (int i = 0; i < numJoints; i += 8) {
+        JointBlock block(numJoints - i, joints + i, parents + i, stride, rootPose, data);
+        const __m256* p = block.parent;
+        const __m256* c = block.child;
+        __m256* r = block.result;
+
+        // rot = normalize(parent.rot * child.rot)
+        quatMul8(p[ROT_X], p[ROT_Y], p[ROT_Z], p[ROT_W], c[ROT_X], c[ROT_Y], c[ROT_Z], c[ROT_W],
+                 r[ROT_X], r[ROT_Y], r[ROT_Z], r[ROT_W]);
+        normalize8(r[ROT_X], r[ROT_Y], r[ROT_Z], r[ROT_W]);
+
+        // trans = parent.trans + parent.rot * (parent.scale * child.trans)
+        __m256 tx = _mm256_mul_ps(p[SCALE_X], c[TRANS_X]);
+        __m256 ty = _mm256_mul_ps(p[SCALE_Y], c[TRANS_Y]);
+        __m256 tz = _mm256_mul_ps(p[SCALE_Z], c[TRANS_Z]);
+        rotate8(p[ROT_X], p[ROT_Y], p[ROT_Z], p[ROT_W], tx, ty, tz);
+        r[TRANS_X] = _mm256_add_ps(p[TRANS_X], tx);
+        r[TRANS_Y] = _mm256_add_ps(p[TRANS_Y], ty);
+        r[TRANS_Z] = _mm256_add_ps(p[TRANS_Z], tz);
+
+        // scale = child.scale * parent.scale
+        for (int j = SCALE_X; j <= SCALE_Z; j++) {
+            r[j] = _mm256_mul_ps(c[j], p[j]);
+        }
+
+        block.write(data);
+    }
+}
+
+// same as absoluteToRelative_ref() in AnimPoseSoA.cpp
+void absoluteToRelative_AVX2(int numJoints, const int* joints, const int* parents, int stride, const float* rootPose,
+                             float* data) {
+    const __m256 negate = _mm256_set1_ps(-0.0f);
+    for (int i = 0; i < numJoints; i += 8) {
+        JointBlock block(numJoints - i, joints + i, parents + i, stride, rootPose, data);
+        const __m256* p = block.parent;
+        const __m256* c = block.child;
+        __m256* r = block.result;
+
+        // absolute rotations are normalized, so the conjugate is the inverse
+        __m256 ix = _mm256_xor_ps(p[ROT_X], negate);
+        __m256 iy = _mm256_xor_ps(p[ROT_Y], negate);
+        __m256 iz = _mm256_xor_ps(p[ROT_Z], negate);
+        __m256 iw = p[ROT_W];
+
+        // rot = normalize(inverse(parent.rot) * child.rot)
+        quatMul8(ix, iy, iz, iw, c[ROT_X], c[ROT_Y], c[ROT_Z], c[ROT_W], r[ROT_X], r[ROT_Y], r[ROT_Z], r[ROT_W]);
+        normalize8(r[ROT_X], r[ROT_Y], r[ROT_Z], r[ROT_W]);
+
+        // trans = inverse(parent.rot) * ((child.trans - parent.trans) / parent.scale)
+        __m256 tx = _mm256_div_ps(_mm256_sub_ps(c[TRANS_X], p[TRANS_X]), p[SCALE_X]);
+        __m256 ty = _mm256_div_ps(_mm256_sub_ps(c[TRANS_Y], p[TRANS_Y]), p[SCALE_Y]);
+        __m256 tz = _mm256_div_ps(_mm256_sub_ps(c[TRANS_Z], p[TRANS_Z]), p[SCALE_Z]);
+        rotate8(ix, iy, iz, iw, tx, ty, tz);
+        r[TRANS_X] = tx;
+        r[TRANS_Y] = ty;
+        r[TRANS_Z] = tz;
+
+        // scale = child.scale / parent.scale
+        for (int j = SCALE_X; j <= SCALE_Z; j++) {
+            r[j] = _mm256_div_ps(c[j], p[j]);
+        }
+
+        block.write(data);
+    }
+}
+
+// column-major 4x4 matrices, matching static_cast<glm::mat4>(AnimPose)
+void posesToMatrices_AVX2(int numPoses, int stride, const float* src, float (*matrices)[16]) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+
+    for (int i = 0; i < numPoses; i += 8) {
+        const float* p = src + i;
+
+        __m256 x = _mm256_loadu_ps(p + ROT_X * stride);
+        __m256 y = _mm256_loadu_ps(p + ROT_Y * stride);
+        __m256 z = _mm256_loadu_ps(p + ROT_Z * stride);
+        __m256 w = _mm256_loadu_ps(p + ROT_W * stride);
+
+        __m256 xx = _mm256_mul_ps(x, x);
+        __m256 yy = _mm256_mul_ps(y, y);
+        __m256 zz = _mm256_mul_ps(z, z);
+        __m256 xy = _mm256_mul_ps(x, y);
+        __m256 xz = _mm256_mul_ps(x, z);
+        __m256 yz = _mm256_mul_ps(y, z);
+        __m256 wx = _mm256_mul_ps(w, x);
+        __m256 wy = _mm256_mul_ps(w, y);
+        __m256 wz = _mm256_mul_ps(w, z);
+
+        __m256 sx = _mm256_loadu_ps(p + SCALE_X * stride);
+        __m256 sy = _mm256_loadu_ps(p + SCALE_Y * stride);
+        __m256 sz = _mm256_loadu_ps(p + SCALE_Z * stride);
+
+        __m256 m[16];
+        m[0] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), sx);
+        m[1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx);
+        m[2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx);
+        m[3] = _mm256_setzero_ps();
+
+        m[4] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy);
+        m[5] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), sy);
+        m[6] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy);
+        m[7] = _mm256_setzero_ps();
+
+        m[8] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz);
+        m[9] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz);
+        m[10] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), sz);
+        m[11] = _mm256_setzero_ps();
+
+        m[12] = _mm256_loadu_ps(p + TRANS_X * stride);
+        m[13] = _mm256_loadu_ps(p + TRANS_Y * stride);
+        m[14] = _mm256_loadu_ps(p + TRANS_Z * stride);
+        m[15] = one;
+
+        // transpose 16x8 to 8x16 on the way out
+        alignas(32) float tmp[16][8];
+        for (int j = 0; j < 16; j++) {
+            _mm256_store_ps(tmp[j], m[j]);
+        }
+        int count = (numPoses - i) < 8 ? (numPoses - i) : 8;
+        for (int k = 0; k < count; k++) {
+            for (int j = 0; j < 16; j++) {
+                matrices[i + k][j] = tmp[j][k];
+            }
+        }
+    }
+}
+
+#endif
@@ -16,13 +16,13 @@
 #include <glm/glm.hpp>
 
 #include <QRunnable>
-#include <QThreadPool>
 #include <QDataStream>
 #include <QtCore/QDebug>
 #include <QtNetwork/QNetworkRequest>
 #include <QtNetwork/QNetworkReply>
 #include <qendian.h>
 
+#include <JobScheduler.h>
 #include <LimitedNodeList.h>
 #include <NetworkAccessManager.h>
 #include <SharedUtil.h>
@@ -79,7 +79,7 @@ void Sound::downloadFinished(const QByteArray& data) {
     auto soundProcessor = new SoundProcessor(_self, data);
     connect(soundProcessor, &SoundProcessor::onSuccess, this, &Sound::soundProcessSuccess);
     connect(soundProcessor, &SoundProcessor::onError, this, &Sound::soundProcessError);
-    QThreadPool::globalInstance()->start(soundProcessor);
+    JobScheduler::getInstance().submit(JobScheduler::Category::Sound, soundProcessor);
 }
 
 void Sound::soundProcessSuccess(AudioDataPointer audioData) {
@@ -40,7 +40,11 @@ namespace AvatarTraits {
     qint64 packVersionedTrait(TraitType traitType, ExtendedIODevice& destination,
                               TraitVersion traitVersion, const AvatarData& avatar) {
         // Call packer function
-        auto traitBinaryData = avatar.packTrait(traitType);
+        return packVersionedTraitData(traitType, destination, traitVersion, avatar.packTrait(traitType));
+    }
+
+    qint64 packVersionedTraitData(TraitType traitType, ExtendedIODevice& destination, TraitVersion traitVersion,
+                                  const QByteArray& traitBinaryData) {
         auto traitBinaryDataSize = traitBinaryData.size();
 
         // Verify packed data
@@ -93,7 +97,13 @@ namespace AvatarTraits {
                                       ExtendedIODevice& destination, TraitVersion traitVersion,
                                       AvatarData& avatar) {
         // Call packer function
-        auto traitBinaryData = avatar.packTraitInstance(traitType, traitInstanceID);
+        return packVersionedTraitInstanceData(traitType, traitInstanceID, destination, traitVersion,
+                                              avatar.packTraitInstance(traitType, traitInstanceID));
+    }
+
+    qint64 packVersionedTraitInstanceData(TraitType traitType, TraitInstanceID traitInstanceID,
+                                          ExtendedIODevice& destination, TraitVersion traitVersion,
+                                          const QByteArray& traitBinaryData) {
         auto traitBinaryDataSize = traitBinaryData.size();
 
 
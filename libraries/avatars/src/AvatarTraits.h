@@ -71,6 +71,13 @@ namespace AvatarTraits {
                                       ExtendedIODevice& destination, TraitVersion traitVersion,
                                       AvatarData& avatar);
 
+    // same as the above, for trait data that has already been packed by the avatar
+    qint64 packVersionedTraitData(TraitType traitType, ExtendedIODevice& destination, TraitVersion traitVersion,
+                                  const QByteArray& traitBinaryData);
+    qint64 packVersionedTraitInstanceData(TraitType traitType, TraitInstanceID traitInstanceID,
+                                          ExtendedIODevice& destination, TraitVersion traitVersion,
+                                          const QByteArray& traitBinaryData);
+
     qint64 packInstancedTraitDelete(TraitType traitType, TraitInstanceID instanceID, ExtendedIODevice& destination,
                                            TraitVersion traitVersion = NULL_TRAIT_VERSION);
 
@@ -11,6 +11,8 @@
 
 #include "DiffTraversal.h"
 
+#include <algorithm>
+
 #include <OctreeUtils.h>
 
 #include "EntityPriorityQueue.h"
@@ -162,6 +164,27 @@ float DiffTraversal::View::computePriority(const EntityItemPointer& entity) cons
     return priority;
 }
 
+float DiffTraversal::View::computePriority(const AACube& regionCube) const {
+    if (!usesViewFrustums()) {
+        return PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY;
+    }
+
+    auto center = regionCube.calcCenter(); // center of bounding sphere
+    auto radius = 0.5f * SQRT_THREE * regionCube.getScale(); // radius of bounding sphere
+
+    auto priority = PrioritizedEntity::DO_NOT_SEND;
+    for (const auto& frustum : viewFrustums) {
+        auto position = center - frustum.getPosition(); // position of bounding sphere in view-frame
+        float distance = glm::length(position); // distance to center of bounding sphere
+        float angularSize = frustum.getAngularSize(distance, radius);
+        if (angularSize > lodScaleFactor * MIN_ELEMENT_ANGULAR_DIAMETER &&
+            frustum.intersects(position, distance, radius)) {
+            priority = std::max(priority, angularSize);
+        }
+    }
+    return priority;
+}
+
 bool DiffTraversal::View::shouldTraverseElement(const EntityTreeElement& element) const {
     if (!usesViewFrustums()) {
         return true;
@@ -244,6 +267,12 @@ DiffTraversal::Type DiffTraversal::prepareNewTraversal(const DiffTraversal::View
     return type;
 }
 
+void DiffTraversal::completeFromSharedTraversal(uint64_t startTime) {
+    _path.clear();
+    _currentView.startTime = std::min(_currentView.startTime, startTime);
+    _completedView = _currentView;
+}
+
 void DiffTraversal::getNextVisibleElement(DiffTraversal::VisibleElement& next) {
     if (_path.empty()) {
         next.element.reset();
@@ -34,6 +34,7 @@ public:
 
         bool shouldTraverseElement(const EntityTreeElement& element) const;
         float computePriority(const EntityItemPointer& entity) const;
+        float computePriority(const AACube& regionCube) const; // for a region of elements, culled like an element
 
         ConicalViewFrustums viewFrustums;
         uint64_t startTime { 0 };
@@ -73,6 +74,10 @@ public:
 
     void reset() { _path.clear(); _completedView.startTime = 0; } // resets our state to force a new "First" traversal
 
+    // skips the traversal that was just prepared, because its results came from a traversal of a very similar view
+    // that started at startTime.  The next traversal looks for what changed since then.
+    void completeFromSharedTraversal(uint64_t startTime);
+
 private:
     void getNextVisibleElement(VisibleElement& next);
 
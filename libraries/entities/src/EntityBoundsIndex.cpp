@@ -0,0 +1,746 @@
+//
+//  EntityBoundsIndex.cpp
+//  libraries/entities/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityBoundsIndex.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <queue>
+
+#include <glm/gtx/norm.hpp>
+
+#include <AABox.h>
+#include <GLMHelpers.h>
+#include <ViewFrustum.h>
+
+#include "EntityTreeElement.h"
+
+using Node = EntityBoundsIndex::Node;
+
+// the loose cube of an entity is its bounding cube for any rotation, grown by this much
+static const float LOOSE_MARGIN_SCALE = 0.1f;
+static const float MIN_LOOSE_MARGIN = 0.01f; // meters
+
+// the pending entities are tested one by one, so the index is rebuilt once there are more than
+// max(MIN_PENDING_TO_REBUILD, number of placed entities / PLACED_PER_PENDING_TO_REBUILD) of them
+static const int MIN_PENDING_TO_REBUILD = 32;
+static const int PLACED_PER_PENDING_TO_REBUILD = 8;
+
+// avoids infinities, and the NaNs they make at the edges of the slabs, for rays parallel to an axis
+static const float MAX_INVERSE_DIRECTION = 1.0e30f;
+
+static float safeInverse(float value) {
+    return fabsf(value) < 1.0f / MAX_INVERSE_DIRECTION ? copysignf(MAX_INVERSE_DIRECTION, value) : 1.0f / value;
+}
+
+static Node makeEmptyNode() {
+    Node node;
+    for (int lane = 0; lane < EntityBoundsIndex::NUM_LANES; lane++) {
+        node.minX[lane] = node.minY[lane] = node.minZ[lane] = FLT_MAX;
+        node.maxX[lane] = node.maxY[lane] = node.maxZ[lane] = -FLT_MAX;
+        node.children[lane] = -1;  // EMPTY_CHILD
+    }
+    return node;
+}
+
+static const Node EMPTY_NODE = makeEmptyNode();
+
+// Each query is a test of bounds, done one box at a time by testBounds() for the pending entities,
+// and four boxes at a time by testNode() for the nodes.  testNode() returns the mask of the lanes that pass.
+// The distances are only filled in by the tests that sort their results.
+
+struct BoxTest {
+    glm::vec3 minCorner;
+    glm::vec3 maxCorner;
+
+    bool testBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, float& distance) const {
+        return glm::all(glm::lessThanEqual(boundsMin, maxCorner)) && glm::all(glm::greaterThanEqual(boundsMax, minCorner));
+    }
+    int testNode(const Node& node, float* distances) const;
+};
+
+struct SphereTest {
+    glm::vec3 center;
+    float radius;
+
+    bool testBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, float& distance) const {
+        glm::vec3 e = glm::max(boundsMin - center, Vectors::ZERO) + glm::max(center - boundsMax, Vectors::ZERO);
+        distance = glm::length(e);
+        return distance <= radius;
+    }
+    int testNode(const Node& node, float* distances) const;
+};
+
+struct FrustumTest {
+    glm::vec4 planes[NUM_FRUSTUM_PLANES];   // normal and d coefficient
+    glm::vec3 keyholeCenter;
+    float keyholeRadius;
+
+    bool testBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, float& distance) const {
+        // same as ViewFrustum::boxIntersectsFrustum() || ViewFrustum::boxIntersectsKeyhole()
+        glm::vec3 e = glm::max(boundsMin - keyholeCenter, Vectors::ZERO) + glm::max(keyholeCenter - boundsMax, Vectors::ZERO);
+        if (glm::length2(e) <= keyholeRadius * keyholeRadius) {
+            return true;
+        }
+        for (int i = 0; i < NUM_FRUSTUM_PLANES; i++) {
+            glm::vec3 normal(planes[i]);
+            glm::vec3 farthest(normal.x > 0.0f ? boundsMax.x : boundsMin.x, normal.y > 0.0f ? boundsMax.y : boundsMin.y,
+                normal.z > 0.0f ? boundsMax.z : boundsMin.z);
+            if (planes[i].w + glm::dot(normal, farthest) < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+    int testNode(const Node& node, float* distances) const;
+};
+
+struct RayTest {
+    glm::vec3 origin;
+    glm::vec3 inverseDirection;
+
+    bool testBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, float& distance) const {
+        glm::vec3 t1 = (boundsMin - origin) * inverseDirection;
+        glm::vec3 t2 = (boundsMax - origin) * inverseDirection;
+        glm::vec3 tMin = glm::min(t1, t2);
+        glm::vec3 tMax = glm::max(t1, t2);
+        float tNear = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+        float tFar = std::min(std::min(tMax.x, tMax.y), tMax.z);
+        distance = tNear;
+        return tNear <= tFar;
+    }
+    int testNode(const Node& node, float* distances) const;
+};
+
+// the parabola stays in the plane through its origin with this normal
+struct PlaneTest {
+    glm::vec3 origin;
+    glm::vec3 normal;
+
+    bool testBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, float& distance) const {
+        glm::vec3 center = 0.5f * (boundsMin + boundsMax);
+        glm::vec3 extents = 0.5f * (boundsMax - boundsMin);
+        return fabsf(glm::dot(normal, center - origin)) <= glm::dot(glm::abs(normal), extents) &&
+            glm::all(glm::lessThanEqual(boundsMin, boundsMax));
+    }
+    int testNode(const Node& node, float* distances) const;
+};
+
+struct AnyTest {
+    bool testBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, float& distance) const {
+        return true;
+    }
+    int testNode(const Node& node, float* distances) const {
+        return (1 << EntityBoundsIndex::NUM_LANES) - 1;
+    }
+};
+
+// on x86 architecture, assume that SSE2 is present
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+
+#include <emmintrin.h>
+
+// the nodes are only 4 byte aligned in their vector, so the lanes use unaligned loads
+struct Lanes {
+    __m128 minX, minY, minZ, maxX, maxY, maxZ;
+
+    Lanes(const Node& node) :
+        minX(_mm_loadu_ps(node.minX)), minY(_mm_loadu_ps(node.minY)), minZ(_mm_loadu_ps(node.minZ)),
+        maxX(_mm_loadu_ps(node.maxX)), maxY(_mm_loadu_ps(node.maxY)), maxZ(_mm_loadu_ps(node.maxZ)) {}
+};
+
+// squared distances from the point to the bounds of the lanes, 0 inside of them
+static inline __m128 distanceSquared(const Lanes& lanes, const glm::vec3& point) {
+    __m128 zero = _mm_setzero_ps();
+    __m128 x = _mm_set1_ps(point.x);
+    __m128 y = _mm_set1_ps(point.y);
+    __m128 z = _mm_set1_ps(point.z);
+    __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(lanes.minX, x), zero), _mm_max_ps(_mm_sub_ps(x, lanes.maxX), zero));
+    __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(lanes.minY, y), zero), _mm_max_ps(_mm_sub_ps(y, lanes.maxY), zero));
+    __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(lanes.minZ, z), zero), _mm_max_ps(_mm_sub_ps(z, lanes.maxZ), zero));
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+}
+
+int BoxTest::testNode(const Node& node, float* distances) const {
+    Lanes lanes(node);
+    __m128 overlapX = _mm_and_ps(_mm_cmple_ps(lanes.minX, _mm_set1_ps(maxCorner.x)),
+        _mm_cmpge_ps(lanes.maxX, _mm_set1_ps(minCorner.x)));
+    __m128 overlapY = _mm_and_ps(_mm_cmple_ps(lanes.minY, _mm_set1_ps(maxCorner.y)),
+        _mm_cmpge_ps(lanes.maxY, _mm_set1_ps(minCorner.y)));
+    __m128 overlapZ = _mm_and_ps(_mm_cmple_ps(lanes.minZ, _mm_set1_ps(maxCorner.z)),
+        _mm_cmpge_ps(lanes.maxZ, _mm_set1_ps(minCorner.z)));
+    return _mm_movemask_ps(_mm_and_ps(_mm_and_ps(overlapX, overlapY), overlapZ));
+}
+
+int SphereTest::testNode(const Node& node, float* distances) const {
+    __m128 distance = _mm_sqrt_ps(distanceSquared(Lanes(node), center));
+    _mm_storeu_ps(distances, distance);
+    return _mm_movemask_ps(_mm_cmple_ps(distance, _mm_set1_ps(radius)));
+}
+
+int FrustumTest::testNode(const Node& node, float* distances) const {
+    Lanes lanes(node);
+    __m128 keyhole = _mm_cmple_ps(distanceSquared(lanes, keyholeCenter), _mm_set1_ps(keyholeRadius * keyholeRadius));
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int i = 0; i < NUM_FRUSTUM_PLANES; i++) {
+        const glm::vec4& plane = planes[i];
+        // the farthest corner along the normal of the plane
+        __m128 x = plane.x > 0.0f ? lanes.maxX : lanes.minX;
+        __m128 y = plane.y > 0.0f ? lanes.maxY : lanes.minY;
+        __m128 z = plane.z > 0.0f ? lanes.maxZ : lanes.minZ;
+        __m128 distance = _mm_add_ps(_mm_set1_ps(plane.w),
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+                _mm_mul_ps(_mm_set1_ps(plane.z), z)));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+    }
+    return _mm_movemask_ps(_mm_or_ps(keyhole, inside));
+}
+
+int RayTest::testNode(const Node& node, float* distances) const {
+    Lanes lanes(node);
+    __m128 originX = _mm_set1_ps(origin.x);
+    __m128 originY = _mm_set1_ps(origin.y);
+    __m128 originZ = _mm_set1_ps(origin.z);
+    __m128 inverseX = _mm_set1_ps(inverseDirection.x);
+    __m128 inverseY = _mm_set1_ps(inverseDirection.y);
+    __m128 inverseZ = _mm_set1_ps(inverseDirection.z);
+
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(lanes.minX, originX), inverseX);
+    __m128 t2 = _mm_mul_ps(_mm_sub_ps(lanes.maxX, originX), inverseX);
+    __m128 tNear = _mm_max_ps(_mm_min_ps(t1, t2), _mm_setzero_ps());
+    __m128 tFar = _mm_max_ps(t1, t2);
+
+    t1 = _mm_mul_ps(_mm_sub_ps(lanes.minY, originY), inverseY);
+    t2 = _mm_mul_ps(_mm_sub_ps(lanes.maxY, originY), inverseY);
+    tNear = _mm_max_ps(tNear, _mm_min_ps(t1, t2));
+    tFar = _mm_min_ps(tFar, _mm_max_ps(t1, t2));
+
+    t1 = _mm_mul_ps(_mm_sub_ps(lanes.minZ, originZ), inverseZ);
+    t2 = _mm_mul_ps(_mm_sub_ps(lanes.maxZ, originZ), inverseZ);
+    tNear = _mm_max_ps(tNear, _mm_min_ps(t1, t2));
+    tFar = _mm_min_ps(tFar, _mm_max_ps(t1, t2));
+
+    _mm_storeu_ps(distances, tNear);
+    return _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+}
+
+int PlaneTest::testNode(const Node& node, float* distances) const {
+    Lanes lanes(node);
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 normalX = _mm_set1_ps(normal.x);
+    __m128 normalY = _mm_set1_ps(normal.y);
+    __m128 normalZ = _mm_set1_ps(normal.z);
+
+    // signed distance from the plane to the centers, and the reach of the extents along the normal
+    __m128 centerX = _mm_sub_ps(_mm_mul_ps(half, _mm_add_ps(lanes.minX, lanes.maxX)), _mm_set1_ps(origin.x));
+    __m128 centerY = _mm_sub_ps(_mm_mul_ps(half, _mm_add_ps(lanes.minY, lanes.maxY)), _mm_set1_ps(origin.y));
+    __m128 centerZ = _mm_sub_ps(_mm_mul_ps(half, _mm_add_ps(lanes.minZ, lanes.maxZ)), _mm_set1_ps(origin.z));
+    __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, centerX), _mm_mul_ps(normalY, centerY)),
+        _mm_mul_ps(normalZ, centerZ));
+
+    __m128 extentsX = _mm_mul_ps(half, _mm_sub_ps(lanes.maxX, lanes.minX));
+    __m128 extentsY = _mm_mul_ps(half, _mm_sub_ps(lanes.maxY, lanes.minY));
+    __m128 extentsZ = _mm_mul_ps(half, _mm_sub_ps(lanes.maxZ, lanes.minZ));
+    __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(normalX, signMask), extentsX),
+        _mm_mul_ps(_mm_and_ps(normalY, signMask), extentsY)), _mm_mul_ps(_mm_and_ps(normalZ, signMask), extentsZ));
+
+    // the empty lanes have negative extents
+    return _mm_movemask_ps(_mm_cmple_ps(_mm_and_ps(distance, signMask), reach));
+}
+
+#else   // portable reference code
+
+template <typename Test>
+static int testLanes(const Test& test, const Node& node, float* distances) {
+    int mask = 0;
+    for (int lane = 0; lane < EntityBoundsIndex::NUM_LANES; lane++) {
+        glm::vec3 boundsMin(node.minX[lane], node.minY[lane], node.minZ[lane]);
+        glm::vec3 boundsMax(node.maxX[lane], node.maxY[lane], node.maxZ[lane]);
+        if (test.testBounds(boundsMin, boundsMax, distances[lane])) {
+            mask |= 1 << lane;
+        }
+    }
+    return mask;
+}
+
+int BoxTest::testNode(const Node& node, float* distances) const {
+    return testLanes(*this, node, distances);
+}
+
+int SphereTest::testNode(const Node& node, float* distances) const {
+    return testLanes(*this, node, distances);
+}
+
+int FrustumTest::testNode(const Node& node, float* distances) const {
+    return testLanes(*this, node, distances);
+}
+
+int RayTest::testNode(const Node& node, float* distances) const {
+    return testLanes(*this, node, distances);
+}
+
+int PlaneTest::testNode(const Node& node, float* distances) const {
+    return testLanes(*this, node, distances);
+}
+
+#endif
+
+void EntityBoundsIndex::addEntity(const EntityItemPointer& entity) {
+    // flag the entity as changed before queueing it: moving it in between doesn't queue it twice,
+    // and moving it once the change is applied queues it again
+    entity->withWriteLock([&] {
+        entity->_boundsIndex = shared_from_this();
+        entity->_boundsIndexChanged = true;
+    });
+
+    std::lock_guard<std::mutex> lock(_changesMutex);
+    if (entity->_boundsIndexSlot >= 0) {
+        return;
+    }
+    int32_t slot;
+    if (!_freeSlots.empty()) {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    } else {
+        slot = _numSlots++;
+    }
+    entity->_boundsIndexSlot = slot;
+    _changes[entity.get()] = { entity, slot };
+}
+
+void EntityBoundsIndex::removeEntity(const EntityItemPointer& entity) {
+    {
+        std::lock_guard<std::mutex> lock(_changesMutex);
+        int32_t slot = entity->_boundsIndexSlot;
+        if (slot < 0) {
+            return;
+        }
+        entity->_boundsIndexSlot = -1;
+        _changes.erase(entity.get());
+        // the slot is freed once the removal is applied
+        _removedSlots.push_back(slot);
+    }
+    entity->withWriteLock([&] {
+        entity->_boundsIndex.reset();
+        entity->_boundsIndexChanged = false;
+    });
+}
+
+void EntityBoundsIndex::entityChanged(const EntityItemPointer& entity) {
+    std::lock_guard<std::mutex> lock(_changesMutex);
+    int32_t slot = entity->_boundsIndexSlot;
+    if (slot >= 0) {
+        _changes[entity.get()] = { entity, slot };
+    }
+}
+
+int EntityBoundsIndex::getNumEntities() {
+    update();
+    return resultWithReadLock<int>([&] {
+        return _numLive;
+    });
+}
+
+int EntityBoundsIndex::getNumNodes() {
+    update();
+    return resultWithReadLock<int>([&] {
+        return (int)_nodes.size();
+    });
+}
+
+void EntityBoundsIndex::update() {
+    std::unordered_map<EntityItem*, Change> changes;
+    std::vector<int32_t> removedSlots;
+    int32_t numSlots;
+    {
+        std::lock_guard<std::mutex> lock(_changesMutex);
+        if (_changes.empty() && _removedSlots.empty()) {
+            return;
+        }
+        changes.swap(_changes);
+        removedSlots.swap(_removedSlots);
+        numSlots = _numSlots;
+    }
+
+    withWriteLock([&] {
+        if ((int32_t)_slots.size() < numSlots) {
+            _slots.resize(numSlots);
+        }
+        for (int32_t slot : removedSlots) {
+            removeSlot(slot);
+        }
+        for (const auto& change : changes) {
+            applyChange(change.second);
+        }
+
+        int maxPending = std::max(MIN_PENDING_TO_REBUILD, _numPlaced / PLACED_PER_PENDING_TO_REBUILD);
+        if ((int)_pending.size() > maxPending || _numRemovedSinceRebuild > _numPlaced / 4 ||
+                _numRefitsSinceRebuild > _numLive) {
+            rebuild();
+        }
+    });
+
+    if (!removedSlots.empty()) {
+        std::lock_guard<std::mutex> lock(_changesMutex);
+        _freeSlots.insert(_freeSlots.end(), removedSlots.begin(), removedSlots.end());
+    }
+}
+
+void EntityBoundsIndex::applyChange(const Change& change) {
+    auto entity = change.entity.lock();
+    // the entity has been removed, or removed and added again, since the change was made
+    if (!entity || entity->_boundsIndexSlot != change.slot) {
+        return;
+    }
+    entity->withWriteLock([&] {
+        entity->_boundsIndexChanged = false;
+    });
+
+    // if the parent of the entity isn't known yet, leave it where it was: the parent fixup recalculates its boxes
+    bool success;
+    glm::vec3 position = entity->getWorldPosition(success);
+    glm::vec3 registrationPoint = entity->getRegistrationPoint();
+    glm::vec3 maxExtents = entity->getScaledDimensions() * glm::max(registrationPoint, glm::vec3(1.0f) - registrationPoint);
+    float radius = glm::length(maxExtents) + glm::length(entity->getPivot());
+    if (!success || glm::any(glm::isnan(position)) || glm::any(glm::isinf(position)) || glm::isnan(radius) ||
+            glm::isinf(radius)) {
+        return;
+    }
+
+    Slot& slot = _slots[change.slot];
+    glm::vec3 minCorner = position - glm::vec3(radius);
+    glm::vec3 maxCorner = position + glm::vec3(radius);
+    if (slot.live && glm::all(glm::greaterThanEqual(minCorner, slot.minCorner)) &&
+            glm::all(glm::lessThanEqual(maxCorner, slot.maxCorner))) {
+        return;
+    }
+
+    float margin = MIN_LOOSE_MARGIN + LOOSE_MARGIN_SCALE * radius;
+    slot.minCorner = minCorner - glm::vec3(margin);
+    slot.maxCorner = maxCorner + glm::vec3(margin);
+    if (!slot.live) {
+        slot.entity = change.entity;
+        slot.live = true;
+        slot.node = -1;
+        slot.pendingIndex = (int32_t)_pending.size();
+        _pending.push_back(change.slot);
+        _numLive++;
+    } else if (slot.node >= 0) {
+        setLane(slot.node, slot.lane, slot.minCorner, slot.maxCorner, leafChild(change.slot));
+        refit(slot.node);
+        _numRefitsSinceRebuild++;
+    }
+}
+
+void EntityBoundsIndex::removeSlot(int32_t slotIndex) {
+    Slot& slot = _slots[slotIndex];
+    if (slot.live) {
+        if (slot.node >= 0) {
+            setLane(slot.node, slot.lane, glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX), EMPTY_CHILD);
+            refit(slot.node);
+            _numPlaced--;
+        } else {
+            int32_t last = _pending.back();
+            _pending[slot.pendingIndex] = last;
+            _slots[last].pendingIndex = slot.pendingIndex;
+            _pending.pop_back();
+        }
+        _numLive--;
+        _numRemovedSinceRebuild++;
+    }
+    _slots[slotIndex] = Slot();
+}
+
+void EntityBoundsIndex::setLane(int32_t nodeIndex, int lane, const glm::vec3& minCorner, const glm::vec3& maxCorner,
+        int32_t child) {
+    Node& node = _nodes[nodeIndex];
+    node.minX[lane] = minCorner.x;
+    node.minY[lane] = minCorner.y;
+    node.minZ[lane] = minCorner.z;
+    node.maxX[lane] = maxCorner.x;
+    node.maxY[lane] = maxCorner.y;
+    node.maxZ[lane] = maxCorner.z;
+    node.children[lane] = child;
+}
+
+void EntityBoundsIndex::refit(int32_t nodeIndex) {
+    // make the lanes of the ancestors fit their children again, up to the first one that doesn't change
+    while (nodeIndex >= 0) {
+        const Node& node = _nodes[nodeIndex];
+        if (node.parent < 0) {
+            return;
+        }
+        glm::vec3 minCorner(FLT_MAX);
+        glm::vec3 maxCorner(-FLT_MAX);
+        for (int lane = 0; lane < NUM_LANES; lane++) {
+            if (node.children[lane] != EMPTY_CHILD) {
+                minCorner = glm::min(minCorner, glm::vec3(node.minX[lane], node.minY[lane], node.minZ[lane]));
+                maxCorner = glm::max(maxCorner, glm::vec3(node.maxX[lane], node.maxY[lane], node.maxZ[lane]));
+            }
+        }
+
+        int32_t parent = node.parent;
+        int lane = node.parentLane;
+        const Node& parentNode = _nodes[parent];
+        if (parentNode.minX[lane] == minCorner.x && parentNode.minY[lane] == minCorner.y &&
+                parentNode.minZ[lane] == minCorner.z && parentNode.maxX[lane] == maxCorner.x &&
+                parentNode.maxY[lane] == maxCorner.y && parentNode.maxZ[lane] == maxCorner.z) {
+            return;
+        }
+        setLane(parent, lane, minCorner, maxCorner, nodeIndex);
+        nodeIndex = parent;
+    }
+}
+
+void EntityBoundsIndex::rebuild() {
+    std::vector<int32_t> slots;
+    slots.reserve(_numLive);
+    for (int32_t i = 0; i < (int32_t)_slots.size(); i++) {
+        if (_slots[i].live) {
+            slots.push_back(i);
+            _slots[i].pendingIndex = -1;
+        }
+    }
+    _pending.clear();
+    _nodes.clear();
+    _numPlaced = (int)slots.size();
+    _numRemovedSinceRebuild = 0;
+    _numRefitsSinceRebuild = 0;
+    _numRebuilds++;
+
+    if (!slots.empty()) {
+        _nodes.reserve(slots.size() / 2 + 1);
+        buildNode(slots.data(), slots.data() + slots.size(), -1, -1);
+    }
+}
+
+int32_t* EntityBoundsIndex::split(int32_t* begin, int32_t* end) {
+    // split at the median of the centers, along the axis where they are the most spread out
+    glm::vec3 minCenter(FLT_MAX);
+    glm::vec3 maxCenter(-FLT_MAX);
+    for (int32_t* slot = begin; slot != end; slot++) {
+        glm::vec3 center = _slots[*slot].minCorner + _slots[*slot].maxCorner;
+        minCenter = glm::min(minCenter, center);
+        maxCenter = glm::max(maxCenter, center);
+    }
+    glm::vec3 spread = maxCenter - minCenter;
+    int axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+
+    int32_t* middle = begin + (end - begin) / 2;
+    std::nth_element(begin, middle, end, [&](int32_t a, int32_t b) {
+        return _slots[a].minCorner[axis] + _slots[a].maxCorner[axis] < _slots[b].minCorner[axis] + _slots[b].maxCorner[axis];
+    });
+    return middle;
+}
+
+int32_t EntityBoundsIndex::buildNode(int32_t* begin, int32_t* end, int32_t parent, int parentLane) {
+    int32_t nodeIndex = (int32_t)_nodes.size();
+    _nodes.push_back(EMPTY_NODE);
+    _nodes[nodeIndex].parent = parent;
+    _nodes[nodeIndex].parentLane = parentLane;
+
+    int32_t* groups[NUM_LANES + 1];
+    groups[0] = begin;
+    groups[NUM_LANES] = end;
+    if (end - begin <= NUM_LANES) {
+        for (int lane = 1; lane < NUM_LANES; lane++) {
+            groups[lane] = std::min(begin + lane, end);
+        }
+    } else {
+        groups[2] = split(begin, end);
+        groups[1] = split(begin, groups[2]);
+        groups[3] = split(groups[2], end);
+    }
+
+    for (int lane = 0; lane < NUM_LANES; lane++) {
+        int32_t* groupBegin = groups[lane];
+        int32_t* groupEnd = groups[lane + 1];
+        if (groupEnd - groupBegin == 1) {
+            Slot& slot = _slots[*groupBegin];
+            slot.node = nodeIndex;
+            slot.lane = lane;
+            setLane(nodeIndex, lane, slot.minCorner, slot.maxCorner, leafChild(*groupBegin));
+        } else if (groupEnd - groupBegin > 1) {
+            glm::vec3 minCorner(FLT_MAX);
+            glm::vec3 maxCorner(-FLT_MAX);
+            for (int32_t* slot = groupBegin; slot != groupEnd; slot++) {
+                minCorner = glm::min(minCorner, _slots[*slot].minCorner);
+                maxCorner = glm::max(maxCorner, _slots[*slot].maxCorner);
+            }
+            // the recursion grows _nodes, so the lane is set by index afterwards
+            int32_t child = buildNode(groupBegin, groupEnd, nodeIndex, lane);
+            setLane(nodeIndex, lane, minCorner, maxCorner, child);
+        }
+    }
+    return nodeIndex;
+}
+
+void EntityBoundsIndex::visitSlot(int32_t slotIndex, const EntityOperator& entityOperator) const {
+    auto entity = _slots[slotIndex].entity.lock();
+    if (entity) {
+        entityOperator(entity);
+    }
+}
+
+template <typename LaneTest>
+void EntityBoundsIndex::findAll(const LaneTest& laneTest, const EntityOperator& entityOperator) {
+    float distance;
+    for (int32_t slotIndex : _pending) {
+        const Slot& slot = _slots[slotIndex];
+        if (laneTest.testBounds(slot.minCorner, slot.maxCorner, distance)) {
+            visitSlot(slotIndex, entityOperator);
+        }
+    }
+    if (_nodes.empty()) {
+        return;
+    }
+
+    std::vector<int32_t> stack;
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& node = _nodes[stack.back()];
+        stack.pop_back();
+
+        float distances[NUM_LANES];
+        int mask = laneTest.testNode(node, distances);
+        for (int lane = 0; lane < NUM_LANES; lane++) {
+            int32_t child = node.children[lane];
+            if ((mask & (1 << lane)) && child != EMPTY_CHILD) {
+                if (child >= 0) {
+                    stack.push_back(child);
+                } else {
+                    visitSlot(childSlot(child), entityOperator);
+                }
+            }
+        }
+    }
+}
+
+template <typename LaneTest>
+void EntityBoundsIndex::findSorted(const LaneTest& laneTest, const DistanceOperator& distanceOperator, float maxDistance) {
+    struct Candidate {
+        int32_t child;
+        float distance;
+        // std::priority_queue puts the greatest first
+        bool operator<(const Candidate& other) const { return distance > other.distance; }
+    };
+    std::priority_queue<Candidate> candidates;
+    float bestDistance = maxDistance;
+
+    for (int32_t slotIndex : _pending) {
+        const Slot& slot = _slots[slotIndex];
+        float distance;
+        if (laneTest.testBounds(slot.minCorner, slot.maxCorner, distance) && distance <= bestDistance) {
+            candidates.push({ leafChild(slotIndex), distance });
+        }
+    }
+    if (!_nodes.empty()) {
+        candidates.push({ 0, 0.0f });
+    }
+
+    while (!candidates.empty()) {
+        Candidate candidate = candidates.top();
+        candidates.pop();
+        if (candidate.distance > bestDistance) {
+            // everything left is farther
+            return;
+        }
+
+        if (candidate.child < EMPTY_CHILD) {
+            auto entity = _slots[childSlot(candidate.child)].entity.lock();
+            if (entity) {
+                bestDistance = std::min(bestDistance, distanceOperator(entity, candidate.distance));
+            }
+            continue;
+        }
+
+        const Node& node = _nodes[candidate.child];
+        float distances[NUM_LANES];
+        int mask = laneTest.testNode(node, distances);
+        for (int lane = 0; lane < NUM_LANES; lane++) {
+            int32_t child = node.children[lane];
+            if ((mask & (1 << lane)) && child != EMPTY_CHILD && distances[lane] <= bestDistance) {
+                candidates.push({ child, distances[lane] });
+            }
+        }
+    }
+}
+
+void EntityBoundsIndex::findInBox(const AABox& box, const EntityOperator& entityOperator) {
+    update();
+    BoxTest test { box.getMinimumPoint(), box.getMaximumPoint() };
+    withReadLock([&] {
+        findAll(test, entityOperator);
+    });
+}
+
+void EntityBoundsIndex::findInSphere(const glm::vec3& center, float radius, const EntityOperator& entityOperator) {
+    update();
+    SphereTest test { center, radius };
+    withReadLock([&] {
+        findAll(test, entityOperator);
+    });
+}
+
+void EntityBoundsIndex::findInFrustum(const ViewFrustum& frustum, const EntityOperator& entityOperator) {
+    update();
+    FrustumTest test;
+    const ::Plane* planes = frustum.getPlanes();
+    for (int i = 0; i < NUM_FRUSTUM_PLANES; i++) {
+        test.planes[i] = glm::vec4(planes[i].getNormal(), planes[i].getDCoefficient());
+    }
+    test.keyholeCenter = frustum.getPosition();
+    test.keyholeRadius = frustum.getCenterRadius();
+    withReadLock([&] {
+        findAll(test, entityOperator);
+    });
+}
+
+void EntityBoundsIndex::findNearest(const glm::vec3& point, float maxDistance, const DistanceOperator& distanceOperator) {
+    update();
+    SphereTest test { point, maxDistance };
+    withReadLock([&] {
+        findSorted(test, distanceOperator, maxDistance);
+    });
+}
+
+void EntityBoundsIndex::findAlongRay(const glm::vec3& origin, const glm::vec3& direction,
+        const DistanceOperator& distanceOperator) {
+    update();
+    RayTest test { origin, glm::vec3(safeInverse(direction.x), safeInverse(direction.y), safeInverse(direction.z)) };
+    withReadLock([&] {
+        findSorted(test, distanceOperator, FLT_MAX);
+    });
+}
+
+void EntityBoundsIndex::findAlongParabola(const glm::vec3& origin, const glm::vec3& velocity,
+        const glm::vec3& acceleration, const EntityOperator& entityOperator) {
+    update();
+    withReadLock([&] {
+        if (glm::length2(acceleration) < EPSILON) {
+            // without acceleration, it's a ray
+            glm::vec3 direction = velocity;
+            RayTest test { origin, glm::vec3(safeInverse(direction.x), safeInverse(direction.y), safeInverse(direction.z)) };
+            findAll(test, entityOperator);
+            return;
+        }
+
+        glm::vec3 normal = EntityTreeElement::getParabolaPlaneNormal(velocity, acceleration);
+        if (glm::any(glm::isnan(normal))) {
+            // velocity and acceleration are parallel, or the velocity is null
+            findAll(AnyTest(), entityOperator);
+        } else {
+            findAll(PlaneTest { origin, normal }, entityOperator);
+        }
+    });
+}
@@ -0,0 +1,141 @@
+//
+//  EntityBoundsIndex.h
+//  libraries/entities/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityBoundsIndex_h
+#define hifi_EntityBoundsIndex_h
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <shared/ReadWriteLockable.h>
+
+#include "EntityItem.h"
+
+class AABox;
+class ViewFrustum;
+
+// Bounding volume hierarchy over the entities of an EntityTree, used to answer the spatial queries of the tree
+// (entities in a box, a sphere or a frustum, the closest entity, ray and parabola picks) without walking the octree.
+//
+// The hierarchy is flat: each node holds the bounds of up to four children as packed arrays, so that one node is tested
+// against a query with a single pass of SSE instructions.  Entities are indexed by a loose cube around their position
+// that contains them for any rotation (billboards are rotated per view) plus a margin, so rotating an entity or moving it
+// a little doesn't touch the index.  When an entity leaves its loose cube, only its leaf and the bounds of the nodes
+// above it are updated.  Newly added entities are kept in a short list that is tested one by one until the next
+// rebuild, which happens once that list, or the number of entities removed since, grows too large.
+//
+// Adding, moving and removing entities only records the change, under a small mutex, so it is cheap to do from any
+// thread.  The changes are applied by the next query.
+class EntityBoundsIndex : public ReadWriteLockable, public std::enable_shared_from_this<EntityBoundsIndex> {
+public:
+    // called for each entity whose bounds overlap the query; the entity may still be outside of the query
+    using EntityOperator = std::function<void(const EntityItemPointer& entity)>;
+    // called in increasing order of the distance to the bounds, returns the distance that following entities must beat
+    using DistanceOperator = std::function<float(const EntityItemPointer& entity, float boundsDistance)>;
+
+    void addEntity(const EntityItemPointer& entity);
+    void removeEntity(const EntityItemPointer& entity);
+    // called by EntityItem when its bounds need to be recalculated
+    void entityChanged(const EntityItemPointer& entity);
+
+    // the operators must not query the index themselves
+    void findInBox(const AABox& box, const EntityOperator& entityOperator);
+    void findInSphere(const glm::vec3& center, float radius, const EntityOperator& entityOperator);
+    void findInFrustum(const ViewFrustum& frustum, const EntityOperator& entityOperator);
+    // entities whose bounds are within maxDistance of the point, nearest bounds first
+    void findNearest(const glm::vec3& point, float maxDistance, const DistanceOperator& distanceOperator);
+    // entities whose bounds are hit by the ray, nearest hit first
+    void findAlongRay(const glm::vec3& origin, const glm::vec3& direction, const DistanceOperator& distanceOperator);
+    // entities whose bounds are sliced by the plane of the parabola
+    void findAlongParabola(const glm::vec3& origin, const glm::vec3& velocity, const glm::vec3& acceleration,
+        const EntityOperator& entityOperator);
+
+    int getNumEntities();
+    int getNumNodes();
+    int getNumRebuilds() const { return _numRebuilds; }
+
+    static const int NUM_LANES = 4;
+
+    // bounds of up to four children in structure of arrays layout, an empty lane has min > max.
+    // a child >= 0 is a node, EMPTY_CHILD is nothing and anything below that encodes a slot, see leafChild().
+    // public so that the query tests in EntityBoundsIndex.cpp can read the bounds
+    struct Node {
+        float minX[NUM_LANES];
+        float minY[NUM_LANES];
+        float minZ[NUM_LANES];
+        float maxX[NUM_LANES];
+        float maxY[NUM_LANES];
+        float maxZ[NUM_LANES];
+        int32_t children[NUM_LANES];
+        int32_t parent { -1 };
+        int32_t parentLane { -1 };
+    };
+
+private:
+    struct Slot {
+        EntityItemWeakPointer entity;
+        glm::vec3 minCorner;
+        glm::vec3 maxCorner;
+        int32_t node { -1 };            // the node that holds it, or -1 when pending
+        int32_t lane { -1 };
+        int32_t pendingIndex { -1 };    // position in _pending, or -1 when in a node
+        bool live { false };
+    };
+
+    struct Change {
+        EntityItemWeakPointer entity;
+        int32_t slot;
+    };
+
+    static const int32_t EMPTY_CHILD = -1;
+    static int32_t leafChild(int32_t slot) { return -(slot + 2); }
+    static int32_t childSlot(int32_t child) { return -child - 2; }
+
+    void update();
+    void applyChange(const Change& change);
+    void removeSlot(int32_t slotIndex);
+    void setLane(int32_t nodeIndex, int lane, const glm::vec3& minCorner, const glm::vec3& maxCorner, int32_t child);
+    void refit(int32_t nodeIndex);
+    void rebuild();
+    int32_t buildNode(int32_t* begin, int32_t* end, int32_t parent, int parentLane);
+    int32_t* split(int32_t* begin, int32_t* end);
+    void visitSlot(int32_t slotIndex, const EntityOperator& entityOperator) const;
+
+    template <typename LaneTest>
+    void findAll(const LaneTest& laneTest, const EntityOperator& entityOperator);
+    template <typename LaneTest>
+    void findSorted(const LaneTest& laneTest, const DistanceOperator& distanceOperator, float maxDistance);
+
+    // guards the changes not yet applied, and the slot numbers
+    std::mutex _changesMutex;
+    std::unordered_map<EntityItem*, Change> _changes;
+    std::vector<int32_t> _removedSlots;
+    std::vector<int32_t> _freeSlots;
+    int32_t _numSlots { 0 };
+
+    // guarded by the read/write lock
+    std::vector<Node> _nodes;
+    std::vector<Slot> _slots;
+    std::vector<int32_t> _pending;
+    int _numLive { 0 };
+    int _numPlaced { 0 };
+    int _numRemovedSinceRebuild { 0 };
+    int _numRefitsSinceRebuild { 0 };
+    int _numRebuilds { 0 };
+};
+
+using EntityBoundsIndexPointer = std::shared_ptr<EntityBoundsIndex>;
+
+#endif // hifi_EntityBoundsIndex_h
@@ -0,0 +1,263 @@
+//
+//  EntityEditFilterRules.cpp
+//  libraries/entities/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityEditFilterRules.h"
+
+#include <algorithm>
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+// past this many senders, the buckets that have refilled are forgotten
+const int MAX_RATE_LIMITED_SENDERS = 256;
+
+static bool readVec3(const QJsonValue& value, glm::vec3& result) {
+    if (!value.isObject()) {
+        return false;
+    }
+    QJsonObject object = value.toObject();
+    if (!object["x"].isDouble() || !object["y"].isDouble() || !object["z"].isDouble()) {
+        return false;
+    }
+    result = glm::vec3(object["x"].toDouble(), object["y"].toDouble(), object["z"].toDouble());
+    return true;
+}
+
+static bool readFilterType(const QString& name, EntityTree::FilterType& filterType) {
+    if (name == "add") {
+        filterType = EntityTree::FilterType::Add;
+    } else if (name == "edit") {
+        filterType = EntityTree::FilterType::Edit;
+    } else if (name == "physics") {
+        filterType = EntityTree::FilterType::Physics;
+    } else if (name == "delete") {
+        filterType = EntityTree::FilterType::Delete;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool EntityEditFilterRules::isRulesDocument(const QByteArray& contents) {
+    QByteArray trimmed = contents.trimmed();
+    return !trimmed.isEmpty() && trimmed[0] == '{';
+}
+
+std::shared_ptr<EntityEditFilterRules> EntityEditFilterRules::fromJson(const QByteArray& json, QString& error) {
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        error = parseError.errorString() + " at offset " + QString::number(parseError.offset);
+        return nullptr;
+    }
+    if (!document.isObject() || !document.object()["rules"].isArray()) {
+        error = "expected an object with a \"rules\" array";
+        return nullptr;
+    }
+    QJsonObject root = document.object();
+
+    auto result = std::make_shared<EntityEditFilterRules>();
+
+    if (root.contains("filterTypes")) {
+        for (const auto& value : root["filterTypes"].toArray()) {
+            EntityTree::FilterType filterType;
+            if (!readFilterType(value.toString(), filterType)) {
+                error = "unknown filter type " + value.toString();
+                return nullptr;
+            }
+            result->_filterTypes |= 1 << filterType;
+        }
+    } else {
+        result->_filterTypes = (1 << EntityTree::FilterType::Add) | (1 << EntityTree::FilterType::Edit) |
+            (1 << EntityTree::FilterType::Physics);
+    }
+
+    QJsonArray rules = root["rules"].toArray();
+    for (int i = 0; i < rules.size(); i++) {
+        QJsonObject object = rules[i].toObject();
+        QString type = object["type"].toString();
+        QString ruleName = QString("rule %1 (%2)").arg(i).arg(type);
+
+        Rule rule;
+        QString action = object["action"].toString("clamp");
+        if (action == "reject") {
+            rule.action = Action::Reject;
+        } else if (action != "clamp") {
+            error = ruleName + ": unknown action " + action;
+            return nullptr;
+        }
+
+        if (type == "bounds") {
+            rule.type = RuleType::Bounds;
+            rule.useZoneBounds = object["zone"].toBool(false);
+            if (rule.useZoneBounds) {
+                result->_wantsZoneBounds = true;
+            } else if (!readVec3(object["min"], rule.minimum) || !readVec3(object["max"], rule.maximum)) {
+                error = ruleName + ": expected \"min\" and \"max\" or \"zone\"";
+                return nullptr;
+            }
+        } else if (type == "maxDimensions") {
+            rule.type = RuleType::MaxDimensions;
+            if (!readVec3(object["max"], rule.maximum)) {
+                error = ruleName + ": expected \"max\"";
+                return nullptr;
+            }
+        } else if (type == "rejectProperties") {
+            rule.type = RuleType::RejectProperties;
+            rule.action = Action::Reject;
+            for (const auto& value : object["properties"].toArray()) {
+                QString propertyName = value.toString();
+                EntityPropertyInfo propertyInfo;
+                EntityPropertyFlags groupFlags;
+                if (EntityItemProperties::getPropertyInfo(propertyName, propertyInfo)) {
+                    rule.properties.push_back(propertyInfo.propertyEnum);
+                } else if (EntityItemProperties::getGroupPropertyFlags(propertyName, groupFlags)) {
+                    for (int flag = (int)groupFlags.firstFlag(); flag <= (int)groupFlags.lastFlag(); flag++) {
+                        if (groupFlags.getHasProperty((EntityPropertyList)flag)) {
+                            rule.properties.push_back((EntityPropertyList)flag);
+                        }
+                    }
+                } else {
+                    error = ruleName + ": unknown property " + propertyName;
+                    return nullptr;
+                }
+            }
+        } else if (type == "rateLimit") {
+            rule.type = RuleType::RateLimit;
+            rule.action = Action::Reject;
+            rule.editsPerSecond = (float)object["editsPerSecond"].toDouble(0.0);
+            if (rule.editsPerSecond <= 0.0f) {
+                error = ruleName + ": expected a positive \"editsPerSecond\"";
+                return nullptr;
+            }
+            rule.burst = std::max(1.0f, (float)object["burst"].toDouble(rule.editsPerSecond));
+        } else {
+            error = ruleName + ": unknown rule type";
+            return nullptr;
+        }
+        result->_rules.push_back(rule);
+    }
+    result->_buckets.resize(result->_rules.size());
+    return result;
+}
+
+bool EntityEditFilterRules::takeToken(const Rule& rule, int ruleIndex, const QUuid& senderID) {
+    std::lock_guard<std::mutex> lock(_bucketsMutex);
+    QHash<QUuid, TokenBucket>& buckets = _buckets[ruleIndex];
+    quint64 now = usecTimestampNow();
+
+    auto refill = [&](TokenBucket& bucket) {
+        float elapsed = (float)(now - bucket.lastRefill) / USECS_PER_SECOND;
+        bucket.tokens = std::min(rule.burst, bucket.tokens + elapsed * rule.editsPerSecond);
+        bucket.lastRefill = now;
+    };
+
+    if (buckets.size() > MAX_RATE_LIMITED_SENDERS) {
+        for (auto iter = buckets.begin(); iter != buckets.end();) {
+            refill(*iter);
+            if (iter->tokens >= rule.burst) {
+                iter = buckets.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+
+    auto iter = buckets.find(senderID);
+    if (iter == buckets.end()) {
+        TokenBucket bucket;
+        bucket.tokens = rule.burst;
+        bucket.lastRefill = now;
+        iter = buckets.insert(senderID, bucket);
+    }
+    TokenBucket& bucket = *iter;
+    refill(bucket);
+    if (bucket.tokens < 1.0f) {
+        return false;
+    }
+    bucket.tokens -= 1.0f;
+    return true;
+}
+
+bool EntityEditFilterRules::filter(EntityItemProperties& properties, const EntityItemPointer& existingEntity,
+        const AABox* zoneBounds, const QUuid& senderID, bool& wasChanged) {
+    for (int i = 0; i < (int)_rules.size(); i++) {
+        const Rule& rule = _rules[i];
+        switch (rule.type) {
+            case RuleType::Bounds: {
+                if (!properties.containsPositionChange()) {
+                    break;
+                }
+                // the position of a child is relative to its parent
+                QUuid parentID = properties.parentIDChanged() ? properties.getParentID() :
+                    (existingEntity ? existingEntity->getParentID() : QUuid());
+                if (!parentID.isNull()) {
+                    break;
+                }
+                glm::vec3 minimum = rule.minimum;
+                glm::vec3 maximum = rule.maximum;
+                if (rule.useZoneBounds) {
+                    if (!zoneBounds) {
+                        break;
+                    }
+                    minimum = zoneBounds->getMinimumPoint();
+                    maximum = zoneBounds->getMaximumPoint();
+                }
+                glm::vec3 position = properties.getPosition();
+                glm::vec3 clampedPosition = glm::clamp(position, minimum, maximum);
+                if (clampedPosition != position) {
+                    if (rule.action == Action::Reject) {
+                        return false;
+                    }
+                    properties.setPosition(clampedPosition);
+                    wasChanged = true;
+                }
+                break;
+            }
+
+            case RuleType::MaxDimensions: {
+                if (!properties.containsDimensionsChange()) {
+                    break;
+                }
+                glm::vec3 dimensions = properties.getDimensions();
+                glm::vec3 clampedDimensions = glm::min(dimensions, rule.maximum);
+                if (clampedDimensions != dimensions) {
+                    if (rule.action == Action::Reject) {
+                        return false;
+                    }
+                    properties.setDimensions(clampedDimensions);
+                    wasChanged = true;
+                }
+                break;
+            }
+
+            case RuleType::RejectProperties: {
+                EntityPropertyFlags changedProperties = properties.getChangedProperties();
+                for (auto property : rule.properties) {
+                    if (changedProperties.getHasProperty(property)) {
+                        return false;
+                    }
+                }
+                break;
+            }
+
+            case RuleType::RateLimit:
+                if (!takeToken(rule, i, senderID)) {
+                    return false;
+                }
+                break;
+        }
+    }
+    return true;
+}
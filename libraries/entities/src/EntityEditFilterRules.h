@@ -0,0 +1,104 @@
+//
+//  EntityEditFilterRules.h
+//  libraries/entities/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityEditFilterRules_h
+#define hifi_EntityEditFilterRules_h
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QHash>
+#include <QtCore/QUuid>
+#include <glm/glm.hpp>
+
+#include <AABox.h>
+#include <OctreeConstants.h>
+
+#include "EntityItemProperties.h"
+#include "EntityTree.h"
+
+// Script free edit filter for the common policies of a domain.  The filter URL of a zone or of the entity server may
+// point to a json document instead of a script:
+//
+//    {
+//        "filterTypes": [ "add", "edit", "physics" ],
+//        "rules": [
+//            { "type": "bounds", "min": { "x": -100, "y": 0, "z": -100 }, "max": { "x": 100, "y": 50, "z": 100 } },
+//            { "type": "bounds", "zone": true, "action": "reject" },
+//            { "type": "maxDimensions", "max": { "x": 10, "y": 10, "z": 10 } },
+//            { "type": "rejectProperties", "properties": [ "script", "serverScripts" ] },
+//            { "type": "rateLimit", "editsPerSecond": 20, "burst": 40 }
+//        ]
+//    }
+//
+// "filterTypes" defaults to every type but deletes, like filter scripts.  Bounds apply to the position of entities
+// without a parent, "zone" uses the bounding box of the zone the filter is set on.  Bounds and dimensions are clamped
+// unless "action" is "reject".  Rate limits are per sender.  The rules are checked natively, in order, and the first
+// one that rejects the edit stops the filter.
+class EntityEditFilterRules {
+public:
+    enum class RuleType {
+        Bounds,
+        MaxDimensions,
+        RejectProperties,
+        RateLimit
+    };
+
+    enum class Action {
+        Clamp,
+        Reject
+    };
+
+    struct Rule {
+        RuleType type { RuleType::Bounds };
+        Action action { Action::Clamp };
+        glm::vec3 minimum { (float)-HALF_TREE_SCALE };
+        glm::vec3 maximum { (float)HALF_TREE_SCALE };
+        bool useZoneBounds { false };
+        std::vector<EntityPropertyList> properties;
+        float editsPerSecond { 0.0f };
+        float burst { 0.0f };
+    };
+
+    // true if the contents of a filter URL are rules rather than a script
+    static bool isRulesDocument(const QByteArray& contents);
+    // returns null, and sets the error, if the document can't be parsed
+    static std::shared_ptr<EntityEditFilterRules> fromJson(const QByteArray& json, QString& error);
+
+    bool wantsToFilter(EntityTree::FilterType filterType) const { return (_filterTypes & (1 << filterType)) != 0; }
+    bool wantsZoneBounds() const { return _wantsZoneBounds; }
+    const std::vector<Rule>& getRules() const { return _rules; }
+
+    // returns false if the edit is rejected, sets wasChanged if a rule changed the properties.
+    // zoneBounds is only used by the rules on the bounds of the zone, it may be null.
+    bool filter(EntityItemProperties& properties, const EntityItemPointer& existingEntity, const AABox* zoneBounds,
+        const QUuid& senderID, bool& wasChanged);
+
+private:
+    struct TokenBucket {
+        float tokens { 0.0f };
+        quint64 lastRefill { 0 };
+    };
+
+    bool takeToken(const Rule& rule, int ruleIndex, const QUuid& senderID);
+
+    std::vector<Rule> _rules;
+    int _filterTypes { 0 };
+    bool _wantsZoneBounds { false };
+
+    // rate limit buckets by rule and sender
+    std::mutex _bucketsMutex;
+    std::vector<QHash<QUuid, TokenBucket>> _buckets;
+};
+
+using EntityEditFilterRulesPointer = std::shared_ptr<EntityEditFilterRules>;
+
+#endif // hifi_EntityEditFilterRules_h
@@ -11,11 +11,44 @@
 
 #include "EntityEditFilters.h"
 
+#include <QRegularExpression>
+#include <QSet>
 #include <QUrl>
 
 #include <ResourceManager.h>
 #include <shared/ScriptInitializerMixin.h>
 
+#include "EntityItemPropertiesMacros.h"
+
+EntityEditFilters::FilterEnginePool::~FilterEnginePool() {
+    // the pool can go away on an edit thread, the engines belong to the thread that loaded the script
+    for (auto& filterEngine : _engines) {
+        filterEngine->engine->deleteLater();
+    }
+}
+
+void EntityEditFilters::FilterEnginePool::addEngine(const FilterEngine& engine) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _engines.push_back(std::unique_ptr<FilterEngine>(new FilterEngine(engine)));
+    _freeEngines.push_back(_engines.back().get());
+}
+
+std::shared_ptr<EntityEditFilters::FilterEngine> EntityEditFilters::FilterEnginePool::acquire() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _engineReleased.wait(lock, [this] { return !_freeEngines.empty(); });
+    FilterEngine* engine = _freeEngines.back();
+    _freeEngines.pop_back();
+    return std::shared_ptr<FilterEngine>(engine, [this](FilterEngine* engine) { release(engine); });
+}
+
+void EntityEditFilters::FilterEnginePool::release(FilterEngine* engine) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _freeEngines.push_back(engine);
+    }
+    _engineReleased.notify_one();
+}
+
 QList<EntityItemID> EntityEditFilters::getZonesByPosition(glm::vec3& position) {
     QList<EntityItemID> zones;
     QList<EntityItemID> missingZones;
@@ -42,8 +75,66 @@ QList<EntityItemID> EntityEditFilters::getZonesByPosition(glm::vec3& position) {
     return zones;
 }
 
+bool EntityEditFilters::filterWithRules(const FilterData& filterData, const EntityItemID& zoneID,
+        EntityItemProperties& propertiesIn, EntityItemProperties& propertiesOut, bool& wasChanged,
+        EntityTree::FilterType filterType, const EntityItemPointer& existingEntity, const QUuid& senderID) {
+    if (!filterData.rules->wantsToFilter(filterType)) {
+        return true;
+    }
+
+    AABox zoneBounds;
+    bool hasZoneBounds = false;
+    if (filterData.rules->wantsZoneBounds() && !zoneID.isInvalidID()) {
+        auto zoneEntity = _tree->findEntityByEntityItemID(zoneID);
+        if (zoneEntity) {
+            zoneBounds = zoneEntity->getAABox(hasZoneBounds);
+        }
+    }
+
+    bool rulesChanged = false;
+    if (!filterData.rules->filter(propertiesIn, existingEntity, hasZoneBounds ? &zoneBounds : nullptr, senderID,
+            rulesChanged)) {
+        return false;
+    }
+    if (rulesChanged) {
+        if (&propertiesOut != &propertiesIn) {
+            propertiesOut = propertiesIn;
+        }
+        wasChanged = true;
+    }
+    return true;
+}
+
+// Converts the edited properties that the filter function reads, the others are left out of the script object.
+static QScriptValue readPropertiesToScriptValue(const EntityEditFilters::FilterData& filterData,
+        EntityItemProperties& properties, QScriptEngine* engine) {
+    auto oldProperties = properties.getDesiredProperties();
+    auto specifiedProperties = properties.getChangedProperties();
+    if (!filterData.readsAllProperties) {
+        EntityPropertyFlags readProperties;
+        for (auto property : filterData.readProperties) {
+            if (specifiedProperties.getHasProperty(property)) {
+                readProperties << property;
+            }
+        }
+        if (readProperties.isEmpty()) {
+            // an empty set of desired properties would copy all of them
+            QScriptValue values = engine->newObject();
+            values.setProperty("type", EntityTypes::getEntityTypeName(properties.getType()));
+            values.setProperty("lastEdited", convertScriptValue(engine, properties.getLastEdited()));
+            return values;
+        }
+        specifiedProperties = readProperties;
+    }
+    properties.setDesiredProperties(specifiedProperties);
+    QScriptValue values = properties.copyToScriptValue(engine, false, true, true);
+    properties.setDesiredProperties(oldProperties);
+    return values;
+}
+
 bool EntityEditFilters::filter(glm::vec3& position, EntityItemProperties& propertiesIn, EntityItemProperties& propertiesOut,
-        bool& wasChanged, EntityTree::FilterType filterType, EntityItemID& itemID, const EntityItemPointer& existingEntity) {
+        bool& wasChanged, EntityTree::FilterType filterType, EntityItemID& itemID, const EntityItemPointer& existingEntity,
+        const QUuid& senderID) {
     
     // get the ids of all the zones (plus the global entity edit filter) that the position
     // lies within
@@ -63,6 +154,14 @@ bool EntityEditFilters::filter(glm::vec3& position, EntityItemProperties& proper
                 return false;
             }
 
+            if (filterData.rules) {
+                if (!filterWithRules(filterData, id, propertiesIn, propertiesOut, wasChanged, filterType, existingEntity,
+                        senderID)) {
+                    return false;
+                }
+                continue;
+            }
+
             // check to see if this filter wants to filter this message type
             if ((!filterData.wantsToFilterEdit && filterType == EntityTree::FilterType::Edit) ||
                 (!filterData.wantsToFilterPhysics && filterType == EntityTree::FilterType::Physics) ||
@@ -73,11 +172,10 @@ bool EntityEditFilters::filter(glm::vec3& position, EntityItemProperties& proper
                 return true; // accept the message
             }
 
-            auto oldProperties = propertiesIn.getDesiredProperties();
-            auto specifiedProperties = propertiesIn.getChangedProperties();
-            propertiesIn.setDesiredProperties(specifiedProperties);
-            QScriptValue inputValues = propertiesIn.copyToScriptValue(filterData.engine, false, true, true);
-            propertiesIn.setDesiredProperties(oldProperties);
+            auto filterEngine = filterData.engines->acquire();
+            QScriptEngine* engine = filterEngine->engine;
+
+            QScriptValue inputValues = readPropertiesToScriptValue(filterData, propertiesIn, engine);
 
             auto in = QJsonValue::fromVariant(inputValues.toVariant()); // grab json copy now, because the inputValues might be side effected by the filter.
 
@@ -88,7 +186,7 @@ bool EntityEditFilters::filter(glm::vec3& position, EntityItemProperties& proper
             // get the current properties for then entity and include them for the filter call
             if (existingEntity && filterData.wantsOriginalProperties) {
                 auto currentProperties = existingEntity->getProperties(filterData.includedOriginalProperties);
-                QScriptValue currentValues = currentProperties.copyToScriptValue(filterData.engine, false, true, true);
+                QScriptValue currentValues = currentProperties.copyToScriptValue(engine, false, true, true);
                 args << currentValues;
             }
 
@@ -98,17 +196,17 @@ bool EntityEditFilters::filter(glm::vec3& position, EntityItemProperties& proper
                 auto zoneEntity = _tree->findEntityByEntityItemID(id);
                 if (zoneEntity) {
                     auto zoneProperties = zoneEntity->getProperties(filterData.includedZoneProperties);
-                    QScriptValue zoneValues = zoneProperties.copyToScriptValue(filterData.engine, false, true, true);
+                    QScriptValue zoneValues = zoneProperties.copyToScriptValue(engine, false, true, true);
 
                     if (filterData.wantsZoneBoundingBox) {
                         bool success = true;
                         AABox aaBox = zoneEntity->getAABox(success);
                         if (success) {
-                            QScriptValue boundingBox = filterData.engine->newObject();
-                            QScriptValue bottomRightNear = vec3ToScriptValue(filterData.engine, aaBox.getCorner());
-                            QScriptValue topFarLeft = vec3ToScriptValue(filterData.engine, aaBox.calcTopFarLeft());
-                            QScriptValue center = vec3ToScriptValue(filterData.engine, aaBox.calcCenter());
-                            QScriptValue boundingBoxDimensions = vec3ToScriptValue(filterData.engine, aaBox.getDimensions());
+                            QScriptValue boundingBox = engine->newObject();
+                            QScriptValue bottomRightNear = vec3ToScriptValue(engine, aaBox.getCorner());
+                            QScriptValue topFarLeft = vec3ToScriptValue(engine, aaBox.calcTopFarLeft());
+                            QScriptValue center = vec3ToScriptValue(engine, aaBox.calcCenter());
+                            QScriptValue boundingBoxDimensions = vec3ToScriptValue(engine, aaBox.getDimensions());
                             boundingBox.setProperty("brn", bottomRightNear);
                             boundingBox.setProperty("tfl", topFarLeft);
                             boundingBox.setProperty("center", center);
@@ -129,9 +227,9 @@ bool EntityEditFilters::filter(glm::vec3& position, EntityItemProperties& proper
                 }
             }
 
-            QScriptValue result = filterData.filterFn.call(_nullObjectForFilter, args);
+            QScriptValue result = filterEngine->filterFn.call(_nullObjectForFilter, args);
 
-            if (filterData.uncaughtExceptions()) {
+            if (filterEngine->uncaughtExceptions()) {
                 return false;
             }
 
@@ -165,11 +263,8 @@ bool EntityEditFilters::filter(glm::vec3& position, EntityItemProperties& proper
 }
 
 void EntityEditFilters::removeFilter(EntityItemID entityID) {
+    // the engines are deleted once the filter calls that borrowed them are done
     QWriteLocker writeLock(&_lock);
-    FilterData filterData = _filterDataMap.value(entityID);
-    if (filterData.valid()) {
-        delete filterData.engine;
-    }
     _filterDataMap.remove(entityID);
 }
 
@@ -215,6 +310,18 @@ void EntityEditFilters::addFilter(EntityItemID entityID, QString filterURL) {
     qDebug() << "script request sent for entity " << entityID;
 }
 
+void EntityEditFilters::addFilterRules(EntityItemID entityID, const EntityEditFilterRulesPointer& rules) {
+    FilterData filterData;
+    filterData.rules = rules;
+    _lock.lockForWrite();
+    _filterDataMap.insert(entityID, filterData);
+    _lock.unlock();
+
+    qDebug() << "filter rules processed for entity id " << entityID;
+
+    emit filterAdded(entityID, true);
+}
+
 // Copied from ScriptEngine.cpp. We should make this a class method for reuse.
 // Note: I've deliberately stopped short of using ScriptEngine instead of QScriptEngine, as that is out of project scope at this point.
 static bool hasCorrectSyntax(const QScriptProgram& program) {
@@ -248,6 +355,101 @@ static bool hadUncaughtExceptions(QScriptEngine& engine, const QString& fileName
     return false;
 }
 
+// Works out which properties of an edit the filter function reads, so that only those are converted for each call.
+// The function can list them in its wantsProperties, otherwise they're the property names the script mentions.  A
+// script that could read properties by computed names, or walk all of them, reads all of them.
+static void findReadProperties(const QString& scriptContents, const QScriptValue& filterFn,
+        EntityEditFilters::FilterData& filterData) {
+    QSet<int> readProperties;
+    auto addProperty = [&readProperties](const QString& name) {
+        EntityPropertyInfo propertyInfo;
+        EntityPropertyFlags groupFlags;
+        if (EntityItemProperties::getPropertyInfo(name, propertyInfo)) {
+            readProperties.insert(propertyInfo.propertyEnum);
+        } else if (EntityItemProperties::getGroupPropertyFlags(name, groupFlags)) {
+            for (int flag = (int)groupFlags.firstFlag(); flag <= (int)groupFlags.lastFlag(); flag++) {
+                if (groupFlags.getHasProperty((EntityPropertyList)flag)) {
+                    readProperties.insert(flag);
+                }
+            }
+        }
+    };
+
+    // if the wantsProperties is a boolean, or a string, or list of strings, then evaluate as follows:
+    //   - boolean - true  - the filter reads all properties
+    //               false - no properties at all
+    //   - string  - just that property
+    //   - list of strings - only those properties
+    QScriptValue wantsPropertiesValue = filterFn.property("wantsProperties");
+    if (wantsPropertiesValue.isBool()) {
+        filterData.readsAllProperties = wantsPropertiesValue.toBool();
+    } else if (wantsPropertiesValue.isString()) {
+        filterData.readsAllProperties = false;
+        addProperty(wantsPropertiesValue.toString());
+    } else if (wantsPropertiesValue.isArray()) {
+        filterData.readsAllProperties = false;
+        auto length = wantsPropertiesValue.property("length").toInteger();
+        for (int i = 0; i < length; i++) {
+            addProperty(wantsPropertiesValue.property(i).toString());
+        }
+    } else {
+        static const QRegularExpression READS_ALL_PROPERTIES("Object\\s*\\.\\s*(keys|getOwnPropertyNames|entries|assign)"
+            "|JSON\\s*\\.\\s*stringify|\\bfor\\s*\\([^)]*\\bin\\b|[\\w\\)\\]]\\s*\\[\\s*[^\\]'\"\\d\\s]");
+        if (READS_ALL_PROPERTIES.match(scriptContents).hasMatch()) {
+            filterData.readsAllProperties = true;
+            return;
+        }
+        filterData.readsAllProperties = false;
+        static const QRegularExpression IDENTIFIER("[A-Za-z_$][\\w$]*");
+        QSet<QString> names;
+        auto iterator = IDENTIFIER.globalMatch(scriptContents);
+        while (iterator.hasNext()) {
+            names.insert(iterator.next().captured());
+        }
+        for (const auto& name : names) {
+            addProperty(name);
+        }
+    }
+
+    filterData.readProperties.clear();
+    for (int property : readProperties) {
+        filterData.readProperties.push_back((EntityPropertyList)property);
+    }
+}
+
+// Evaluates the script in a new engine, returns false if that threw.
+static bool createFilterEngine(const QString& scriptContents, const QString& urlString, const EntityItemID& entityID,
+        EntityEditFilters::FilterEngine& filterEngine) {
+    QScriptEngine* engine = new QScriptEngine();
+    engine->setObjectName("filter:" + entityID.toString());
+    engine->setProperty("type", "edit_filter");
+    engine->setProperty("fileName", urlString);
+    engine->setProperty("entityID", entityID);
+    engine->globalObject().setProperty("Script", engine->newQObject(engine));
+    DependencyManager::get<ScriptInitializers>()->runScriptInitializers(engine);
+    engine->evaluate(scriptContents, urlString);
+    if (hadUncaughtExceptions(*engine, urlString)) {
+        delete engine;
+        return false;
+    }
+    filterEngine.engine = engine;
+
+    // define the uncaughtException function
+    QScriptEngine& engineRef = *engine;
+    filterEngine.uncaughtExceptions = [&engineRef, urlString]() { return hadUncaughtExceptions(engineRef, urlString); };
+
+    // now get the filter function
+    auto global = engine->globalObject();
+    auto entitiesObject = engine->newObject();
+    entitiesObject.setProperty("ADD_FILTER_TYPE", EntityTree::FilterType::Add);
+    entitiesObject.setProperty("EDIT_FILTER_TYPE", EntityTree::FilterType::Edit);
+    entitiesObject.setProperty("PHYSICS_FILTER_TYPE", EntityTree::FilterType::Physics);
+    entitiesObject.setProperty("DELETE_FILTER_TYPE", EntityTree::FilterType::Delete);
+    global.setProperty("Entities", entitiesObject);
+    filterEngine.filterFn = global.property("filter");
+    return true;
+}
+
 void EntityEditFilters::scriptRequestFinished(EntityItemID entityID) {
     qDebug() << "script request completed for entity " << entityID;
     auto scriptRequest = qobject_cast<ResourceRequest*>(sender());
@@ -255,118 +457,116 @@ void EntityEditFilters::scriptRequestFinished(EntityItemID entityID) {
         const QString urlString = scriptRequest->getUrl().toString();
         auto scriptContents = scriptRequest->getData();
         qInfo() << "Downloaded script:" << scriptContents;
-        QScriptProgram program(scriptContents, urlString);
-        if (hasCorrectSyntax(program)) {
-            // create a QScriptEngine for this script
-            QScriptEngine* engine = new QScriptEngine();
-            engine->setObjectName("filter:" + entityID.toString());
-            engine->setProperty("type", "edit_filter");
-            engine->setProperty("fileName", urlString);
-            engine->setProperty("entityID", entityID);
-            engine->globalObject().setProperty("Script", engine->newQObject(engine));
-            DependencyManager::get<ScriptInitializers>()->runScriptInitializers(engine);
-            engine->evaluate(scriptContents, urlString);
-            if (!hadUncaughtExceptions(*engine, urlString)) {
-                // put the engine in the engine map (so we don't leak them, etc...)
+        if (EntityEditFilterRules::isRulesDocument(scriptContents)) {
+            // a json document of rules that are checked natively
+            QString error;
+            auto rules = EntityEditFilterRules::fromJson(scriptContents, error);
+            if (rules) {
+                addFilterRules(entityID, rules);
+                return;
+            }
+            qCritical() << "Invalid filter rules in" << urlString << ":" << error;
+        } else {
+            QScriptProgram program(scriptContents, urlString);
+            FilterEngine filterEngine;
+            if (hasCorrectSyntax(program) && createFilterEngine(scriptContents, urlString, entityID, filterEngine)) {
                 FilterData filterData;
-                filterData.engine = engine;
-                filterData.rejectAll = false;
-                
-                // define the uncaughtException function
-                QScriptEngine& engineRef = *engine;
-                filterData.uncaughtExceptions = [&engineRef, urlString]() { return hadUncaughtExceptions(engineRef, urlString); };
-
-                // now get the filter function
-                auto global = engine->globalObject();
-                auto entitiesObject = engine->newObject();
-                entitiesObject.setProperty("ADD_FILTER_TYPE", EntityTree::FilterType::Add);
-                entitiesObject.setProperty("EDIT_FILTER_TYPE", EntityTree::FilterType::Edit);
-                entitiesObject.setProperty("PHYSICS_FILTER_TYPE", EntityTree::FilterType::Physics);
-                entitiesObject.setProperty("DELETE_FILTER_TYPE", EntityTree::FilterType::Delete);
-                global.setProperty("Entities", entitiesObject);
-                filterData.filterFn = global.property("filter");
-                if (!filterData.filterFn.isFunction()) {
+                if (!filterEngine.filterFn.isFunction()) {
                     qDebug() << "Filter function specified but not found. Will reject all edits for those without lock rights.";
-                    delete engine;
-                    filterData.rejectAll=true;
-                }
-
-                // if the wantsToFilterEdit is a boolean evaluate as a boolean, otherwise assume true
-                QScriptValue wantsToFilterAddValue = filterData.filterFn.property("wantsToFilterAdd");
-                filterData.wantsToFilterAdd = wantsToFilterAddValue.isBool() ? wantsToFilterAddValue.toBool() : true;
-
-                // if the wantsToFilterEdit is a boolean evaluate as a boolean, otherwise assume true
-                QScriptValue wantsToFilterEditValue = filterData.filterFn.property("wantsToFilterEdit");
-                filterData.wantsToFilterEdit = wantsToFilterEditValue.isBool() ? wantsToFilterEditValue.toBool() : true;
-
-                // if the wantsToFilterPhysics is a boolean evaluate as a boolean, otherwise assume true
-                QScriptValue wantsToFilterPhysicsValue = filterData.filterFn.property("wantsToFilterPhysics");
-                filterData.wantsToFilterPhysics = wantsToFilterPhysicsValue.isBool() ? wantsToFilterPhysicsValue.toBool() : true;
-
-                // if the wantsToFilterDelete is a boolean evaluate as a boolean, otherwise assume false
-                QScriptValue wantsToFilterDeleteValue = filterData.filterFn.property("wantsToFilterDelete");
-                filterData.wantsToFilterDelete = wantsToFilterDeleteValue.isBool() ? wantsToFilterDeleteValue.toBool() : false;
-
-                // check to see if the filterFn has properties asking for Original props
-                QScriptValue wantsOriginalPropertiesValue = filterData.filterFn.property("wantsOriginalProperties");
-                // if the wantsOriginalProperties is a boolean, or a string, or list of strings, then evaluate as follows:
-                //   - boolean - true  - include all original properties
-                //               false - no properties at all
-                //   - string  - empty - no properties at all
-                //               any valid property - include just that property in the Original properties
-                //   - list of strings - include only those properties in the Original properties
-                if (wantsOriginalPropertiesValue.isBool()) {
-                    filterData.wantsOriginalProperties = wantsOriginalPropertiesValue.toBool();
-                } else if (wantsOriginalPropertiesValue.isString()) {
-                    auto stringValue = wantsOriginalPropertiesValue.toString();
-                    filterData.wantsOriginalProperties = !stringValue.isEmpty();
-                    if (filterData.wantsOriginalProperties) {
+                    delete filterEngine.engine;
+                    filterData.rejectAll = true;
+                } else {
+                    filterData.engines = std::make_shared<FilterEnginePool>();
+                    filterData.engines->addEngine(filterEngine);
+
+                    // if the wantsToFilterEdit is a boolean evaluate as a boolean, otherwise assume true
+                    QScriptValue wantsToFilterAddValue = filterEngine.filterFn.property("wantsToFilterAdd");
+                    filterData.wantsToFilterAdd = wantsToFilterAddValue.isBool() ? wantsToFilterAddValue.toBool() : true;
+
+                    // if the wantsToFilterEdit is a boolean evaluate as a boolean, otherwise assume true
+                    QScriptValue wantsToFilterEditValue = filterEngine.filterFn.property("wantsToFilterEdit");
+                    filterData.wantsToFilterEdit = wantsToFilterEditValue.isBool() ? wantsToFilterEditValue.toBool() : true;
+
+                    // if the wantsToFilterPhysics is a boolean evaluate as a boolean, otherwise assume true
+                    QScriptValue wantsToFilterPhysicsValue = filterEngine.filterFn.property("wantsToFilterPhysics");
+                    filterData.wantsToFilterPhysics = wantsToFilterPhysicsValue.isBool() ? wantsToFilterPhysicsValue.toBool() : true;
+
+                    // if the wantsToFilterDelete is a boolean evaluate as a boolean, otherwise assume false
+                    QScriptValue wantsToFilterDeleteValue = filterEngine.filterFn.property("wantsToFilterDelete");
+                    filterData.wantsToFilterDelete = wantsToFilterDeleteValue.isBool() ? wantsToFilterDeleteValue.toBool() : false;
+
+                    // check to see if the filterFn has properties asking for Original props
+                    QScriptValue wantsOriginalPropertiesValue = filterEngine.filterFn.property("wantsOriginalProperties");
+                    // if the wantsOriginalProperties is a boolean, or a string, or list of strings, then evaluate as follows:
+                    //   - boolean - true  - include all original properties
+                    //               false - no properties at all
+                    //   - string  - empty - no properties at all
+                    //               any valid property - include just that property in the Original properties
+                    //   - list of strings - include only those properties in the Original properties
+                    if (wantsOriginalPropertiesValue.isBool()) {
+                        filterData.wantsOriginalProperties = wantsOriginalPropertiesValue.toBool();
+                    } else if (wantsOriginalPropertiesValue.isString()) {
+                        auto stringValue = wantsOriginalPropertiesValue.toString();
+                        filterData.wantsOriginalProperties = !stringValue.isEmpty();
+                        if (filterData.wantsOriginalProperties) {
+                            EntityPropertyFlagsFromScriptValue(wantsOriginalPropertiesValue, filterData.includedOriginalProperties);
+                        }
+                    } else if (wantsOriginalPropertiesValue.isArray()) {
                         EntityPropertyFlagsFromScriptValue(wantsOriginalPropertiesValue, filterData.includedOriginalProperties);
+                        filterData.wantsOriginalProperties = !filterData.includedOriginalProperties.isEmpty();
                     }
-                } else if (wantsOriginalPropertiesValue.isArray()) {
-                    EntityPropertyFlagsFromScriptValue(wantsOriginalPropertiesValue, filterData.includedOriginalProperties);
-                    filterData.wantsOriginalProperties = !filterData.includedOriginalProperties.isEmpty();
-                }
 
-                // check to see if the filterFn has properties asking for Zone props
-                QScriptValue wantsZonePropertiesValue = filterData.filterFn.property("wantsZoneProperties");
-                // if the wantsZoneProperties is a boolean, or a string, or list of strings, then evaluate as follows:
-                //   - boolean - true  - include all Zone properties
-                //               false - no properties at all
-                //   - string  - empty - no properties at all
-                //               any valid property - include just that property in the Zone properties
-                //   - list of strings - include only those properties in the Zone properties
-                if (wantsZonePropertiesValue.isBool()) {
-                    filterData.wantsZoneProperties = wantsZonePropertiesValue.toBool();
-                    filterData.wantsZoneBoundingBox = filterData.wantsZoneProperties; // include this too
-                } else if (wantsZonePropertiesValue.isString()) {
-                    auto stringValue = wantsZonePropertiesValue.toString();
-                    filterData.wantsZoneProperties = !stringValue.isEmpty();
-                    if (filterData.wantsZoneProperties) {
-                        if (stringValue == "boundingBox") {
-                            filterData.wantsZoneBoundingBox = true;
-                        } else {
-                            EntityPropertyFlagsFromScriptValue(wantsZonePropertiesValue, filterData.includedZoneProperties);
-                        }
-                    }
-                } else if (wantsZonePropertiesValue.isArray()) {
-                    auto length = wantsZonePropertiesValue.property("length").toInteger();
-                    for (int i = 0; i < length; i++) {
-                        auto stringValue = wantsZonePropertiesValue.property(i).toString();
-                        if (!stringValue.isEmpty()) {
-                            filterData.wantsZoneProperties = true;
-
-                            // boundingBox is a special case since it's not a true EntityPropertyFlag, so we
-                            // need to detect it here.
+                    // check to see if the filterFn has properties asking for Zone props
+                    QScriptValue wantsZonePropertiesValue = filterEngine.filterFn.property("wantsZoneProperties");
+                    // if the wantsZoneProperties is a boolean, or a string, or list of strings, then evaluate as follows:
+                    //   - boolean - true  - include all Zone properties
+                    //               false - no properties at all
+                    //   - string  - empty - no properties at all
+                    //               any valid property - include just that property in the Zone properties
+                    //   - list of strings - include only those properties in the Zone properties
+                    if (wantsZonePropertiesValue.isBool()) {
+                        filterData.wantsZoneProperties = wantsZonePropertiesValue.toBool();
+                        filterData.wantsZoneBoundingBox = filterData.wantsZoneProperties; // include this too
+                    } else if (wantsZonePropertiesValue.isString()) {
+                        auto stringValue = wantsZonePropertiesValue.toString();
+                        filterData.wantsZoneProperties = !stringValue.isEmpty();
+                        if (filterData.wantsZoneProperties) {
                             if (stringValue == "boundingBox") {
                                 filterData.wantsZoneBoundingBox = true;
-                                break; // we can break here, since there are no other special cases
+                            } else {
+                                EntityPropertyFlagsFromScriptValue(wantsZonePropertiesValue, filterData.includedZoneProperties);
                             }
+                        }
+                    } else if (wantsZonePropertiesValue.isArray()) {
+                        auto length = wantsZonePropertiesValue.property("length").toInteger();
+                        for (int i = 0; i < length; i++) {
+                            auto stringValue = wantsZonePropertiesValue.property(i).toString();
+                            if (!stringValue.isEmpty()) {
+                                filterData.wantsZoneProperties = true;
+
+                                // boundingBox is a special case since it's not a true EntityPropertyFlag, so we
+                                // need to detect it here.
+                                if (stringValue == "boundingBox") {
+                                    filterData.wantsZoneBoundingBox = true;
+                                    break; // we can break here, since there are no other special cases
+                                }
 
+                            }
+                        }
+                        if (filterData.wantsZoneProperties) {
+                            EntityPropertyFlagsFromScriptValue(wantsZonePropertiesValue, filterData.includedZoneProperties);
                         }
                     }
-                    if (filterData.wantsZoneProperties) {
-                        EntityPropertyFlagsFromScriptValue(wantsZonePropertiesValue, filterData.includedZoneProperties);
+
+                    findReadProperties(scriptContents, filterEngine.filterFn, filterData);
+
+                    // the other engines of the pool, each with its own evaluation of the script
+                    for (int i = 1; i < _enginePoolSize; i++) {
+                        FilterEngine poolEngine;
+                        if (!createFilterEngine(scriptContents, urlString, entityID, poolEngine)) {
+                            break;
+                        }
+                        filterData.engines->addEngine(poolEngine);
                     }
                 }
 
@@ -379,7 +579,7 @@ void EntityEditFilters::scriptRequestFinished(EntityItemID entityID) {
                 emit filterAdded(entityID, true);
                 return;
             }
-        } 
+        }
     } else if (scriptRequest) {
         const QString urlString = scriptRequest->getUrl().toString();
         qCritical() << "Failed to download script";
@@ -15,10 +15,17 @@
 #include <QMap>
 #include <QScriptValue>
 #include <QScriptEngine>
+#include <QThread>
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
+#include "EntityEditFilterRules.h"
 #include "EntityItemID.h"
 #include "EntityItemProperties.h"
 #include "EntityTree.h"
@@ -26,8 +33,37 @@
 class EntityEditFilters : public QObject, public Dependency {
     Q_OBJECT
 public:
-    struct FilterData {
+    struct FilterEngine {
+        QScriptEngine* engine { nullptr };
         QScriptValue filterFn;
+        std::function<bool()> uncaughtExceptions;
+    };
+
+    // A QScriptEngine isn't thread safe, so each filter script is evaluated in a few engines and every call borrows one
+    // of them.  That lets the edit threads of the entity server filter edits at the same time.  The engines are
+    // deleted with the last reference to the pool, so removing a filter that is in use is safe.
+    class FilterEnginePool {
+    public:
+        ~FilterEnginePool();
+
+        void addEngine(const FilterEngine& engine);
+        bool isEmpty() const { return _engines.empty(); }
+
+        // blocks until an engine is free, the engine goes back to the pool with the last copy of the pointer
+        std::shared_ptr<FilterEngine> acquire();
+
+    private:
+        void release(FilterEngine* engine);
+
+        std::vector<std::unique_ptr<FilterEngine>> _engines;
+        std::vector<FilterEngine*> _freeEngines;
+        std::mutex _mutex;
+        std::condition_variable _engineReleased;
+    };
+
+    struct FilterData {
+        std::shared_ptr<FilterEnginePool> engines;
+        EntityEditFilterRulesPointer rules;
         bool wantsOriginalProperties { false };
         bool wantsZoneProperties { false };
 
@@ -40,22 +76,30 @@ public:
         EntityPropertyFlags includedZoneProperties;
         bool wantsZoneBoundingBox { false };
 
-        std::function<bool()> uncaughtExceptions;
-        QScriptEngine* engine;
-        bool rejectAll;
-        
-        FilterData(): engine(nullptr), rejectAll(false) {};
-        bool valid() { return (rejectAll || (engine != nullptr && filterFn.isFunction() && uncaughtExceptions)); }
+        // the properties of an edit the filter function reads, only those are converted to script values
+        bool readsAllProperties { true };
+        std::vector<EntityPropertyList> readProperties;
+
+        bool rejectAll { false };
+
+        bool valid() const { return rejectAll || rules || (engines && !engines->isEmpty()); }
     };
 
     EntityEditFilters() {};
     EntityEditFilters(EntityTreePointer tree ): _tree(tree) {};
 
     void addFilter(EntityItemID entityID, QString filterURL);
+    // adds rules that have already been parsed, as addFilter() does once a rules document has been downloaded
+    void addFilterRules(EntityItemID entityID, const EntityEditFilterRulesPointer& rules);
     void removeFilter(EntityItemID entityID);
 
+    // the number of engines each filter script runs on, scripts loaded later use it
+    void setEnginePoolSize(int size) { _enginePoolSize = std::max(1, size); }
+    int getEnginePoolSize() const { return _enginePoolSize; }
+
     bool filter(glm::vec3& position, EntityItemProperties& propertiesIn, EntityItemProperties& propertiesOut, bool& wasChanged, 
-                EntityTree::FilterType filterType, EntityItemID& entityID, const EntityItemPointer& existingEntity);
+                EntityTree::FilterType filterType, EntityItemID& entityID, const EntityItemPointer& existingEntity,
+                const QUuid& senderID = QUuid());
 
 signals:
     void filterAdded(EntityItemID id, bool success);
@@ -65,10 +109,14 @@ private slots:
     
 private:
     QList<EntityItemID> getZonesByPosition(glm::vec3& position);
+    bool filterWithRules(const FilterData& filterData, const EntityItemID& zoneID, EntityItemProperties& propertiesIn,
+        EntityItemProperties& propertiesOut, bool& wasChanged, EntityTree::FilterType filterType,
+        const EntityItemPointer& existingEntity, const QUuid& senderID);
 
     EntityTreePointer _tree {};
     bool _rejectAll {false};
     QScriptValue _nullObjectForFilter{};
+    int _enginePoolSize { std::max(1, std::min(4, QThread::idealThreadCount())) };
     
     QReadWriteLock _lock;
     QMap<EntityItemID, FilterData> _filterDataMap;
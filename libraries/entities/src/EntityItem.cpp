@@ -400,6 +400,61 @@ OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packet
     return appendState;
 }
 
+std::atomic<quint64> EntityItem::_encodedDataCacheHits { 0 };
+std::atomic<quint64> EntityItem::_encodedDataCacheMisses { 0 };
+
+EntityItem::EncodedDataPointer EntityItem::getEncodedData(bool withPrivateUserData) const {
+    auto encodedData = std::make_shared<EncodedData>();
+    withReadLock([&] {
+        encodedData->lastEdited = _lastEdited;
+        encodedData->lastUpdated = _lastUpdated;
+        encodedData->lastSimulated = _lastSimulated;
+        encodedData->changedOnServer = _changedOnServer;
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(_encodedDataMutex);
+        const EncodedDataPointer& cached = _encodedData[withPrivateUserData ? 1 : 0];
+        if (cached && cached->lastEdited == encodedData->lastEdited && cached->lastUpdated == encodedData->lastUpdated &&
+            cached->lastSimulated == encodedData->lastSimulated && cached->changedOnServer == encodedData->changedOnServer) {
+            _encodedDataCacheHits++;
+            return cached;
+        }
+    }
+    _encodedDataCacheMisses++;
+
+    // Encode outside of the lock, other send threads can keep using the old encoding in the meantime.  The timestamps were
+    // read before encoding, so an edit that lands part way through leaves this encoding stale and it is rebuilt next time.
+    OctreePacketData packetData;
+    EncodeBitstreamParams params;
+    auto extraEncodeData = std::make_shared<EntityTreeElementExtraEncodeData>();
+    if (appendEntityData(&packetData, params, extraEncodeData, withPrivateUserData) != OctreeElement::COMPLETED) {
+        // bigger than a packet, these are always sent piecewise
+        return EncodedDataPointer();
+    }
+    encodedData->data = QByteArray((const char*)packetData.getUncompressedData(), packetData.getUncompressedSize());
+
+    std::lock_guard<std::mutex> lock(_encodedDataMutex);
+    _encodedData[withPrivateUserData ? 1 : 0] = encodedData;
+    return encodedData;
+}
+
+OctreeElement::AppendState EntityItem::appendCachedEntityData(OctreePacketData* packetData, EncodeBitstreamParams& params,
+                                            EntityTreeElementExtraEncodeDataPointer entityTreeElementExtraEncodeData,
+                                            const bool destinationNodeCanGetAndSetPrivateUserData) const {
+    // the parent ID of AVATAR_SELF_ID is converted while encoding, and the remaining properties of a partially sent entity
+    // are tracked per client, neither of which can be shared.
+    bool isContinuation = entityTreeElementExtraEncodeData && entityTreeElementExtraEncodeData->entities.contains(getEntityItemID());
+    if (!isContinuation && getParentID() != AVATAR_SELF_ID) {
+        EncodedDataPointer encodedData = getEncodedData(destinationNodeCanGetAndSetPrivateUserData);
+        if (encodedData && packetData->appendRawData(encodedData->data)) {
+            params.trackSend(getID(), encodedData->lastEdited);
+            return OctreeElement::COMPLETED;
+        }
+    }
+    return appendEntityData(packetData, params, entityTreeElementExtraEncodeData, destinationNodeCanGetAndSetPrivateUserData);
+}
+
 // TODO: My goal is to get rid of this concept completely. The old code (and some of the current code) used this
 // result to calculate if a packet being sent to it was potentially bad or corrupt. I've adjusted this to now
 // only consider the minimum header bytes as being required. But it would be preferable to completely eliminate
@@ -2757,6 +2812,7 @@ void EntityItem::setLastEdited(quint64 lastEdited) {
             _lastEdited = _lastUpdated = lastEdited;
             _changedOnServer = glm::max(lastEdited, _changedOnServer);
         });
+        journalChange();
     }
 }
 
@@ -2764,6 +2820,14 @@ void EntityItem::markAsChangedOnServer() {
     withWriteLock([&] {
         _changedOnServer = usecTimestampNow();
     });
+    journalChange();
+}
+
+void EntityItem::journalChange() const {
+    EntityTreePointer tree = getTree();
+    if (tree && tree->isJournalEnabled()) {
+        tree->journalEntityChange(getEntityItemID(), OctreeJournal::RecordType::Edit);
+    }
 }
 
 quint64 EntityItem::getLastChangedOnServer() const {
@@ -2789,11 +2853,19 @@ quint64 EntityItem::getLastUpdated() const {
 }
 
 void EntityItem::requiresRecalcBoxes() {
+    std::shared_ptr<EntityBoundsIndex> boundsIndex;
     withWriteLock([&] {
         _recalcAABox = true;
         _recalcMinAACube = true;
         _recalcMaxAACube = true;
+        if (!_boundsIndexChanged) {
+            boundsIndex = _boundsIndex.lock();
+            _boundsIndexChanged = boundsIndex != nullptr;
+        }
     });
+    if (boundsIndex) {
+        boundsIndex->entityChanged(getThisPointer());
+    }
 }
 
 QString EntityItem::getHref() const {
@@ -12,7 +12,9 @@
 #ifndef hifi_EntityItem_h
 #define hifi_EntityItem_h
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <stdint.h>
 
 #include <glm/glm.hpp>
@@ -45,6 +47,7 @@ class EntityTreeElementExtraEncodeData;
 class EntityDynamicInterface;
 class EntityItemProperties;
 class EntityTree;
+class EntityBoundsIndex;
 class btCollisionShape;
 typedef std::shared_ptr<EntityTree> EntityTreePointer;
 typedef std::shared_ptr<EntityDynamicInterface> EntityDynamicPointer;
@@ -87,6 +90,7 @@ class EntityItem : public QObject, public SpatiallyNestable, public ReadWriteLoc
     // do cleanup.
     friend class EntityTreeElement;
     friend class EntitySimulation;
+    friend class EntityBoundsIndex;
 public:
 
     DONT_ALLOW_INSTANTIATION // This class can not be instantiated directly
@@ -139,6 +143,16 @@ public:
                                                         EntityTreeElementExtraEncodeDataPointer entityTreeElementExtraEncodeData,
                                                         const bool destinationNodeCanGetAndSetPrivateUserData = false) const;
 
+    // Same as appendEntityData(), but copies a full encoding of this entity that is shared by every EntityTreeSendThread.
+    // The encoding is rebuilt on demand after the entity is edited, updated or simulated, and the regular encode path is used
+    // when the whole entity doesn't fit in what's left of the packet or is part way through being sent.
+    OctreeElement::AppendState appendCachedEntityData(OctreePacketData* packetData, EncodeBitstreamParams& params,
+                                                      EntityTreeElementExtraEncodeDataPointer entityTreeElementExtraEncodeData,
+                                                      const bool destinationNodeCanGetAndSetPrivateUserData = false) const;
+
+    static quint64 getEncodedDataCacheHits() { return _encodedDataCacheHits; }
+    static quint64 getEncodedDataCacheMisses() { return _encodedDataCacheMisses; }
+
     virtual void appendSubclassData(OctreePacketData* packetData, EncodeBitstreamParams& params,
                                     EntityTreeElementExtraEncodeDataPointer entityTreeElementExtraEncodeData,
                                     EntityPropertyFlags& requestedProperties,
@@ -596,6 +610,9 @@ protected:
 
     void somethingChangedNotification();
 
+    // marks this entity for the tree's journal, if it has one
+    void journalChange() const;
+
     void setSimulated(bool simulated) { _simulated = simulated; }
 
     const QByteArray getDynamicDataInternal() const;
@@ -618,6 +635,21 @@ protected:
     quint64 _created { 0 };
     quint64 _changedOnServer { 0 };
 
+    // full encodings written by appendCachedEntityData(), with and without the private user data
+    struct EncodedData {
+        quint64 lastEdited;
+        quint64 lastUpdated;
+        quint64 lastSimulated;
+        quint64 changedOnServer;
+        QByteArray data;
+    };
+    using EncodedDataPointer = std::shared_ptr<const EncodedData>;
+    EncodedDataPointer getEncodedData(bool withPrivateUserData) const;
+    mutable std::mutex _encodedDataMutex;
+    mutable EncodedDataPointer _encodedData[2];
+    static std::atomic<quint64> _encodedDataCacheHits;
+    static std::atomic<quint64> _encodedDataCacheMisses;
+
     mutable AABox _cachedAABox;
     mutable AACube _maxAACube;
     mutable AACube _minAACube;
@@ -754,6 +786,11 @@ protected:
     float _boundingRadius { 0.0f };
     int32_t _spaceIndex { -1 }; // index to proxy in workload::Space
 
+    // set by EntityBoundsIndex, the first two are guarded by the entity lock
+    std::weak_ptr<EntityBoundsIndex> _boundsIndex;
+    bool _boundsIndexChanged { false }; // a change is queued in the index
+    std::atomic<int32_t> _boundsIndexSlot { -1 };
+
     // TODO: move this "scriptSimulationPriority" and "pendingOwnership" stuff into EntityMotionState
     // but first would need to do some other cleanup. In the meantime these live here as "scratch space"
     // to allow libs that don't know about each other to communicate.
@@ -3005,6 +3005,22 @@ bool EntityItemProperties::getPropertyInfo(const QString& propertyName, EntityPr
     return false;
 }
 
+bool EntityItemProperties::getGroupPropertyFlags(const QString& groupName, EntityPropertyFlags& flags) {
+    // make sure the map is filled
+    EntityPropertyInfo propertyInfo;
+    getPropertyInfo(groupName, propertyInfo);
+
+    bool found = false;
+    QString prefix = groupName + ".";
+    for (auto iter = _propertyInfos.cbegin(); iter != _propertyInfos.cend(); ++iter) {
+        if (iter.key().startsWith(prefix)) {
+            flags << iter.value().propertyEnum;
+            found = true;
+        }
+    }
+    return found;
+}
+
 /*@jsdoc
  * Information about an entity property.
  * @typedef {object} Entities.EntityPropertyInfo
@@ -142,6 +142,8 @@ public:
     static void entityPropertyFlagsFromScriptValue(const QScriptValue& object, EntityPropertyFlags& flags);
 
     static bool getPropertyInfo(const QString& propertyName, EntityPropertyInfo& propertyInfo);
+    // adds the flags of every property of a group, like "keyLight", returns false if there is no such group
+    static bool getGroupPropertyFlags(const QString& groupName, EntityPropertyFlags& flags);
 
     // editing related features supported by all entities
     quint64 getLastEdited() const { return _lastEdited; }
@@ -0,0 +1,1010 @@
+//
+//  EntityJSONReader.cpp
+//  libraries/entities/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityJSONReader.h"
+
+#include <cctype>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <QtCore/QHash>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QLocale>
+#include <QtScript/QScriptEngine>
+
+#include <OctreeEntitiesFileParser.h>
+#include <SharedUtil.h>
+#include <VariantMapToScriptValue.h>
+
+const int EntityJSONReader::DEFAULT_BATCH_SIZE = 1000;
+
+// the parser thread gets at most this many batches ahead of the operator
+static const size_t MAX_QUEUED_BATCHES = 2;
+
+static const int MAX_NUMBER_LENGTH = 64;
+
+// A position in the json text, with the few primitives the reader needs.  Values are read without copying the text
+// they come from, apart from strings that contain escapes.
+class JSONCursor {
+public:
+    JSONCursor(const QByteArray& json, int position = 0) :
+        _begin(json.constData()),
+        _end(json.constData() + json.size()),
+        _position(json.constData() + position)
+    {
+    }
+
+    int getPosition() const { return (int)(_position - _begin); }
+    void setPosition(int position) { _position = _begin + position; }
+    const char* getData(int position) const { return _begin + position; }
+
+    // the next character that isn't whitespace, without consuming it, or 0 at the end
+    char peek() {
+        while (_position < _end && (*_position == ' ' || *_position == '\n' || *_position == '\r' || *_position == '\t')) {
+            ++_position;
+        }
+        return _position < _end ? *_position : 0;
+    }
+
+    bool consume(char c) {
+        if (peek() == c) {
+            ++_position;
+            return true;
+        }
+        return false;
+    }
+
+    // a key without escapes refers to the text, so that looking it up doesn't allocate
+    bool readKey(QByteArray& key) {
+        if (!consume('"')) {
+            return false;
+        }
+        const char* start = _position;
+        while (_position < _end && *_position != '"' && *_position != '\\') {
+            ++_position;
+        }
+        if (_position < _end && *_position == '"') {
+            key = QByteArray::fromRawData(start, (int)(_position - start));
+            ++_position;
+            return true;
+        }
+        _position = start - 1;
+        QString escapedKey;
+        if (!readString(escapedKey)) {
+            return false;
+        }
+        key = escapedKey.toUtf8();
+        return true;
+    }
+
+    bool readString(QString& value) {
+        if (!consume('"')) {
+            return false;
+        }
+        QString result;
+        const char* segment = _position;
+        while (_position < _end) {
+            char c = *_position;
+            if (c == '"') {
+                result += QString::fromUtf8(segment, (int)(_position - segment));
+                ++_position;
+                value = result;
+                return true;
+            } else if (c == '\\') {
+                result += QString::fromUtf8(segment, (int)(_position - segment));
+                if (++_position >= _end) {
+                    return false;
+                }
+                switch (*_position++) {
+                    case '"': result += '"'; break;
+                    case '\\': result += '\\'; break;
+                    case '/': result += '/'; break;
+                    case 'b': result += '\b'; break;
+                    case 'f': result += '\f'; break;
+                    case 'n': result += '\n'; break;
+                    case 'r': result += '\r'; break;
+                    case 't': result += '\t'; break;
+                    case 'u': {
+                        // surrogate pairs come as two escapes, which QString puts back together
+                        if (_end - _position < 4) {
+                            return false;
+                        }
+                        bool ok;
+                        ushort code = QByteArray(_position, 4).toUShort(&ok, 16);
+                        if (!ok) {
+                            return false;
+                        }
+                        result += QChar(code);
+                        _position += 4;
+                        break;
+                    }
+                    default:
+                        return false;
+                }
+                segment = _position;
+            } else if ((unsigned char)c < 0x20) {
+                return false;
+            } else {
+                ++_position;
+            }
+        }
+        return false;
+    }
+
+    bool readNumber(double& value) {
+        peek();
+        const char* start = _position;
+        while (_position < _end && (isdigit((unsigned char)*_position) || *_position == '-' || *_position == '+' ||
+                                    *_position == '.' || *_position == 'e' || *_position == 'E')) {
+            ++_position;
+        }
+        int length = (int)(_position - start);
+        if (length == 0 || length > MAX_NUMBER_LENGTH) {
+            _position = start;
+            return false;
+        }
+        QChar number[MAX_NUMBER_LENGTH];
+        for (int i = 0; i < length; i++) {
+            number[i] = QLatin1Char(start[i]);
+        }
+        bool ok;
+        value = QLocale::c().toDouble(QStringView(number, length), &ok);
+        return ok;
+    }
+
+    bool readBool(bool& value) {
+        peek();
+        if (_end - _position >= 4 && memcmp(_position, "true", 4) == 0) {
+            _position += 4;
+            value = true;
+            return true;
+        }
+        if (_end - _position >= 5 && memcmp(_position, "false", 5) == 0) {
+            _position += 5;
+            value = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool skipValue() {
+        char c = peek();
+        if (c == '"') {
+            ++_position;
+            return skipStringContents();
+        }
+        if (c == '{' || c == '[') {
+            int depth = 0;
+            while (_position < _end) {
+                c = *_position++;
+                if (c == '{' || c == '[') {
+                    ++depth;
+                } else if (c == '}' || c == ']') {
+                    if (--depth == 0) {
+                        return true;
+                    }
+                } else if (c == '"' && !skipStringContents()) {
+                    return false;
+                }
+            }
+            return false;
+        }
+        // number, true, false or null
+        const char* start = _position;
+        while (_position < _end && (isalnum((unsigned char)*_position) || *_position == '-' || *_position == '+' ||
+                                    *_position == '.')) {
+            ++_position;
+        }
+        return _position > start;
+    }
+
+private:
+    bool skipStringContents() {
+        while (_position < _end) {
+            char c = *_position++;
+            if (c == '"') {
+                return true;
+            } else if (c == '\\') {
+                ++_position;
+            }
+        }
+        return false;
+    }
+
+    const char* _begin;
+    const char* _end;
+    const char* _position;
+};
+
+namespace {
+
+// Each reader parses a value of its type or returns false, leaving the value to the QScriptValue conversion.
+// They follow the T##_convertFromScriptValue functions in EntityItemPropertiesMacros.h.
+
+bool bool_readFromJSON(JSONCursor& cursor, bool& value) {
+    return cursor.readBool(value);
+}
+
+bool float_readFromJSON(JSONCursor& cursor, float& value) {
+    double number;
+    if (!cursor.readNumber(number)) {
+        return false;
+    }
+    value = (float)number;
+    return true;
+}
+
+template <typename T>
+bool readInteger(JSONCursor& cursor, T& value) {
+    double number;
+    if (!cursor.readNumber(number)) {
+        return false;
+    }
+    value = (T)qRound64(number);
+    return true;
+}
+
+bool quint64_readFromJSON(JSONCursor& cursor, quint64& value) {
+    // timestamps lose precision as a double, so integers are read as such
+    cursor.peek();
+    int start = cursor.getPosition();
+    double number;
+    if (!cursor.readNumber(number) || number < 0.0) {
+        return false;
+    }
+    bool ok;
+    value = QByteArray(cursor.getData(start), cursor.getPosition() - start).toULongLong(&ok);
+    if (!ok) {
+        value = (quint64)number;
+    }
+    return true;
+}
+
+bool quint32_readFromJSON(JSONCursor& cursor, quint32& value) {
+    double number;
+    if (!cursor.readNumber(number) || number < 0.0 || number > (double)UINT32_MAX || number != (double)(quint32)number) {
+        return false;
+    }
+    value = (quint32)number;
+    return true;
+}
+
+bool quint16_readFromJSON(JSONCursor& cursor, quint16& value) { return readInteger(cursor, value); }
+bool uint16_t_readFromJSON(JSONCursor& cursor, uint16_t& value) { return readInteger(cursor, value); }
+bool uint32_t_readFromJSON(JSONCursor& cursor, uint32_t& value) { return readInteger(cursor, value); }
+
+bool uint8_t_readFromJSON(JSONCursor& cursor, uint8_t& value) {
+    int number;
+    if (!readInteger(cursor, number)) {
+        return false;
+    }
+    value = (uint8_t)(0xff & number);
+    return true;
+}
+
+bool QString_readFromJSON(JSONCursor& cursor, QString& value) {
+    if (!cursor.readString(value)) {
+        return false;
+    }
+    value = value.trimmed();
+    return true;
+}
+
+bool QUuid_readFromJSON(JSONCursor& cursor, QUuid& value) {
+    QString string;
+    if (!cursor.readString(string)) {
+        return false;
+    }
+    value = QUuid(string);
+    return true;
+}
+
+bool EntityItemID_readFromJSON(JSONCursor& cursor, EntityItemID& value) {
+    QUuid uuid;
+    if (!QUuid_readFromJSON(cursor, uuid)) {
+        return false;
+    }
+    value = EntityItemID(uuid);
+    return true;
+}
+
+bool QByteArray_readFromJSON(JSONCursor& cursor, QByteArray& value) {
+    QString base64;
+    if (!QString_readFromJSON(cursor, base64)) {
+        return false;
+    }
+    value = QByteArray::fromBase64(base64.toUtf8());
+    return true;
+}
+
+// urls relative to the file are resolved like OctreeEntitiesFileParser::resolveRelativeURLs does, values holding an
+// object of urls are left to it
+bool readURL(JSONCursor& cursor, const QUrl& relativeURL, QString& value) {
+    if (!QString_readFromJSON(cursor, value)) {
+        return false;
+    }
+    if (!relativeURL.isEmpty()) {
+        if (value.startsWith("{")) {
+            return false;
+        }
+        if (value.startsWith("./") || value.startsWith("../")) {
+            value = relativeURL.resolved(value).toString();
+        }
+    }
+    return true;
+}
+
+// reads an object of numbers, each key is the name or an alias of one of the components.  every component has to be
+// present and there can't be any other keys.
+template <int N>
+bool readComponents(JSONCursor& cursor, float (&components)[N], int (*getComponentIndex)(const QByteArray& key)) {
+    if (!cursor.consume('{')) {
+        return false;
+    }
+    int found = 0;
+    if (!cursor.consume('}')) {
+        do {
+            QByteArray key;
+            double number;
+            if (!cursor.readKey(key) || !cursor.consume(':')) {
+                return false;
+            }
+            int index = getComponentIndex(key);
+            if (index < 0 || (found & (1 << index)) || !cursor.readNumber(number)) {
+                return false;
+            }
+            components[index] = (float)number;
+            found |= 1 << index;
+        } while (cursor.consume(','));
+        if (!cursor.consume('}')) {
+            return false;
+        }
+    }
+    return found == (1 << N) - 1;
+}
+
+int getVec3ComponentIndex(const QByteArray& key) {
+    if (key == "x" || key == "r" || key == "red") {
+        return 0;
+    } else if (key == "y" || key == "g" || key == "green") {
+        return 1;
+    } else if (key == "z" || key == "b" || key == "blue") {
+        return 2;
+    }
+    return -1;
+}
+
+int getQuatComponentIndex(const QByteArray& key) {
+    if (key.size() == 1) {
+        switch (key[0]) {
+            case 'x': return 0;
+            case 'y': return 1;
+            case 'z': return 2;
+            case 'w': return 3;
+        }
+    }
+    return -1;
+}
+
+int getAACubeComponentIndex(const QByteArray& key) {
+    if (key == "scale") {
+        return 3;
+    }
+    return key.size() == 1 ? getQuatComponentIndex(key) : -1;
+}
+
+bool vec3_readFromJSON(JSONCursor& cursor, glm::vec3& value) {
+    float components[3];
+    if (!readComponents(cursor, components, getVec3ComponentIndex)) {
+        return false;
+    }
+    value = glm::vec3(components[0], components[1], components[2]);
+    return true;
+}
+
+bool vec3Color_readFromJSON(JSONCursor& cursor, glm::vec3& value) {
+    return vec3_readFromJSON(cursor, value);
+}
+
+bool u8vec3Color_readFromJSON(JSONCursor& cursor, glm::u8vec3& value) {
+    float components[3];
+    if (!readComponents(cursor, components, getVec3ComponentIndex)) {
+        return false;
+    }
+    value = glm::u8vec3((uint8_t)qRound64(components[0]), (uint8_t)qRound64(components[1]), (uint8_t)qRound64(components[2]));
+    return true;
+}
+
+bool quat_readFromJSON(JSONCursor& cursor, glm::quat& value) {
+    float components[4];
+    if (!readComponents(cursor, components, getQuatComponentIndex)) {
+        return false;
+    }
+    value = glm::quat(components[3], components[0], components[1], components[2]);
+    return !glm::isnan(value.x) && !glm::isnan(value.y) && !glm::isnan(value.z) && !glm::isnan(value.w);
+}
+
+bool AACube_readFromJSON(JSONCursor& cursor, AACube& value) {
+    float components[4];
+    if (!readComponents(cursor, components, getAACubeComponentIndex)) {
+        return false;
+    }
+    value.setBox(glm::vec3(components[0], components[1], components[2]), components[3]);
+    return true;
+}
+
+using PropertyReader = bool (*)(JSONCursor& cursor, EntityItemProperties& properties, const QUrl& relativeURL);
+
+#define READ_JSON_PROPERTY(P, T, S)                                                         \
+    { #P, [](JSONCursor& cursor, EntityItemProperties& properties, const QUrl&) {           \
+        T value;                                                                            \
+        if (!T##_readFromJSON(cursor, value)) {                                             \
+            return false;                                                                   \
+        }                                                                                   \
+        properties.S(value);                                                                \
+        return true;                                                                        \
+    } }
+
+#define READ_JSON_PROPERTY_URL(P, S)                                                        \
+    { #P, [](JSONCursor& cursor, EntityItemProperties& properties, const QUrl& relativeURL) { \
+        QString value;                                                                      \
+        if (!readURL(cursor, relativeURL, value)) {                                         \
+            return false;                                                                   \
+        }                                                                                   \
+        properties.S(value);                                                                \
+        return true;                                                                        \
+    } }
+
+#define READ_JSON_PROPERTY_ENUM(P, S)                                                       \
+    { #P, [](JSONCursor& cursor, EntityItemProperties& properties, const QUrl&) {           \
+        QString value;                                                                      \
+        if (!cursor.readString(value)) {                                                    \
+            return false;                                                                   \
+        }                                                                                   \
+        properties.set##S##FromString(value);                                               \
+        return true;                                                                        \
+    } }
+
+// values written with the entity that can't be set
+#define SKIP_JSON_PROPERTY(P)                                                               \
+    { #P, [](JSONCursor& cursor, EntityItemProperties&, const QUrl&) {                      \
+        return cursor.skipValue();                                                          \
+    } }
+
+// The properties EntityItemProperties::copyFromScriptValue reads with a plain setter, in the same order.  Left out,
+// and so converted through a QScriptValue: group properties, lists, vec2 and QRect values, and the properties
+// copyFromScriptValue treats together with others (textures, imageURL, billboardMode, faceCamera, isFacingAvatar).
+// The legacy names that are still written alongside their property set the same value.
+const QHash<QByteArray, PropertyReader>& getPropertyReaders() {
+    static const QHash<QByteArray, PropertyReader> propertyReaders {
+        { "type", [](JSONCursor& cursor, EntityItemProperties& properties, const QUrl&) {
+            QString value;
+            if (!cursor.readString(value)) {
+                return false;
+            }
+            properties.setType(value);
+            return true;
+        } },
+
+        // Core
+        READ_JSON_PROPERTY(parentID, QUuid, setParentID),
+        READ_JSON_PROPERTY(parentJointIndex, quint16, setParentJointIndex),
+        READ_JSON_PROPERTY(visible, bool, setVisible),
+        READ_JSON_PROPERTY(name, QString, setName),
+        READ_JSON_PROPERTY(locked, bool, setLocked),
+        READ_JSON_PROPERTY(userData, QString, setUserData),
+        READ_JSON_PROPERTY(privateUserData, QString, setPrivateUserData),
+        READ_JSON_PROPERTY_URL(href, setHref),
+        READ_JSON_PROPERTY(description, QString, setDescription),
+        READ_JSON_PROPERTY(position, vec3, setPosition),
+        READ_JSON_PROPERTY(dimensions, vec3, setDimensions),
+        READ_JSON_PROPERTY(rotation, quat, setRotation),
+        READ_JSON_PROPERTY(registrationPoint, vec3, setRegistrationPoint),
+        READ_JSON_PROPERTY(created, quint64, setCreated),
+        READ_JSON_PROPERTY(lastEditedBy, QUuid, setLastEditedBy),
+        READ_JSON_PROPERTY_ENUM(entityHostType, EntityHostType),
+        READ_JSON_PROPERTY(owningAvatarID, QUuid, setOwningAvatarID),
+        READ_JSON_PROPERTY(queryAACube, AACube, setQueryAACube),
+        READ_JSON_PROPERTY(canCastShadow, bool, setCanCastShadow),
+        READ_JSON_PROPERTY(isVisibleInSecondaryCamera, bool, setIsVisibleInSecondaryCamera),
+        READ_JSON_PROPERTY_ENUM(renderLayer, RenderLayer),
+        READ_JSON_PROPERTY_ENUM(primitiveMode, PrimitiveMode),
+        READ_JSON_PROPERTY(ignorePickIntersection, bool, setIgnorePickIntersection),
+
+        // Physics
+        READ_JSON_PROPERTY(density, float, setDensity),
+        READ_JSON_PROPERTY(velocity, vec3, setVelocity),
+        READ_JSON_PROPERTY(angularVelocity, vec3, setAngularVelocity),
+        READ_JSON_PROPERTY(gravity, vec3, setGravity),
+        READ_JSON_PROPERTY(acceleration, vec3, setAcceleration),
+        READ_JSON_PROPERTY(damping, float, setDamping),
+        READ_JSON_PROPERTY(angularDamping, float, setAngularDamping),
+        READ_JSON_PROPERTY(restitution, float, setRestitution),
+        READ_JSON_PROPERTY(friction, float, setFriction),
+        READ_JSON_PROPERTY(lifetime, float, setLifetime),
+        READ_JSON_PROPERTY(collisionless, bool, setCollisionless),
+        READ_JSON_PROPERTY(ignoreForCollisions, bool, setCollisionless), // legacy support
+        { "collisionMask", [](JSONCursor& cursor, EntityItemProperties& properties, const QUrl&) {
+            uint16_t value;
+            if (!uint16_t_readFromJSON(cursor, value)) {
+                return false;
+            }
+            // collidesWith takes precedence, as it does in copyFromScriptValue
+            if (!properties.collisionMaskChanged()) {
+                properties.setCollisionMask(value);
+            }
+            return true;
+        } },
+        READ_JSON_PROPERTY_ENUM(collidesWith, CollisionMask),
+        READ_JSON_PROPERTY(collisionsWillMove, bool, setDynamic), // legacy support
+        READ_JSON_PROPERTY(dynamic, bool, setDynamic),
+        READ_JSON_PROPERTY_URL(collisionSoundURL, setCollisionSoundURL),
+        READ_JSON_PROPERTY(actionData, QByteArray, setActionData),
+
+        // Cloning
+        READ_JSON_PROPERTY(cloneable, bool, setCloneable),
+        READ_JSON_PROPERTY(cloneLifetime, float, setCloneLifetime),
+        READ_JSON_PROPERTY(cloneLimit, float, setCloneLimit),
+        READ_JSON_PROPERTY(cloneDynamic, bool, setCloneDynamic),
+        READ_JSON_PROPERTY(cloneAvatarEntity, bool, setCloneAvatarEntity),
+        READ_JSON_PROPERTY(cloneOriginID, QUuid, setCloneOriginID),
+
+        // Scripts
+        READ_JSON_PROPERTY_URL(script, setScript),
+        READ_JSON_PROPERTY(scriptTimestamp, quint64, setScriptTimestamp),
+        READ_JSON_PROPERTY_URL(serverScripts, setServerScripts),
+
+        // Certifiable Properties
+        READ_JSON_PROPERTY(itemName, QString, setItemName),
+        READ_JSON_PROPERTY(itemDescription, QString, setItemDescription),
+        READ_JSON_PROPERTY(itemCategories, QString, setItemCategories),
+        READ_JSON_PROPERTY(itemArtist, QString, setItemArtist),
+        READ_JSON_PROPERTY(itemLicense, QString, setItemLicense),
+        READ_JSON_PROPERTY(limitedRun, quint32, setLimitedRun),
+        READ_JSON_PROPERTY(marketplaceID, QString, setMarketplaceID),
+        READ_JSON_PROPERTY(editionNumber, quint32, setEditionNumber),
+        READ_JSON_PROPERTY(entityInstanceNumber, quint32, setEntityInstanceNumber),
+        READ_JSON_PROPERTY(certificateID, QString, setCertificateID),
+        READ_JSON_PROPERTY(certificateType, QString, setCertificateType),
+        READ_JSON_PROPERTY(staticCertificateVersion, quint32, setStaticCertificateVersion),
+
+        // Script location data
+        READ_JSON_PROPERTY(localPosition, vec3, setLocalPosition),
+        READ_JSON_PROPERTY(localRotation, quat, setLocalRotation),
+        READ_JSON_PROPERTY(localVelocity, vec3, setLocalVelocity),
+        READ_JSON_PROPERTY(localAngularVelocity, vec3, setLocalAngularVelocity),
+        READ_JSON_PROPERTY(localDimensions, vec3, setLocalDimensions),
+
+        // Common
+        READ_JSON_PROPERTY_ENUM(shapeType, ShapeType),
+        READ_JSON_PROPERTY_URL(compoundShapeURL, setCompoundShapeURL),
+        READ_JSON_PROPERTY(color, u8vec3Color, setColor),
+        READ_JSON_PROPERTY(alpha, float, setAlpha),
+
+        // Particles
+        READ_JSON_PROPERTY(maxParticles, quint32, setMaxParticles),
+        READ_JSON_PROPERTY(lifespan, float, setLifespan),
+        READ_JSON_PROPERTY(isEmitting, bool, setIsEmitting),
+        READ_JSON_PROPERTY(emitRate, float, setEmitRate),
+        READ_JSON_PROPERTY(emitSpeed, float, setEmitSpeed),
+        READ_JSON_PROPERTY(speedSpread, float, setSpeedSpread),
+        READ_JSON_PROPERTY(emitOrientation, quat, setEmitOrientation),
+        READ_JSON_PROPERTY(emitDimensions, vec3, setEmitDimensions),
+        READ_JSON_PROPERTY(emitRadiusStart, float, setEmitRadiusStart),
+        READ_JSON_PROPERTY(polarStart, float, setPolarStart),
+        READ_JSON_PROPERTY(polarFinish, float, setPolarFinish),
+        READ_JSON_PROPERTY(azimuthStart, float, setAzimuthStart),
+        READ_JSON_PROPERTY(azimuthFinish, float, setAzimuthFinish),
+        READ_JSON_PROPERTY(emitAcceleration, vec3, setEmitAcceleration),
+        READ_JSON_PROPERTY(accelerationSpread, vec3, setAccelerationSpread),
+        READ_JSON_PROPERTY(particleRadius, float, setParticleRadius),
+        READ_JSON_PROPERTY(radiusSpread, float, setRadiusSpread),
+        READ_JSON_PROPERTY(radiusStart, float, setRadiusStart),
+        READ_JSON_PROPERTY(radiusFinish, float, setRadiusFinish),
+        READ_JSON_PROPERTY(colorSpread, u8vec3Color, setColorSpread),
+        READ_JSON_PROPERTY(colorStart, vec3Color, setColorStart),
+        READ_JSON_PROPERTY(colorFinish, vec3Color, setColorFinish),
+        READ_JSON_PROPERTY(alphaSpread, float, setAlphaSpread),
+        READ_JSON_PROPERTY(alphaStart, float, setAlphaStart),
+        READ_JSON_PROPERTY(alphaFinish, float, setAlphaFinish),
+        READ_JSON_PROPERTY(emitterShouldTrail, bool, setEmitterShouldTrail),
+        READ_JSON_PROPERTY(particleSpin, float, setParticleSpin),
+        READ_JSON_PROPERTY(spinSpread, float, setSpinSpread),
+        READ_JSON_PROPERTY(spinStart, float, setSpinStart),
+        READ_JSON_PROPERTY(spinFinish, float, setSpinFinish),
+        READ_JSON_PROPERTY(rotateWithEntity, bool, setRotateWithEntity),
+
+        // Model
+        READ_JSON_PROPERTY_URL(modelURL, setModelURL),
+        READ_JSON_PROPERTY(modelScale, vec3, setModelScale),
+        READ_JSON_PROPERTY(relayParentJoints, bool, setRelayParentJoints),
+        READ_JSON_PROPERTY(groupCulled, bool, setGroupCulled),
+        READ_JSON_PROPERTY(blendshapeCoefficients, QString, setBlendshapeCoefficients),
+        READ_JSON_PROPERTY(useOriginalPivot, bool, setUseOriginalPivot),
+
+        // Light
+        READ_JSON_PROPERTY(isSpotlight, bool, setIsSpotlight),
+        READ_JSON_PROPERTY(intensity, float, setIntensity),
+        READ_JSON_PROPERTY(exponent, float, setExponent),
+        READ_JSON_PROPERTY(cutoff, float, setCutoff),
+        READ_JSON_PROPERTY(falloffRadius, float, setFalloffRadius),
+
+        // Text
+        READ_JSON_PROPERTY(text, QString, setText),
+        READ_JSON_PROPERTY(lineHeight, float, setLineHeight),
+        READ_JSON_PROPERTY(textColor, u8vec3Color, setTextColor),
+        READ_JSON_PROPERTY(textAlpha, float, setTextAlpha),
+        READ_JSON_PROPERTY(backgroundColor, u8vec3Color, setBackgroundColor),
+        READ_JSON_PROPERTY(backgroundAlpha, float, setBackgroundAlpha),
+        READ_JSON_PROPERTY(leftMargin, float, setLeftMargin),
+        READ_JSON_PROPERTY(rightMargin, float, setRightMargin),
+        READ_JSON_PROPERTY(topMargin, float, setTopMargin),
+        READ_JSON_PROPERTY(bottomMargin, float, setBottomMargin),
+        READ_JSON_PROPERTY(unlit, bool, setUnlit),
+        READ_JSON_PROPERTY(font, QString, setFont),
+        READ_JSON_PROPERTY_ENUM(textEffect, TextEffect),
+        READ_JSON_PROPERTY(textEffectColor, u8vec3Color, setTextEffectColor),
+        READ_JSON_PROPERTY(textEffectThickness, float, setTextEffectThickness),
+        READ_JSON_PROPERTY_ENUM(alignment, Alignment),
+
+        // Zone
+        READ_JSON_PROPERTY(flyingAllowed, bool, setFlyingAllowed),
+        READ_JSON_PROPERTY(ghostingAllowed, bool, setGhostingAllowed),
+        READ_JSON_PROPERTY(filterURL, QString, setFilterURL),
+        READ_JSON_PROPERTY_ENUM(keyLightMode, KeyLightMode),
+        READ_JSON_PROPERTY_ENUM(ambientLightMode, AmbientLightMode),
+        READ_JSON_PROPERTY_ENUM(skyboxMode, SkyboxMode),
+        READ_JSON_PROPERTY_ENUM(hazeMode, HazeMode),
+        READ_JSON_PROPERTY_ENUM(bloomMode, BloomMode),
+        READ_JSON_PROPERTY_ENUM(avatarPriority, AvatarPriority),
+        READ_JSON_PROPERTY_ENUM(screenshare, Screenshare),
+
+        // Polyvox
+        READ_JSON_PROPERTY(voxelVolumeSize, vec3, setVoxelVolumeSize),
+        READ_JSON_PROPERTY(voxelData, QByteArray, setVoxelData),
+        READ_JSON_PROPERTY(voxelSurfaceStyle, uint16_t, setVoxelSurfaceStyle),
+        READ_JSON_PROPERTY(xTextureURL, QString, setXTextureURL),
+        READ_JSON_PROPERTY(yTextureURL, QString, setYTextureURL),
+        READ_JSON_PROPERTY(zTextureURL, QString, setZTextureURL),
+        READ_JSON_PROPERTY(xNNeighborID, EntityItemID, setXNNeighborID),
+        READ_JSON_PROPERTY(yNNeighborID, EntityItemID, setYNNeighborID),
+        READ_JSON_PROPERTY(zNNeighborID, EntityItemID, setZNNeighborID),
+        READ_JSON_PROPERTY(xPNeighborID, EntityItemID, setXPNeighborID),
+        READ_JSON_PROPERTY(yPNeighborID, EntityItemID, setYPNeighborID),
+        READ_JSON_PROPERTY(zPNeighborID, EntityItemID, setZPNeighborID),
+
+        // Web
+        READ_JSON_PROPERTY_URL(sourceUrl, setSourceUrl),
+        READ_JSON_PROPERTY(dpi, uint16_t, setDPI),
+        READ_JSON_PROPERTY_URL(scriptURL, setScriptURL),
+        READ_JSON_PROPERTY(maxFPS, uint8_t, setMaxFPS),
+        READ_JSON_PROPERTY_ENUM(inputMode, InputMode),
+        READ_JSON_PROPERTY(showKeyboardFocusHighlight, bool, setShowKeyboardFocusHighlight),
+        READ_JSON_PROPERTY(useBackground, bool, setUseBackground),
+        READ_JSON_PROPERTY(userAgent, QString, setUserAgent),
+
+        // Polyline
+        READ_JSON_PROPERTY(isUVModeStretch, bool, setIsUVModeStretch),
+        READ_JSON_PROPERTY(glow, bool, setGlow),
+
+        // Shape
+        READ_JSON_PROPERTY(shape, QString, setShape),
+
+        // Material
+        READ_JSON_PROPERTY_URL(materialURL, setMaterialURL),
+        READ_JSON_PROPERTY_ENUM(materialMappingMode, MaterialMappingMode),
+        READ_JSON_PROPERTY(priority, quint16, setPriority),
+        READ_JSON_PROPERTY(parentMaterialName, QString, setParentMaterialName),
+        READ_JSON_PROPERTY(materialMappingRot, float, setMaterialMappingRot),
+        READ_JSON_PROPERTY(materialData, QString, setMaterialData),
+        READ_JSON_PROPERTY(materialRepeat, bool, setMaterialRepeat),
+
+        // Image
+        READ_JSON_PROPERTY(emissive, bool, setEmissive),
+        READ_JSON_PROPERTY(keepAspectRatio, bool, setKeepAspectRatio),
+
+        // Grid
+        READ_JSON_PROPERTY(followCamera, bool, setFollowCamera),
+        READ_JSON_PROPERTY(majorGridEvery, uint32_t, setMajorGridEvery),
+        READ_JSON_PROPERTY(minorGridEvery, float, setMinorGridEvery),
+
+        // Gizmo
+        READ_JSON_PROPERTY_ENUM(gizmoType, GizmoType),
+
+        SKIP_JSON_PROPERTY(age),
+        SKIP_JSON_PROPERTY(ageAsText),
+        SKIP_JSON_PROPERTY(lastEdited),
+        SKIP_JSON_PROPERTY(boundingBox),
+        SKIP_JSON_PROPERTY(originalTextures),
+        SKIP_JSON_PROPERTY(renderInfo),
+    };
+    return propertyReaders;
+}
+
+}
+
+EntityJSONReader::EntityJSONReader(const QByteArray& json) :
+    _json(json)
+{
+}
+
+QString EntityJSONReader::getErrorString() const {
+    if (_errorString.isEmpty()) {
+        return QString();
+    }
+    int line = 1 + (int)std::count(_json.constData(), _json.constData() + _errorPosition, '\n');
+    return QString("Error: Line %1, byte position %2: %3").arg(line).arg(_errorPosition).arg(_errorString);
+}
+
+bool EntityJSONReader::setError(const JSONCursor& cursor, const QString& error) {
+    _errorString = error;
+    _errorPosition = cursor.getPosition();
+    return false;
+}
+
+bool EntityJSONReader::readHeader() {
+    JSONCursor cursor(_json);
+    if (!cursor.consume('{')) {
+        return setError(cursor, "Text before start of object");
+    }
+
+    bool gotDataVersion = false;
+    bool gotEntities = false;
+    bool gotId = false;
+    bool gotVersion = false;
+
+    if (!cursor.consume('}')) {
+        do {
+            QByteArray key;
+            if (!cursor.readKey(key) || key.isEmpty()) {
+                return setError(cursor, "Incorrect key string");
+            }
+            if (!cursor.consume(':')) {
+                return setError(cursor, "Ill-formed id/value entry");
+            }
+
+            double number;
+            if (key == "DataVersion") {
+                if (gotDataVersion || !cursor.readNumber(number)) {
+                    return setError(cursor, "Invalid DataVersion entry");
+                }
+                _dataVersion = (int)number;
+                _hasDataVersion = true;
+                gotDataVersion = true;
+            } else if (key == "Entities") {
+                cursor.peek();
+                if (gotEntities || !cursor.consume('[')) {
+                    return setError(cursor, "Entities entry is not an array");
+                }
+                // the entities are read once the version is known, which comes after them
+                _entitiesPosition = cursor.getPosition() - 1;
+                cursor.setPosition(_entitiesPosition);
+                if (!cursor.skipValue()) {
+                    return setError(cursor, "Unterminated entities array");
+                }
+                gotEntities = true;
+            } else if (key == "Id") {
+                QString idString;
+                if (gotId || !cursor.readString(idString) || idString.isEmpty()) {
+                    return setError(cursor, "Invalid Id value");
+                }
+                gotId = true;
+                // older archives may have a null id, which results in a new one for the restored archive
+                if (idString != "{00000000-0000-0000-0000-000000000000}") {
+                    _persistID = QUuid::fromString(idString);
+                    if (_persistID.isNull()) {
+                        return setError(cursor, "Id value invalid UUID string: " + idString);
+                    }
+                }
+            } else if (key == "Version") {
+                if (gotVersion || !cursor.readNumber(number)) {
+                    return setError(cursor, "Invalid Version entry");
+                }
+                _version = (int)number;
+                gotVersion = true;
+            } else if (key == "Paths") {
+                // serverless json has an optional Paths entry
+                int position = cursor.getPosition();
+                if (cursor.peek() != '{' || !cursor.skipValue()) {
+                    return setError(cursor, "Paths item is not an object");
+                }
+                QJsonDocument pathsObject = QJsonDocument::fromJson(_json.mid(position, cursor.getPosition() - position));
+                if (pathsObject.isNull()) {
+                    return setError(cursor, "Ill-formed paths entry");
+                }
+                _paths = pathsObject.object().toVariantMap();
+            } else {
+                return setError(cursor, "Unrecognized key name: " + QString::fromUtf8(key));
+            }
+        } while (cursor.consume(','));
+
+        if (!cursor.consume('}')) {
+            return setError(cursor, "Ill-formed end of object");
+        }
+    }
+
+    if (cursor.peek() != 0) {
+        return setError(cursor, "Ill-formed end of object");
+    }
+    return true;
+}
+
+bool EntityJSONReader::parseEntity(JSONCursor& cursor, Entity& entity, std::unique_ptr<QScriptEngine>& scriptEngine) {
+    if (!cursor.consume('{')) {
+        return setError(cursor, "Entity array item is not an object");
+    }
+
+    const auto& propertyReaders = getPropertyReaders();
+    QByteArray otherValuesJSON;
+    bool hasID = false;
+    if (!cursor.consume('}')) {
+        do {
+            cursor.peek();
+            int keyPosition = cursor.getPosition();
+            QByteArray key;
+            if (!cursor.readKey(key) || !cursor.consume(':')) {
+                return setError(cursor, "Ill-formed entity");
+            }
+            cursor.peek();
+            int valuePosition = cursor.getPosition();
+
+            if (key == "id") {
+                QUuid id;
+                if (QUuid_readFromJSON(cursor, id)) {
+                    entity.id = EntityItemID(id);
+                    hasID = true;
+                    continue;
+                }
+            } else {
+                auto propertyReader = propertyReaders.find(key);
+                if (propertyReader != propertyReaders.end() &&
+                    (*propertyReader)(cursor, entity.properties, _relativeURL)) {
+                    continue;
+                }
+            }
+
+            // everything else is copied as it is, to be converted along with the rest of the entity's other values
+            cursor.setPosition(valuePosition);
+            if (!cursor.skipValue()) {
+                return setError(cursor, "Ill-formed entity");
+            }
+            otherValuesJSON += otherValuesJSON.isEmpty() ? '{' : ',';
+            otherValuesJSON.append(cursor.getData(keyPosition), cursor.getPosition() - keyPosition);
+        } while (cursor.consume(','));
+
+        if (!cursor.consume('}')) {
+            return setError(cursor, "Ill-formed entity");
+        }
+    }
+
+    if (!hasID) {
+        entity.id = EntityItemID(QUuid::createUuid());
+    }
+
+    if (!otherValuesJSON.isEmpty()) {
+        otherValuesJSON += '}';
+        QJsonDocument document = QJsonDocument::fromJson(otherValuesJSON);
+        if (document.isNull()) {
+            return setError(cursor, "Ill-formed entity");
+        }
+        QJsonObject otherValuesObject = document.object();
+        if (!_relativeURL.isEmpty()) {
+            OctreeEntitiesFileParser::resolveRelativeURLs(otherValuesObject, _relativeURL);
+        }
+        entity.otherValues = otherValuesObject.toVariantMap();
+
+        if (!scriptEngine) {
+            scriptEngine.reset(new QScriptEngine());
+        }
+        EntityItemPropertiesFromScriptValueIgnoreReadOnly(variantMapToScriptValue(entity.otherValues, *scriptEngine),
+                                                          entity.properties);
+        _numConvertedEntities++;
+    } else {
+        entity.properties.setLastEdited(usecTimestampNow());
+    }
+
+    if (!_marketplaceID.isEmpty()) {
+        entity.properties.setMarketplaceID(_marketplaceID);
+    }
+    return true;
+}
+
+bool EntityJSONReader::parseEntities(const BatchOperator& batchOperator) {
+    JSONCursor cursor(_json, _entitiesPosition);
+    cursor.consume('[');
+    if (cursor.consume(']')) {
+        return true;
+    }
+
+    // the engine converting the values that aren't in the table belongs to this thread
+    std::unique_ptr<QScriptEngine> scriptEngine;
+    Batch batch;
+    batch.reserve(_batchSize);
+    do {
+        batch.emplace_back();
+        if (!parseEntity(cursor, batch.back(), scriptEngine)) {
+            return false;
+        }
+        _numEntities++;
+        if ((int)batch.size() == _batchSize) {
+            if (!batchOperator(batch)) {
+                return false;
+            }
+            batch.clear();
+            batch.reserve(_batchSize);
+        }
+    } while (cursor.consume(','));
+
+    if (!cursor.consume(']')) {
+        return setError(cursor, "Entity array item incorrectly terminated");
+    }
+    return batch.empty() || batchOperator(batch);
+}
+
+bool EntityJSONReader::readEntities(const BatchOperator& batchOperator) {
+    _numEntities = 0;
+    _numConvertedEntities = 0;
+    if (_entitiesPosition < 0) {
+        return true;
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Batch> batches;
+    bool finished = false;
+    bool cancelled = false;
+    bool parsed = false;
+
+    std::thread parser([&] {
+        bool result = parseEntities([&](Batch& batch) {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&] { return batches.size() < MAX_QUEUED_BATCHES || cancelled; });
+            if (cancelled) {
+                return false;
+            }
+            batches.push_back(std::move(batch));
+            condition.notify_all();
+            return true;
+        });
+        std::lock_guard<std::mutex> lock(mutex);
+        parsed = result;
+        finished = true;
+        condition.notify_all();
+    });
+
+    bool success = true;
+    while (true) {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&] { return !batches.empty() || finished; });
+            if (batches.empty()) {
+                break;
+            }
+            batch = std::move(batches.front());
+            batches.pop_front();
+            condition.notify_all();
+        }
+        if (!batchOperator(batch)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = true;
+            condition.notify_all();
+            success = false;
+            break;
+        }
+    }
+
+    parser.join();
+    return success && parsed;
+}
@@ -0,0 +1,102 @@
+//
+//  EntityJSONReader.h
+//  libraries/entities/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityJSONReader_h
+#define hifi_EntityJSONReader_h
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QUrl>
+#include <QtCore/QUuid>
+#include <QtCore/QVariantMap>
+
+#include "EntityItemID.h"
+#include "EntityItemProperties.h"
+
+class JSONCursor;
+class QScriptEngine;
+
+// Reads the entities of a json export, as written by Octree::toJSONString, directly into EntityItemProperties.
+//
+// OctreeEntitiesFileParser followed by EntityTree::readFromMap holds the text, a QVariantMap of the whole file and a
+// QScriptValue per entity at the same time.  This reader makes a single pass over the text instead: the values of the
+// plain properties are parsed in place and handed to their setter through a table keyed by property name.  Whatever
+// isn't in the table (group properties, lists, legacy names) is collected per entity and converted the old way, for
+// that entity only.
+//
+// The entities are parsed on a separate thread and handed out in batches, so that a batch can be added to the tree
+// while the next one is being parsed.
+class EntityJSONReader {
+public:
+    struct Entity {
+        EntityItemID id;
+        EntityItemProperties properties;
+        QVariantMap otherValues;    // the values that didn't go through the table, used to convert older content
+    };
+    using Batch = std::vector<Entity>;
+    using BatchOperator = std::function<bool(Batch& batch)>;
+
+    static const int DEFAULT_BATCH_SIZE;
+
+    // json must outlive the reader
+    EntityJSONReader(const QByteArray& json);
+
+    void setRelativeURL(const QUrl& relativeURL) { _relativeURL = relativeURL; }
+    void setMarketplaceID(const QString& marketplaceID) { _marketplaceID = marketplaceID; }
+    void setBatchSize(int batchSize) { _batchSize = std::max(1, batchSize); }
+
+    // reads the top level values, skipping over the entities
+    bool readHeader();
+
+    // reads the entities and passes them to the operator, a batch at a time, on the calling thread.
+    // stops early if the operator returns false.
+    bool readEntities(const BatchOperator& batchOperator);
+
+    const QUuid& getPersistID() const { return _persistID; }
+    bool hasDataVersion() const { return _hasDataVersion; }
+    int getDataVersion() const { return _dataVersion; }
+    int getVersion() const { return _version; }
+    const QVariantMap& getPaths() const { return _paths; }
+
+    int getNumEntities() const { return _numEntities; }
+    // the number of entities that had values converted through a QScriptValue
+    int getNumConvertedEntities() const { return _numConvertedEntities; }
+
+    QString getErrorString() const;
+
+private:
+    bool parseEntities(const BatchOperator& batchOperator);
+    bool parseEntity(JSONCursor& cursor, Entity& entity, std::unique_ptr<QScriptEngine>& scriptEngine);
+    bool setError(const JSONCursor& cursor, const QString& error);
+
+    const QByteArray& _json;
+    QUrl _relativeURL;
+    QString _marketplaceID;
+    int _batchSize { DEFAULT_BATCH_SIZE };
+
+    QUuid _persistID;
+    bool _hasDataVersion { false };
+    int _dataVersion { 0 };
+    int _version { 0 };
+    QVariantMap _paths;
+    int _entitiesPosition { -1 };
+
+    int _numEntities { 0 };
+    int _numConvertedEntities { 0 };
+
+    QString _errorString;
+    int _errorPosition { 0 };
+};
+
+#endif // hifi_EntityJSONReader_h
@@ -976,6 +976,110 @@ QUuid EntityScriptingInterface::editEntity(const QUuid& id, const EntityItemProp
     return id;
 }
 
+void EntityScriptingInterface::readEntity(const QUuid& entityID, std::function<void(const EntityItemPointer&)> reader) {
+    if (_entityTree) {
+        _entityTree->withReadLock([&] {
+            EntityItemPointer entity = _entityTree->findEntityByEntityItemID(EntityItemID(entityID));
+            if (entity) {
+                reader(entity);
+            }
+        });
+    }
+}
+
+void EntityScriptingInterface::readEntities(const QVector<QUuid>& entityIDs,
+                                            std::function<void(int, const EntityItemPointer&)> reader) {
+    if (!_entityTree) {
+        return;
+    }
+    // release the lock now and then, as getMultipleEntityProperties() does, so that long lists don't starve writers
+    const int lockAmount = 500;
+    int i = 0;
+    int size = entityIDs.size();
+    while (i < size) {
+        _entityTree->withReadLock([&] {
+            for (int j = 0; j < lockAmount && i < size; ++i, ++j) {
+                EntityItemPointer entity = _entityTree->findEntityByEntityItemID(EntityItemID(entityIDs.at(i)));
+                if (entity) {
+                    reader(i, entity);
+                }
+            }
+        });
+    }
+}
+
+glm::vec3 EntityScriptingInterface::getEntityPosition(const QUuid& entityID) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+    glm::vec3 result;
+    readEntity(entityID, [&](const EntityItemPointer& entity) {
+        result = entity->getWorldPosition();
+    });
+    return result;
+}
+
+glm::quat EntityScriptingInterface::getEntityRotation(const QUuid& entityID) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+    glm::quat result;
+    readEntity(entityID, [&](const EntityItemPointer& entity) {
+        result = entity->getWorldOrientation();
+    });
+    return result;
+}
+
+QString EntityScriptingInterface::getEntityUserData(const QUuid& entityID) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+    QString result;
+    readEntity(entityID, [&](const EntityItemPointer& entity) {
+        result = entity->getUserData();
+    });
+    return result;
+}
+
+QVector<glm::vec3> EntityScriptingInterface::getMultipleEntityPositions(const QVector<QUuid>& entityIDs) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+    QVector<glm::vec3> results(entityIDs.size(), glm::vec3());
+    readEntities(entityIDs, [&](int i, const EntityItemPointer& entity) {
+        results[i] = entity->getWorldPosition();
+    });
+    return results;
+}
+
+QVector<glm::quat> EntityScriptingInterface::getMultipleEntityRotations(const QVector<QUuid>& entityIDs) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+    QVector<glm::quat> results(entityIDs.size(), glm::quat());
+    readEntities(entityIDs, [&](int i, const EntityItemPointer& entity) {
+        results[i] = entity->getWorldOrientation();
+    });
+    return results;
+}
+
+QStringList EntityScriptingInterface::getMultipleEntityUserData(const QVector<QUuid>& entityIDs) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+    QVector<QString> results(entityIDs.size());
+    readEntities(entityIDs, [&](int i, const EntityItemPointer& entity) {
+        results[i] = entity->getUserData();
+    });
+    return results.toList();
+}
+
+QUuid EntityScriptingInterface::setEntityPosition(const QUuid& entityID, const glm::vec3& position) {
+    EntityItemProperties properties;
+    properties.setPosition(position);
+    return editEntity(entityID, properties);
+}
+
+QUuid EntityScriptingInterface::setEntityRotation(const QUuid& entityID, const glm::quat& rotation) {
+    EntityItemProperties properties;
+    properties.setRotation(rotation);
+    return editEntity(entityID, properties);
+}
+
+QUuid EntityScriptingInterface::setEntityUserData(const QUuid& entityID, const QString& userData) {
+    EntityItemProperties properties;
+    properties.setUserData(userData);
+    return editEntity(entityID, properties);
+}
+
 void EntityScriptingInterface::deleteEntity(const QUuid& id) {
     PROFILE_RANGE(script_entities, __FUNCTION__);
 
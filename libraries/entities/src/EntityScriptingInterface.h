@@ -434,6 +434,96 @@ public slots:
      */
     Q_INVOKABLE QUuid editEntity(const QUuid& entityID, const EntityItemProperties& properties);
 
+    /*@jsdoc
+     * Gets an entity's position, without building the full set of its properties. This is much cheaper than
+     * <code>Entities.getEntityProperties(entityID, "position").position</code> for scripts that poll it often.
+     * @function Entities.getEntityPosition
+     * @param {Uuid} entityID - The ID of the entity.
+     * @returns {Vec3} The position of the entity, in world coordinates, if the entity can be found, otherwise
+     *     {@link Vec3(0)|Vec3.ZERO}.
+     */
+    Q_INVOKABLE glm::vec3 getEntityPosition(const QUuid& entityID);
+
+    /*@jsdoc
+     * Gets an entity's rotation, without building the full set of its properties.
+     * @function Entities.getEntityRotation
+     * @param {Uuid} entityID - The ID of the entity.
+     * @returns {Quat} The rotation of the entity, in world coordinates, if the entity can be found, otherwise
+     *     {@link Quat(0)|Quat.IDENTITY}.
+     */
+    Q_INVOKABLE glm::quat getEntityRotation(const QUuid& entityID);
+
+    /*@jsdoc
+     * Gets an entity's <code>userData</code>, without building the full set of its properties.
+     * @function Entities.getEntityUserData
+     * @param {Uuid} entityID - The ID of the entity.
+     * @returns {string} The <code>userData</code> of the entity if the entity can be found, otherwise <code>""</code>.
+     */
+    Q_INVOKABLE QString getEntityUserData(const QUuid& entityID);
+
+    /*@jsdoc
+     * Gets the positions of multiple entities.
+     * @function Entities.getMultipleEntityPositions
+     * @param {Uuid[]} entityIDs - The IDs of the entities.
+     * @returns {Vec3[]} The position of each entity, in world coordinates and in the same order as the IDs.
+     *     {@link Vec3(0)|Vec3.ZERO} is returned for entities that can't be found.
+     * @example <caption>Report the positions of the nearby entities.</caption>
+     * var SEARCH_RADIUS = 50; // meters
+     * var entityIDs = Entities.findEntities(MyAvatar.position, SEARCH_RADIUS);
+     * var positions = Entities.getMultipleEntityPositions(entityIDs);
+     * print("Nearby entity positions: " + JSON.stringify(positions));
+     */
+    Q_INVOKABLE QVector<glm::vec3> getMultipleEntityPositions(const QVector<QUuid>& entityIDs);
+
+    /*@jsdoc
+     * Gets the rotations of multiple entities.
+     * @function Entities.getMultipleEntityRotations
+     * @param {Uuid[]} entityIDs - The IDs of the entities.
+     * @returns {Quat[]} The rotation of each entity, in world coordinates and in the same order as the IDs.
+     *     {@link Quat(0)|Quat.IDENTITY} is returned for entities that can't be found.
+     */
+    Q_INVOKABLE QVector<glm::quat> getMultipleEntityRotations(const QVector<QUuid>& entityIDs);
+
+    /*@jsdoc
+     * Gets the <code>userData</code> of multiple entities.
+     * @function Entities.getMultipleEntityUserData
+     * @param {Uuid[]} entityIDs - The IDs of the entities.
+     * @returns {string[]} The <code>userData</code> of each entity, in the same order as the IDs. <code>""</code> is
+     *     returned for entities that can't be found.
+     */
+    Q_INVOKABLE QStringList getMultipleEntityUserData(const QVector<QUuid>& entityIDs);
+
+    /*@jsdoc
+     * Sets an entity's position. This is the same as <code>Entities.editEntity(entityID, { position: position })</code>
+     * without converting a script object to entity properties.
+     * @function Entities.setEntityPosition
+     * @param {Uuid} entityID - The ID of the entity to edit.
+     * @param {Vec3} position - The new position of the entity, in world coordinates.
+     * @returns {Uuid} The ID of the entity if the edit was successful, otherwise <code>null</code> or {@link Uuid|Uuid.NULL}.
+     */
+    Q_INVOKABLE QUuid setEntityPosition(const QUuid& entityID, const glm::vec3& position);
+
+    /*@jsdoc
+     * Sets an entity's rotation. This is the same as <code>Entities.editEntity(entityID, { rotation: rotation })</code>
+     * without converting a script object to entity properties.
+     * @function Entities.setEntityRotation
+     * @param {Uuid} entityID - The ID of the entity to edit.
+     * @param {Quat} rotation - The new rotation of the entity, in world coordinates.
+     * @returns {Uuid} The ID of the entity if the edit was successful, otherwise <code>null</code> or {@link Uuid|Uuid.NULL}.
+     */
+    Q_INVOKABLE QUuid setEntityRotation(const QUuid& entityID, const glm::quat& rotation);
+
+    /*@jsdoc
+     * Sets an entity's <code>userData</code>. This is the same as
+     * <code>Entities.editEntity(entityID, { userData: userData })</code> without converting a script object to entity
+     * properties.
+     * @function Entities.setEntityUserData
+     * @param {Uuid} entityID - The ID of the entity to edit.
+     * @param {string} userData - The new <code>userData</code> of the entity.
+     * @returns {Uuid} The ID of the entity if the edit was successful, otherwise <code>null</code> or {@link Uuid|Uuid.NULL}.
+     */
+    Q_INVOKABLE QUuid setEntityUserData(const QUuid& entityID, const QString& userData);
+
     /*@jsdoc
      * Deletes an entity.
      * @function Entities.deleteEntity
@@ -2551,6 +2641,10 @@ private:
     EntityItemPointer checkForTreeEntityAndTypeMatch(const QUuid& entityID,
                                                      EntityTypes::EntityType entityType = EntityTypes::Unknown);
 
+    // the typed accessors read the entities they can find under the tree's read lock, without building properties
+    void readEntity(const QUuid& entityID, std::function<void(const EntityItemPointer&)> reader);
+    void readEntities(const QVector<QUuid>& entityIDs, std::function<void(int, const EntityItemPointer&)> reader);
+
 
     /// actually does the work of finding the ray intersection, can be called in locking mode or tryLock mode
     RayToEntityIntersectionResult evalRayIntersectionWorker(const PickRay& ray, Octree::lockType lockType,
@@ -243,6 +243,8 @@ void EntitySimulation::moveSimpleKinematics(uint64_t now) {
             if (ancestryIsKnown && !hasAvatarAncestor) {
                 entity->updateQueryAACube();
             }
+            // clients extrapolate the motion themselves, so it isn't a change on the server, but it is persisted
+            _entityTree->journalEntityChange(entity->getEntityItemID(), OctreeJournal::RecordType::Edit);
             _entitiesToSort.insert(entity);
             ++itemItr;
         } else {
@@ -0,0 +1,301 @@
+//
+//  EntitySnapshot.cpp
+//  libraries/entities/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySnapshot.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include <QtCore/QFile>
+#include <QtCore/QThread>
+
+#include <TBBHelpers.h>
+#include <udt/PacketHeaders.h>
+
+#include "EntitiesLogging.h"
+
+namespace {
+
+const uint32_t SNAPSHOT_MAGIC = 0x504e5345; // "ESNP"
+const uint16_t SNAPSHOT_FORMAT_VERSION = 1;
+
+// entities with more data than this, which can only be a huge userData, are left out and logged
+const int MAX_ENCODED_ENTITY_SIZE = 16 * 1024 * 1024;
+const int INITIAL_ENCODE_BUFFER_SIZE = 4 * 1024;
+
+const int NUM_BYTES_RFC4122_UUID = 16;
+
+#pragma pack(push, 1)
+struct FileHeader {
+    uint32_t magic;
+    uint16_t formatVersion;
+    uint8_t propertiesVersion;      // version of the EntityAdd packets the properties are encoded like
+    uint8_t reserved;
+    uint8_t persistID[NUM_BYTES_RFC4122_UUID];
+    int64_t dataVersion;
+    uint32_t numEntities;
+    uint32_t numPaths;
+    uint64_t entityTableOffset;
+    uint64_t pathTableOffset;
+    uint64_t stringPoolOffset;
+    uint64_t stringPoolSize;
+    uint64_t entityDataOffset;
+    uint64_t entityDataSize;
+};
+
+struct EntityRow {
+    uint8_t id[NUM_BYTES_RFC4122_UUID];
+    uint64_t dataOffset;            // relative to the entity data section
+    uint32_t dataSize;
+    uint32_t type;
+};
+
+struct PathRow {
+    uint32_t nameOffset;            // relative to the string pool
+    uint32_t nameSize;
+    uint32_t viewpointOffset;
+    uint32_t viewpointSize;
+};
+#pragma pack(pop)
+
+PacketVersion getPropertiesVersion() {
+    return versionForPacketType(PacketType::EntityAdd);
+}
+
+template <typename T>
+void appendRow(QByteArray& table, const T& row) {
+    table.append(reinterpret_cast<const char*>(&row), sizeof(T));
+}
+
+}
+
+EntitySnapshot::Writer::Writer(const QUuid& persistID, int64_t dataVersion) :
+    _persistID(persistID),
+    _dataVersion(dataVersion)
+{
+}
+
+uint32_t EntitySnapshot::Writer::addString(const QString& string, uint32_t& size) {
+    QByteArray utf8 = string.toUtf8();
+    uint32_t offset = (uint32_t)_stringPool.size();
+    size = (uint32_t)utf8.size();
+    _stringPool.append(utf8);
+    return offset;
+}
+
+void EntitySnapshot::Writer::addPath(const QString& name, const QString& viewpoint) {
+    PathRow row;
+    row.nameOffset = addString(name, row.nameSize);
+    row.viewpointOffset = addString(viewpoint, row.viewpointSize);
+    appendRow(_pathTable, row);
+    _numPaths++;
+}
+
+bool EntitySnapshot::Writer::addEntity(const EntityItemID& id, const EntityItemProperties& properties) {
+    EntityPropertyFlags requestedProperties = properties.getChangedProperties();
+    int bufferSize = INITIAL_ENCODE_BUFFER_SIZE;
+    while (true) {
+        QByteArray buffer(bufferSize, Qt::Uninitialized);
+        EntityPropertyFlags didntFitProperties;
+        auto appendState = EntityItemProperties::encodeEntityEditPacket(PacketType::EntityAdd, id, properties, buffer,
+                                                                        requestedProperties, didntFitProperties);
+        if (appendState == OctreeElement::COMPLETED) {
+            EntityRow row;
+            memcpy(row.id, id.toRfc4122().constData(), NUM_BYTES_RFC4122_UUID);
+            row.dataOffset = (uint64_t)_entityData.size();
+            row.dataSize = (uint32_t)buffer.size();
+            row.type = (uint32_t)properties.getType();
+            appendRow(_entityTable, row);
+            _entityData.append(buffer);
+            _numEntities++;
+            return true;
+        }
+        if (bufferSize >= MAX_ENCODED_ENTITY_SIZE) {
+            qCWarning(entities) << "Entity" << id << "is too large for the entity snapshot";
+            return false;
+        }
+        bufferSize *= 4;
+    }
+}
+
+QByteArray EntitySnapshot::Writer::finish() {
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SNAPSHOT_MAGIC;
+    header.formatVersion = SNAPSHOT_FORMAT_VERSION;
+    header.propertiesVersion = getPropertiesVersion();
+    memcpy(header.persistID, _persistID.toRfc4122().constData(), NUM_BYTES_RFC4122_UUID);
+    header.dataVersion = _dataVersion;
+    header.numEntities = _numEntities;
+    header.numPaths = _numPaths;
+    header.entityTableOffset = sizeof(FileHeader);
+    header.pathTableOffset = header.entityTableOffset + _entityTable.size();
+    header.stringPoolOffset = header.pathTableOffset + _pathTable.size();
+    header.stringPoolSize = _stringPool.size();
+    header.entityDataOffset = header.stringPoolOffset + _stringPool.size();
+    header.entityDataSize = _entityData.size();
+
+    QByteArray data;
+    data.reserve((int)(header.entityDataOffset + header.entityDataSize));
+    appendRow(data, header);
+    data.append(_entityTable);
+    data.append(_pathTable);
+    data.append(_stringPool);
+    data.append(_entityData);
+    return data;
+}
+
+EntitySnapshot::Reader::Reader() {
+}
+
+EntitySnapshot::Reader::~Reader() {
+    close();
+}
+
+bool EntitySnapshot::Reader::open(const QString& filename) {
+    close();
+    _file.reset(new QFile(filename));
+    if (!_file->open(QIODevice::ReadOnly) || _file->size() < (qint64)sizeof(FileHeader)) {
+        close();
+        return false;
+    }
+    _size = (size_t)_file->size();
+    _data = _file->map(0, _file->size());
+    if (!_data) {
+        qCWarning(entities) << "Failed to map entity snapshot" << filename << _file->errorString();
+        close();
+        return false;
+    }
+    if (!parse()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool EntitySnapshot::Reader::open(const QByteArray& data) {
+    close();
+    _data = reinterpret_cast<const uchar*>(data.constData());
+    _size = (size_t)data.size();
+    if (!parse()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void EntitySnapshot::Reader::close() {
+    if (_file) {
+        if (_data) {
+            _file->unmap(const_cast<uchar*>(_data));
+        }
+        _file->close();
+        _file.reset();
+    }
+    _data = nullptr;
+    _size = 0;
+    _numEntities = 0;
+    _entityTable = nullptr;
+    _paths.clear();
+}
+
+bool EntitySnapshot::Reader::parse() {
+    if (_size < sizeof(FileHeader)) {
+        return false;
+    }
+    FileHeader header;
+    memcpy(&header, _data, sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.formatVersion != SNAPSHOT_FORMAT_VERSION) {
+        qCWarning(entities) << "Not an entity snapshot, or written by an incompatible version";
+        return false;
+    }
+    if (header.propertiesVersion != getPropertiesVersion()) {
+        qCDebug(entities) << "Entity snapshot properties version" << header.propertiesVersion << "doesn't match"
+                          << getPropertiesVersion();
+        return false;
+    }
+
+    // every section has to be within the file
+    uint64_t entityTableEnd = header.entityTableOffset + (uint64_t)header.numEntities * sizeof(EntityRow);
+    uint64_t pathTableEnd = header.pathTableOffset + (uint64_t)header.numPaths * sizeof(PathRow);
+    if (entityTableEnd > _size || pathTableEnd > _size || header.stringPoolOffset + header.stringPoolSize > _size ||
+        header.entityDataOffset + header.entityDataSize > _size) {
+        qCWarning(entities) << "Truncated entity snapshot";
+        return false;
+    }
+
+    _entityTable = _data + header.entityTableOffset;
+    for (uint32_t i = 0; i < header.numEntities; i++) {
+        EntityRow row;
+        memcpy(&row, _entityTable + i * sizeof(EntityRow), sizeof(row));
+        if (row.dataOffset + row.dataSize > header.entityDataSize) {
+            qCWarning(entities) << "Invalid entity snapshot row" << i;
+            return false;
+        }
+    }
+
+    const char* stringPool = reinterpret_cast<const char*>(_data + header.stringPoolOffset);
+    for (uint32_t i = 0; i < header.numPaths; i++) {
+        PathRow row;
+        memcpy(&row, _data + header.pathTableOffset + i * sizeof(PathRow), sizeof(row));
+        if ((uint64_t)row.nameOffset + row.nameSize > header.stringPoolSize ||
+            (uint64_t)row.viewpointOffset + row.viewpointSize > header.stringPoolSize) {
+            qCWarning(entities) << "Invalid entity snapshot path" << i;
+            return false;
+        }
+        _paths[QString::fromUtf8(stringPool + row.nameOffset, row.nameSize)] =
+            QString::fromUtf8(stringPool + row.viewpointOffset, row.viewpointSize);
+    }
+
+    _persistID = QUuid::fromRfc4122(QByteArray::fromRawData(reinterpret_cast<const char*>(header.persistID),
+                                                            NUM_BYTES_RFC4122_UUID));
+    _dataVersion = header.dataVersion;
+    _numEntities = header.numEntities;
+    _entityDataOffset = header.entityDataOffset;
+    return true;
+}
+
+bool EntitySnapshot::Reader::decodeEntity(int index, Entity& entity) const {
+    EntityRow row;
+    memcpy(&row, _entityTable + index * sizeof(EntityRow), sizeof(row));
+
+    const uchar* data = _data + _entityDataOffset + row.dataOffset;
+    int processedBytes = 0;
+    entity.properties = EntityItemProperties();
+    bool valid = EntityItemProperties::decodeEntityEditPacket(data, (int)row.dataSize, processedBytes,
+                                                              entity.id, entity.properties);
+    return valid && processedBytes <= (int)row.dataSize;
+}
+
+bool EntitySnapshot::Reader::decodeEntities(int first, int count, std::vector<Entity>& entities, int numTasks) const {
+    first = std::max(0, first);
+    count = std::max(0, std::min(count, (int)_numEntities - first));
+    entities.resize(count);
+    if (count == 0) {
+        return true;
+    }
+
+    if (numTasks <= 0) {
+        numTasks = std::max(1, QThread::idealThreadCount());
+    }
+    numTasks = std::min(numTasks, count);
+
+    std::atomic<bool> success { true };
+    tbb::parallel_for(0, numTasks, [&](int task) {
+        int begin = (int)((int64_t)count * task / numTasks);
+        int end = (int)((int64_t)count * (task + 1) / numTasks);
+        for (int i = begin; i < end; i++) {
+            if (!decodeEntity(first + i, entities[i])) {
+                success = false;
+            }
+        }
+    });
+    return success;
+}
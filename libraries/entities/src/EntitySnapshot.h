@@ -0,0 +1,104 @@
+//
+//  EntitySnapshot.h
+//  libraries/entities/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySnapshot_h
+#define hifi_EntitySnapshot_h
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QUuid>
+
+#include "EntityItemID.h"
+#include "EntityItemProperties.h"
+
+class QFile;
+
+// Binary snapshot of the entities of a domain, written by the entity server next to its json persist file so that it
+// can start without parsing the json.  The file is laid out to be memory mapped and decoded in place:
+//
+//   header           version info, counts and offsets of the sections below
+//   entity table     one fixed size row per entity: id, type, offset and size of its properties
+//   path table       one fixed size row per named path, referencing the string pool
+//   string pool      utf-8 strings, not terminated
+//   entity data      each entity's properties, in the same encoding as the EntityAdd edit packets
+//
+// Since the properties don't depend on each other they are decoded on several threads, a batch at a time.
+// The json persist file remains the reference: a snapshot is only used if it matches its id and data version.
+class EntitySnapshot {
+public:
+    struct Entity {
+        EntityItemID id;
+        EntityItemProperties properties;
+    };
+
+    class Writer {
+    public:
+        Writer(const QUuid& persistID, int64_t dataVersion);
+
+        void addPath(const QString& name, const QString& viewpoint);
+        bool addEntity(const EntityItemID& id, const EntityItemProperties& properties);
+
+        QByteArray finish();
+
+    private:
+        uint32_t addString(const QString& string, uint32_t& size);
+
+        QUuid _persistID;
+        int64_t _dataVersion;
+        QByteArray _entityTable;
+        QByteArray _pathTable;
+        QByteArray _stringPool;
+        QByteArray _entityData;
+        uint32_t _numEntities { 0 };
+        uint32_t _numPaths { 0 };
+    };
+
+    class Reader {
+    public:
+        Reader();
+        ~Reader();
+
+        // maps the file, returns false if it isn't a snapshot this build can decode
+        bool open(const QString& filename);
+        // reads from data, which must outlive the reader
+        bool open(const QByteArray& data);
+        void close();
+
+        const QUuid& getPersistID() const { return _persistID; }
+        int64_t getDataVersion() const { return _dataVersion; }
+        int getNumEntities() const { return (int)_numEntities; }
+        const std::map<QString, QString>& getPaths() const { return _paths; }
+
+        // decodes entities [first, first + count) into entities, split into numTasks (0 for the ideal thread count) which
+        // run on the TBB pool.  returns false if any of them failed to decode.
+        bool decodeEntities(int first, int count, std::vector<Entity>& entities, int numTasks = 0) const;
+
+    private:
+        bool parse();
+        bool decodeEntity(int index, Entity& entity) const;
+
+        std::unique_ptr<QFile> _file;
+        const uchar* _data { nullptr };
+        size_t _size { 0 };
+
+        QUuid _persistID;
+        int64_t _dataVersion { 0 };
+        uint32_t _numEntities { 0 };
+        const uchar* _entityTable { nullptr };
+        uint64_t _entityDataOffset { 0 };
+        std::map<QString, QString> _paths;
+    };
+};
+
+#endif // hifi_EntitySnapshot_h
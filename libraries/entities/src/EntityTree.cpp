@@ -11,7 +11,9 @@
 //
 
 #include "EntityTree.h"
+#include <tbb/task_group.h>
 #include <QtCore/QDateTime>
+#include <QtCore/QDataStream>
 #include <QtCore/QQueue>
 #include <openssl/err.h>
 #include <openssl/pem.h>
@@ -42,11 +44,16 @@
 #include "LogHandler.h"
 #include "EntityEditFilters.h"
 #include "EntityDynamicFactoryInterface.h"
+#include "EntityJSONReader.h"
+#include "EntitySnapshot.h"
 
 static const quint64 DELETED_ENTITIES_EXTRA_USECS_TO_CONSIDER = USECS_PER_MSEC * 50;
 const float EntityTree::DEFAULT_MAX_TMP_ENTITY_LIFETIME = 60 * 60; // 1 hour
 static const QString DOMAIN_UNLIMITED = "domainUnlimited";
 
+// entities decoded at once when reading a binary snapshot, see readFromBinarySnapshot
+static const int SNAPSHOT_DECODE_BATCH_SIZE = 4096;
+
 EntityTree::EntityTree(bool shouldReaverage) :
     Octree(shouldReaverage)
 {
@@ -103,16 +110,18 @@ void EntityTree::eraseDomainAndNonOwnedEntities() {
             if (!getIsServer()) {
                 if (entity->isLocalEntity() || entity->isMyAvatarEntity()) {
                     savedEntities[entity->getEntityItemID()] = entity;
-                } else {
-                    int32_t spaceIndex = entity->getSpaceIndex();
-                    if (spaceIndex != -1) {
-                        // stale spaceIndices will be freed later
-                        _staleProxies.push_back(spaceIndex);
-                    }
+                    continue;
+                }
+                int32_t spaceIndex = entity->getSpaceIndex();
+                if (spaceIndex != -1) {
+                    // stale spaceIndices will be freed later
+                    _staleProxies.push_back(spaceIndex);
                 }
             }
+            _boundsIndex->removeEntity(entity);
         }
         _entityMap.swap(savedEntities);
+        _entityMapEpoch++;
     });
 
     resetClientEditStats();
@@ -141,12 +150,14 @@ void EntityTree::eraseAllOctreeElements(bool createNewRoot) {
     }
     QHash<EntityItemID, EntityItemPointer> localMap;
     localMap.swap(_entityMap);
+    _entityMapEpoch++;
     this->withWriteLock([&] {
         foreach(EntityItemPointer entity, localMap) {
             EntityTreeElementPointer element = entity->getElement();
             if (element) {
                 element->cleanupEntities();
             }
+            _boundsIndex->removeEntity(entity);
             if (!getIsServer()) {
                 int32_t spaceIndex = entity->getSpaceIndex();
                 if (spaceIndex != -1) {
@@ -305,6 +316,7 @@ void EntityTree::postAddEntity(EntityItemPointer entity) {
     }
 
     _isDirty = true;
+    journalEntityChange(entity->getEntityItemID(), OctreeJournal::RecordType::Add);
 
     // find and hook up any entities with this entity as a (previously) missing parent
     fixupNeedsParentFixups();
@@ -371,6 +383,7 @@ bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperti
                     emit editingEntityPointer(entity);
                 }
                 _isDirty = true;
+                journalEntityChange(entity->getEntityItemID(), OctreeJournal::RecordType::Edit);
             }
         }
     } else {
@@ -506,6 +519,7 @@ bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperti
         }
 
         _isDirty = true;
+        journalEntityChange(entity->getEntityItemID(), OctreeJournal::RecordType::Edit);
 
         uint32_t newFlags = entity->getDirtyFlags() & ~preFlags;
         if (newFlags) {
@@ -747,6 +761,7 @@ void EntityTree::deleteEntitiesByPointer(const std::vector<EntityItemPointer>& e
             theOperator.addEntityToDeleteList(entity);
             emit deletingEntity(entity->getID());
             emit deletingEntityPointer(entity.get());
+            journalEntityChange(entity->getEntityItemID(), OctreeJournal::RecordType::Delete);
         }
     }
 
@@ -792,144 +807,33 @@ void EntityTree::processRemovedEntities(const DeleteEntityOperator& theOperator)
     }
 }
 
-class RayArgs {
-public:
-    // Inputs
-    glm::vec3 origin;
-    glm::vec3 direction;
-    glm::vec3 invDirection;
-    glm::vec3 viewFrustumPos;
-    const QVector<EntityItemID>& entityIdsToInclude;
-    const QVector<EntityItemID>& entityIdsToDiscard;
-    PickFilter searchFilter;
-
-    // Outputs
-    OctreeElementPointer& element;
-    float& distance;
-    BoxFace& face;
-    glm::vec3& surfaceNormal;
-    QVariantMap& extraInfo;
-    EntityItemID entityID;
-};
-
-bool evalRayIntersectionOp(const OctreeElementPointer& element, void* extraData) {
-    RayArgs* args = static_cast<RayArgs*>(extraData);
-    bool keepSearching = true;
-    EntityTreeElementPointer entityTreeElementPointer = std::static_pointer_cast<EntityTreeElement>(element);
-    EntityItemID entityID = entityTreeElementPointer->evalRayIntersection(args->origin, args->direction, args->viewFrustumPos,
-        args->element, args->distance, args->face, args->surfaceNormal, args->entityIdsToInclude,
-        args->entityIdsToDiscard, args->searchFilter, args->extraInfo);
-    if (!entityID.isNull()) {
-        args->entityID = entityID;
-        // We recurse OctreeElements in order, so if we hit something, we can stop immediately
-        keepSearching = false;
-    }
-    return keepSearching;
-}
-
-float evalRayIntersectionSortingOp(const OctreeElementPointer& element, void* extraData) {
-    RayArgs* args = static_cast<RayArgs*>(extraData);
-    EntityTreeElementPointer entityTreeElementPointer = std::static_pointer_cast<EntityTreeElement>(element);
-    float distance = FLT_MAX;
-    // If origin is inside the cube, always check this element first
-    if (entityTreeElementPointer->getAACube().contains(args->origin)) {
-        distance = 0.0f;
-    } else {
-        float boundDistance = FLT_MAX;
-        BoxFace face;
-        glm::vec3 surfaceNormal;
-        if (entityTreeElementPointer->getAACube().findRayIntersection(args->origin, args->direction, args->invDirection,
-            boundDistance, face, surfaceNormal)) {
-            // Don't add this cell if it's already farther than our best distance so far
-            if (boundDistance < args->distance) {
-                distance = boundDistance;
-            }
-        }
-    }
-    return distance;
-}
-
 EntityItemID EntityTree::evalRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
                                     QVector<EntityItemID> entityIdsToInclude, QVector<EntityItemID> entityIdsToDiscard,
                                     PickFilter searchFilter, OctreeElementPointer& element, float& distance,
                                     BoxFace& face, glm::vec3& surfaceNormal, QVariantMap& extraInfo,
                                     Octree::lockType lockType, bool* accurateResult) {
-
-    // calculate dirReciprocal like this rather than with glm's scalar / vec3 template to avoid NaNs.
-    vec3 dirReciprocal = glm::vec3(direction.x == 0.0f ? 0.0f : 1.0f / direction.x,
-                                   direction.y == 0.0f ? 0.0f : 1.0f / direction.y,
-                                   direction.z == 0.0f ? 0.0f : 1.0f / direction.z);
-    RayArgs args = { origin, direction, dirReciprocal, BillboardModeHelpers::getPrimaryViewFrustumPosition(), entityIdsToInclude, entityIdsToDiscard,
-            searchFilter, element, distance, face, surfaceNormal, extraInfo, EntityItemID() };
+    glm::vec3 viewFrustumPos = BillboardModeHelpers::getPrimaryViewFrustumPosition();
+    EntityItemID entityID;
     distance = FLT_MAX;
 
     bool requireLock = lockType == Octree::Lock;
     bool lockResult = withReadLock([&]{
-        recurseTreeWithOperationSorted(evalRayIntersectionOp, evalRayIntersectionSortingOp, &args);
+        // the entities come in order of the distance to their bounds, so the search stops at the first bounds
+        // that are farther than the closest hit
+        _boundsIndex->findAlongRay(origin, direction, [&](const EntityItemPointer& entity, float boundsDistance) {
+            if (EntityTreeElement::evalEntityRayIntersection(entity, origin, direction, viewFrustumPos, element, distance,
+                    face, surfaceNormal, entityIdsToInclude, entityIdsToDiscard, searchFilter, extraInfo)) {
+                entityID = entity->getEntityItemID();
+            }
+            return distance;
+        });
     }, requireLock);
 
     if (accurateResult) {
         *accurateResult = lockResult; // if user asked to accuracy or result, let them know this is accurate
     }
 
-    return args.entityID;
-}
-
-class ParabolaArgs {
-public:
-    // Inputs
-    glm::vec3 origin;
-    glm::vec3 velocity;
-    glm::vec3 acceleration;
-    glm::vec3 viewFrustumPos;
-    const QVector<EntityItemID>& entityIdsToInclude;
-    const QVector<EntityItemID>& entityIdsToDiscard;
-    PickFilter searchFilter;
-
-    // Outputs
-    OctreeElementPointer& element;
-    float& parabolicDistance;
-    BoxFace& face;
-    glm::vec3& surfaceNormal;
-    QVariantMap& extraInfo;
-    EntityItemID entityID;
-};
-
-bool evalParabolaIntersectionOp(const OctreeElementPointer& element, void* extraData) {
-    ParabolaArgs* args = static_cast<ParabolaArgs*>(extraData);
-    bool keepSearching = true;
-    EntityTreeElementPointer entityTreeElementPointer = std::static_pointer_cast<EntityTreeElement>(element);
-    EntityItemID entityID = entityTreeElementPointer->evalParabolaIntersection(args->origin, args->velocity, args->acceleration, args->viewFrustumPos,
-        args->element, args->parabolicDistance, args->face, args->surfaceNormal, args->entityIdsToInclude,
-        args->entityIdsToDiscard, args->searchFilter, args->extraInfo);
-    if (!entityID.isNull()) {
-        args->entityID = entityID;
-        // We recurse OctreeElements in order, so if we hit something, we can stop immediately
-        keepSearching = false;
-    }
-    return keepSearching;
-}
-
-float evalParabolaIntersectionSortingOp(const OctreeElementPointer& element, void* extraData) {
-    ParabolaArgs* args = static_cast<ParabolaArgs*>(extraData);
-    EntityTreeElementPointer entityTreeElementPointer = std::static_pointer_cast<EntityTreeElement>(element);
-    float distance = FLT_MAX;
-    // If origin is inside the cube, always check this element first
-    if (entityTreeElementPointer->getAACube().contains(args->origin)) {
-        distance = 0.0f;
-    } else {
-        float boundDistance = FLT_MAX;
-        BoxFace face;
-        glm::vec3 surfaceNormal;
-        if (entityTreeElementPointer->getAACube().findParabolaIntersection(args->origin, args->velocity, args->acceleration,
-            boundDistance, face, surfaceNormal)) {
-            // Don't add this cell if it's already farther than our best distance so far
-            if (boundDistance < args->parabolicDistance) {
-                distance = boundDistance;
-            }
-        }
-    }
-    return distance;
+    return entityID;
 }
 
 EntityItemID EntityTree::evalParabolaIntersection(const PickParabola& parabola,
@@ -938,270 +842,152 @@ EntityItemID EntityTree::evalParabolaIntersection(const PickParabola& parabola,
                                     OctreeElementPointer& element, glm::vec3& intersection, float& distance, float& parabolicDistance,
                                     BoxFace& face, glm::vec3& surfaceNormal, QVariantMap& extraInfo,
                                     Octree::lockType lockType, bool* accurateResult) {
-    ParabolaArgs args = { parabola.origin, parabola.velocity, parabola.acceleration, BillboardModeHelpers::getPrimaryViewFrustumPosition(),
-        entityIdsToInclude, entityIdsToDiscard, searchFilter, element, parabolicDistance, face, surfaceNormal, extraInfo, EntityItemID() };
+    glm::vec3 viewFrustumPos = BillboardModeHelpers::getPrimaryViewFrustumPosition();
+    // We can precompute the world-space parabola normal and reuse it for the parabola plane intersects AABox sphere check
+    glm::vec3 normal = EntityTreeElement::getParabolaPlaneNormal(parabola.velocity, parabola.acceleration);
+    EntityItemID entityID;
     parabolicDistance = FLT_MAX;
     distance = FLT_MAX;
 
     bool requireLock = lockType == Octree::Lock;
     bool lockResult = withReadLock([&] {
-        recurseTreeWithOperationSorted(evalParabolaIntersectionOp, evalParabolaIntersectionSortingOp, &args);
+        _boundsIndex->findAlongParabola(parabola.origin, parabola.velocity, parabola.acceleration,
+            [&](const EntityItemPointer& entity) {
+                if (EntityTreeElement::evalEntityParabolaIntersection(entity, parabola.origin, parabola.velocity,
+                        parabola.acceleration, viewFrustumPos, normal, element, parabolicDistance, face, surfaceNormal,
+                        entityIdsToInclude, entityIdsToDiscard, searchFilter, extraInfo)) {
+                    entityID = entity->getEntityItemID();
+                }
+            });
     }, requireLock);
 
     if (accurateResult) {
         *accurateResult = lockResult; // if user asked to accuracy or result, let them know this is accurate
     }
 
-    if (!args.entityID.isNull()) {
+    if (!entityID.isNull()) {
         intersection = parabola.origin + parabola.velocity * parabolicDistance + 0.5f * parabola.acceleration * parabolicDistance * parabolicDistance;
         distance = glm::distance(intersection, parabola.origin);
     }
 
-    return args.entityID;
-}
-
-class FindClosestEntityArgs {
-public:
-    // Inputs
-    glm::vec3 position;
-    float targetRadius;
-    PickFilter searchFilter;
-
-    // Outputs
-    QUuid closestEntity;
-    float closestEntityDistance;
-};
-
-
-bool evalClosestEntityOperation(const OctreeElementPointer& element, void* extraData) {
-    FindClosestEntityArgs* args = static_cast<FindClosestEntityArgs*>(extraData);
-    EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-
-    glm::vec3 penetration;
-    bool sphereIntersection = entityTreeElement->getAACube().findSpherePenetration(args->position, args->targetRadius, penetration);
-
-    // If this entityTreeElement contains the point, then search it...
-    if (sphereIntersection) {
-        float closestDistanceSquared = FLT_MAX;
-        QUuid thisClosestEntity = entityTreeElement->evalClosetEntity(args->position, args->searchFilter, closestDistanceSquared);
-
-        // we may have gotten NULL back, meaning no entity was available
-        if (!thisClosestEntity.isNull()) {
-            float distanceFromPointToEntity = glm::sqrt(closestDistanceSquared);
-
-            // If we're within our target radius
-            if (distanceFromPointToEntity <= args->targetRadius) {
-                // we are closer than anything else we've found
-                if (distanceFromPointToEntity < args->closestEntityDistance) {
-                    args->closestEntity = thisClosestEntity;
-                    args->closestEntityDistance = distanceFromPointToEntity;
-                }
-            }
-        }
-
-        // we should be able to optimize this...
-        return true; // keep searching in case children have closer entities
-    }
-
-    // if this element doesn't contain the point, then none of its children can contain the point, so stop searching
-    return false;
+    return entityID;
 }
 
 // NOTE: assumes caller has handled locking
 QUuid EntityTree::evalClosestEntity(const glm::vec3& position, float targetRadius, PickFilter searchFilter) {
-    FindClosestEntityArgs args = { position, targetRadius, searchFilter, QUuid(), FLT_MAX };
-    recurseTreeWithOperation(evalClosestEntityOperation, &args);
-    return args.closestEntity;
-}
-
-class FindEntitiesInSphereArgs {
-public:
-    // Inputs
-    glm::vec3 position;
-    float targetRadius;
-    PickFilter searchFilter;
-
-    // Outputs
-    QVector<QUuid> entities;
-};
-
-bool evalInSphereOperation(const OctreeElementPointer& element, void* extraData) {
-    FindEntitiesInSphereArgs* args = static_cast<FindEntitiesInSphereArgs*>(extraData);
-    glm::vec3 penetration;
-    bool sphereIntersection = element->getAACube().findSpherePenetration(args->position, args->targetRadius, penetration);
-
-    // If this element contains the point, then search it...
-    if (sphereIntersection) {
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        entityTreeElement->evalEntitiesInSphere(args->position, args->targetRadius, args->searchFilter, args->entities);
-        return true; // keep searching in case children have closer entities
-    }
-
-    // if this element doesn't contain the point, then none of it's children can contain the point, so stop searching
-    return false;
+    QUuid closestEntity;
+    float closestEntityDistance = targetRadius;
+    _boundsIndex->findNearest(position, targetRadius, [&](const EntityItemPointer& entity, float boundsDistance) {
+        if (EntityTreeElement::checkFilterSettings(entity, searchFilter)) {
+            float distanceFromPointToEntity = glm::distance(position, entity->getWorldPosition());
+            // the first entity only needs to be within our target radius, the others need to be closer than it
+            if (closestEntity.isNull() ? distanceFromPointToEntity <= closestEntityDistance :
+                    distanceFromPointToEntity < closestEntityDistance) {
+                closestEntity = entity->getID();
+                closestEntityDistance = distanceFromPointToEntity;
+            }
+        }
+        return closestEntityDistance;
+    });
+    return closestEntity;
 }
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInSphere(const glm::vec3& center, float radius, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
-    FindEntitiesInSphereArgs args = { center, radius, searchFilter, QVector<QUuid>() };
-    recurseTreeWithOperation(evalInSphereOperation, &args);
-    foundEntities.swap(args.entities);
-}
-
-class FindEntitiesInSphereWithTypeArgs {
-public:
-    // Inputs
-    glm::vec3 position;
-    float targetRadius;
-    EntityTypes::EntityType type;
-    PickFilter searchFilter;
-
-    // Outputs
     QVector<QUuid> entities;
-};
-
-bool evalInSphereWithTypeOperation(const OctreeElementPointer& element, void* extraData) {
-    FindEntitiesInSphereWithTypeArgs* args = static_cast<FindEntitiesInSphereWithTypeArgs*>(extraData);
-    glm::vec3 penetration;
-    bool sphereIntersection = element->getAACube().findSpherePenetration(args->position, args->targetRadius, penetration);
-
-    // If this element contains the point, then search it...
-    if (sphereIntersection) {
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        entityTreeElement->evalEntitiesInSphereWithType(args->position, args->targetRadius, args->type, args->searchFilter, args->entities);
-        return true; // keep searching in case children have closer entities
-    }
-
-    // if this element doesn't contain the point, then none of it's children can contain the point, so stop searching
-    return false;
+    _boundsIndex->findInSphere(center, radius, [&](const EntityItemPointer& entity) {
+        if (EntityTreeElement::checkFilterSettings(entity, searchFilter) &&
+                EntityTreeElement::isEntityInSphere(entity, center, radius)) {
+            entities.push_back(entity->getID());
+        }
+    });
+    foundEntities.swap(entities);
 }
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInSphereWithType(const glm::vec3& center, float radius, EntityTypes::EntityType type, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
-    FindEntitiesInSphereWithTypeArgs args = { center, radius, type, searchFilter, QVector<QUuid>() };
-    recurseTreeWithOperation(evalInSphereWithTypeOperation, &args);
-    foundEntities.swap(args.entities);
-}
-
-class FindEntitiesInSphereWithNameArgs {
-public:
-    // Inputs
-    glm::vec3 position;
-    float targetRadius;
-    QString name;
-    bool caseSensitive;
-    PickFilter searchFilter;
-
-    // Outputs
     QVector<QUuid> entities;
-};
-
-bool evalInSphereWithNameOperation(const OctreeElementPointer& element, void* extraData) {
-    FindEntitiesInSphereWithNameArgs* args = static_cast<FindEntitiesInSphereWithNameArgs*>(extraData);
-    glm::vec3 penetration;
-    bool sphereIntersection = element->getAACube().findSpherePenetration(args->position, args->targetRadius, penetration);
-
-    // If this element contains the point, then search it...
-    if (sphereIntersection) {
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        entityTreeElement->evalEntitiesInSphereWithName(args->position, args->targetRadius, args->name, args->caseSensitive, args->searchFilter, args->entities);
-        return true; // keep searching in case children have closer entities
-    }
-
-    // if this element doesn't contain the point, then none of it's children can contain the point, so stop searching
-    return false;
+    _boundsIndex->findInSphere(center, radius, [&](const EntityItemPointer& entity) {
+        if (type == entity->getType() && EntityTreeElement::checkFilterSettings(entity, searchFilter) &&
+                EntityTreeElement::isEntityInSphere(entity, center, radius)) {
+            entities.push_back(entity->getID());
+        }
+    });
+    foundEntities.swap(entities);
 }
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInSphereWithName(const glm::vec3& center, float radius, const QString& name, bool caseSensitive, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
-    FindEntitiesInSphereWithNameArgs args = { center, radius, name, caseSensitive, searchFilter, QVector<QUuid>() };
-    recurseTreeWithOperation(evalInSphereWithNameOperation, &args);
-    foundEntities.swap(args.entities);
-}
-
-class FindEntitiesInCubeArgs {
-public:
-    // Inputs
-    AACube cube;
-    PickFilter searchFilter;
-
-    // Outputs
     QVector<QUuid> entities;
-};
-
-bool findInCubeOperation(const OctreeElementPointer& element, void* extraData) {
-    FindEntitiesInCubeArgs* args = static_cast<FindEntitiesInCubeArgs*>(extraData);
-    if (element->getAACube().touches(args->cube)) {
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        entityTreeElement->evalEntitiesInCube(args->cube, args->searchFilter, args->entities);
-        return true;
-    }
-    return false;
+    QString lowerName = name.toLower();
+    _boundsIndex->findInSphere(center, radius, [&](const EntityItemPointer& entity) {
+        if (!EntityTreeElement::checkFilterSettings(entity, searchFilter)) {
+            return;
+        }
+        QString entityName = entity->getName();
+        if ((caseSensitive && name != entityName) || (!caseSensitive && lowerName != entityName.toLower())) {
+            return;
+        }
+        if (EntityTreeElement::isEntityInSphere(entity, center, radius)) {
+            entities.push_back(entity->getID());
+        }
+    });
+    foundEntities.swap(entities);
 }
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInCube(const AACube& cube, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
-    FindEntitiesInCubeArgs args { cube, searchFilter, QVector<QUuid>() };
-    recurseTreeWithOperation(findInCubeOperation, &args);
-    foundEntities.swap(args.entities);
-}
-
-class FindEntitiesInBoxArgs {
-public:
-    // Inputs
-    AABox box;
-    PickFilter searchFilter;
-
-    // Outputs
     QVector<QUuid> entities;
-};
-
-bool findInBoxOperation(const OctreeElementPointer& element, void* extraData) {
-    FindEntitiesInBoxArgs* args = static_cast<FindEntitiesInBoxArgs*>(extraData);
-    if (element->getAACube().touches(args->box)) {
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        entityTreeElement->evalEntitiesInBox(args->box, args->searchFilter, args->entities);
-        return true;
-    }
-    return false;
+    _boundsIndex->findInBox(AABox(cube), [&](const EntityItemPointer& entity) {
+        if (!EntityTreeElement::checkFilterSettings(entity, searchFilter)) {
+            return;
+        }
+        // If the entities AABox touches the search cube then consider it to be found
+        bool success;
+        AABox entityBox = entity->getAABox(success);
+        if (success && entityBox.touches(cube)) {
+            entities.push_back(entity->getID());
+        }
+    });
+    foundEntities.swap(entities);
 }
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInBox(const AABox& box, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
-    FindEntitiesInBoxArgs args { box, searchFilter, QVector<QUuid>() };
-    // NOTE: This should use recursion, since this is a spatial operation
-    recurseTreeWithOperation(findInBoxOperation, &args);
-    // swap the two lists of entity pointers instead of copy
-    foundEntities.swap(args.entities);
-}
-
-class FindEntitiesInFrustumArgs {
-public:
-    // Inputs
-    ViewFrustum frustum;
-    PickFilter searchFilter;
-
-    // Outputs
     QVector<QUuid> entities;
-};
-
-bool findInFrustumOperation(const OctreeElementPointer& element, void* extraData) {
-    FindEntitiesInFrustumArgs* args = static_cast<FindEntitiesInFrustumArgs*>(extraData);
-    if (element->isInView(args->frustum)) {
-        EntityTreeElementPointer entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
-        entityTreeElement->evalEntitiesInFrustum(args->frustum, args->searchFilter, args->entities);
-        return true;
-    }
-    return false;
+    _boundsIndex->findInBox(box, [&](const EntityItemPointer& entity) {
+        if (!EntityTreeElement::checkFilterSettings(entity, searchFilter)) {
+            return;
+        }
+        // FIXME - handle entity->getShapeType() == SHAPE_TYPE_SPHERE case better
+        // FIXME - consider allowing the entity to determine penetration so that
+        //         entities could presumably dull actuall hull testing if they wanted to
+        // If the entities AABox touches the search box then consider it to be found
+        bool success;
+        AABox entityBox = entity->getAABox(success);
+        if (success && entityBox.touches(box)) {
+            entities.push_back(entity->getID());
+        }
+    });
+    // swap the two lists of entity pointers instead of copy
+    foundEntities.swap(entities);
 }
 
 // NOTE: assumes caller has handled locking
 void EntityTree::evalEntitiesInFrustum(const ViewFrustum& frustum, PickFilter searchFilter, QVector<QUuid>& foundEntities) {
-    FindEntitiesInFrustumArgs args = { frustum, searchFilter, QVector<QUuid>() };
-    // NOTE: This should use recursion, since this is a spatial operation
-    recurseTreeWithOperation(findInFrustumOperation, &args);
+    QVector<QUuid> entities;
+    _boundsIndex->findInFrustum(frustum, [&](const EntityItemPointer& entity) {
+        if (!EntityTreeElement::checkFilterSettings(entity, searchFilter)) {
+            return;
+        }
+        bool success;
+        AABox entityBox = entity->getAABox(success);
+        if (success && (frustum.boxIntersectsFrustum(entityBox) || frustum.boxIntersectsKeyhole(entityBox))) {
+            entities.push_back(entity->getID());
+        }
+    });
     // swap the two lists of entity pointers instead of copy
-    foundEntities.swap(args.entities);
+    foundEntities.swap(entities);
 }
 
 EntityItemPointer EntityTree::findEntityByID(const QUuid& id) const {
@@ -1398,13 +1184,15 @@ void EntityTree::fixupTerseEditLogging(EntityItemProperties& properties, QList<Q
 }
 
 
-bool EntityTree::filterProperties(const EntityItemPointer& existingEntity, EntityItemProperties& propertiesIn, EntityItemProperties& propertiesOut, bool& wasChanged, FilterType filterType) const {
+bool EntityTree::filterProperties(const EntityItemPointer& existingEntity, EntityItemProperties& propertiesIn,
+        EntityItemProperties& propertiesOut, bool& wasChanged, FilterType filterType, const QUuid& senderID) const {
     bool accepted = true;
     auto entityEditFilters = DependencyManager::get<EntityEditFilters>();
     if (entityEditFilters) {
         auto position = existingEntity ? existingEntity->getWorldPosition() : propertiesIn.getPosition();
         auto entityID = existingEntity ? existingEntity->getEntityItemID() : EntityItemID();
-        accepted = entityEditFilters->filter(position, propertiesIn, propertiesOut, wasChanged, filterType, entityID, existingEntity);
+        accepted = entityEditFilters->filter(position, propertiesIn, propertiesOut, wasChanged, filterType, entityID, existingEntity,
+            senderID);
     }
 
     return accepted;
@@ -1799,6 +1587,38 @@ void EntityTree::processChallengeOwnershipPacket(ReceivedMessage& message, const
     }
 }
 
+class EntityTree::PreparedEntityEdit : public Octree::PreparedEdit {
+public:
+    bool isErase { false };
+    bool isAdd { false };
+    bool isClone { false };
+    bool isPhysics { false };
+    bool valid { false };
+    bool rejectAdd { false };   // the sender must be told that its add failed
+    bool filtered { false };
+    bool allowed { true };
+    bool suppressDisallowedClientScript { false };
+    bool suppressDisallowedServerScript { false };
+    bool suppressDisallowedPrivateUserData { false };
+
+    EntityItemID entityItemID;
+    EntityItemID entityIDToClone;
+    EntityItemPointer entityToClone;
+    EntityItemPointer existingEntity;
+    EntityItemProperties properties;
+    std::vector<EntityItemID> erasedIDs;
+
+    // what the filter saw: the entity's last change on the server, and the properties before the filter changed or
+    // rejected them (null if it let them through as they were), so that the edit can be filtered again if an earlier
+    // edit of the batch changed the entity in the meantime.
+    quint64 filteredChangedOnServer { 0 };
+    std::unique_ptr<EntityItemProperties> unfilteredProperties;
+
+    quint64 decodeTime { 0 };
+    quint64 lookupTime { 0 };
+    quint64 filterTime { 0 };
+};
+
 // NOTE: Caller must lock the tree before calling this.
 int EntityTree::processEditPacketData(ReceivedMessage& message, const unsigned char* editData, int maxLength,
                                      const SharedNodePointer& senderNode) {
@@ -1807,324 +1627,374 @@ int EntityTree::processEditPacketData(ReceivedMessage& message, const unsigned c
         return 0;
     }
 
+    PreparedEditPointer edit = prepareEditPacketData(message, editData, maxLength, senderNode);
+    if (!edit) {
+        return 0;
+    }
+    applyPreparedEdit(message, *edit, senderNode);
+    return edit->bytesRead;
+}
+
+// NOTE: Caller must hold at least the read lock.  This doesn't change the tree, so edits can be prepared in parallel.
+Octree::PreparedEditPointer EntityTree::prepareEditPacketData(ReceivedMessage& message, const unsigned char* editData,
+                                                              int maxLength, const SharedNodePointer& senderNode) {
+    auto edit = std::make_unique<PreparedEntityEdit>();
+
     int processedBytes = 0;
-    bool isAdd = false;
-    bool isClone = false;
     // we handle these types of "edit" packets
     switch (message.getType()) {
         case PacketType::EntityErase: {
             QByteArray dataByteArray = QByteArray::fromRawData(reinterpret_cast<const char*>(editData), maxLength);
-            processedBytes = processEraseMessageDetails(dataByteArray, senderNode);
-            break;
+            edit->isErase = true;
+            edit->bytesRead = decodeEraseMessageDetails(dataByteArray, edit->erasedIDs);
+            return std::move(edit);
         }
 
         case PacketType::EntityClone:
-            isClone = true; // fall through to next case
+            edit->isClone = true; // fall through to next case
             // FALLTHRU
         case PacketType::EntityAdd:
-            isAdd = true;  // fall through to next case
+            edit->isAdd = true;  // fall through to next case
             // FALLTHRU
         case PacketType::EntityPhysics:
-        case PacketType::EntityEdit: {
-            quint64 startDecode = 0, endDecode = 0;
-            quint64 startLookup = 0, endLookup = 0;
-            quint64 startUpdate = 0, endUpdate = 0;
-            quint64 startCreate = 0, endCreate = 0;
-            quint64 startFilter = 0, endFilter = 0;
-            quint64 startLogging = 0, endLogging = 0;
-
-            bool suppressDisallowedClientScript = false;
-            bool suppressDisallowedServerScript = false;
-            bool suppressDisallowedPrivateUserData = false;
-            bool isPhysics = message.getType() == PacketType::EntityPhysics;
-
-            _totalEditMessages++;
-
-            EntityItemID entityItemID;
-            EntityItemProperties properties;
-            startDecode = usecTimestampNow();
-
-            bool validEditPacket = false;
-            EntityItemID entityIDToClone;
-            EntityItemPointer entityToClone;
-            if (isClone) {
-                QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<const char*>(editData), maxLength);
-                validEditPacket = EntityItemProperties::decodeCloneEntityMessage(buffer, processedBytes, entityIDToClone, entityItemID);
-                if (validEditPacket) {
-                    entityToClone = findEntityByEntityItemID(entityIDToClone);
-                    if (entityToClone) {
-                        properties = entityToClone->getProperties();
-                    }
-                }
-            } else {
-                validEditPacket = EntityItemProperties::decodeEntityEditPacket(editData, maxLength, processedBytes, entityItemID, properties);
-            }
+        case PacketType::EntityEdit:
+            break;
 
-            endDecode = usecTimestampNow();
+        default:
+            return nullptr;
+    }
 
-            EntityItemPointer existingEntity;
-            if (!isAdd) {
-                // search for the entity by EntityItemID
-                startLookup = usecTimestampNow();
-                existingEntity = findEntityByEntityItemID(entityItemID);
-                endLookup = usecTimestampNow();
-                if (!existingEntity) {
-                    // this is not an add-entity operation, and we don't know about the identified entity.
-                    validEditPacket = false;
-                }
-            }
+    bool isAdd = edit->isAdd;
+    bool isClone = edit->isClone;
+    edit->isPhysics = message.getType() == PacketType::EntityPhysics;
+    EntityItemProperties& properties = edit->properties;
 
-            if (validEditPacket && !_entityScriptSourceWhitelist.isEmpty()) {
+    quint64 startDecode = usecTimestampNow();
 
-                bool wasDeletedBecauseOfClientScript = false;
+    bool validEditPacket = false;
+    if (isClone) {
+        QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<const char*>(editData), maxLength);
+        validEditPacket = EntityItemProperties::decodeCloneEntityMessage(buffer, processedBytes, edit->entityIDToClone,
+                                                                         edit->entityItemID);
+        if (validEditPacket) {
+            edit->entityToClone = findEntityByEntityItemID(edit->entityIDToClone);
+            if (edit->entityToClone) {
+                properties = edit->entityToClone->getProperties();
+            }
+        }
+    } else {
+        validEditPacket = EntityItemProperties::decodeEntityEditPacket(editData, maxLength, processedBytes,
+                                                                       edit->entityItemID, properties);
+    }
+    edit->bytesRead = processedBytes;
 
-                // check the client entity script to make sure its URL is in the whitelist
-                if (!properties.getScript().isEmpty()) {
-                    bool clientScriptPassedWhitelist = isScriptInWhitelist(properties.getScript());
+    edit->decodeTime = usecTimestampNow() - startDecode;
 
-                    if (!clientScriptPassedWhitelist) {
-                        if (wantEditLogging()) {
-                            qCDebug(entities) << "User [" << senderNode->getUUID()
-                                << "] attempting to set entity script not on whitelist, edit rejected";
-                        }
+    if (!isAdd) {
+        // search for the entity by EntityItemID.  if it isn't known yet, it may be added by an edit earlier in the
+        // same batch, so applyPreparedEdit() looks for it again.
+        quint64 startLookup = usecTimestampNow();
+        edit->existingEntity = findEntityByEntityItemID(edit->entityItemID);
+        edit->lookupTime = usecTimestampNow() - startLookup;
+    }
 
-                        // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
-                        if (isAdd) {
-                            QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                            _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                            validEditPacket = false;
-                            wasDeletedBecauseOfClientScript = true;
-                        } else {
-                            suppressDisallowedClientScript = true;
-                        }
-                    }
-                }
+    if (validEditPacket && !_entityScriptSourceWhitelist.isEmpty()) {
+        // check the client entity script to make sure its URL is in the whitelist
+        if (!properties.getScript().isEmpty() && !isScriptInWhitelist(properties.getScript())) {
+            if (wantEditLogging()) {
+                qCDebug(entities) << "User [" << senderNode->getUUID()
+                    << "] attempting to set entity script not on whitelist, edit rejected";
+            }
 
-                // check all server entity scripts to make sure their URLs are in the whitelist
-                if (!properties.getServerScripts().isEmpty()) {
-                    bool serverScriptPassedWhitelist = isScriptInWhitelist(properties.getServerScripts());
+            // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
+            if (isAdd) {
+                edit->rejectAdd = true;
+                validEditPacket = false;
+            } else {
+                edit->suppressDisallowedClientScript = true;
+            }
+        }
 
-                    if (!serverScriptPassedWhitelist) {
-                        if (wantEditLogging()) {
-                            qCDebug(entities) << "User [" << senderNode->getUUID()
-                                << "] attempting to set server entity script not on whitelist, edit rejected";
-                        }
+        // check all server entity scripts to make sure their URLs are in the whitelist
+        if (!properties.getServerScripts().isEmpty() && !isScriptInWhitelist(properties.getServerScripts())) {
+            if (wantEditLogging()) {
+                qCDebug(entities) << "User [" << senderNode->getUUID()
+                    << "] attempting to set server entity script not on whitelist, edit rejected";
+            }
 
-                        // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
-                        if (isAdd) {
-                            // Make sure we didn't already need to send back a delete because the client script failed
-                            // the whitelist check
-                            if (!wasDeletedBecauseOfClientScript) {
-                                QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                                _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                                validEditPacket = false;
-                            }
-                        } else {
-                            suppressDisallowedServerScript = true;
-                        }
-                    }
-                }
+            // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
+            if (isAdd) {
+                edit->rejectAdd = true;
+                validEditPacket = false;
+            } else {
+                edit->suppressDisallowedServerScript = true;
             }
+        }
+    }
 
-            if (!properties.getPrivateUserData().isEmpty() && validEditPacket && !senderNode->getCanGetAndSetPrivateUserData()) {
-                if (wantEditLogging()) {
-                    qCDebug(entities) << "User [" << senderNode->getUUID()
-                        << "] is attempting to set private user data but user isn't allowed; edit rejected...";
-                }
+    if (!properties.getPrivateUserData().isEmpty() && validEditPacket && !senderNode->getCanGetAndSetPrivateUserData()) {
+        if (wantEditLogging()) {
+            qCDebug(entities) << "User [" << senderNode->getUUID()
+                << "] is attempting to set private user data but user isn't allowed; edit rejected...";
+        }
 
-                // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
-                if (isAdd) {
-                    QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                    _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                    validEditPacket = false;
-                } else {
-                    suppressDisallowedPrivateUserData = true;
-                }
+        // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
+        if (isAdd) {
+            edit->rejectAdd = true;
+            validEditPacket = false;
+        } else {
+            edit->suppressDisallowedPrivateUserData = true;
+        }
+    }
+
+    if (!isClone) {
+        if ((isAdd || properties.lifetimeChanged()) &&
+            ((!senderNode->getCanRez() && senderNode->getCanRezTmp()) ||
+            (!senderNode->getCanRezCertified() && senderNode->getCanRezTmpCertified()))) {
+            // this node is only allowed to rez temporary entities.  if need be, cap the lifetime.
+            if (properties.getLifetime() == ENTITY_ITEM_IMMORTAL_LIFETIME ||
+                properties.getLifetime() > _maxTmpEntityLifetime) {
+                properties.setLifetime(_maxTmpEntityLifetime);
+                bumpTimestamp(properties);
             }
+        }
 
-            if (!isClone) {
-                if ((isAdd || properties.lifetimeChanged()) &&
-                    ((!senderNode->getCanRez() && senderNode->getCanRezTmp()) ||
-                    (!senderNode->getCanRezCertified() && senderNode->getCanRezTmpCertified()))) {
-                    // this node is only allowed to rez temporary entities.  if need be, cap the lifetime.
-                    if (properties.getLifetime() == ENTITY_ITEM_IMMORTAL_LIFETIME ||
-                        properties.getLifetime() > _maxTmpEntityLifetime) {
-                        properties.setLifetime(_maxTmpEntityLifetime);
-                        bumpTimestamp(properties);
-                    }
-                }
+        if (isAdd && properties.getLocked() && !senderNode->isAllowedEditor()) {
+            // if a node can't change locks, don't allow it to create an already-locked entity -- automatically
+            // clear the locked property and allow the unlocked entity to be created.
+            properties.setLocked(false);
+            bumpTimestamp(properties);
+        }
+    }
 
-                if (isAdd && properties.getLocked() && !senderNode->isAllowedEditor()) {
-                    // if a node can't change locks, don't allow it to create an already-locked entity -- automatically
-                    // clear the locked property and allow the unlocked entity to be created.
-                    properties.setLocked(false);
-                    bumpTimestamp(properties);
-                }
-            }
+    edit->valid = validEditPacket;
+    if (validEditPacket && (isAdd || edit->existingEntity)) {
+        filterPreparedEdit(*edit, senderNode);
+    }
+    return std::move(edit);
+}
 
-            // If we got a valid edit packet, then it could be a new entity or it could be an update to
-            // an existing entity... handle appropriately
-            if (validEditPacket) {
-                startFilter = usecTimestampNow();
-                bool wasChanged = false;
-                // Having (un)lock rights bypasses the filter, unless it's a physics result.
-                FilterType filterType = isPhysics ? FilterType::Physics : (isAdd ? FilterType::Add : FilterType::Edit);
-                bool allowed = (!isPhysics && senderNode->isAllowedEditor()) || filterProperties(existingEntity, properties, properties, wasChanged, filterType);
-                if (!allowed) {
-                    // the update failed and we need to convey that fact to the sender
-                    // our method is to re-assert the current properties and bump the lastEdited timestamp
-                    auto timestamp = properties.getLastEdited();
-                    properties = EntityItemProperties();
-                    properties.setLastEdited(timestamp);
-                }
-                if (!allowed || wasChanged) {
-                    bumpTimestamp(properties);
-                    // For now, free ownership on any modification.
-                    properties.clearSimulationOwner();
-                }
-                endFilter = usecTimestampNow();
+void EntityTree::filterPreparedEdit(PreparedEntityEdit& edit, const SharedNodePointer& senderNode) const {
+    quint64 startFilter = usecTimestampNow();
+    EntityItemProperties& properties = edit.properties;
+    if (edit.unfilteredProperties) {
+        // filtered again, from what the sender asked for
+        properties = std::move(*edit.unfilteredProperties);
+        edit.unfilteredProperties.reset();
+    }
+    if (edit.existingEntity) {
+        edit.filteredChangedOnServer = edit.existingEntity->getLastChangedOnServer();
+    }
+
+    bool wasChanged = false;
+    // Having (un)lock rights bypasses the filter, unless it's a physics result.
+    FilterType filterType = edit.isPhysics ? FilterType::Physics : (edit.isAdd ? FilterType::Add : FilterType::Edit);
+    edit.allowed = !edit.isPhysics && senderNode->isAllowedEditor();
+    if (!edit.allowed) {
+        EntityItemProperties unfilteredProperties = properties;
+        edit.allowed = filterProperties(edit.existingEntity, properties, properties, wasChanged, filterType,
+                                        senderNode->getUUID());
+        if (!edit.allowed || wasChanged) {
+            edit.unfilteredProperties.reset(new EntityItemProperties(std::move(unfilteredProperties)));
+        }
+    }
+    if (!edit.allowed) {
+        // the update failed and we need to convey that fact to the sender
+        // our method is to re-assert the current properties and bump the lastEdited timestamp
+        auto timestamp = properties.getLastEdited();
+        properties = EntityItemProperties();
+        properties.setLastEdited(timestamp);
+    }
+    if (!edit.allowed || wasChanged) {
+        bumpTimestamp(properties);
+        // For now, free ownership on any modification.
+        properties.clearSimulationOwner();
+    }
+    edit.filtered = true;
+    edit.filterTime += usecTimestampNow() - startFilter;
+}
+
+// NOTE: Caller must hold the write lock.
+void EntityTree::applyPreparedEdit(ReceivedMessage& message, PreparedEdit& preparedEdit, const SharedNodePointer& senderNode) {
+    PreparedEntityEdit& edit = static_cast<PreparedEntityEdit&>(preparedEdit);
+
+    if (edit.isErase) {
+        if (!edit.erasedIDs.empty()) {
+            bool force = senderNode->isAllowedEditor();
+            bool ignoreWarnings = true;
+            deleteEntitiesByID(edit.erasedIDs, force, ignoreWarnings);
+        }
+        return;
+    }
 
-                if (existingEntity && !isAdd) {
+    quint64 startUpdate = 0, endUpdate = 0;
+    quint64 startCreate = 0, endCreate = 0;
+    quint64 startLogging = 0, endLogging = 0;
 
-                    if (suppressDisallowedClientScript) {
-                        bumpTimestamp(properties);
-                        properties.setScript(existingEntity->getScript());
-                    }
+    _totalEditMessages++;
 
-                    if (suppressDisallowedServerScript) {
-                        bumpTimestamp(properties);
-                        properties.setServerScripts(existingEntity->getServerScripts());
-                    }
+    bool isAdd = edit.isAdd;
+    bool isClone = edit.isClone;
+    const EntityItemID& entityItemID = edit.entityItemID;
+    const EntityItemID& entityIDToClone = edit.entityIDToClone;
+    EntityItemProperties& properties = edit.properties;
+
+    if (edit.rejectAdd) {
+        QWriteLocker locker(&_recentlyDeletedEntitiesLock);
+        _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
+    }
+
+    EntityItemPointer existingEntity;
+    if (!isAdd && edit.valid) {
+        // an earlier edit of the batch may have added, deleted or changed the entity.  The filter and its zones depend on
+        // the entity as it is, e.g. where it is, so in the last case the edit is filtered again against the entity the
+        // earlier edit left.
+        quint64 startLookup = usecTimestampNow();
+        existingEntity = findEntityByEntityItemID(entityItemID);
+        edit.lookupTime += usecTimestampNow() - startLookup;
+        if (existingEntity && (!edit.filtered || existingEntity != edit.existingEntity ||
+                               existingEntity->getLastChangedOnServer() != edit.filteredChangedOnServer)) {
+            edit.existingEntity = existingEntity;
+            filterPreparedEdit(edit, senderNode);
+        }
+    }
+
+    // If we got a valid edit packet, then it could be a new entity or it could be an update to
+    // an existing entity... handle appropriately
+    if (edit.valid && (isAdd || existingEntity)) {
+        bool allowed = edit.allowed;
+        if (existingEntity && !isAdd) {
+
+            if (edit.suppressDisallowedClientScript) {
+                bumpTimestamp(properties);
+                properties.setScript(existingEntity->getScript());
+            }
+
+            if (edit.suppressDisallowedServerScript) {
+                bumpTimestamp(properties);
+                properties.setServerScripts(existingEntity->getServerScripts());
+            }
+
+            if (edit.suppressDisallowedPrivateUserData) {
+                bumpTimestamp(properties);
+                properties.setPrivateUserData(existingEntity->getPrivateUserData());
+            }
+
+            // if the EntityItem exists, then update it
+            startLogging = usecTimestampNow();
+            if (wantEditLogging()) {
+                qCDebug(entities) << "User [" << senderNode->getUUID() << "] editing entity. ID:" << entityItemID;
+                qCDebug(entities) << "   properties:" << properties;
+            }
+            if (wantTerseEditLogging()) {
+                QList<QString> changedProperties = properties.listChangedProperties();
+                fixupTerseEditLogging(properties, changedProperties);
+                qCDebug(entities) << senderNode->getUUID() << "edit" <<
+                    existingEntity->getDebugName() << changedProperties;
+            }
+            endLogging = usecTimestampNow();
+
+            startUpdate = usecTimestampNow();
+            if (!edit.isPhysics) {
+                properties.setLastEditedBy(senderNode->getUUID());
+            }
+            updateEntity(existingEntity, properties, senderNode);
+            existingEntity->markAsChangedOnServer();
+            endUpdate = usecTimestampNow();
+            _totalUpdates++;
+        } else if (isAdd) {
+            const EntityItemPointer& entityToClone = edit.entityToClone;
+            bool failedAdd = !allowed;
+            bool isCertified = !properties.getCertificateID().isEmpty();
+            bool isCloneable = properties.getCloneable();
+            int cloneLimit = properties.getCloneLimit();
+            if (!allowed) {
+                qCDebug(entities) << "Filtered entity add. ID:" << entityItemID;
+            } else if (!isClone && !isCertified && !senderNode->getCanRez() && !senderNode->getCanRezTmp()) {
+                failedAdd = true;
+                qCDebug(entities) << "User without 'uncertified rez rights' [" << senderNode->getUUID()
+                    << "] attempted to add an uncertified entity with ID:" << entityItemID;
+            } else if (!isClone && isCertified && !senderNode->getCanRezCertified() && !senderNode->getCanRezTmpCertified()) {
+                failedAdd = true;
+                qCDebug(entities) << "User without 'certified rez rights' [" << senderNode->getUUID()
+                    << "] attempted to add a certified entity with ID:" << entityItemID;
+            } else if (isClone && isCertified && !properties.getCertificateType().contains(DOMAIN_UNLIMITED)) {
+                failedAdd = true;
+                qCDebug(entities) << "User attempted to clone certified entity from entity ID:" << entityIDToClone;
+            } else if (isClone && !isCloneable) {
+                failedAdd = true;
+                qCDebug(entities) << "User attempted to clone non-cloneable entity from entity ID:" << entityIDToClone;
+            } else if (isClone && entityToClone && entityToClone->getCloneIDs().size() >= cloneLimit && cloneLimit != 0) {
+                failedAdd = true;
+                qCDebug(entities) << "User attempted to clone entity ID:" << entityIDToClone << " which reached it's cloneable limit.";
+            } else {
+                if (isClone) {
+                    properties.convertToCloneProperties(entityIDToClone);
+                }
 
-                    if (suppressDisallowedPrivateUserData) {
-                        bumpTimestamp(properties);
-                        properties.setPrivateUserData(existingEntity->getPrivateUserData());
+                // this is a new entity... assign a new entityID
+                properties.setLastEditedBy(senderNode->getUUID());
+                startCreate = usecTimestampNow();
+                EntityItemPointer newEntity = addEntity(entityItemID, properties);
+                endCreate = usecTimestampNow();
+                _totalCreates++;
+
+                if (newEntity && isCertified && getIsServer()) {
+                    if (!properties.verifyStaticCertificateProperties()) {
+                        qCDebug(entities) << "User" << senderNode->getUUID()
+                            << "attempted to add a certified entity with ID" << entityItemID << "which failed"
+                            << "static certificate verification.";
+                        // Delete the entity we just added if it doesn't pass static certificate verification
+                        deleteEntity(entityItemID, true);
+                    } else {
+                        validatePop(properties.getCertificateID(), entityItemID, senderNode);
                     }
+                }
+
+                if (newEntity && isClone) {
+                    entityToClone->addCloneID(newEntity->getEntityItemID());
+                    newEntity->setCloneOriginID(entityIDToClone);
+                }
+
+                if (newEntity) {
+                    newEntity->markAsChangedOnServer();
+                    notifyNewlyCreatedEntity(*newEntity, senderNode);
 
-                    // if the EntityItem exists, then update it
                     startLogging = usecTimestampNow();
                     if (wantEditLogging()) {
-                        qCDebug(entities) << "User [" << senderNode->getUUID() << "] editing entity. ID:" << entityItemID;
+                        qCDebug(entities) << "User [" << senderNode->getUUID() << "] added entity. ID:"
+                                          << newEntity->getEntityItemID();
                         qCDebug(entities) << "   properties:" << properties;
                     }
                     if (wantTerseEditLogging()) {
                         QList<QString> changedProperties = properties.listChangedProperties();
                         fixupTerseEditLogging(properties, changedProperties);
-                        qCDebug(entities) << senderNode->getUUID() << "edit" <<
-                            existingEntity->getDebugName() << changedProperties;
+                        qCDebug(entities) << senderNode->getUUID() << "add" << entityItemID << changedProperties;
                     }
                     endLogging = usecTimestampNow();
 
-                    startUpdate = usecTimestampNow();
-                    if (!isPhysics) {
-                        properties.setLastEditedBy(senderNode->getUUID());
-                    }
-                    updateEntity(existingEntity, properties, senderNode);
-                    existingEntity->markAsChangedOnServer();
-                    endUpdate = usecTimestampNow();
-                    _totalUpdates++;
-                } else if (isAdd) {
-                    bool failedAdd = !allowed;
-                    bool isCertified = !properties.getCertificateID().isEmpty();
-                    bool isCloneable = properties.getCloneable();
-                    int cloneLimit = properties.getCloneLimit();
-                    if (!allowed) {
-                        qCDebug(entities) << "Filtered entity add. ID:" << entityItemID;
-                    } else if (!isClone && !isCertified && !senderNode->getCanRez() && !senderNode->getCanRezTmp()) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User without 'uncertified rez rights' [" << senderNode->getUUID()
-                            << "] attempted to add an uncertified entity with ID:" << entityItemID;
-                    } else if (!isClone && isCertified && !senderNode->getCanRezCertified() && !senderNode->getCanRezTmpCertified()) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User without 'certified rez rights' [" << senderNode->getUUID()
-                            << "] attempted to add a certified entity with ID:" << entityItemID;
-                    } else if (isClone && isCertified && !properties.getCertificateType().contains(DOMAIN_UNLIMITED)) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User attempted to clone certified entity from entity ID:" << entityIDToClone;
-                    } else if (isClone && !isCloneable) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User attempted to clone non-cloneable entity from entity ID:" << entityIDToClone;
-                    } else if (isClone && entityToClone && entityToClone->getCloneIDs().size() >= cloneLimit && cloneLimit != 0) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User attempted to clone entity ID:" << entityIDToClone << " which reached it's cloneable limit.";
-                    } else {
-                        if (isClone) {
-                            properties.convertToCloneProperties(entityIDToClone);
-                        }
-
-                        // this is a new entity... assign a new entityID
-                        properties.setLastEditedBy(senderNode->getUUID());
-                        startCreate = usecTimestampNow();
-                        EntityItemPointer newEntity = addEntity(entityItemID, properties);
-                        endCreate = usecTimestampNow();
-                        _totalCreates++;
-
-                        if (newEntity && isCertified && getIsServer()) {
-                            if (!properties.verifyStaticCertificateProperties()) {
-                                qCDebug(entities) << "User" << senderNode->getUUID()
-                                    << "attempted to add a certified entity with ID" << entityItemID << "which failed"
-                                    << "static certificate verification.";
-                                // Delete the entity we just added if it doesn't pass static certificate verification
-                                deleteEntity(entityItemID, true);
-                            } else {
-                                validatePop(properties.getCertificateID(), entityItemID, senderNode);
-                            }
-                        }
-
-                        if (newEntity && isClone) {
-                            entityToClone->addCloneID(newEntity->getEntityItemID());
-                            newEntity->setCloneOriginID(entityIDToClone);
-                        }
-
-                        if (newEntity) {
-                            newEntity->markAsChangedOnServer();
-                            notifyNewlyCreatedEntity(*newEntity, senderNode);
-                            
-                            startLogging = usecTimestampNow();
-                            if (wantEditLogging()) {
-                                qCDebug(entities) << "User [" << senderNode->getUUID() << "] added entity. ID:"
-                                                  << newEntity->getEntityItemID();
-                                qCDebug(entities) << "   properties:" << properties;
-                            }
-                            if (wantTerseEditLogging()) {
-                                QList<QString> changedProperties = properties.listChangedProperties();
-                                fixupTerseEditLogging(properties, changedProperties);
-                                qCDebug(entities) << senderNode->getUUID() << "add" << entityItemID << changedProperties;
-                            }
-                            endLogging = usecTimestampNow();
-
-                        } else {
-                            failedAdd = true;
-                            qCDebug(entities) << "Add entity failed ID:" << entityItemID;
-                        }
-                    }
-                    if (failedAdd) { // Let client know it failed, so that they don't have an entity that no one else sees.
-                        QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                        _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                    }
                 } else {
-                    HIFI_FCDEBUG(entities(), "Edit failed. [" << message.getType() <<"] " <<
-                            "entity id:" << entityItemID << 
-                            "existingEntity pointer:" << existingEntity.get());
+                    failedAdd = true;
+                    qCDebug(entities) << "Add entity failed ID:" << entityItemID;
                 }
             }
-
-
-            _totalDecodeTime += endDecode - startDecode;
-            _totalLookupTime += endLookup - startLookup;
-            _totalUpdateTime += endUpdate - startUpdate;
-            _totalCreateTime += endCreate - startCreate;
-            _totalLoggingTime += endLogging - startLogging;
-            _totalFilterTime += endFilter - startFilter;
-
-            break;
+            if (failedAdd) { // Let client know it failed, so that they don't have an entity that no one else sees.
+                QWriteLocker locker(&_recentlyDeletedEntitiesLock);
+                _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
+            }
+        } else {
+            HIFI_FCDEBUG(entities(), "Edit failed. [" << message.getType() <<"] " <<
+                    "entity id:" << entityItemID <<
+                    "existingEntity pointer:" << existingEntity.get());
         }
-
-        default:
-            processedBytes = 0;
-            break;
     }
-    return processedBytes;
+
+    _totalDecodeTime += edit.decodeTime;
+    _totalLookupTime += edit.lookupTime;
+    _totalUpdateTime += endUpdate - startUpdate;
+    _totalCreateTime += endCreate - startCreate;
+    _totalLoggingTime += endLogging - startLogging;
+    _totalFilterTime += edit.filterTime;
 }
 
 
@@ -2405,7 +2275,8 @@ bool EntityTree::shouldEraseEntity(EntityItemID entityID, const SharedNodePointe
     EntityItemProperties dummyProperties;
     bool wasChanged = false;
 
-    bool allowed = (sourceNode->isAllowedEditor()) || filterProperties(existingEntity, dummyProperties, dummyProperties, wasChanged, filterType);
+    bool allowed = (sourceNode->isAllowedEditor()) || filterProperties(existingEntity, dummyProperties, dummyProperties,
+        wasChanged, filterType, sourceNode->getUUID());
     auto endFilter = usecTimestampNow();
 
     _totalFilterTime += endFilter - startFilter;
@@ -2497,8 +2368,19 @@ int EntityTree::processEraseMessageDetails(const QByteArray& dataByteArray, cons
     // NOTE: this is called on entity-server when receiving a delete request from an interface-client or agent
     //TODO: assert(treeIsLocked);
     assert(getIsServer());
+    std::vector<EntityItemID> ids;
+    int processedBytes = decodeEraseMessageDetails(dataByteArray, ids);
+    if (!ids.empty()) {
+        bool force = sourceNode->isAllowedEditor();
+        bool ignoreWarnings = true;
+        deleteEntitiesByID(ids, force, ignoreWarnings);
+    }
+    return processedBytes;
+}
+
+int EntityTree::decodeEraseMessageDetails(const QByteArray& dataByteArray, std::vector<EntityItemID>& ids) const {
     #ifdef EXTRA_ERASE_DEBUGGING
-        qCDebug(entities) << "EntityTree::processEraseMessageDetails()";
+        qCDebug(entities) << "EntityTree::decodeEraseMessageDetails()";
     #endif
     size_t packetLength = dataByteArray.size();
     size_t processedBytes = 0;
@@ -2508,13 +2390,12 @@ int EntityTree::processEraseMessageDetails(const QByteArray& dataByteArray, cons
     processedBytes += sizeof(numberOfIds);
 
     if (numberOfIds > 0) {
-        std::vector<EntityItemID> ids;
         ids.reserve(numberOfIds);
 
         // extract ids from packet
         for (size_t i = 0; i < numberOfIds; i++) {
             if (processedBytes + NUM_BYTES_RFC4122_UUID > packetLength) {
-                qCDebug(entities) << "EntityTree::processEraseMessageDetails().... bailing because not enough bytes in buffer";
+                qCDebug(entities) << "EntityTree::decodeEraseMessageDetails().... bailing because not enough bytes in buffer";
                 break; // bail to prevent buffer overflow
             }
 
@@ -2523,16 +2404,12 @@ int EntityTree::processEraseMessageDetails(const QByteArray& dataByteArray, cons
             processedBytes += encodedID.size();
 
             #ifdef EXTRA_ERASE_DEBUGGING
-                qCDebug(entities) << "    ---- EntityTree::processEraseMessageDetails() contains id:" << id;
+                qCDebug(entities) << "    ---- EntityTree::decodeEraseMessageDetails() contains id:" << id;
             #endif
 
             EntityItemID entityID(id);
             ids.push_back(entityID);
         }
-
-        bool force = sourceNode->isAllowedEditor();
-        bool ignoreWarnings = true;
-        deleteEntitiesByID(ids, force, ignoreWarnings);
     }
     return (int)processedBytes;
 }
@@ -2559,11 +2436,32 @@ void EntityTree::addEntityMapEntry(EntityItemPointer entity) {
         return;
     }
     _entityMap.insert(id, entity);
+    _entityMapEpoch++;
+    _boundsIndex->addEntity(entity);
 }
 
 void EntityTree::clearEntityMapEntry(const EntityItemID& id) {
     QWriteLocker locker(&_entityMapLock);
-    _entityMap.remove(id);
+    EntityItemPointer entity = _entityMap.take(id);
+    if (entity) {
+        _entityMapEpoch++;
+        _boundsIndex->removeEntity(entity);
+    }
+}
+
+EntityTreeEpochPointer EntityTree::getCurrentEpoch() const {
+    std::lock_guard<std::mutex> lock(_currentEpochMutex);
+    QReadLocker locker(&_entityMapLock);
+    if (!_currentEpoch || _currentEpoch->number != _entityMapEpoch) {
+        auto epoch = std::make_shared<EntityTreeEpoch>();
+        epoch->number = _entityMapEpoch;
+        epoch->entities.reserve(_entityMap.size());
+        for (const auto& entity : _entityMap) {
+            epoch->entities.push_back(entity);
+        }
+        _currentEpoch = epoch;
+    }
+    return _currentEpoch;
 }
 
 void EntityTree::debugDumpMap() {
@@ -2971,6 +2869,138 @@ void convertGrabUserDataToProperties(EntityItemProperties& properties) {
 }
 
 
+EntityItemPointer EntityTree::addEntityFromContent(const EntityItemID& entityItemID, EntityItemProperties& properties,
+                                                   const QVariantMap& entityMap, int contentVersion, bool isImport) {
+    // handle parentJointName for wearables
+    if (_myAvatar && entityMap.contains("parentJointName") && properties.getParentID() == AVATAR_SELF_ID) {
+        properties.setParentJointIndex(_myAvatar->getJointIndex(entityMap["parentJointName"].toString()));
+
+        qCDebug(entities) << "Found parentJointName " << entityMap["parentJointName"].toString() <<
+            " mapped it to parentJointIndex " << properties.getParentJointIndex();
+    }
+
+    // Convert old clientOnly bool to new entityHostType enum
+    // (must happen before setOwningAvatarID below)
+    if (contentVersion < (int)EntityVersion::EntityHostTypes) {
+        if (entityMap.contains("clientOnly")) {
+            properties.setEntityHostType(entityMap["clientOnly"].toBool() ? entity::HostType::AVATAR : entity::HostType::DOMAIN);
+        }
+    }
+
+    if (properties.getEntityHostType() == entity::HostType::AVATAR) {
+        auto nodeList = DependencyManager::get<NodeList>();
+        const QUuid myNodeID = nodeList->getSessionUUID();
+        properties.setOwningAvatarID(myNodeID);
+    }
+
+    // Fix for older content not containing mode fields in the zones
+    if (contentVersion < (int)EntityVersion::ZoneLightInheritModes && (properties.getType() == EntityTypes::EntityType::Zone)) {
+        // The legacy version had no keylight mode - this is set to on
+        properties.setKeyLightMode(COMPONENT_MODE_ENABLED);
+
+        // The ambient URL has been moved from "keyLight" to "ambientLight"
+        if (entityMap.contains("keyLight")) {
+            QVariantMap keyLightObject = entityMap["keyLight"].toMap();
+            properties.getAmbientLight().setAmbientURL(keyLightObject["ambientURL"].toString());
+        }
+
+        // Copy the skybox URL if the ambient URL is empty, as this is the legacy behaviour
+        // Use skybox value only if it is not empty, else set ambientMode to inherit (to use default URL)
+        properties.setAmbientLightMode(COMPONENT_MODE_ENABLED);
+        if (properties.getAmbientLight().getAmbientURL() == "") {
+            if (properties.getSkybox().getURL() != "") {
+                properties.getAmbientLight().setAmbientURL(properties.getSkybox().getURL());
+            } else {
+                properties.setAmbientLightMode(COMPONENT_MODE_INHERIT);
+            }
+        }
+
+        // The background should be enabled if the mode is skybox
+        // Note that if the values are default then they are not stored in the JSON file
+        if (entityMap.contains("backgroundMode") && (entityMap["backgroundMode"].toString() == "skybox")) {
+            properties.setSkyboxMode(COMPONENT_MODE_ENABLED);
+        } else {
+            properties.setSkyboxMode(COMPONENT_MODE_INHERIT);
+        }
+    }
+
+    // Convert old materials so that they use materialData instead of userData
+    if (contentVersion < (int)EntityVersion::MaterialData && properties.getType() == EntityTypes::EntityType::Material) {
+        if (properties.getMaterialURL().startsWith("userData")) {
+            QString materialURL = properties.getMaterialURL();
+            properties.setMaterialURL(materialURL.replace("userData", "materialData"));
+
+            QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
+            QJsonObject materialData;
+            QJsonValue materialVersion = userData["materialVersion"];
+            if (!materialVersion.isNull()) {
+                materialData.insert("materialVersion", materialVersion);
+                userData.remove("materialVersion");
+            }
+            QJsonValue materials = userData["materials"];
+            if (!materials.isNull()) {
+                materialData.insert("materials", materials);
+                userData.remove("materials");
+            }
+
+            properties.setMaterialData(QJsonDocument(materialData).toJson());
+            properties.setUserData(QJsonDocument(userData).toJson());
+        }
+    }
+
+    // Convert old cloneable entities so they use cloneableData instead of userData
+    if (contentVersion < (int)EntityVersion::CloneableData) {
+        QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
+        QJsonObject grabbableKey = userData["grabbableKey"].toObject();
+        QJsonValue cloneable = grabbableKey["cloneable"];
+        if (cloneable.isBool() && cloneable.toBool()) {
+            QJsonValue cloneLifetime = grabbableKey["cloneLifetime"];
+            QJsonValue cloneLimit = grabbableKey["cloneLimit"];
+            QJsonValue cloneDynamic = grabbableKey["cloneDynamic"];
+            QJsonValue cloneAvatarEntity = grabbableKey["cloneAvatarEntity"];
+
+            // This is cloneable, we need to convert the properties
+            properties.setCloneable(true);
+            properties.setCloneLifetime(cloneLifetime.toInt());
+            properties.setCloneLimit(cloneLimit.toInt());
+            properties.setCloneDynamic(cloneDynamic.toBool());
+            properties.setCloneAvatarEntity(cloneAvatarEntity.toBool());
+        }
+    }
+
+    // convert old grab-related userData to new grab properties
+    if (contentVersion < (int)EntityVersion::GrabProperties) {
+        convertGrabUserDataToProperties(properties);
+    }
+
+    // Zero out the spread values that were fixed in version ParticleEntityFix so they behave the same as before
+    if (contentVersion < (int)EntityVersion::ParticleEntityFix) {
+        properties.setRadiusSpread(0.0f);
+        properties.setAlphaSpread(0.0f);
+        properties.setColorSpread({0, 0, 0});
+    }
+
+    if (contentVersion < (int)EntityVersion::FixPropertiesFromCleanup) {
+        if (entityMap.contains("created")) {
+            quint64 created = QDateTime::fromString(entityMap["created"].toString().trimmed(), Qt::ISODate).toMSecsSinceEpoch() * 1000;
+            properties.setCreated(created);
+        }
+    }
+
+    // Before, billboarded entities ignored rotation.  Now, they use it to determine which axis is facing you.
+    if (contentVersion < (int)EntityVersion::AllBillboardMode) {
+        if (properties.getBillboardMode() != BillboardMode::NONE) {
+            properties.setRotation(glm::quat());
+        }
+    }
+
+    EntityItemPointer entity = addEntity(entityItemID, properties, isImport);
+    if (!entity) {
+        qCDebug(entities) << "adding Entity failed:" << entityItemID << properties.getType();
+    }
+    return entity;
+}
+
 bool EntityTree::readFromMap(QVariantMap& map, const bool isImport) {
     // These are needed to deal with older content (before adding inheritance modes)
     int contentVersion = map["Version"].toInt();
@@ -3011,17 +3041,6 @@ bool EntityTree::readFromMap(QVariantMap& map, const bool isImport) {
     foreach (QVariant entityVariant, entitiesQList) {
         // QVariantMap --> QScriptValue --> EntityItemProperties --> Entity
         QVariantMap entityMap = entityVariant.toMap();
-
-        // handle parentJointName for wearables
-        if (_myAvatar && entityMap.contains("parentJointName") && entityMap.contains("parentID") &&
-            QUuid(entityMap["parentID"].toString()) == AVATAR_SELF_ID) {
-
-            entityMap["parentJointIndex"] = _myAvatar->getJointIndex(entityMap["parentJointName"].toString());
-
-            qCDebug(entities) << "Found parentJointName " << entityMap["parentJointName"].toString() <<
-                " mapped it to parentJointIndex " << entityMap["parentJointIndex"].toInt();
-        }
-
         QScriptValue entityScriptValue = variantMapToScriptValue(entityMap, scriptEngine);
         EntityItemProperties properties;
         EntityItemPropertiesFromScriptValueIgnoreReadOnly(entityScriptValue, properties);
@@ -3033,133 +3052,181 @@ bool EntityTree::readFromMap(QVariantMap& map, const bool isImport) {
             entityItemID = EntityItemID(QUuid::createUuid());
         }
 
-        // Convert old clientOnly bool to new entityHostType enum
-        // (must happen before setOwningAvatarID below)
-        if (contentVersion < (int)EntityVersion::EntityHostTypes) {
-            if (entityMap.contains("clientOnly")) {
-                properties.setEntityHostType(entityMap["clientOnly"].toBool() ? entity::HostType::AVATAR : entity::HostType::DOMAIN);
+        EntityItemPointer entity = addEntityFromContent(entityItemID, properties, entityMap, contentVersion, isImport);
+        if (!entity) {
+            success = false;
+        } else {
+            const QUuid& cloneOriginID = entity->getCloneOriginID();
+            if (!cloneOriginID.isNull()) {
+                cloneIDs[cloneOriginID].push_back(entity->getEntityItemID());
             }
         }
+    }
 
-        if (properties.getEntityHostType() == entity::HostType::AVATAR) {
-            auto nodeList = DependencyManager::get<NodeList>();
-            const QUuid myNodeID = nodeList->getSessionUUID();
-            properties.setOwningAvatarID(myNodeID);
+    for (const auto& entityID : cloneIDs.keys()) {
+        auto entity = findEntityByID(entityID);
+        if (entity) {
+            entity->setCloneIDs(cloneIDs.value(entityID));
         }
+    }
 
-        // Fix for older content not containing mode fields in the zones
-        if (contentVersion < (int)EntityVersion::ZoneLightInheritModes && (properties.getType() == EntityTypes::EntityType::Zone)) {
-            // The legacy version had no keylight mode - this is set to on
-            properties.setKeyLightMode(COMPONENT_MODE_ENABLED);
+    return success;
+}
 
-            // The ambient URL has been moved from "keyLight" to "ambientLight"
-            if (entityMap.contains("keyLight")) {
-                QVariantMap keyLightObject = entityMap["keyLight"].toMap();
-                properties.getAmbientLight().setAmbientURL(keyLightObject["ambientURL"].toString());
-            }
+bool EntityTree::readFromJSON(const QByteArray& json, const QString& marketplaceID, const bool isImport,
+                              const QUrl& relativeURL) {
+    EntityJSONReader reader(json);
+    reader.setRelativeURL(relativeURL);
+    reader.setMarketplaceID(marketplaceID);
+    if (!reader.readHeader()) {
+        qCritical() << "Couldn't parse Entities JSON:" << reader.getErrorString();
+        return false;
+    }
 
-            // Copy the skybox URL if the ambient URL is empty, as this is the legacy behaviour
-            // Use skybox value only if it is not empty, else set ambientMode to inherit (to use default URL)
-            properties.setAmbientLightMode(COMPONENT_MODE_ENABLED);
-            if (properties.getAmbientLight().getAmbientURL() == "") {
-                if (properties.getSkybox().getURL() != "") {
-                    properties.getAmbientLight().setAmbientURL(properties.getSkybox().getURL());
-                } else {
-                    properties.setAmbientLightMode(COMPONENT_MODE_INHERIT);
-                }
-            }
+    if (!reader.getPersistID().isNull()) {
+        _persistID = reader.getPersistID();
+    }
+    if (reader.hasDataVersion()) {
+        _persistDataVersion = reader.getDataVersion();
+    }
+    _namedPaths.clear();
+    const QVariantMap& namedPathsMap = reader.getPaths();
+    for (auto iter = namedPathsMap.begin(); iter != namedPathsMap.end(); ++iter) {
+        _namedPaths[iter.key()] = iter.value().toString();
+    }
 
-            // The background should be enabled if the mode is skybox
-            // Note that if the values are default then they are not stored in the JSON file
-            if (entityMap.contains("backgroundMode") && (entityMap["backgroundMode"].toString() == "skybox")) {
-                properties.setSkyboxMode(COMPONENT_MODE_ENABLED);
+    // each batch is added while the next one is parsed
+    int contentVersion = reader.getVersion();
+    QMap<QUuid, QVector<QUuid>> cloneIDs;
+    bool success = true;
+    bool parsed = reader.readEntities([&](EntityJSONReader::Batch& batch) {
+        for (auto& batchEntity : batch) {
+            EntityItemPointer entity = addEntityFromContent(batchEntity.id, batchEntity.properties, batchEntity.otherValues,
+                                                            contentVersion, isImport);
+            if (!entity) {
+                success = false;
             } else {
-                properties.setSkyboxMode(COMPONENT_MODE_INHERIT);
+                const QUuid& cloneOriginID = entity->getCloneOriginID();
+                if (!cloneOriginID.isNull()) {
+                    cloneIDs[cloneOriginID].push_back(entity->getEntityItemID());
+                }
             }
         }
+        return true;
+    });
+    if (!parsed) {
+        qCritical() << "Couldn't parse Entities JSON:" << reader.getErrorString();
+        return false;
+    }
 
-        // Convert old materials so that they use materialData instead of userData
-        if (contentVersion < (int)EntityVersion::MaterialData && properties.getType() == EntityTypes::EntityType::Material) {
-            if (properties.getMaterialURL().startsWith("userData")) {
-                QString materialURL = properties.getMaterialURL();
-                properties.setMaterialURL(materialURL.replace("userData", "materialData"));
-
-                QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
-                QJsonObject materialData;
-                QJsonValue materialVersion = userData["materialVersion"];
-                if (!materialVersion.isNull()) {
-                    materialData.insert("materialVersion", materialVersion);
-                    userData.remove("materialVersion");
-                }
-                QJsonValue materials = userData["materials"];
-                if (!materials.isNull()) {
-                    materialData.insert("materials", materials);
-                    userData.remove("materials");
-                }
+    qCDebug(entities) << "Read" << reader.getNumEntities() << "entities," << reader.getNumConvertedEntities()
+                      << "of them with values converted through a script value";
+    if (reader.getNumEntities() == 0) {
+        // Empty map or invalidly formed file.
+        return false;
+    }
 
-                properties.setMaterialData(QJsonDocument(materialData).toJson());
-                properties.setUserData(QJsonDocument(userData).toJson());
-            }
+    for (const auto& entityID : cloneIDs.keys()) {
+        auto entity = findEntityByID(entityID);
+        if (entity) {
+            entity->setCloneIDs(cloneIDs.value(entityID));
         }
+    }
 
-        // Convert old cloneable entities so they use cloneableData instead of userData
-        if (contentVersion < (int)EntityVersion::CloneableData) {
-            QJsonObject userData = QJsonDocument::fromJson(properties.getUserData().toUtf8()).object();
-            QJsonObject grabbableKey = userData["grabbableKey"].toObject();
-            QJsonValue cloneable = grabbableKey["cloneable"];
-            if (cloneable.isBool() && cloneable.toBool()) {
-                QJsonValue cloneLifetime = grabbableKey["cloneLifetime"];
-                QJsonValue cloneLimit = grabbableKey["cloneLimit"];
-                QJsonValue cloneDynamic = grabbableKey["cloneDynamic"];
-                QJsonValue cloneAvatarEntity = grabbableKey["cloneAvatarEntity"];
+    return success;
+}
 
-                // This is cloneable, we need to convert the properties
-                properties.setCloneable(true);
-                properties.setCloneLifetime(cloneLifetime.toInt());
-                properties.setCloneLimit(cloneLimit.toInt());
-                properties.setCloneDynamic(cloneDynamic.toBool());
-                properties.setCloneAvatarEntity(cloneAvatarEntity.toBool());
-            }
+bool EntityTree::writeToJSON(QString& jsonString, const OctreeElementPointer& element) {
+    QScriptEngine scriptEngine;
+    RecurseOctreeToJSONOperator theOperator(element, &scriptEngine, jsonString);
+    if (element == _rootElement) {
+        // the whole tree doesn't need the tree structure, so it is written without holding up the edits
+        for (const auto& entity : getCurrentEpoch()->entities) {
+            theOperator.processEntity(entity);
         }
+    } else {
+        withReadLock([&] {
+            recurseTreeWithOperator(&theOperator);
+        });
+    }
 
-        // convert old grab-related userData to new grab properties
-        if (contentVersion < (int)EntityVersion::GrabProperties) {
-            convertGrabUserDataToProperties(properties);
-        }
+    jsonString = theOperator.getJson();
+    return true;
+}
 
-        // Zero out the spread values that were fixed in version ParticleEntityFix so they behave the same as before
-        if (contentVersion < (int)EntityVersion::ParticleEntityFix) {
-            properties.setRadiusSpread(0.0f);
-            properties.setAlphaSpread(0.0f);
-            properties.setColorSpread({0, 0, 0});
-        }
+bool EntityTree::writeToBinarySnapshot(QByteArray& data) {
+    EntitySnapshot::Writer writer(_persistID, _persistDataVersion);
+    for (const auto& path : _namedPaths) {
+        writer.addPath(path.first, path.second);
+    }
 
-        if (contentVersion < (int)EntityVersion::FixPropertiesFromCleanup) {
-            if (entityMap.contains("created")) {
-                quint64 created = QDateTime::fromString(entityMap["created"].toString().trimmed(), Qt::ISODate).toMSecsSinceEpoch() * 1000;
-                properties.setCreated(created);
-            }
+    // every entity, as the json persist file: writeToJSON() doesn't skip those with bad parents either, so an entity
+    // whose parent is missing or not loaded yet is kept, and the snapshot and the json file load the same domain.
+    for (const auto& entity : getCurrentEpoch()->entities) {
+        if (!writer.addEntity(entity->getEntityItemID(), entity->getProperties())) {
+            return false;
         }
+    }
+    data = writer.finish();
+    return true;
+}
 
-        // Before, billboarded entities ignored rotation.  Now, they use it to determine which axis is facing you.
-        if (contentVersion < (int)EntityVersion::AllBillboardMode) {
-            if (properties.getBillboardMode() != BillboardMode::NONE) {
-                properties.setRotation(glm::quat());
-            }
-        }
+bool EntityTree::readFromBinarySnapshot(const QString& filename, const QUuid& persistID, int64_t dataVersion) {
+    EntitySnapshot::Reader reader;
+    if (!reader.open(filename)) {
+        return false;
+    }
+    if (reader.getPersistID() != persistID || reader.getDataVersion() != dataVersion) {
+        qCDebug(entities) << "Entity snapshot" << filename << "is out of date";
+        return false;
+    }
 
-        EntityItemPointer entity = addEntity(entityItemID, properties, isImport);
-        if (!entity) {
-            qCDebug(entities) << "adding Entity failed:" << entityItemID << properties.getType();
-            success = false;
+    _persistID = persistID;
+    _persistDataVersion = dataVersion;
+    _namedPaths = reader.getPaths();
+
+    // the next batch is decoded on other threads while the entities of this one are added to the tree
+    int numEntities = reader.getNumEntities();
+    std::vector<EntitySnapshot::Entity> batch;
+    std::vector<EntitySnapshot::Entity> nextBatch;
+    bool success = reader.decodeEntities(0, SNAPSHOT_DECODE_BATCH_SIZE, batch);
+
+    QMap<QUuid, QVector<QUuid>> cloneIDs;
+    for (int first = 0; success && first < numEntities; first += SNAPSHOT_DECODE_BATCH_SIZE) {
+        tbb::task_group decodeNextBatch;
+        bool nextBatchDecoded = true;
+        int next = first + SNAPSHOT_DECODE_BATCH_SIZE;
+        if (next < numEntities) {
+            decodeNextBatch.run([&reader, &nextBatch, &nextBatchDecoded, next] {
+                nextBatchDecoded = reader.decodeEntities(next, SNAPSHOT_DECODE_BATCH_SIZE, nextBatch);
+            });
         }
 
-        if (entity) {
+        for (const auto& snapshotEntity : batch) {
+            EntityItemPointer entity = addEntity(snapshotEntity.id, snapshotEntity.properties);
+            if (!entity) {
+                qCDebug(entities) << "adding Entity failed:" << snapshotEntity.id << snapshotEntity.properties.getType();
+                success = false;
+                break;
+            }
             const QUuid& cloneOriginID = entity->getCloneOriginID();
             if (!cloneOriginID.isNull()) {
                 cloneIDs[cloneOriginID].push_back(entity->getEntityItemID());
             }
         }
+
+        if (next < numEntities) {
+            decodeNextBatch.wait();
+            success = nextBatchDecoded && success;
+            batch.swap(nextBatch);
+        }
+    }
+
+    if (!success) {
+        // the caller falls back to the persist file
+        qCWarning(entities) << "Failed to read entity snapshot" << filename;
+        eraseAllOctreeElements();
+        return false;
     }
 
     for (const auto& entityID : cloneIDs.keys()) {
@@ -3169,18 +3236,56 @@ bool EntityTree::readFromMap(QVariantMap& map, const bool isImport) {
         }
     }
 
-    return success;
+    qCDebug(entities) << "Read" << numEntities << "entities from snapshot" << filename;
+    return true;
 }
 
-bool EntityTree::writeToJSON(QString& jsonString, const OctreeElementPointer& element) {
-    QScriptEngine scriptEngine;
-    RecurseOctreeToJSONOperator theOperator(element, &scriptEngine, jsonString);
-    withReadLock([&] {
-        recurseTreeWithOperator(&theOperator);
-    });
+void EntityTree::journalEntityChange(const EntityItemID& entityID, OctreeJournal::RecordType type) {
+    if (!_journalEnabled) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_journalMutex);
+    auto change = _journalChanges.find(entityID);
+    if (change == _journalChanges.end()) {
+        _journalChanges.insert(entityID, type);
+    } else if (type != OctreeJournal::RecordType::Edit || change.value() == OctreeJournal::RecordType::Delete) {
+        // an entity added since the last flush stays an add however often it is edited
+        change.value() = type;
+    }
+}
 
-    jsonString = theOperator.getJson();
-    return true;
+void EntityTree::takeJournalRecords(OctreeJournal::Records& records) {
+    // edits only mark their entity as changed, the serialization happens here at most once per entity per flush.
+    // an entity edited again while this runs is marked again, so its latest state makes it to the next flush.
+    QHash<EntityItemID, OctreeJournal::RecordType> changes;
+    {
+        std::lock_guard<std::mutex> lock(_journalMutex);
+        changes.swap(_journalChanges);
+    }
+    if (changes.isEmpty()) {
+        return;
+    }
+
+    if (!_journalScriptEngine) {
+        _journalScriptEngine.reset(new QScriptEngine());
+    }
+    records.reserve(records.size() + changes.size());
+    for (auto change = changes.cbegin(); change != changes.cend(); ++change) {
+        OctreeJournal::Record record { change.value(), change.key(), QByteArray() };
+        if (record.type != OctreeJournal::RecordType::Delete) {
+            EntityItemPointer entity = findEntityByEntityItemID(change.key());
+            if (entity) {
+                // same as an entity of the persist file, see RecurseOctreeToMapOperator
+                QVariantMap entityMap =
+                    EntityItemNonDefaultPropertiesToScriptValue(_journalScriptEngine.get(), entity->getProperties()).toVariant().toMap();
+                QDataStream stream(&record.payload, QIODevice::WriteOnly);
+                stream << entityMap;
+            } else {
+                record.type = OctreeJournal::RecordType::Delete;
+            }
+        }
+        records.push_back(std::move(record));
+    }
 }
 
 void EntityTree::resetClientEditStats() {
@@ -12,6 +12,9 @@
 #ifndef hifi_EntityTree_h
 #define hifi_EntityTree_h
 
+#include <memory>
+#include <mutex>
+
 #include <QSet>
 #include <QVector>
 
@@ -19,6 +22,7 @@
 #include <SpatialParentFinder.h>
 
 #include "AddEntityOperator.h"
+#include "EntityBoundsIndex.h"
 #include "EntityTreeElement.h"
 #include "DeleteEntityOperator.h"
 #include "MovingEntitiesOperator.h"
@@ -27,6 +31,16 @@ class EntityTree;
 using EntityTreePointer = std::shared_ptr<EntityTree>;
 
 class EntitySimulation;
+class QScriptEngine;
+
+// The entities of the tree at one point, for readers that go over all of them without holding the tree lock.
+// The list never changes once made, the entities themselves are read under their own locks.
+class EntityTreeEpoch {
+public:
+    uint64_t number { 0 };
+    std::vector<EntityItemPointer> entities;
+};
+using EntityTreeEpochPointer = std::shared_ptr<const EntityTreeEpoch>;
 
 namespace EntityQueryFilterSymbol {
     static const QString NonDefault = "+";
@@ -90,6 +104,10 @@ public:
     void fixupTerseEditLogging(EntityItemProperties& properties, QList<QString>& changedProperties);
     virtual int processEditPacketData(ReceivedMessage& message, const unsigned char* editData, int maxLength,
                                       const SharedNodePointer& senderNode) override;
+    virtual bool canPrepareEdits() const override { return true; }
+    virtual PreparedEditPointer prepareEditPacketData(ReceivedMessage& message, const unsigned char* editData, int maxLength,
+                                                      const SharedNodePointer& senderNode) override;
+    virtual void applyPreparedEdit(ReceivedMessage& message, PreparedEdit& edit, const SharedNodePointer& senderNode) override;
     virtual void processChallengeOwnershipRequestPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) override;
     virtual void processChallengeOwnershipReplyPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) override;
     virtual void processChallengeOwnershipPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) override;
@@ -165,6 +183,7 @@ public:
 
     int processEraseMessage(ReceivedMessage& message, const SharedNodePointer& sourceNode);
     int processEraseMessageDetails(const QByteArray& buffer, const SharedNodePointer& sourceNode);
+    int decodeEraseMessageDetails(const QByteArray& buffer, std::vector<EntityItemID>& ids) const;
     bool shouldEraseEntity(EntityItemID entityID, const SharedNodePointer& sourceNode);
 
 
@@ -197,8 +216,23 @@ public:
     virtual bool writeToMap(QVariantMap& entityDescription, OctreeElementPointer element, bool skipDefaultValues,
                             bool skipThoseWithBadParents) override;
     virtual bool readFromMap(QVariantMap& entityDescription, const bool isImport = false) override;
+    virtual bool readFromJSON(const QByteArray& json, const QString& marketplaceID, const bool isImport,
+                              const QUrl& relativeURL) override;
     virtual bool writeToJSON(QString& jsonString, const OctreeElementPointer& element) override;
+    virtual void takeJournalRecords(OctreeJournal::Records& records) override;
+
+    // marks an entity for the next journal flush, does nothing unless the tree is journaled.  Called from every server
+    // side change: edits, adds and deletes, EntityItem::markAsChangedOnServer() and kinematic motion.
+    void journalEntityChange(const EntityItemID& entityID, OctreeJournal::RecordType type);
+    virtual bool writeToBinarySnapshot(QByteArray& data) override;
+    virtual bool readFromBinarySnapshot(const QString& filename, const QUuid& persistID, int64_t dataVersion) override;
+
 
+    // the entities currently in the tree, without taking the tree lock.  a new epoch is made by the first call after
+    // entities were added or deleted, until then every caller shares the same one.
+    EntityTreeEpochPointer getCurrentEpoch() const;
+
+    const EntityBoundsIndexPointer& getBoundsIndex() const { return _boundsIndex; }
 
     glm::vec3 getContentsDimensions();
     float getContentsLargestDimension();
@@ -212,6 +246,7 @@ public:
         _totalUpdateTime = 0;
         _totalCreateTime = 0;
         _totalLoggingTime = 0;
+        _totalFilterTime = 0;
     }
 
     virtual quint64 getAverageDecodeTime() const override { return _totalEditMessages == 0 ? 0 : _totalDecodeTime / _totalEditMessages; }
@@ -220,6 +255,9 @@ public:
     virtual quint64 getAverageCreateTime() const override { return _totalCreates == 0 ? 0 : _totalCreateTime / _totalCreates; }
     virtual quint64 getAverageLoggingTime() const override { return _totalEditMessages == 0 ? 0 : _totalLoggingTime / _totalEditMessages; }
     virtual quint64 getAverageFilterTime() const override { return _totalEditMessages == 0 ? 0 : _totalFilterTime / _totalEditMessages; }
+    int getTotalEditMessages() const { return _totalEditMessages; }
+    int getTotalUpdates() const { return _totalUpdates; }
+    int getTotalCreates() const { return _totalCreates; }
 
     void trackIncomingEntityLastEdited(quint64 lastEditedTime, int bytesRead);
     quint64 getAverageEditDeltas() const
@@ -329,6 +367,13 @@ protected:
 
     mutable QReadWriteLock _entityMapLock;
     QHash<EntityItemID, EntityItemPointer> _entityMap;
+    std::atomic<uint64_t> _entityMapEpoch { 0 };    // changes with the entities in _entityMap
+
+    mutable std::mutex _currentEpochMutex;
+    mutable EntityTreeEpochPointer _currentEpoch;
+
+    // answers the spatial queries, follows the entities in _entityMap
+    EntityBoundsIndexPointer _boundsIndex { std::make_shared<EntityBoundsIndex>() };
 
     mutable QReadWriteLock _entityCertificateIDMapLock;
     QHash<QString, QList<EntityItemID>> _entityCertificateIDMap;
@@ -373,7 +418,10 @@ protected:
 
     float _maxTmpEntityLifetime { DEFAULT_MAX_TMP_ENTITY_LIFETIME };
 
-    bool filterProperties(const EntityItemPointer& existingEntity, EntityItemProperties& propertiesIn, EntityItemProperties& propertiesOut, bool& wasChanged, FilterType filterType) const;
+    bool filterProperties(const EntityItemPointer& existingEntity, EntityItemProperties& propertiesIn,
+        EntityItemProperties& propertiesOut, bool& wasChanged, FilterType filterType, const QUuid& senderID = QUuid()) const;
+    class PreparedEntityEdit;
+    void filterPreparedEdit(PreparedEntityEdit& edit, const SharedNodePointer& senderNode) const;
     bool _hasEntityEditFilter{ false };
     QStringList _entityScriptSourceWhitelist;
 
@@ -383,6 +431,10 @@ protected:
     Q_INVOKABLE void startChallengeOwnershipTimer(const EntityItemID& entityItemID);
 
 private:
+    // applies the conversions for content written by older versions, then adds the entity
+    EntityItemPointer addEntityFromContent(const EntityItemID& entityItemID, EntityItemProperties& properties,
+                                           const QVariantMap& entityMap, int contentVersion, bool isImport);
+
     void addCertifiedEntityOnServer(EntityItemPointer entity);
     void removeCertifiedEntityOnServer(EntityItemPointer entity);
     void sendChallengeOwnershipPacket(const QString& certID, const QString& ownerKey, const EntityItemID& entityItemID, const SharedNodePointer& senderNode);
@@ -403,6 +455,10 @@ private:
 
     std::map<QString, QString> _namedPaths;
 
+    std::mutex _journalMutex;
+    QHash<EntityItemID, OctreeJournal::RecordType> _journalChanges;
+    std::unique_ptr<QScriptEngine> _journalScriptEngine;  // only used by takeJournalRecords, on the persist thread
+
     // Return an AACube containing object and all its entity descendants
     AACube updateEntityQueryAACubeWorker(SpatiallyNestablePointer object, EntityEditPacketSender* packetSender,
                                          MovingEntitiesOperator& moveOperator, bool force, bool tellServer);
@@ -20,9 +20,9 @@ public:
 
     QString getJson() const { return _json; }
 
-private:
     void processEntity(const EntityItemPointer& entity);
 
+private:
     QScriptEngine* _engine;
     QScriptValue _toStringMethod;
 
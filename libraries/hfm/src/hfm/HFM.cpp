@@ -11,6 +11,8 @@
 
 #include "HFM.h"
 
+#include <algorithm>
+
 #include "ModelFormatLogging.h"
 
 void HFMMaterial::getTextureNames(QSet<QString>& textureList) const {
@@ -67,6 +69,74 @@ bool HFMMaterial::needTangentSpace() const {
     return !normalTexture.isNull();
 }
 
+// vertices this close together share a span, with zero offsets in between.
+static const int MAX_SPARSE_BLENDSHAPE_GAP = 8;
+
+void HFMBlendshape::buildSparseOffsets() {
+    sparse = HFMSparseBlendshape();
+    int numIndices = indices.size();
+    if (numIndices == 0) {
+        return;
+    }
+
+    std::vector<int> order(numIndices);
+    for (int i = 0; i < numIndices; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return indices[a] < indices[b]; });
+
+    // group sorted indices into spans
+    for (int i : order) {
+        int index = indices[i];
+        if (index < 0) {
+            continue;
+        }
+        if (!sparse.spans.empty()) {
+            auto& span = sparse.spans.back();
+            int end = span.start + span.count;
+            if (index < end) {
+                continue;   // duplicate index, accumulated below
+            }
+            if (index - end <= MAX_SPARSE_BLENDSHAPE_GAP) {
+                span.count = index - span.start + 1;
+                continue;
+            }
+        }
+        int offset = sparse.spans.empty() ? 0 : sparse.spans.back().offset + sparse.spans.back().count;
+        sparse.spans.push_back({ index, 1, offset });
+    }
+    if (sparse.spans.empty()) {
+        return;
+    }
+    sparse.numOffsets = sparse.spans.back().offset + sparse.spans.back().count;
+    sparse.data.assign(HFMSparseBlendshape::NumStreams * sparse.numOffsets, 0.0f);
+
+    // scatter the offsets, duplicate indices are summed the same way Blender would have accumulated them
+    size_t spanIndex = 0;
+    for (int i : order) {
+        int index = indices[i];
+        if (index < 0) {
+            continue;
+        }
+        while (index >= sparse.spans[spanIndex].start + sparse.spans[spanIndex].count) {
+            spanIndex++;
+        }
+        const auto& span = sparse.spans[spanIndex];
+        int offset = span.offset + (index - span.start);
+        float* data = sparse.data.data() + offset;
+        int stride = sparse.numOffsets;
+        const glm::vec3 zero(0.0f);
+        const glm::vec3& vertex = i < vertices.size() ? vertices[i] : zero;
+        const glm::vec3& normal = i < normals.size() ? normals[i] : zero;
+        const glm::vec3& tangent = i < tangents.size() ? tangents[i] : zero;
+        for (int c = 0; c < 3; c++) {
+            data[(HFMSparseBlendshape::PositionX + c) * stride] += vertex[c];
+            data[(HFMSparseBlendshape::NormalX + c) * stride] += normal[c];
+            data[(HFMSparseBlendshape::TangentX + c) * stride] += tangent[c];
+        }
+    }
+}
+
 QStringList HFMModel::getJointNames() const {
     QStringList names;
     foreach (const HFMJoint& joint, joints) {
@@ -16,6 +16,8 @@
 #include <QSet>
 #include <QVector>
 
+#include <vector>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
@@ -66,6 +68,38 @@ static const int DRACO_ATTRIBUTE_ORIGINAL_INDEX = DRACO_BEGIN_CUSTOM_HIFI_ATTRIB
 // High Fidelity Model namespace
 namespace hfm {
 
+/// Sparse, structure-of-arrays copy of a blendshape's offsets, so that blendshapes can be accumulated with SIMD.
+/// Offsets are grouped into spans of consecutive vertex indices, small gaps between touched vertices are filled with zeros.
+class SparseBlendshape {
+public:
+    // same order as the components of BlendshapeOffsetUnpacked
+    enum Stream {
+        PositionX = 0,
+        PositionY,
+        PositionZ,
+        NormalX,
+        NormalY,
+        NormalZ,
+        TangentX,
+        TangentY,
+        TangentZ,
+        NumStreams
+    };
+
+    struct Span {
+        int start;      // index of the first vertex
+        int count;      // number of vertices
+        int offset;     // position of the first vertex within each stream
+    };
+
+    std::vector<Span> spans;    // sorted by start, non overlapping
+    std::vector<float> data;    // NumStreams streams of numOffsets floats
+    int numOffsets { 0 };
+
+    bool isEmpty() const { return spans.empty(); }
+    const float* getStream(int stream) const { return data.data() + stream * numOffsets; }
+};
+
 /// A single blendshape.
 class Blendshape {
 public:
@@ -73,6 +107,11 @@ public:
     QVector<glm::vec3> vertices;
     QVector<glm::vec3> normals;
     QVector<glm::vec3> tangents;
+
+    SparseBlendshape sparse;
+
+    /// Builds sparse from the offsets above, call once they are final.
+    void buildSparseOffsets();
 };
 
 struct JointShapeInfo {
@@ -356,6 +395,7 @@ public:
 };
 
 typedef hfm::Blendshape HFMBlendshape;
+typedef hfm::SparseBlendshape HFMSparseBlendshape;
 typedef hfm::JointShapeInfo HFMJointShapeInfo;
 typedef hfm::Joint HFMJoint;
 typedef hfm::Cluster HFMCluster;
@@ -13,12 +13,10 @@
 
 #include <mutex>
 
-#include <QtConcurrent/QtConcurrentRun>
-
 #include <QCryptographicHash>
 #include <QImageReader>
 #include <QRunnable>
-#include <QThreadPool>
+#include <QThread>
 #include <QNetworkReply>
 #include <QPainter>
 #include <QUrlQuery>
@@ -490,6 +488,7 @@ public:
     ImageReader(const QWeakPointer<Resource>& resource, const QUrl& url,
                 const QByteArray& data, size_t extraHash, int maxNumPixels,
                 image::ColorChannel sourceChannel);
+    ~ImageReader();
     void run() override final;
     void read();
 
@@ -502,9 +501,14 @@ private:
     size_t _extraHash;
     int _maxNumPixels;
     image::ColorChannel _sourceChannel;
+    bool _started { false };
 };
 
 NetworkTexture::~NetworkTexture() {
+    if (_imageReaderJob) {
+        _imageReaderJob->cancel();
+        _imageReaderJob.reset();
+    }
     if (_ktxHeaderRequest || _ktxMipRequest) {
         if (_ktxHeaderRequest) {
             _ktxHeaderRequest->disconnect(this);
@@ -529,7 +533,7 @@ void NetworkTexture::makeRequest() {
 
     if (isLocalUrl(_activeUrl)) {
         auto self = _self;
-        QtConcurrent::run(QThreadPool::globalInstance(), [self] {
+        JobScheduler::getInstance().submit(JobScheduler::Category::Texture, [self] {
             auto resource = self.lock();
             if (!resource) {
                 return;
@@ -828,7 +832,7 @@ void NetworkTexture::ktxMipRequestFinished() {
             auto mipLevel = _ktxMipLevelRangeInFlight.first;
             auto texture = _textureSource->getGPUTexture();
             DependencyManager::get<StatTracker>()->incrementStat("PendingProcessing");
-            QtConcurrent::run(QThreadPool::globalInstance(), [self, data, mipLevel, url, texture] {
+            JobScheduler::getInstance().submit(JobScheduler::Category::Texture, [self, data, mipLevel, url, texture] {
                 PROFILE_RANGE_EX(resource_parse_image, "NetworkTexture - Processing Mip Data", 0xffff0000, 0, { { "url", url.toString() } });
                 DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
                 CounterStat counter("Processing");
@@ -896,7 +900,7 @@ void NetworkTexture::handleFinishedInitialLoad() {
     auto self = _self;
     auto url = _url;
     DependencyManager::get<StatTracker>()->incrementStat("PendingProcessing");
-    QtConcurrent::run(QThreadPool::globalInstance(), [self, ktxHeaderData, ktxHighMipData, url] {
+    JobScheduler::getInstance().submit(JobScheduler::Category::Texture, [self, ktxHeaderData, ktxHighMipData, url] {
         PROFILE_RANGE_EX(resource_parse_image, "NetworkTexture - Processing Initial Data", 0xffff0000, 0, { { "url", url.toString() } });
         DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
         CounterStat counter("Processing");
@@ -1131,7 +1135,8 @@ void NetworkTexture::loadTextureContent(const QByteArray& content) {
         return;
     }
 
-    QThreadPool::globalInstance()->start(new ImageReader(_self, _url, content, _extraHash, _maxNumPixels, _sourceChannel));
+    _imageReaderJob = JobScheduler::getInstance().submit(JobScheduler::Category::Texture,
+        new ImageReader(_self, _url, content, _extraHash, _maxNumPixels, _sourceChannel));
 }
 
 void NetworkTexture::refresh() {
@@ -1187,6 +1192,13 @@ ImageReader::ImageReader(const QWeakPointer<Resource>& resource, const QUrl& url
 #endif
 }
 
+ImageReader::~ImageReader() {
+    if (!_started) {
+        // cancelled before it got to run
+        DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
+    }
+}
+
 void ImageReader::listSupportedImageFormats() {
     static std::once_flag once;
     std::call_once(once, []{
@@ -1197,6 +1209,7 @@ void ImageReader::listSupportedImageFormats() {
 
 void ImageReader::run() {
     PROFILE_RANGE_EX(resource_parse_image, __FUNCTION__, 0xffff0000, 0, { { "url", _url.toString() } });
+    _started = true;
     DependencyManager::get<StatTracker>()->decrementStat("PendingProcessing");
     CounterStat counter("Processing");
 
@@ -20,6 +20,7 @@
 #include <QMetaEnum>
 
 #include <DependencyManager.h>
+#include <JobScheduler.h>
 #include <ResourceCache.h>
 #include <graphics/TextureMap.h>
 #include <image/ColorChannel.h>
@@ -143,6 +144,9 @@ private:
     int _maxNumPixels { ABSOLUTE_MAX_TEXTURE_NUM_PIXELS };
     QByteArray _content;
 
+    // the pending image decode, cancelled if this texture goes away before it starts
+    JobScheduler::JobPointer _imageReaderJob;
+
     friend class TextureCache;
 };
 
@@ -94,6 +94,9 @@ namespace baker {
                 meshOut.normals = QVector<glm::vec3>::fromStdVector(safeGet(normalsPerMeshIn, i));
                 meshOut.tangents = QVector<glm::vec3>::fromStdVector(safeGet(tangentsPerMeshIn, i));
                 meshOut.blendshapes = QVector<hfm::Blendshape>::fromStdVector(safeGet(blendshapesPerMeshIn, i));
+                for (auto& blendshape : meshOut.blendshapes) {
+                    blendshape.buildSparseOffsets();
+                }
             }
             output = meshesOut;
         }
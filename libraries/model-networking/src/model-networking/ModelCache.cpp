@@ -16,7 +16,7 @@
 #include <gpu/Batch.h>
 #include <gpu/Stream.h>
 
-#include <QThreadPool>
+#include <JobScheduler.h>
 
 #include <Gzip.h>
 
@@ -271,6 +271,8 @@ void GeometryResource::downloadFinished(const QByteArray& data) {
             _geometryResource = modelCache->getResource(url, QUrl(), &extra, std::hash<GeometryExtra>()(extra)).staticCast<GeometryResource>();
             // Avoid caching nested resources - their references will be held by the parent
             _geometryResource->_isCacheable = false;
+            // so that the model is parsed with the priority of whoever is waiting for the mapping
+            _geometryResource->setLoadPriorities(_loadPriorities);
 
             if (_geometryResource->isLoaded()) {
                 onGeometryMappingLoaded(!_geometryResource->getURL().isEmpty());
@@ -287,7 +289,8 @@ void GeometryResource::downloadFinished(const QByteArray& data) {
             _url = _effectiveBaseURL;
             _textureBaseURL = _effectiveBaseURL;
         }
-        QThreadPool::globalInstance()->start(new GeometryReader(_modelLoader, _self, _effectiveBaseURL, _mappingPair, data, _combineParts, _request->getWebMediaType()));
+        auto priority = JobScheduler::getLoadingPriority(JobScheduler::Category::Model, getLoadPriority());
+        JobScheduler::getInstance().submit(JobScheduler::Category::Model, priority, new GeometryReader(_modelLoader, _self, _effectiveBaseURL, _mappingPair, data, _combineParts, _request->getWebMediaType()));
     }
 }
 
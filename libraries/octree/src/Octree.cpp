@@ -68,6 +68,53 @@ Octree::~Octree() {
     eraseAllOctreeElements(false);
 }
 
+void Octree::lockForWrite() const {
+    _writeLockWaits.addLock();
+    if (!getLock().tryLockForWrite()) {
+        quint64 start = usecTimestampNow();
+        getLock().lockForWrite();
+        _writeLockWaits.addWait(usecTimestampNow() - start);
+    }
+}
+
+void Octree::lockForRead() const {
+    _readLockWaits.addLock();
+    if (!getLock().tryLockForRead()) {
+        quint64 start = usecTimestampNow();
+        getLock().lockForRead();
+        _readLockWaits.addWait(usecTimestampNow() - start);
+    }
+}
+
+void Octree::resetLockWaitStats() {
+    _writeLockWaits.reset();
+    _readLockWaits.reset();
+}
+
+void Octree::LockWaitCounter::addWait(quint64 waitUsecs) {
+    _numWaits++;
+    _totalWaitUsecs += waitUsecs;
+    quint64 maxWaitUsecs = _maxWaitUsecs;
+    while (waitUsecs > maxWaitUsecs && !_maxWaitUsecs.compare_exchange_weak(maxWaitUsecs, waitUsecs)) {
+    }
+}
+
+Octree::LockWaitStats Octree::LockWaitCounter::getStats() const {
+    LockWaitStats stats;
+    stats.numLocks = _numLocks;
+    stats.numWaits = _numWaits;
+    stats.totalWaitUsecs = _totalWaitUsecs;
+    stats.maxWaitUsecs = _maxWaitUsecs;
+    return stats;
+}
+
+void Octree::LockWaitCounter::reset() {
+    _numLocks = 0;
+    _numWaits = 0;
+    _totalWaitUsecs = 0;
+    _maxWaitUsecs = 0;
+}
+
 // Recurses voxel tree calling the RecurseOctreeOperation function for each element.
 // stops recursion if operation function returns false.
 void Octree::recurseTreeWithOperation(const RecurseOctreeOperation& operation, void* extraData) {
@@ -865,10 +912,15 @@ bool Octree::readJSONFromStream(
         }
         jsonBuffer += QByteArray(rawData, got);
     }
+    delete[] rawData;
+
+    return readFromJSON(jsonBuffer, marketplaceID, isImport, relativeURL);
+}
 
+bool Octree::readFromJSON(const QByteArray& json, const QString& marketplaceID, const bool isImport, const QUrl& relativeURL) {
     OctreeEntitiesFileParser octreeParser;
     octreeParser.setRelativeURL(relativeURL);
-    octreeParser.setEntitiesString(jsonBuffer);
+    octreeParser.setEntitiesString(json);
 
     QVariantMap asMap;
     if (!octreeParser.parseEntities(asMap)) {
@@ -880,9 +932,7 @@ bool Octree::readJSONFromStream(
         addMarketplaceIDToDocumentEntities(asMap, marketplaceID);
     }
 
-    bool success = readFromMap(asMap, isImport);
-    delete[] rawData;
-    return success;
+    return readFromMap(asMap, isImport);
 }
 
 bool Octree::writeToFile(const char* fileName, const OctreeElementPointer& element, QString persistAsFileType) {
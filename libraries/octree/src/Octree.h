@@ -12,6 +12,7 @@
 #ifndef hifi_Octree_h
 #define hifi_Octree_h
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <stdint.h>
@@ -26,6 +27,7 @@
 
 #include "OctreeElement.h"
 #include "OctreeElementBag.h"
+#include "OctreeJournal.h"
 #include "OctreePacketData.h"
 #include "OctreeSceneStats.h"
 #include "OctreeUtils.h"
@@ -128,6 +130,34 @@ public:
     Octree(bool shouldReaverage = false);
     virtual ~Octree();
 
+    // The tree lock.  These hide the ones of ReadWriteLockable so that the time spent waiting for it is counted, the
+    // clock is only read when the lock can't be taken straight away.
+    template <typename F>
+    void withWriteLock(F&& f) const;
+    template <typename F>
+    bool withWriteLock(F&& f, bool require) const;
+    template <typename T, typename F>
+    T resultWithWriteLock(F&& f) const;
+
+    template <typename F>
+    void withReadLock(F&& f) const;
+    template <typename F>
+    bool withReadLock(F&& f, bool require) const;
+    template <typename T, typename F>
+    T resultWithReadLock(F&& f) const;
+
+    struct LockWaitStats {
+        quint64 numLocks { 0 };
+        quint64 numWaits { 0 };         // the locks that couldn't be taken straight away
+        quint64 totalWaitUsecs { 0 };
+        quint64 maxWaitUsecs { 0 };
+
+        quint64 getAverageWaitUsecs() const { return numWaits == 0 ? 0 : totalWaitUsecs / numWaits; }
+    };
+    LockWaitStats getReadLockWaitStats() const { return _readLockWaits.getStats(); }
+    LockWaitStats getWriteLockWaitStats() const { return _writeLockWaits.getStats(); }
+    void resetLockWaitStats();
+
     /// Your tree class must implement this to create the correct element type
     virtual OctreeElementPointer createNewElement(unsigned char * octalCode = NULL) = 0;
 
@@ -138,6 +168,23 @@ public:
     virtual bool handlesEditPacketType(PacketType packetType) const { return false; }
     virtual int processEditPacketData(ReceivedMessage& message, const unsigned char* editData, int maxLength,
                                       const SharedNodePointer& sourceNode) { return 0; }
+
+    // Trees that return true from canPrepareEdits() split the processing of an edit in two, so that the server can
+    // decode and validate a batch of edits on several threads and then apply all of them under a single write lock:
+    // prepareEditPacketData() only needs the read lock and may be called from any thread, it returns null if the edit
+    // can't be read.  applyPreparedEdit() must be called with the write lock, in the order the edits were received.
+    class PreparedEdit {
+    public:
+        virtual ~PreparedEdit() {}
+        int bytesRead { 0 };
+    };
+    using PreparedEditPointer = std::unique_ptr<PreparedEdit>;
+
+    virtual bool canPrepareEdits() const { return false; }
+    virtual PreparedEditPointer prepareEditPacketData(ReceivedMessage& message, const unsigned char* editData, int maxLength,
+                                                      const SharedNodePointer& sourceNode) { return nullptr; }
+    virtual void applyPreparedEdit(ReceivedMessage& message, PreparedEdit& edit, const SharedNodePointer& sourceNode) { }
+
     virtual void processChallengeOwnershipRequestPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) { return; }
     virtual void processChallengeOwnershipReplyPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) { return; }
     virtual void processChallengeOwnershipPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) { return; }
@@ -222,6 +269,8 @@ public:
     bool readJSONFromStream(uint64_t streamLength, QDataStream& inputStream, const QString& marketplaceID="", const bool isImport = false, const QUrl& urlString = QUrl());
     bool readJSONFromGzippedFile(QString qFileName);
     virtual bool readFromMap(QVariantMap& entityDescription, const bool isImport = false) = 0;
+    // reads the json text of an export, the default parses it into a map for readFromMap
+    virtual bool readFromJSON(const QByteArray& json, const QString& marketplaceID, const bool isImport, const QUrl& relativeURL);
 
     uint64_t getOctreeElementsCount();
 
@@ -250,6 +299,19 @@ public:
         _persistID = id;
         _persistDataVersion = dataVersion;
     }
+    const QUuid& getPersistID() const { return _persistID; }
+
+    // when enabled the tree keeps track of what changed, for the OctreePersistThread to journal
+    void setJournalEnabled(bool enabled) { _journalEnabled = enabled; }
+    bool isJournalEnabled() const { return _journalEnabled; }
+
+    // moves the changes tracked since the last call into records, doesn't need the tree lock
+    virtual void takeJournalRecords(OctreeJournal::Records& records) { }
+
+    // binary snapshot of the whole tree, which loads faster than the json persist file.  writing doesn't need the tree
+    // lock, reading assumes it is write locked, and only succeeds if the snapshot has the given persist id and data version.
+    virtual bool writeToBinarySnapshot(QByteArray& data) { return false; }
+    virtual bool readFromBinarySnapshot(const QString& filename, const QUuid& persistID, int64_t dataVersion) { return false; }
 
     virtual void resetEditStats() { }
     virtual quint64 getAverageDecodeTime() const { return 0; }
@@ -276,12 +338,95 @@ protected:
 
     QUuid _persistID { QUuid::createUuid() };
     int _persistDataVersion { 0 };
+    std::atomic<bool> _journalEnabled { false };
 
     bool _isDirty;
     bool _shouldReaverage;
 
     bool _isViewing;
     bool _isServer;
+
+private:
+    class LockWaitCounter {
+    public:
+        void addLock() { _numLocks++; }
+        void addWait(quint64 waitUsecs);
+        LockWaitStats getStats() const;
+        void reset();
+
+    private:
+        std::atomic<quint64> _numLocks { 0 };
+        std::atomic<quint64> _numWaits { 0 };
+        std::atomic<quint64> _totalWaitUsecs { 0 };
+        std::atomic<quint64> _maxWaitUsecs { 0 };
+    };
+
+    class LockReleaser {
+    public:
+        LockReleaser(QReadWriteLock& lock) : _lock(lock) { }
+        ~LockReleaser() { _lock.unlock(); }
+
+    private:
+        QReadWriteLock& _lock;
+    };
+
+    void lockForWrite() const;
+    void lockForRead() const;
+
+    mutable LockWaitCounter _writeLockWaits;
+    mutable LockWaitCounter _readLockWaits;
 };
 
+template <typename F>
+inline void Octree::withWriteLock(F&& f) const {
+    lockForWrite();
+    LockReleaser releaser(getLock());
+    f();
+}
+
+template <typename F>
+inline bool Octree::withWriteLock(F&& f, bool require) const {
+    if (require) {
+        withWriteLock(std::forward<F>(f));
+        return true;
+    } else {
+        return withTryWriteLock(std::forward<F>(f));
+    }
+}
+
+template <typename T, typename F>
+inline T Octree::resultWithWriteLock(F&& f) const {
+    T result;
+    withWriteLock([&] {
+        result = f();
+    });
+    return result;
+}
+
+template <typename F>
+inline void Octree::withReadLock(F&& f) const {
+    lockForRead();
+    LockReleaser releaser(getLock());
+    f();
+}
+
+template <typename F>
+inline bool Octree::withReadLock(F&& f, bool require) const {
+    if (require) {
+        withReadLock(std::forward<F>(f));
+        return true;
+    } else {
+        return withTryReadLock(std::forward<F>(f));
+    }
+}
+
+template <typename T, typename F>
+inline T Octree::resultWithReadLock(F&& f) const {
+    T result;
+    withReadLock([&] {
+        result = f();
+    });
+    return result;
+}
+
 #endif // hifi_Octree_h
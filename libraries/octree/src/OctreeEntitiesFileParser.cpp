@@ -242,88 +242,7 @@ bool OctreeEntitiesFileParser::readEntitiesArray(QVariantList& entitiesArray) {
 
         // resolve urls starting with ./ or ../ 
         if (!_relativeURL.isEmpty()) {
-            bool isDirty = false;
-
-            const QStringList urlKeys { 
-                // model
-                "modelURL",
-                "animation.url",
-                "textures",
-                // image
-                "imageURL",
-                // web
-                "sourceUrl",
-                "scriptURL",
-                // zone
-                "ambientLight.ambientURL",
-                "skybox.url",
-                // particles
-                //"textures",  Already specified for model entity type.
-                // materials
-                "materialURL",
-                // ...shared
-                "href",
-                "script",
-                "serverScripts",
-                "collisionSoundURL",
-                "compoundShapeURL",
-                // TODO: deal with materialData and userData
-            };
-
-            for (const QString& key : urlKeys) {
-                if (key.contains('.')) {
-                    // url is inside another object
-                    const QStringList keyPair = key.split('.');
-                    const QString entityKey = keyPair[0];
-                    const QString childKey = keyPair[1];
-
-                    if (entityObject.contains(entityKey) && entityObject[entityKey].isObject()) {
-                        QJsonObject childObject = entityObject[entityKey].toObject();
-
-                        if (childObject.contains(childKey) && childObject[childKey].isString()) {
-                            const QString url = childObject[childKey].toString();
-
-                            if (url.startsWith("./") || url.startsWith("../")) {
-                                childObject[childKey] = _relativeURL.resolved(url).toString();
-                                entityObject[entityKey] = childObject;
-                                isDirty = true;
-                            }
-                        }
-                    }
-                } else {
-                    if (entityObject.contains(key) && entityObject[key].isString()) {
-                        const QString value = entityObject[key].toString();
-
-                        if (value.startsWith("./") || value.startsWith("../")) {
-                            // URL value.
-                            entityObject[key] = _relativeURL.resolved(value).toString();
-                            isDirty = true;
-                        } else if (value.startsWith("{")) {
-                            // Object with URL values.
-                            auto document = QJsonDocument::fromJson(value.toUtf8());
-                            if (!document.isNull()) {
-                                auto object = document.object();
-                                bool isObjectUpdated = false;
-                                for (const QString& key : object.keys()) {
-                                    auto value = object[key].toString();
-                                    if (value.startsWith("./") || value.startsWith("../")) {
-                                        object[key] = _relativeURL.resolved(value).toString();
-                                        isObjectUpdated = true;
-                                    }
-                                }
-                                if (isObjectUpdated) {
-                                    entityObject[key] = QString(QJsonDocument(object).toJson());
-                                    isDirty = true;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-
-            if (isDirty) {
-                entity.setObject(entityObject);
-            }
+            resolveRelativeURLs(entityObject, _relativeURL);
         }
 
         entitiesArray.append(entityObject);
@@ -339,6 +258,89 @@ bool OctreeEntitiesFileParser::readEntitiesArray(QVariantList& entitiesArray) {
     return true;
 }
 
+bool OctreeEntitiesFileParser::resolveRelativeURLs(QJsonObject& entityObject, const QUrl& relativeURL) {
+    bool isDirty = false;
+
+    const QStringList urlKeys { 
+        // model
+        "modelURL",
+        "animation.url",
+        "textures",
+        // image
+        "imageURL",
+        // web
+        "sourceUrl",
+        "scriptURL",
+        // zone
+        "ambientLight.ambientURL",
+        "skybox.url",
+        // particles
+        //"textures",  Already specified for model entity type.
+        // materials
+        "materialURL",
+        // ...shared
+        "href",
+        "script",
+        "serverScripts",
+        "collisionSoundURL",
+        "compoundShapeURL",
+        // TODO: deal with materialData and userData
+    };
+
+    for (const QString& key : urlKeys) {
+        if (key.contains('.')) {
+            // url is inside another object
+            const QStringList keyPair = key.split('.');
+            const QString entityKey = keyPair[0];
+            const QString childKey = keyPair[1];
+
+            if (entityObject.contains(entityKey) && entityObject[entityKey].isObject()) {
+                QJsonObject childObject = entityObject[entityKey].toObject();
+
+                if (childObject.contains(childKey) && childObject[childKey].isString()) {
+                    const QString url = childObject[childKey].toString();
+
+                    if (url.startsWith("./") || url.startsWith("../")) {
+                        childObject[childKey] = relativeURL.resolved(url).toString();
+                        entityObject[entityKey] = childObject;
+                        isDirty = true;
+                    }
+                }
+            }
+        } else {
+            if (entityObject.contains(key) && entityObject[key].isString()) {
+                const QString value = entityObject[key].toString();
+
+                if (value.startsWith("./") || value.startsWith("../")) {
+                    // URL value.
+                    entityObject[key] = relativeURL.resolved(value).toString();
+                    isDirty = true;
+                } else if (value.startsWith("{")) {
+                    // Object with URL values.
+                    auto document = QJsonDocument::fromJson(value.toUtf8());
+                    if (!document.isNull()) {
+                        auto object = document.object();
+                        bool isObjectUpdated = false;
+                        for (const QString& key : object.keys()) {
+                            auto value = object[key].toString();
+                            if (value.startsWith("./") || value.startsWith("../")) {
+                                object[key] = relativeURL.resolved(value).toString();
+                                isObjectUpdated = true;
+                            }
+                        }
+                        if (isObjectUpdated) {
+                            entityObject[key] = QString(QJsonDocument(object).toJson());
+                            isDirty = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return isDirty;
+}
+
 int OctreeEntitiesFileParser::findMatchingBrace() const {
     int index = _position;
     int nestCount = 1;
@@ -15,6 +15,7 @@
 #define hifi_OctreeEntitiesFileParser_h
 
 #include <QByteArray>
+#include <QJsonObject>
 #include <QUrl>
 #include <QVariant>
 
@@ -25,6 +26,9 @@ public:
     bool parseEntities(QVariantMap& parsedEntities);
     std::string getErrorString() const;
 
+    // resolves the urls of an entity that start with ./ or ../ against relativeURL, returns whether any were changed
+    static bool resolveRelativeURLs(QJsonObject& entityObject, const QUrl& relativeURL);
+
 private:
     int nextToken();
     std::string readString();
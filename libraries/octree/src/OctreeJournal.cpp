@@ -0,0 +1,250 @@
+//
+//  OctreeJournal.cpp
+//  libraries/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreeJournal.h"
+
+#include <algorithm>
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "OctreeLogging.h"
+
+static const quint32 JOURNAL_MAGIC = 0x4f4a524e; // "OJRN"
+static const quint16 JOURNAL_FORMAT_VERSION = 1;
+static const QString SEGMENT_EXTENSION = ".journal.";
+
+static const int NUM_BYTES_RFC4122_UUID = 16;
+static const int SEGMENT_HEADER_SIZE = sizeof(quint32) + sizeof(quint16) + sizeof(quint8) + NUM_BYTES_RFC4122_UUID;
+
+// guards against reading a garbage size from a torn write as a huge allocation
+static const quint32 MAX_RECORD_SIZE = 64 * 1024 * 1024;
+
+OctreeJournal::OctreeJournal(const QString& persistFilename) :
+    _persistFilename(persistFilename)
+{
+}
+
+OctreeJournal::~OctreeJournal() {
+    close();
+}
+
+QString OctreeJournal::getSegmentFilename(int segment) const {
+    return _persistFilename + SEGMENT_EXTENSION + QString::number(segment);
+}
+
+std::vector<int> OctreeJournal::findSegments() const {
+    QFileInfo persistFile(_persistFilename);
+    QString prefix = persistFile.fileName() + SEGMENT_EXTENSION;
+    QDir dir(persistFile.absolutePath());
+
+    std::vector<int> segments;
+    for (const auto& name : dir.entryList({ prefix + "*" }, QDir::Files)) {
+        bool ok;
+        int segment = name.mid(prefix.length()).toInt(&ok);
+        if (ok && segment >= 0) {
+            segments.push_back(segment);
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+bool OctreeJournal::open(const QUuid& treeID, PacketVersion version) {
+    close();
+    _treeID = treeID;
+    _version = version;
+
+    auto segments = findSegments();
+    return openSegment(segments.empty() ? 0 : segments.back() + 1);
+}
+
+void OctreeJournal::close() {
+    if (_segmentFile) {
+        _segmentFile->close();
+        _segmentFile.reset();
+    }
+}
+
+bool OctreeJournal::openSegment(int segment) {
+    close();
+    _currentSegment = segment;
+
+    auto file = std::unique_ptr<QFile>(new QFile(getSegmentFilename(segment)));
+    if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(octree) << "Failed to open journal segment" << file->fileName() << file->errorString();
+        return false;
+    }
+
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream << JOURNAL_MAGIC << JOURNAL_FORMAT_VERSION << (quint8)_version;
+    header.append(_treeID.toRfc4122());
+    if (file->write(header) != header.size()) {
+        qCWarning(octree) << "Failed to write journal segment header" << file->fileName() << file->errorString();
+        return false;
+    }
+
+    _segmentFile = std::move(file);
+    return sync();
+}
+
+bool OctreeJournal::sync() {
+    if (!_segmentFile->flush()) {
+        return false;
+    }
+    _numSyncs++;
+#ifdef Q_OS_WIN
+    return _commit(_segmentFile->handle()) == 0;
+#else
+    return fsync(_segmentFile->handle()) == 0;
+#endif
+}
+
+bool OctreeJournal::append(const Records& records) {
+    if (!_segmentFile || records.empty()) {
+        return records.empty();
+    }
+
+    QByteArray batch;
+    for (const auto& record : records) {
+        QByteArray body;
+        body.reserve(sizeof(quint8) + NUM_BYTES_RFC4122_UUID + record.payload.size());
+        body.append((char)record.type);
+        body.append(record.id.toRfc4122());
+        body.append(record.payload);
+
+        QDataStream stream(&batch, QIODevice::WriteOnly | QIODevice::Append);
+        stream << (quint32)body.size() << qChecksum(body.constData(), body.size());
+        batch.append(body);
+    }
+
+    if (_segmentFile->write(batch) != batch.size() || !sync()) {
+        qCWarning(octree) << "Failed to append to journal segment" << _segmentFile->fileName() << _segmentFile->errorString();
+        return false;
+    }
+    _numRecordsWritten += records.size();
+    _numBytesWritten += batch.size();
+    return true;
+}
+
+int OctreeJournal::rotate() {
+    openSegment(_currentSegment + 1);
+    return _currentSegment;
+}
+
+void OctreeJournal::removeSegmentsBefore(int segment) {
+    for (int existing : findSegments()) {
+        if (existing < segment) {
+            QFile::remove(getSegmentFilename(existing));
+        }
+    }
+}
+
+void OctreeJournal::removeAllSegments() {
+    bool wasOpen = isOpen();
+    close();
+    for (int existing : findSegments()) {
+        QFile::remove(getSegmentFilename(existing));
+    }
+    if (wasOpen) {
+        openSegment(0);
+    }
+}
+
+bool OctreeJournal::hasRecords(const QUuid& treeID) const {
+    for (int segment : findSegments()) {
+        if (_segmentFile && segment == _currentSegment) {
+            continue;
+        }
+        QFile file(getSegmentFilename(segment));
+        if (file.size() <= SEGMENT_HEADER_SIZE || !file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QByteArray header = file.read(SEGMENT_HEADER_SIZE);
+        if (header.size() == SEGMENT_HEADER_SIZE &&
+            QUuid::fromRfc4122(header.right(NUM_BYTES_RFC4122_UUID)) == treeID) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int OctreeJournal::replay(const QUuid& treeID, const ReplayOperator& replayOperator) const {
+    int numRecords = 0;
+    for (int segment : findSegments()) {
+        if (_segmentFile && segment == _currentSegment) {
+            continue;
+        }
+
+        QFile file(getSegmentFilename(segment));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCWarning(octree) << "Failed to open journal segment" << file.fileName() << file.errorString();
+            continue;
+        }
+        QByteArray data = file.readAll();
+
+        QDataStream stream(data);
+        quint32 magic;
+        quint16 formatVersion;
+        quint8 version;
+        stream >> magic >> formatVersion >> version;
+        QByteArray id(NUM_BYTES_RFC4122_UUID, 0);
+        if (stream.readRawData(id.data(), id.size()) != id.size() || magic != JOURNAL_MAGIC ||
+            formatVersion != JOURNAL_FORMAT_VERSION) {
+            qCWarning(octree) << "Skipping invalid journal segment" << file.fileName();
+            continue;
+        }
+        if (QUuid::fromRfc4122(id) != treeID) {
+            qCDebug(octree) << "Skipping journal segment" << file.fileName() << "written for other octree data";
+            continue;
+        }
+
+        // each record is its size and checksum, followed by the type, the id and the payload
+        Records records;
+        qint64 validSize = stream.device()->pos();
+        while (!stream.atEnd()) {
+            quint32 size;
+            quint16 checksum;
+            stream >> size >> checksum;
+            if (stream.status() != QDataStream::Ok || size < sizeof(quint8) + NUM_BYTES_RFC4122_UUID || size > MAX_RECORD_SIZE) {
+                break;
+            }
+            QByteArray body(size, 0);
+            if (stream.readRawData(body.data(), size) != (int)size || qChecksum(body.constData(), size) != checksum) {
+                break;
+            }
+            quint8 type = (quint8)body[0];
+            if (type > (quint8)RecordType::Delete) {
+                break;
+            }
+            records.push_back({ (RecordType)type, QUuid::fromRfc4122(body.mid(1, NUM_BYTES_RFC4122_UUID)),
+                                body.mid(1 + NUM_BYTES_RFC4122_UUID) });
+            validSize = stream.device()->pos();
+        }
+
+        if (validSize < data.size()) {
+            qCWarning(octree) << "Journal segment" << file.fileName() << "ends with" << (data.size() - validSize)
+                              << "bytes of incomplete records";
+        }
+
+        numRecords += (int)records.size();
+        replayOperator(version, records);
+    }
+    return numRecords;
+}
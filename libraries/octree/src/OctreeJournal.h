@@ -0,0 +1,99 @@
+//
+//  OctreeJournal.h
+//  libraries/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeJournal_h
+#define hifi_OctreeJournal_h
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QUuid>
+
+#include <udt/PacketHeaders.h>
+
+class QFile;
+
+// Append-only log of the changes made to a persisted octree since it was last written out in full.
+// Each change is one record holding the complete new state of an element (or its deletion), so replaying a
+// record more than once, or on top of a persist file that already contains it, gives the same result.
+//
+// The journal is split in numbered segments next to the persist file (<persist file>.journal.<n>).  Compacting the
+// journal into a new persist file starts a new segment first; once that persist file is safely written, the
+// segments before it can be removed.  Records are written in batches with a single sync per batch, and replay of a
+// segment stops at a record that was cut short by a crash.
+//
+// Not thread safe, owned by the OctreePersistThread.
+class OctreeJournal {
+public:
+    enum class RecordType : uint8_t {
+        Add = 0,
+        Edit,
+        Delete
+    };
+
+    struct Record {
+        RecordType type;
+        QUuid id;
+        QByteArray payload;     // empty for deletes
+    };
+    using Records = std::vector<Record>;
+
+    using ReplayOperator = std::function<void(PacketVersion version, const Records& records)>;
+
+    OctreeJournal(const QString& persistFilename);
+    ~OctreeJournal();
+
+    // starts a new segment after any existing ones, for the octree with the given persist ID.
+    bool open(const QUuid& treeID, PacketVersion version);
+    void close();
+    bool isOpen() const { return _segmentFile != nullptr; }
+
+    // writes the records and syncs them to disk before returning.
+    bool append(const Records& records);
+
+    // starts a new segment and returns its number, everything appended before it belongs to older segments.
+    int rotate();
+
+    void removeSegmentsBefore(int segment);
+    void removeAllSegments();
+
+    // reads every segment written for treeID, oldest first, and passes its records to the operator.
+    // returns the number of records read.
+    int replay(const QUuid& treeID, const ReplayOperator& replayOperator) const;
+
+    // whether there are any records written for treeID to replay
+    bool hasRecords(const QUuid& treeID) const;
+
+    int getCurrentSegment() const { return _currentSegment; }
+    quint64 getNumRecordsWritten() const { return _numRecordsWritten; }
+    quint64 getNumBytesWritten() const { return _numBytesWritten; }
+    quint64 getNumSyncs() const { return _numSyncs; }
+
+private:
+    QString getSegmentFilename(int segment) const;
+    std::vector<int> findSegments() const;
+    bool openSegment(int segment);
+    bool sync();
+
+    QString _persistFilename;
+    QUuid _treeID;
+    PacketVersion _version { 0 };
+    std::unique_ptr<QFile> _segmentFile;
+    int _currentSegment { 0 };
+
+    quint64 _numRecordsWritten { 0 };
+    quint64 _numBytesWritten { 0 };
+    quint64 _numSyncs { 0 };
+};
+
+#endif // hifi_OctreeJournal_h
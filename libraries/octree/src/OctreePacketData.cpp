@@ -669,6 +669,28 @@ void OctreePacketData::loadFinalizedContent(const unsigned char* data, int lengt
     }
 }
 
+void OctreePacketData::loadPrecompressedContent(const QByteArray& uncompressedData, const QByteArray& compressedData) {
+    assert(_enableCompression);
+    reset();
+
+    if (uncompressedData.size() > _uncompressedByteArray.size()) {
+        _uncompressedByteArray.resize(uncompressedData.size());
+        _uncompressed = (unsigned char*)_uncompressedByteArray.data();
+    }
+    if (compressedData.size() > _compressedByteArray.size()) {
+        _compressedByteArray.resize(compressedData.size());
+        _compressed = (unsigned char*)_compressedByteArray.data();
+    }
+
+    _bytesInUse = uncompressedData.size();
+    _bytesAvailable = std::max(0, (int)_targetSize - _bytesInUse);
+    memcpy(_uncompressed, uncompressedData.constData(), _bytesInUse);
+
+    // not dirty, so the finalized data is the precompressed data until something else is appended
+    _compressedBytes = compressedData.size();
+    memcpy(_compressed, compressedData.constData(), _compressedBytes);
+}
+
 void OctreePacketData::debugContent() {
     qCDebug(octree, "OctreePacketData::debugContent()... COMPRESSED DATA.... size=%d",_compressedBytes);
     int perline=0;
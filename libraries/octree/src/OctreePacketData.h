@@ -241,6 +241,9 @@ public:
 
     /// load finalized content to allow access to decoded content for parsing
     void loadFinalizedContent(const unsigned char* data, int length);
+
+    /// load content that was compressed ahead of time, so that it is sent as is instead of being compressed again
+    void loadPrecompressedContent(const QByteArray& uncompressedData, const QByteArray& compressedData);
     
     /// returns whether or not zlib compression enabled on finalization
     bool isCompressed() const { return _enableCompression; }
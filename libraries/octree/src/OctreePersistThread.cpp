@@ -27,17 +27,20 @@
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QRegExp>
+#include <QSaveFile>
 
 #include <NumericalConstants.h>
 #include <PerfStat.h>
 #include <PathUtils.h>
 #include <Gzip.h>
 
+#include "OctreeEntitiesFileParser.h"
 #include "OctreeLogging.h"
 #include "OctreeUtils.h"
 #include "OctreeDataUtils.h"
 
 constexpr std::chrono::seconds OctreePersistThread::DEFAULT_PERSIST_INTERVAL { 30 };
+constexpr std::chrono::milliseconds OctreePersistThread::JOURNAL_FLUSH_INTERVAL { 1000 };
 constexpr std::chrono::milliseconds TIME_BETWEEN_PROCESSING { 10 };
 
 constexpr int MAX_OCTREE_REPLACEMENT_BACKUP_FILES_COUNT { 20 };
@@ -53,13 +56,22 @@ OctreePersistThread::OctreePersistThread(OctreePointer tree, const QString& file
     _loadTimeUSecs(0),
     _debugTimestampNow(debugTimestampNow),
     _lastTimeDebug(0),
-    _persistAsFileType(persistAsFileType)
+    _persistAsFileType(persistAsFileType),
+    _journal(fileNameWithoutExtension(_filename, PERSIST_EXTENSIONS))
 {
+    _snapshotFilename = fileNameWithoutExtension(_filename, PERSIST_EXTENSIONS) + ".snapshot";
+
     // in case the persist filename has an extension that doesn't match the file type
     QString sansExt = fileNameWithoutExtension(_filename, PERSIST_EXTENSIONS);
     _filename = sansExt + "." + _persistAsFileType;
 }
 
+OctreePersistThread::~OctreePersistThread() {
+    if (_compaction) {
+        _compaction->thread.join();
+    }
+}
+
 void OctreePersistThread::start() {
     cleanupOldReplacementBackups();
 
@@ -113,10 +125,14 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
     QByteArray replacementData;
     OctreeUtils::RawOctreeData data;
     bool hasValidOctreeData { false };
+    QUuid currentDataID;
+    OctreeUtils::Version currentDataVersion { OctreeUtils::INITIAL_VERSION };
     if (includesNewData) {
         _cachedJSONData.clear();
         replacementData = message->readAll();
         replaceData(replacementData);
+        // the journal holds changes to the data that was just replaced
+        _journal.removeAllSegments();
         hasValidOctreeData = data.readOctreeDataInfoFromFile(_filename);
         qDebug() << "Got OctreeDataFileReply, new data sent";
     } else {
@@ -138,6 +154,9 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
                 } else {
                     qCDebug(octree) << "Failed to update octree data";
                 }
+            } else {
+                currentDataID = data.id;
+                currentDataVersion = data.dataVersion;
             }
         }
     }
@@ -149,25 +168,88 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
         _tree->setOctreeVersionInfo(data.id, data.dataVersion);
     }
 
-    bool persistentFileRead;
-
-    _tree->withWriteLock([&] {
-        PerformanceWarning warn(true, "Loading Octree File", true);
+    // the binary snapshot written along with the persist file loads much faster, but it can only be used if the persist
+    // file it was written with is the current data, and there are no journaled changes to merge into it
+    bool loadedSnapshot = false;
+    if (!currentDataID.isNull() && !_journal.hasRecords(currentDataID)) {
+        _tree->withWriteLock([&] {
+            PerformanceWarning warn(true, "Loading Octree Snapshot", true);
+            loadedSnapshot = _tree->readFromBinarySnapshot(_snapshotFilename, currentDataID, currentDataVersion);
+            if (loadedSnapshot) {
+                _tree->pruneTree();
+            }
+        });
+    }
 
-        if (_cachedJSONData.isEmpty()) {
-            persistentFileRead = _tree->readFromFile(_filename.toLocal8Bit().constData());
-        } else {
-            QDataStream jsonStream(_cachedJSONData);
-            persistentFileRead = _tree->readFromStream(-1, jsonStream);
+    QString persistFilename = _filename;
+    if (_cachedJSONData.isEmpty() && !loadedSnapshot) {
+        persistFilename = findMostRecentFileExtension(_filename, PERSIST_EXTENSIONS);
+        QFile file(persistFilename);
+        if (file.open(QIODevice::ReadOnly)) {
+            QByteArray fileData = file.readAll();
+            if (!gunzip(fileData, _cachedJSONData)) {
+                _cachedJSONData = fileData;
+            }
         }
-        _tree->pruneTree();
-    });
+    }
 
+    QVariantMap octreeMap;
+    if (!_cachedJSONData.isEmpty() && !loadedSnapshot) {
+        OctreeEntitiesFileParser octreeParser;
+        octreeParser.setRelativeURL(QUrl::fromLocalFile(persistFilename).adjusted(QUrl::RemoveFilename));
+        octreeParser.setEntitiesString(_cachedJSONData);
+        if (!octreeParser.parseEntities(octreeMap)) {
+            qCritical() << "Couldn't parse Entities JSON:" << octreeParser.getErrorString().c_str();
+            octreeMap.clear();
+        }
+    }
     _cachedJSONData.clear();
+
+    // the changes journaled since the persist file was last written are merged in before the tree is built
+    int numJournalRecords = replayJournal(octreeMap);
+
+    if (!loadedSnapshot) {
+        _tree->withWriteLock([&] {
+            PerformanceWarning warn(true, "Loading Octree File", true);
+
+            if (!octreeMap.isEmpty()) {
+                _tree->readFromMap(octreeMap);
+            }
+            _tree->pruneTree();
+        });
+    }
+
     quint64 loadDone = usecTimestampNow();
     _loadTimeUSecs = loadDone - loadStarted;
 
-    _tree->clearDirtyBit(); // the tree is clean since we just loaded it
+    if (numJournalRecords > 0) {
+        // fold the journal into the persist file at the next persist
+        _tree->setDirtyBit();
+    } else {
+        _tree->clearDirtyBit(); // the tree is clean since we just loaded it
+    }
+
+    _initialLoadComplete = true;
+
+    // The journal is replayed on top of the persist file with the ID it was written for.  A tree whose ID isn't in the
+    // persist file, because there was no file or it had no ID, is written out before anything is journaled, otherwise
+    // its ID would change at the next start and the changes journaled before a crash would be skipped.
+    QUuid persistedID = loadedSnapshot ? currentDataID : octreeMap.value("Id").toUuid();
+    if (persistedID.isNull() || persistedID != _tree->getPersistID()) {
+        if (_tree->getPersistID().isNull()) {
+            _tree->setOctreeVersionInfo(QUuid::createUuid(), OctreeUtils::INITIAL_VERSION);
+        }
+        _tree->setDirtyBit();
+        persist(true);
+    }
+
+    // from now on every change is journaled
+    if (_journal.open(_tree->getPersistID(), _tree->expectedVersion())) {
+        _tree->setJournalEnabled(true);
+    } else {
+        qCWarning(octree) << "Couldn't open the octree journal, changes are only saved every" << _persistInterval.count() << "msecs";
+    }
+    _lastJournalFlush = std::chrono::steady_clock::now();
 
     unsigned long nodeCount = OctreeElement::getNodeCount();
     unsigned long internalNodeCount = OctreeElement::getInternalNodeCount();
@@ -187,8 +269,6 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
                 << " setChildAtIndexTime=" << OctreeElement::getSetChildAtIndexTime() << " perSet=" << usecPerSet;
     }
 
-    _initialLoadComplete = true;
-
     // Since we just loaded the persistent file, we can consider ourselves as having just persisted
     _lastPersistCheck = std::chrono::steady_clock::now();
 
@@ -247,6 +327,16 @@ void OctreePersistThread::process() {
     _tree->update();
 
     auto now = std::chrono::steady_clock::now();
+
+    if (now - _lastJournalFlush > JOURNAL_FLUSH_INTERVAL) {
+        _lastJournalFlush = now;
+        flushJournal();
+    }
+
+    if (_compaction && _compaction->done) {
+        finishCompaction();
+    }
+
     auto timeSinceLastPersist = now - _lastPersistCheck;
 
     if (timeSinceLastPersist > _persistInterval) {
@@ -259,7 +349,11 @@ void OctreePersistThread::process() {
 
 void OctreePersistThread::aboutToFinish() {
     qCDebug(octree) << "Persist thread about to finish...";
-    persist();
+    if (_compaction) {
+        _compaction->thread.join();
+        finishCompaction();
+    }
+    persist(true);
     qCDebug(octree) << "Persist thread done with about to finish...";
 }
 
@@ -302,40 +396,180 @@ void OctreePersistThread::cleanupOldReplacementBackups() {
     qDebug() << "Found" << count << "backups";
 }
 
-void OctreePersistThread::persist() {
-    if (_tree->isDirty() && _initialLoadComplete) {
+void OctreePersistThread::flushJournal() {
+    if (!_journal.isOpen()) {
+        return;
+    }
 
-        _tree->withWriteLock([&] {
-            qCDebug(octree) << "pruning Octree before saving...";
-            _tree->pruneTree();
-            qCDebug(octree) << "DONE pruning Octree before saving...";
-        });
+    OctreeJournal::Records records;
+    _tree->takeJournalRecords(records);
+    if (!_journal.append(records)) {
+        // the changes will only make it to disk with the next persist
+        qCWarning(octree) << "Failed to journal" << records.size() << "octree changes";
+    }
+}
 
-        _tree->incrementPersistDataVersion();
+void OctreePersistThread::persist(bool waitForCompletion) {
+    if (!_tree->isDirty() || !_initialLoadComplete || _compaction) {
+        return;
+    }
 
-        qCDebug(octree) << "Saving Octree data to:" << _filename;
-        if (_tree->writeToFile(_filename.toLocal8Bit().constData(), nullptr, _persistAsFileType)) {
-            _tree->clearDirtyBit(); // tree is clean after saving
-            qCDebug(octree) << "DONE persisting Octree data to" << _filename;
-        } else {
-            qCWarning(octree) << "Failed to persist Octree data to" << _filename;
+    // pruning needs the write lock, so it is skipped rather than holding up edits when the tree is busy
+    _tree->withTryWriteLock([&] {
+        _tree->pruneTree();
+    });
+
+    _tree->incrementPersistDataVersion();
+
+    // the tree is serialized without the tree lock, while it is being edited.  the last journal records are taken
+    // first, so every change that may have been missed is journaled in the segments replayed on top of this persist
+    // file, and since journal records hold the whole state of an entity replaying a change that wasn't missed is harmless.
+    OctreeJournal::Records records;
+    _tree->takeJournalRecords(records);
+    _tree->clearDirtyBit();
+
+    QString jsonString;
+    QByteArray snapshotData;
+    _tree->toJSONString(jsonString);
+    bool hasSnapshot = _tree->writeToBinarySnapshot(snapshotData);
+
+    auto compaction = std::unique_ptr<Compaction>(new Compaction());
+    if (_journal.isOpen()) {
+        _journal.append(records);
+        compaction->firstSegment = _journal.rotate();
+    }
+
+    // compressing and writing the file doesn't need the tree, so it is done away from the persist thread
+    Compaction* compactionPointer = compaction.get();
+    QString filename = _filename;
+    QString snapshotFilename = _snapshotFilename;
+    bool wantsGzippedFile = _persistAsFileType == "json.gz";
+    auto writePersistFile = [compactionPointer, filename, snapshotFilename, wantsGzippedFile, jsonString,
+                             snapshotData, hasSnapshot] {
+        QByteArray jsonData = jsonString.toUtf8();
+        bool success = gzip(jsonData, compactionPointer->gzippedData, -1);
+        if (success) {
+            QSaveFile persistFile(filename);
+            success = persistFile.open(QIODevice::WriteOnly) &&
+                persistFile.write(wantsGzippedFile ? compactionPointer->gzippedData : jsonData) != -1 &&
+                persistFile.commit();
         }
 
-        sendLatestEntityDataToDS();
+        // only written once the persist file is, since it is only used when it matches it
+        if (success && hasSnapshot) {
+            QSaveFile snapshotFile(snapshotFilename);
+            if (!snapshotFile.open(QIODevice::WriteOnly) || snapshotFile.write(snapshotData) == -1 || !snapshotFile.commit()) {
+                qCWarning(octree) << "Failed to write octree snapshot to" << snapshotFilename;
+            }
+        }
+        compactionPointer->success = success;
+        compactionPointer->done = true;
+    };
+
+    qCDebug(octree) << "Saving Octree data to:" << _filename;
+    _compaction = std::move(compaction);
+    if (waitForCompletion) {
+        writePersistFile();
+        finishCompaction();
+    } else {
+        _compaction->thread = std::thread(writePersistFile);
     }
 }
 
-void OctreePersistThread::sendLatestEntityDataToDS() {
-    qDebug() << "Sending latest entity data to DS";
-    auto nodeList = DependencyManager::get<NodeList>();
-    const DomainHandler& domainHandler = nodeList->getDomainHandler();
+void OctreePersistThread::finishCompaction() {
+    if (_compaction->thread.joinable()) {
+        _compaction->thread.join();
+    }
+
+    if (_compaction->success) {
+        qCDebug(octree) << "DONE persisting Octree data to" << _filename;
+        _journal.removeSegmentsBefore(_compaction->firstSegment);
+        sendEntityDataToDS(_compaction->gzippedData);
+    } else {
+        qCWarning(octree) << "Failed to persist Octree data to" << _filename;
+        // keep the journal, and try again at the next persist
+        _tree->setDirtyBit();
+    }
+    _compaction.reset();
+}
 
+void OctreePersistThread::sendLatestEntityDataToDS() {
     QByteArray data;
     if (_tree->toJSON(&data, nullptr, true)) {
-        auto message = NLPacketList::create(PacketType::OctreeDataPersist, QByteArray(), true, true);
-        message->write(data);
-        nodeList->sendPacketList(std::move(message), domainHandler.getSockAddr());
+        sendEntityDataToDS(data);
     } else {
         qCWarning(octree) << "Failed to persist octree to DS";
     }
 }
+
+void OctreePersistThread::sendEntityDataToDS(const QByteArray& gzippedData) {
+    qDebug() << "Sending latest entity data to DS";
+    auto nodeList = DependencyManager::get<NodeList>();
+    const DomainHandler& domainHandler = nodeList->getDomainHandler();
+
+    auto message = NLPacketList::create(PacketType::OctreeDataPersist, QByteArray(), true, true);
+    message->write(gzippedData);
+    nodeList->sendPacketList(std::move(message), domainHandler.getSockAddr());
+}
+
+int OctreePersistThread::replayJournal(QVariantMap& map) {
+    QVariantList entities = map["Entities"].toList();
+    QHash<QUuid, int> entityIndices;
+    for (int i = 0; i < entities.size(); i++) {
+        entityIndices[entities[i].toMap()["id"].toUuid()] = i;
+    }
+
+    // the tree only takes the persist file's id once the map is read
+    QUuid persistID = map.contains("Id") ? map["Id"].toUuid() : _tree->getPersistID();
+    bool hasVersion = map.contains("Version");
+    int numSkippedRecords = 0;
+    int numRecords = _journal.replay(persistID, [&](PacketVersion version, const OctreeJournal::Records& records) {
+        if (!hasVersion) {
+            map["Version"] = (int)version;
+            hasVersion = true;
+        } else if (map["Version"].toInt() != (int)version) {
+            // the entities are read with the persist file's version, so these changes can't be merged with them
+            numSkippedRecords += (int)records.size();
+            return;
+        }
+
+        for (const auto& record : records) {
+            auto index = entityIndices.find(record.id);
+            if (record.type == OctreeJournal::RecordType::Delete) {
+                if (index != entityIndices.end()) {
+                    entities[index.value()] = QVariant();
+                    entityIndices.erase(index);
+                }
+                continue;
+            }
+
+            QVariantMap entityMap;
+            QDataStream stream(record.payload);
+            stream >> entityMap;
+            if (index != entityIndices.end()) {
+                entities[index.value()] = entityMap;
+            } else {
+                entityIndices[record.id] = entities.size();
+                entities.push_back(entityMap);
+            }
+        }
+    });
+
+    if (numRecords == 0) {
+        return 0;
+    }
+    if (numSkippedRecords > 0) {
+        qCWarning(octree) << "Skipped" << numSkippedRecords << "journaled changes written for another entity data version";
+    }
+
+    QVariantList replayedEntities;
+    replayedEntities.reserve(entityIndices.size());
+    for (const auto& entity : entities) {
+        if (entity.isValid()) {
+            replayedEntities.push_back(entity);
+        }
+    }
+    map["Entities"] = replayedEntities;
+    qCDebug(octree) << "Replayed" << (numRecords - numSkippedRecords) << "journaled changes on top of" << _filename;
+    return numRecords - numSkippedRecords;
+}
@@ -14,9 +14,14 @@
 #ifndef hifi_OctreePersistThread_h
 #define hifi_OctreePersistThread_h
 
+#include <atomic>
+#include <memory>
+#include <thread>
+
 #include <QString>
 #include <GenericThread.h>
 #include "Octree.h"
+#include "OctreeJournal.h"
 
 class OctreePersistThread : public QObject {
     Q_OBJECT
@@ -31,12 +36,14 @@ public:
     };
 
     static const std::chrono::seconds DEFAULT_PERSIST_INTERVAL;
+    static const std::chrono::milliseconds JOURNAL_FLUSH_INTERVAL;
 
     OctreePersistThread(OctreePointer tree,
                         const QString& filename,
                         std::chrono::milliseconds persistInterval = DEFAULT_PERSIST_INTERVAL,
                         bool debugTimestampNow = false,
                         QString persistAsFileType = "json.gz");
+    ~OctreePersistThread();
 
     bool isInitialLoadComplete() const { return _initialLoadComplete; }
     quint64 getLoadElapsedTime() const { return _loadTimeUSecs; }
@@ -58,12 +65,19 @@ protected slots:
     void handleOctreeDataFileReply(QSharedPointer<ReceivedMessage> message);
 
 protected:
-    void persist();
+    // writes the whole tree to the persist file, compacting the journal written since the last time.
+    // the file is written on a separate thread unless waitForCompletion is set.
+    void persist(bool waitForCompletion = false);
+    void flushJournal();
+    void finishCompaction();
+    int replayJournal(QVariantMap& map);
+
     bool backupCurrentFile();
     void cleanupOldReplacementBackups();
 
     void replaceData(QByteArray data);
     void sendLatestEntityDataToDS();
+    void sendEntityDataToDS(const QByteArray& gzippedData);
 
 private:
     OctreePointer _tree;
@@ -79,6 +93,19 @@ private:
 
     QString _persistAsFileType;
     QByteArray _cachedJSONData;
+
+    QString _snapshotFilename;
+    OctreeJournal _journal;
+    std::chrono::steady_clock::time_point _lastJournalFlush;
+
+    struct Compaction {
+        std::thread thread;
+        std::atomic<bool> done { false };
+        bool success { false };
+        int firstSegment { 0 };     // the segments before this one are included in the persist file
+        QByteArray gzippedData;     // for the domain server
+    };
+    std::unique_ptr<Compaction> _compaction;
 };
 
 #endif // hifi_OctreePersistThread_h
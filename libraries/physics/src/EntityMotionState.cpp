@@ -367,15 +367,17 @@ bool EntityMotionState::remoteSimulationOutOfSync(uint32_t simulationStep) {
     btTransform worldTrans = _body->getWorldTransform();
     glm::vec3 position = worldToLocal.transform(bulletToGLM(worldTrans.getOrigin()));
 
+    // the allowed errors grow with _sendErrorScale, when the upstream budget is tight or nobody is near
+    float errorScale2 = _sendErrorScale * _sendErrorScale;
     float dx2 = glm::distance2(position, _serverPosition);
     const float MAX_POSITION_ERROR_SQUARED = 0.000004f; // corresponds to 2mm
-    if (dx2 > MAX_POSITION_ERROR_SQUARED) {
+    if (dx2 > MAX_POSITION_ERROR_SQUARED * errorScale2) {
         // we don't mind larger position error when the object has high speed
         // so we divide by speed and check again
         float speed2 = glm::length2(_serverVelocity);
         const float MIN_ERROR_RATIO_SQUARED = 0.0025f; // corresponds to 5% error in 1 second
         const float MIN_SPEED_SQUARED = 1.0e-6f; // corresponds to 1mm/sec
-        if (speed2 < MIN_SPEED_SQUARED || dx2 / speed2 > MIN_ERROR_RATIO_SQUARED) {
+        if (speed2 < MIN_SPEED_SQUARED || dx2 / speed2 > MIN_ERROR_RATIO_SQUARED * errorScale2) {
             return true;
         }
     }
@@ -395,8 +397,14 @@ bool EntityMotionState::remoteSimulationOutOfSync(uint32_t simulationStep) {
         }
         _serverRotation = glm::normalize(rotation * _serverRotation);
         const float MIN_ROTATION_DOT = 0.99999f; // This corresponds to about 0.5 degrees of rotation
+        float minRotationDot = MIN_ROTATION_DOT;
+        if (_sendErrorScale > 1.0f) {
+            // the dot is the cosine of half the angle between the rotations
+            const float MAX_ROTATION_HALF_ANGLE = acosf(MIN_ROTATION_DOT);
+            minRotationDot = cosf(MAX_ROTATION_HALF_ANGLE * _sendErrorScale);
+        }
         glm::quat actualRotation = worldToLocal.getRotation() * bulletToGLM(worldTrans.getRotation());
-        return (fabsf(glm::dot(actualRotation, _serverRotation)) < MIN_ROTATION_DOT);
+        return (fabsf(glm::dot(actualRotation, _serverRotation)) < minRotationDot);
     }
     return false;
 }
@@ -52,6 +52,8 @@ public:
     virtual void setWorldTransform(const btTransform& worldTrans) override;
 
     bool shouldSendUpdate(uint32_t simulationStep);
+    // scales the dead reckoning error allowed before an update is sent
+    void setSendErrorScale(float scale) { _sendErrorScale = scale; }
     void sendBid(OctreeEditPacketSender* packetSender, uint32_t step);
     void sendUpdate(OctreeEditPacketSender* packetSender, uint32_t step);
 
@@ -147,6 +149,7 @@ protected:
     quint64 _nextBidExpiry { 0 };
 
     float _measuredDeltaTime;
+    float _sendErrorScale { 1.0f };
     uint32_t _lastMeasureStep;
     uint32_t _lastStep; // last step of server extrapolation
 
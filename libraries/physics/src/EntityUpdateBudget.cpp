@@ -0,0 +1,75 @@
+//
+//  EntityUpdateBudget.cpp
+//  libraries/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityUpdateBudget.h"
+
+#include <algorithm>
+
+#include <NumericalConstants.h>
+
+const float EntityUpdateBudget::DEFAULT_MAX_KBPS = 256.0f;
+const float EntityUpdateBudget::MAX_ERROR_SCALE = 16.0f; // 3.2cm and 8 degrees
+const float EntityUpdateBudget::FULL_ACCURACY_DISTANCE = 5.0f; // meters
+const uint32_t EntityUpdateBudget::MAX_SEND_PERIOD_STEPS = 3;
+
+const uint64_t MEASUREMENT_WINDOW = USECS_PER_SECOND / 4;
+const float RATE_SMOOTHING = 0.5f;
+const float OVER_BUDGET_GROWTH = 1.5f;
+const float UNDER_BUDGET_DECAY = 0.8f;
+const float UNDER_BUDGET_RATIO = 0.5f;
+
+void EntityUpdateBudget::setMaxKbps(float maxKbps) {
+    _maxKbps = std::max(maxKbps, 1.0f);
+}
+
+void EntityUpdateBudget::update(uint64_t now, uint64_t totalBytesQueued, uint64_t totalPacketsQueued, uint32_t numUpdates) {
+    if (_windowStart == 0) {
+        _windowStart = now;
+        _windowStartBytes = totalBytesQueued;
+        _windowStartPackets = totalPacketsQueued;
+    }
+    _windowUpdates += numUpdates;
+    if (now - _windowStart < MEASUREMENT_WINDOW) {
+        return;
+    }
+
+    float seconds = (float)(now - _windowStart) / (float)USECS_PER_SECOND;
+    float kbps = (float)(totalBytesQueued - _windowStartBytes) / ((float)BYTES_PER_KILOBIT * seconds);
+    float packetsPerSecond = (float)(totalPacketsQueued - _windowStartPackets) / seconds;
+    float updatesPerSecond = (float)_windowUpdates / seconds;
+    _kbps = RATE_SMOOTHING * _kbps + (1.0f - RATE_SMOOTHING) * kbps;
+    _packetsPerSecond = RATE_SMOOTHING * _packetsPerSecond + (1.0f - RATE_SMOOTHING) * packetsPerSecond;
+    _updatesPerSecond = RATE_SMOOTHING * _updatesPerSecond + (1.0f - RATE_SMOOTHING) * updatesPerSecond;
+
+    if (_kbps > _maxKbps) {
+        _errorScale = std::min(_errorScale * OVER_BUDGET_GROWTH, MAX_ERROR_SCALE);
+    } else if (_kbps < UNDER_BUDGET_RATIO * _maxKbps) {
+        _errorScale = std::max(_errorScale * UNDER_BUDGET_DECAY, 1.0f);
+    }
+
+    _windowStart = now;
+    _windowStartBytes = totalBytesQueued;
+    _windowStartPackets = totalPacketsQueued;
+    _windowUpdates = 0;
+}
+
+float EntityUpdateBudget::computeErrorScale(float viewerDistance) const {
+    // farther viewers can't see small errors, keep the error constant in screen space
+    float distanceScale = std::max(viewerDistance / FULL_ACCURACY_DISTANCE, 1.0f);
+    return std::min(_errorScale * distanceScale, MAX_ERROR_SCALE);
+}
+
+uint32_t EntityUpdateBudget::getSendPeriodSteps() const {
+    // every step within budget, then every other step, then every third one
+    if (_errorScale < 2.0f) {
+        return 1;
+    }
+    return _errorScale < 4.0f ? 2 : MAX_SEND_PERIOD_STEPS;
+}
@@ -0,0 +1,58 @@
+//
+//  EntityUpdateBudget.h
+//  libraries/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityUpdateBudget_h
+#define hifi_EntityUpdateBudget_h
+
+#include <stdint.h>
+
+// Keeps the updates of locally owned entities within an upstream budget.  The entity edit traffic is measured after
+// every batch of updates: while it is over budget the dead reckoning error allowed before an update is sent grows,
+// and the batches are sent less often, when it is well under budget they shrink back.  Both are bounded, so the
+// error the entity server and the other clients see never exceeds MAX_ERROR_SCALE times the nominal error.
+class EntityUpdateBudget {
+public:
+    static const float DEFAULT_MAX_KBPS;
+    static const float MAX_ERROR_SCALE;
+    static const float FULL_ACCURACY_DISTANCE;
+    static const uint32_t MAX_SEND_PERIOD_STEPS;
+
+    void setMaxKbps(float maxKbps);
+    float getMaxKbps() const { return _maxKbps; }
+
+    // called after each batch with the lifetime totals of the entity packet sender
+    void update(uint64_t now, uint64_t totalBytesQueued, uint64_t totalPacketsQueued, uint32_t numUpdates);
+
+    // the part of the error scale due to the budget
+    float getErrorScale() const { return _errorScale; }
+    // the error scale of an object, which also grows with the distance to the nearest viewer
+    float computeErrorScale(float viewerDistance) const;
+    // the number of physics substeps between two batches of updates
+    uint32_t getSendPeriodSteps() const;
+
+    float getKbps() const { return _kbps; }
+    float getPacketsPerSecond() const { return _packetsPerSecond; }
+    float getUpdatesPerSecond() const { return _updatesPerSecond; }
+
+private:
+    float _maxKbps { DEFAULT_MAX_KBPS };
+    float _errorScale { 1.0f };
+
+    uint64_t _windowStart { 0 };
+    uint64_t _windowStartBytes { 0 };
+    uint64_t _windowStartPackets { 0 };
+    uint32_t _windowUpdates { 0 };
+
+    float _kbps { 0.0f };
+    float _packetsPerSecond { 0.0f };
+    float _updatesPerSecond { 0.0f };
+};
+
+#endif // hifi_EntityUpdateBudget_h
@@ -12,6 +12,8 @@
 
 #include "PhysicalEntitySimulation.h"
 
+#include <glm/gtx/norm.hpp>
+
 #include <Profile.h>
 
 #include "PhysicsHelpers.h"
@@ -298,7 +300,8 @@ void PhysicalEntitySimulation::buildMotionStatesForEntitiesThatNeedThem() {
                         // bummer, the hashes are different and we no longer want the shape we've received
                         ObjectMotionState::getShapeManager()->releaseShape(shape);
                         // try again
-                        shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo));
+                        const bool ALLOW_OFF_THREAD = true;
+                        shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo, ALLOW_OFF_THREAD));
                         if (shape) {
                             buildMotionState(shape, entity);
                             requestItr = _shapeRequests.erase(requestItr);
@@ -372,7 +375,8 @@ void PhysicalEntitySimulation::buildMotionStatesForEntitiesThatNeedThem() {
                 ShapeInfo shapeInfo;
                 entity->computeShapeInfo(shapeInfo);
                 uint32_t requestCount = ObjectMotionState::getShapeManager()->getWorkRequestCount();
-                btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo));
+                const bool ALLOW_OFF_THREAD = true;
+                btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo, ALLOW_OFF_THREAD));
                 if (shape) {
                     buildMotionState(shape, entity);
                 } else if (requestCount != ObjectMotionState::getShapeManager()->getWorkRequestCount()) {
@@ -428,14 +432,15 @@ void PhysicalEntitySimulation::buildPhysicsTransaction(PhysicsEngine::Transactio
         bool needsNewShape = object->needsNewShape() && object->_entity->isReadyToComputeShape();
         if (needsNewShape) {
             ShapeType shapeType = object->getShapeType();
-            if (shapeType == SHAPE_TYPE_STATIC_MESH) {
+            if (ObjectMotionState::getShapeManager()->canBuildOffThread(shapeType)) {
                 ShapeRequest shapeRequest(object->_entity);
                 ShapeRequests::iterator requestItr = _shapeRequests.find(shapeRequest);
                 if (requestItr == _shapeRequests.end()) {
                     ShapeInfo shapeInfo;
                     object->_entity->computeShapeInfo(shapeInfo);
                     uint32_t requestCount = ObjectMotionState::getShapeManager()->getWorkRequestCount();
-                    btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo));
+                    const bool ALLOW_OFF_THREAD = true;
+                    btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo, ALLOW_OFF_THREAD));
                     if (shape) {
                         object->setShape(shape);
                         handledFlags |= Simulation::DIRTY_SHAPE;
@@ -558,7 +563,8 @@ void PhysicalEntitySimulation::handleChangedMotionStates(const VectorOfMotionSta
     }
 
     uint32_t numSubsteps = _physicsEngine->getNumSubsteps();
-    if (_lastStepSendPackets != numSubsteps) {
+    // updates go out in batches, every substep while within the upstream budget and less often when over it
+    if (numSubsteps - _lastStepSendPackets >= _updateBudget.getSendPeriodSteps()) {
         _lastStepSendPackets = numSubsteps;
 
         if (Physics::getSessionUUID().isNull()) {
@@ -568,6 +574,17 @@ void PhysicalEntitySimulation::handleChangedMotionStates(const VectorOfMotionSta
         // send updates before bids, because this simplifies the logic thasuccessful bids will immediately send an update when added to the 'owned' list
         sendOwnedUpdates(numSubsteps);
         sendOwnershipBids(numSubsteps);
+
+        if (_entityPacketSender) {
+            if (_numUpdatesSent > 0) {
+                // the sender packs consecutive edits into one packet per server, release it with the whole batch
+                // rather than waiting for the next script edit
+                _entityPacketSender->releaseQueuedMessages();
+            }
+            _updateBudget.update(usecTimestampNow(), _entityPacketSender->getLifetimeBytesQueued(),
+                _entityPacketSender->getLifetimePacketsQueued(), _numUpdatesSent);
+        }
+        _numUpdatesSent = 0;
     }
 }
 
@@ -604,6 +621,7 @@ void PhysicalEntitySimulation::sendOwnershipBids(uint32_t numSubsteps) {
                 // "telling" the server rather than what we've been "hearing" from the server.
                 _bids[i]->slaveBidPriority();
                 _bids[i]->sendUpdate(_entityPacketSender, numSubsteps);
+                ++_numUpdatesSent;
 
                 addOwnership(_bids[i]);
                 removeBid = true;
@@ -616,6 +634,7 @@ void PhysicalEntitySimulation::sendOwnershipBids(uint32_t numSubsteps) {
             } else {
                 if (now > _bids[i]->getNextBidExpiry()) {
                     _bids[i]->sendBid(_entityPacketSender, numSubsteps);
+                    ++_numUpdatesSent;
                     _nextBidExpiry = glm::min(_nextBidExpiry, _bids[i]->getNextBidExpiry());
                 }
                 ++i;
@@ -639,14 +658,29 @@ void PhysicalEntitySimulation::sendOwnedUpdates(uint32_t numSubsteps) {
             }
             _owned.remove(i);
         } else {
+            float viewerDistance = computeViewerDistance(_owned[i]->getEntity()->getWorldPosition());
+            _owned[i]->setSendErrorScale(_updateBudget.computeErrorScale(viewerDistance));
             if (_owned[i]->shouldSendUpdate(numSubsteps)) {
                 _owned[i]->sendUpdate(_entityPacketSender, numSubsteps);
+                ++_numUpdatesSent;
             }
             ++i;
         }
     }
 }
 
+float PhysicalEntitySimulation::computeViewerDistance(const glm::vec3& position) const {
+    if (_viewerPositions.empty()) {
+        // nobody to ask, keep full accuracy
+        return 0.0f;
+    }
+    float minDistance2 = std::numeric_limits<float>::max();
+    for (const auto& viewerPosition : _viewerPositions) {
+        minDistance2 = std::min(minDistance2, glm::distance2(position, viewerPosition));
+    }
+    return sqrtf(minDistance2);
+}
+
 void PhysicalEntitySimulation::handleCollisionEvents(const CollisionEvents& collisionEvents) {
     for (auto collision : collisionEvents) {
         // NOTE: The collision event is always aligned such that idA is never NULL.
@@ -26,6 +26,7 @@
 
 #include "PhysicsEngine.h"
 #include "EntityMotionState.h"
+#include "EntityUpdateBudget.h"
 
 class PhysicalEntitySimulation;
 using PhysicalEntitySimulationPointer = std::shared_ptr<PhysicalEntitySimulation>;
@@ -99,8 +100,15 @@ public:
     void sendOwnershipBids(uint32_t numSubsteps);
     void sendOwnedUpdates(uint32_t numSubsteps);
 
+    // the positions of the avatars that can see our objects, objects far from all of them send coarser updates
+    void setViewerPositions(const std::vector<glm::vec3>& positions) { _viewerPositions = positions; }
+
+    EntityUpdateBudget& getUpdateBudget() { return _updateBudget; }
+    const EntityUpdateBudget& getUpdateBudget() const { return _updateBudget; }
+
 private:
     void buildMotionStatesForEntitiesThatNeedThem();
+    float computeViewerDistance(const glm::vec3& position) const;
 
     class ShapeRequest {
     public:
@@ -134,6 +142,9 @@ private:
     workload::SpacePointer _space;
     uint64_t _nextBidExpiry;
     uint32_t _lastStepSendPackets { 0 };
+    uint32_t _numUpdatesSent { 0 };
+    EntityUpdateBudget _updateBudget;
+    std::vector<glm::vec3> _viewerPositions;
     uint32_t _lastWorkDeliveryCount { 0 };
 };
 
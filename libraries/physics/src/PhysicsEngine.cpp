@@ -11,22 +11,36 @@
 
 #include "PhysicsEngine.h"
 
+#include <algorithm>
 #include <functional>
 
 #include <QFile>
+#include <QThread>
 
 #include <PerfStat.h>
 #include <PhysicsCollisionGroups.h>
 #include <Profile.h>
+#include <SharedUtil.h>
+#include <ThreadHelpers.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
 #include <BulletCollision/CollisionShapes/btTriangleShape.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
 
 #include "CharacterController.h"
 #include "ObjectMotionState.h"
 #include "PhysicsHelpers.h"
 #include "PhysicsDebugDraw.h"
+#include "PhysicsTaskScheduler.h"
 #include "ThreadSafeDynamicsWorld.h"
 #include "PhysicsLogging.h"
 
+// the most threads the automatic number of simulation threads uses
+const int MAX_AUTOMATIC_SIMULATION_THREADS = 4;
+
+static int getMaxNumSimulationThreads() {
+    return std::max(1, std::min(QThread::idealThreadCount(), BT_MAX_THREAD_COUNT - 1));
+}
+
 PhysicsEngine::PhysicsEngine(const glm::vec3& offset) :
         _originOffset(offset),
         _myAvatarController(nullptr) {
@@ -37,7 +51,8 @@ PhysicsEngine::~PhysicsEngine() {
     delete _collisionConfig;
     delete _collisionDispatcher;
     delete _broadphaseFilter;
-    delete _constraintSolver;
+    delete _constraintSolverPool;
+    delete _constraintSolverMt;
     delete _dynamicsWorld;
     delete _ghostPairCallback;
 }
@@ -45,10 +60,15 @@ PhysicsEngine::~PhysicsEngine() {
 void PhysicsEngine::init() {
     if (!_dynamicsWorld) {
         _collisionConfig = new btDefaultCollisionConfiguration();
-        _collisionDispatcher = new btCollisionDispatcher(_collisionConfig);
+        // the multi-threaded parts of Bullet run on the task scheduler, with one thread until told otherwise
+        btSetTaskScheduler(PhysicsTaskScheduler::getInstance());
+        _collisionDispatcher = new btCollisionDispatcherMt(_collisionConfig);
         _broadphaseFilter = new btDbvtBroadphase();
-        _constraintSolver = new btSequentialImpulseConstraintSolver;
-        _dynamicsWorld = new ThreadSafeDynamicsWorld(_collisionDispatcher, _broadphaseFilter, _constraintSolver, _collisionConfig);
+        // a solver for each thread that can solve islands at the same time, and one for the islands too large for one thread
+        _constraintSolverPool = new btConstraintSolverPoolMt(getMaxNumSimulationThreads());
+        _constraintSolverMt = new btSequentialImpulseConstraintSolverMt();
+        _dynamicsWorld = new ThreadSafeDynamicsWorld(_collisionDispatcher, _broadphaseFilter, _constraintSolverPool,
+            _constraintSolverMt, _collisionConfig);
         _physicsDebugDraw.reset(new PhysicsDebugDraw());
 
         // hook up debug draw renderer
@@ -70,6 +90,18 @@ void PhysicsEngine::init() {
     }
 }
 
+void PhysicsEngine::setNumSimulationThreads(int numThreads) {
+    if (numThreads <= 0) {
+        // leave cores to the game loop and the render thread
+        numThreads = std::min(MAX_AUTOMATIC_SIMULATION_THREADS, QThread::idealThreadCount() / 2);
+    }
+    PhysicsTaskScheduler::getInstance()->setNumThreads(std::max(1, std::min(numThreads, getMaxNumSimulationThreads())));
+}
+
+int PhysicsEngine::getNumSimulationThreads() const {
+    return PhysicsTaskScheduler::getInstance()->getNumThreads();
+}
+
 uint32_t PhysicsEngine::getNumSubsteps() const {
     return _dynamicsWorld->getNumSubsteps();
 }
@@ -96,6 +96,11 @@ public:
     ~PhysicsEngine();
     void init();
 
+    /// \brief sets the number of threads a step runs on, 0 picks it from the number of cores.
+    /// Bullet has a single task scheduler, so all engines share the number.
+    void setNumSimulationThreads(int numThreads);
+    int getNumSimulationThreads() const;
+
     uint32_t getNumSubsteps() const;
     int32_t getNumCollisionObjects() const;
 
@@ -172,7 +177,8 @@ private:
     btDefaultCollisionConfiguration* _collisionConfig = NULL;
     btCollisionDispatcher* _collisionDispatcher = NULL;
     btBroadphaseInterface* _broadphaseFilter = NULL;
-    btSequentialImpulseConstraintSolver* _constraintSolver = NULL;
+    btConstraintSolverPoolMt* _constraintSolverPool = NULL;
+    btConstraintSolver* _constraintSolverMt = NULL;
     ThreadSafeDynamicsWorld* _dynamicsWorld = NULL;
     btGhostPairCallback* _ghostPairCallback = NULL;
     std::unique_ptr<PhysicsDebugDraw> _physicsDebugDraw;
@@ -0,0 +1,68 @@
+//
+//  PhysicsTaskScheduler.cpp
+//  libraries/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PhysicsTaskScheduler.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <TBBHelpers.h>
+#include <tbb/parallel_reduce.h>
+
+PhysicsTaskScheduler* PhysicsTaskScheduler::getInstance() {
+    static PhysicsTaskScheduler instance;
+    return &instance;
+}
+
+PhysicsTaskScheduler::PhysicsTaskScheduler() : btITaskScheduler("PhysicsTaskScheduler") {
+}
+
+PhysicsTaskScheduler::~PhysicsTaskScheduler() {
+}
+
+void PhysicsTaskScheduler::setNumThreads(int numThreads) {
+    // one of the threads is the one that steps the simulation
+    numThreads = std::max(1, std::min(numThreads, BT_MAX_THREAD_COUNT - 1));
+    if (numThreads == _numThreads) {
+        return;
+    }
+    _numThreads = numThreads;
+    if (_numThreads > 1) {
+        _arena.reset(new tbb::task_arena(_numThreads));
+    } else {
+        _arena.reset();
+    }
+}
+
+void PhysicsTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) {
+    if (!_arena || iEnd - iBegin <= grainSize) {
+        body.forLoop(iBegin, iEnd);
+        return;
+    }
+    _arena->execute([&] {
+        tbb::parallel_for(tbb::blocked_range<int>(iBegin, iEnd, grainSize), [&](const tbb::blocked_range<int>& range) {
+            body.forLoop(range.begin(), range.end());
+        });
+    });
+}
+
+btScalar PhysicsTaskScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) {
+    if (!_arena || iEnd - iBegin <= grainSize) {
+        return body.sumLoop(iBegin, iEnd);
+    }
+    btScalar sum = btScalar(0);
+    _arena->execute([&] {
+        sum = tbb::parallel_reduce(tbb::blocked_range<int>(iBegin, iEnd, grainSize), btScalar(0),
+            [&](const tbb::blocked_range<int>& range, btScalar partialSum) {
+                return partialSum + body.sumLoop(range.begin(), range.end());
+            }, std::plus<btScalar>());
+    });
+    return sum;
+}
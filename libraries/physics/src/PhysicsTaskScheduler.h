@@ -0,0 +1,43 @@
+//
+//  PhysicsTaskScheduler.h
+//  libraries/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PhysicsTaskScheduler_h
+#define hifi_PhysicsTaskScheduler_h
+
+#include <memory>
+
+#include <LinearMath/btThreads.h>
+#include <tbb/task_arena.h>
+
+// Runs the parallel loops of Bullet's multi-threaded world on the TBB thread pool the rest of the code uses, limited
+// to a number of threads.  With one thread the loops run on the calling thread.
+class PhysicsTaskScheduler : public btITaskScheduler {
+public:
+    // Bullet has a single task scheduler
+    static PhysicsTaskScheduler* getInstance();
+
+    ~PhysicsTaskScheduler();
+
+    // Bullet sizes its per thread data by this, and TBB may run the loops on any of its threads
+    int getMaxNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+    int getNumThreads() const override { return _numThreads; }
+    void setNumThreads(int numThreads) override;
+
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override;
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override;
+
+private:
+    PhysicsTaskScheduler();
+
+    int _numThreads { 1 };
+    std::unique_ptr<tbb::task_arena> _arena;
+};
+
+#endif // hifi_PhysicsTaskScheduler_h
@@ -0,0 +1,294 @@
+//
+//  ShapeCache.cpp
+//  libraries/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ShapeCache.h"
+
+#include <cstring>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QSysInfo>
+
+#include "PhysicsLogging.h"
+#include "ShapeFactory.h"
+
+// Whenever a change is made to the serialized format that isn't backward compatible, this value should be
+// incremented.  Files with another version are rebuilt and overwritten.
+const uint32_t ShapeCache::CURRENT_VERSION = 0x02;
+
+static const quint32 SHAPE_CACHE_MAGIC = 0x48465343; // "HFSC"
+static const int BVH_BUFFER_ALIGNMENT = 16;
+
+// the shapes built by the ShapeFactory for cacheable types are convex hulls, static meshes, or one level of
+// compound shape around them
+enum SerializedShapeType : quint8 {
+    SERIALIZED_CONVEX_HULL = 0,
+    SERIALIZED_COMPOUND,
+    SERIALIZED_STATIC_MESH
+};
+
+static QByteArray computeContentHash(const ShapeInfo& info) {
+    // the ShapeInfo hash covers the type, dimensions and url but not the geometry, so the exact points and indices
+    // are hashed as well
+    QCryptographicHash hasher(QCryptographicHash::Md5);
+    for (const auto& points : info.getPointCollection()) {
+        int32_t numPoints = points.size();
+        hasher.addData(reinterpret_cast<const char*>(&numPoints), sizeof(numPoints));
+        hasher.addData(reinterpret_cast<const char*>(points.constData()), numPoints * (int)sizeof(glm::vec3));
+    }
+    const ShapeInfo::TriangleIndices& indices = info.getTriangleIndices();
+    hasher.addData(reinterpret_cast<const char*>(indices.constData()), indices.size() * (int)sizeof(int32_t));
+    return hasher.result();
+}
+
+// the header only says which shape the file is for, a truncated or damaged file is caught by the checksum of the
+// serialized shape that follows it
+static QByteArray computeChecksum(const QByteArray& payload) {
+    return QCryptographicHash::hash(payload, QCryptographicHash::Md5);
+}
+
+static std::string computeKey(uint64_t shapeHash, const QByteArray& contentHash) {
+    return (QString("%1").arg(shapeHash, 16, 16, QChar('0')) + contentHash.toHex()).toStdString();
+}
+
+static void writeVector(QDataStream& stream, const btVector3& vector) {
+    stream << (float)vector.x() << (float)vector.y() << (float)vector.z();
+}
+
+static btVector3 readVector(QDataStream& stream) {
+    float x, y, z;
+    stream >> x >> y >> z;
+    return btVector3(x, y, z);
+}
+
+static bool writeShape(QDataStream& stream, const btCollisionShape* shape, bool isChild) {
+    switch (shape->getShapeType()) {
+        case CONVEX_HULL_SHAPE_PROXYTYPE: {
+            const btConvexHullShape* hull = static_cast<const btConvexHullShape*>(shape);
+            int32_t numPoints = hull->getNumPoints();
+            stream << (quint8)SERIALIZED_CONVEX_HULL << (float)hull->getMargin() << (quint32)numPoints;
+            const btVector3* points = hull->getUnscaledPoints();
+            for (int32_t i = 0; i < numPoints; ++i) {
+                writeVector(stream, points[i]);
+            }
+            return true;
+        }
+        case COMPOUND_SHAPE_PROXYTYPE: {
+            if (isChild) {
+                return false;
+            }
+            const btCompoundShape* compound = static_cast<const btCompoundShape*>(shape);
+            int32_t numChildren = compound->getNumChildShapes();
+            stream << (quint8)SERIALIZED_COMPOUND << (quint32)numChildren;
+            for (int32_t i = 0; i < numChildren; ++i) {
+                const btTransform& transform = compound->getChildTransform(i);
+                btQuaternion rotation = transform.getRotation();
+                writeVector(stream, transform.getOrigin());
+                stream << (float)rotation.x() << (float)rotation.y() << (float)rotation.z() << (float)rotation.w();
+                if (!writeShape(stream, compound->getChildShape(i), true)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case TRIANGLE_MESH_SHAPE_PROXYTYPE: {
+            // the mesh is rebuilt from the ShapeInfo when loaded, only its bvh is expensive
+            btBvhTriangleMeshShape* mesh = const_cast<btBvhTriangleMeshShape*>(static_cast<const btBvhTriangleMeshShape*>(shape));
+            const btOptimizedBvh* bvh = mesh->getOptimizedBvh();
+            if (!bvh) {
+                return false;
+            }
+            uint32_t size = bvh->calculateSerializeBufferSize();
+            void* buffer = btAlignedAlloc(size, BVH_BUFFER_ALIGNMENT);
+            bool serialized = bvh->serializeInPlace(buffer, size, false);
+            if (serialized) {
+                stream << (quint8)SERIALIZED_STATIC_MESH << QByteArray(static_cast<const char*>(buffer), (int)size);
+            }
+            btAlignedFree(buffer);
+            return serialized;
+        }
+        default:
+            return false;
+    }
+}
+
+static btCollisionShape* readShape(QDataStream& stream, const ShapeInfo& info, bool isChild) {
+    quint8 type = 0;
+    stream >> type;
+    if (stream.status() != QDataStream::Ok) {
+        return nullptr;
+    }
+    switch (type) {
+        case SERIALIZED_CONVEX_HULL: {
+            float margin = 0.0f;
+            quint32 numPoints = 0;
+            stream >> margin >> numPoints;
+            if (stream.status() != QDataStream::Ok || numPoints == 0 || numPoints > (quint32)MAX_HULL_POINTS) {
+                return nullptr;
+            }
+            btConvexHullShape* hull = new btConvexHullShape();
+            for (quint32 i = 0; i < numPoints; ++i) {
+                hull->addPoint(readVector(stream), false);
+            }
+            if (stream.status() != QDataStream::Ok) {
+                delete hull;
+                return nullptr;
+            }
+            hull->setMargin(margin);
+            hull->recalcLocalAabb();
+            return hull;
+        }
+        case SERIALIZED_COMPOUND: {
+            quint32 numChildren = 0;
+            stream >> numChildren;
+            if (isChild || stream.status() != QDataStream::Ok || numChildren == 0 ||
+                    numChildren > (quint32)stream.device()->bytesAvailable()) {
+                return nullptr;
+            }
+            btCompoundShape* compound = new btCompoundShape();
+            for (quint32 i = 0; i < numChildren; ++i) {
+                btTransform transform;
+                transform.setOrigin(readVector(stream));
+                float x, y, z, w;
+                stream >> x >> y >> z >> w;
+                transform.setRotation(btQuaternion(x, y, z, w));
+                btCollisionShape* child = readShape(stream, info, true);
+                if (!child) {
+                    ShapeFactory::deleteShape(compound);
+                    return nullptr;
+                }
+                compound->addChildShape(transform, child);
+            }
+            return compound;
+        }
+        case SERIALIZED_STATIC_MESH: {
+            if (info.getType() != SHAPE_TYPE_STATIC_MESH) {
+                return nullptr;
+            }
+            QByteArray serializedBvh;
+            stream >> serializedBvh;
+            if (stream.status() != QDataStream::Ok || serializedBvh.isEmpty()) {
+                return nullptr;
+            }
+            uint32_t size = (uint32_t)serializedBvh.size();
+            void* buffer = btAlignedAlloc(size, BVH_BUFFER_ALIGNMENT);
+            memcpy(buffer, serializedBvh.constData(), size);
+            btCollisionShape* mesh = ShapeFactory::createStaticMeshShape(info, buffer, size);
+            if (!mesh) {
+                btAlignedFree(buffer);
+            }
+            return mesh;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+static void writeHeader(QDataStream& stream, const ShapeInfo& info, const QByteArray& contentHash) {
+    stream << SHAPE_CACHE_MAGIC << (quint32)ShapeCache::CURRENT_VERSION << (quint8)sizeof(btScalar)
+        << (quint8)(QSysInfo::ByteOrder == QSysInfo::LittleEndian) << (quint8)info.getType()
+        << (quint64)info.getHash() << contentHash;
+}
+
+static bool readHeader(QDataStream& stream, const ShapeInfo& info, const QByteArray& contentHash) {
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint8 scalarSize = 0;
+    quint8 isLittleEndian = 0;
+    quint8 type = 0;
+    quint64 shapeHash = 0;
+    QByteArray fileContentHash;
+    stream >> magic >> version >> scalarSize >> isLittleEndian >> type >> shapeHash >> fileContentHash;
+    return stream.status() == QDataStream::Ok && magic == SHAPE_CACHE_MAGIC && version == ShapeCache::CURRENT_VERSION
+        && scalarSize == sizeof(btScalar) && isLittleEndian == (quint8)(QSysInfo::ByteOrder == QSysInfo::LittleEndian)
+        && type == (quint8)info.getType() && shapeHash == info.getHash() && fileContentHash == contentHash;
+}
+
+ShapeCache::ShapeCache(const std::string& dir, const std::string& ext) :
+    FileCache(dir, ext) { }
+
+bool ShapeCache::isCacheable(ShapeType type) {
+    return type == SHAPE_TYPE_STATIC_MESH || type == SHAPE_TYPE_COMPOUND || type == SHAPE_TYPE_SIMPLE_COMPOUND;
+}
+
+std::string ShapeCache::getKey(const ShapeInfo& info) {
+    return computeKey(info.getHash(), computeContentHash(info));
+}
+
+const btCollisionShape* ShapeCache::loadShape(const ShapeInfo& info) {
+    if (!isCacheable(info.getType())) {
+        return nullptr;
+    }
+    QByteArray contentHash = computeContentHash(info);
+    std::string key = computeKey(info.getHash(), contentHash);
+    cache::FilePointer file = getFile(key);
+    if (!file) {
+        ++_numMisses;
+        return nullptr;
+    }
+
+    QByteArray data;
+    QFile qFile(QString::fromStdString(file->getFilepath()));
+    if (qFile.open(QIODevice::ReadOnly)) {
+        data = qFile.readAll();
+    }
+    QDataStream stream(data);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    btCollisionShape* shape = nullptr;
+    QByteArray payload;
+    QByteArray checksum;
+    if (readHeader(stream, info, contentHash)) {
+        stream >> payload >> checksum;
+    }
+    if (stream.status() == QDataStream::Ok && stream.atEnd() && !payload.isEmpty() &&
+            checksum == computeChecksum(payload)) {
+        QDataStream payloadStream(payload);
+        payloadStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        shape = readShape(payloadStream, info, false);
+        if (shape && (payloadStream.status() != QDataStream::Ok || !payloadStream.atEnd())) {
+            ShapeFactory::deleteShape(shape);
+            shape = nullptr;
+        }
+    }
+    if (!shape) {
+        // it will be overwritten when the shape is rebuilt
+        qCWarning(physics) << "ShapeCache: ignoring invalid entry" << key.c_str();
+        ++_numMisses;
+        return nullptr;
+    }
+    ++_numHits;
+    return shape;
+}
+
+bool ShapeCache::saveShape(const ShapeInfo& info, const btCollisionShape* shape) {
+    if (!shape || !isCacheable(info.getType())) {
+        return false;
+    }
+    QByteArray payload;
+    {
+        QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+        payloadStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        if (!writeShape(payloadStream, shape, false)) {
+            return false;
+        }
+    }
+    QByteArray contentHash = computeContentHash(info);
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    writeHeader(stream, info, contentHash);
+    stream << payload << computeChecksum(payload);
+    const bool OVERWRITE_INVALID_ENTRY = true;
+    cache::FilePointer file = writeFile(data.constData(), Metadata(computeKey(info.getHash(), contentHash), data.size()),
+        OVERWRITE_INVALID_ENTRY);
+    return (bool)file;
+}
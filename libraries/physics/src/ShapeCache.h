@@ -0,0 +1,57 @@
+//
+//  ShapeCache.h
+//  libraries/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ShapeCache_h
+#define hifi_ShapeCache_h
+
+#include <atomic>
+#include <memory>
+
+#include <btBulletDynamicsCommon.h>
+
+#include <shared/FileCache.h>
+#include <ShapeInfo.h>
+
+// The ShapeCache keeps the expensive parts of mesh and hull shapes on disk so they don't have to be rebuilt every
+// session: the final points of each convex hull and the bounding volume hierarchy of static meshes.  Files are keyed
+// by the hash of the ShapeInfo and the hash of the points and indices it was built from, so a model that changes
+// at the same url gets a new entry.  Every file is validated against its key and the checksum of its contents before
+// it is used, and a bvh is checked against the mesh it is loaded for.  A file that doesn't match is ignored and rebuilt.  Loading and saving are blocking, the ShapeManager only calls them from its workers.
+
+class ShapeCache : public cache::FileCache {
+    Q_OBJECT
+
+public:
+    // Whenever a change is made to the serialized format that isn't backward compatible, this value should be
+    // incremented.  Files with another version are rebuilt and overwritten.
+    static const uint32_t CURRENT_VERSION;
+
+    ShapeCache(const std::string& dir, const std::string& ext);
+
+    static bool isCacheable(ShapeType type);
+    static std::string getKey(const ShapeInfo& info);
+
+    /// \return new shape if it was found in the cache and is valid, else nullptr
+    const btCollisionShape* loadShape(const ShapeInfo& info);
+
+    /// \return true if the shape was written to the cache
+    bool saveShape(const ShapeInfo& info, const btCollisionShape* shape);
+
+    uint32_t getNumHits() const { return _numHits; }
+    uint32_t getNumMisses() const { return _numMisses; }
+
+private:
+    std::atomic_uint _numHits { 0 };
+    std::atomic_uint _numMisses { 0 };
+};
+
+using ShapeCachePointer = std::shared_ptr<ShapeCache>;
+
+#endif // hifi_ShapeCache_h
@@ -16,6 +16,7 @@
 #include <SharedUtil.h> // for MILLIMETERS_PER_METER
 
 #include "BulletUtil.h"
+#include "ShapeCache.h"
 
 
 class StaticMeshShape : public btBvhTriangleMeshShape {
@@ -27,9 +28,29 @@ public:
         assert(_dataArray);
     }
 
+    // uses a bvh that was deserialized in place rather than building it, the shape owns the bvh buffer
+    StaticMeshShape(btTriangleIndexVertexArray* dataArray, btOptimizedBvh* bvh, void* bvhBuffer)
+    :   btBvhTriangleMeshShape(dataArray, true, false), _dataArray(dataArray), _bvhBuffer(bvhBuffer) {
+        assert(_dataArray);
+        assert(bvh && _bvhBuffer);
+        setOptimizedBvh(bvh);
+    }
+
     ~StaticMeshShape() {
+        if (_bvhBuffer) {
+            // the base class doesn't own the bvh, it was constructed in our buffer
+            m_bvh->~btOptimizedBvh();
+            m_bvh = nullptr;
+            btAlignedFree(_bvhBuffer);
+            _bvhBuffer = nullptr;
+        }
         assert(_dataArray);
-        IndexedMeshArray& meshes = _dataArray->getIndexedMeshArray();
+        deleteDataArray(_dataArray);
+        _dataArray = nullptr;
+    }
+
+    static void deleteDataArray(btTriangleIndexVertexArray* dataArray) {
+        IndexedMeshArray& meshes = dataArray->getIndexedMeshArray();
         for (int32_t i = 0; i < meshes.size(); ++i) {
             btIndexedMesh mesh = meshes[i];
             mesh.m_numTriangles = 0;
@@ -40,17 +61,75 @@ public:
             mesh.m_vertexBase = nullptr;
         }
         meshes.clear();
-        delete _dataArray;
-        _dataArray = nullptr;
+        delete dataArray;
     }
 
 private:
     // the StaticMeshShape owns its vertex/index data
     btTriangleIndexVertexArray* _dataArray;
+    void* _bvhBuffer { nullptr };
 };
 
 // the dataArray must be created before we create the StaticMeshShape
 
+// btOptimizedBvh::deSerializeInPlace() trusts the counts at the start of the buffer, this reads them first
+class SerializedBvh : public btOptimizedBvh {
+public:
+    static bool hasValidSize(const void* alignedBvhBuffer, uint32_t bufferSize) {
+        if (!alignedBvhBuffer || bufferSize < sizeof(btQuantizedBvh)) {
+            return false;
+        }
+        const btQuantizedBvh* bvh = static_cast<const btQuantizedBvh*>(alignedBvhBuffer);
+        int32_t numNodes = bvh->*(&SerializedBvh::m_curNodeIndex);
+        int32_t numSubtrees = bvh->*(&SerializedBvh::m_subtreeHeaderCount);
+        bool isQuantized = bvh->*(&SerializedBvh::m_useQuantization);
+        // the static meshes we build always use quantized nodes
+        if (!isQuantized || numNodes <= 0 || numSubtrees < 0 ||
+                (uint32_t)numNodes > bufferSize / sizeof(btQuantizedBvhNode) ||
+                (uint32_t)numSubtrees > bufferSize / sizeof(btBvhSubtreeInfo)) {
+            return false;
+        }
+        uint64_t expectedSize = (uint64_t)sizeof(btQuantizedBvh) + btQuantizedBvh::getAlignmentSerializationPadding() +
+            (uint64_t)numSubtrees * sizeof(btBvhSubtreeInfo) + (uint64_t)numNodes * sizeof(btQuantizedBvhNode);
+        return expectedSize == bufferSize;
+    }
+};
+
+// a bvh traversal follows the escape indices of the nodes and hands the triangles of the leaves to the mesh,
+// so they must all be within the bvh and the mesh it was loaded for
+static bool isValidBvh(btOptimizedBvh* bvh, btTriangleIndexVertexArray* dataArray) {
+    if (!bvh->isQuantized()) {
+        return false;
+    }
+    const QuantizedNodeArray& nodes = bvh->getQuantizedNodeArray();
+    const int32_t numNodes = nodes.size();
+    const IndexedMeshArray& meshes = dataArray->getIndexedMeshArray();
+    for (int32_t i = 0; i < numNodes; ++i) {
+        const btQuantizedBvhNode& node = nodes[i];
+        if (node.isLeafNode()) {
+            int32_t part = node.getPartId();
+            int32_t triangle = node.getTriangleIndex();
+            if (part < 0 || part >= meshes.size() || triangle < 0 || triangle >= meshes[part].m_numTriangles) {
+                return false;
+            }
+        } else {
+            int32_t escapeIndex = node.getEscapeIndex();
+            if (escapeIndex < 1 || escapeIndex > numNodes - i) {
+                return false;
+            }
+        }
+    }
+    const BvhSubtreeInfoArray& subtrees = bvh->getSubtreeInfoArray();
+    for (int32_t i = 0; i < subtrees.size(); ++i) {
+        const btBvhSubtreeInfo& subtree = subtrees[i];
+        if (subtree.m_rootNodeIndex < 0 || subtree.m_subtreeSize < 1 ||
+                subtree.m_subtreeSize > numNodes - subtree.m_rootNodeIndex) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // These are the same normalized directions used by the btShapeHull class.
 // 12 points for the face centers of a dodecahedron plus another 30 points
 // for the midpoints the edges, for a total of 42.
@@ -462,6 +541,26 @@ const btCollisionShape* ShapeFactory::createShapeFromInfo(const ShapeInfo& info)
     return shape;
 }
 
+btCollisionShape* ShapeFactory::createStaticMeshShape(const ShapeInfo& info, void* alignedBvhBuffer, uint32_t bufferSize) {
+    if (!SerializedBvh::hasValidSize(alignedBvhBuffer, bufferSize)) {
+        return nullptr;
+    }
+    btTriangleIndexVertexArray* dataArray = createStaticMeshArray(info);
+    if (!dataArray) {
+        return nullptr;
+    }
+    btOptimizedBvh* bvh = btOptimizedBvh::deSerializeInPlace(alignedBvhBuffer, bufferSize, false);
+    if (!bvh || !isValidBvh(bvh, dataArray)) {
+        if (bvh) {
+            // the buffer holds the nodes, the caller frees it
+            bvh->~btOptimizedBvh();
+        }
+        StaticMeshShape::deleteDataArray(dataArray);
+        return nullptr;
+    }
+    return new StaticMeshShape(dataArray, bvh, alignedBvhBuffer);
+}
+
 void ShapeFactory::deleteShape(const btCollisionShape* shape) {
     assert(shape);
     // ShapeFactory is responsible for deleting all shapes, even the const ones that are stored
@@ -484,6 +583,14 @@ void ShapeFactory::deleteShape(const btCollisionShape* shape) {
 }
 
 void ShapeFactory::Worker::run() {
-    shape = ShapeFactory::createShapeFromInfo(shapeInfo);
+    if (cache) {
+        shape = cache->loadShape(shapeInfo);
+    }
+    if (!shape) {
+        shape = ShapeFactory::createShapeFromInfo(shapeInfo);
+        if (shape && cache) {
+            cache->saveShape(shapeInfo, shape);
+        }
+    }
     emit submitWork(this);
 }
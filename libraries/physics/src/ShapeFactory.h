@@ -17,14 +17,22 @@
 #include <QObject>
 #include <QtCore/QRunnable>
 
+#include <memory>
+
 #include <ShapeInfo.h>
 
+class ShapeCache;
+
 // The ShapeFactory assembles and correctly disassembles btCollisionShapes.
 
 namespace ShapeFactory {
     const btCollisionShape* createShapeFromInfo(const ShapeInfo& info);
     void deleteShape(const btCollisionShape* shape);
 
+    // builds the mesh of a SHAPE_TYPE_STATIC_MESH around a serialized btOptimizedBvh instead of computing a new one.
+    // On success the shape takes ownership of the buffer, which must be allocated with btAlignedAlloc.
+    btCollisionShape* createStaticMeshShape(const ShapeInfo& info, void* alignedBvhBuffer, uint32_t bufferSize);
+
     class Worker : public QObject, public QRunnable {
         Q_OBJECT
     public:
@@ -32,6 +40,7 @@ namespace ShapeFactory {
         void run() override;
         ShapeInfo shapeInfo;
         const btCollisionShape* shape;
+        std::shared_ptr<ShapeCache> cache;
     signals:
         void submitWork(Worker*);
     };
@@ -12,8 +12,8 @@
 #include "ShapeManager.h"
 
 #include <glm/gtx/norm.hpp>
-#include <QThreadPool>
 
+#include <JobScheduler.h>
 #include <NumericalConstants.h>
 
 const int MAX_RING_SIZE = 256;
@@ -36,7 +36,11 @@ ShapeManager::~ShapeManager() {
     }
 }
 
-const btCollisionShape* ShapeManager::getShape(const ShapeInfo& info) {
+bool ShapeManager::canBuildOffThread(ShapeType type) const {
+    return type == SHAPE_TYPE_STATIC_MESH || (_shapeCache && ShapeCache::isCacheable(type));
+}
+
+const btCollisionShape* ShapeManager::getShape(const ShapeInfo& info, bool allowOffThread) {
     if (info.getType() == SHAPE_TYPE_NONE) {
         return nullptr;
     }
@@ -47,7 +51,7 @@ const btCollisionShape* ShapeManager::getShape(const ShapeInfo& info) {
         return shapeRef->shape;
     }
     const btCollisionShape* shape = nullptr;
-    if (info.getType() == SHAPE_TYPE_STATIC_MESH) {
+    if (info.getType() == SHAPE_TYPE_STATIC_MESH || (allowOffThread && canBuildOffThread(info.getType()))) {
         uint64_t hash = info.getHash();
 
         // bump the request count to the caller knows we're 
@@ -66,10 +70,11 @@ const btCollisionShape* ShapeManager::getShape(const ShapeInfo& info) {
                 worker->shapeInfo = info;
                 _deadWorker = nullptr;
             }
+            worker->cache = _shapeCache;
             // we will delete worker manually later
             worker->setAutoDelete(false);
             QObject::connect(worker, &ShapeFactory::Worker::submitWork, this, &ShapeManager::acceptWork);
-            QThreadPool::globalInstance()->start(worker);
+            JobScheduler::getInstance().submit(JobScheduler::Category::Shape, worker);
         }
         // else we're still waiting for the shape to be created on another thread
     } else {
@@ -277,6 +282,7 @@ void ShapeManager::acceptWork(ShapeFactory::Worker* worker) {
     // save this dead worker for later
     worker->shapeInfo.clear();
     worker->shape = nullptr;
+    worker->cache.reset();
     _deadWorker = worker;
     ++_workDeliveryCount;
 }
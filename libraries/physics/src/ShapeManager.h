@@ -22,6 +22,7 @@
 
 #include <ShapeInfo.h>
 
+#include "ShapeCache.h"
 #include "ShapeFactory.h"
 #include "HashKey.h"
 
@@ -46,6 +47,12 @@
 // doesn't delete it right away.  Instead it puts the shape's key on a list delete
 // later.  When that list grows big enough the ShapeManager will remove any matching
 // entries that still have zero ref-count.
+//
+// Static mesh shapes are expensive so they are always built on a worker thread: getShape()
+// returns nullptr and bumps the work request count, the shape can be fetched by key once the
+// work delivery count changes.  When the ShapeManager has a ShapeCache the workers load mesh
+// and hull shapes from disk before building them, and callers that can wait may let the hull
+// shapes go through the workers as well.
 
 
 class ShapeManager : public QObject {
@@ -55,8 +62,14 @@ public:
     ShapeManager();
     ~ShapeManager();
 
-    /// \return pointer to shape
-    const btCollisionShape* getShape(const ShapeInfo& info);
+    void setShapeCache(const ShapeCachePointer& cache) { _shapeCache = cache; }
+    const ShapeCachePointer& getShapeCache() const { return _shapeCache; }
+
+    /// \return true if getShape() builds shapes of this type on a worker when allowed to
+    bool canBuildOffThread(ShapeType type) const;
+
+    /// \return pointer to shape, or nullptr if it is being built on a worker
+    const btCollisionShape* getShape(const ShapeInfo& info, bool allowOffThread = false);
     const btCollisionShape* getShapeByKey(uint64_t key);
     bool hasShapeWithKey(uint64_t key) const;
 
@@ -107,6 +120,7 @@ private:
     uint32_t _ringIndex { 0 };
     std::atomic_uint _workRequestCount { 0 };
     std::atomic_uint _workDeliveryCount { 0 };
+    ShapeCachePointer _shapeCache;
 };
 
 #endif // hifi_ShapeManager_h
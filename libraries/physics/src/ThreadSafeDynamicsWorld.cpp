@@ -24,9 +24,10 @@
 ThreadSafeDynamicsWorld::ThreadSafeDynamicsWorld(
         btDispatcher* dispatcher,
         btBroadphaseInterface* pairCache,
-        btConstraintSolver* constraintSolver,
+        btConstraintSolverPoolMt* constraintSolverPool,
+        btConstraintSolver* constraintSolverMt,
         btCollisionConfiguration* collisionConfiguration)
-    :   btDiscreteDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration) {
+    :   btDiscreteDynamicsWorldMt(dispatcher, pairCache, constraintSolverPool, constraintSolverMt, collisionConfiguration) {
 }
 
 int ThreadSafeDynamicsWorld::stepSimulationWithSubstepCallback(btScalar timeStep, int maxSubSteps,
@@ -89,6 +90,11 @@ int ThreadSafeDynamicsWorld::stepSimulationWithSubstepCallback(btScalar timeStep
 
     clearForces();
 
+    // btDiscreteDynamicsWorldMt::stepSimulation() isn't called, do what it does after the step
+    if (btITaskScheduler* scheduler = btGetTaskScheduler()) {
+        scheduler->sleepWorkerThreadsHint();
+    }
+
     return subSteps;
 }
 
@@ -13,13 +13,13 @@
 
 #include <QMetaType>
 #include <QRunnable>
-#include <QThreadPool>
 
 #include <glm/gtx/transform.hpp>
 #include <glm/gtx/norm.hpp>
 
 #include <shared/QtHelpers.h>
 #include <GeometryUtil.h>
+#include <JobScheduler.h>
 #include <PathUtils.h>
 #include <PerfStat.h>
 #include <ViewFrustum.h>
@@ -40,6 +40,7 @@
 #include <Trace.h>
 
 #include <BlendshapeConstants.h>
+#include <BlendshapePacking.h>
 
 using namespace std;
 
@@ -1484,6 +1485,9 @@ void Model::updateClusterMatrices() {
 
     _needsUpdateClusterMatrices = false;
     const HFMModel& hfmModel = getHFMModel();
+    if (!_useDualQuaternionSkinning) {
+        _rig.getJointTransforms(_jointTransforms);
+    }
     for (int i = 0; i < (int) _meshStates.size(); i++) {
         MeshState& state = _meshStates[i];
         int meshIndex = i;
@@ -1499,7 +1503,9 @@ void Model::updateClusterMatrices() {
                 Transform::mult(clusterTransform, jointTransform, _rig.getAnimSkeleton()->getClusterBindMatricesOriginalValues(meshIndex, clusterIndex).inverseBindTransform);
                 state.clusterDualQuaternions[j] = Model::TransformDualQuaternion(clusterTransform);
             } else {
-                auto jointMatrix = _rig.getJointTransform(cluster.jointIndex);
+                static const glm::mat4 IDENTITY;
+                const glm::mat4& jointMatrix = (cluster.jointIndex >= 0 && cluster.jointIndex < (int)_jointTransforms.size()) ?
+                    _jointTransforms[cluster.jointIndex] : IDENTITY;
                 glm_mat4u_mul(jointMatrix, _rig.getAnimSkeleton()->getClusterBindMatricesOriginalValues(meshIndex, clusterIndex).inverseBindMatrix, state.clusterMatrices[j]);
             }
         }
@@ -1787,54 +1793,6 @@ public:
     }
 };
 
-static void packBlendshapeOffsetTo_Pos_F32_3xSN10_Nor_3xSN10_Tan_3xSN10(glm::uvec4& packed, const BlendshapeOffsetUnpacked& unpacked) {
-    float len = glm::compMax(glm::abs(unpacked.positionOffset));
-    glm::vec3 normalizedPos(unpacked.positionOffset);
-    if (len > 0.0f) {
-        normalizedPos /= len;
-    } else {
-        len = 1.0f;
-    }
-
-    packed = glm::uvec4(
-        glm::floatBitsToUint(len),
-        glm_packSnorm3x10_1x2(glm::vec4(normalizedPos, 0.0f)),
-        glm_packSnorm3x10_1x2(glm::vec4(unpacked.normalOffset, 0.0f)),
-        glm_packSnorm3x10_1x2(glm::vec4(unpacked.tangentOffset, 0.0f))
-    );
-}
-
-static void packBlendshapeOffsets_ref(BlendshapeOffsetUnpacked* unpacked, BlendshapeOffsetPacked* packed, int size) {
-    for (int i = 0; i < size; ++i) {
-        packBlendshapeOffsetTo_Pos_F32_3xSN10_Nor_3xSN10_Tan_3xSN10((*packed).packedPosNorTan, (*unpacked));
-        ++unpacked;
-        ++packed;
-    }
-}
-
-#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
-//
-// Runtime CPU dispatch
-//
-#include <CPUDetect.h>
-
-void packBlendshapeOffsets_AVX2(float (*unpacked)[9], uint32_t (*packed)[4], int size);
-
-static void packBlendshapeOffsets(BlendshapeOffsetUnpacked* unpacked, BlendshapeOffsetPacked* packed, int size) {
-    static bool _cpuSupportsAVX2 = cpuSupportsAVX2();
-    if (_cpuSupportsAVX2) {
-        static_assert(sizeof(BlendshapeOffsetUnpacked) == 9 * sizeof(float), "struct BlendshapeOffsetUnpacked size doesn't match.");
-        static_assert(sizeof(BlendshapeOffsetPacked) == 4 * sizeof(uint32_t), "struct BlendshapeOffsetPacked size doesn't match.");
-        packBlendshapeOffsets_AVX2((float(*)[9])unpacked, (uint32_t(*)[4])packed, size);
-    } else {
-        packBlendshapeOffsets_ref(unpacked, packed, size);
-    }
-}
-
-#else   // portable reference code
-static auto& packBlendshapeOffsets = packBlendshapeOffsets_ref;
-#endif
-
 class Blender : public QRunnable {
 public:
 
@@ -1856,6 +1814,43 @@ Blender::Blender(ModelPointer model, HFMModel::ConstPointer hfmModel, int blendN
     _blendshapeCoefficients(blendshapeCoefficients) {
 }
 
+// meshes with at least this many vertices are blended in parallel, in chunks of BLENDER_CHUNK_SIZE vertices.
+static const int PARALLEL_BLEND_MIN_VERTICES = 8192;
+static const int BLENDER_CHUNK_SIZE = 2048;
+
+static void accumulateBlendshape(const HFMBlendshape& blendshape, float vertexCoefficient, float normalCoefficient,
+                                 float* offsets, int stride, int begin, int end) {
+    const HFMSparseBlendshape& sparse = blendshape.sparse;
+    if (sparse.isEmpty()) {
+        // not built by the baker, fall back to the per-vertex offsets
+        for (int j = 0; j < blendshape.indices.size(); ++j) {
+            int index = blendshape.indices.at(j);
+            if (index < begin || index >= end) {
+                continue;
+            }
+            glm::vec3 position = blendshape.vertices.at(j) * vertexCoefficient;
+            glm::vec3 normal = blendshape.normals.at(j) * normalCoefficient;
+            glm::vec3 tangent = (j < blendshape.tangents.size()) ? blendshape.tangents.at(j) * normalCoefficient : glm::vec3(0.0f);
+            for (int c = 0; c < 3; c++) {
+                offsets[(HFMSparseBlendshape::PositionX + c) * stride + index] += position[c];
+                offsets[(HFMSparseBlendshape::NormalX + c) * stride + index] += normal[c];
+                offsets[(HFMSparseBlendshape::TangentX + c) * stride + index] += tangent[c];
+            }
+        }
+        return;
+    }
+
+    // skip the spans that end before this range
+    auto span = std::lower_bound(sparse.spans.cbegin(), sparse.spans.cend(), begin,
+        [](const HFMSparseBlendshape::Span& span, int index) { return span.start + span.count <= index; });
+    for (; span != sparse.spans.cend() && span->start < end; ++span) {
+        int first = std::max(span->start, begin);
+        int last = std::min(span->start + span->count, end);
+        accumulateBlendshapeOffsets(offsets + first, stride, sparse.data.data() + span->offset + (first - span->start),
+                                    sparse.numOffsets, vertexCoefficient, normalCoefficient, last - first);
+    }
+}
+
 void Blender::run() {
     DETAILED_PROFILE_RANGE_EX(simulation_animation, __FUNCTION__, 0xFFFF0000, 0, { { "url", _model->getURL().toString() } });
     int numBlendshapeOffsets = 0;  // number of offsets required for all meshes.
@@ -1878,8 +1873,15 @@ void Blender::run() {
     QVector<BlendshapeOffset> packedBlendshapeOffsets;
     packedBlendshapeOffsets.resize(numBlendshapeOffsets);
 
-    QVector<BlendshapeOffsetUnpacked> unpackedBlendshapeOffsets;
-    unpackedBlendshapeOffsets.resize(maxBlendshapeOffsets);    // reuse for all meshes
+    // unpacked offsets as one stream per component, reused for all meshes
+    std::vector<float> unpackedBlendshapeOffsets(HFMSparseBlendshape::NumStreams * maxBlendshapeOffsets);
+
+    struct ActiveBlendshape {
+        const HFMBlendshape* blendshape;
+        float vertexCoefficient;
+        float normalCoefficient;
+    };
+    std::vector<ActiveBlendshape> activeBlendshapes;
 
     int offset = 0;
     for (auto meshIter = _hfmModel->meshes.cbegin(); meshIter != _hfmModel->meshes.cend(); ++meshIter) {
@@ -1890,36 +1892,39 @@ void Blender::run() {
         int numVertsInMesh = meshIter->vertices.size();
         blendedMeshSizes.push_back(numVertsInMesh);
 
-        // initialize offsets to zero
-        memset(unpackedBlendshapeOffsets.data(), 0, numVertsInMesh * sizeof(BlendshapeOffsetUnpacked));
-
-        // for each blendshape in this mesh, accumulate the offsets into unpackedBlendshapeOffsets.
+        // find the blendshapes that contribute to this mesh, most coefficients of a face rig are zero at any given time.
         const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+        const float EPSILON = 0.0001f;
+        activeBlendshapes.clear();
         for (int i = 0, n = qMin(_blendshapeCoefficients.size(), meshIter->blendshapes.size()); i < n; i++) {
             float vertexCoefficient = _blendshapeCoefficients.at(i);
-            const float EPSILON = 0.0001f;
             if (vertexCoefficient < EPSILON) {
                 continue;
             }
+            activeBlendshapes.push_back({ &meshIter->blendshapes.at(i), vertexCoefficient, vertexCoefficient * NORMAL_COEFFICIENT_SCALE });
+        }
 
-            float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
-            const HFMBlendshape& blendshape = meshIter->blendshapes.at(i);
-            for (int j = 0; j < blendshape.indices.size(); ++j) {
-                int index = blendshape.indices.at(j);
-
-                auto& currentBlendshapeOffset = unpackedBlendshapeOffsets[index];
-                currentBlendshapeOffset.positionOffset += blendshape.vertices.at(j) * vertexCoefficient;
-                currentBlendshapeOffset.normalOffset += blendshape.normals.at(j) * normalCoefficient;
-                if (j < blendshape.tangents.size()) {
-                    currentBlendshapeOffset.tangentOffset += blendshape.tangents.at(j) * normalCoefficient;
-                }
+        // accumulate the offsets of a range of vertices, then convert them into packedBlendshapeOffsets for the gpu.
+        float* unpacked = unpackedBlendshapeOffsets.data();
+        BlendshapeOffset* packed = packedBlendshapeOffsets.data() + offset;
+        auto blendRange = [&](int begin, int end) {
+            for (int s = 0; s < HFMSparseBlendshape::NumStreams; s++) {
+                memset(unpacked + s * numVertsInMesh + begin, 0, (end - begin) * sizeof(float));
             }
-        }
+            for (const auto& active : activeBlendshapes) {
+                accumulateBlendshape(*active.blendshape, active.vertexCoefficient, active.normalCoefficient,
+                                     unpacked, numVertsInMesh, begin, end);
+            }
+            packBlendshapeOffsetsSoA(unpacked + begin, numVertsInMesh, packed + begin, end - begin);
+        };
 
-        // convert unpackedBlendshapeOffsets into packedBlendshapeOffsets for the gpu.
-        auto unpacked = unpackedBlendshapeOffsets.data();
-        auto packed = packedBlendshapeOffsets.data() + offset;
-        packBlendshapeOffsets(unpacked, packed, numVertsInMesh);
+        if (numVertsInMesh >= PARALLEL_BLEND_MIN_VERTICES && !activeBlendshapes.empty()) {
+            tbb::parallel_for(tbb::blocked_range<int>(0, numVertsInMesh, BLENDER_CHUNK_SIZE), [&](const tbb::blocked_range<int>& range) {
+                blendRange(range.begin(), range.end());
+            });
+        } else {
+            blendRange(0, numVertsInMesh);
+        }
 
         offset += numVertsInMesh;
     }
@@ -1934,8 +1939,8 @@ void Blender::run() {
 
 bool Model::maybeStartBlender() {
     if (isLoaded()) {
-        QThreadPool::globalInstance()->start(new Blender(getThisPointer(), getGeometry()->getConstHFMModelPointer(),
-                                                         ++_blendNumber, _blendshapeCoefficients));
+        JobScheduler::getInstance().submit(JobScheduler::Category::Blendshape,
+            new Blender(getThisPointer(), getGeometry()->getConstHFMModelPointer(), ++_blendNumber, _blendshapeCoefficients));
         return true;
     }
     return false;
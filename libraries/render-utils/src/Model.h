@@ -420,6 +420,7 @@ protected:
     bool _forceOffset { false };
 
     std::vector<MeshState> _meshStates;
+    std::vector<glm::mat4> _jointTransforms; // rig space, scratch for updateClusterMatrices()
 
     virtual void initJointStates();
 
@@ -26,6 +26,7 @@
 
 #include "ScriptEngines.h"
 #include "ScriptEngineLogging.h"
+#include "ScriptProgramCache.h"
 #include <QtCore/QTimer>
 
 const QString ScriptCache::STATUS_INLINE { "Inline" };
@@ -38,6 +39,7 @@ ScriptCache::ScriptCache(QObject* parent) {
 void ScriptCache::clearCache() {
     Lock lock(_containerLock);
     _scriptCache.clear();
+    ScriptProgramCache::invalidateAll();
 }
 
 void ScriptCache::clearATPScriptsFromCache() {
@@ -50,6 +52,7 @@ void ScriptCache::clearATPScriptsFromCache() {
             ++it;
         }
     }
+    ScriptProgramCache::invalidate(QUrl("atp:"));
 }
 
 void ScriptCache::deleteScript(const QUrl& unnormalizedURL) {
@@ -58,6 +61,10 @@ void ScriptCache::deleteScript(const QUrl& unnormalizedURL) {
     if (_scriptCache.contains(url)) {
         _scriptCache.remove(url);
     }
+    ScriptProgramCache::invalidate(url);
+    if (url != unnormalizedURL) {
+        ScriptProgramCache::invalidate(unnormalizedURL);
+    }
 }
 
 void ScriptCache::getScriptContents(const QString& scriptOrURL, contentAvailableCallback contentAvailable, bool forceDownload, int maxRetries) {
@@ -103,6 +110,10 @@ void ScriptCache::getScriptContents(const QString& scriptOrURL, contentAvailable
             return;
         }
     }
+    if (forceDownload) {
+        // the programs of the old contents won't be used again
+        ScriptProgramCache::invalidate(url);
+    }
     {
         auto& scriptRequest = _activeScriptRequests[url];
         bool alreadyWaiting = scriptRequest.scriptUsers.size() > 0;
@@ -11,6 +11,7 @@
 
 #include "ScriptEngine.h"
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
@@ -76,6 +77,7 @@
 #include "WebSocketClass.h"
 #include "RecordingScriptingInterface.h"
 #include "ScriptEngines.h"
+#include "ScriptProgramCache.h"
 #include "StackTestScriptingInterface.h"
 #include "ModelScriptingInterface.h"
 
@@ -103,6 +105,12 @@ static const QScriptValue::PropertyFlags READONLY_HIDDEN_PROP_FLAGS { READONLY_P
 
 static const bool HIFI_AUTOREFRESH_FILE_SCRIPTS { true };
 
+// the profiler contexts of code that doesn't run in a function of its own
+static const QString PROFILER_LOAD_FUNCTION { "(load)" };
+static const QString PROFILER_UPDATE_FUNCTION { "(update)" };
+static const QString PROFILER_ANONYMOUS_FUNCTION { "(anonymous)" };
+static const int MAX_CACHED_PROFILER_CONTEXTS { 4096 };
+
 Q_DECLARE_METATYPE(QScriptEngine::FunctionSignature)
 int functionSignatureMetaID = qRegisterMetaType<QScriptEngine::FunctionSignature>();
 
@@ -1225,23 +1233,29 @@ QScriptValue ScriptEngine::evaluate(const QString& sourceCode, const QString& fi
         return result;
     }
 
-    // Check syntax
-    auto syntaxError = lintScript(sourceCode, fileName);
-    if (syntaxError.isError()) {
-        if (!isEvaluating()) {
-            syntaxError.setProperty("detail", "evaluate");
-        }
-        raiseException(syntaxError);
-        maybeEmitUncaughtException("lint");
-        return syntaxError;
-    }
-    QScriptProgram program { sourceCode, fileName, lineNumber };
+    // the program cache only finds the scripts that were checked for syntax errors, not the modules it keeps unchecked
+    auto& programCache = ScriptProgramCache::get();
+    QScriptProgram program = programCache.find(sourceCode, fileName, lineNumber);
     if (program.isNull()) {
-        // can this happen?
-        auto err = makeError("could not create QScriptProgram for " + fileName);
-        raiseException(err);
-        maybeEmitUncaughtException("compile");
-        return err;
+        // Check syntax
+        auto syntaxError = lintScript(sourceCode, fileName);
+        if (syntaxError.isError()) {
+            if (!isEvaluating()) {
+                syntaxError.setProperty("detail", "evaluate");
+            }
+            raiseException(syntaxError);
+            maybeEmitUncaughtException("lint");
+            return syntaxError;
+        }
+        program = QScriptProgram { sourceCode, fileName, lineNumber };
+        if (program.isNull()) {
+            // can this happen?
+            auto err = makeError("could not create QScriptProgram for " + fileName);
+            raiseException(err);
+            maybeEmitUncaughtException("compile");
+            return err;
+        }
+        programCache.insert(program);
     }
 
     QScriptValue result;
@@ -1279,7 +1293,9 @@ void ScriptEngine::run() {
 
     {
         PROFILE_RANGE(script, _fileNameString);
+        auto previousContext = _profiler.enter(getProfilerContext(EntityItemID(), QUrl(), PROFILER_LOAD_FUNCTION));
         evaluate(_scriptContents, _fileNameString);
+        _profiler.leave(previousContext);
         maybeEmitUncaughtException(__FUNCTION__);
     }
 #ifdef _WIN32
@@ -1292,6 +1308,7 @@ void ScriptEngine::run() {
 
     clock::time_point startTime = clock::now();
     int thisFrame = 0;
+    auto updateProfilerContext = getProfilerContext(EntityItemID(), QUrl(), PROFILER_UPDATE_FUNCTION);
 
     auto nodeList = DependencyManager::get<NodeList>();
     auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
@@ -1396,7 +1413,9 @@ void ScriptEngine::run() {
                 auto preUpdate = clock::now();
                 {
                     PROFILE_RANGE(script, "ScriptUpdate");
+                    auto previousContext = _profiler.enter(updateProfilerContext);
                     emit update(deltaTime);
+                    _profiler.leave(previousContext);
                 }
                 auto postUpdate = clock::now();
                 auto elapsed = (postUpdate - preUpdate);
@@ -1447,11 +1466,11 @@ void ScriptEngine::run() {
 // NOTE: This is private because it must be called on the same thread that created the timers, which is why
 // we want to only call it in our own run "shutdown" processing.
 void ScriptEngine::stopAllTimers() {
-    QMutableHashIterator<QTimer*, CallbackData> i(_timerFunctionMap);
+    QMutableHashIterator<QObject*, CallbackData> i(_timerFunctionMap);
     int j {0};
     while (i.hasNext()) {
         i.next();
-        QTimer* timer = i.key();
+        QObject* timer = i.key();
         qCDebug(scriptengine) << getFilename() << "stopAllTimers[" << j++ << "]";
         stopTimer(timer);
     }
@@ -1459,14 +1478,14 @@ void ScriptEngine::stopAllTimers() {
 
 void ScriptEngine::stopAllTimersForEntityScript(const EntityItemID& entityID) {
      // We could maintain a separate map of entityID => QTimer, but someone will have to prove to me that it's worth the complexity. -HRS
-    QVector<QTimer*> toDelete;
-    QMutableHashIterator<QTimer*, CallbackData> i(_timerFunctionMap);
+    QVector<QObject*> toDelete;
+    QMutableHashIterator<QObject*, CallbackData> i(_timerFunctionMap);
     while (i.hasNext()) {
         i.next();
         if (i.value().definingEntityIdentifier != entityID) {
             continue;
         }
-        QTimer* timer = i.key();
+        QObject* timer = i.key();
         toDelete << timer; // don't delete while we're iterating. save it.
     }
     for (auto timer:toDelete) { // now reap 'em
@@ -1516,7 +1535,14 @@ void ScriptEngine::callAnimationStateHandler(QScriptValue callback, AnimVariantM
     }
 }
 
+void ScriptEngine::requestGarbageCollection() {
+    quint64 startTime = usecTimestampNow();
+    collectGarbage();
+    _profiler.addGarbageCollection(usecTimestampNow() - startTime);
+}
+
 void ScriptEngine::updateMemoryCost(const qint64& deltaSize) {
+    _profiler.addAllocation(deltaSize);
     if (deltaSize > 0) {
         // We've patched qt to fix https://highfidelity.atlassian.net/browse/BUGZ-46 on mac and windows only.
 #if defined(Q_OS_WIN) || defined(Q_OS_MAC)
@@ -1534,49 +1560,102 @@ void ScriptEngine::timerFired() {
         }
     }
 
-    QTimer* callingTimer = reinterpret_cast<QTimer*>(sender());
-    CallbackData timerData = _timerFunctionMap.value(callingTimer);
+    auto startTime = p_high_resolution_clock::now();
+    std::chrono::microseconds functionTime { 0 };
+
+    // Every timer that came due since the last time runs in this batch, in the order Qt would have fired them.  The
+    // timer functions can process events and so fire a nested batch, so the batch works on its own vector, only
+    // reusing the storage of the last one.
+    std::vector<TimerWheel::Key> dueTimers;
+    dueTimers.swap(_dueTimers);
+    dueTimers.clear();
+    _timerWheel.advance(_timerClock.elapsed(), dueTimers);
+    uint64_t numFiredTimers = 0;
+    for (auto key : dueTimers) {
+        QObject* timer = reinterpret_cast<QObject*>(key);
+        auto itr = _timerFunctionMap.find(timer);
+        if (itr == _timerFunctionMap.end()) {
+            // stopped by a timer earlier in the batch
+            continue;
+        }
+        CallbackData timerData = itr.value();
+
+        if (!_timerWheel.isActive(key)) {
+            // this timer is done, we can kill it
+            _timerFunctionMap.erase(itr);
+            timer->deleteLater();
+        }
 
-    if (!callingTimer->isActive()) {
-        // this timer is done, we can kill it
-        _timerFunctionMap.remove(callingTimer);
-        delete callingTimer;
+        // call the associated JS function, if it exists
+        if (timerData.function.isValid()) {
+            PROFILE_RANGE(script, __FUNCTION__);
+            auto preTimer = p_high_resolution_clock::now();
+            callWithEnvironment(timerData.definingEntityIdentifier, timerData.definingSandboxURL, timerData.function, timerData.function, QScriptValueList());
+            auto postTimer = p_high_resolution_clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(postTimer - preTimer);
+            _totalTimerExecution += elapsed;
+            functionTime += elapsed;
+        } else {
+            qCWarning(scriptengine) << "timerFired -- invalid function" << timerData.function.toVariant().toString();
+        }
+        ++numFiredTimers;
     }
+    _dueTimers.swap(dueTimers);
 
-    // call the associated JS function, if it exists
-    if (timerData.function.isValid()) {
-        PROFILE_RANGE(script, __FUNCTION__);
-        auto preTimer = p_high_resolution_clock::now();
-        callWithEnvironment(timerData.definingEntityIdentifier, timerData.definingSandboxURL, timerData.function, timerData.function, QScriptValueList());
-        auto postTimer = p_high_resolution_clock::now();
-        auto elapsed = (postTimer - preTimer);
-        _totalTimerExecution += std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
-    } else {
-        qCWarning(scriptengine) << "timerFired -- invalid function" << timerData.function.toVariant().toString();
+    scheduleTimers(_timerWheel.getNextExpiry());
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(p_high_resolution_clock::now() - startTime);
+    std::lock_guard<std::mutex> lock(_timerStatsMutex);
+    _timerStats.numTimers = _timerFunctionMap.size();
+    _timerStats.numFiredTimers += numFiredTimers;
+    _timerStats.overheadUsecs += std::max(elapsed - functionTime, std::chrono::microseconds(0)).count();
+    _timerStats.totalLatenessMsecs += _timerWheel.getLastTotalLatenessMsecs();
+    _timerStats.maxLatenessMsecs = std::max(_timerStats.maxLatenessMsecs, (quint64)_timerWheel.getLastMaxLatenessMsecs());
+}
+
+void ScriptEngine::scheduleTimers(int64_t expiry) {
+    if (expiry < 0) {
+        _timerWheelTimer->stop();
+        _timerWheelExpiry = -1;
+        return;
+    }
+    // the wheel timer is only moved when a timer is due sooner, so that starting many timers doesn't restart it each time
+    if (!_timerWheelTimer->isActive() || expiry < _timerWheelExpiry) {
+        _timerWheelExpiry = expiry;
+        _timerWheelTimer->start((int)std::max(expiry - _timerClock.elapsed(), (int64_t)0));
     }
 }
 
 QObject* ScriptEngine::setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot) {
-    // create the timer, add it to the map, and start it
-    QTimer* newTimer = new QTimer(this);
-    newTimer->setSingleShot(isSingleShot);
-
-    // The default timer type is not very accurate below about 200ms http://doc.qt.io/qt-5/qt.html#TimerType-enum
-    static const int MIN_TIMEOUT_FOR_COARSE_TIMER = 200;
-    if (intervalMS < MIN_TIMEOUT_FOR_COARSE_TIMER) {
-        newTimer->setTimerType(Qt::PreciseTimer);
-    }
+    auto startTime = p_high_resolution_clock::now();
 
-    connect(newTimer, &QTimer::timeout, this, &ScriptEngine::timerFired);
+    if (!_timerWheelTimer) {
+        // the wheel is on the milliseconds of _timerClock
+        _timerClock.start();
+        _timerWheelTimer = new QTimer(this);
+        _timerWheelTimer->setSingleShot(true);
+        // The default timer type is not very accurate below about 200ms http://doc.qt.io/qt-5/qt.html#TimerType-enum
+        _timerWheelTimer->setTimerType(Qt::PreciseTimer);
+        connect(_timerWheelTimer, &QTimer::timeout, this, &ScriptEngine::timerFired);
 
-    // make sure the timer stops when the script does
-    connect(this, &ScriptEngine::scriptEnding, newTimer, &QTimer::stop);
+        // make sure the timers stop when the script does
+        connect(this, &ScriptEngine::scriptEnding, _timerWheelTimer, &QTimer::stop);
+    }
 
+    // the handle given to the script
+    QObject* newTimer = new QObject(this);
 
     CallbackData timerData = { function, currentEntityIdentifier, currentSandboxURL };
     _timerFunctionMap.insert(newTimer, timerData);
 
-    newTimer->start(intervalMS);
+    int64_t now = _timerClock.elapsed();
+    _timerWheel.start(reinterpret_cast<TimerWheel::Key>(newTimer), intervalMS, isSingleShot, now);
+    scheduleTimers(now + std::max(intervalMS, 0));
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(p_high_resolution_clock::now() - startTime);
+    std::lock_guard<std::mutex> lock(_timerStatsMutex);
+    _timerStats.numTimers = _timerFunctionMap.size();
+    _timerStats.overheadUsecs += elapsed.count();
     return newTimer;
 }
 
@@ -1600,11 +1679,12 @@ QObject* ScriptEngine::setTimeout(const QScriptValue& function, int timeoutMS) {
     return setupTimerWithInterval(function, timeoutMS, true);
 }
 
-void ScriptEngine::stopTimer(QTimer *timer) {
+void ScriptEngine::stopTimer(QObject* timer) {
     if (_timerFunctionMap.contains(timer)) {
-        timer->stop();
+        _timerWheel.stop(reinterpret_cast<TimerWheel::Key>(timer));
         _timerFunctionMap.remove(timer);
-        delete timer;
+        // the timer may still be in the batch being run by timerFired(), so its handle must not be reused before then
+        timer->deleteLater();
     } else {
         qCDebug(scriptengine) << "stopTimer -- not in _timerFunctionMap" << timer;
     }
@@ -1906,7 +1986,7 @@ QScriptValue ScriptEngine::instantiateModule(const QScriptValue& module, const Q
         closure.setProperty("require", module.property("require"));
         closure.setProperty("__filename", modulePath, READONLY_HIDDEN_PROP_FLAGS);
         closure.setProperty("__dirname", QString(modulePath).replace(QRegExp("/[^/]*$"), ""), READONLY_HIDDEN_PROP_FLAGS);
-        result = evaluateInClosure(closure, { sourceCode, modulePath });
+        result = evaluateInClosure(closure, ScriptProgramCache::get().getProgram(sourceCode, modulePath));
     }
     maybeEmitUncaughtException(__FUNCTION__);
     return result;
@@ -2087,7 +2167,8 @@ void ScriptEngine::include(const QStringList& includeFiles, QScriptValue callbac
                         evaluate(contents, url.toString());
                     };
 
-                    doWithEnvironment(capturedEntityIdentifier, capturedSandboxURL, operation);
+                    doWithEnvironment(capturedEntityIdentifier, capturedSandboxURL, operation,
+                                      getProfilerContext(capturedEntityIdentifier, url, PROFILER_LOAD_FUNCTION));
                     if (hasUncaughtException()) {
                         emit unhandledException(cloneUncaughtException("evaluateInclude"));
                         clearExceptions();
@@ -2188,6 +2269,23 @@ void ScriptEngine::forwardHandlerCall(const EntityItemID& entityID, const QStrin
     }
 }
 
+QHash<EntityItemID, quint64> ScriptEngine::getEntityScriptRunTimes() const {
+    std::lock_guard<std::mutex> lock(_entityScriptRunTimesMutex);
+    return _entityScriptRunTimes;
+}
+
+ScriptEngine::TimerStats ScriptEngine::getTimerStats() const {
+    std::lock_guard<std::mutex> lock(_timerStatsMutex);
+    return _timerStats;
+}
+
+void ScriptEngine::resetTimerStats() {
+    std::lock_guard<std::mutex> lock(_timerStatsMutex);
+    int numTimers = _timerStats.numTimers;
+    _timerStats = TimerStats();
+    _timerStats.numTimers = numTimers;
+}
+
 int ScriptEngine::getNumRunningEntityScripts() const {
     QReadLocker locker { &_entityScriptsLock };
     int sum = 0;
@@ -2429,17 +2527,23 @@ void ScriptEngine::entityScriptContentAvailable(const EntityItemID& entityID, co
     }
 
     // SYNTAX ERRORS
-    auto syntaxError = lintScript(contents, fileName);
-    if (syntaxError.isError()) {
-        auto message = syntaxError.property("formatted").toString();
-        if (message.isEmpty()) {
-            message = syntaxError.toString();
-        }
-        setError(QString("Bad syntax (%1)").arg(message), EntityScriptStatus::ERROR_RUNNING_SCRIPT);
-        syntaxError.setProperty("detail", entityID.toString());
-        emit unhandledException(syntaxError);
-        return;
+    // (entities running the same script have it checked once, and cached for the evaluation below)
+    auto& programCache = ScriptProgramCache::get();
+    if (programCache.find(contents, fileName).isNull()) {
+        auto syntaxError = lintScript(contents, fileName);
+        if (syntaxError.isError()) {
+            auto message = syntaxError.property("formatted").toString();
+            if (message.isEmpty()) {
+                message = syntaxError.toString();
+            }
+            setError(QString("Bad syntax (%1)").arg(message), EntityScriptStatus::ERROR_RUNNING_SCRIPT);
+            syntaxError.setProperty("detail", entityID.toString());
+            emit unhandledException(syntaxError);
+            return;
+        }
+        programCache.insert(QScriptProgram { contents, fileName });
     }
+    // the sandbox gets a program of its own, so that the cached one keeps the code compiled by this engine
     QScriptProgram program { contents, fileName };
     if (program.isNull()) {
         setError("Bad program (isNull)", EntityScriptStatus::ERROR_RUNNING_SCRIPT);
@@ -2610,7 +2714,7 @@ void ScriptEngine::entityScriptContentAvailable(const EntityItemID& entityID, co
         }
     };
 
-    doWithEnvironment(entityID, sandboxURL, initialization);
+    doWithEnvironment(entityID, sandboxURL, initialization, getProfilerContext(entityID, sandboxURL, PROFILER_LOAD_FUNCTION));
 
     if (entityScriptObject.isError()) {
         auto exception = entityScriptObject;
@@ -2680,6 +2784,10 @@ void ScriptEngine::unloadEntityScript(const EntityItemID& entityID, bool shouldR
                 QWriteLocker locker { &_entityScriptsLock };
                 _entityScripts.remove(entityID);
             }
+            {
+                std::lock_guard<std::mutex> lock(_entityScriptRunTimesMutex);
+                _entityScriptRunTimes.remove(entityID);
+            }
             emit entityScriptDetailsUpdated();
         } else if (oldDetails.status != EntityScriptStatus::UNLOADED) {
             EntityScriptDetails newDetails;
@@ -2691,6 +2799,7 @@ void ScriptEngine::unloadEntityScript(const EntityItemID& entityID, bool shouldR
         }
 
         stopAllTimersForEntityScript(entityID);
+        removeProfilerContexts(entityID);
     }
 }
 
@@ -2768,11 +2877,18 @@ void ScriptEngine::refreshFileScript(const EntityItemID& entityID) {
 // Even if entityID is supplied as currentEntityIdentifier, this still documents the source
 // of the code being executed (e.g., if we ever sandbox different entity scripts, or provide different
 // global values for different entity scripts).
-void ScriptEngine::doWithEnvironment(const EntityItemID& entityID, const QUrl& sandboxURL, std::function<void()> operation) {
+void ScriptEngine::doWithEnvironment(const EntityItemID& entityID, const QUrl& sandboxURL, std::function<void()> operation,
+                                     ScriptProfiler::ContextID profilerContext) {
     EntityItemID oldIdentifier = currentEntityIdentifier;
     QUrl oldSandboxURL = currentSandboxURL;
     currentEntityIdentifier = entityID;
     currentSandboxURL = sandboxURL;
+    auto previousProfilerContext = _profiler.enter(profilerContext);
+
+    // calls into other entity scripts are charged to those scripts
+    quint64 startTime = usecTimestampNow();
+    quint64 outerNestedUsecs = _nestedEnvironmentUsecs;
+    _nestedEnvironmentUsecs = 0;
 
 #if DEBUG_CURRENT_ENTITY
     QScriptValue oldData = this->globalObject().property("debugEntityID");
@@ -2783,15 +2899,59 @@ void ScriptEngine::doWithEnvironment(const EntityItemID& entityID, const QUrl& s
     operation();
 #endif
     maybeEmitUncaughtException(!entityID.isNull() ? entityID.toString() : __FUNCTION__);
+    _profiler.leave(previousProfilerContext);
     currentEntityIdentifier = oldIdentifier;
     currentSandboxURL = oldSandboxURL;
+
+    quint64 elapsed = usecTimestampNow() - startTime;
+    if (!entityID.isNull()) {
+        std::lock_guard<std::mutex> lock(_entityScriptRunTimesMutex);
+        _entityScriptRunTimes[entityID] += elapsed - std::min(elapsed, _nestedEnvironmentUsecs);
+    }
+    _nestedEnvironmentUsecs = outerNestedUsecs + elapsed;
 }
 
 void ScriptEngine::callWithEnvironment(const EntityItemID& entityID, const QUrl& sandboxURL, QScriptValue function, QScriptValue thisObject, QScriptValueList args) {
     auto operation = [&]() {
         function.call(thisObject, args);
     };
-    doWithEnvironment(entityID, sandboxURL, operation);
+    doWithEnvironment(entityID, sandboxURL, operation, getProfilerContext(entityID, sandboxURL, function));
+}
+
+ScriptProfiler::ContextID ScriptEngine::getProfilerContext(const EntityItemID& entityID, const QUrl& sandboxURL,
+                                                           const QString& function) {
+    // the code of entity scripts is charged to the script of the entity, the rest to the script of the engine
+    return _profiler.getContext(sandboxURL.isEmpty() ? _fileNameString : sandboxURL.toString(), function, entityID);
+}
+
+ScriptProfiler::ContextID ScriptEngine::getProfilerContext(const EntityItemID& entityID, const QUrl& sandboxURL,
+                                                           const QScriptValue& function) {
+    QPair<qint64, QUuid> key(function.objectId(), entityID);
+    auto itr = _functionProfilerContexts.constFind(key);
+    if (itr != _functionProfilerContexts.constEnd()) {
+        return itr.value();
+    }
+
+    // functions made on the fly, such as the callbacks of Script.setTimeout(), each have an ID of their own
+    if (_functionProfilerContexts.size() >= MAX_CACHED_PROFILER_CONTEXTS) {
+        _functionProfilerContexts.clear();
+    }
+    QString name = function.property("name").toString();
+    auto context = getProfilerContext(entityID, sandboxURL, name.isEmpty() ? PROFILER_ANONYMOUS_FUNCTION : name);
+    _functionProfilerContexts.insert(key, context);
+    return context;
+}
+
+void ScriptEngine::removeProfilerContexts(const EntityItemID& entityID) {
+    // a script that is loaded again gets new contexts, the counts of the old ones go to ScriptProfiler::OTHER
+    for (auto itr = _functionProfilerContexts.begin(); itr != _functionProfilerContexts.end();) {
+        if (itr.key().second == entityID) {
+            itr = _functionProfilerContexts.erase(itr);
+        } else {
+            ++itr;
+        }
+    }
+    _profiler.removeEntityContexts(entityID);
 }
 
 void ScriptEngine::callEntityScriptMethod(const EntityItemID& entityID, const QString& methodName, const QStringList& params, const QUuid& remoteCallerID) {
@@ -13,9 +13,11 @@
 #ifndef hifi_ScriptEngine_h
 #define hifi_ScriptEngine_h
 
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
 #include <QtCore/QUrl>
 #include <QtCore/QSet>
@@ -44,10 +46,12 @@
 #include "Quat.h"
 #include "Mat4.h"
 #include "ScriptCache.h"
+#include "ScriptProfiler.h"
 #include "ScriptUUID.h"
 #include "Vec3.h"
 #include "ConsoleScriptingInterface.h"
 #include "SettingHandle.h"
+#include "TimerWheel.h"
 #include "Profile.h"
 
 class QScriptEngineDebugger;
@@ -507,7 +511,7 @@ public:
      *     Script.clearInterval(timer);
      * }, 10000);
      */
-    Q_INVOKABLE void clearInterval(QObject* timer) { stopTimer(reinterpret_cast<QTimer*>(timer)); }
+    Q_INVOKABLE void clearInterval(QObject* timer) { stopTimer(timer); }
 
     /*@jsdoc
      * Stops a timeout timer set by {@link Script.setTimeout|setTimeout}.
@@ -522,7 +526,7 @@ public:
      * // Uncomment the following line to stop the timer from firing.
      * //Script.clearTimeout(timer);
      */
-    Q_INVOKABLE void clearTimeout(QObject* timer) { stopTimer(reinterpret_cast<QTimer*>(timer)); }
+    Q_INVOKABLE void clearTimeout(QObject* timer) { stopTimer(timer); }
 
     /*@jsdoc
      * Prints a message to the program log and emits {@link Script.printedMessage}.
@@ -648,7 +652,24 @@ public:
      * reachable.
      * @function Script.requestGarbageCollection
      */
-    Q_INVOKABLE void requestGarbageCollection() { collectGarbage(); }
+    Q_INVOKABLE void requestGarbageCollection();
+
+    /*@jsdoc
+     * Gets the profile of the script engine since it started: the time spent running each function of each script, the
+     * calls made into them, and the garbage collections requested.
+     * <p>The profile is sampled every <code>sample_interval_msecs</code> milliseconds, so functions that run for less time
+     * than that only show up in proportion to how often they run.</p>
+     * @function Script.getProfile
+     * @returns {object} The profile, with the time spent in each context listed in <code>contexts</code>, from the most
+     *     to the least time spent.
+     * @example <caption>Report the functions that take the most time.</caption>
+     * var profile = Script.getProfile();
+     * for (var i = 0; i < Math.min(profile.contexts.length, 5); i++) {
+     *     var context = profile.contexts[i];
+     *     print(context.script, context.function, context.cpu_msecs + " ms", context.calls + " calls");
+     * }
+     */
+    Q_INVOKABLE QVariantMap getProfile() const { return getProfilerStats().toVariantMap(); }
 
     /*@jsdoc
      * @function Script.generateUUID
@@ -693,6 +714,25 @@ public:
     int getNumRunningEntityScripts() const;
     bool getEntityScriptDetails(const EntityItemID& entityID, EntityScriptDetails &details) const;
     bool hasEntityScriptDetails(const EntityItemID& entityID) const;
+    // usecs spent running the code of each entity script, not counting the calls it makes into other entity scripts
+    QHash<EntityItemID, quint64> getEntityScriptRunTimes() const;
+
+    class TimerStats {
+    public:
+        int numTimers { 0 };
+        quint64 numFiredTimers { 0 };
+        // time spent scheduling and dispatching the timers, not running their functions
+        quint64 overheadUsecs { 0 };
+        // how late the timers fired
+        quint64 totalLatenessMsecs { 0 };
+        quint64 maxLatenessMsecs { 0 };
+    };
+    // the stats of Script.setInterval() and Script.setTimeout() timers since the last resetTimerStats()
+    TimerStats getTimerStats() const;
+    void resetTimerStats();
+
+    // the profile of the script code run by the engine, see ScriptProfiler::toJson()
+    QJsonObject getProfilerStats(int maxContexts = -1) const { return _profiler.toJson(maxContexts); }
 
     void setScriptEngines(QSharedPointer<ScriptEngines>& scriptEngines) { _scriptEngines = scriptEngines; }
 
@@ -945,7 +985,8 @@ protected:
     void setParentURL(const QString& parentURL) { _parentURL = parentURL; }
 
     QObject* setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot);
-    void stopTimer(QTimer* timer);
+    void stopTimer(QObject* timer);
+    void scheduleTimers(int64_t expiry);
 
     QHash<EntityItemID, RegisteredEventHandlers> _registeredHandlers;
     void forwardHandlerCall(const EntityItemID& entityID, const QString& eventName, QScriptValueList eventHanderArgs);
@@ -964,8 +1005,12 @@ protected:
 
     EntityItemID currentEntityIdentifier; // Contains the defining entity script entity id during execution, if any. Empty for interface script execution.
     QUrl currentSandboxURL; // The toplevel url string for the entity script that loaded the code being executed, else empty.
-    void doWithEnvironment(const EntityItemID& entityID, const QUrl& sandboxURL, std::function<void()> operation);
+    void doWithEnvironment(const EntityItemID& entityID, const QUrl& sandboxURL, std::function<void()> operation,
+                           ScriptProfiler::ContextID profilerContext);
     void callWithEnvironment(const EntityItemID& entityID, const QUrl& sandboxURL, QScriptValue function, QScriptValue thisObject, QScriptValueList args);
+    ScriptProfiler::ContextID getProfilerContext(const EntityItemID& entityID, const QUrl& sandboxURL, const QString& function);
+    ScriptProfiler::ContextID getProfilerContext(const EntityItemID& entityID, const QUrl& sandboxURL, const QScriptValue& function);
+    void removeProfilerContexts(const EntityItemID& entityID);
 
     Context _context;
     Type _type;
@@ -975,10 +1020,25 @@ protected:
     std::atomic<bool> _isRunning { false };
     std::atomic<bool> _isStopping { false };
     bool _isInitialized { false };
-    QHash<QTimer*, CallbackData> _timerFunctionMap;
+    // The script timers are keyed by the handles given to the script, and run from a TimerWheel driven by a single
+    // QTimer, rather than a QTimer each.
+    QHash<QObject*, CallbackData> _timerFunctionMap;
+    TimerWheel _timerWheel;
+    QTimer* _timerWheelTimer { nullptr };
+    int64_t _timerWheelExpiry { -1 };
+    QElapsedTimer _timerClock;
+    std::vector<TimerWheel::Key> _dueTimers; // storage for the next batch of timerFired(), not used during a batch
+    mutable std::mutex _timerStatsMutex;
+    TimerStats _timerStats;
     QSet<QUrl> _includedURLs;
     mutable QReadWriteLock _entityScriptsLock { QReadWriteLock::Recursive };
     QHash<EntityItemID, EntityScriptDetails> _entityScripts;
+    mutable std::mutex _entityScriptRunTimesMutex;
+    QHash<EntityItemID, quint64> _entityScriptRunTimes;
+    quint64 _nestedEnvironmentUsecs { 0 };
+    ScriptProfiler _profiler;
+    // the profiler context of the functions called, by object ID of the function and entity
+    QHash<QPair<qint64, QUuid>, ScriptProfiler::ContextID> _functionProfilerContexts;
     EntityScriptContentAvailableMap _contentAvailableQueue;
 
     bool _isThreaded { false };
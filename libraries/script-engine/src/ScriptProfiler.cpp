@@ -0,0 +1,258 @@
+//
+//  ScriptProfiler.cpp
+//  libraries/script-engine/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ScriptProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#include <QtCore/QJsonArray>
+
+#include <UUID.h>
+
+namespace {
+
+// The thread that samples every profiler of the process.  It runs while there are profilers to sample.
+class Sampler {
+public:
+    static Sampler& get() {
+        // never destroyed, profilers may outlive the statics of the process
+        static Sampler* sampler = new Sampler();
+        return *sampler;
+    }
+
+    void add(ScriptProfiler* profiler) {
+        std::unique_lock<std::mutex> threadLock(_threadMutex);
+        std::unique_lock<std::mutex> lock(_mutex);
+        _profilers.push_back(profiler);
+        if (!_thread.joinable()) {
+            _isStopping = false;
+            _thread = std::thread([this] { run(); });
+        }
+    }
+
+    void remove(ScriptProfiler* profiler) {
+        // a thread that is stopping is joined before another one can be started
+        std::unique_lock<std::mutex> threadLock(_threadMutex);
+        std::thread thread;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _profilers.erase(std::remove(_profilers.begin(), _profilers.end(), profiler), _profilers.end());
+            if (!_profilers.empty()) {
+                return;
+            }
+            _isStopping = true;
+            thread.swap(_thread);
+        }
+        _condition.notify_one();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto nextSample = std::chrono::steady_clock::now();
+        while (!_isStopping) {
+            nextSample += std::chrono::milliseconds(ScriptProfiler::SAMPLE_INTERVAL_MSECS);
+            if (_condition.wait_until(lock, nextSample, [this] { return _isStopping; })) {
+                break;
+            }
+            for (auto profiler : _profilers) {
+                profiler->sample();
+            }
+        }
+    }
+
+    std::mutex _threadMutex;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::vector<ScriptProfiler*> _profilers;
+    std::thread _thread;
+    bool _isStopping { false };
+};
+
+}
+
+const QString ScriptProfiler::OTHER_FUNCTION = "(other)";
+
+ScriptProfiler::ScriptProfiler() {
+    _contexts.emplace_back();
+    _contexts.back().function = OTHER_FUNCTION;
+    Sampler::get().add(this);
+}
+
+ScriptProfiler::~ScriptProfiler() {
+    Sampler::get().remove(this);
+}
+
+QString ScriptProfiler::getKey(const QString& script, const QString& function, const QUuid& entityID) {
+    return script + '\n' + function + '\n' + entityID.toString();
+}
+
+ScriptProfiler::ContextID ScriptProfiler::getContext(const QString& script, const QString& function, const QUuid& entityID) {
+    QString key = getKey(script, function, entityID);
+    auto itr = _contextIDs.constFind(key);
+    if (itr != _contextIDs.constEnd()) {
+        return itr.value();
+    }
+    if (_freeContexts.empty() && (int)_contexts.size() >= MAX_CONTEXTS) {
+        return OTHER;
+    }
+
+    ContextID contextID;
+    {
+        std::unique_lock<std::mutex> lock(_contextsMutex);
+        if (!_freeContexts.empty()) {
+            contextID = _freeContexts.back();
+            _freeContexts.pop_back();
+        } else {
+            contextID = (ContextID)_contexts.size();
+            _contexts.emplace_back();
+        }
+        Context& context = _contexts[contextID];
+        context.isFree = false;
+        context.script = script;
+        context.function = function;
+        context.entityID = entityID;
+    }
+    _contextIDs.insert(key, contextID);
+    if (!entityID.isNull()) {
+        _entityContexts[entityID].push_back(contextID);
+    }
+    return contextID;
+}
+
+void ScriptProfiler::removeEntityContexts(const QUuid& entityID) {
+    auto itr = _entityContexts.find(entityID);
+    if (itr == _entityContexts.end()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_contextsMutex);
+    Context& other = _contexts[OTHER];
+    for (ContextID contextID : itr.value()) {
+        Context& context = _contexts[contextID];
+        _contextIDs.remove(getKey(context.script, context.function, context.entityID));
+        other.numSamples.fetch_add(context.numSamples.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        other.numCalls.fetch_add(context.numCalls.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        other.allocatedBytes.fetch_add(context.allocatedBytes.exchange(0, std::memory_order_relaxed),
+                                       std::memory_order_relaxed);
+        context.isFree = true;
+        context.script.clear();
+        context.function.clear();
+        context.entityID = QUuid();
+        _freeContexts.push_back(contextID);
+    }
+    _entityContexts.erase(itr);
+}
+
+ScriptProfiler::ContextID ScriptProfiler::enter(ContextID context) {
+    // only the engine thread appends contexts, so it can read them without the lock
+    _contexts[context].numCalls.fetch_add(1, std::memory_order_relaxed);
+    return _currentContext.exchange(context, std::memory_order_relaxed);
+}
+
+void ScriptProfiler::addAllocation(qint64 bytes) {
+    ContextID context = getCurrentContext();
+    if (context != IDLE && bytes > 0) {
+        _contexts[context].allocatedBytes.fetch_add((quint64)bytes, std::memory_order_relaxed);
+    }
+}
+
+void ScriptProfiler::addGarbageCollection(quint64 usecs) {
+    _numGarbageCollections.fetch_add(1, std::memory_order_relaxed);
+    _garbageCollectionUsecs.fetch_add(usecs, std::memory_order_relaxed);
+    if (usecs > _maxGarbageCollectionUsecs.load(std::memory_order_relaxed)) {
+        _maxGarbageCollectionUsecs.store(usecs, std::memory_order_relaxed);
+    }
+}
+
+void ScriptProfiler::sample() {
+    _numSamples.fetch_add(1, std::memory_order_relaxed);
+    ContextID context = getCurrentContext();
+    if (context != IDLE) {
+        std::unique_lock<std::mutex> lock(_contextsMutex);
+        // the engine may still be leaving a context it just freed
+        if (!_contexts[context].isFree) {
+            _contexts[context].numSamples.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+QJsonObject ScriptProfiler::toJson(int maxContexts) const {
+    class Snapshot {
+    public:
+        quint64 numSamples;
+        quint64 numCalls;
+        quint64 allocatedBytes;
+        QString script;
+        QString function;
+        QUuid entityID;
+    };
+
+    // the counts keep changing while we read them, and the contexts get reused, sort on a snapshot
+    std::vector<Snapshot> contexts;
+    quint64 numBusySamples = 0;
+    {
+        std::unique_lock<std::mutex> lock(_contextsMutex);
+        for (const auto& context : _contexts) {
+            if (context.isFree) {
+                continue;
+            }
+            quint64 numSamples = context.numSamples.load(std::memory_order_relaxed);
+            quint64 numCalls = context.numCalls.load(std::memory_order_relaxed);
+            quint64 allocatedBytes = context.allocatedBytes.load(std::memory_order_relaxed);
+            numBusySamples += numSamples;
+            if (&context == &_contexts[OTHER] && numSamples == 0 && numCalls == 0 && allocatedBytes == 0) {
+                continue;
+            }
+            contexts.push_back({ numSamples, numCalls, allocatedBytes, context.script, context.function, context.entityID });
+        }
+    }
+    std::stable_sort(contexts.begin(), contexts.end(), [](const Snapshot& a, const Snapshot& b) {
+        return a.numSamples > b.numSamples;
+    });
+    if (maxContexts >= 0 && (int)contexts.size() > maxContexts) {
+        contexts.resize(maxContexts);
+    }
+
+    QJsonArray contextsArray;
+    for (const auto& context : contexts) {
+        QJsonObject contextObject;
+        contextObject["script"] = context.script;
+        contextObject["function"] = context.function;
+        if (!context.entityID.isNull()) {
+            contextObject["entity"] = uuidStringWithoutCurlyBraces(context.entityID);
+        }
+        contextObject["samples"] = (double)context.numSamples;
+        contextObject["cpu_msecs"] = (double)(context.numSamples * SAMPLE_INTERVAL_MSECS);
+        contextObject["calls"] = (double)context.numCalls;
+        contextObject["allocated_bytes"] = (double)context.allocatedBytes;
+        contextsArray.append(contextObject);
+    }
+
+    QJsonObject garbageCollection;
+    garbageCollection["count"] = (double)_numGarbageCollections.load(std::memory_order_relaxed);
+    garbageCollection["total_usecs"] = (double)_garbageCollectionUsecs.load(std::memory_order_relaxed);
+    garbageCollection["max_usecs"] = (double)_maxGarbageCollectionUsecs.load(std::memory_order_relaxed);
+
+    QJsonObject profile;
+    profile["sample_interval_msecs"] = SAMPLE_INTERVAL_MSECS;
+    profile["samples"] = (double)_numSamples.load(std::memory_order_relaxed);
+    profile["busy_samples"] = (double)numBusySamples;
+    profile["garbage_collection"] = garbageCollection;
+    profile["contexts"] = contextsArray;
+    return profile;
+}
@@ -0,0 +1,107 @@
+//
+//  ScriptProfiler.h
+//  libraries/script-engine/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ScriptProfiler_h
+#define hifi_ScriptProfiler_h
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+#include <QtCore/QUuid>
+
+// A sampling profiler that attributes the time a ScriptEngine spends running script code to the script file, function
+// and entity that ran it.
+//
+// The engine thread publishes the context it is running with enter() and leave(), which are a couple of relaxed
+// atomic operations, and a single sampler thread shared by every profiler of the process counts a sample for the
+// current context of each profiler every SAMPLE_INTERVAL_MSECS.  That makes it cheap enough to leave on all the time.
+// Samples are taken on the wall clock, so a script blocked in a native call is still charged for the time it waits.
+//
+// An engine runs the scripts of many entities over its life, so the contexts are bounded: those of an entity are
+// dropped when its script unloads, and past MAX_CONTEXTS the new ones are all charged to a single OTHER context.  The
+// counts of the dropped contexts are added to OTHER too, so the totals of the profile still add up.
+class ScriptProfiler {
+public:
+    using ContextID = int;
+
+    static const int SAMPLE_INTERVAL_MSECS = 10;
+    static const int MAX_CONTEXTS = 4096;
+    // the engine isn't running any script code
+    static const ContextID IDLE = -1;
+    // the contexts that were dropped, or didn't fit
+    static const ContextID OTHER = 0;
+    static const QString OTHER_FUNCTION;
+
+    ScriptProfiler();
+    ~ScriptProfiler();
+
+    // The following are called on the engine thread only.
+
+    // returns the ID of the context, which is created on first use
+    ContextID getContext(const QString& script, const QString& function, const QUuid& entityID);
+    // Adds the counts of the contexts of the entity to OTHER and frees them, their IDs can be given to new contexts.
+    // Call it once the entity can't run any more code.
+    void removeEntityContexts(const QUuid& entityID);
+    // the contexts in use, OTHER included
+    int getNumContexts() const { return (int)_contexts.size() - (int)_freeContexts.size(); }
+
+    // Makes context the current one and counts a call to it.  Returns the context to leave() back to when the call
+    // is done, as calls nest.
+    ContextID enter(ContextID context);
+    void leave(ContextID previousContext) { _currentContext.store(previousContext, std::memory_order_relaxed); }
+    ContextID getCurrentContext() const { return _currentContext.load(std::memory_order_relaxed); }
+
+    // native memory reported by the engine is charged to the current context
+    void addAllocation(qint64 bytes);
+    void addGarbageCollection(quint64 usecs);
+
+    // Called on the sampler thread.
+    void sample();
+
+    // The profile since the engine started, with its contexts ordered by the number of samples.  maxContexts limits
+    // the number of contexts listed, -1 lists them all.  Can be called from any thread.
+    QJsonObject toJson(int maxContexts = -1) const;
+
+private:
+    class Context {
+    public:
+        bool isFree { false };
+        QString script;
+        QString function;
+        QUuid entityID;
+        std::atomic<quint64> numSamples { 0 };
+        std::atomic<quint64> numCalls { 0 };
+        std::atomic<quint64> allocatedBytes { 0 };
+    };
+
+    static QString getKey(const QString& script, const QString& function, const QUuid& entityID);
+
+    // Contexts are appended and freed by the engine thread, under the mutex.  They are never removed, so enter() can
+    // read them without the lock, but a free context is reused.
+    mutable std::mutex _contextsMutex;
+    std::deque<Context> _contexts;
+    // engine thread only
+    QHash<QString, ContextID> _contextIDs;
+    QHash<QUuid, std::vector<ContextID>> _entityContexts;
+    std::vector<ContextID> _freeContexts;
+
+    std::atomic<ContextID> _currentContext { IDLE };
+    std::atomic<quint64> _numSamples { 0 };
+    std::atomic<quint64> _numGarbageCollections { 0 };
+    std::atomic<quint64> _garbageCollectionUsecs { 0 };
+    std::atomic<quint64> _maxGarbageCollectionUsecs { 0 };
+};
+
+#endif // hifi_ScriptProfiler_h
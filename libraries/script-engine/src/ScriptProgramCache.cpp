@@ -0,0 +1,207 @@
+//
+//  ScriptProgramCache.cpp
+//  libraries/script-engine/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ScriptProgramCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QThreadStorage>
+
+namespace {
+
+// the URLs dropped from the ScriptCache, with the generation at which they were dropped
+class Invalidations {
+public:
+    static Invalidations& get() {
+        // never destroyed, the cache of the main thread may be dropped after the statics
+        static Invalidations* invalidations = new Invalidations();
+        return *invalidations;
+    }
+
+    // drops the URLs that every cache has applied, called with the mutex
+    void prune() {
+        quint64 appliedGeneration = generation;
+        for (quint64 cacheGeneration : cacheGenerations) {
+            appliedGeneration = std::min(appliedGeneration, cacheGeneration);
+        }
+        for (auto itr = urls.begin(); itr != urls.end();) {
+            if (itr.value() <= appliedGeneration) {
+                itr = urls.erase(itr);
+            } else {
+                ++itr;
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::atomic<quint64> generation { 0 };
+    quint64 allGeneration { 0 };
+    // URLs, or schemes followed by a colon
+    QHash<QString, quint64> urls;
+    // the generation each thread's cache has applied
+    QHash<const ScriptProgramCache*, quint64> cacheGenerations;
+};
+
+}
+
+ScriptProgramCache::Key::Key(const QString& sourceCode, const QString& fileName, int lineNumber) :
+    fileName(fileName),
+    lineNumber(lineNumber)
+{
+    QCryptographicHash hasher(QCryptographicHash::Sha1);
+    hasher.addData(reinterpret_cast<const char*>(sourceCode.constData()), sourceCode.size() * (int)sizeof(QChar));
+    sourceHash = hasher.result();
+}
+
+uint qHash(const ScriptProgramCache::Key& key, uint seed) {
+    return qHash(key.sourceHash, seed) ^ qHash(key.fileName, seed) ^ (uint)key.lineNumber;
+}
+
+ScriptProgramCache::ScriptProgramCache() {
+    auto& invalidations = Invalidations::get();
+    std::unique_lock<std::mutex> lock(invalidations.mutex);
+    // nothing to drop yet
+    _invalidationGeneration = invalidations.generation;
+    invalidations.cacheGenerations.insert(this, _invalidationGeneration);
+}
+
+ScriptProgramCache::~ScriptProgramCache() {
+    auto& invalidations = Invalidations::get();
+    std::unique_lock<std::mutex> lock(invalidations.mutex);
+    invalidations.cacheGenerations.remove(this);
+    invalidations.prune();
+}
+
+ScriptProgramCache& ScriptProgramCache::get() {
+    static QThreadStorage<ScriptProgramCache*> caches;
+    if (!caches.hasLocalData()) {
+        caches.setLocalData(new ScriptProgramCache());
+    }
+    return *caches.localData();
+}
+
+void ScriptProgramCache::invalidate(const QUrl& url) {
+    QString key = url.path().isEmpty() ? url.scheme() + ":" : url.toString();
+    auto& invalidations = Invalidations::get();
+    std::unique_lock<std::mutex> lock(invalidations.mutex);
+    invalidations.urls[key] = ++invalidations.generation;
+    // forgotten right away when no thread has a cache
+    invalidations.prune();
+}
+
+void ScriptProgramCache::invalidateAll() {
+    auto& invalidations = Invalidations::get();
+    std::unique_lock<std::mutex> lock(invalidations.mutex);
+    invalidations.allGeneration = ++invalidations.generation;
+    // the URLs dropped before are covered
+    invalidations.urls.clear();
+}
+
+int ScriptProgramCache::getNumInvalidatedURLs() {
+    auto& invalidations = Invalidations::get();
+    std::unique_lock<std::mutex> lock(invalidations.mutex);
+    return invalidations.urls.size();
+}
+
+QScriptProgram ScriptProgramCache::find(const QString& sourceCode, const QString& fileName, int lineNumber) {
+    applyInvalidations();
+    auto itr = findEntry({ sourceCode, fileName, lineNumber });
+    if (itr == _programs.end() || !itr.value().isChecked) {
+        ++_numMisses;
+        return QScriptProgram();
+    }
+    ++_numHits;
+    return itr.value().program;
+}
+
+void ScriptProgramCache::insert(const QScriptProgram& program) {
+    if (program.isNull()) {
+        return;
+    }
+    Key key { program.sourceCode(), program.fileName(), program.firstLineNumber() };
+    auto itr = findEntry(key);
+    if (itr != _programs.end()) {
+        // keep the program made by getProgram(), and the code compiled for it
+        itr.value().isChecked = true;
+        return;
+    }
+    insertEntry(key, program, true);
+}
+
+QScriptProgram ScriptProgramCache::getProgram(const QString& sourceCode, const QString& fileName, int lineNumber) {
+    applyInvalidations();
+    Key key { sourceCode, fileName, lineNumber };
+    auto itr = findEntry(key);
+    if (itr != _programs.end()) {
+        ++_numHits;
+        return itr.value().program;
+    }
+    ++_numMisses;
+    QScriptProgram program(sourceCode, fileName, lineNumber);
+    if (!program.isNull()) {
+        insertEntry(key, program, false);
+    }
+    return program;
+}
+
+void ScriptProgramCache::clear() {
+    _programs.clear();
+    _useOrder.clear();
+}
+
+ScriptProgramCache::Programs::iterator ScriptProgramCache::findEntry(const Key& key) {
+    auto itr = _programs.find(key);
+    if (itr != _programs.end()) {
+        _useOrder.splice(_useOrder.end(), _useOrder, itr.value().use);
+    }
+    return itr;
+}
+
+void ScriptProgramCache::insertEntry(const Key& key, const QScriptProgram& program, bool isChecked) {
+    if (_programs.size() >= MAX_PROGRAMS) {
+        _programs.remove(_useOrder.front());
+        _useOrder.pop_front();
+    }
+    _programs.insert(key, { program, isChecked, _useOrder.insert(_useOrder.end(), key) });
+}
+
+ScriptProgramCache::Programs::iterator ScriptProgramCache::eraseEntry(Programs::iterator itr) {
+    _useOrder.erase(itr.value().use);
+    return _programs.erase(itr);
+}
+
+void ScriptProgramCache::applyInvalidations() {
+    auto& invalidations = Invalidations::get();
+    if (invalidations.generation.load(std::memory_order_acquire) == _invalidationGeneration) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(invalidations.mutex);
+    if (invalidations.allGeneration > _invalidationGeneration) {
+        clear();
+    } else {
+        for (auto itr = _programs.begin(); itr != _programs.end();) {
+            const QString& fileName = itr.key().fileName;
+            quint64 urlGeneration = invalidations.urls.value(fileName, 0);
+            quint64 schemeGeneration = invalidations.urls.value(QUrl(fileName).scheme() + ":", 0);
+            if (urlGeneration > _invalidationGeneration || schemeGeneration > _invalidationGeneration) {
+                itr = eraseEntry(itr);
+            } else {
+                ++itr;
+            }
+        }
+    }
+    _invalidationGeneration = invalidations.generation;
+    invalidations.cacheGenerations.insert(this, _invalidationGeneration);
+    invalidations.prune();
+}
@@ -0,0 +1,102 @@
+//
+//  ScriptProgramCache.h
+//  libraries/script-engine/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ScriptProgramCache_h
+#define hifi_ScriptProgramCache_h
+
+#include <list>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QUrl>
+#include <QtScript/QScriptProgram>
+
+// Keeps the programs evaluated by the script engines of a thread, keyed by a hash of their source code, so that the many
+// entities of a domain that run the same script, or include the same libraries, have them checked and parsed once.  When
+// it is full, the program used least recently is dropped.  An engine reusing a program also reuses the code it compiled
+// for it, as long as no other engine has run the program since.
+//
+// The programs are only ever used on the thread of their cache: QScriptProgram isn't thread safe.  A cache is dropped
+// with its thread.
+//
+// As the programs are keyed by their contents, a script that changes gets a new program.  The old ones are dropped as
+// the ScriptCache drops the contents of their URL, see invalidate().
+class ScriptProgramCache {
+public:
+    ScriptProgramCache();
+    ~ScriptProgramCache();
+
+    static const int MAX_PROGRAMS = 1024;
+
+    // the cache of the calling thread
+    static ScriptProgramCache& get();
+
+    // Drops the programs of url, or of all the URLs with the scheme of url when it has no path, from the caches of
+    // every thread.  The caches of the other threads drop them the next time they are used, and the URL is forgotten
+    // once they all have.
+    static void invalidate(const QUrl& url);
+    static void invalidateAll();
+    // the URLs that the cache of some thread hasn't dropped the programs of yet
+    static int getNumInvalidatedURLs();
+
+    // Returns a null program if the source code isn't in the cache, or wasn't checked for syntax errors, so that the
+    // callers that check it can skip that when it is found.
+    QScriptProgram find(const QString& sourceCode, const QString& fileName, int lineNumber = 1);
+    // the program must have been checked for syntax errors
+    void insert(const QScriptProgram& program);
+    // Finds the program, checked or not, or makes and inserts it when it isn't in the cache.  For the callers that don't
+    // check the syntax of the program before running it.
+    QScriptProgram getProgram(const QString& sourceCode, const QString& fileName, int lineNumber = 1);
+
+    void clear();
+    int getNumPrograms() const { return _programs.size(); }
+    quint64 getNumHits() const { return _numHits; }
+    quint64 getNumMisses() const { return _numMisses; }
+
+private:
+    class Key {
+    public:
+        Key(const QString& sourceCode, const QString& fileName, int lineNumber);
+
+        bool operator==(const Key& other) const {
+            return lineNumber == other.lineNumber && fileName == other.fileName && sourceHash == other.sourceHash;
+        }
+
+        QByteArray sourceHash;
+        QString fileName;
+        int lineNumber;
+    };
+    friend uint qHash(const Key& key, uint seed);
+
+    using UseOrder = std::list<Key>;
+
+    class Entry {
+    public:
+        QScriptProgram program;
+        bool isChecked;
+        UseOrder::iterator use;
+    };
+    using Programs = QHash<Key, Entry>;
+
+    Programs::iterator findEntry(const Key& key);
+    void insertEntry(const Key& key, const QScriptProgram& program, bool isChecked);
+    Programs::iterator eraseEntry(Programs::iterator itr);
+    void applyInvalidations();
+
+    Programs _programs;
+    // least recently used first
+    UseOrder _useOrder;
+    quint64 _invalidationGeneration { 0 };
+    quint64 _numHits { 0 };
+    quint64 _numMisses { 0 };
+};
+
+#endif // hifi_ScriptProgramCache_h
@@ -0,0 +1,97 @@
+//
+//  BlendshapePacking.cpp
+//  libraries/shared/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BlendshapePacking.h"
+
+#include <glm/gtx/component_wise.hpp>
+
+#include "GLMHelpers.h"
+
+static const int NUM_BLENDSHAPE_STREAMS = 9;
+
+static void accumulateBlendshapeOffsets_ref(float* dst, int dstStride, const float* src, int srcStride,
+                                            float vertexCoefficient, float normalCoefficient, int size) {
+    for (int s = 0; s < NUM_BLENDSHAPE_STREAMS; s++) {
+        float coefficient = (s < 3) ? vertexCoefficient : normalCoefficient;
+        float* d = dst + s * dstStride;
+        const float* v = src + s * srcStride;
+        for (int i = 0; i < size; i++) {
+            d[i] += v[i] * coefficient;
+        }
+    }
+}
+
+static void packBlendshapeOffsetsSoA_ref(const float* unpacked, int stride, BlendshapeOffsetPacked* packed, int size) {
+    const float* p = unpacked;
+    const float* n = unpacked + 3 * stride;
+    const float* t = unpacked + 6 * stride;
+    for (int i = 0; i < size; i++) {
+        glm::vec3 position(p[i], p[i + stride], p[i + 2 * stride]);
+        glm::vec3 normal(n[i], n[i + stride], n[i + 2 * stride]);
+        glm::vec3 tangent(t[i], t[i + stride], t[i + 2 * stride]);
+
+        float len = glm::compMax(glm::abs(position));
+        if (len > 0.0f) {
+            position /= len;
+        } else {
+            len = 1.0f;
+        }
+
+        packed[i].packedPosNorTan = glm::uvec4(
+            glm::floatBitsToUint(len),
+            glm_packSnorm3x10_1x2(glm::vec4(position, 0.0f)),
+            glm_packSnorm3x10_1x2(glm::vec4(normal, 0.0f)),
+            glm_packSnorm3x10_1x2(glm::vec4(tangent, 0.0f))
+        );
+    }
+}
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+//
+// Runtime CPU dispatch
+//
+#include "CPUDetect.h"
+
+void accumulateBlendshapeOffsets_AVX2(float* dst, int dstStride, const float* src, int srcStride,
+                                      float vertexCoefficient, float normalCoefficient, int size);
+void packBlendshapeOffsetsSoA_AVX2(const float* unpacked, int stride, uint32_t (*packed)[4], int size);
+
+void accumulateBlendshapeOffsets(float* dst, int dstStride, const float* src, int srcStride,
+                                 float vertexCoefficient, float normalCoefficient, int size) {
+    static bool _cpuSupportsAVX2 = cpuSupportsAVX2();
+    if (_cpuSupportsAVX2) {
+        accumulateBlendshapeOffsets_AVX2(dst, dstStride, src, srcStride, vertexCoefficient, normalCoefficient, size);
+    } else {
+        accumulateBlendshapeOffsets_ref(dst, dstStride, src, srcStride, vertexCoefficient, normalCoefficient, size);
+    }
+}
+
+void packBlendshapeOffsetsSoA(const float* unpacked, int stride, BlendshapeOffsetPacked* packed, int size) {
+    static bool _cpuSupportsAVX2 = cpuSupportsAVX2();
+    if (_cpuSupportsAVX2) {
+        static_assert(sizeof(BlendshapeOffsetPacked) == 4 * sizeof(uint32_t), "struct BlendshapeOffsetPacked size doesn't match.");
+        packBlendshapeOffsetsSoA_AVX2(unpacked, stride, (uint32_t(*)[4])packed, size);
+    } else {
+        packBlendshapeOffsetsSoA_ref(unpacked, stride, packed, size);
+    }
+}
+
+#else   // portable reference code
+
+void accumulateBlendshapeOffsets(float* dst, int dstStride, const float* src, int srcStride,
+                                 float vertexCoefficient, float normalCoefficient, int size) {
+    accumulateBlendshapeOffsets_ref(dst, dstStride, src, srcStride, vertexCoefficient, normalCoefficient, size);
+}
+
+void packBlendshapeOffsetsSoA(const float* unpacked, int stride, BlendshapeOffsetPacked* packed, int size) {
+    packBlendshapeOffsetsSoA_ref(unpacked, stride, packed, size);
+}
+
+#endif
@@ -0,0 +1,28 @@
+//
+//  BlendshapePacking.h
+//  libraries/shared/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BlendshapePacking_h
+#define hifi_BlendshapePacking_h
+
+#include "BlendshapeConstants.h"
+
+//
+// Blendshape offsets in structure-of-arrays form: nine streams (position xyz, normal xyz, tangent xyz, in the order of
+// BlendshapeOffsetUnpacked), each stream "stride" floats after the previous one.
+//
+
+// dst += src * coefficient for size vertices, positions are scaled by vertexCoefficient, normals and tangents by normalCoefficient.
+void accumulateBlendshapeOffsets(float* dst, int dstStride, const float* src, int srcStride,
+                                 float vertexCoefficient, float normalCoefficient, int size);
+
+// packs size vertices of SoA offsets for the gpu, same output as packing the equivalent BlendshapeOffsetUnpacked.
+void packBlendshapeOffsetsSoA(const float* unpacked, int stride, BlendshapeOffsetPacked* packed, int size);
+
+#endif // hifi_BlendshapePacking_h
@@ -0,0 +1,336 @@
+//
+//  JobScheduler.cpp
+//  libraries/shared/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "JobScheduler.h"
+
+#include <chrono>
+
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+#include "NumericalConstants.h"
+#include "SharedUtil.h"
+
+// weight of the newest sample in the moving averages of wait and run times.
+static const float AVERAGE_TIMESCALE = 0.1f;
+
+// load priorities, in radians, above which a model is considered nearby and below which it is considered distant.
+// 0.2 radians is a 2m model at 10m, 0.02 radians the same model at 100m.
+static const float NEARBY_MODEL_LOAD_PRIORITY = 0.2f;
+static const float DISTANT_MODEL_LOAD_PRIORITY = 0.02f;
+
+class JobScheduler::Runner : public QRunnable {
+public:
+    Runner(JobScheduler* scheduler) : _scheduler(scheduler) {}
+    void run() override { _scheduler->runJobs(); }
+private:
+    JobScheduler* _scheduler;
+};
+
+bool JobScheduler::Job::cancel() {
+    int expected = Waiting;
+    if (_state.compare_exchange_strong(expected, Cancelled)) {
+        // nothing else touches the work of a cancelled job, so whatever it captured can go now rather than when the job
+        // reaches the front of its queue.
+        _work = nullptr;
+        return true;
+    }
+    return _state == Cancelled;
+}
+
+JobScheduler& JobScheduler::getInstance() {
+    static JobScheduler instance(QThreadPool::globalInstance());
+    return instance;
+}
+
+const char* JobScheduler::getCategoryName(Category category) {
+    switch (category) {
+        case Category::Blendshape: return "blendshape";
+        case Category::Animation: return "animation";
+        case Category::Model: return "model";
+        case Category::Shape: return "shape";
+        case Category::Sound: return "sound";
+        case Category::Texture: return "texture";
+        case Category::General: return "general";
+        default: return "unknown";
+    }
+}
+
+JobScheduler::Priority JobScheduler::getDefaultPriority(Category category) {
+    switch (category) {
+        case Category::Blendshape:
+            // visible every frame on nearby avatars
+            return Priority::High;
+        case Category::Texture:
+            // the bulk of the work on domain entry, and models render without them in the meantime
+            return Priority::Low;
+        default:
+            return Priority::Normal;
+    }
+}
+
+JobScheduler::Priority JobScheduler::getLoadingPriority(Category category, float loadPriority) {
+    if (category != Category::Model) {
+        return getDefaultPriority(category);
+    }
+    if (loadPriority >= NEARBY_MODEL_LOAD_PRIORITY) {
+        return Priority::High;
+    }
+    if (loadPriority < DISTANT_MODEL_LOAD_PRIORITY) {
+        return Priority::Low;
+    }
+    return Priority::Normal;
+}
+
+JobScheduler::JobScheduler(QThreadPool* pool) :
+    _pool(pool ? pool : QThreadPool::globalInstance())
+{
+    int numThreads = std::max(1, QThread::idealThreadCount());
+    for (int i = 0; i < NUM_CATEGORIES; i++) {
+        _categories[i].limit = numThreads;
+    }
+    // leave room for everything else while a domain's worth of textures and models are decoded.
+    _categories[(int)Category::Texture].limit = std::max(1, numThreads / 2);
+    _categories[(int)Category::Model].limit = std::max(1, numThreads / 2);
+}
+
+JobScheduler::~JobScheduler() {
+    cancelAll();
+}
+
+JobScheduler::JobPointer JobScheduler::submit(Category category, std::function<void()> work,
+                                              const std::vector<JobPointer>& dependencies) {
+    return submit(category, getDefaultPriority(category), std::move(work), dependencies);
+}
+
+JobScheduler::JobPointer JobScheduler::submit(Category category, Priority priority, std::function<void()> work,
+                                              const std::vector<JobPointer>& dependencies) {
+    return addJob(JobPointer(new Job(category, priority, std::move(work))), dependencies);
+}
+
+JobScheduler::JobPointer JobScheduler::submit(Category category, QRunnable* runnable, const std::vector<JobPointer>& dependencies) {
+    return submit(category, getDefaultPriority(category), runnable, dependencies);
+}
+
+JobScheduler::JobPointer JobScheduler::submit(Category category, Priority priority, QRunnable* runnable,
+                                              const std::vector<JobPointer>& dependencies) {
+    // As QThreadPool, autoDelete() is read once, when the runnable is submitted.  An auto deleted runnable is owned by
+    // the work function, so it goes away whether the job runs or is cancelled.  Any other runnable belongs to the caller,
+    // which may delete it as soon as run() returns, so it isn't touched after that.
+    if (runnable->autoDelete()) {
+        std::shared_ptr<QRunnable> holder(runnable);
+        return submit(category, priority, [holder] { holder->run(); }, dependencies);
+    }
+    return submit(category, priority, [runnable] { runnable->run(); }, dependencies);
+}
+
+void JobScheduler::setConcurrencyLimit(Category category, int maxRunning) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _categories[(int)category].limit = std::max(1, maxRunning);
+    startRunners();
+}
+
+int JobScheduler::getConcurrencyLimit(Category category) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _categories[(int)category].limit;
+}
+
+JobScheduler::JobPointer JobScheduler::addJob(JobPointer job, const std::vector<JobPointer>& dependencies) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& dependency : dependencies) {
+        if (!dependency) {
+            continue;
+        }
+        if (dependency->_done) {
+            if (dependency->isCancelled()) {
+                job->cancel();
+            }
+        } else {
+            dependency->_dependents.push_back(job);
+            job->_pendingDependencies++;
+        }
+    }
+
+    if (job->_pendingDependencies == 0) {
+        makeReady(job);
+        startRunners();
+    } else {
+        _categories[(int)job->_category].blocked++;
+    }
+    return job;
+}
+
+void JobScheduler::makeReady(const JobPointer& job) {
+    job->_readyTime = usecTimestampNow();
+    _queues[(int)job->_priority][(int)job->_category].push_back(job);
+}
+
+void JobScheduler::startRunners() {
+    int runnable = 0;
+    int running = 0;
+    for (int c = 0; c < NUM_CATEGORIES; c++) {
+        int queued = 0;
+        for (int p = 0; p < NUM_PRIORITIES; p++) {
+            queued += (int)_queues[p][c].size();
+        }
+        running += _categories[c].running;
+        runnable += std::min(queued, std::max(0, _categories[c].limit - _categories[c].running));
+    }
+
+    // each runner is either running a job, or about to take one
+    int maxRunners = std::min(std::max(1, _pool->maxThreadCount()), running + runnable);
+    while (_numRunners < maxRunners) {
+        _numRunners++;
+        _pool->start(new Runner(this));
+    }
+}
+
+JobScheduler::JobPointer JobScheduler::takeNextJob() {
+    for (int p = 0; p < NUM_PRIORITIES; p++) {
+        for (int i = 0; i < NUM_CATEGORIES; i++) {
+            int c = (_nextCategory + i) % NUM_CATEGORIES;
+            CategoryState& category = _categories[c];
+            auto& queue = _queues[p][c];
+            while (!queue.empty() && category.running < category.limit) {
+                JobPointer job = queue.front();
+                queue.pop_front();
+
+                int expected = Job::Waiting;
+                if (job->_state.compare_exchange_strong(expected, Job::Running)) {
+                    category.running++;
+                    float waitMsecs = (float)(usecTimestampNow() - job->_readyTime) / (float)USECS_PER_MSEC;
+                    category.averageWaitMsecs += AVERAGE_TIMESCALE * (waitMsecs - category.averageWaitMsecs);
+                    _nextCategory = (c + 1) % NUM_CATEGORIES;
+                    return job;
+                }
+
+                // cancelled while queued
+                job->_done = true;
+                category.cancelled++;
+                releaseDependents(job);
+            }
+        }
+    }
+    return JobPointer();
+}
+
+void JobScheduler::releaseDependents(const JobPointer& job) {
+    bool cancelled = job->isCancelled();
+    for (auto& dependent : job->_dependents) {
+        if (cancelled) {
+            dependent->cancel();
+        }
+        if (--dependent->_pendingDependencies == 0) {
+            _categories[(int)dependent->_category].blocked--;
+            makeReady(dependent);
+        }
+    }
+    job->_dependents.clear();
+}
+
+void JobScheduler::completeJob(const JobPointer& job, uint64_t startTime, uint64_t endTime) {
+    CategoryState& category = _categories[(int)job->_category];
+    category.running--;
+    category.completed++;
+    float runMsecs = (float)(endTime - startTime) / (float)USECS_PER_MSEC;
+    category.averageRunMsecs += AVERAGE_TIMESCALE * (runMsecs - category.averageRunMsecs);
+
+    job->_state = Job::Finished;
+    job->_done = true;
+    releaseDependents(job);
+}
+
+void JobScheduler::runJobs() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (JobPointer job = takeNextJob()) {
+        // more work may have become runnable than this runner can take on alone
+        startRunners();
+        lock.unlock();
+
+        uint64_t startTime = usecTimestampNow();
+        job->_work();
+        job->_work = nullptr;
+        uint64_t endTime = usecTimestampNow();
+
+        lock.lock();
+        completeJob(job, startTime, endTime);
+    }
+    _numRunners--;
+    _doneCondition.notify_all();
+}
+
+JobScheduler::CategoryStats JobScheduler::getStats(Category category) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const CategoryState& state = _categories[(int)category];
+    CategoryStats stats;
+    for (int p = 0; p < NUM_PRIORITIES; p++) {
+        stats.queued += (int)_queues[p][(int)category].size();
+    }
+    stats.blocked = state.blocked;
+    stats.running = state.running;
+    stats.limit = state.limit;
+    stats.completed = state.completed;
+    stats.cancelled = state.cancelled;
+    stats.averageWaitMsecs = state.averageWaitMsecs;
+    stats.averageRunMsecs = state.averageRunMsecs;
+    return stats;
+}
+
+QVariantMap JobScheduler::getStatsMap() const {
+    QVariantMap result;
+    for (int c = 0; c < NUM_CATEGORIES; c++) {
+        CategoryStats stats = getStats((Category)c);
+        QVariantMap categoryMap;
+        categoryMap["queued"] = stats.queued;
+        categoryMap["blocked"] = stats.blocked;
+        categoryMap["running"] = stats.running;
+        categoryMap["limit"] = stats.limit;
+        categoryMap["completed"] = (quint64)stats.completed;
+        categoryMap["cancelled"] = (quint64)stats.cancelled;
+        categoryMap["averageWaitMsecs"] = stats.averageWaitMsecs;
+        categoryMap["averageRunMsecs"] = stats.averageRunMsecs;
+        result[getCategoryName((Category)c)] = categoryMap;
+    }
+    return result;
+}
+
+void JobScheduler::cancelAll() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    bool drained = false;
+    while (!drained) {
+        // releasing the dependents of a cancelled job can queue more cancelled jobs, so repeat until nothing is left.
+        drained = true;
+        for (int p = 0; p < NUM_PRIORITIES; p++) {
+            for (int c = 0; c < NUM_CATEGORIES; c++) {
+                auto& queue = _queues[p][c];
+                while (!queue.empty()) {
+                    drained = false;
+                    JobPointer job = queue.front();
+                    queue.pop_front();
+                    job->cancel();
+                    job->_done = true;
+                    _categories[c].cancelled++;
+                    releaseDependents(job);
+                }
+            }
+        }
+    }
+}
+
+bool JobScheduler::waitForDone(int msecs) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto isDone = [this] { return _numRunners == 0; };
+    if (msecs < 0) {
+        _doneCondition.wait(lock, isDone);
+        return true;
+    }
+    return _doneCondition.wait_for(lock, std::chrono::milliseconds(msecs), isDone);
+}
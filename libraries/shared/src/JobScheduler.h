@@ -0,0 +1,167 @@
+//
+//  JobScheduler.h
+//  libraries/shared/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_JobScheduler_h
+#define hifi_JobScheduler_h
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QString>
+#include <QtCore/QVariantMap>
+
+class QRunnable;
+class QThreadPool;
+
+// Prioritized background job scheduler shared by the resource loaders (textures, models, animations, sounds, shapes)
+// and the blendshape Blender.  Jobs run on the global QThreadPool, but instead of going straight into its FIFO queue
+// they wait in per priority, per category queues so that:
+//   * higher priority categories (blendshapes, nearby models) are not stuck behind a flood of texture decodes,
+//   * each category can be limited to a number of concurrently running jobs,
+//   * jobs can be cancelled while still queued, e.g. when the resource that requested them is released,
+//   * a job can depend on other jobs, and only becomes runnable once they have all finished.
+class JobScheduler {
+public:
+    enum class Category : uint8_t {
+        Blendshape = 0,
+        Animation,
+        Model,
+        Shape,
+        Sound,
+        Texture,
+        General,
+        NumCategories
+    };
+
+    enum class Priority : uint8_t {
+        High = 0,
+        Normal,
+        Low,
+        NumPriorities
+    };
+
+    static const int NUM_CATEGORIES = (int)Category::NumCategories;
+    static const int NUM_PRIORITIES = (int)Priority::NumPriorities;
+
+    class Job {
+    public:
+        // cancels the job if it has not started running yet, returns false if it is too late.  The work function, and
+        // anything it captured, is released right away on the calling thread.
+        // jobs that depend on a cancelled job are cancelled as well.
+        bool cancel();
+
+        bool isCancelled() const { return _state == Cancelled; }
+        bool isFinished() const { return _state == Finished; }
+        Category getCategory() const { return _category; }
+        Priority getPriority() const { return _priority; }
+
+    private:
+        friend class JobScheduler;
+        enum State { Waiting = 0, Running, Finished, Cancelled };
+
+        Job(Category category, Priority priority, std::function<void()> work) :
+            _category(category), _priority(priority), _work(std::move(work)) {}
+
+        const Category _category;
+        const Priority _priority;
+        std::function<void()> _work;
+        std::atomic<int> _state { Waiting };
+
+        // guarded by the scheduler mutex
+        int _pendingDependencies { 0 };
+        bool _done { false };
+        std::vector<std::shared_ptr<Job>> _dependents;
+        uint64_t _readyTime { 0 };
+    };
+    using JobPointer = std::shared_ptr<Job>;
+
+    struct CategoryStats {
+        int queued { 0 };           // ready to run, waiting for a thread or for the category limit
+        int blocked { 0 };          // waiting on dependencies
+        int running { 0 };
+        int limit { 0 };
+        uint64_t completed { 0 };
+        uint64_t cancelled { 0 };
+        float averageWaitMsecs { 0.0f };  // time from ready to running
+        float averageRunMsecs { 0.0f };
+    };
+
+    static JobScheduler& getInstance();
+    static const char* getCategoryName(Category category);
+    static Priority getDefaultPriority(Category category);
+
+    // Priority of a resource's job given the resource's load priority, which for entities is the angle the entity
+    // subtends from the avatar (at most PI / 2) and for avatars is above that.  Close and large models go first, distant
+    // small ones wait behind everything else; other categories keep their default priority.
+    static Priority getLoadingPriority(Category category, float loadPriority);
+
+    JobScheduler(QThreadPool* pool = nullptr);
+    ~JobScheduler();
+
+    JobPointer submit(Category category, std::function<void()> work, const std::vector<JobPointer>& dependencies = {});
+    JobPointer submit(Category category, Priority priority, std::function<void()> work,
+                      const std::vector<JobPointer>& dependencies = {});
+
+    // Runs an existing QRunnable as a job.  As with QThreadPool, autoDelete() is read when the runnable is submitted: if it
+    // is set the runnable is deleted once the job has run or been cancelled, otherwise it is left to the caller.
+    JobPointer submit(Category category, QRunnable* runnable, const std::vector<JobPointer>& dependencies = {});
+    JobPointer submit(Category category, Priority priority, QRunnable* runnable,
+                      const std::vector<JobPointer>& dependencies = {});
+
+    // maximum number of jobs of this category running at once.
+    void setConcurrencyLimit(Category category, int maxRunning);
+    int getConcurrencyLimit(Category category) const;
+
+    CategoryStats getStats(Category category) const;
+    QVariantMap getStatsMap() const;
+
+    // cancels every job which hasn't started yet.
+    void cancelAll();
+
+    // waits until every running and runnable job is done, returns false on timeout.
+    bool waitForDone(int msecs = -1);
+
+private:
+    class Runner;
+
+    JobPointer addJob(JobPointer job, const std::vector<JobPointer>& dependencies);
+    void makeReady(const JobPointer& job);      // assumes _mutex is held
+    void startRunners();                        // assumes _mutex is held
+    JobPointer takeNextJob();                   // assumes _mutex is held
+    void completeJob(const JobPointer& job, uint64_t startTime, uint64_t endTime);
+    void releaseDependents(const JobPointer& job);  // assumes _mutex is held
+    void runJobs();
+
+    struct CategoryState {
+        int running { 0 };
+        int blocked { 0 };
+        int limit { 0 };
+        uint64_t completed { 0 };
+        uint64_t cancelled { 0 };
+        float averageWaitMsecs { 0.0f };
+        float averageRunMsecs { 0.0f };
+    };
+
+    QThreadPool* _pool;
+    mutable std::mutex _mutex;
+    std::condition_variable _doneCondition;
+    std::array<std::array<std::deque<JobPointer>, NUM_CATEGORIES>, NUM_PRIORITIES> _queues;
+    std::array<CategoryState, NUM_CATEGORIES> _categories;
+    int _numRunners { 0 };
+    int _nextCategory { 0 };    // round robin between categories of the same priority
+};
+
+#endif // hifi_JobScheduler_h
@@ -0,0 +1,178 @@
+//
+//  TimerWheel.cpp
+//  libraries/shared/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <limits>
+
+// timers further in the future than the wheel spans wait in the last slot they can reach and are placed again from there
+static const int64_t MAX_TIMER_DELTA = ((int64_t)1 << (TimerWheel::LEVEL_BITS * TimerWheel::NUM_LEVELS)) - 1;
+
+static int64_t slotSpan(int level) {
+    return (int64_t)1 << (TimerWheel::LEVEL_BITS * level);
+}
+
+static int slotIndex(int64_t tick, int level) {
+    return (int)((tick >> (TimerWheel::LEVEL_BITS * level)) & (TimerWheel::SLOTS_PER_LEVEL - 1));
+}
+
+TimerWheel::TimerWheel(int64_t nowMsecs) :
+    _currentTick(nowMsecs)
+{
+}
+
+void TimerWheel::start(Key key, int64_t intervalMsecs, bool isSingleShot, int64_t nowMsecs) {
+    if (_timers.empty()) {
+        // nothing can be due in the meantime, skip the ticks the wheel was idle for
+        _currentTick = std::max(_currentTick, nowMsecs);
+    }
+    Timer timer;
+    timer.interval = std::max(intervalMsecs, (int64_t)0);
+    timer.expiry = nowMsecs + timer.interval;
+    timer.sequence = _nextSequence++;
+    timer.isSingleShot = isSingleShot;
+    // a timer that was already running is replaced, its entry in the wheel is no longer live
+    _timers[key] = timer;
+    insert(key, timer, _currentTick + 1);
+}
+
+bool TimerWheel::stop(Key key) {
+    return _timers.erase(key) > 0;
+}
+
+void TimerWheel::clear() {
+    for (auto& level : _slots) {
+        for (auto& slot : level) {
+            slot.clear();
+        }
+    }
+    _timers.clear();
+}
+
+void TimerWheel::advance(int64_t nowMsecs, std::vector<Key>& dueKeys) {
+    _lastMaxLatenessMsecs = 0;
+    _lastTotalLatenessMsecs = 0;
+    if (_timers.empty()) {
+        _currentTick = std::max(_currentTick, nowMsecs);
+        return;
+    }
+
+    _dueTimers.clear();
+    while (_currentTick < nowMsecs) {
+        int64_t tick = ++_currentTick;
+
+        // bring the timers of the higher levels down as the lower levels wrap around, highest level first
+        for (int level = NUM_LEVELS - 1; level > 0; --level) {
+            if ((tick & (slotSpan(level) - 1)) == 0) {
+                cascade(level, tick);
+            }
+        }
+
+        Slot& slot = _slots[0][slotIndex(tick, 0)];
+        for (const auto& entry : slot) {
+            if (!isLive(entry)) {
+                continue;
+            }
+            auto itr = _timers.find(entry.key);
+            _dueTimers.emplace_back(itr->second, entry.key);
+            if (itr->second.isSingleShot) {
+                _timers.erase(itr);
+            }
+        }
+        slot.clear();
+    }
+
+    std::sort(_dueTimers.begin(), _dueTimers.end(), [](const std::pair<Timer, Key>& a, const std::pair<Timer, Key>& b) {
+        return a.first.expiry < b.first.expiry || (a.first.expiry == b.first.expiry && a.first.sequence < b.first.sequence);
+    });
+
+    for (auto& due : _dueTimers) {
+        Timer& timer = due.first;
+        int64_t lateness = nowMsecs - timer.expiry;
+        _lastMaxLatenessMsecs = std::max(_lastMaxLatenessMsecs, lateness);
+        _lastTotalLatenessMsecs += lateness;
+        dueKeys.push_back(due.second);
+
+        if (!timer.isSingleShot) {
+            // as Qt does, an interval timer keeps its phase unless it fell behind by a whole interval
+            timer.expiry += timer.interval;
+            if (timer.expiry <= nowMsecs) {
+                timer.expiry = nowMsecs + timer.interval;
+            }
+            timer.sequence = _nextSequence++;
+            _timers[due.second] = timer;
+            insert(due.second, timer, _currentTick + 1);
+        }
+    }
+}
+
+int64_t TimerWheel::getNextExpiry() const {
+    if (_timers.empty()) {
+        return -1;
+    }
+    int64_t baseTick = _currentTick + 1;
+    int64_t nextExpiry = std::numeric_limits<int64_t>::max();
+    for (int level = 0; level < NUM_LEVELS; ++level) {
+        // the slots of the higher levels are due when they cascade, which is never later than the expiry of their timers
+        int64_t firstSlot = baseTick >> (LEVEL_BITS * level);
+        for (int64_t i = 0; i <= SLOTS_PER_LEVEL; ++i) {
+            int64_t slotTick = (firstSlot + i) << (LEVEL_BITS * level);
+            if (slotTick < baseTick) {
+                continue;
+            }
+            if (slotTick >= nextExpiry) {
+                break;
+            }
+            if (hasLiveEntries(_slots[level][slotIndex(slotTick, level)])) {
+                nextExpiry = slotTick;
+                break;
+            }
+        }
+    }
+    return nextExpiry;
+}
+
+void TimerWheel::insert(Key key, const Timer& timer, int64_t baseTick) {
+    int64_t expiry = std::max(timer.expiry, baseTick);
+    int64_t delta = expiry - baseTick;
+    int level = 0;
+    while (level < NUM_LEVELS - 1 && delta >= slotSpan(level + 1)) {
+        ++level;
+    }
+    if (delta > MAX_TIMER_DELTA) {
+        expiry = baseTick + MAX_TIMER_DELTA;
+    }
+    _slots[level][slotIndex(expiry, level)].push_back({ key, timer.sequence });
+}
+
+void TimerWheel::cascade(int level, int64_t tick) {
+    Slot entries;
+    entries.swap(_slots[level][slotIndex(tick, level)]);
+    for (const auto& entry : entries) {
+        if (isLive(entry)) {
+            insert(entry.key, _timers[entry.key], tick);
+        }
+    }
+}
+
+bool TimerWheel::isLive(const Entry& entry) const {
+    auto itr = _timers.find(entry.key);
+    return itr != _timers.end() && itr->second.sequence == entry.sequence;
+}
+
+bool TimerWheel::hasLiveEntries(const Slot& slot) const {
+    for (const auto& entry : slot) {
+        if (isLive(entry)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,88 @@
+//
+//  TimerWheel.h
+//  libraries/shared/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TimerWheel_h
+#define hifi_TimerWheel_h
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+// A hierarchical timer wheel with a resolution of one millisecond.  Starting and stopping a timer is constant time, and
+// advance() collects every timer that came due since the last call in one batch, so that a single system timer can
+// drive thousands of script timers.
+//
+// Timers are identified by a key chosen by the caller.  Due timers are returned in the order of their expiry, and
+// timers that expire on the same millisecond in the order they were started, as Qt fires its timers.
+class TimerWheel {
+public:
+    using Key = uint64_t;
+
+    static const int LEVEL_BITS = 6;
+    static const int SLOTS_PER_LEVEL = 1 << LEVEL_BITS;
+    static const int NUM_LEVELS = 4;
+
+    TimerWheel(int64_t nowMsecs = 0);
+
+    // (re)starts the timer of key, to expire intervalMsecs after nowMsecs.  nowMsecs must not be earlier than the
+    // last time the wheel was advanced to.
+    void start(Key key, int64_t intervalMsecs, bool isSingleShot, int64_t nowMsecs);
+    bool stop(Key key);
+    bool isActive(Key key) const { return _timers.find(key) != _timers.end(); }
+    void clear();
+
+    // Appends the keys of the timers due by nowMsecs to dueKeys.  Single shot timers are removed from the wheel and
+    // interval timers are restarted, so keys stopped by the callbacks of earlier timers in the batch should be skipped.
+    void advance(int64_t nowMsecs, std::vector<Key>& dueKeys);
+
+    // the earliest time at which advance() may have something to do, or -1 if there are no timers
+    int64_t getNextExpiry() const;
+
+    int getNumTimers() const { return (int)_timers.size(); }
+
+    // how late the timers returned by the last advance() were, relative to their expiry
+    int64_t getLastMaxLatenessMsecs() const { return _lastMaxLatenessMsecs; }
+    int64_t getLastTotalLatenessMsecs() const { return _lastTotalLatenessMsecs; }
+
+private:
+    class Timer {
+    public:
+        int64_t expiry;
+        int64_t interval;
+        uint64_t sequence;
+        bool isSingleShot;
+    };
+
+    // stopped timers are dropped lazily: an entry is live only while the timer of its key has the same sequence
+    class Entry {
+    public:
+        Key key;
+        uint64_t sequence;
+    };
+    using Slot = std::vector<Entry>;
+
+    void insert(Key key, const Timer& timer, int64_t baseTick);
+    void cascade(int level, int64_t tick);
+    bool isLive(const Entry& entry) const;
+    bool hasLiveEntries(const Slot& slot) const;
+
+    Slot _slots[NUM_LEVELS][SLOTS_PER_LEVEL];
+    std::unordered_map<Key, Timer> _timers;
+    int64_t _currentTick; // the last millisecond processed by advance()
+    uint64_t _nextSequence { 0 };
+
+    // reused by advance()
+    std::vector<std::pair<Timer, Key>> _dueTimers;
+
+    int64_t _lastMaxLatenessMsecs { 0 };
+    int64_t _lastTotalLatenessMsecs { 0 };
+};
+
+#endif // hifi_TimerWheel_h
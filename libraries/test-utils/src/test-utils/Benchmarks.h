@@ -0,0 +1,26 @@
+//
+//  Benchmarks.h
+//  libraries/test-utils/src/test-utils
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_Benchmarks_h
+#define hifi_Benchmarks_h
+
+#include <QtCore/QtGlobal>
+#include <QtTest/QtTest>
+
+// Benchmarks build large synthetic data sets and take long enough to slow every ctest run down, so they are skipped
+// unless the HIFI_RUN_BENCHMARKS environment variable is set.  Use it first thing in the test function.
+#define QSKIP_UNLESS_BENCHMARKING()                               \
+    do {                                                          \
+        if (qEnvironmentVariableIsEmpty("HIFI_RUN_BENCHMARKS")) { \
+            QSKIP("set HIFI_RUN_BENCHMARKS to run");              \
+        }                                                         \
+    } while (false)
+
+#endif // hifi_Benchmarks_h
@@ -0,0 +1,77 @@
+//
+//  RegionClassifier_avx2.cpp
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifdef __AVX2__
+
+#include <stdint.h>
+#include <immintrin.h>
+
+// must match workload::Region
+enum { R1 = 0, R2, R3, R4, NUM_TRACKED_REGIONS = R4 };
+
+void classifyProxies_AVX2(const float* x, const float* y, const float* z, const float* radius, int begin, int end,
+                          const float* regionSpheres, int numViews, uint8_t* regions) {
+    int i = begin;
+    for (; i < end - 7; i += 8) {  // blocks of 8
+
+        __m256 px = _mm256_loadu_ps(&x[i]);
+        __m256 py = _mm256_loadu_ps(&y[i]);
+        __m256 pz = _mm256_loadu_ps(&z[i]);
+        __m256 pr = _mm256_loadu_ps(&radius[i]);
+
+        __m256i region = _mm256_set1_epi32(R4);
+        for (int j = 0; j < numViews; ++j) {
+            const float* spheres = &regionSpheres[4 * NUM_TRACKED_REGIONS * j];
+
+            // the lowest region touched wins, so test from the outermost in
+            __m256i viewRegion = _mm256_set1_epi32(R4);
+            for (int k = NUM_TRACKED_REGIONS - 1; k >= 0; --k) {
+                const float* sphere = &spheres[4 * k];
+                __m256 dx = _mm256_sub_ps(px, _mm256_set1_ps(sphere[0]));
+                __m256 dy = _mm256_sub_ps(py, _mm256_set1_ps(sphere[1]));
+                __m256 dz = _mm256_sub_ps(pz, _mm256_set1_ps(sphere[2]));
+                // same order of operations as the reference, without fma
+                __m256 distance2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                                                 _mm256_mul_ps(dz, dz));
+                __m256 touchDistance = _mm256_add_ps(pr, _mm256_set1_ps(sphere[3]));
+                __m256 touches = _mm256_cmp_ps(distance2, _mm256_mul_ps(touchDistance, touchDistance), _CMP_LT_OQ);
+                viewRegion = _mm256_blendv_epi8(viewRegion, _mm256_set1_epi32(k), _mm256_castps_si256(touches));
+            }
+            region = _mm256_min_epi32(region, viewRegion);
+        }
+
+        // pack 8x32 to 8x8
+        __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(region), _mm256_extracti128_si256(region, 1));
+        packed = _mm_packus_epi16(packed, packed);
+        _mm_storel_epi64((__m128i*)&regions[i], packed);
+    }
+
+    for (; i < end; i++) {  // remainder
+        uint8_t region = R4;
+        for (int j = 0; j < numViews; ++j) {
+            const float* spheres = &regionSpheres[4 * NUM_TRACKED_REGIONS * j];
+            for (int k = 0; k < region; ++k) {
+                const float* sphere = &spheres[4 * k];
+                float dx = x[i] - sphere[0];
+                float dy = y[i] - sphere[1];
+                float dz = z[i] - sphere[2];
+                float touchDistance = radius[i] + sphere[3];
+                if (dx * dx + dy * dy + dz * dz < touchDistance * touchDistance) {
+                    region = (uint8_t)k;
+                    break;
+                }
+            }
+        }
+        regions[i] = region;
+    }
+
+    _mm256_zeroupper();
+}
+
+#endif
@@ -0,0 +1,229 @@
+//
+//  ProxyGrid.cpp
+//  libraries/workload/src/workload
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ProxyGrid.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "RegionClassifier.h"
+
+using namespace workload;
+
+// cell coordinates are packed in 21 bits each
+static const int64_t MAX_CELL_COORDINATE = (1 << 20) - 1;
+// proxies beyond the range of the grid, or with NaN coordinates, share a cell that is always tested
+static const uint64_t OVERFLOW_CELL_KEY = (uint64_t)-1;
+
+static bool computeCellCoordinate(float value, float cellSize, int64_t& cellCoordinate) {
+    float coordinate = floorf(value / cellSize);
+    if (!(coordinate > (float)(-MAX_CELL_COORDINATE) && coordinate < (float)MAX_CELL_COORDINATE)) {
+        return false;
+    }
+    cellCoordinate = (int64_t)coordinate;
+    return true;
+}
+
+void ProxyGrid::setCellSize(float cellSize) {
+    clear();
+    _cellSize = std::max(cellSize, 0.0f);
+    _cellHalfDiagonal = 0.5f * sqrtf(3.0f) * _cellSize;
+}
+
+void ProxyGrid::insert(int32_t proxyID, const Sphere& sphere) {
+    if (!isEnabled()) {
+        return;
+    }
+    if (proxyID >= (int32_t)_proxyCells.size()) {
+        _proxyCells.resize(proxyID + 1, -1);
+        _proxySlots.resize(proxyID + 1, -1);
+    }
+    if (_proxyCells[proxyID] != -1) {
+        removeMember(proxyID);
+    }
+    addMember(findOrAddCell(glm::vec3(sphere)), proxyID, sphere);
+}
+
+void ProxyGrid::update(int32_t proxyID, const Sphere& sphere) {
+    if (!isEnabled()) {
+        return;
+    }
+    if (proxyID >= (int32_t)_proxyCells.size() || _proxyCells[proxyID] == -1) {
+        insert(proxyID, sphere);
+        return;
+    }
+    int32_t cellIndex = findOrAddCell(glm::vec3(sphere));
+    if (cellIndex != _proxyCells[proxyID]) {
+        removeMember(proxyID);
+        addMember(cellIndex, proxyID, sphere);
+        return;
+    }
+
+    // the region of the cell is recomputed from its bounds every time, so a member moving within its cell only has
+    // to keep them up to date
+    Cell& cell = _cells[cellIndex];
+    int32_t slot = _proxySlots[proxyID];
+    float oldRadius = cell.radius[slot];
+    cell.x[slot] = sphere.x;
+    cell.y[slot] = sphere.y;
+    cell.z[slot] = sphere.z;
+    cell.radius[slot] = sphere.w;
+    if (oldRadius == cell.minRadius || oldRadius == cell.maxRadius) {
+        recomputeRadiusBounds(cell);
+    } else {
+        cell.minRadius = std::min(cell.minRadius, sphere.w);
+        cell.maxRadius = std::max(cell.maxRadius, sphere.w);
+    }
+}
+
+void ProxyGrid::remove(int32_t proxyID) {
+    if (proxyID < (int32_t)_proxyCells.size() && _proxyCells[proxyID] != -1) {
+        removeMember(proxyID);
+    }
+}
+
+void ProxyGrid::clear() {
+    _cells.clear();
+    _cellIndices.clear();
+    _proxyCells.clear();
+    _proxySlots.clear();
+}
+
+void ProxyGrid::classifyCells(int32_t begin, int32_t end, const float* regionSpheres, int32_t numViews, uint8_t* regions) {
+    std::vector<uint8_t> memberRegions;
+    for (int32_t i = begin; i < end; ++i) {
+        Cell& cell = _cells[i];
+        int32_t numMembers = (int32_t)cell.proxyIDs.size();
+        if (numMembers == 0) {
+            continue;
+        }
+        uint8_t region = classifyCell(cell, regionSpheres, numViews);
+        if (region == NEEDS_TEST) {
+            memberRegions.resize(numMembers);
+            classifyProxies(cell.x.data(), cell.y.data(), cell.z.data(), cell.radius.data(), 0, numMembers,
+                regionSpheres, numViews, memberRegions.data());
+            for (int32_t j = 0; j < numMembers; ++j) {
+                regions[cell.proxyIDs[j]] = memberRegions[j];
+            }
+        } else if (region != cell.region || cell.dirty) {
+            for (int32_t proxyID : cell.proxyIDs) {
+                regions[proxyID] = region;
+            }
+        }
+        cell.region = region;
+        cell.dirty = false;
+    }
+}
+
+uint8_t ProxyGrid::classifyCell(const Cell& cell, const float* regionSpheres, int32_t numViews) const {
+    if (!cell.bounded) {
+        return NEEDS_TEST;
+    }
+    // the centers of the members are within _cellHalfDiagonal of the center of the cell, and their radii within
+    // [minRadius, maxRadius], so the cell is decided when that whole range is on one side of a boundary
+    uint8_t region = Region::R4;
+    for (int32_t j = 0; j < numViews; ++j) {
+        const float* spheres = &regionSpheres[4 * Region::NUM_TRACKED_REGIONS * j];
+        // as for a single proxy we need only test the regions below the current one
+        for (uint8_t k = 0; k < region; ++k) {
+            const float* sphere = &spheres[4 * k];
+            float distance = glm::distance(cell.center, glm::vec3(sphere[0], sphere[1], sphere[2]));
+            if (distance + _cellHalfDiagonal < cell.minRadius + sphere[3]) {
+                // every member touches this region
+                region = k;
+                break;
+            }
+            if (distance - _cellHalfDiagonal < cell.maxRadius + sphere[3]) {
+                // some members might
+                return NEEDS_TEST;
+            }
+        }
+    }
+    return region;
+}
+
+int32_t ProxyGrid::findOrAddCell(const glm::vec3& position) {
+    int64_t x, y, z;
+    uint64_t key = OVERFLOW_CELL_KEY;
+    bool inRange = computeCellCoordinate(position.x, _cellSize, x) && computeCellCoordinate(position.y, _cellSize, y) &&
+        computeCellCoordinate(position.z, _cellSize, z);
+    if (inRange) {
+        key = ((uint64_t)(x + MAX_CELL_COORDINATE) << 42) | ((uint64_t)(y + MAX_CELL_COORDINATE) << 21) |
+            (uint64_t)(z + MAX_CELL_COORDINATE);
+    }
+
+    auto itr = _cellIndices.find(key);
+    if (itr != _cellIndices.end()) {
+        return itr->second;
+    }
+    int32_t cellIndex = (int32_t)_cells.size();
+    _cellIndices[key] = cellIndex;
+    Cell cell;
+    if (inRange) {
+        cell.center = _cellSize * (glm::vec3((float)x, (float)y, (float)z) + glm::vec3(0.5f));
+    }
+    cell.minRadius = FLT_MAX;
+    cell.maxRadius = 0.0f;
+    cell.region = NEEDS_TEST;
+    cell.bounded = inRange;
+    cell.dirty = true;
+    _cells.push_back(std::move(cell));
+    return cellIndex;
+}
+
+void ProxyGrid::addMember(int32_t cellIndex, int32_t proxyID, const Sphere& sphere) {
+    Cell& cell = _cells[cellIndex];
+    _proxyCells[proxyID] = cellIndex;
+    _proxySlots[proxyID] = (int32_t)cell.proxyIDs.size();
+    cell.proxyIDs.push_back(proxyID);
+    cell.x.push_back(sphere.x);
+    cell.y.push_back(sphere.y);
+    cell.z.push_back(sphere.z);
+    cell.radius.push_back(sphere.w);
+    cell.minRadius = std::min(cell.minRadius, sphere.w);
+    cell.maxRadius = std::max(cell.maxRadius, sphere.w);
+    // the new member doesn't have the region of the cell yet
+    cell.dirty = true;
+}
+
+void ProxyGrid::removeMember(int32_t proxyID) {
+    Cell& cell = _cells[_proxyCells[proxyID]];
+    int32_t slot = _proxySlots[proxyID];
+    float radius = cell.radius[slot];
+
+    // move the last member into the slot
+    cell.proxyIDs[slot] = cell.proxyIDs.back();
+    cell.x[slot] = cell.x.back();
+    cell.y[slot] = cell.y.back();
+    cell.z[slot] = cell.z.back();
+    cell.radius[slot] = cell.radius.back();
+    _proxySlots[cell.proxyIDs[slot]] = slot;
+    cell.proxyIDs.pop_back();
+    cell.x.pop_back();
+    cell.y.pop_back();
+    cell.z.pop_back();
+    cell.radius.pop_back();
+    _proxyCells[proxyID] = -1;
+    _proxySlots[proxyID] = -1;
+
+    if (radius == cell.minRadius || radius == cell.maxRadius) {
+        recomputeRadiusBounds(cell);
+    }
+}
+
+void ProxyGrid::recomputeRadiusBounds(Cell& cell) {
+    cell.minRadius = FLT_MAX;
+    cell.maxRadius = 0.0f;
+    for (float radius : cell.radius) {
+        cell.minRadius = std::min(cell.minRadius, radius);
+        cell.maxRadius = std::max(cell.maxRadius, radius);
+    }
+}
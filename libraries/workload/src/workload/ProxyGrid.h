@@ -0,0 +1,83 @@
+//
+//  ProxyGrid.h
+//  libraries/workload/src/workload
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_workload_ProxyGrid_h
+#define hifi_workload_ProxyGrid_h
+
+#include <unordered_map>
+#include <vector>
+
+#include "View.h"
+
+namespace workload {
+
+// Bins the proxies of the Space in a uniform grid of cubic cells, so that cells can be classified as a whole: when
+// every member of a cell is on the same side of each region boundary they all get the region of the cell, and only
+// the members of cells that straddle a boundary are tested one by one.  Cells that keep their region and members from
+// one classification to the next aren't touched at all.
+class ProxyGrid {
+public:
+    void setCellSize(float cellSize);
+    float getCellSize() const { return _cellSize; }
+    bool isEnabled() const { return _cellSize > 0.0f; }
+
+    void insert(int32_t proxyID, const Sphere& sphere);
+    void update(int32_t proxyID, const Sphere& sphere);
+    void remove(int32_t proxyID);
+    void clear();
+
+    int32_t getNumCells() const { return (int32_t)_cells.size(); }
+
+    // Writes the region of the members of the cells in [begin, end) whose region may have changed.  regionSpheres holds
+    // Region::NUM_TRACKED_REGIONS spheres per view as (x, y, z, radius).  Different ranges of cells can be classified
+    // concurrently.
+    void classifyCells(int32_t begin, int32_t end, const float* regionSpheres, int32_t numViews, uint8_t* regions);
+
+private:
+    // the region of cells that straddle a boundary
+    static const uint8_t NEEDS_TEST = 0xff;
+
+    class Cell {
+    public:
+        // the members are a structure of arrays, like the Space, so they can be tested several at once
+        std::vector<int32_t> proxyIDs;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<float> radius;
+
+        glm::vec3 center;
+        float minRadius;
+        float maxRadius;
+        uint8_t region;
+        bool bounded;
+        bool dirty;
+    };
+
+    uint8_t classifyCell(const Cell& cell, const float* regionSpheres, int32_t numViews) const;
+    int32_t findOrAddCell(const glm::vec3& position);
+    void addMember(int32_t cellIndex, int32_t proxyID, const Sphere& sphere);
+    void removeMember(int32_t proxyID);
+    void recomputeRadiusBounds(Cell& cell);
+
+    std::vector<Cell> _cells;
+    std::unordered_map<uint64_t, int32_t> _cellIndices;
+
+    // the cell of each proxy, and its slot in the members of that cell
+    std::vector<int32_t> _proxyCells;
+    std::vector<int32_t> _proxySlots;
+
+    float _cellSize { 0.0f };
+    float _cellHalfDiagonal { 0.0f };
+};
+
+} // namespace workload
+
+#endif // hifi_workload_ProxyGrid_h
@@ -0,0 +1,65 @@
+//
+//  RegionClassifier.cpp
+//  libraries/workload/src/workload
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "RegionClassifier.h"
+
+#include "Region.h"
+
+static void classifyProxies_ref(const float* x, const float* y, const float* z, const float* radius, int begin, int end,
+                                const float* regionSpheres, int numViews, uint8_t* regions) {
+    for (int i = begin; i < end; ++i) {
+        uint8_t region = workload::Region::R4;
+        for (int j = 0; j < numViews; ++j) {
+            const float* spheres = &regionSpheres[4 * workload::Region::NUM_TRACKED_REGIONS * j];
+            // for each view we need only test the regions below the current value of 'region'
+            for (uint8_t k = 0; k < region; ++k) {
+                const float* sphere = &spheres[4 * k];
+                float dx = x[i] - sphere[0];
+                float dy = y[i] - sphere[1];
+                float dz = z[i] - sphere[2];
+                float touchDistance = radius[i] + sphere[3];
+                if (dx * dx + dy * dy + dz * dz < touchDistance * touchDistance) {
+                    region = k;
+                    break;
+                }
+            }
+        }
+        regions[i] = region;
+    }
+}
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+//
+// Runtime CPU dispatch
+//
+#include <CPUDetect.h>
+
+void classifyProxies_AVX2(const float* x, const float* y, const float* z, const float* radius, int begin, int end,
+                          const float* regionSpheres, int numViews, uint8_t* regions);
+
+static void classify(const float* x, const float* y, const float* z, const float* radius, int begin, int end,
+                     const float* regionSpheres, int numViews, uint8_t* regions) {
+    static auto f = cpuSupportsAVX2() ? classifyProxies_AVX2 : classifyProxies_ref;
+    (*f)(x, y, z, radius, begin, end, regionSpheres, numViews, regions); // dispatch
+}
+
+#else
+
+static void classify(const float* x, const float* y, const float* z, const float* radius, int begin, int end,
+                     const float* regionSpheres, int numViews, uint8_t* regions) {
+    classifyProxies_ref(x, y, z, radius, begin, end, regionSpheres, numViews, regions);
+}
+
+#endif
+
+void workload::classifyProxies(const float* x, const float* y, const float* z, const float* radius, int begin, int end,
+                               const float* regionSpheres, int numViews, uint8_t* regions) {
+    classify(x, y, z, radius, begin, end, regionSpheres, numViews, regions);
+}
@@ -0,0 +1,26 @@
+//
+//  RegionClassifier.h
+//  libraries/workload/src/workload
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_workload_RegionClassifier_h
+#define hifi_workload_RegionClassifier_h
+
+#include <stdint.h>
+
+namespace workload {
+
+// Classifies the proxies in [begin, end), stored as separate x, y, z and radius arrays, against the region spheres of
+// every view.  Each proxy gets the lowest region it touches in any view, or Region::R4 when it touches none.
+// regionSpheres holds Region::NUM_TRACKED_REGIONS spheres per view as (x, y, z, radius).
+void classifyProxies(const float* x, const float* y, const float* z, const float* radius, int begin, int end,
+    const float* regionSpheres, int numViews, uint8_t* regions);
+
+} // namespace workload
+
+#endif // hifi_workload_RegionClassifier_h
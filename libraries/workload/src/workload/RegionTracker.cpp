@@ -18,6 +18,7 @@
 using namespace workload;
 
 void RegionTracker::configure(const Config& config) {
+    _gridCellSize = config.gridCellSize;
 }
 
 void RegionTracker::run(const WorkloadContextPointer& context, Outputs& outputs) {
@@ -30,7 +31,7 @@ void RegionTracker::run(const WorkloadContextPointer& context, Outputs& outputs)
 
     auto space = context->_space;
     if (space) {
-        //Changes changes;
+        space->setGridCellSize(_gridCellSize);
         space->categorizeAndGetChanges(outChanges);
 
         // use exit/enter lists for each region less than Region::R4
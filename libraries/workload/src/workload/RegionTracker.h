@@ -22,8 +22,15 @@ namespace workload {
 
     class RegionTrackerConfig : public Job::Config {
         Q_OBJECT
+        Q_PROPERTY(float gridCellSize MEMBER gridCellSize NOTIFY dirty)
     public:
         RegionTrackerConfig() : Job::Config(true) {}
+
+        // zero turns the grid of the Space off
+        float gridCellSize { Space::DEFAULT_GRID_CELL_SIZE };
+
+    signals:
+        void dirty();
     };
 
     class RegionTracker {
@@ -38,6 +45,7 @@ namespace workload {
         void run(const workload::WorkloadContextPointer& renderContext, Outputs& outputs);
 
     protected:
+        float _gridCellSize { Space::DEFAULT_GRID_CELL_SIZE };
     };
 } // namespace workload
 
@@ -18,9 +18,39 @@
 
 #include <glm/gtx/quaternion.hpp>
 
+#include <TBBHelpers.h>
+
+#include "RegionClassifier.h"
+
 using namespace workload;
 
+const float Space::DEFAULT_GRID_CELL_SIZE = 32.0f; // meters
+
+// proxies are categorized in tasks of PROXIES_PER_TASK, their regions are compared PROXIES_PER_BLOCK at a time
+static const int32_t PROXIES_PER_BLOCK = 8;
+static const int32_t PROXIES_PER_TASK = 512 * PROXIES_PER_BLOCK;
+static const int32_t CELLS_PER_TASK = 256;
+
 Space::Space() : Collection() {
+    _grid.setCellSize(DEFAULT_GRID_CELL_SIZE);
+}
+
+void Space::setGridCellSize(float cellSize) {
+    std::unique_lock<std::mutex> lock(_proxiesMutex);
+    if (cellSize == _grid.getCellSize()) {
+        return;
+    }
+    _grid.setCellSize(cellSize);
+    for (int32_t i = 0; i < (int32_t)_regions.size(); ++i) {
+        if (_regions[i] < Region::INVALID) {
+            _grid.insert(i, Sphere(_proxyX[i], _proxyY[i], _proxyZ[i], _proxyRadius[i]));
+        }
+    }
+}
+
+float Space::getGridCellSize() const {
+    std::unique_lock<std::mutex> lock(_proxiesMutex);
+    return _grid.getCellSize();
 }
 
 void Space::processTransactionFrame(const Transaction& transaction) {
@@ -28,9 +58,8 @@ void Space::processTransactionFrame(const Transaction& transaction) {
     // Here we should be able to check the value of last ProxyID allocated
     // and allocate new proxies accordingly
     ProxyID maxID = _IDAllocator.getNumAllocatedIndices();
-    if (maxID > (Index) _proxies.size()) {
-        _proxies.resize(maxID + 100); // allocate the maxId and more
-        _owners.resize(maxID + 100);
+    if (maxID > (Index) _regions.size()) {
+        resizeProxies(maxID + 100); // allocate the maxId and more
     }
     // Now we know for sure that we have enough items in the array to
     // capture anything coming from the transaction
@@ -40,6 +69,30 @@ void Space::processTransactionFrame(const Transaction& transaction) {
     processRemoves(transaction._removedItems);
 }
 
+void Space::resizeProxies(uint32_t numProxies) {
+    _proxyX.resize(numProxies, 0.0f);
+    _proxyY.resize(numProxies, 0.0f);
+    _proxyZ.resize(numProxies, 0.0f);
+    _proxyRadius.resize(numProxies, 0.0f);
+    _regions.resize(numProxies, Region::INVALID);
+    _prevRegions.resize(numProxies, Region::INVALID);
+    _owners.resize(numProxies);
+}
+
+void Space::setProxySphere(int32_t proxyID, const Sphere& sphere) {
+    _proxyX[proxyID] = sphere.x;
+    _proxyY[proxyID] = sphere.y;
+    _proxyZ[proxyID] = sphere.z;
+    _proxyRadius[proxyID] = sphere.w;
+}
+
+Proxy Space::getProxy(int32_t proxyID) const {
+    Proxy proxy(Sphere(_proxyX[proxyID], _proxyY[proxyID], _proxyZ[proxyID], _proxyRadius[proxyID]));
+    proxy.region = _regions[proxyID];
+    proxy.prevRegion = _prevRegions[proxyID];
+    return proxy;
+}
+
 void Space::processResets(const Transaction::Resets& transactions) {
     for (auto& reset : transactions) {
         // Access the true item
@@ -49,11 +102,12 @@ void Space::processResets(const Transaction::Resets& transactions) {
         if (!_IDAllocator.checkIndex(proxyID)) {
             continue;
         }
-        auto& item = _proxies[proxyID];
 
         // Reset the item with a new payload
-        item.sphere = (std::get<1>(reset));
-        item.prevRegion = item.region = Region::UNKNOWN;
+        const Sphere& sphere = std::get<1>(reset);
+        setProxySphere(proxyID, sphere);
+        _prevRegions[proxyID] = _regions[proxyID] = Region::UNKNOWN;
+        _grid.insert(proxyID, sphere);
 
         _owners[proxyID] = (std::get<2>(reset));
     }
@@ -66,11 +120,9 @@ void Space::processRemoves(const Transaction::Removes& transactions) {
         }
         _IDAllocator.freeIndex(removedID);
 
-        // Access the true item
-        auto& item = _proxies[removedID];
-
         // Kill it
-        item.prevRegion = item.region = Region::INVALID;
+        _prevRegions[removedID] = _regions[removedID] = Region::INVALID;
+        _grid.remove(removedID);
         _owners[removedID] = Owner();
     }
 }
@@ -82,39 +134,74 @@ void Space::processUpdates(const Transaction::Updates& transactions) {
             continue;
         }
 
-        // Access the true item
-        auto& item = _proxies[updateID];
-
         // Update the item
-        item.sphere = (std::get<1>(update));
+        const Sphere& sphere = std::get<1>(update);
+        setProxySphere(updateID, sphere);
+        _grid.update(updateID, sphere);
     }
 }
 
 void Space::categorizeAndGetChanges(std::vector<Space::Change>& changes) {
     std::unique_lock<std::mutex> lock(_proxiesMutex);
-    uint32_t numProxies = (uint32_t)_proxies.size();
-    uint32_t numViews = (uint32_t)_views.size();
-    for (uint32_t i = 0; i < numProxies; ++i) {
-        Proxy& proxy = _proxies[i];
-        if (proxy.region < Region::INVALID) {
-            glm::vec3 proxyCenter = glm::vec3(proxy.sphere);
-            float proxyRadius = proxy.sphere.w;
-            uint8_t region = Region::R4;
-            for (uint32_t j = 0; j < numViews; ++j) {
-                auto& view = _views[j];
-                // for each 'view' we need only increment 'k' below the current value of 'region'
-                for (uint8_t k = 0; k < region; ++k) {
-                    float touchDistance = proxyRadius + view.regions[k].w;
-                    if (distance2(proxyCenter, glm::vec3(view.regions[k])) < touchDistance * touchDistance) {
-                        region = k;
-                        break;
-                    }
-                }
+    int32_t numProxies = (int32_t)_regions.size();
+
+    _regionSpheres.clear();
+    for (const auto& view : _views) {
+        for (uint32_t k = 0; k < Region::NUM_TRACKED_REGIONS; ++k) {
+            const Sphere& sphere = view.regions[k];
+            _regionSpheres.insert(_regionSpheres.end(), { sphere.x, sphere.y, sphere.z, sphere.w });
+        }
+    }
+
+    // with the grid the proxies in cells whose region didn't change keep theirs, without it every proxy is tested
+    _newRegions = _regions;
+    bool testAll = !_grid.isEnabled();
+    if (!testAll) {
+        int32_t numViews = (int32_t)_views.size();
+        tbb::parallel_for(tbb::blocked_range<int32_t>(0, _grid.getNumCells(), CELLS_PER_TASK),
+            [&](const tbb::blocked_range<int32_t>& range) {
+                _grid.classifyCells(range.begin(), range.end(), _regionSpheres.data(), numViews, _newRegions.data());
+            });
+    }
+
+    int32_t numTasks = (numProxies + PROXIES_PER_TASK - 1) / PROXIES_PER_TASK;
+    _taskChanges.resize(numTasks);
+    tbb::parallel_for(0, numTasks, [&](int32_t task) {
+        int32_t begin = task * PROXIES_PER_TASK;
+        categorizeProxies(begin, std::min(begin + PROXIES_PER_TASK, numProxies), testAll, _taskChanges[task]);
+    });
+
+    // the changes are in the order of the proxies, as if they had been categorized in one pass
+    for (auto& taskChanges : _taskChanges) {
+        changes.insert(changes.end(), taskChanges.begin(), taskChanges.end());
+        taskChanges.clear();
+    }
+}
+
+void Space::categorizeProxies(int32_t begin, int32_t end, bool testAll, std::vector<Space::Change>& changes) {
+    if (testAll) {
+        classifyProxies(_proxyX.data(), _proxyY.data(), _proxyZ.data(), _proxyRadius.data(), begin, end,
+            _regionSpheres.data(), (int32_t)_views.size(), _newRegions.data());
+    }
+
+    memcpy(&_prevRegions[begin], &_regions[begin], end - begin);
+
+    // most regions don't change from one frame to the next, compare them a block at a time
+    for (int32_t i = begin; i < end; i += PROXIES_PER_BLOCK) {
+        int32_t blockEnd = std::min(i + PROXIES_PER_BLOCK, end);
+        if (blockEnd - i == PROXIES_PER_BLOCK) {
+            uint64_t regions;
+            uint64_t newRegions;
+            memcpy(&regions, &_regions[i], sizeof(regions));
+            memcpy(&newRegions, &_newRegions[i], sizeof(newRegions));
+            if (regions == newRegions) {
+                continue;
             }
-            proxy.prevRegion = proxy.region;
-            proxy.region = region;
-            if (proxy.region != proxy.prevRegion) {
-                changes.emplace_back(Space::Change((int32_t)i, proxy.region, proxy.prevRegion));
+        }
+        for (int32_t j = i; j < blockEnd; ++j) {
+            if (_regions[j] < Region::INVALID && _newRegions[j] != _regions[j]) {
+                changes.emplace_back(Space::Change(j, _newRegions[j], _regions[j]));
+                _regions[j] = _newRegions[j];
             }
         }
     }
@@ -122,8 +209,10 @@ void Space::categorizeAndGetChanges(std::vector<Space::Change>& changes) {
 
 uint32_t Space::copyProxyValues(Proxy* proxies, uint32_t numDestProxies) const {
     std::unique_lock<std::mutex> lock(_proxiesMutex);
-    auto numCopied = std::min(numDestProxies, (uint32_t)_proxies.size());
-    memcpy(proxies, _proxies.data(), numCopied * sizeof(Proxy));
+    auto numCopied = std::min(numDestProxies, (uint32_t)_regions.size());
+    for (uint32_t i = 0; i < numCopied; ++i) {
+        proxies[i] = getProxy((int32_t)i);
+    }
     return numCopied;
 }
 
@@ -131,8 +220,8 @@ uint32_t Space::copySelectedProxyValues(Proxy::Vector& proxies, const workload::
     std::unique_lock<std::mutex> lock(_proxiesMutex);
     uint32_t numCopied = 0;
     for (auto index : indices) {
-        if (isAllocatedID(index) && (index < (Index)_proxies.size())) {
-            proxies.push_back(_proxies[index]);
+        if (isAllocatedID(index) && (index < (Index)_regions.size())) {
+            proxies.push_back(getProxy(index));
             ++numCopied;
         }
     }
@@ -141,7 +230,7 @@ uint32_t Space::copySelectedProxyValues(Proxy::Vector& proxies, const workload::
 
 const Owner Space::getOwner(int32_t proxyID) const {
     std::unique_lock<std::mutex> lock(_proxiesMutex);
-    if (isAllocatedID(proxyID) && (proxyID < (Index)_proxies.size())) {
+    if (isAllocatedID(proxyID) && (proxyID < (Index)_regions.size())) {
         return _owners[proxyID];
     }
     return Owner();
@@ -149,8 +238,8 @@ const Owner Space::getOwner(int32_t proxyID) const {
 
 uint8_t Space::getRegion(int32_t proxyID) const {
     std::unique_lock<std::mutex> lock(_proxiesMutex);
-    if (isAllocatedID(proxyID) && (proxyID < (Index)_proxies.size())) {
-        return _proxies[proxyID].region;
+    if (isAllocatedID(proxyID) && (proxyID < (Index)_regions.size())) {
+        return _regions[proxyID];
     }
     return (uint8_t)Region::INVALID;
 }
@@ -159,8 +248,14 @@ void Space::clear() {
     Collection::clear();
     std::unique_lock<std::mutex> lock(_proxiesMutex);
     _IDAllocator.clear();
-    _proxies.clear();
+    _proxyX.clear();
+    _proxyY.clear();
+    _proxyZ.clear();
+    _proxyRadius.clear();
+    _regions.clear();
+    _prevRegions.clear();
     _owners.clear();
+    _grid.clear();
     _views.clear();
 }
 
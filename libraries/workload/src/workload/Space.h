@@ -19,6 +19,7 @@
 #include <vector>
 #include <glm/glm.hpp>
 
+#include "ProxyGrid.h"
 #include "Transaction.h"
 
 namespace workload {
@@ -35,10 +36,17 @@ public:
         uint8_t prevRegion { 0 };
     };
 
+    // proxies are binned in cells of this size so that cells away from region boundaries are classified as a whole
+    static const float DEFAULT_GRID_CELL_SIZE;
+
     Space();
 
     void setViews(const Views& views);
 
+    // a size of zero turns the grid off, and every proxy is tested every time
+    void setGridCellSize(float cellSize);
+    float getGridCellSize() const;
+
     uint32_t getNumViews() const { return (uint32_t)(_views.size()); }
     void copyViews(std::vector<View>& copy) const;
 
@@ -60,10 +68,27 @@ private:
     void processRemoves(const Transaction::Removes& transactions);
     void processUpdates(const Transaction::Updates& transactions);
 
-    // The database of proxies is protected for editing by a mutex
+    void resizeProxies(uint32_t numProxies);
+    void setProxySphere(int32_t proxyID, const Sphere& sphere);
+    Proxy getProxy(int32_t proxyID) const;
+    void categorizeProxies(int32_t begin, int32_t end, bool testAll, std::vector<Change>& changes);
+
+    // The database of proxies is protected for editing by a mutex.  It is a structure of arrays rather than a vector
+    // of Proxy, so that categorizeAndGetChanges() can test several proxies at once.
     mutable std::mutex _proxiesMutex;
-    Proxy::Vector _proxies;
+    std::vector<float> _proxyX;
+    std::vector<float> _proxyY;
+    std::vector<float> _proxyZ;
+    std::vector<float> _proxyRadius;
+    std::vector<uint8_t> _regions;
+    std::vector<uint8_t> _prevRegions;
     std::vector<Owner> _owners;
+    ProxyGrid _grid;
+
+    // reused by categorizeAndGetChanges()
+    std::vector<float> _regionSpheres;
+    std::vector<uint8_t> _newRegions;
+    std::vector<std::vector<Change>> _taskChanges;
 
     Views _views;
 };
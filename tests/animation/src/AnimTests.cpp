@@ -8,6 +8,7 @@
 //
 
 #include "AnimTests.h"
+#include <QtCore/QElapsedTimer>
 #include <AnimNodeLoader.h>
 #include <AnimClip.h>
 #include <AnimBlendLinear.h>
@@ -15,6 +16,8 @@
 #include <AnimVariant.h>
 #include <AnimExpression.h>
 #include <AnimUtil.h>
+#include <AnimPoseSoA.h>
+#include <AnimClipCache.h>
 #include <ExternalResource.h>
 #include <NodeList.h>
 #include <AddressManager.h>
@@ -22,6 +25,8 @@
 #include <ResourceManager.h>
 #include <ResourceRequestObserver.h>
 #include <StatTracker.h>
+#include <CPUDetect.h>
+#include <test-utils/Benchmarks.h>
 #include <test-utils/QTestExtensions.h>
 
 QTEST_MAIN(AnimTests)
@@ -468,6 +473,307 @@ void AnimTests::testAnimPose() {
     QCOMPARE_WITH_ABS_ERROR(p.scale(), resultScale, TEST_EPSILON2);
 }
 
+static AnimPoseVec buildTestPoses(size_t numPoses, float seed, bool uniformScale) {
+    AnimPoseVec poses;
+    for (size_t i = 0; i < numPoses; i++) {
+        float t = seed + (float)i;
+        glm::vec3 axis = glm::normalize(glm::vec3(sinf(t), cosf(t * 1.3f), 0.5f + sinf(t * 0.7f)));
+        glm::quat rot = glm::angleAxis(t * 0.37f, axis);
+        if (i % 3 == 0) {
+            rot = -rot;
+        }
+        float s = 0.5f + fabsf(sinf(t * 0.3f));
+        glm::vec3 scale = uniformScale ? glm::vec3(s) : glm::vec3(s, s * 1.5f, 1.0f);
+        glm::vec3 trans(sinf(t) * 10.0f, cosf(t) * 5.0f, t * 0.1f);
+        poses.push_back(AnimPose(scale, rot, trans));
+    }
+    return poses;
+}
+
+static void compareAnimPoses(const AnimPose& a, const AnimPose& b, float epsilon) {
+    QCOMPARE_WITH_ABS_ERROR(a.trans(), b.trans(), epsilon);
+    QCOMPARE_WITH_ABS_ERROR(a.scale(), b.scale(), epsilon);
+    glm::quat rot = glm::dot(a.rot(), b.rot()) < 0.0f ? -b.rot() : b.rot();
+    QCOMPARE_WITH_ABS_ERROR(a.rot(), rot, epsilon);
+}
+
+void AnimTests::testAnimPoseSoA() {
+    const float TEST_EPSILON = 0.0001f;
+    const size_t NUM_POSES = 37;  // not a multiple of the simd width
+    const float ALPHA = 0.3f;
+
+    AnimPoseVec a = buildTestPoses(NUM_POSES, 1.0f, false);
+    AnimPoseVec b = buildTestPoses(NUM_POSES, 100.0f, false);
+    AnimPoseSoA soaA(a);
+    AnimPoseSoA soaB(b);
+    QCOMPARE(soaA.size(), (int)NUM_POSES);
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        compareAnimPoses(soaA.getPose((int)i), a[i], 0.0f);
+    }
+
+    // blend
+    AnimPoseSoA soaResult;
+    ::blend(soaA, soaB, ALPHA, soaResult);
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        AnimPose expected;
+        ::blend(1, &a[i], &b[i], ALPHA, &expected);
+        compareAnimPoses(soaResult.getPose((int)i), expected, TEST_EPSILON);
+    }
+
+    // masked blend
+    std::vector<float> weights;
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        weights.push_back((i % 2) ? 1.0f : 0.25f);
+    }
+    ::blendMasked(soaA, soaB, weights.data(), ALPHA, soaResult);
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        AnimPose expected;
+        ::blend(1, &a[i], &b[i], weights[i] * ALPHA, &expected);
+        compareAnimPoses(soaResult.getPose((int)i), expected, TEST_EPSILON);
+    }
+
+    // additive blend
+    ::blendAdd(soaA, soaB, ALPHA, soaResult);
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        AnimPose expected;
+        ::blendAdd(1, &a[i], &b[i], ALPHA, &expected);
+        compareAnimPoses(soaResult.getPose((int)i), expected, TEST_EPSILON);
+    }
+
+    // AoS entry points, which go through the SoA kernels for large pose counts
+    AnimPoseVec result(NUM_POSES);
+    ::blend(NUM_POSES, &a[0], &b[0], ALPHA, &result[0]);
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        AnimPose expected;
+        ::blend(1, &a[i], &b[i], ALPHA, &expected);
+        compareAnimPoses(result[i], expected, TEST_EPSILON);
+    }
+
+    // matrices
+    std::vector<glm::mat4> matrices(NUM_POSES);
+    soaA.buildMatrices(&matrices[0]);
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        QCOMPARE_WITH_ABS_ERROR(matrices[i], (glm::mat4)a[i], TEST_EPSILON);
+    }
+
+    // relative to absolute, on a binary tree of joints
+    AnimPoseVec relPoses = buildTestPoses(NUM_POSES, 7.0f, true);
+    std::vector<int> parentIndices;
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        parentIndices.push_back(((int)i - 1) / 2 - (i == 0 ? 1 : 0));
+    }
+    AnimPose rootPose(glm::vec3(2.0f), glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(1.0f, 2.0f, 3.0f));
+    AnimPoseSoA soaPoses(relPoses);
+    QVERIFY(soaPoses.hasUniformPositiveScale());
+    soaPoses.convertRelativeToAbsolute(parentIndices, rootPose);
+
+    AnimPoseVec absPoses(NUM_POSES);
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        absPoses[i] = (parentIndices[i] < 0 ? rootPose : absPoses[parentIndices[i]]) * relPoses[i];
+        float epsilon = 0.001f * (1.0f + glm::length(absPoses[i].trans()) + glm::length(absPoses[i].scale()));
+        compareAnimPoses(soaPoses.getPose((int)i), absPoses[i], epsilon);
+    }
+
+    // and back
+    soaPoses.convertAbsoluteToRelative(parentIndices, rootPose);
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        float epsilon = 0.001f * (1.0f + glm::length(relPoses[i].trans()) + glm::length(relPoses[i].scale()));
+        compareAnimPoses(soaPoses.getPose((int)i), relPoses[i], epsilon);
+    }
+
+    // on a chain of joints, where every level has a single joint
+    std::vector<int> chainIndices;
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        chainIndices.push_back((int)i - 1);
+    }
+    AnimPoseVec chainPoses = buildTestPoses(NUM_POSES, 3.0f, true);
+    for (auto& pose : chainPoses) {
+        // keep the chain from growing or shrinking away
+        pose.scale() = glm::vec3(1.0f);
+        pose.trans() *= 0.1f;
+    }
+    soaPoses.setPoses(chainPoses);
+    soaPoses.convertRelativeToAbsolute(chainIndices, AnimPose::identity);
+    AnimPose absPose = AnimPose::identity;
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        absPose = absPose * chainPoses[i];
+        float epsilon = 0.001f * (1.0f + glm::length(absPose.trans()) + glm::length(absPose.scale()));
+        compareAnimPoses(soaPoses.getPose((int)i), absPose, epsilon);
+    }
+    soaPoses.convertAbsoluteToRelative(chainIndices, AnimPose::identity);
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        compareAnimPoses(soaPoses.getPose((int)i), chainPoses[i], 0.01f);
+    }
+}
+
+void AnimTests::benchmarkAnimPoseSoA() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    // a typical avatar skeleton: a spine with a head, two arms with five fingers each and two legs
+    std::vector<int> parentIndices;
+    auto addChain = [&](int parentIndex, int length) {
+        for (int i = 0; i < length; i++) {
+            parentIndices.push_back(parentIndex);
+            parentIndex = (int)parentIndices.size() - 1;
+        }
+        return parentIndex;
+    };
+    int spine = addChain(-1, 5);
+    addChain(spine, 3);
+    for (int side = 0; side < 2; side++) {
+        int hand = addChain(spine, 4);
+        for (int finger = 0; finger < 5; finger++) {
+            addChain(hand, 4);
+        }
+        addChain(0, 5);
+    }
+    const size_t NUM_POSES = parentIndices.size();
+    const int NUM_ITERATIONS = 10000;
+    const float ALPHA = 0.3f;
+
+    AnimPoseVec a = buildTestPoses(NUM_POSES, 1.0f, true);
+    AnimPoseVec b = buildTestPoses(NUM_POSES, 100.0f, true);
+    AnimPoseVec result(NUM_POSES);
+    AnimPose rootPose(glm::vec3(2.0f), glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(1.0f, 2.0f, 3.0f));
+
+    // what every AnimNode pays: the AoS poses are transposed into AnimPoseSoA and back for each call
+    auto timeNsecs = [&](const std::function<void()>& f) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < NUM_ITERATIONS; i++) {
+            f();
+        }
+        return timer.nsecsElapsed() / NUM_ITERATIONS;
+    };
+    qint64 blendNsecs = timeNsecs([&] {
+        for (size_t i = 0; i < NUM_POSES; i++) {
+            ::blend(1, &a[i], &b[i], ALPHA, &result[i]);
+        }
+    });
+    qint64 soaBlendNsecs = timeNsecs([&] { ::blend(NUM_POSES, &a[0], &b[0], ALPHA, &result[0]); });
+    qint64 blendAddNsecs = timeNsecs([&] {
+        for (size_t i = 0; i < NUM_POSES; i++) {
+            ::blendAdd(1, &a[i], &b[i], ALPHA, &result[i]);
+        }
+    });
+    qint64 soaBlendAddNsecs = timeNsecs([&] { ::blendAdd(NUM_POSES, &a[0], &b[0], ALPHA, &result[0]); });
+
+    // as Rig::buildAbsoluteRigPoses() and AnimSkeleton did before
+    AnimPoseSoA soaPoses;
+    qint64 toAbsoluteNsecs = timeNsecs([&] {
+        for (size_t i = 0; i < NUM_POSES; i++) {
+            result[i] = (parentIndices[i] < 0 ? rootPose : result[parentIndices[i]]) * a[i];
+        }
+    });
+    qint64 soaToAbsoluteNsecs = timeNsecs([&] {
+        soaPoses.setPoses(a);
+        soaPoses.convertRelativeToAbsolute(parentIndices, rootPose);
+        soaPoses.getPoses(result);
+    });
+    AnimPoseVec absPoses = result;
+    qint64 toRelativeNsecs = timeNsecs([&] {
+        for (size_t i = NUM_POSES; i-- > 0;) {
+            result[i] = (parentIndices[i] < 0 ? rootPose : absPoses[parentIndices[i]]).inverse() * absPoses[i];
+        }
+    });
+    qint64 soaToRelativeNsecs = timeNsecs([&] {
+        soaPoses.setPoses(absPoses);
+        soaPoses.convertAbsoluteToRelative(parentIndices, rootPose);
+        soaPoses.getPoses(result);
+    });
+
+    qDebug() << NUM_POSES << "poses, nsecs per call with AoS poses, and through AnimPoseSoA:";
+    qDebug() << "  blend" << blendNsecs << soaBlendNsecs;
+    qDebug() << "  blendAdd" << blendAddNsecs << soaBlendAddNsecs;
+    qDebug() << "  relative to absolute" << toAbsoluteNsecs << soaToAbsoluteNsecs;
+    qDebug() << "  absolute to relative" << toRelativeNsecs << soaToRelativeNsecs;
+
+    // the SoA paths are only taken when they pay for the round trip, which the AVX2 kernels must
+    if (cpuSupportsAVX2()) {
+        QVERIFY(soaBlendNsecs < blendNsecs);
+        QVERIFY(soaBlendAddNsecs < blendAddNsecs);
+        QVERIFY(soaToAbsoluteNsecs < toAbsoluteNsecs);
+        QVERIFY(soaToRelativeNsecs < toRelativeNsecs);
+    }
+}
+
+void AnimTests::testClipCache() {
+    const float TEST_EPSILON = 0.0001f;
+    const size_t NUM_POSES = 20;
+    auto& cache = AnimClipCache::getInstance();
+    cache.resetStats();
+
+    int numBuilds = 0;
+    auto buildFrames = [&] {
+        numBuilds++;
+        AnimClipCache::Frames frames;
+        frames.push_back(buildTestPoses(NUM_POSES, 1.0f, false));
+        frames.push_back(buildTestPoses(NUM_POSES, 2.0f, false));
+        return frames;
+    };
+
+    // two clips with the same key share one set of frames
+    AnimClipCache::FramesKey key { 1234, "test.fbx", 42, (int)AnimBlendType_Normal, "", 0, 0.0f, false };
+    AnimClipCache::FramesPointer framesA = cache.getFrames(key, buildFrames);
+    AnimClipCache::FramesPointer framesB = cache.getFrames(key, buildFrames);
+    QCOMPARE(numBuilds, 1);
+    QVERIFY(framesA == framesB);
+
+    // a different skeleton does not
+    AnimClipCache::FramesKey otherKey = key;
+    otherKey.skeletonHash = 5678;
+    AnimClipCache::FramesPointer framesC = cache.getFrames(otherKey, buildFrames);
+    QCOMPARE(numBuilds, 2);
+    QVERIFY(framesA != framesC);
+
+    // nor does the same animation once it is refreshed with new contents
+    AnimClipCache::FramesKey refreshedKey = key;
+    refreshedKey.contentHash = 43;
+    AnimClipCache::FramesPointer framesRefreshed = cache.getFrames(refreshedKey, buildFrames);
+    QCOMPARE(numBuilds, 3);
+    QVERIFY(framesA != framesRefreshed);
+
+    // a clip no other clip is sharing frames with is blended exactly, as ::blend
+    AnimClipCache::FramesKey unsharedKey = key;
+    unsharedKey.url = "unshared.fbx";
+    AnimClipCache::FramesPointer framesD = cache.getFrames(unsharedKey, buildFrames);
+    int unsharedUser = 0;
+    AnimPoseVec poses(NUM_POSES);
+    for (float alpha : { 0.0f, 0.01f, 0.1f, 0.26f, 0.5f, 0.99f, 1.0f }) {
+        cache.sample(framesD, 0, 1, alpha, poses, &unsharedUser);
+        for (size_t i = 0; i < NUM_POSES; i++) {
+            AnimPose expected;
+            ::blend(1, &(*framesD)[0][i], &(*framesD)[1][i], alpha, &expected);
+            compareAnimPoses(poses[i], expected, TEST_EPSILON);
+        }
+    }
+    cache.resetStats();
+
+    // clips at nearly the same point of shared frames share one quantized sample
+    cache.setSamplesPerFrame(4);
+    int userA = 0;
+    int userB = 0;
+    AnimPoseVec posesA(NUM_POSES);
+    AnimPoseVec posesB(NUM_POSES);
+    cache.sample(framesA, 0, 1, 0.26f, posesA, &userA);
+    cache.sample(framesA, 0, 1, 0.24f, posesB, &userB);
+    cache.sample(framesA, 0, 1, 0.26f, posesA, &userA);
+    auto stats = cache.getStats();
+    QCOMPARE(stats.sampleMisses, (uint64_t)2);
+    QCOMPARE(stats.sampleHits, (uint64_t)1);
+    for (size_t i = 0; i < NUM_POSES; i++) {
+        AnimPose expected;
+        ::blend(1, &(*framesA)[0][i], &(*framesA)[1][i], 0.25f, &expected);
+        compareAnimPoses(posesA[i], expected, TEST_EPSILON);
+        compareAnimPoses(posesB[i], expected, TEST_EPSILON);
+    }
+
+    // frames are released once no clip (or live sample) holds them
+    framesC.reset();
+    cache.getFrames(otherKey, buildFrames);
+    QCOMPARE(numBuilds, 5);
+}
+
 void AnimTests::testExpressionTokenizer() {
     QString str = "(10 +  x) >= 20.1 && (y != !z)";
     AnimExpression e("x");
@@ -27,6 +27,9 @@ private slots:
     void testVariant();
     void testAccumulateTime();
     void testAnimPose();
+    void testAnimPoseSoA();
+    void benchmarkAnimPoseSoA();
+    void testClipCache();
     void testExpressionTokenizer();
     void testExpressionParser();
     void testExpressionEvaluator();
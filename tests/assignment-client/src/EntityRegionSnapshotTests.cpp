@@ -0,0 +1,381 @@
+//
+//  EntityRegionSnapshotTests.cpp
+//  tests/assignment-client/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityRegionSnapshotTests.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSet>
+#include <QtTest/QtTest>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <DependencyManager.h>
+#include <DiffTraversal.h>
+#include <EntityPriorityQueue.h>
+#include <EntityRegionSnapshot.h>
+#include <EntityTree.h>
+#include <NodeList.h>
+#include <OctreePacketData.h>
+#include <ViewFrustum.h>
+
+#include <test-utils/Benchmarks.h>
+
+QTEST_MAIN(EntityRegionSnapshotTests)
+
+// the size of the synthetic domain used by benchmarkJoin
+static const int NUM_BENCHMARK_ENTITIES = 20000;
+static const int NUM_BENCHMARK_JOINS = 20;
+static const float BENCHMARK_WORLD_SIZE = 8000.0f;
+
+static const int NUM_TEST_ENTITIES = 256;
+static const float TEST_REGION_SPACING = 4096.0f;
+
+static EntityItemProperties makeProperties(int index, const glm::vec3& position, const glm::vec3& dimensions) {
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    properties.setName(QString("entity %1").arg(index));
+    properties.setPosition(position);
+    properties.setDimensions(dimensions);
+    properties.setUserData(QString("{\"index\":%1}").arg(index));
+    return properties;
+}
+
+static EntityTreePointer makeTree() {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+    return tree;
+}
+
+// Entities spread over several regions, all in the same child of the root so that the others don't exist, and one
+// that spans the children of the root.
+static EntityTreePointer makeTestTree(QVector<QUuid>& ids) {
+    EntityTreePointer tree = makeTree();
+    tree->withWriteLock([&] {
+        for (int i = 0; i < NUM_TEST_ENTITIES; i++) {
+            glm::vec3 position(500.0f + (float)(i % 4) * TEST_REGION_SPACING,
+                               500.0f + (float)((i / 4) % 4) * TEST_REGION_SPACING,
+                               500.0f + (float)((i / 16) % 4) * TEST_REGION_SPACING + (float)(i / 64) * 10.0f);
+            ids.push_back(QUuid::createUuid());
+            tree->addEntity(EntityItemID(ids.back()), makeProperties(i, position, glm::vec3(1.0f)));
+        }
+        ids.push_back(QUuid::createUuid());
+        tree->addEntity(EntityItemID(ids.back()), makeProperties(NUM_TEST_ENTITIES, glm::vec3(0.0f), glm::vec3(100.0f)));
+    });
+    return tree;
+}
+
+static uint8_t getRootChildrenMask(const EntityTreePointer& tree) {
+    uint8_t mask = 0;
+    tree->withReadLock([&] {
+        EntityTreeElementPointer root = tree->getRoot();
+        for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+            if (root->getChildAtIndex(i)) {
+                mask |= (1 << i);
+            }
+        }
+    });
+    return mask;
+}
+
+// Appends entities, from first on, to a payload the way EntityTreeSendThread::traverseTreeAndBuildNextPacketPayload() does
+// for a client that wants the exists bits, until one doesn't fit.  Returns the number of entities appended.  The send thread
+// itself needs a running EntityServer.
+static size_t appendTraversalPayload(OctreePacketData& packetData, const std::vector<EntityItemPointer>& entities, size_t first,
+                                     uint8_t childrenExistBits) {
+    EncodeBitstreamParams params;
+    auto extraEncodeData = std::make_shared<EntityTreeElementExtraEncodeData>();
+
+    const uint8_t zeroByte = 0;
+    packetData.appendValue(zeroByte); // octalcode
+    packetData.appendValue(zeroByte); // colors
+    packetData.appendValue(childrenExistBits); // childrenInTreeMask
+    packetData.appendValue(zeroByte); // childrenInBufferMask
+    uint16_t numEntities = 0;
+    int numEntitiesOffset = packetData.getUncompressedByteOffset();
+    packetData.appendValue(numEntities);
+
+    LevelDetails entitiesLevel = packetData.startLevel();
+    for (size_t i = first; i < entities.size(); i++) {
+        if (entities[i]->appendCachedEntityData(&packetData, params, extraEncodeData) != OctreeElement::COMPLETED) {
+            break;
+        }
+        ++numEntities;
+    }
+    packetData.endLevel(entitiesLevel);
+    packetData.updatePriorBytes(numEntitiesOffset, (const unsigned char*)&numEntities, sizeof(numEntities));
+    return numEntities;
+}
+
+// the payload of the traversal for entities, empty if they don't fit in one
+static QByteArray buildTraversalPayload(const std::vector<EntityItemPointer>& entities, uint8_t childrenExistBits) {
+    OctreePacketData packetData;
+    if (appendTraversalPayload(packetData, entities, 0, childrenExistBits) != entities.size()) {
+        return QByteArray();
+    }
+    return QByteArray((const char*)packetData.getUncompressedData(), packetData.getUncompressedSize());
+}
+
+// reads a section the way OctreeProcessor does on the client
+static void readSection(const EntityTreePointer& tree, const QByteArray& data, bool isCompressed) {
+    tree->withWriteLock([&] {
+        OctreePacketData packetData(isCompressed);
+        packetData.loadFinalizedContent((const unsigned char*)data.constData(), data.size());
+        ReadBitstreamToTreeParams args(WANT_EXISTS_BITS);
+        tree->readBitstreamToTree(packetData.getUncompressedData(), packetData.getUncompressedSize(), args);
+    });
+}
+
+// a client tree with a child of the root that the server doesn't have, left from a previous visit
+static EntityTreePointer makeClientTree(uint8_t serverChildrenMask) {
+    EntityTreePointer tree = makeTree();
+    tree->withWriteLock([&] {
+        for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+            if (!(serverChildrenMask & (1 << i))) {
+                tree->getRoot()->addChildAtIndex(i);
+                break;
+            }
+        }
+    });
+    return tree;
+}
+
+void EntityRegionSnapshotTests::initTestCase() {
+    // the encoding looks up the session ID
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<NodeList>(NodeType::Agent, INVALID_PORT);
+}
+
+void EntityRegionSnapshotTests::testSectionsMatchTraversal() {
+    QVector<QUuid> ids;
+    EntityTreePointer tree = makeTestTree(ids);
+    uint8_t childrenMask = getRootChildrenMask(tree);
+    QCOMPARE(childrenMask & (childrenMask - 1), 0); // one child
+
+    EntityRegionSnapshotPointer snapshot = EntityRegionSnapshot::build(tree, EntityRegionSnapshotPointer());
+    QVERIFY(snapshot);
+    QCOMPARE(snapshot->getChildrenInTreeMask(), childrenMask);
+    QCOMPARE(snapshot->getNumEntities(), ids.size());
+    QVERIFY(snapshot->getRegions().size() > 2);
+    QVERIFY(snapshot->getRegions().front().isRoot);
+
+    EntityTreePointer snapshotClient = makeClientTree(childrenMask);
+    EntityTreePointer traversalClient = makeClientTree(childrenMask);
+    QSet<QUuid> snapshotIDs;
+    for (const auto& region : snapshot->getRegions()) {
+        for (const auto& section : region.sections) {
+            std::vector<EntityItemPointer> entities;
+            for (const auto& snapshotEntity : section.entities) {
+                EntityItemPointer entity = snapshotEntity.entity.lock();
+                QVERIFY(entity);
+                QCOMPARE(snapshotEntity.key, entity.get());
+                QCOMPARE(snapshotEntity.knownTimestamp, std::max(entity->getLastEdited(), entity->getLastChangedOnServer()));
+                QVERIFY(!snapshotIDs.contains(entity->getID()));
+                snapshotIDs.insert(entity->getID());
+                entities.push_back(entity);
+            }
+
+            // the same bytes as the traversal sends for the same entities
+            QByteArray traversalPayload = buildTraversalPayload(entities, childrenMask);
+            QVERIFY(!traversalPayload.isEmpty());
+            QCOMPARE(section.data, traversalPayload);
+            QVERIFY(!section.compressedData.isEmpty());
+            QVERIFY(section.compressedData.size() <= EntityRegionSnapshot::MAX_COMPRESSED_SECTION_SIZE);
+
+            readSection(snapshotClient, section.compressedData, true);
+            readSection(traversalClient, traversalPayload, false);
+        }
+    }
+    QCOMPARE(snapshotIDs.size(), ids.size());
+
+    // the client ends up with the entities and the children of the root of the server
+    QCOMPARE(getRootChildrenMask(snapshotClient), childrenMask);
+    QCOMPARE(getRootChildrenMask(traversalClient), childrenMask);
+    for (const auto& id : ids) {
+        EntityItemPointer entity = tree->findEntityByID(id);
+        EntityItemPointer snapshotEntity = snapshotClient->findEntityByID(id);
+        EntityItemPointer traversalEntity = traversalClient->findEntityByID(id);
+        QVERIFY(snapshotEntity);
+        QVERIFY(traversalEntity);
+        QCOMPARE(snapshotEntity->getName(), entity->getName());
+        QCOMPARE(snapshotEntity->getName(), traversalEntity->getName());
+        QCOMPARE(snapshotEntity->getWorldPosition(), traversalEntity->getWorldPosition());
+        QCOMPARE(snapshotEntity->getScaledDimensions(), traversalEntity->getScaledDimensions());
+        QCOMPARE(snapshotEntity->getUserData(), traversalEntity->getUserData());
+        QCOMPARE(snapshotEntity->getLastEdited(), traversalEntity->getLastEdited());
+    }
+}
+
+void EntityRegionSnapshotTests::testReuseUnchangedRegions() {
+    QVector<QUuid> ids;
+    EntityTreePointer tree = makeTestTree(ids);
+    EntityRegionSnapshotPointer first = EntityRegionSnapshot::build(tree, EntityRegionSnapshotPointer());
+    int numRegions = (int)first->getRegions().size();
+
+    EntityRegionSnapshotPointer second = EntityRegionSnapshot::build(tree, first);
+    QCOMPARE(second->getNumReusedRegions(), numRegions);
+    QCOMPARE(second->getNumEntities(), first->getNumEntities());
+
+    // only the region of the edited entity is encoded again
+    EntityItemPointer edited = tree->findEntityByID(ids.front());
+    tree->withWriteLock([&] {
+        EntityItemProperties properties;
+        properties.setName("edited");
+        properties.setLastEdited(edited->getLastEdited() + 1);
+        edited->setProperties(properties);
+    });
+    EntityRegionSnapshotPointer third = EntityRegionSnapshot::build(tree, second);
+    QCOMPARE(third->getNumReusedRegions(), numRegions - 1);
+    bool found = false;
+    for (const auto& region : third->getRegions()) {
+        for (const auto& section : region.sections) {
+            for (const auto& snapshotEntity : section.entities) {
+                if (snapshotEntity.key == edited.get()) {
+                    found = true;
+                    QCOMPARE(snapshotEntity.knownTimestamp, std::max(edited->getLastEdited(), edited->getLastChangedOnServer()));
+                    QVERIFY(section.data.contains("edited"));
+                }
+            }
+        }
+    }
+    QVERIFY(found);
+
+    // the region of a deleted entity goes when it is empty
+    tree->deleteEntity(EntityItemID(ids.back()), true, true);
+    EntityRegionSnapshotPointer fourth = EntityRegionSnapshot::build(tree, third);
+    QCOMPARE(fourth->getNumEntities(), third->getNumEntities() - 1);
+    QCOMPARE((int)fourth->getRegions().size(), numRegions - 1);
+    QCOMPARE(fourth->getNumReusedRegions(), numRegions - 1);
+    QVERIFY(!fourth->getRegions().front().isRoot);
+}
+
+void EntityRegionSnapshotTests::benchmarkJoin() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> coordinate(-0.5f * BENCHMARK_WORLD_SIZE, 0.5f * BENCHMARK_WORLD_SIZE);
+    std::uniform_real_distribution<float> size(0.1f, 10.0f);
+    EntityTreePointer tree = makeTree();
+    tree->withWriteLock([&] {
+        for (int i = 0; i < NUM_BENCHMARK_ENTITIES; i++) {
+            glm::vec3 position(coordinate(random), coordinate(random), coordinate(random));
+            glm::vec3 dimensions(size(random), size(random), size(random));
+            tree->addEntity(EntityItemID(QUuid::createUuid()), makeProperties(i, position, dimensions));
+        }
+    });
+    uint8_t childrenMask = getRootChildrenMask(tree);
+
+    ViewFrustum frustum;
+    frustum.setProjection(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, BENCHMARK_WORLD_SIZE));
+    frustum.setPosition(glm::vec3(0.0f));
+    frustum.calculate();
+    DiffTraversal::View view;
+    view.viewFrustums.push_back(ConicalViewFrustum(frustum));
+
+    // built by the EntityServer every few seconds, not for each join
+    QElapsedTimer timer;
+    timer.start();
+    EntityRegionSnapshotPointer snapshot = EntityRegionSnapshot::build(tree, EntityRegionSnapshotPointer());
+    qint64 buildMsecs = timer.elapsed();
+
+    // Without the snapshot: every entity in view is prioritized, queued and encoded into packets.  This is the work of
+    // EntityTreeSendThread for a First traversal, less the sending.
+    int numTraversalPackets = 0;
+    int numTraversalEntities = 0;
+    timer.restart();
+    for (int join = 0; join < NUM_BENCHMARK_JOINS; join++) {
+        EntityPriorityQueue sendQueue;
+        std::function<void(const EntityTreeElementPointer&)> scan = [&](const EntityTreeElementPointer& element) {
+            if (!view.shouldTraverseElement(*element)) {
+                return;
+            }
+            element->forEachEntity([&](const EntityItemPointer& entity) {
+                float priority = view.computePriority(entity);
+                if (priority != PrioritizedEntity::DO_NOT_SEND) {
+                    sendQueue.emplace(entity, priority);
+                }
+            });
+            for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+                EntityTreeElementPointer child = element->getChildAtIndex(i);
+                if (child) {
+                    scan(child);
+                }
+            }
+        };
+        tree->withReadLock([&] {
+            scan(tree->getRoot());
+        });
+
+        std::vector<EntityItemPointer> entities;
+        entities.reserve(NUM_BENCHMARK_ENTITIES);
+        while (!sendQueue.empty()) {
+            entities.push_back(sendQueue.top().getEntity());
+            sendQueue.pop();
+        }
+        for (size_t next = 0; next < entities.size();) {
+            OctreePacketData packetData(true);
+            size_t numAppended = appendTraversalPayload(packetData, entities, next, childrenMask);
+            if (numAppended == 0) {
+                // bigger than a packet, the send thread sends it piecewise
+                next++;
+                continue;
+            }
+            packetData.getFinalizedSize();
+            next += numAppended;
+            numTraversalEntities += (int)numAppended;
+            numTraversalPackets++;
+        }
+    }
+    qint64 traversalMsecs = timer.elapsed();
+
+    // With the snapshot: the regions in view are prioritized and their sections copied into packets as they are, after
+    // checking their entities still exist.  This is the work of queueRegionSnapshot() and buildNextRegionSnapshotPayload().
+    int numSnapshotPackets = 0;
+    int numSnapshotEntities = 0;
+    timer.restart();
+    for (int join = 0; join < NUM_BENCHMARK_JOINS; join++) {
+        std::vector<std::pair<float, const EntityRegionSnapshot::Region*>> regions;
+        for (const auto& region : snapshot->getRegions()) {
+            float priority = region.isRoot ? std::numeric_limits<float>::max() : view.computePriority(region.cube);
+            if (priority != PrioritizedEntity::DO_NOT_SEND) {
+                regions.emplace_back(priority, &region);
+            }
+        }
+        std::stable_sort(regions.begin(), regions.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        for (const auto& region : regions) {
+            for (const auto& section : region.second->sections) {
+                bool isCurrent = true;
+                for (const auto& snapshotEntity : section.entities) {
+                    EntityItemPointer entity = snapshotEntity.entity.lock();
+                    isCurrent = isCurrent && entity && !entity->isDead();
+                }
+                if (isCurrent) {
+                    OctreePacketData packetData(true);
+                    packetData.loadPrecompressedContent(section.data, section.compressedData);
+                    numSnapshotEntities += (int)section.entities.size();
+                    numSnapshotPackets++;
+                }
+            }
+        }
+    }
+    qint64 snapshotMsecs = timer.elapsed();
+
+    qDebug() << NUM_BENCHMARK_ENTITIES << "entities, snapshot of" << snapshot->getNumSections() << "sections,"
+             << snapshot->getNumBytes() << "bytes built in" << buildMsecs << "msecs";
+    qDebug() << "per join: traversal" << (double)traversalMsecs / NUM_BENCHMARK_JOINS << "msecs for"
+             << numTraversalEntities / NUM_BENCHMARK_JOINS << "entities in" << numTraversalPackets / NUM_BENCHMARK_JOINS
+             << "packets, snapshot" << (double)snapshotMsecs / NUM_BENCHMARK_JOINS << "msecs for"
+             << numSnapshotEntities / NUM_BENCHMARK_JOINS << "entities in" << numSnapshotPackets / NUM_BENCHMARK_JOINS
+             << "packets";
+}
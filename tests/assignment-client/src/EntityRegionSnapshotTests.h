@@ -0,0 +1,25 @@
+//
+//  EntityRegionSnapshotTests.h
+//  tests/assignment-client/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityRegionSnapshotTests_h
+#define hifi_EntityRegionSnapshotTests_h
+
+#include <QtCore/QObject>
+
+class EntityRegionSnapshotTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void testSectionsMatchTraversal();
+    void testReuseUnchangedRegions();
+    void benchmarkJoin();
+};
+
+#endif // hifi_EntityRegionSnapshotTests_h
@@ -0,0 +1,233 @@
+//
+//  EntityScriptShardsTests.cpp
+//  tests/assignment-client/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityScriptShardsTests.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtTest/QtTest>
+
+#include <EntityScriptShards.h>
+
+QTEST_MAIN(EntityScriptShardsTests)
+
+namespace {
+
+// An engine that records the calls into its entity scripts instead of running them, with the thread they ran on.
+class CallRecordingEngine : public ScriptEngine {
+public:
+    struct Call {
+        EntityItemID entityID;
+        QString methodName;
+        QThread* thread;
+    };
+
+    CallRecordingEngine() : ScriptEngine(ScriptEngine::ENTITY_SERVER_SCRIPT) {}
+
+    using ScriptEngine::callEntityScriptMethod;
+    void callEntityScriptMethod(const EntityItemID& entityID, const QString& methodName,
+                                const QStringList&, const QUuid&) override {
+        std::lock_guard<std::mutex> lock(_callsMutex);
+        _calls.push_back({ entityID, methodName, QThread::currentThread() });
+    }
+
+    std::vector<Call> getCalls() const {
+        std::lock_guard<std::mutex> lock(_callsMutex);
+        return _calls;
+    }
+    int getNumCalls() const { return (int)getCalls().size(); }
+
+private:
+    mutable std::mutex _callsMutex;
+    std::vector<Call> _calls;
+};
+
+// engines running on threads of their own, as they do in the entity script server
+class ShardThreads {
+public:
+    ShardThreads(int numShards) {
+        for (int i = 0; i < numShards; i++) {
+            auto engine = new CallRecordingEngine();
+            auto thread = new QThread();
+            engine->moveToThread(thread);
+            thread->start();
+            _threads.emplace_back(thread);
+            engines.push_back(ScriptEnginePointer(engine));
+        }
+    }
+
+    ~ShardThreads() {
+        for (const auto& thread : _threads) {
+            thread->quit();
+            thread->wait();
+        }
+    }
+
+    CallRecordingEngine* getEngine(int shard) const { return static_cast<CallRecordingEngine*>(engines[shard].data()); }
+
+    std::vector<ScriptEnginePointer> engines;
+
+private:
+    std::vector<std::unique_ptr<QThread>> _threads;
+};
+
+// an entity ID on the shard
+EntityItemID entityOnShard(const EntityScriptShards& shards, int shard) {
+    EntityItemID entityID;
+    do {
+        entityID = EntityItemID(QUuid::createUuid());
+    } while (shards.shardForEntity(entityID) != shard);
+    return entityID;
+}
+
+}
+
+void EntityScriptShardsTests::testSharding() {
+    const int NUM_SHARDS = 3;
+    const int NUM_ENTITIES = 3000;
+    std::vector<ScriptEnginePointer> engines;
+    for (int i = 0; i < NUM_SHARDS; i++) {
+        engines.push_back(ScriptEnginePointer(new CallRecordingEngine()));
+    }
+    EntityScriptShards shards(engines);
+    QCOMPARE(shards.getNumShards(), NUM_SHARDS);
+
+    std::vector<int> numEntities(NUM_SHARDS, 0);
+    for (int i = 0; i < NUM_ENTITIES; i++) {
+        EntityItemID entityID(QUuid::createUuid());
+        int shard = shards.shardForEntity(entityID);
+        QVERIFY(shard >= 0 && shard < NUM_SHARDS);
+        // an entity's script always runs on the same shard
+        QCOMPARE(shards.shardForEntity(EntityItemID(QUuid(entityID))), shard);
+        QCOMPARE(shards.engineForEntity(entityID).data(), engines[shard].data());
+        numEntities[shard]++;
+    }
+    // and the scripts are spread over the shards
+    for (int shard = 0; shard < NUM_SHARDS; shard++) {
+        QVERIFY(numEntities[shard] > NUM_ENTITIES / NUM_SHARDS / 2);
+    }
+}
+
+void EntityScriptShardsTests::testQueuedCalls() {
+    ShardThreads threads(2);
+    EntityScriptShards shards(threads.engines);
+    CallRecordingEngine* engine = threads.getEngine(1);
+    EntityItemID entityID = entityOnShard(shards, 1);
+
+    // calls from the main thread, as for the call method packets, run in order on the thread of the shard
+    const int NUM_CALLS = 10;
+    for (int i = 0; i < NUM_CALLS; i++) {
+        shards.callEntityScriptMethod(entityID, QString("method%1").arg(i));
+    }
+    QCOMPARE(shards.getNumQueuedCalls(1), (quint64)NUM_CALLS);
+    QCOMPARE(shards.getNumQueuedCalls(0), (quint64)0);
+
+    QTRY_COMPARE(engine->getNumCalls(), NUM_CALLS);
+    auto calls = engine->getCalls();
+    for (int i = 0; i < NUM_CALLS; i++) {
+        QCOMPARE(calls[i].entityID, entityID);
+        QCOMPARE(calls[i].methodName, QString("method%1").arg(i));
+        QCOMPARE(calls[i].thread, engine->thread());
+    }
+    QCOMPARE(threads.getEngine(0)->getNumCalls(), 0);
+}
+
+void EntityScriptShardsTests::testCallsBetweenShards() {
+    ShardThreads threads(2);
+    EntityScriptShards shards(threads.engines);
+    CallRecordingEngine* engine = threads.getEngine(0);
+    CallRecordingEngine* otherEngine = threads.getEngine(1);
+    EntityItemID entityID = entityOnShard(shards, 0);
+    EntityItemID otherEntityID = entityOnShard(shards, 1);
+
+    // keep the other shard busy, as with a slow script
+    QSemaphore otherShardBusy;
+    QSemaphore releaseOtherShard;
+    QMetaObject::invokeMethod(otherEngine, [&] {
+        otherShardBusy.release();
+        releaseOtherShard.acquire();
+    }, Qt::QueuedConnection);
+    otherShardBusy.acquire();
+
+    // A script of the first shard calls an entity of its own shard, then one of the other shard.  The first call runs
+    // right away, as it does with a single engine.  The second is queued: unlike with a single engine, the calling
+    // script goes on before the method has run.
+    int numCallsOnShard = -1;
+    QMetaObject::invokeMethod(engine, [&] {
+        shards.callEntityScriptMethod(entityID, "sameShard");
+        numCallsOnShard = engine->getNumCalls();
+        shards.callEntityScriptMethod(otherEntityID, "otherShard");
+    }, Qt::BlockingQueuedConnection);
+    QCOMPARE(numCallsOnShard, 1);
+    QCOMPARE(engine->getCalls()[0].methodName, QString("sameShard"));
+    QCOMPARE(shards.getNumQueuedCalls(0), (quint64)0);
+    QCOMPARE(shards.getNumQueuedCalls(1), (quint64)1);
+    QCOMPARE(otherEngine->getNumCalls(), 0);
+
+    // the call runs once the other shard is free, on its own thread
+    releaseOtherShard.release();
+    QTRY_COMPARE(otherEngine->getNumCalls(), 1);
+    auto calls = otherEngine->getCalls();
+    QCOMPARE(calls[0].entityID, otherEntityID);
+    QCOMPARE(calls[0].methodName, QString("otherShard"));
+    QCOMPARE(calls[0].thread, otherEngine->thread());
+    QCOMPARE(engine->getNumCalls(), 1);
+}
+
+void EntityScriptShardsTests::testRestartOnSettingsChange() {
+    // a number of script threads in the settings is used as is, none picks it from the cores
+    QCOMPARE(EntityScriptShards::getNumShardsToRun(3), 3);
+    int automaticShards = EntityScriptShards::getNumShardsToRun(0);
+    QVERIFY(automaticShards >= 1 && automaticShards <= EntityScriptShards::MAX_AUTOMATIC_SHARDS);
+
+    // the entity script server restarts the shards when their number changes, as most scripts move
+    std::vector<ScriptEnginePointer> engines { ScriptEnginePointer(new CallRecordingEngine()),
+                                               ScriptEnginePointer(new CallRecordingEngine()) };
+    EntityScriptShards shards(engines);
+    QCOMPARE(shards.getNumShards(), EntityScriptShards::getNumShardsToRun(2));
+    QVERIFY(shards.getNumShards() != EntityScriptShards::getNumShardsToRun(3));
+    engines.push_back(ScriptEnginePointer(new CallRecordingEngine()));
+    EntityScriptShards restartedShards(engines);
+    int numMoved = 0;
+    for (int i = 0; i < 100; i++) {
+        EntityItemID entityID(QUuid::createUuid());
+        if (shards.shardForEntity(entityID) != restartedShards.shardForEntity(entityID)) {
+            numMoved++;
+        }
+    }
+    QVERIFY(numMoved > 0);
+
+    // then preloads the entities that have a server script, and only those
+    QVERIFY(EntityScriptShards::getEntitiesWithServerScripts(EntityTreePointer()).empty());
+    auto tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+    QSet<EntityItemID> scriptedIDs;
+    tree->withWriteLock([&] {
+        for (int i = 0; i < 10; i++) {
+            EntityItemID entityID(QUuid::createUuid());
+            EntityItemProperties properties;
+            properties.setType(EntityTypes::Box);
+            if (i % 2 == 0) {
+                properties.setServerScripts(QString("https://example.com/scripts/server%1.js").arg(i));
+                scriptedIDs.insert(entityID);
+            }
+            tree->addEntity(entityID, properties);
+        }
+    });
+    auto preloadIDs = EntityScriptShards::getEntitiesWithServerScripts(tree);
+    QCOMPARE((int)preloadIDs.size(), scriptedIDs.size());
+    for (const auto& entityID : preloadIDs) {
+        QVERIFY(scriptedIDs.contains(entityID));
+    }
+}
@@ -0,0 +1,25 @@
+//
+//  EntityScriptShardsTests.h
+//  tests/assignment-client/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityScriptShardsTests_h
+#define hifi_EntityScriptShardsTests_h
+
+#include <QtCore/QObject>
+
+class EntityScriptShardsTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testSharding();
+    void testQueuedCalls();
+    void testCallsBetweenShards();
+    void testRestartOnSettingsChange();
+};
+
+#endif // hifi_EntityScriptShardsTests_h
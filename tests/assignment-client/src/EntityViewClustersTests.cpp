@@ -0,0 +1,179 @@
+//
+//  EntityViewClustersTests.cpp
+//  tests/assignment-client/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityViewClustersTests.h"
+
+#include <QtTest/QtTest>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <EntityPriorityQueue.h>
+#include <EntityTree.h>
+#include <EntityViewClusters.h>
+#include <SharedUtil.h>
+#include <ViewFrustum.h>
+
+QTEST_MAIN(EntityViewClustersTests)
+
+using VisibleSet = EntityViewClusters::VisibleSet;
+using VisibleSetPointer = EntityViewClusters::VisibleSetPointer;
+
+// a view looking down -z from position
+static DiffTraversal::View makeView(const glm::vec3& position, uint64_t startTime, float lodScaleFactor = 1.0f) {
+    ViewFrustum frustum;
+    frustum.setProjection(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f));
+    frustum.setPosition(position);
+    frustum.calculate();
+
+    DiffTraversal::View view;
+    view.viewFrustums.push_back(ConicalViewFrustum(frustum));
+    view.startTime = startTime;
+    view.lodScaleFactor = lodScaleFactor;
+    return view;
+}
+
+static VisibleSetPointer makeSet(const DiffTraversal::View& view, int numEntities = 0) {
+    auto visibleSet = std::make_shared<VisibleSet>();
+    visibleSet->view = view;
+    for (int i = 0; i < numEntities; i++) {
+        visibleSet->entities.push_back({ EntityItemWeakPointer(), nullptr, 1.0f });
+    }
+    return visibleSet;
+}
+
+void EntityViewClustersTests::testMatching() {
+    EntityViewClusters clusters;
+    uint64_t now = usecTimestampNow();
+    VisibleSetPointer visibleSet = makeSet(makeView(glm::vec3(0.0f), now), 3);
+    clusters.publish(visibleSet);
+    QCOMPARE(clusters.getNumPublished(), (quint64)1);
+    QCOMPARE(clusters.getNumClusters(), 1);
+
+    // a client standing a meter away shares the set
+    QCOMPARE(clusters.find(makeView(glm::vec3(1.0f, 0.0f, 0.0f), now)).get(), visibleSet.get());
+    QCOMPARE(clusters.getNumShared(), (quint64)1);
+    QCOMPARE(clusters.getNumEntitiesShared(), (quint64)3);
+
+    // one across the domain doesn't, nor does one with another LOD, nor one with a second view
+    QVERIFY(!clusters.find(makeView(glm::vec3(100.0f, 0.0f, 0.0f), now)));
+    QVERIFY(!clusters.find(makeView(glm::vec3(0.0f), now, 0.5f)));
+    DiffTraversal::View twoViews = makeView(glm::vec3(0.0f), now);
+    twoViews.viewFrustums.push_back(twoViews.viewFrustums.front());
+    QVERIFY(!clusters.find(twoViews));
+    QCOMPARE(clusters.getNumShared(), (quint64)1);
+    QCOMPARE(clusters.getNumEntitiesShared(), (quint64)3);
+}
+
+void EntityViewClustersTests::testNewerSetReplacesOlder() {
+    EntityViewClusters clusters;
+    uint64_t now = usecTimestampNow();
+    VisibleSetPointer older = makeSet(makeView(glm::vec3(0.0f), now - 1000));
+    VisibleSetPointer newer = makeSet(makeView(glm::vec3(1.0f, 0.0f, 0.0f), now));
+    VisibleSetPointer elsewhere = makeSet(makeView(glm::vec3(100.0f, 0.0f, 0.0f), now - 1000));
+
+    clusters.publish(older);
+    clusters.publish(elsewhere);
+    QCOMPARE(clusters.getNumClusters(), 2);
+    clusters.publish(newer);
+    QCOMPARE(clusters.getNumClusters(), 2);
+    QCOMPARE(clusters.find(makeView(glm::vec3(0.0f), now)).get(), newer.get());
+    QCOMPARE(clusters.find(makeView(glm::vec3(100.0f, 0.0f, 0.0f), now)).get(), elsewhere.get());
+
+    // a traversal that started before the latest one finishes after it: the latest is still the one shared
+    clusters.publish(makeSet(makeView(glm::vec3(0.0f), now - 500)));
+    QCOMPARE(clusters.find(makeView(glm::vec3(0.0f), now)).get(), newer.get());
+    QCOMPARE(clusters.getNumPublished(), (quint64)4);
+}
+
+void EntityViewClustersTests::testAgeCutoff() {
+    EntityViewClusters clusters;
+    uint64_t now = usecTimestampNow();
+    VisibleSetPointer expired = makeSet(makeView(glm::vec3(0.0f), now - EntityViewClusters::MAX_VISIBLE_SET_AGE));
+    VisibleSetPointer recent = makeSet(makeView(glm::vec3(100.0f, 0.0f, 0.0f), now));
+
+    clusters.publish(expired);
+    QVERIFY(!clusters.find(makeView(glm::vec3(0.0f), now)));
+    QCOMPARE(clusters.getNumClusters(), 0);
+    QCOMPARE(clusters.getNumShared(), (quint64)0);
+
+    clusters.publish(recent);
+    QCOMPARE(clusters.getNumClusters(), 1);
+    QCOMPARE(clusters.find(makeView(glm::vec3(100.0f, 0.0f, 0.0f), now)).get(), recent.get());
+
+    // the expired set was dropped when the recent one was published
+    QCOMPARE(expired.use_count(), 1L);
+}
+
+void EntityViewClustersTests::testMaxVisibleSets() {
+    EntityViewClusters clusters;
+    uint64_t now = usecTimestampNow();
+    const int NUM_SETS = EntityViewClusters::MAX_VISIBLE_SETS + 1;
+    for (int i = 0; i < NUM_SETS; i++) {
+        clusters.publish(makeSet(makeView(glm::vec3((float)i * 100.0f, 0.0f, 0.0f), now - NUM_SETS + i)));
+    }
+    QCOMPARE(clusters.getNumClusters(), EntityViewClusters::MAX_VISIBLE_SETS);
+
+    // the oldest made room for the last
+    QVERIFY(!clusters.find(makeView(glm::vec3(0.0f), now)));
+    QVERIFY(clusters.find(makeView(glm::vec3(100.0f, 0.0f, 0.0f), now)));
+    QVERIFY(clusters.find(makeView(glm::vec3((float)(NUM_SETS - 1) * 100.0f, 0.0f, 0.0f), now)));
+}
+
+void EntityViewClustersTests::testSharedPriority() {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+    QUuid editedID = QUuid::createUuid();
+    QUuid changedID = QUuid::createUuid();
+    QUuid untouchedID = QUuid::createUuid();
+    tree->withWriteLock([&] {
+        for (const auto& id : { editedID, changedID, untouchedID }) {
+            EntityItemProperties properties;
+            properties.setType(EntityTypes::Box);
+            properties.setPosition(glm::vec3(0.0f, 0.0f, -10.0f));
+            properties.setDimensions(glm::vec3(1.0f));
+            tree->addEntity(EntityItemID(id), properties);
+        }
+    });
+    EntityItemPointer edited = tree->findEntityByID(editedID);
+    EntityItemPointer changed = tree->findEntityByID(changedID);
+    EntityItemPointer untouched = tree->findEntityByID(untouchedID);
+    QVERIFY(edited && changed && untouched);
+
+    // the shared traversal started once the entities were added, and recorded a priority of its own for them
+    uint64_t sharedStartTime = usecTimestampNow();
+    DiffTraversal::View view = makeView(glm::vec3(0.0f), sharedStartTime + 1000);
+    const float RECORDED_PRIORITY = 42.0f;
+    auto visibleEntity = [&](const EntityItemPointer& entity) {
+        return EntityViewClusters::VisibleEntity { entity, entity.get(), RECORDED_PRIORITY };
+    };
+    QVERIFY(view.computePriority(untouched) != PrioritizedEntity::DO_NOT_SEND);
+    QVERIFY(view.computePriority(untouched) != RECORDED_PRIORITY);
+
+    // an entity that wasn't touched since keeps the priority it was shared with
+    QCOMPARE(EntityViewClusters::computeSharedPriority(visibleEntity(untouched), untouched, view, sharedStartTime),
+             RECORDED_PRIORITY);
+
+    // one moved behind the client since is prioritized again, out of view
+    EntityItemProperties properties;
+    properties.setPosition(glm::vec3(0.0f, 0.0f, 200.0f));
+    properties.setLastEdited(sharedStartTime + 1);
+    edited->setProperties(properties);
+    QVERIFY(edited->getLastEdited() > sharedStartTime);
+    QCOMPARE(EntityViewClusters::computeSharedPriority(visibleEntity(edited), edited, view, sharedStartTime),
+             PrioritizedEntity::DO_NOT_SEND);
+
+    // as is one the server changed since, such as by simulation
+    while (usecTimestampNow() <= sharedStartTime) {
+    }
+    changed->markAsChangedOnServer();
+    QVERIFY(changed->getLastChangedOnServer() > sharedStartTime);
+    QCOMPARE(EntityViewClusters::computeSharedPriority(visibleEntity(changed), changed, view, sharedStartTime),
+             view.computePriority(changed));
+}
@@ -0,0 +1,26 @@
+//
+//  EntityViewClustersTests.h
+//  tests/assignment-client/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityViewClustersTests_h
+#define hifi_EntityViewClustersTests_h
+
+#include <QtCore/QObject>
+
+class EntityViewClustersTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testMatching();
+    void testNewerSetReplacesOlder();
+    void testAgeCutoff();
+    void testMaxVisibleSets();
+    void testSharedPriority();
+};
+
+#endif // hifi_EntityViewClustersTests_h
@@ -0,0 +1,124 @@
+//
+//  TraitBlobCacheTests.cpp
+//  tests/assignment-client/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TraitBlobCacheTests.h"
+
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include <TraitBlobCache.h>
+
+QTEST_MAIN(TraitBlobCacheTests)
+
+using BlobPointer = TraitBlobCache::BlobPointer;
+
+static int getStat(const TraitBlobCache& cache, const char* name) {
+    return cache.getStatsJSON()[name].toInt();
+}
+
+void TraitBlobCacheTests::testHitsAndMisses() {
+    TraitBlobCache cache;
+    QByteArray skeletonURL("https://example.com/avatars/avatar.fst");
+
+    BlobPointer first = cache.insert(skeletonURL);
+    QVERIFY(first);
+    QCOMPARE(first->data, skeletonURL);
+    QCOMPARE(getStat(cache, "misses"), 1);
+    QCOMPARE(getStat(cache, "hits"), 0);
+
+    // the same contents from another avatar, in a buffer of their own
+    QByteArray sameURL(skeletonURL.constData(), skeletonURL.size());
+    BlobPointer second = cache.insert(sameURL);
+    QCOMPARE(second.get(), first.get());
+    QCOMPARE(getStat(cache, "misses"), 1);
+    QCOMPARE(getStat(cache, "hits"), 1);
+
+    BlobPointer other = cache.insert(QByteArray("https://example.com/avatars/other.fst"));
+    QVERIFY(other.get() != first.get());
+    QVERIFY(other->hash != first->hash);
+    QCOMPARE(getStat(cache, "misses"), 2);
+    QCOMPARE(getStat(cache, "blobs"), 2);
+    QCOMPARE(getStat(cache, "bytes"), first->data.size() + other->data.size());
+
+    // a trait that was never set isn't stored, nor counted, while an empty one is
+    QVERIFY(!cache.insert(QByteArray()));
+    QCOMPARE(getStat(cache, "misses"), 2);
+    BlobPointer empty = cache.insert(QByteArray(""));
+    QVERIFY(empty);
+    QVERIFY(empty->data.isEmpty());
+    QCOMPARE(cache.insert(QByteArray("")).get(), empty.get());
+    QCOMPARE(getStat(cache, "misses"), 3);
+    QCOMPARE(getStat(cache, "hits"), 2);
+}
+
+void TraitBlobCacheTests::testRefcount() {
+    TraitBlobCache cache;
+    QByteArray data("avatar entity data");
+
+    BlobPointer first = cache.insert(data);
+    BlobPointer second = cache.insert(data);
+    // the cache itself doesn't keep the blob alive
+    QCOMPARE(first.use_count(), 2L);
+
+    // the blob lives as long as one avatar holds it
+    first.reset();
+    QCOMPARE(cache.insert(data).get(), second.get());
+    QCOMPARE(getStat(cache, "hits"), 2);
+    QCOMPARE(getStat(cache, "blobs"), 1);
+
+    // then it goes, and the same data is stored again
+    second.reset();
+    QCOMPARE(getStat(cache, "blobs"), 0);
+    QCOMPARE(getStat(cache, "bytes"), 0);
+    BlobPointer third = cache.insert(data);
+    QVERIFY(third);
+    QCOMPARE(third->data, data);
+    QCOMPARE(getStat(cache, "misses"), 2);
+    QCOMPARE(getStat(cache, "entries"), 1);
+}
+
+void TraitBlobCacheTests::testEviction() {
+    TraitBlobCache cache;
+
+    // blobs held by avatars survive the pruning, the released ones don't
+    std::vector<BlobPointer> held;
+    for (int i = 0; i < TraitBlobCache::PRUNE_INTERVAL - 1; i++) {
+        BlobPointer blob = cache.insert(QByteArray::number(i));
+        if (i % 4 == 0) {
+            held.push_back(blob);
+        }
+    }
+    QCOMPARE(getStat(cache, "entries"), TraitBlobCache::PRUNE_INTERVAL - 1);
+    QCOMPARE(getStat(cache, "blobs"), (int)held.size());
+
+    // the insert that triggers the pruning holds its own blob
+    BlobPointer last = cache.insert(QByteArray("last"));
+    QCOMPARE(getStat(cache, "entries"), (int)held.size() + 1);
+    QCOMPARE(getStat(cache, "blobs"), (int)held.size() + 1);
+
+    // the survivors are still shared
+    QCOMPARE(cache.insert(QByteArray::number(0)).get(), held.front().get());
+    QCOMPARE(cache.insert(QByteArray("last")).get(), last.get());
+
+    // the released ones stay listed until the next pruning, which hits don't count towards
+    int numEntries = (int)held.size() + 1;
+    held.clear();
+    last.reset();
+    QCOMPARE(getStat(cache, "blobs"), 0);
+    QCOMPARE(getStat(cache, "entries"), numEntries);
+    for (int i = 0; i < TraitBlobCache::PRUNE_INTERVAL - 1; i++) {
+        cache.insert(QByteArray("new ") + QByteArray::number(i));
+    }
+    QCOMPARE(getStat(cache, "entries"), numEntries + TraitBlobCache::PRUNE_INTERVAL - 1);
+    BlobPointer next = cache.insert(QByteArray("next"));
+    QCOMPARE(getStat(cache, "entries"), 1);
+    QCOMPARE(getStat(cache, "blobs"), 1);
+}
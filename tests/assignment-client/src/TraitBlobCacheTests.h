@@ -0,0 +1,24 @@
+//
+//  TraitBlobCacheTests.h
+//  tests/assignment-client/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TraitBlobCacheTests_h
+#define hifi_TraitBlobCacheTests_h
+
+#include <QtCore/QObject>
+
+class TraitBlobCacheTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testHitsAndMisses();
+    void testRefcount();
+    void testEviction();
+};
+
+#endif // hifi_TraitBlobCacheTests_h
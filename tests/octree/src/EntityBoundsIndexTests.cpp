@@ -0,0 +1,361 @@
+//
+//  EntityBoundsIndexTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityBoundsIndexTests.h"
+
+#include <random>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSet>
+#include <QtTest/QtTest>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <AABox.h>
+#include <EntityBoundsIndex.h>
+#include <EntityItemProperties.h>
+#include <EntityTypes.h>
+#include <GLMHelpers.h>
+#include <NumericalConstants.h>
+#include <ViewFrustum.h>
+
+#include <test-utils/Benchmarks.h>
+
+QTEST_MAIN(EntityBoundsIndexTests)
+
+// the size of the synthetic domain used by benchmarkQueries
+static const int NUM_BENCHMARK_ENTITIES = 100000;
+static const int NUM_BENCHMARK_QUERIES = 1000;
+static const float BENCHMARK_WORLD_SIZE = 1000.0f;
+
+static const int NUM_TEST_ENTITIES = 2000;
+static const int NUM_TEST_QUERIES = 100;
+static const float TEST_WORLD_SIZE = 100.0f;
+
+using EntityBoxTest = std::function<bool(const AABox& entityBox)>;
+
+static glm::vec3 randomPoint(std::mt19937& random, float worldSize) {
+    std::uniform_real_distribution<float> coordinate(-0.5f * worldSize, 0.5f * worldSize);
+    return glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+}
+
+static glm::vec3 randomDirection(std::mt19937& random) {
+    std::normal_distribution<float> coordinate;
+    glm::vec3 direction;
+    do {
+        direction = glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+    } while (glm::length(direction) < 0.01f);
+    return glm::normalize(direction);
+}
+
+static EntityItemPointer makeEntity(std::mt19937& random, float worldSize) {
+    std::uniform_real_distribution<float> size(0.1f, 5.0f);
+    std::uniform_real_distribution<float> angle(0.0f, TWO_PI);
+    EntityItemProperties properties;
+    properties.setPosition(randomPoint(random, worldSize));
+    properties.setDimensions(glm::vec3(size(random), size(random), size(random)));
+    properties.setRotation(glm::angleAxis(angle(random), randomDirection(random)));
+    return EntityTypes::constructEntityItem(EntityTypes::Box, EntityItemID(QUuid::createUuid()), properties);
+}
+
+static ViewFrustum makeFrustum(std::mt19937& random, float worldSize, float farClip) {
+    ViewFrustum frustum;
+    frustum.setProjection(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, farClip));
+    frustum.setPosition(randomPoint(random, worldSize));
+    frustum.setOrientation(glm::rotation(Vectors::UNIT_NEG_Z, randomDirection(random)));
+    frustum.calculate();
+    return frustum;
+}
+
+static bool getBox(const EntityItemPointer& entity, AABox& box) {
+    bool success;
+    box = entity->getAABox(success);
+    return success;
+}
+
+static float findRayHit(const AABox& box, const glm::vec3& origin, const glm::vec3& direction) {
+    float distance;
+    BoxFace face;
+    glm::vec3 normal;
+    if (box.contains(origin)) {
+        return 0.0f;
+    }
+    return box.findRayIntersection(origin, direction, 1.0f / direction, distance, face, normal) ? distance : FLT_MAX;
+}
+
+static QSet<QUuid> findBruteForce(const std::vector<EntityItemPointer>& entities, const EntityBoxTest& test) {
+    QSet<QUuid> result;
+    for (const auto& entity : entities) {
+        AABox box;
+        if (getBox(entity, box) && test(box)) {
+            result.insert(entity->getID());
+        }
+    }
+    return result;
+}
+
+static EntityBoundsIndex::EntityOperator collect(QSet<QUuid>& result, const EntityBoxTest& test) {
+    return [&result, test](const EntityItemPointer& entity) {
+        AABox box;
+        if (getBox(entity, box) && test(box)) {
+            result.insert(entity->getID());
+        }
+    };
+}
+
+static float findNearestBruteForce(const std::vector<EntityItemPointer>& entities, const glm::vec3& point, float maxDistance) {
+    float nearest = maxDistance;
+    for (const auto& entity : entities) {
+        nearest = std::min(nearest, glm::distance(point, entity->getWorldPosition()));
+    }
+    return nearest;
+}
+
+static float findNearestIndexed(EntityBoundsIndex& index, const glm::vec3& point, float maxDistance) {
+    float nearest = maxDistance;
+    index.findNearest(point, maxDistance, [&](const EntityItemPointer& entity, float boundsDistance) {
+        nearest = std::min(nearest, glm::distance(point, entity->getWorldPosition()));
+        return nearest;
+    });
+    return nearest;
+}
+
+static float findRayBruteForce(const std::vector<EntityItemPointer>& entities, const glm::vec3& origin,
+        const glm::vec3& direction) {
+    float nearest = FLT_MAX;
+    for (const auto& entity : entities) {
+        AABox box;
+        if (getBox(entity, box)) {
+            nearest = std::min(nearest, findRayHit(box, origin, direction));
+        }
+    }
+    return nearest;
+}
+
+static float findRayIndexed(EntityBoundsIndex& index, const glm::vec3& origin, const glm::vec3& direction) {
+    float nearest = FLT_MAX;
+    index.findAlongRay(origin, direction, [&](const EntityItemPointer& entity, float boundsDistance) {
+        AABox box;
+        if (getBox(entity, box)) {
+            nearest = std::min(nearest, findRayHit(box, origin, direction));
+        }
+        return nearest;
+    });
+    return nearest;
+}
+
+// runs every kind of query on the index and compares the results with testing every entity
+static void compareQueries(EntityBoundsIndex& index, const std::vector<EntityItemPointer>& entities, std::mt19937& random) {
+    std::uniform_real_distribution<float> size(0.0f, 0.2f * TEST_WORLD_SIZE);
+    for (int i = 0; i < NUM_TEST_QUERIES; i++) {
+        AABox box(randomPoint(random, TEST_WORLD_SIZE), glm::vec3(size(random), size(random), size(random)));
+        EntityBoxTest boxTest = [&](const AABox& entityBox) { return entityBox.touches(box); };
+        QSet<QUuid> inBox;
+        index.findInBox(box, collect(inBox, boxTest));
+        QCOMPARE(inBox, findBruteForce(entities, boxTest));
+
+        glm::vec3 center = randomPoint(random, TEST_WORLD_SIZE);
+        float radius = size(random);
+        EntityBoxTest sphereTest = [&](const AABox& entityBox) { return entityBox.touchesSphere(center, radius); };
+        QSet<QUuid> inSphere;
+        index.findInSphere(center, radius, collect(inSphere, sphereTest));
+        QCOMPARE(inSphere, findBruteForce(entities, sphereTest));
+
+        ViewFrustum frustum = makeFrustum(random, TEST_WORLD_SIZE, 0.5f * TEST_WORLD_SIZE);
+        EntityBoxTest frustumTest = [&](const AABox& entityBox) {
+            return frustum.boxIntersectsFrustum(entityBox) || frustum.boxIntersectsKeyhole(entityBox);
+        };
+        QSet<QUuid> inFrustum;
+        index.findInFrustum(frustum, collect(inFrustum, frustumTest));
+        QCOMPARE(inFrustum, findBruteForce(entities, frustumTest));
+
+        glm::vec3 origin = randomPoint(random, 1.5f * TEST_WORLD_SIZE);
+        glm::vec3 direction = randomDirection(random);
+        QCOMPARE(findRayIndexed(index, origin, direction), findRayBruteForce(entities, origin, direction));
+
+        glm::vec3 velocity = 10.0f * direction;
+        glm::vec3 acceleration(0.0f, -9.8f, 0.0f);
+        EntityBoxTest parabolaTest = [&](const AABox& entityBox) {
+            float distance;
+            BoxFace face;
+            glm::vec3 normal;
+            return entityBox.findParabolaIntersection(origin, velocity, acceleration, distance, face, normal);
+        };
+        QSet<QUuid> alongParabola;
+        index.findAlongParabola(origin, velocity, acceleration, collect(alongParabola, parabolaTest));
+        QCOMPARE(alongParabola, findBruteForce(entities, parabolaTest));
+
+        QCOMPARE(findNearestIndexed(index, center, radius), findNearestBruteForce(entities, center, radius));
+    }
+}
+
+void EntityBoundsIndexTests::testQueries() {
+    std::mt19937 random(1);
+    auto index = std::make_shared<EntityBoundsIndex>();
+    std::vector<EntityItemPointer> entities;
+
+    // before anything is indexed, while the entities are pending, and once they are in the hierarchy
+    compareQueries(*index, entities, random);
+    for (int i = 0; i < 10; i++) {
+        entities.push_back(makeEntity(random, TEST_WORLD_SIZE));
+        index->addEntity(entities.back());
+    }
+    compareQueries(*index, entities, random);
+    QCOMPARE(index->getNumNodes(), 0);
+
+    while ((int)entities.size() < NUM_TEST_ENTITIES) {
+        entities.push_back(makeEntity(random, TEST_WORLD_SIZE));
+        index->addEntity(entities.back());
+    }
+    compareQueries(*index, entities, random);
+    QCOMPARE(index->getNumEntities(), NUM_TEST_ENTITIES);
+    QVERIFY(index->getNumNodes() > 0);
+}
+
+void EntityBoundsIndexTests::testUpdates() {
+    std::mt19937 random(2);
+    auto index = std::make_shared<EntityBoundsIndex>();
+    std::vector<EntityItemPointer> entities;
+    for (int i = 0; i < NUM_TEST_ENTITIES; i++) {
+        entities.push_back(makeEntity(random, TEST_WORLD_SIZE));
+        index->addEntity(entities.back());
+    }
+    compareQueries(*index, entities, random);
+    int numRebuilds = index->getNumRebuilds();
+
+    // moves within the loose bounds and rotations don't change the hierarchy, the others refit it
+    std::uniform_real_distribution<float> angle(0.0f, TWO_PI);
+    for (int i = 0; i < NUM_TEST_ENTITIES / 10; i++) {
+        auto& entity = entities[i];
+        entity->setWorldPosition(entity->getWorldPosition() + glm::vec3(0.001f));
+        entity->setWorldOrientation(glm::angleAxis(angle(random), randomDirection(random)));
+    }
+    for (int i = NUM_TEST_ENTITIES / 10; i < NUM_TEST_ENTITIES / 5; i++) {
+        entities[i]->setWorldPosition(randomPoint(random, TEST_WORLD_SIZE));
+        // moved twice before the index is updated
+        entities[i]->setWorldPosition(randomPoint(random, TEST_WORLD_SIZE));
+    }
+    compareQueries(*index, entities, random);
+    QCOMPARE(index->getNumRebuilds(), numRebuilds);
+
+    // removed, and added back again
+    for (int i = 0; i < NUM_TEST_ENTITIES / 10; i++) {
+        index->removeEntity(entities[i]);
+    }
+    index->addEntity(entities[0]);
+    std::vector<EntityItemPointer> remaining(entities.begin() + 1, entities.begin() + NUM_TEST_ENTITIES / 10);
+    entities.erase(entities.begin() + 1, entities.begin() + NUM_TEST_ENTITIES / 10);
+    for (int i = 0; i < NUM_TEST_ENTITIES / 10; i++) {
+        entities.push_back(makeEntity(random, TEST_WORLD_SIZE));
+        index->addEntity(entities.back());
+    }
+    compareQueries(*index, entities, random);
+    QCOMPARE(index->getNumEntities(), (int)entities.size());
+
+    // the removed entities aren't indexed anymore, and moving them doesn't add them back
+    for (auto& entity : remaining) {
+        entity->setWorldPosition(randomPoint(random, TEST_WORLD_SIZE));
+    }
+    compareQueries(*index, entities, random);
+    QCOMPARE(index->getNumEntities(), (int)entities.size());
+}
+
+void EntityBoundsIndexTests::benchmarkQueries() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    std::mt19937 random(3);
+    auto index = std::make_shared<EntityBoundsIndex>();
+    std::vector<EntityItemPointer> entities;
+    for (int i = 0; i < NUM_BENCHMARK_ENTITIES; i++) {
+        entities.push_back(makeEntity(random, BENCHMARK_WORLD_SIZE));
+        index->addEntity(entities.back());
+    }
+    QElapsedTimer timer;
+    timer.start();
+    QCOMPARE(index->getNumEntities(), NUM_BENCHMARK_ENTITIES);
+    qDebug() << "built the index of" << NUM_BENCHMARK_ENTITIES << "entities in" << timer.elapsed() << "msecs";
+
+    // each kind of query is run against the index, then against every entity
+    auto run = [&](const char* name, const std::function<int(bool indexed, int query)>& query) {
+        QElapsedTimer queryTimer;
+        int numIndexed = 0;
+        queryTimer.start();
+        for (int i = 0; i < NUM_BENCHMARK_QUERIES; i++) {
+            numIndexed += query(true, i);
+        }
+        qint64 indexedUsecs = queryTimer.nsecsElapsed() / NSECS_PER_USEC;
+
+        int numBruteForce = 0;
+        queryTimer.restart();
+        for (int i = 0; i < NUM_BENCHMARK_QUERIES; i++) {
+            numBruteForce += query(false, i);
+        }
+        qint64 bruteForceUsecs = queryTimer.nsecsElapsed() / NSECS_PER_USEC;
+
+        QCOMPARE(numIndexed, numBruteForce);
+        qDebug() << name << "queries:" << (float)indexedUsecs / NUM_BENCHMARK_QUERIES << "usecs with the index,"
+                 << (float)bruteForceUsecs / NUM_BENCHMARK_QUERIES << "usecs testing every entity,"
+                 << (float)numIndexed / NUM_BENCHMARK_QUERIES << "results per query";
+    };
+
+    std::vector<AABox> boxes;
+    std::vector<glm::vec3> points;
+    std::vector<glm::vec3> directions;
+    std::vector<ViewFrustum> frustums;
+    for (int i = 0; i < NUM_BENCHMARK_QUERIES; i++) {
+        boxes.push_back(AABox(randomPoint(random, BENCHMARK_WORLD_SIZE), glm::vec3(20.0f)));
+        points.push_back(randomPoint(random, BENCHMARK_WORLD_SIZE));
+        directions.push_back(randomDirection(random));
+        frustums.push_back(makeFrustum(random, BENCHMARK_WORLD_SIZE, 100.0f));
+    }
+    const float SPHERE_RADIUS = 10.0f;
+
+    run("box", [&](bool indexed, int query) {
+        EntityBoxTest test = [&](const AABox& entityBox) { return entityBox.touches(boxes[query]); };
+        QSet<QUuid> result;
+        if (indexed) {
+            index->findInBox(boxes[query], collect(result, test));
+        } else {
+            result = findBruteForce(entities, test);
+        }
+        return result.size();
+    });
+
+    run("sphere", [&](bool indexed, int query) {
+        EntityBoxTest test = [&](const AABox& entityBox) { return entityBox.touchesSphere(points[query], SPHERE_RADIUS); };
+        QSet<QUuid> result;
+        if (indexed) {
+            index->findInSphere(points[query], SPHERE_RADIUS, collect(result, test));
+        } else {
+            result = findBruteForce(entities, test);
+        }
+        return result.size();
+    });
+
+    run("ray", [&](bool indexed, int query) {
+        float distance = indexed ? findRayIndexed(*index, points[query], directions[query]) :
+            findRayBruteForce(entities, points[query], directions[query]);
+        return distance < FLT_MAX ? 1 : 0;
+    });
+
+    run("frustum", [&](bool indexed, int query) {
+        const ViewFrustum& frustum = frustums[query];
+        EntityBoxTest test = [&](const AABox& entityBox) {
+            return frustum.boxIntersectsFrustum(entityBox) || frustum.boxIntersectsKeyhole(entityBox);
+        };
+        QSet<QUuid> result;
+        if (indexed) {
+            index->findInFrustum(frustum, collect(result, test));
+        } else {
+            result = findBruteForce(entities, test);
+        }
+        return result.size();
+    });
+}
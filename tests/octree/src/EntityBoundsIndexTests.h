@@ -0,0 +1,24 @@
+//
+//  EntityBoundsIndexTests.h
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityBoundsIndexTests_h
+#define hifi_EntityBoundsIndexTests_h
+
+#include <QtCore/QObject>
+
+class EntityBoundsIndexTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testQueries();
+    void testUpdates();
+    void benchmarkQueries();
+};
+
+#endif // hifi_EntityBoundsIndexTests_h
@@ -0,0 +1,225 @@
+//
+//  EntityEditBatchTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityEditBatchTests.h"
+
+#include <memory>
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include <DependencyManager.h>
+#include <EntityEditFilterRules.h>
+#include <EntityEditFilters.h>
+#include <EntityItemProperties.h>
+#include <EntityTree.h>
+#include <Node.h>
+#include <NodeList.h>
+#include <ReceivedMessage.h>
+#include <udt/PacketHeaders.h>
+
+QTEST_MAIN(EntityEditBatchTests)
+
+static const int MAX_EDIT_SIZE = 16 * 1024;
+
+struct TestEdit {
+    PacketType type;
+    QByteArray data;
+};
+
+static quint64 nextEditTime() {
+    // every edit is newer than the last one, however quickly they are made
+    static quint64 lastEditTime = usecTimestampNow();
+    return ++lastEditTime;
+}
+
+static TestEdit makeEdit(PacketType type, const EntityItemID& id, EntityItemProperties properties) {
+    properties.setLastEdited(nextEditTime());
+    TestEdit edit { type, QByteArray(MAX_EDIT_SIZE, 0) };
+    EntityPropertyFlags didntFitProperties;
+    EntityItemProperties::encodeEntityEditPacket(type, id, properties, edit.data, properties.getChangedProperties(),
+                                                 didntFitProperties);
+    return edit;
+}
+
+static TestEdit makeRename(const EntityItemID& id, const QString& name) {
+    EntityItemProperties properties;
+    properties.setName(name);
+    return makeEdit(PacketType::EntityEdit, id, properties);
+}
+
+static TestEdit makeMove(const EntityItemID& id, const glm::vec3& position) {
+    EntityItemProperties properties;
+    properties.setPosition(position);
+    return makeEdit(PacketType::EntityEdit, id, properties);
+}
+
+static TestEdit makeErase(const EntityItemID& id) {
+    TestEdit edit { PacketType::EntityErase, QByteArray() };
+    EntityItemProperties::encodeEraseEntityMessage(id, edit.data);
+    return edit;
+}
+
+static EntityItemProperties makeBox(const glm::vec3& position, const QString& name) {
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    properties.setPosition(position);
+    properties.setDimensions(glm::vec3(1.0f));
+    properties.setName(name);
+    return properties;
+}
+
+static EntityTreePointer makeServerTree() {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+    tree->setIsServer(true);
+    return tree;
+}
+
+static SharedNodePointer makeSender() {
+    // may rez, but has no lock rights, so its edits go through the filters
+    SharedNodePointer sender(new Node(QUuid::createUuid(), NodeType::Agent, HifiSockAddr(), HifiSockAddr()));
+    NodePermissions permissions;
+    permissions.set(NodePermissions::Permission::canRezPermanentEntities);
+    sender->setPermissions(permissions);
+    return sender;
+}
+
+// as the entity server does: every edit of the batch is prepared against the tree as it was before the batch, then
+// they are all applied in order
+static bool applyBatch(const EntityTreePointer& tree, const SharedNodePointer& sender, const std::vector<TestEdit>& edits) {
+    std::vector<std::unique_ptr<ReceivedMessage>> messages;
+    std::vector<Octree::PreparedEditPointer> preparedEdits;
+    tree->withReadLock([&] {
+        for (const auto& edit : edits) {
+            messages.emplace_back(new ReceivedMessage(edit.data, edit.type, versionForPacketType(edit.type), HifiSockAddr()));
+            preparedEdits.push_back(tree->prepareEditPacketData(*messages.back(),
+                reinterpret_cast<const unsigned char*>(edit.data.constData()), edit.data.size(), sender));
+        }
+    });
+    for (const auto& preparedEdit : preparedEdits) {
+        if (!preparedEdit) {
+            return false;
+        }
+    }
+    tree->withWriteLock([&] {
+        for (size_t i = 0; i < preparedEdits.size(); i++) {
+            tree->applyPreparedEdit(*messages[i], *preparedEdits[i], sender);
+        }
+    });
+    return true;
+}
+
+void EntityEditBatchTests::initTestCase() {
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<NodeList>(NodeType::EntityServer, INVALID_PORT);
+}
+
+void EntityEditBatchTests::testOrder() {
+    EntityTreePointer tree = makeServerTree();
+    SharedNodePointer sender = makeSender();
+    EntityItemID entityID(QUuid::createUuid());
+
+    // edits of an entity added earlier in the same batch
+    QVERIFY(applyBatch(tree, sender, {
+        makeEdit(PacketType::EntityAdd, entityID, makeBox(glm::vec3(1.0f), "first")),
+        makeRename(entityID, "second"),
+        makeRename(entityID, "third")
+    }));
+    auto entity = tree->findEntityByEntityItemID(entityID);
+    QVERIFY(entity);
+    QCOMPARE(entity->getName(), QString("third"));
+
+    // edits after a delete of the same batch find nothing to edit
+    QVERIFY(applyBatch(tree, sender, {
+        makeRename(entityID, "fourth"),
+        makeErase(entityID),
+        makeRename(entityID, "fifth")
+    }));
+    QVERIFY(!tree->findEntityByEntityItemID(entityID));
+    QCOMPARE(entity->getName(), QString("fourth"));
+}
+
+void EntityEditBatchTests::testStats() {
+    EntityTreePointer tree = makeServerTree();
+    SharedNodePointer sender = makeSender();
+    EntityItemID entityID(QUuid::createUuid());
+    EntityItemID otherID(QUuid::createUuid());
+
+    tree->resetEditStats();
+    QVERIFY(applyBatch(tree, sender, {
+        makeEdit(PacketType::EntityAdd, entityID, makeBox(glm::vec3(1.0f), "entity")),
+        makeEdit(PacketType::EntityAdd, otherID, makeBox(glm::vec3(2.0f), "other")),
+        makeRename(entityID, "renamed"),
+        makeMove(otherID, glm::vec3(3.0f)),
+        makeRename(otherID, "renamed"),
+        // an edit of an unknown entity is counted, but neither updates nor creates anything
+        makeRename(EntityItemID(QUuid::createUuid()), "unknown"),
+        // erases aren't edit messages
+        makeErase(otherID)
+    }));
+    QCOMPARE(tree->getTotalEditMessages(), 6);
+    QCOMPARE(tree->getTotalCreates(), 2);
+    QCOMPARE(tree->getTotalUpdates(), 3);
+
+    tree->resetEditStats();
+    QCOMPARE(tree->getTotalEditMessages(), 0);
+    QCOMPARE(tree->getTotalCreates(), 0);
+    QCOMPARE(tree->getTotalUpdates(), 0);
+    QCOMPARE(tree->getAverageFilterTime(), (quint64)0);
+}
+
+void EntityEditBatchTests::testFilterSeesEarlierEdit() {
+    EntityTreePointer tree = makeServerTree();
+    SharedNodePointer sender = makeSender();
+    auto filters = DependencyManager::set<EntityEditFilters>(tree);
+
+    // a zone in which entities can't be renamed
+    EntityItemID zoneID(QUuid::createUuid());
+    EntityItemProperties zoneProperties;
+    zoneProperties.setType(EntityTypes::Zone);
+    zoneProperties.setPosition(glm::vec3(0.0f));
+    zoneProperties.setDimensions(glm::vec3(10.0f));
+    EntityItemID outsideID(QUuid::createUuid());
+    EntityItemID insideID(QUuid::createUuid());
+    bool added = false;
+    tree->withWriteLock([&] {
+        added = tree->addEntity(zoneID, zoneProperties) &&
+            tree->addEntity(outsideID, makeBox(glm::vec3(100.0f, 0.0f, 0.0f), "outside")) &&
+            tree->addEntity(insideID, makeBox(glm::vec3(1.0f, 0.0f, 0.0f), "inside"));
+    });
+    QVERIFY(added);
+    QString error;
+    auto rules = EntityEditFilterRules::fromJson(
+        "{ \"rules\": [ { \"type\": \"rejectProperties\", \"properties\": [ \"name\" ] } ] }", error);
+    QVERIFY(rules);
+    filters->addFilterRules(zoneID, rules);
+
+    // both renames were prepared while the entities were where they started: the first entity outside the zone, the
+    // second one inside.  The moves earlier in the batch decide what the filter says.
+    QVERIFY(applyBatch(tree, sender, {
+        makeMove(outsideID, glm::vec3(2.0f, 0.0f, 0.0f)),
+        makeRename(outsideID, "renamed"),
+        makeMove(insideID, glm::vec3(-100.0f, 0.0f, 0.0f)),
+        makeRename(insideID, "renamed")
+    }));
+
+    auto movedIn = tree->findEntityByEntityItemID(outsideID);
+    QVERIFY(movedIn);
+    QCOMPARE(movedIn->getWorldPosition(), glm::vec3(2.0f, 0.0f, 0.0f));
+    QCOMPARE(movedIn->getName(), QString("outside"));
+
+    auto movedOut = tree->findEntityByEntityItemID(insideID);
+    QVERIFY(movedOut);
+    QCOMPARE(movedOut->getWorldPosition(), glm::vec3(-100.0f, 0.0f, 0.0f));
+    QCOMPARE(movedOut->getName(), QString("renamed"));
+
+    DependencyManager::destroy<EntityEditFilters>();
+}
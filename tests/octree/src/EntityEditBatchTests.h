@@ -0,0 +1,25 @@
+//
+//  EntityEditBatchTests.h
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityEditBatchTests_h
+#define hifi_EntityEditBatchTests_h
+
+#include <QtCore/QObject>
+
+class EntityEditBatchTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void testOrder();
+    void testStats();
+    void testFilterSeesEarlierEdit();
+};
+
+#endif // hifi_EntityEditBatchTests_h
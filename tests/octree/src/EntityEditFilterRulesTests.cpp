@@ -0,0 +1,146 @@
+//
+//  EntityEditFilterRulesTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityEditFilterRulesTests.h"
+
+#include <QtTest/QtTest>
+
+#include <EntityEditFilterRules.h>
+
+QTEST_MAIN(EntityEditFilterRulesTests)
+
+static EntityEditFilterRulesPointer parseRules(const QByteArray& json) {
+    QString error;
+    auto rules = EntityEditFilterRules::fromJson(json, error);
+    if (!rules) {
+        qWarning() << "failed to parse rules:" << error;
+    }
+    return rules;
+}
+
+void EntityEditFilterRulesTests::testParse() {
+    QVERIFY(EntityEditFilterRules::isRulesDocument("  { \"rules\": [] }"));
+    QVERIFY(!EntityEditFilterRules::isRulesDocument("function filter(properties) { return properties; }"));
+
+    QString error;
+    QVERIFY(!EntityEditFilterRules::fromJson("{ \"rules\": [", error));
+    QVERIFY(!error.isEmpty());
+    QVERIFY(!EntityEditFilterRules::fromJson("{ \"rules\": [ { \"type\": \"teleport\" } ] }", error));
+    QVERIFY(!EntityEditFilterRules::fromJson("{ \"rules\": [ { \"type\": \"bounds\" } ] }", error));
+    QVERIFY(!EntityEditFilterRules::fromJson("{ \"rules\": [ { \"type\": \"rateLimit\" } ] }", error));
+    QVERIFY(!EntityEditFilterRules::fromJson(
+        "{ \"rules\": [ { \"type\": \"rejectProperties\", \"properties\": [ \"noSuchProperty\" ] } ] }", error));
+    QVERIFY(!EntityEditFilterRules::fromJson("{ \"filterTypes\": [ \"move\" ], \"rules\": [] }", error));
+
+    auto rules = parseRules("{ \"rules\": [ { \"type\": \"maxDimensions\", \"max\": { \"x\": 1, \"y\": 2, \"z\": 3 } } ] }");
+    QVERIFY(rules);
+    QCOMPARE((int)rules->getRules().size(), 1);
+    QCOMPARE(rules->getRules()[0].maximum, glm::vec3(1.0f, 2.0f, 3.0f));
+    QVERIFY(rules->wantsToFilter(EntityTree::FilterType::Add));
+    QVERIFY(rules->wantsToFilter(EntityTree::FilterType::Physics));
+    QVERIFY(!rules->wantsToFilter(EntityTree::FilterType::Delete));
+
+    rules = parseRules("{ \"filterTypes\": [ \"delete\" ], \"rules\": [] }");
+    QVERIFY(rules);
+    QVERIFY(rules->wantsToFilter(EntityTree::FilterType::Delete));
+    QVERIFY(!rules->wantsToFilter(EntityTree::FilterType::Edit));
+}
+
+void EntityEditFilterRulesTests::testBounds() {
+    auto rules = parseRules("{ \"rules\": [ { \"type\": \"bounds\", "
+        "\"min\": { \"x\": -10, \"y\": 0, \"z\": -10 }, \"max\": { \"x\": 10, \"y\": 5, \"z\": 10 } } ] }");
+    QVERIFY(rules);
+
+    EntityItemProperties properties;
+    properties.setPosition(glm::vec3(20.0f, -1.0f, 3.0f));
+    bool wasChanged = false;
+    QVERIFY(rules->filter(properties, nullptr, nullptr, QUuid(), wasChanged));
+    QVERIFY(wasChanged);
+    QCOMPARE(properties.getPosition(), glm::vec3(10.0f, 0.0f, 3.0f));
+
+    // positions of children are relative to their parent
+    EntityItemProperties childProperties;
+    childProperties.setParentID(QUuid::createUuid());
+    childProperties.setPosition(glm::vec3(20.0f));
+    wasChanged = false;
+    QVERIFY(rules->filter(childProperties, nullptr, nullptr, QUuid(), wasChanged));
+    QVERIFY(!wasChanged);
+
+    auto zoneRules = parseRules("{ \"rules\": [ { \"type\": \"bounds\", \"zone\": true, \"action\": \"reject\" } ] }");
+    QVERIFY(zoneRules);
+    QVERIFY(zoneRules->wantsZoneBounds());
+    AABox zoneBounds(glm::vec3(0.0f), glm::vec3(4.0f));
+
+    EntityItemProperties inside;
+    inside.setPosition(glm::vec3(1.0f, 2.0f, 3.0f));
+    wasChanged = false;
+    QVERIFY(zoneRules->filter(inside, nullptr, &zoneBounds, QUuid(), wasChanged));
+    QVERIFY(!wasChanged);
+
+    EntityItemProperties outside;
+    outside.setPosition(glm::vec3(5.0f, 2.0f, 3.0f));
+    QVERIFY(!zoneRules->filter(outside, nullptr, &zoneBounds, QUuid(), wasChanged));
+}
+
+void EntityEditFilterRulesTests::testMaxDimensions() {
+    auto rules = parseRules("{ \"rules\": [ { \"type\": \"maxDimensions\", \"max\": { \"x\": 2, \"y\": 2, \"z\": 2 } } ] }");
+    QVERIFY(rules);
+
+    EntityItemProperties properties;
+    properties.setDimensions(glm::vec3(1.0f, 3.0f, 2.0f));
+    bool wasChanged = false;
+    QVERIFY(rules->filter(properties, nullptr, nullptr, QUuid(), wasChanged));
+    QVERIFY(wasChanged);
+    QCOMPARE(properties.getDimensions(), glm::vec3(1.0f, 2.0f, 2.0f));
+
+    // edits that don't change the dimensions are left alone
+    EntityItemProperties nameOnly;
+    nameOnly.setName("small");
+    wasChanged = false;
+    QVERIFY(rules->filter(nameOnly, nullptr, nullptr, QUuid(), wasChanged));
+    QVERIFY(!wasChanged);
+    QVERIFY(!nameOnly.containsDimensionsChange());
+}
+
+void EntityEditFilterRulesTests::testRejectProperties() {
+    auto rules = parseRules("{ \"rules\": [ { \"type\": \"rejectProperties\", \"properties\": [ \"script\", \"keyLight\" ] } ] }");
+    QVERIFY(rules);
+
+    bool wasChanged = false;
+    EntityItemProperties allowed;
+    allowed.setName("allowed");
+    QVERIFY(rules->filter(allowed, nullptr, nullptr, QUuid(), wasChanged));
+
+    EntityItemProperties script;
+    script.setScript("https://example.com/script.js");
+    QVERIFY(!rules->filter(script, nullptr, nullptr, QUuid(), wasChanged));
+
+    // a group name rejects all the properties of the group
+    EntityItemProperties keyLight;
+    keyLight.getKeyLight().setIntensity(2.0f);
+    QVERIFY(!rules->filter(keyLight, nullptr, nullptr, QUuid(), wasChanged));
+}
+
+void EntityEditFilterRulesTests::testRateLimit() {
+    auto rules = parseRules("{ \"rules\": [ { \"type\": \"rateLimit\", \"editsPerSecond\": 0.001, \"burst\": 2 } ] }");
+    QVERIFY(rules);
+
+    QUuid sender = QUuid::createUuid();
+    QUuid otherSender = QUuid::createUuid();
+    EntityItemProperties properties;
+    properties.setName("edit");
+    bool wasChanged = false;
+    QVERIFY(rules->filter(properties, nullptr, nullptr, sender, wasChanged));
+    QVERIFY(rules->filter(properties, nullptr, nullptr, sender, wasChanged));
+    QVERIFY(!rules->filter(properties, nullptr, nullptr, sender, wasChanged));
+
+    // each sender has its own limit
+    QVERIFY(rules->filter(properties, nullptr, nullptr, otherSender, wasChanged));
+}
@@ -0,0 +1,26 @@
+//
+//  EntityEditFilterRulesTests.h
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityEditFilterRulesTests_h
+#define hifi_EntityEditFilterRulesTests_h
+
+#include <QtCore/QObject>
+
+class EntityEditFilterRulesTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testParse();
+    void testBounds();
+    void testMaxDimensions();
+    void testRejectProperties();
+    void testRateLimit();
+};
+
+#endif // hifi_EntityEditFilterRulesTests_h
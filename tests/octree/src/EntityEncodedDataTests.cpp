@@ -0,0 +1,214 @@
+//
+//  EntityEncodedDataTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityEncodedDataTests.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include <ByteCountCoding.h>
+#include <DependencyManager.h>
+#include <EntityItem.h>
+#include <EntityItemProperties.h>
+#include <EntityTreeElement.h>
+#include <EntityTypes.h>
+#include <NodeList.h>
+#include <OctreePacketData.h>
+#include <UUID.h>
+
+QTEST_MAIN(EntityEncodedDataTests)
+
+static const int NUM_THREADS = 4;
+static const int NUM_ENCODES = 1000;
+static const int NUM_EDITS = 200;
+
+static EntityItemPointer makeEntity() {
+    EntityItemProperties properties;
+    properties.setName("encoded");
+    properties.setPosition(glm::vec3(1.0f, 2.0f, 3.0f));
+    properties.setDimensions(glm::vec3(0.5f, 1.0f, 2.0f));
+    properties.setUserData("{\"public\":true}");
+    properties.setPrivateUserData("{\"private\":true}");
+    return EntityTypes::constructEntityItem(EntityTypes::Box, EntityItemID(QUuid::createUuid()), properties);
+}
+
+// encodes entity the way EntityTreeSendThread does, or through the regular encode path when cached is false
+static QByteArray encode(const EntityItemPointer& entity, bool cached, bool withPrivateUserData = false,
+                         quint64* trackedLastEdited = nullptr) {
+    OctreePacketData packetData;
+    EncodeBitstreamParams params;
+    params.trackSend = [&](const QUuid&, quint64 itemLastEdited) {
+        if (trackedLastEdited) {
+            *trackedLastEdited = itemLastEdited;
+        }
+    };
+    auto extraEncodeData = std::make_shared<EntityTreeElementExtraEncodeData>();
+    OctreeElement::AppendState state = cached ?
+        entity->appendCachedEntityData(&packetData, params, extraEncodeData, withPrivateUserData) :
+        entity->appendEntityData(&packetData, params, extraEncodeData, withPrivateUserData);
+    if (state != OctreeElement::COMPLETED) {
+        return QByteArray();
+    }
+    return QByteArray((const char*)packetData.getUncompressedData(), packetData.getUncompressedSize());
+}
+
+static void edit(const EntityItemPointer& entity, const QString& name) {
+    EntityItemProperties properties;
+    properties.setName(name);
+    properties.setLastEdited(entity->getLastEdited() + 1);
+    entity->setProperties(properties);
+}
+
+// the last edited time written in an encoding: after the ID, the type and the created time
+static quint64 getEncodedLastEdited(const EntityItemPointer& entity, const QByteArray& data) {
+    ByteCountCoded<quint32> typeCoder = entity->getType();
+    QByteArray encodedType = typeCoder;
+    int offset = NUM_BYTES_RFC4122_UUID + encodedType.size() + (int)sizeof(quint64);
+    quint64 lastEdited = 0;
+    if (data.size() >= offset + (int)sizeof(lastEdited)) {
+        memcpy(&lastEdited, data.constData() + offset, sizeof(lastEdited));
+    }
+    return lastEdited;
+}
+
+void EntityEncodedDataTests::initTestCase() {
+    // the encoding looks up the session ID
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<NodeList>(NodeType::Agent, INVALID_PORT);
+}
+
+void EntityEncodedDataTests::testMatchesEncoding() {
+    EntityItemPointer entity = makeEntity();
+    QByteArray expected = encode(entity, false);
+    QVERIFY(!expected.isEmpty());
+
+    quint64 hits = EntityItem::getEncodedDataCacheHits();
+    quint64 misses = EntityItem::getEncodedDataCacheMisses();
+    quint64 tracked = 0;
+    QCOMPARE(encode(entity, true, false, &tracked), expected);
+    QCOMPARE(tracked, entity->getLastEdited());
+    QCOMPARE(encode(entity, true), expected);
+    QCOMPARE(EntityItem::getEncodedDataCacheMisses(), misses + 1);
+    QCOMPARE(EntityItem::getEncodedDataCacheHits(), hits + 1);
+
+    // the bytes are copied as they are, next to whatever else is in the packet
+    OctreePacketData packetData;
+    EncodeBitstreamParams params;
+    auto extraEncodeData = std::make_shared<EntityTreeElementExtraEncodeData>();
+    QVERIFY(packetData.appendValue((uint16_t)1));
+    QCOMPARE(entity->appendCachedEntityData(&packetData, params, extraEncodeData), OctreeElement::COMPLETED);
+    QByteArray packet((const char*)packetData.getUncompressedData(), packetData.getUncompressedSize());
+    QCOMPARE(packet.mid(sizeof(uint16_t)), expected);
+}
+
+void EntityEncodedDataTests::testEditInvalidates() {
+    EntityItemPointer entity = makeEntity();
+    QByteArray before = encode(entity, true);
+    QCOMPARE(encode(entity, true), before);
+
+    edit(entity, "edited");
+    QByteArray after = encode(entity, false);
+    QVERIFY(after != before);
+    quint64 misses = EntityItem::getEncodedDataCacheMisses();
+    quint64 tracked = 0;
+    QCOMPARE(encode(entity, true, false, &tracked), after);
+    QCOMPARE(tracked, entity->getLastEdited());
+    QCOMPARE(EntityItem::getEncodedDataCacheMisses(), misses + 1);
+
+    // as does a change made by the server, the way EntityTree marks one
+    entity->markAsChangedOnServer();
+    misses = EntityItem::getEncodedDataCacheMisses();
+    encode(entity, true);
+    QCOMPARE(EntityItem::getEncodedDataCacheMisses(), misses + 1);
+}
+
+void EntityEncodedDataTests::testPrivateUserData() {
+    EntityItemPointer entity = makeEntity();
+    QByteArray withoutPrivate = encode(entity, false, false);
+    QByteArray withPrivate = encode(entity, false, true);
+    QVERIFY(withoutPrivate != withPrivate);
+
+    // each variant is cached on its own, in either order
+    QCOMPARE(encode(entity, true, true), withPrivate);
+    QCOMPARE(encode(entity, true, false), withoutPrivate);
+    QCOMPARE(encode(entity, true, true), withPrivate);
+    QCOMPARE(encode(entity, true, false), withoutPrivate);
+    QVERIFY(!encode(entity, true, false).contains("private"));
+}
+
+void EntityEncodedDataTests::testSharedBetweenThreads() {
+    EntityItemPointer entity = makeEntity();
+    QByteArray expected = encode(entity, false);
+    QByteArray encodedID = entity->getID().toRfc4122();
+
+    // every send thread gets the same bytes
+    std::atomic<int> numWrong { 0 };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < NUM_ENCODES; j++) {
+                if (encode(entity, true) != expected) {
+                    numWrong++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+    QCOMPARE(numWrong.load(), 0);
+
+    // Edits landing while the send threads encode can leave an encoding part way between two versions of the entity,
+    // as they can for the regular encode path, but the time reported to the send thread must never be later than the
+    // one the client is sent, or the client would miss the next version.
+    std::atomic<bool> isEditing { true };
+    std::atomic<int> numEncodes { 0 };
+    for (int i = 0; i < NUM_THREADS; i++) {
+        threads.emplace_back([&] {
+            while (isEditing) {
+                quint64 tracked = 0;
+                QByteArray data = encode(entity, true, false, &tracked);
+                if (!data.startsWith(encodedID) || tracked > getEncodedLastEdited(entity, data)) {
+                    numWrong++;
+                }
+                numEncodes++;
+            }
+        });
+    }
+    for (int i = 0; i < NUM_EDITS; i++) {
+        edit(entity, QString("edit %1").arg(i));
+        std::this_thread::yield();
+    }
+    isEditing = false;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+    QCOMPARE(numWrong.load(), 0);
+    QVERIFY(numEncodes > 0);
+
+    // once the edits stop, every send thread gets the latest version
+    expected = encode(entity, false);
+    for (int i = 0; i < NUM_THREADS; i++) {
+        threads.emplace_back([&] {
+            if (encode(entity, true) != expected) {
+                numWrong++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    QCOMPARE(numWrong.load(), 0);
+}
@@ -0,0 +1,26 @@
+//
+//  EntityEncodedDataTests.h
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityEncodedDataTests_h
+#define hifi_EntityEncodedDataTests_h
+
+#include <QtCore/QObject>
+
+class EntityEncodedDataTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void testMatchesEncoding();
+    void testEditInvalidates();
+    void testPrivateUserData();
+    void testSharedBetweenThreads();
+};
+
+#endif // hifi_EntityEncodedDataTests_h
@@ -0,0 +1,265 @@
+//
+//  EntityJSONReaderTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityJSONReaderTests.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtScript/QScriptEngine>
+#include <QtTest/QtTest>
+
+#include <EntityItemProperties.h>
+#include <EntityJSONReader.h>
+#include <OctreeEntitiesFileParser.h>
+#include <SharedUtil.h>
+#include <VariantMapToScriptValue.h>
+
+#include <test-utils/Benchmarks.h>
+
+QTEST_MAIN(EntityJSONReaderTests)
+
+// the size of the export used by benchmarkImport
+static const int NUM_BENCHMARK_ENTITIES = 100000;
+
+static EntityItemProperties makeProperties(int index) {
+    EntityItemProperties properties;
+    properties.setCreated(1600000000000000 + index);
+    properties.setName(QString("entity \"%1\"\né").arg(index));
+    properties.setPosition(glm::vec3((float)index, 2.5f, -3.0f));
+    properties.setDimensions(glm::vec3(0.5f, 1.0f, 2.0f));
+    properties.setRotation(glm::angleAxis((float)index * 0.01f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    properties.setUserData(QString("{\"index\":%1}").arg(index));
+    properties.setParentJointIndex(3);
+    properties.setCollisionless(true);
+
+    switch (index % 4) {
+        case 0:
+            properties.setType(EntityTypes::Box);
+            properties.setColor(glm::u8vec3(10, 20, 30));
+            break;
+        case 1:
+            // has a group property, which goes through the script conversion
+            properties.setType(EntityTypes::Model);
+            properties.setModelURL(QString("https://example.com/models/%1.fbx").arg(index % 10));
+            properties.setShapeType(SHAPE_TYPE_SIMPLE_COMPOUND);
+            properties.getAnimation().setURL("https://example.com/animations/walk.fbx");
+            properties.getAnimation().setFPS(24.0f);
+            break;
+        case 2:
+            properties.setType(EntityTypes::Zone);
+            properties.setKeyLightMode(COMPONENT_MODE_ENABLED);
+            properties.getKeyLight().setIntensity(2.0f);
+            break;
+        default:
+            properties.setType(EntityTypes::PolyLine);
+            properties.setLinePoints({ glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f) });
+            properties.setStrokeWidths({ 0.1f, 0.2f });
+            break;
+    }
+    return properties;
+}
+
+// an export like the ones written by Octree::toJSONString
+static QByteArray makeJSON(int numEntities, std::vector<QUuid>& ids, std::function<EntityItemProperties(int)> makeEntity = makeProperties) {
+    QScriptEngine scriptEngine;
+    QString json = "{\n  \"DataVersion\": 3,\n  \"Entities\": [";
+    for (int i = 0; i < numEntities; i++) {
+        ids.push_back(QUuid::createUuid());
+        QScriptValue value = EntityItemNonDefaultPropertiesToScriptValue(&scriptEngine, makeEntity(i));
+        value.setProperty("id", ids.back().toString());
+        json += (i > 0 ? ",\n    " : "\n    ") + QJsonDocument::fromVariant(value.toVariant()).toJson(QJsonDocument::Compact);
+    }
+    json += "\n  ],\n  \"Id\": \"{a8c4fe69-7d0e-47e6-8a28-63ea1b6ea9c3}\",\n  \"Paths\": {\n    \"/\": \"/0,0,0/0,0,0,1\"\n  },\n"
+        "  \"Version\": " + QString::number((int)versionForPacketType(PacketType::EntityData)) + "\n}\n";
+    return json.toUtf8();
+}
+
+// everything that can be set, as json, to compare properties read in different ways
+static QString toComparableJSON(QScriptEngine& scriptEngine, const EntityItemProperties& properties) {
+    QVariantMap map = EntityItemNonDefaultPropertiesToScriptValue(&scriptEngine, properties).toVariant().toMap();
+    map.remove("lastEdited");
+    map.remove("age");
+    map.remove("ageAsText");
+    return QJsonDocument::fromVariant(map).toJson(QJsonDocument::Compact);
+}
+
+static std::vector<EntityJSONReader::Entity> readAll(EntityJSONReader& reader) {
+    std::vector<EntityJSONReader::Entity> entities;
+    bool success = reader.readHeader() && reader.readEntities([&](EntityJSONReader::Batch& batch) {
+        for (auto& entity : batch) {
+            entities.push_back(std::move(entity));
+        }
+        return true;
+    });
+    if (!success) {
+        qWarning() << reader.getErrorString();
+        entities.clear();
+    }
+    return entities;
+}
+
+static uint64_t getPeakMemoryUsage() {
+    QFile status("/proc/self/status");
+    if (status.open(QIODevice::ReadOnly)) {
+        for (const QByteArray& line : status.readAll().split('\n')) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').first().toULongLong() * 1024;
+            }
+        }
+    }
+    MemoryInfo info;
+    return getMemoryInfo(info) ? info.processPeakUsedMemoryBytes : 0;
+}
+
+void EntityJSONReaderTests::testMatchesScriptConversion() {
+    const int NUM_ENTITIES = 40;
+    std::vector<QUuid> ids;
+    QByteArray json = makeJSON(NUM_ENTITIES, ids);
+
+    EntityJSONReader reader(json);
+    std::vector<EntityJSONReader::Entity> entities = readAll(reader);
+    QCOMPARE((int)entities.size(), NUM_ENTITIES);
+    QCOMPARE(reader.getDataVersion(), 3);
+    QCOMPARE(reader.getPersistID(), QUuid("{a8c4fe69-7d0e-47e6-8a28-63ea1b6ea9c3}"));
+    QCOMPARE(reader.getVersion(), (int)versionForPacketType(PacketType::EntityData));
+    QCOMPARE(reader.getPaths()["/"].toString(), QString("/0,0,0/0,0,0,1"));
+
+    // only the entities with group properties or lists needed the script conversion
+    QVERIFY(reader.getNumConvertedEntities() < NUM_ENTITIES);
+
+    // the same as going through a QVariantMap and a QScriptValue
+    OctreeEntitiesFileParser parser;
+    parser.setEntitiesString(json);
+    QVariantMap map;
+    QVERIFY(parser.parseEntities(map));
+    QVariantList entitiesList = map["Entities"].toList();
+    QCOMPARE(entitiesList.size(), NUM_ENTITIES);
+
+    QScriptEngine scriptEngine;
+    for (int i = 0; i < NUM_ENTITIES; i++) {
+        QVariantMap entityMap = entitiesList[i].toMap();
+        EntityItemProperties expected;
+        EntityItemPropertiesFromScriptValueIgnoreReadOnly(variantMapToScriptValue(entityMap, scriptEngine), expected);
+
+        QCOMPARE(entities[i].id, EntityItemID(ids[i]));
+        QCOMPARE(entities[i].properties.getChangedProperties(), expected.getChangedProperties());
+        QCOMPARE(toComparableJSON(scriptEngine, entities[i].properties), toComparableJSON(scriptEngine, expected));
+    }
+}
+
+void EntityJSONReaderTests::testRelativeURLs() {
+    std::vector<QUuid> ids;
+    QByteArray json = makeJSON(2, ids, [](int) {
+        EntityItemProperties properties = makeProperties(1);
+        properties.setModelURL("./models/chair.fbx");
+        properties.getAnimation().setURL("../animations/sit.fbx");
+        return properties;
+    });
+
+    EntityJSONReader reader(json);
+    reader.setRelativeURL(QUrl("https://example.com/content/"));
+    reader.setMarketplaceID("marketplace");
+    std::vector<EntityJSONReader::Entity> entities = readAll(reader);
+    QCOMPARE((int)entities.size(), 2);
+    QCOMPARE(entities[0].properties.getModelURL(), QString("https://example.com/content/models/chair.fbx"));
+    QCOMPARE(entities[0].properties.getAnimation().getURL(), QString("https://example.com/animations/sit.fbx"));
+    QCOMPARE(entities[0].properties.getMarketplaceID(), QString("marketplace"));
+}
+
+void EntityJSONReaderTests::testBatches() {
+    const int NUM_ENTITIES = 25;
+    const int BATCH_SIZE = 10;
+    std::vector<QUuid> ids;
+    QByteArray json = makeJSON(NUM_ENTITIES, ids);
+
+    EntityJSONReader reader(json);
+    reader.setBatchSize(BATCH_SIZE);
+    QVERIFY(reader.readHeader());
+    std::vector<int> batchSizes;
+    QVERIFY(reader.readEntities([&](EntityJSONReader::Batch& batch) {
+        batchSizes.push_back((int)batch.size());
+        return true;
+    }));
+    QCOMPARE(batchSizes, std::vector<int>({ 10, 10, 5 }));
+
+    // stopping early
+    int numBatches = 0;
+    QVERIFY(!reader.readEntities([&](EntityJSONReader::Batch&) {
+        return ++numBatches < 2;
+    }));
+    QCOMPARE(numBatches, 2);
+}
+
+void EntityJSONReaderTests::testInvalidJSON() {
+    std::vector<QUuid> ids;
+    QByteArray json = makeJSON(3, ids);
+
+    {
+        EntityJSONReader reader(json.left(json.size() / 2));
+        QVERIFY(!reader.readHeader());
+        QVERIFY(!reader.getErrorString().isEmpty());
+    }
+    {
+        QByteArray unknownKey = "{ \"DataVersion\": 1, \"Unknown\": 2 }";
+        EntityJSONReader reader(unknownKey);
+        QVERIFY(!reader.readHeader());
+    }
+    {
+        QByteArray badEntity = "{ \"Entities\": [ { \"name\": \"a\" }, { \"name\": } ], \"Version\": 1 }";
+        EntityJSONReader reader(badEntity);
+        QVERIFY(reader.readHeader());
+        QVERIFY(!reader.readEntities([](EntityJSONReader::Batch&) { return true; }));
+        QVERIFY(reader.getErrorString().startsWith("Error: Line 1"));
+    }
+}
+
+void EntityJSONReaderTests::benchmarkImport() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    std::vector<QUuid> ids;
+    QByteArray json = makeJSON(NUM_BENCHMARK_ENTITIES, ids);
+    // the peak is per process, so the streaming reader is measured first
+    uint64_t startPeak = getPeakMemoryUsage();
+
+    QElapsedTimer timer;
+    timer.start();
+    EntityJSONReader reader(json);
+    int numRead = 0;
+    QVERIFY(reader.readHeader());
+    QVERIFY(reader.readEntities([&](EntityJSONReader::Batch& batch) {
+        numRead += (int)batch.size();
+        return true;
+    }));
+    qint64 readerMsecs = timer.elapsed();
+    uint64_t readerPeak = getPeakMemoryUsage();
+
+    timer.restart();
+    OctreeEntitiesFileParser parser;
+    parser.setEntitiesString(json);
+    QVariantMap map;
+    QVERIFY(parser.parseEntities(map));
+    QScriptEngine scriptEngine;
+    int numConverted = 0;
+    for (const auto& entityVariant : map["Entities"].toList()) {
+        QVariantMap entityMap = entityVariant.toMap();
+        EntityItemProperties properties;
+        EntityItemPropertiesFromScriptValueIgnoreReadOnly(variantMapToScriptValue(entityMap, scriptEngine), properties);
+        numConverted++;
+    }
+    qint64 mapMsecs = timer.elapsed();
+    uint64_t mapPeak = getPeakMemoryUsage();
+
+    QCOMPARE(numRead, NUM_BENCHMARK_ENTITIES);
+    QCOMPARE(numConverted, NUM_BENCHMARK_ENTITIES);
+    const double MB = 1024.0 * 1024.0;
+    qDebug() << json.size() / MB << "MB of json," << NUM_BENCHMARK_ENTITIES << "entities";
+    qDebug() << "streaming:" << readerMsecs << "msecs," << (readerPeak - startPeak) / MB << "MB peak growth";
+    qDebug() << "variant map:" << mapMsecs << "msecs, at least" << (mapPeak - readerPeak) / MB << "MB more peak growth";
+}
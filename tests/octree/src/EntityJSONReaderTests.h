@@ -0,0 +1,26 @@
+//
+//  EntityJSONReaderTests.h
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityJSONReaderTests_h
+#define hifi_EntityJSONReaderTests_h
+
+#include <QtCore/QObject>
+
+class EntityJSONReaderTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testMatchesScriptConversion();
+    void testRelativeURLs();
+    void testBatches();
+    void testInvalidJSON();
+    void benchmarkImport();
+};
+
+#endif // hifi_EntityJSONReaderTests_h
@@ -0,0 +1,146 @@
+//
+//  EntityScriptingInterfaceTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityScriptingInterfaceTests.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtScript/QScriptEngine>
+#include <QtTest/QtTest>
+
+#include <DependencyManager.h>
+#include <EntityScriptingInterface.h>
+#include <EntityTree.h>
+#include <NodeList.h>
+#include <RegisteredMetaTypes.h>
+
+#include <test-utils/Benchmarks.h>
+
+QTEST_MAIN(EntityScriptingInterfaceTests)
+
+// the size of the synthetic domain used by benchmarkGetters
+static const int NUM_BENCHMARK_ENTITIES = 1000;
+static const int NUM_BENCHMARK_CALLS = 100000;
+
+static const int NUM_TEST_ENTITIES = 100;
+
+static EntityItemProperties makeProperties(int index) {
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    properties.setPosition(glm::vec3((float)index, 2.0f, -3.0f));
+    properties.setRotation(glm::angleAxis((float)index * 0.01f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    properties.setDimensions(glm::vec3(1.0f));
+    properties.setUserData(QString("{\"index\":%1}").arg(index));
+    return properties;
+}
+
+static EntityTreePointer makeTree(int numEntities, QVector<QUuid>& ids) {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+    tree->withWriteLock([&] {
+        for (int i = 0; i < numEntities; i++) {
+            ids.push_back(QUuid::createUuid());
+            tree->addEntity(EntityItemID(ids.back()), makeProperties(i));
+        }
+    });
+    return tree;
+}
+
+void EntityScriptingInterfaceTests::initTestCase() {
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<NodeList>(NodeType::Agent, INVALID_PORT);
+}
+
+void EntityScriptingInterfaceTests::testTypedGetters() {
+    QVector<QUuid> ids;
+    EntityScriptingInterface entities(false);
+    entities.setEntityTree(makeTree(NUM_TEST_ENTITIES, ids));
+
+    EntityPropertyFlags desiredProperties;
+    desiredProperties += PROP_POSITION;
+    desiredProperties += PROP_ROTATION;
+    desiredProperties += PROP_USER_DATA;
+    for (const auto& id : ids) {
+        // the typed getters agree with the script semantics of getEntityProperties()
+        EntityItemProperties properties = entities.getEntityProperties(id, desiredProperties);
+        QCOMPARE(entities.getEntityPosition(id), properties.getPosition());
+        QCOMPARE(entities.getEntityRotation(id), properties.getRotation());
+        QCOMPARE(entities.getEntityUserData(id), properties.getUserData());
+    }
+
+    QUuid unknownID = QUuid::createUuid();
+    QCOMPARE(entities.getEntityPosition(unknownID), glm::vec3());
+    QCOMPARE(entities.getEntityRotation(unknownID), glm::quat());
+    QCOMPARE(entities.getEntityUserData(unknownID), QString());
+}
+
+void EntityScriptingInterfaceTests::testMultipleGetters() {
+    QVector<QUuid> ids;
+    EntityScriptingInterface entities(false);
+    entities.setEntityTree(makeTree(NUM_TEST_ENTITIES, ids));
+
+    // unknown entities keep their place in the results
+    QUuid unknownID = QUuid::createUuid();
+    ids.insert(NUM_TEST_ENTITIES / 2, unknownID);
+
+    QVector<glm::vec3> positions = entities.getMultipleEntityPositions(ids);
+    QVector<glm::quat> rotations = entities.getMultipleEntityRotations(ids);
+    QStringList userData = entities.getMultipleEntityUserData(ids);
+    QCOMPARE(positions.size(), ids.size());
+    QCOMPARE(rotations.size(), ids.size());
+    QCOMPARE(userData.size(), ids.size());
+    for (int i = 0; i < ids.size(); i++) {
+        QCOMPARE(positions[i], entities.getEntityPosition(ids[i]));
+        QCOMPARE(rotations[i], entities.getEntityRotation(ids[i]));
+        QCOMPARE(userData[i], entities.getEntityUserData(ids[i]));
+    }
+    QCOMPARE(userData[NUM_TEST_ENTITIES / 2], QString());
+
+    QVERIFY(entities.getMultipleEntityPositions(QVector<QUuid>()).isEmpty());
+}
+
+void EntityScriptingInterfaceTests::benchmarkGetters() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    QVector<QUuid> ids;
+    EntityScriptingInterface entities(false);
+    entities.setEntityTree(makeTree(NUM_BENCHMARK_ENTITIES, ids));
+    QScriptEngine engine;
+
+    // both paths include the conversion to the script value the script gets back
+    EntityPropertyFlags desiredProperties;
+    desiredProperties += PROP_POSITION;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < NUM_BENCHMARK_CALLS; i++) {
+        EntityItemProperties properties = entities.getEntityProperties(ids[i % NUM_BENCHMARK_ENTITIES], desiredProperties);
+        properties.copyToScriptValue(&engine, false, false, false).property("position");
+    }
+    qint64 propertiesNsecs = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int i = 0; i < NUM_BENCHMARK_CALLS; i++) {
+        vec3ToScriptValue(&engine, entities.getEntityPosition(ids[i % NUM_BENCHMARK_ENTITIES]));
+    }
+    qint64 typedNsecs = timer.nsecsElapsed();
+
+    timer.restart();
+    const int NUM_BULK_CALLS = NUM_BENCHMARK_CALLS / NUM_BENCHMARK_ENTITIES;
+    for (int i = 0; i < NUM_BULK_CALLS; i++) {
+        qVectorVec3ToScriptValue(&engine, entities.getMultipleEntityPositions(ids));
+    }
+    qint64 bulkNsecs = timer.nsecsElapsed();
+
+    const double NSECS_PER_SECOND = 1.0e9;
+    qDebug() << "position reads per second: getEntityProperties"
+        << (int)(NUM_BENCHMARK_CALLS * NSECS_PER_SECOND / propertiesNsecs)
+        << "getEntityPosition" << (int)(NUM_BENCHMARK_CALLS * NSECS_PER_SECOND / typedNsecs)
+        << "getMultipleEntityPositions" << (int)(NUM_BULK_CALLS * NUM_BENCHMARK_ENTITIES * NSECS_PER_SECOND / bulkNsecs);
+    QVERIFY(typedNsecs < propertiesNsecs);
+}
@@ -0,0 +1,25 @@
+//
+//  EntityScriptingInterfaceTests.h
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityScriptingInterfaceTests_h
+#define hifi_EntityScriptingInterfaceTests_h
+
+#include <QtCore/QObject>
+
+class EntityScriptingInterfaceTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void testTypedGetters();
+    void testMultipleGetters();
+    void benchmarkGetters();
+};
+
+#endif // hifi_EntityScriptingInterfaceTests_h
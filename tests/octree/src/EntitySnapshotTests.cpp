@@ -0,0 +1,155 @@
+//
+//  EntitySnapshotTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySnapshotTests.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtScript/QScriptEngine>
+#include <QtTest/QtTest>
+
+#include <EntityItemProperties.h>
+#include <EntitySnapshot.h>
+#include <OctreeEntitiesFileParser.h>
+#include <VariantMapToScriptValue.h>
+
+#include <test-utils/Benchmarks.h>
+
+QTEST_MAIN(EntitySnapshotTests)
+
+// the size of the synthetic domain used by benchmarkLoad
+static const int NUM_BENCHMARK_ENTITIES = 100000;
+
+static EntityItemProperties makeProperties(int index) {
+    EntityItemProperties properties;
+    properties.setType(index % 2 ? EntityTypes::Box : EntityTypes::Model);
+    properties.setName(QString("entity %1").arg(index));
+    properties.setPosition(glm::vec3((float)(index % 100), (float)((index / 100) % 100), (float)(index / 10000)));
+    properties.setDimensions(glm::vec3(0.5f, 1.0f, 2.0f));
+    properties.setRotation(glm::angleAxis((float)index * 0.01f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    properties.setUserData(QString("{\"index\":%1}").arg(index));
+    properties.setCreated(1000000 + index);
+    properties.setLastEdited(2000000 + index);
+    if (index % 2 == 0) {
+        properties.setModelURL(QString("https://example.com/models/%1.fbx").arg(index % 10));
+    }
+    return properties;
+}
+
+static QByteArray writeSnapshot(int numEntities, std::vector<EntityItemID>& ids) {
+    EntitySnapshot::Writer writer(QUuid::createUuid(), 42);
+    writer.addPath("/", "/0,0,0/0,0,0,1");
+    for (int i = 0; i < numEntities; i++) {
+        ids.push_back(EntityItemID(QUuid::createUuid()));
+        writer.addEntity(ids.back(), makeProperties(i));
+    }
+    return writer.finish();
+}
+
+void EntitySnapshotTests::testRoundTrip() {
+    const int NUM_ENTITIES = 100;
+    std::vector<EntityItemID> ids;
+    QByteArray data = writeSnapshot(NUM_ENTITIES, ids);
+
+    EntitySnapshot::Reader reader;
+    QVERIFY(reader.open(data));
+    QCOMPARE(reader.getDataVersion(), (int64_t)42);
+    QCOMPARE(reader.getNumEntities(), NUM_ENTITIES);
+    QCOMPARE(reader.getPaths().at("/"), QString("/0,0,0/0,0,0,1"));
+
+    // split over more threads than some batches have entities
+    std::vector<EntitySnapshot::Entity> entities;
+    QVERIFY(reader.decodeEntities(10, 30, entities, 4));
+    QCOMPARE((int)entities.size(), 30);
+    QVERIFY(reader.decodeEntities(0, NUM_ENTITIES, entities, 8));
+    QCOMPARE((int)entities.size(), NUM_ENTITIES);
+
+    for (int i = 0; i < NUM_ENTITIES; i++) {
+        EntityItemProperties expected = makeProperties(i);
+        const EntityItemProperties& properties = entities[i].properties;
+        QCOMPARE(entities[i].id, ids[i]);
+        QCOMPARE(properties.getType(), expected.getType());
+        QCOMPARE(properties.getName(), expected.getName());
+        QCOMPARE(properties.getPosition(), expected.getPosition());
+        QCOMPARE(properties.getDimensions(), expected.getDimensions());
+        QCOMPARE(properties.getUserData(), expected.getUserData());
+        QCOMPARE(properties.getCreated(), expected.getCreated());
+        QCOMPARE(properties.getLastEdited(), expected.getLastEdited());
+        QCOMPARE(properties.getModelURL(), expected.getModelURL());
+    }
+
+    // past the end is clamped
+    QVERIFY(reader.decodeEntities(NUM_ENTITIES - 5, 10, entities));
+    QCOMPARE((int)entities.size(), 5);
+}
+
+void EntitySnapshotTests::testInvalidData() {
+    std::vector<EntityItemID> ids;
+    QByteArray data = writeSnapshot(10, ids);
+
+    EntitySnapshot::Reader reader;
+    QVERIFY(!reader.open(QByteArray()));
+    QVERIFY(!reader.open(data.left(data.size() / 2)));
+
+    QByteArray corrupted = data;
+    corrupted[0] = 0;
+    QVERIFY(!reader.open(corrupted));
+}
+
+void EntitySnapshotTests::benchmarkLoad() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    // the json persist file, the way it is written by RecurseOctreeToJSONOperator
+    QScriptEngine scriptEngine;
+    QString json = "{\n  \"DataVersion\": 1,\n  \"Entities\": [";
+    std::vector<EntityItemID> ids;
+    EntitySnapshot::Writer writer(QUuid::createUuid(), 1);
+    for (int i = 0; i < NUM_BENCHMARK_ENTITIES; i++) {
+        EntityItemProperties properties = makeProperties(i);
+        ids.push_back(EntityItemID(QUuid::createUuid()));
+        writer.addEntity(ids.back(), properties);
+
+        QScriptValue value = EntityItemNonDefaultPropertiesToScriptValue(&scriptEngine, properties);
+        value.setProperty("id", ids.back().toString());
+        json += (i > 0 ? ",\n    " : "\n    ") + QJsonDocument::fromVariant(value.toVariant()).toJson(QJsonDocument::Compact);
+    }
+    json += "\n  ],\n  \"Id\": \"" + QUuid::createUuid().toString() + "\",\n  \"Version\": " +
+        QString::number((int)versionForPacketType(PacketType::EntityData)) + "\n}\n";
+    QByteArray jsonData = json.toUtf8();
+    QByteArray snapshotData = writer.finish();
+
+    // json: parse, then convert every entity to properties through the script engine, as EntityTree::readFromMap does
+    QElapsedTimer timer;
+    timer.start();
+    OctreeEntitiesFileParser parser;
+    parser.setEntitiesString(jsonData);
+    QVariantMap map;
+    QVERIFY(parser.parseEntities(map));
+    int numJsonEntities = 0;
+    for (const auto& entityVariant : map["Entities"].toList()) {
+        QVariantMap entityMap = entityVariant.toMap();
+        EntityItemProperties properties;
+        EntityItemPropertiesFromScriptValueIgnoreReadOnly(variantMapToScriptValue(entityMap, scriptEngine), properties);
+        numJsonEntities++;
+    }
+    qint64 jsonMsecs = timer.elapsed();
+
+    timer.restart();
+    EntitySnapshot::Reader reader;
+    QVERIFY(reader.open(snapshotData));
+    std::vector<EntitySnapshot::Entity> entities;
+    for (int first = 0; first < reader.getNumEntities(); first += 4096) {
+        QVERIFY(reader.decodeEntities(first, 4096, entities));
+    }
+    qint64 snapshotMsecs = timer.elapsed();
+
+    QCOMPARE(numJsonEntities, NUM_BENCHMARK_ENTITIES);
+    qDebug() << NUM_BENCHMARK_ENTITIES << "entities: json" << jsonData.size() << "bytes in" << jsonMsecs << "msecs, snapshot"
+             << snapshotData.size() << "bytes in" << snapshotMsecs << "msecs";
+}
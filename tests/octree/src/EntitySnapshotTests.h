@@ -0,0 +1,24 @@
+//
+//  EntitySnapshotTests.h
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySnapshotTests_h
+#define hifi_EntitySnapshotTests_h
+
+#include <QtCore/QObject>
+
+class EntitySnapshotTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testRoundTrip();
+    void testInvalidData();
+    void benchmarkLoad();
+};
+
+#endif // hifi_EntitySnapshotTests_h
@@ -0,0 +1,302 @@
+//
+//  OctreeJournalTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreeJournalTests.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+#include <EntityItemProperties.h>
+#include <EntityTree.h>
+#include <OctreeJournal.h>
+
+QTEST_MAIN(OctreeJournalTests)
+
+using Record = OctreeJournal::Record;
+using Records = OctreeJournal::Records;
+using RecordType = OctreeJournal::RecordType;
+
+static const PacketVersion TEST_VERSION = 42;
+
+static Record makeRecord(RecordType type, int index) {
+    QByteArray payload = type == RecordType::Delete ? QByteArray() : QByteArray("entity ") + QByteArray::number(index);
+    return { type, QUuid::createUuid(), payload };
+}
+
+static Records makeRecords(int first, int count) {
+    Records records;
+    for (int i = first; i < first + count; i++) {
+        records.push_back(makeRecord((RecordType)(i % 3), i));
+    }
+    return records;
+}
+
+// replays from another journal, as after a restart
+static Records replay(const QString& persistFilename, const QUuid& treeID, int* numBatches = nullptr,
+                      PacketVersion* version = nullptr) {
+    Records replayed;
+    OctreeJournal journal(persistFilename);
+    int numRecords = journal.replay(treeID, [&](PacketVersion segmentVersion, const Records& records) {
+        if (numBatches) {
+            (*numBatches)++;
+        }
+        if (version) {
+            *version = segmentVersion;
+        }
+        replayed.insert(replayed.end(), records.begin(), records.end());
+    });
+    if (numRecords != (int)replayed.size()) {
+        return Records();
+    }
+    return replayed;
+}
+
+static bool isSame(const Records& a, const Records& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].type != b[i].type || a[i].id != b[i].id || a[i].payload != b[i].payload) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void OctreeJournalTests::testAppendAndReplay() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString persistFilename = dir.filePath("models.json.gz");
+    QUuid treeID = QUuid::createUuid();
+
+    OctreeJournal journal(persistFilename);
+    QVERIFY(!journal.append(makeRecords(0, 1))); // not open
+    QVERIFY(journal.open(treeID, TEST_VERSION));
+    QVERIFY(journal.isOpen());
+    QCOMPARE(journal.getCurrentSegment(), 0);
+    QVERIFY(QFile::exists(persistFilename + ".journal.0"));
+
+    Records first = makeRecords(0, 5);
+    Records second = makeRecords(5, 3);
+    quint64 numSyncs = journal.getNumSyncs();
+    QVERIFY(journal.append(first));
+    QVERIFY(journal.append(second));
+    QVERIFY(journal.append(Records()));
+    QCOMPARE(journal.getNumRecordsWritten(), (quint64)8);
+    QCOMPARE(journal.getNumSyncs(), numSyncs + 2); // one per batch
+    QVERIFY(journal.getNumBytesWritten() > 0);
+
+    // the segment being written isn't replayed
+    QCOMPARE(journal.replay(treeID, [](PacketVersion, const Records&) {}), 0);
+    QVERIFY(!journal.hasRecords(treeID));
+    journal.close();
+
+    Records expected = first;
+    expected.insert(expected.end(), second.begin(), second.end());
+    int numBatches = 0;
+    PacketVersion version = 0;
+    QVERIFY(isSame(replay(persistFilename, treeID, &numBatches, &version), expected));
+    QCOMPARE(numBatches, 1); // one per segment
+    QCOMPARE(version, TEST_VERSION);
+    QVERIFY(journal.hasRecords(treeID));
+
+    // segments written for other data are skipped
+    QUuid otherID = QUuid::createUuid();
+    QVERIFY(!journal.hasRecords(otherID));
+    QVERIFY(replay(persistFilename, otherID).empty());
+
+    // reopening starts a new segment after the existing ones
+    QVERIFY(journal.open(treeID, TEST_VERSION));
+    QCOMPARE(journal.getCurrentSegment(), 1);
+    QVERIFY(isSame(replay(persistFilename, treeID), expected));
+}
+
+void OctreeJournalTests::testRotation() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString persistFilename = dir.filePath("models.json.gz");
+    QUuid treeID = QUuid::createUuid();
+
+    OctreeJournal journal(persistFilename);
+    QVERIFY(journal.open(treeID, TEST_VERSION));
+    Records first = makeRecords(0, 4);
+    Records second = makeRecords(4, 4);
+    Records third = makeRecords(8, 4);
+    QVERIFY(journal.append(first));
+    QCOMPARE(journal.rotate(), 1);
+    QVERIFY(journal.append(second));
+    QCOMPARE(journal.rotate(), 2);
+    QVERIFY(journal.append(third));
+    journal.close();
+
+    // replayed oldest first, a batch per segment
+    Records expected = first;
+    expected.insert(expected.end(), second.begin(), second.end());
+    expected.insert(expected.end(), third.begin(), third.end());
+    int numBatches = 0;
+    QVERIFY(isSame(replay(persistFilename, treeID, &numBatches), expected));
+    QCOMPARE(numBatches, 3);
+
+    // the segments folded into a persist file go, the later ones stay
+    journal.removeSegmentsBefore(2);
+    QVERIFY(!QFile::exists(persistFilename + ".journal.0"));
+    QVERIFY(!QFile::exists(persistFilename + ".journal.1"));
+    QVERIFY(isSame(replay(persistFilename, treeID), third));
+
+    // segment numbers sort as numbers, not as names
+    QVERIFY(journal.open(treeID, TEST_VERSION));
+    for (int i = 0; i < 8; i++) {
+        QVERIFY(journal.append(makeRecords(12 + i, 1)));
+        journal.rotate();
+    }
+    QCOMPARE(journal.getCurrentSegment(), 11);
+    journal.close();
+    Records replayed = replay(persistFilename, treeID);
+    QCOMPARE((int)replayed.size(), 4 + 8);
+    QVERIFY(replayed.back().payload.endsWith("19"));
+}
+
+void OctreeJournalTests::testTornRecord() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString persistFilename = dir.filePath("models.json.gz");
+    QString segmentFilename = persistFilename + ".journal.0";
+    QUuid treeID = QUuid::createUuid();
+
+    OctreeJournal journal(persistFilename);
+    QVERIFY(journal.open(treeID, TEST_VERSION));
+    Records records = makeRecords(0, 3);
+    records.push_back(makeRecord(RecordType::Edit, 3));
+    QVERIFY(journal.append(records));
+    journal.close();
+
+    QFile file(segmentFilename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray data = file.readAll();
+    file.close();
+    Records complete(records.begin(), records.end() - 1);
+
+    // a crash part way through writing the last record
+    for (int cut : { 1, 8, records.back().payload.size() + 16 }) {
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(data.left(data.size() - cut));
+        file.close();
+        QVERIFY(isSame(replay(persistFilename, treeID), complete));
+    }
+
+    // or garbage after it
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(data + QByteArray("\x00\x00\x01", 3));
+    file.close();
+    QVERIFY(isSame(replay(persistFilename, treeID), records));
+
+    // a record that doesn't match its checksum ends the segment
+    QByteArray corrupted = data;
+    corrupted[corrupted.size() - 1] = corrupted[corrupted.size() - 1] ^ 0xff;
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(corrupted);
+    file.close();
+    QVERIFY(isSame(replay(persistFilename, treeID), complete));
+
+    // the records of the next segments are still replayed, after what was left of the torn one
+    QVERIFY(journal.open(treeID, TEST_VERSION));
+    QCOMPARE(journal.getCurrentSegment(), 1);
+    Records next = makeRecords(10, 2);
+    QVERIFY(journal.append(next));
+    journal.close();
+    Records expected = complete;
+    expected.insert(expected.end(), next.begin(), next.end());
+    QVERIFY(isSame(replay(persistFilename, treeID), expected));
+
+    // a segment cut short in its header is skipped
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(data.left(6));
+    file.close();
+    QVERIFY(isSame(replay(persistFilename, treeID), next));
+}
+
+void OctreeJournalTests::testRemoveAllSegments() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString persistFilename = dir.filePath("models.json.gz");
+    QUuid treeID = QUuid::createUuid();
+
+    OctreeJournal journal(persistFilename);
+    QVERIFY(journal.open(treeID, TEST_VERSION));
+    QVERIFY(journal.append(makeRecords(0, 3)));
+    journal.rotate();
+    QVERIFY(journal.append(makeRecords(3, 3)));
+
+    // the data was replaced, the journal starts over and is still open
+    journal.removeAllSegments();
+    QVERIFY(journal.isOpen());
+    QCOMPARE(journal.getCurrentSegment(), 0);
+    QVERIFY(!QFile::exists(persistFilename + ".journal.1"));
+    Records records = makeRecords(6, 2);
+    QVERIFY(journal.append(records));
+    journal.close();
+    QVERIFY(isSame(replay(persistFilename, treeID), records));
+}
+
+void OctreeJournalTests::testEntityTreeChanges() {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+    tree->setJournalEnabled(true);
+
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    properties.setDimensions(glm::vec3(1.0f));
+    EntityItemID entityID(QUuid::createUuid());
+    EntityItemPointer entity;
+    tree->withWriteLock([&] {
+        entity = tree->addEntity(entityID, properties);
+    });
+    QVERIFY(entity);
+
+    Records records;
+    tree->takeJournalRecords(records);
+    QCOMPARE((int)records.size(), 1);
+    QVERIFY(records[0].type == RecordType::Add);
+    QCOMPARE(records[0].id, (QUuid)entityID);
+
+    // nothing changed since
+    records.clear();
+    tree->takeJournalRecords(records);
+    QVERIFY(records.empty());
+
+    // changes that don't go through an edit, such as a simulation owner expiring, are journaled too
+    entity->markAsChangedOnServer();
+    tree->takeJournalRecords(records);
+    QCOMPARE((int)records.size(), 1);
+    QVERIFY(records[0].type == RecordType::Edit);
+    QCOMPARE(records[0].id, (QUuid)entityID);
+    QVERIFY(!records[0].payload.isEmpty());
+
+    // as is the entity going away
+    records.clear();
+    entity->markAsChangedOnServer();
+    tree->withWriteLock([&] {
+        tree->deleteEntitiesByPointer({ entity });
+    });
+    tree->takeJournalRecords(records);
+    QCOMPARE((int)records.size(), 1);
+    QVERIFY(records[0].type == RecordType::Delete);
+
+    // a tree that isn't journaled keeps nothing
+    tree->setJournalEnabled(false);
+    tree->withWriteLock([&] {
+        entity = tree->addEntity(EntityItemID(QUuid::createUuid()), properties);
+    });
+    entity->markAsChangedOnServer();
+    records.clear();
+    tree->takeJournalRecords(records);
+    QVERIFY(records.empty());
+}
@@ -0,0 +1,26 @@
+//
+//  OctreeJournalTests.h
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeJournalTests_h
+#define hifi_OctreeJournalTests_h
+
+#include <QtCore/QObject>
+
+class OctreeJournalTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testAppendAndReplay();
+    void testRotation();
+    void testTornRecord();
+    void testRemoveAllSegments();
+    void testEntityTreeChanges();
+};
+
+#endif // hifi_OctreeJournalTests_h
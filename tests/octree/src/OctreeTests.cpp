@@ -14,7 +14,10 @@
 
 #include "OctreeTests.h"
 
+#include <thread>
+
 #include <QDebug>
+#include <QSemaphore>
 
 #include <ByteCountCoding.h>
 #include <EntityItem.h>
@@ -827,3 +830,56 @@ void OctreeTests::elementAddChildTests() {
         }
     }
 }
+
+void OctreeTests::treeLockWaitTests() {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->resetLockWaitStats();
+
+    tree->withReadLock([] {});
+    tree->withWriteLock([] {});
+    QCOMPARE(tree->getReadLockWaitStats().numLocks, (quint64)1);
+    QCOMPARE(tree->getReadLockWaitStats().numWaits, (quint64)0);
+    QCOMPARE(tree->getWriteLockWaitStats().numLocks, (quint64)1);
+    QCOMPARE(tree->getWriteLockWaitStats().numWaits, (quint64)0);
+
+    // a writer has to wait for a reader that holds on to the lock
+    const int READ_LOCK_USECS = 20000;
+    QSemaphore readLocked;
+    std::thread reader([&] {
+        tree->withReadLock([&] {
+            readLocked.release();
+            std::this_thread::sleep_for(std::chrono::microseconds(READ_LOCK_USECS));
+        });
+    });
+    readLocked.acquire();
+    tree->withWriteLock([] {});
+    reader.join();
+
+    Octree::LockWaitStats writeLockWaits = tree->getWriteLockWaitStats();
+    QCOMPARE(writeLockWaits.numLocks, (quint64)2);
+    QCOMPARE(writeLockWaits.numWaits, (quint64)1);
+    QVERIFY(writeLockWaits.maxWaitUsecs > 0);
+    QCOMPARE(writeLockWaits.getAverageWaitUsecs(), writeLockWaits.maxWaitUsecs);
+
+    tree->resetLockWaitStats();
+    QCOMPARE(tree->getWriteLockWaitStats().numLocks, (quint64)0);
+    QCOMPARE(tree->getWriteLockWaitStats().maxWaitUsecs, (quint64)0);
+}
+
+void OctreeTests::treeEpochTests() {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+
+    // readers share the epoch until the entities change
+    EntityTreeEpochPointer epoch = tree->getCurrentEpoch();
+    QVERIFY(epoch);
+    QVERIFY(epoch->entities.empty());
+    QCOMPARE(tree->getCurrentEpoch(), epoch);
+
+    // an epoch that is in use doesn't change when the tree does
+    tree->eraseDomainAndNonOwnedEntities();
+    EntityTreeEpochPointer nextEpoch = tree->getCurrentEpoch();
+    QVERIFY(nextEpoch != epoch);
+    QVERIFY(nextEpoch->number > epoch->number);
+    QCOMPARE(tree->getCurrentEpoch(), nextEpoch);
+}
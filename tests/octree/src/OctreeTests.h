@@ -27,6 +27,9 @@ private slots:
 
     void elementAddChildTests();
 
+    void treeLockWaitTests();
+    void treeEpochTests();
+
     // TODO: Break these into separate test functions
 };
 
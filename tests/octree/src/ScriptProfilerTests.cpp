@@ -0,0 +1,184 @@
+//
+//  ScriptProfilerTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ScriptProfilerTests.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonArray>
+#include <QtCore/QThread>
+#include <QtTest/QtTest>
+
+#include <ScriptProfiler.h>
+
+QTEST_MAIN(ScriptProfilerTests)
+
+static const QString SCRIPT_URL = "http://example.com/script.js";
+
+// keeps the engine thread busy in a context for msecs
+static void runFor(ScriptProfiler& profiler, ScriptProfiler::ContextID context, int msecs) {
+    auto previousContext = profiler.enter(context);
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < msecs) {
+    }
+    profiler.leave(previousContext);
+}
+
+static QJsonObject findContext(const QJsonObject& profile, const QString& function) {
+    for (const auto& context : profile["contexts"].toArray()) {
+        if (context.toObject()["function"].toString() == function) {
+            return context.toObject();
+        }
+    }
+    return QJsonObject();
+}
+
+void ScriptProfilerTests::testContexts() {
+    ScriptProfiler profiler;
+    QUuid entityID = QUuid::createUuid();
+    auto context = profiler.getContext(SCRIPT_URL, "update", entityID);
+    QCOMPARE(profiler.getContext(SCRIPT_URL, "update", entityID), context);
+    QVERIFY(profiler.getContext(SCRIPT_URL, "update", QUuid()) != context);
+    QVERIFY(profiler.getContext(SCRIPT_URL, "preload", entityID) != context);
+
+    QCOMPARE(profiler.getCurrentContext(), ScriptProfiler::IDLE);
+    auto previousContext = profiler.enter(context);
+    QCOMPARE(previousContext, ScriptProfiler::IDLE);
+    QCOMPARE(profiler.getCurrentContext(), context);
+    profiler.leave(previousContext);
+    QCOMPARE(profiler.getCurrentContext(), ScriptProfiler::IDLE);
+
+    QJsonObject entry = findContext(profiler.toJson(), "update");
+    QCOMPARE(entry["script"].toString(), SCRIPT_URL);
+    QCOMPARE(QUuid(entry["entity"].toString()), entityID);
+    QCOMPARE(entry["calls"].toInt(), 1);
+}
+
+void ScriptProfilerTests::testSampling() {
+    ScriptProfiler profiler;
+    auto busy = profiler.getContext(SCRIPT_URL, "busy", QUuid());
+    auto quick = profiler.getContext(SCRIPT_URL, "quick", QUuid());
+
+    runFor(profiler, busy, 300);
+    runFor(profiler, quick, 0);
+    // idle time isn't charged to any context
+    QThread::msleep(100);
+
+    QJsonObject profile = profiler.toJson();
+    double busySamples = findContext(profile, "busy")["samples"].toDouble();
+    QVERIFY(busySamples > 0);
+    QVERIFY(busySamples <= profile["busy_samples"].toDouble());
+    QVERIFY(profile["busy_samples"].toDouble() < profile["samples"].toDouble());
+    QCOMPARE(findContext(profile, "busy")["cpu_msecs"].toDouble(), busySamples * ScriptProfiler::SAMPLE_INTERVAL_MSECS);
+    // the busiest context comes first
+    QCOMPARE(profile["contexts"].toArray()[0].toObject()["function"].toString(), QString("busy"));
+}
+
+void ScriptProfilerTests::testNestedCalls() {
+    ScriptProfiler profiler;
+    auto outer = profiler.getContext(SCRIPT_URL, "outer", QUuid());
+    auto inner = profiler.getContext(SCRIPT_URL, "inner", QUuid());
+
+    auto previousContext = profiler.enter(outer);
+    runFor(profiler, inner, 0);
+    runFor(profiler, inner, 0);
+    QCOMPARE(profiler.getCurrentContext(), outer);
+    profiler.leave(previousContext);
+
+    QJsonObject profile = profiler.toJson();
+    QCOMPARE(findContext(profile, "outer")["calls"].toInt(), 1);
+    QCOMPARE(findContext(profile, "inner")["calls"].toInt(), 2);
+}
+
+void ScriptProfilerTests::testAllocations() {
+    ScriptProfiler profiler;
+    auto context = profiler.getContext(SCRIPT_URL, "allocate", QUuid());
+
+    // allocations outside of script code aren't charged
+    profiler.addAllocation(1000);
+    auto previousContext = profiler.enter(context);
+    profiler.addAllocation(100);
+    profiler.addAllocation(-50);
+    profiler.addAllocation(200);
+    profiler.leave(previousContext);
+
+    profiler.addGarbageCollection(10);
+    profiler.addGarbageCollection(30);
+
+    QJsonObject profile = profiler.toJson();
+    QCOMPARE(findContext(profile, "allocate")["allocated_bytes"].toInt(), 300);
+    QJsonObject garbageCollection = profile["garbage_collection"].toObject();
+    QCOMPARE(garbageCollection["count"].toInt(), 2);
+    QCOMPARE(garbageCollection["total_usecs"].toInt(), 40);
+    QCOMPARE(garbageCollection["max_usecs"].toInt(), 30);
+}
+
+void ScriptProfilerTests::testLimit() {
+    ScriptProfiler profiler;
+    for (int i = 0; i < 20; ++i) {
+        profiler.getContext(SCRIPT_URL, QString::number(i), QUuid());
+    }
+    QCOMPARE(profiler.toJson()["contexts"].toArray().size(), 20);
+    QCOMPARE(profiler.toJson(5)["contexts"].toArray().size(), 5);
+    QCOMPARE(profiler.toJson(0)["contexts"].toArray().size(), 0);
+}
+
+void ScriptProfilerTests::testRemoveEntityContexts() {
+    ScriptProfiler profiler;
+    QUuid entityID = QUuid::createUuid();
+    auto kept = profiler.getContext(SCRIPT_URL, "kept", QUuid());
+    auto update = profiler.getContext(SCRIPT_URL, "update", entityID);
+    auto unload = profiler.getContext(SCRIPT_URL, "unload", entityID);
+    runFor(profiler, update, 0);
+    runFor(profiler, update, 0);
+    runFor(profiler, unload, 0);
+    int numContexts = profiler.getNumContexts();
+    QVERIFY(findContext(profiler.toJson(), ScriptProfiler::OTHER_FUNCTION).isEmpty());
+
+    profiler.removeEntityContexts(entityID);
+    QCOMPARE(profiler.getNumContexts(), numContexts - 2);
+    QJsonObject profile = profiler.toJson();
+    QVERIFY(findContext(profile, "update").isEmpty());
+    QVERIFY(findContext(profile, "unload").isEmpty());
+    QCOMPARE(findContext(profile, ScriptProfiler::OTHER_FUNCTION)["calls"].toInt(), 3);
+
+    // the freed contexts are reused, and start from scratch
+    QUuid otherEntityID = QUuid::createUuid();
+    auto reused = profiler.getContext(SCRIPT_URL, "update", otherEntityID);
+    QVERIFY(reused == update || reused == unload);
+    QCOMPARE(profiler.getContext(SCRIPT_URL, "kept", QUuid()), kept);
+    QCOMPARE(findContext(profiler.toJson(), "update")["calls"].toInt(), 0);
+    QCOMPARE(QUuid(findContext(profiler.toJson(), "update")["entity"].toString()), otherEntityID);
+
+    // loading the script of the entity again makes new contexts
+    for (int i = 0; i < 100; ++i) {
+        runFor(profiler, profiler.getContext(SCRIPT_URL, "update", entityID), 0);
+        profiler.removeEntityContexts(entityID);
+    }
+    QCOMPARE(profiler.getNumContexts(), numContexts - 1);
+    QCOMPARE(findContext(profiler.toJson(), ScriptProfiler::OTHER_FUNCTION)["calls"].toInt(), 103);
+}
+
+void ScriptProfilerTests::testMaxContexts() {
+    ScriptProfiler profiler;
+    for (int i = 0; i < ScriptProfiler::MAX_CONTEXTS; ++i) {
+        profiler.getContext(SCRIPT_URL, QString::number(i), QUuid());
+    }
+    QCOMPARE(profiler.getNumContexts(), ScriptProfiler::MAX_CONTEXTS);
+
+    // the contexts that don't fit are charged to OTHER
+    auto overflow = profiler.getContext(SCRIPT_URL, "overflow", QUuid());
+    QCOMPARE(overflow, ScriptProfiler::OTHER);
+    runFor(profiler, overflow, 0);
+    QCOMPARE(profiler.getNumContexts(), ScriptProfiler::MAX_CONTEXTS);
+    QJsonObject profile = profiler.toJson();
+    QVERIFY(findContext(profile, "overflow").isEmpty());
+    QCOMPARE(findContext(profile, ScriptProfiler::OTHER_FUNCTION)["calls"].toInt(), 1);
+}
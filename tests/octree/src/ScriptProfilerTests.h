@@ -0,0 +1,28 @@
+//
+//  ScriptProfilerTests.h
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ScriptProfilerTests_h
+#define hifi_ScriptProfilerTests_h
+
+#include <QtCore/QObject>
+
+class ScriptProfilerTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testContexts();
+    void testSampling();
+    void testNestedCalls();
+    void testAllocations();
+    void testLimit();
+    void testRemoveEntityContexts();
+    void testMaxContexts();
+};
+
+#endif // hifi_ScriptProfilerTests_h
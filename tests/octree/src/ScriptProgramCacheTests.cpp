@@ -0,0 +1,273 @@
+//
+//  ScriptProgramCacheTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ScriptProgramCacheTests.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <QtScript/QScriptEngine>
+#include <QtTest/QtTest>
+
+#include <ScriptProgramCache.h>
+
+#include <test-utils/Benchmarks.h>
+
+QTEST_MAIN(ScriptProgramCacheTests)
+
+// the number of entities started by benchmarkEntityStartup
+static const int NUM_BENCHMARK_ENTITIES = 1000;
+static const int NUM_BENCHMARK_LIBRARY_FUNCTIONS = 200;
+
+static const QString SCRIPT_URL = "http://example.com/script.js";
+static const QString OTHER_SCRIPT_URL = "http://example.com/other.js";
+static const QString ATP_SCRIPT_URL = "atp:/script.js";
+static const QString SCRIPT = "(function() { return { preload: function(id) { this.id = id; } }; })";
+
+// an entity script bundled with a library, as they often are
+static QString makeEntityScript() {
+    QString script = "(function() {\n";
+    for (int i = 0; i < NUM_BENCHMARK_LIBRARY_FUNCTIONS; i++) {
+        script += QString("    function helper%1(a, b) { var c = [a, b, %1]; return c.map(function(x) { return x * 2; }); }\n").arg(i);
+    }
+    script += "    return function() { this.preload = function(id) { this.value = helper0(1, 2); }; };\n})()";
+    return script;
+}
+
+void ScriptProgramCacheTests::init() {
+    ScriptProgramCache::get().clear();
+}
+
+void ScriptProgramCacheTests::testFind() {
+    auto& cache = ScriptProgramCache::get();
+    QVERIFY(cache.find(SCRIPT, SCRIPT_URL).isNull());
+
+    cache.insert(QScriptProgram(SCRIPT, SCRIPT_URL));
+    QScriptProgram program = cache.find(SCRIPT, SCRIPT_URL);
+    QVERIFY(!program.isNull());
+    QCOMPARE(program.sourceCode(), SCRIPT);
+    QCOMPARE(program.fileName(), SCRIPT_URL);
+
+    // programs are keyed by their contents as well as their name
+    QVERIFY(cache.find(SCRIPT + " ", SCRIPT_URL).isNull());
+    QVERIFY(cache.find(SCRIPT, SCRIPT_URL + "?v=2").isNull());
+    QVERIFY(cache.find(SCRIPT, SCRIPT_URL, 10).isNull());
+
+    QCOMPARE(cache.getProgram(SCRIPT, SCRIPT_URL), program);
+    QCOMPARE(cache.getNumPrograms(), 1);
+    QVERIFY(!cache.getProgram(SCRIPT, SCRIPT_URL, 10).isNull());
+    QCOMPARE(cache.getNumPrograms(), 2);
+}
+
+void ScriptProgramCacheTests::testUnchecked() {
+    auto& cache = ScriptProgramCache::get();
+    const QString BAD_SCRIPT = "(function() { return { ";
+
+    // as ScriptEngine::instantiateModule(), whose programs aren't checked for syntax errors
+    QScriptProgram program = cache.getProgram(BAD_SCRIPT, SCRIPT_URL);
+    QVERIFY(!program.isNull());
+    QCOMPARE(cache.getProgram(BAD_SCRIPT, SCRIPT_URL), program);
+    QCOMPARE(cache.getNumPrograms(), 1);
+
+    // so the callers that check the syntax don't find them, and check it themselves
+    QVERIFY(cache.find(BAD_SCRIPT, SCRIPT_URL).isNull());
+    QVERIFY(QScriptEngine::checkSyntax(BAD_SCRIPT).state() != QScriptSyntaxCheckResult::Valid);
+
+    // an unchecked program that passes the check is kept, and found from then on
+    QScriptProgram unchecked = cache.getProgram(SCRIPT, SCRIPT_URL);
+    QVERIFY(cache.find(SCRIPT, SCRIPT_URL).isNull());
+    QCOMPARE(QScriptEngine::checkSyntax(SCRIPT).state(), QScriptSyntaxCheckResult::Valid);
+    cache.insert(QScriptProgram(SCRIPT, SCRIPT_URL));
+    QCOMPARE(cache.find(SCRIPT, SCRIPT_URL), unchecked);
+    QCOMPARE(cache.getNumPrograms(), 2);
+}
+
+void ScriptProgramCacheTests::testReuse() {
+    auto& cache = ScriptProgramCache::get();
+    QScriptEngine engine;
+    QScriptEngine otherEngine;
+    QScriptProgram program = cache.getProgram("var counter = (this.counter || 0) + 1; counter;", SCRIPT_URL);
+
+    // the same program can be run many times, and by several engines
+    QCOMPARE(engine.evaluate(program).toInt32(), 1);
+    QCOMPARE(engine.evaluate(program).toInt32(), 2);
+    QCOMPARE(otherEngine.evaluate(program).toInt32(), 1);
+    QCOMPARE(engine.evaluate(program).toInt32(), 3);
+}
+
+void ScriptProgramCacheTests::testEviction() {
+    auto& cache = ScriptProgramCache::get();
+    for (int i = 0; i < ScriptProgramCache::MAX_PROGRAMS; i++) {
+        cache.insert(QScriptProgram(SCRIPT, SCRIPT_URL, i + 1));
+    }
+    QCOMPARE(cache.getNumPrograms(), ScriptProgramCache::MAX_PROGRAMS);
+
+    // a full cache drops the program used least recently, not all of them
+    QVERIFY(!cache.find(SCRIPT, SCRIPT_URL, 1).isNull());
+    QVERIFY(!cache.getProgram(SCRIPT, SCRIPT_URL, 2).isNull());
+    cache.insert(QScriptProgram(SCRIPT, OTHER_SCRIPT_URL));
+    QCOMPARE(cache.getNumPrograms(), ScriptProgramCache::MAX_PROGRAMS);
+    QVERIFY(cache.find(SCRIPT, SCRIPT_URL, 3).isNull());
+    QVERIFY(!cache.find(SCRIPT, SCRIPT_URL, 1).isNull());
+    QVERIFY(!cache.find(SCRIPT, SCRIPT_URL, 2).isNull());
+    QVERIFY(!cache.find(SCRIPT, SCRIPT_URL, 4).isNull());
+    QVERIFY(!cache.find(SCRIPT, OTHER_SCRIPT_URL).isNull());
+
+    cache.getProgram(SCRIPT, OTHER_SCRIPT_URL, 2);
+    QCOMPARE(cache.getNumPrograms(), ScriptProgramCache::MAX_PROGRAMS);
+    QVERIFY(cache.find(SCRIPT, SCRIPT_URL, 5).isNull());
+}
+
+void ScriptProgramCacheTests::testInvalidate() {
+    auto& cache = ScriptProgramCache::get();
+    cache.insert(QScriptProgram(SCRIPT, SCRIPT_URL));
+    cache.insert(QScriptProgram(SCRIPT, OTHER_SCRIPT_URL));
+    cache.insert(QScriptProgram(SCRIPT, ATP_SCRIPT_URL));
+
+    ScriptProgramCache::invalidate(QUrl(SCRIPT_URL));
+    QVERIFY(cache.find(SCRIPT, SCRIPT_URL).isNull());
+    QVERIFY(!cache.find(SCRIPT, OTHER_SCRIPT_URL).isNull());
+    QVERIFY(!cache.find(SCRIPT, ATP_SCRIPT_URL).isNull());
+
+    // as ScriptCache::clearATPScriptsFromCache()
+    ScriptProgramCache::invalidate(QUrl("atp:"));
+    QVERIFY(cache.find(SCRIPT, ATP_SCRIPT_URL).isNull());
+    QVERIFY(!cache.find(SCRIPT, OTHER_SCRIPT_URL).isNull());
+
+    // a script cached again after it was invalidated stays
+    cache.insert(QScriptProgram(SCRIPT, SCRIPT_URL));
+    QVERIFY(!cache.find(SCRIPT, SCRIPT_URL).isNull());
+
+    ScriptProgramCache::invalidateAll();
+    QVERIFY(cache.find(SCRIPT, SCRIPT_URL).isNull());
+    QVERIFY(cache.find(SCRIPT, OTHER_SCRIPT_URL).isNull());
+    QCOMPARE(cache.getNumPrograms(), 0);
+}
+
+void ScriptProgramCacheTests::testThreads() {
+    ScriptProgramCache::get().insert(QScriptProgram(SCRIPT, SCRIPT_URL));
+
+    // each thread has a cache of its own, that is invalidated from any thread
+    bool foundOnOtherThread = true;
+    bool foundAfterInvalidation = true;
+    QThread* thread = QThread::create([&] {
+        auto& cache = ScriptProgramCache::get();
+        foundOnOtherThread = !cache.find(SCRIPT, SCRIPT_URL).isNull();
+        cache.insert(QScriptProgram(SCRIPT, SCRIPT_URL));
+        ScriptProgramCache::invalidate(QUrl(SCRIPT_URL));
+        foundAfterInvalidation = !cache.find(SCRIPT, SCRIPT_URL).isNull();
+    });
+    thread->start();
+    QVERIFY(thread->wait());
+    delete thread;
+
+    QVERIFY(!foundOnOtherThread);
+    QVERIFY(!foundAfterInvalidation);
+    QVERIFY(ScriptProgramCache::get().find(SCRIPT, SCRIPT_URL).isNull());
+}
+
+void ScriptProgramCacheTests::testInvalidationsForgotten() {
+    ScriptProgramCache::get().insert(QScriptProgram(SCRIPT, SCRIPT_URL));
+
+    // the URL is kept until the cache of every thread has dropped its programs
+    QMutex mutex;
+    QWaitCondition condition;
+    bool otherCacheReady = false;
+    bool invalidated = false;
+    bool otherCacheDone = false;
+    bool foundAfterInvalidation = true;
+    QThread* thread = QThread::create([&] {
+        ScriptProgramCache::get().insert(QScriptProgram(SCRIPT, SCRIPT_URL));
+        QMutexLocker locker(&mutex);
+        otherCacheReady = true;
+        condition.wakeAll();
+        while (!invalidated) {
+            condition.wait(&mutex);
+        }
+        foundAfterInvalidation = !ScriptProgramCache::get().find(SCRIPT, SCRIPT_URL).isNull();
+        otherCacheDone = true;
+        condition.wakeAll();
+    });
+    thread->start();
+    {
+        QMutexLocker locker(&mutex);
+        while (!otherCacheReady) {
+            condition.wait(&mutex);
+        }
+    }
+
+    ScriptProgramCache::invalidate(QUrl(SCRIPT_URL));
+    QVERIFY(ScriptProgramCache::get().find(SCRIPT, SCRIPT_URL).isNull());
+    QCOMPARE(ScriptProgramCache::getNumInvalidatedURLs(), 1);
+    {
+        QMutexLocker locker(&mutex);
+        invalidated = true;
+        condition.wakeAll();
+        while (!otherCacheDone) {
+            condition.wait(&mutex);
+        }
+    }
+    QVERIFY(!foundAfterInvalidation);
+    QCOMPARE(ScriptProgramCache::getNumInvalidatedURLs(), 0);
+    QVERIFY(thread->wait());
+    delete thread;
+
+    // or until the threads that haven't are gone
+    thread = QThread::create([] {
+        ScriptProgramCache::get().insert(QScriptProgram(SCRIPT, SCRIPT_URL));
+    });
+    thread->start();
+    QVERIFY(thread->wait());
+    delete thread;
+    ScriptProgramCache::invalidate(QUrl(SCRIPT_URL));
+    QVERIFY(ScriptProgramCache::get().find(SCRIPT, SCRIPT_URL).isNull());
+    QCOMPARE(ScriptProgramCache::getNumInvalidatedURLs(), 0);
+}
+
+void ScriptProgramCacheTests::benchmarkEntityStartup() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    // an entity script server shard starting the entities of a domain that all run the same script, as
+    // ScriptEngine::entityScriptContentAvailable() does before and after the program cache
+    const QString script = makeEntityScript();
+    bool started = true;
+    auto startEntities = [&](bool useCache) {
+        QScriptEngine engine;
+        auto& cache = ScriptProgramCache::get();
+        cache.clear();
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < NUM_BENCHMARK_ENTITIES; i++) {
+            QScriptProgram program = useCache ? cache.find(script, SCRIPT_URL) : QScriptProgram();
+            if (program.isNull()) {
+                started &= QScriptEngine::checkSyntax(script).state() == QScriptSyntaxCheckResult::Valid;
+                program = QScriptProgram(script, SCRIPT_URL);
+                if (useCache) {
+                    cache.insert(program);
+                }
+            }
+            QScriptValue entityScript = engine.evaluate(program).construct();
+            entityScript.property("preload").call(entityScript, QScriptValueList({ i }));
+            started &= !engine.hasUncaughtException();
+        }
+        return timer.nsecsElapsed();
+    };
+
+    qint64 uncachedNsecs = startEntities(false);
+    qint64 cachedNsecs = startEntities(true);
+    QVERIFY(started);
+
+    const double NSECS_PER_MSEC = 1.0e6;
+    qDebug() << NUM_BENCHMARK_ENTITIES << "entities started in msecs: without the program cache"
+        << uncachedNsecs / NSECS_PER_MSEC << "with the program cache" << cachedNsecs / NSECS_PER_MSEC;
+    QVERIFY(cachedNsecs < uncachedNsecs);
+}
@@ -0,0 +1,30 @@
+//
+//  ScriptProgramCacheTests.h
+//  tests/octree/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ScriptProgramCacheTests_h
+#define hifi_ScriptProgramCacheTests_h
+
+#include <QtCore/QObject>
+
+class ScriptProgramCacheTests : public QObject {
+    Q_OBJECT
+private slots:
+    void init();
+    void testFind();
+    void testUnchecked();
+    void testReuse();
+    void testEviction();
+    void testInvalidate();
+    void testThreads();
+    void testInvalidationsForgotten();
+    void benchmarkEntityStartup();
+};
+
+#endif // hifi_ScriptProgramCacheTests_h
@@ -0,0 +1,95 @@
+//
+//  EntityUpdateBudgetTests.cpp
+//  tests/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityUpdateBudgetTests.h"
+
+#include <EntityUpdateBudget.h>
+#include <NumericalConstants.h>
+
+QTEST_MAIN(EntityUpdateBudgetTests)
+
+namespace {
+
+const float MAX_KBPS = 100.0f;
+const uint64_t STEP = USECS_PER_SECOND / 60;
+const uint32_t UPDATES_PER_PACKET = 10;
+const uint32_t BYTES_PER_PACKET = 1000;
+
+// sends numSteps batches of one packet at the given rate, returns the time after the last one
+uint64_t sendBatches(EntityUpdateBudget& budget, uint64_t now, uint64_t& totalBytes, uint64_t& totalPackets,
+        float kbps, int numSteps) {
+    uint64_t bytesPerStep = (uint64_t)(kbps * (float)BYTES_PER_KILOBIT * (float)STEP / (float)USECS_PER_SECOND);
+    for (int i = 0; i < numSteps; ++i) {
+        now += STEP;
+        totalBytes += bytesPerStep;
+        totalPackets += bytesPerStep / BYTES_PER_PACKET + 1;
+        budget.update(now, totalBytes, totalPackets, UPDATES_PER_PACKET);
+    }
+    return now;
+}
+
+}
+
+void EntityUpdateBudgetTests::testWithinBudget() {
+    EntityUpdateBudget budget;
+    budget.setMaxKbps(MAX_KBPS);
+    uint64_t totalBytes = 0;
+    uint64_t totalPackets = 0;
+    sendBatches(budget, USECS_PER_SECOND, totalBytes, totalPackets, 0.8f * MAX_KBPS, 300);
+
+    QCOMPARE(budget.getErrorScale(), 1.0f);
+    QCOMPARE(budget.getSendPeriodSteps(), (uint32_t)1);
+    QVERIFY(fabsf(budget.getKbps() - 0.8f * MAX_KBPS) < 0.05f * MAX_KBPS);
+    QVERIFY(fabsf(budget.getUpdatesPerSecond() - 60.0f * UPDATES_PER_PACKET) < 10.0f);
+}
+
+void EntityUpdateBudgetTests::testOverBudget() {
+    EntityUpdateBudget budget;
+    budget.setMaxKbps(MAX_KBPS);
+    uint64_t totalBytes = 0;
+    uint64_t totalPackets = 0;
+    uint64_t now = sendBatches(budget, USECS_PER_SECOND, totalBytes, totalPackets, 4.0f * MAX_KBPS, 60);
+    float errorScale = budget.getErrorScale();
+    QVERIFY(errorScale > 1.0f);
+    QVERIFY(budget.getSendPeriodSteps() > 1);
+
+    // the error never grows past its bound, however far over budget
+    sendBatches(budget, now, totalBytes, totalPackets, 100.0f * MAX_KBPS, 600);
+    QVERIFY(budget.getErrorScale() >= errorScale);
+    QCOMPARE(budget.getErrorScale(), EntityUpdateBudget::MAX_ERROR_SCALE);
+    QCOMPARE(budget.computeErrorScale(1000.0f), EntityUpdateBudget::MAX_ERROR_SCALE);
+    QCOMPARE(budget.getSendPeriodSteps(), EntityUpdateBudget::MAX_SEND_PERIOD_STEPS);
+}
+
+void EntityUpdateBudgetTests::testRecovery() {
+    EntityUpdateBudget budget;
+    budget.setMaxKbps(MAX_KBPS);
+    uint64_t totalBytes = 0;
+    uint64_t totalPackets = 0;
+    uint64_t now = sendBatches(budget, USECS_PER_SECOND, totalBytes, totalPackets, 100.0f * MAX_KBPS, 600);
+    QCOMPARE(budget.getErrorScale(), EntityUpdateBudget::MAX_ERROR_SCALE);
+
+    // between half the budget and the budget the error holds, below it shrinks back to nominal
+    float errorScale = budget.getErrorScale();
+    now = sendBatches(budget, now, totalBytes, totalPackets, 0.75f * MAX_KBPS, 150);
+    QCOMPARE(budget.getErrorScale(), errorScale);
+    sendBatches(budget, now, totalBytes, totalPackets, 0.1f * MAX_KBPS, 600);
+    QCOMPARE(budget.getErrorScale(), 1.0f);
+    QCOMPARE(budget.getSendPeriodSteps(), (uint32_t)1);
+}
+
+void EntityUpdateBudgetTests::testViewerDistance() {
+    EntityUpdateBudget budget;
+    QCOMPARE(budget.computeErrorScale(0.0f), 1.0f);
+    QCOMPARE(budget.computeErrorScale(EntityUpdateBudget::FULL_ACCURACY_DISTANCE), 1.0f);
+    QCOMPARE(budget.computeErrorScale(4.0f * EntityUpdateBudget::FULL_ACCURACY_DISTANCE), 4.0f);
+    QCOMPARE(budget.computeErrorScale(100.0f * EntityUpdateBudget::FULL_ACCURACY_DISTANCE),
+        EntityUpdateBudget::MAX_ERROR_SCALE);
+}
@@ -0,0 +1,26 @@
+//
+//  EntityUpdateBudgetTests.h
+//  tests/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityUpdateBudgetTests_h
+#define hifi_EntityUpdateBudgetTests_h
+
+#include <QtTest/QtTest>
+
+class EntityUpdateBudgetTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testWithinBudget();
+    void testOverBudget();
+    void testRecovery();
+    void testViewerDistance();
+};
+
+#endif // hifi_EntityUpdateBudgetTests_h
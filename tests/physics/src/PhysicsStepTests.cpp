@@ -0,0 +1,129 @@
+//
+//  PhysicsStepTests.cpp
+//  tests/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PhysicsStepTests.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <PhysicsEngine.h>
+
+#include <test-utils/Benchmarks.h>
+
+QTEST_MAIN(PhysicsStepTests)
+
+namespace {
+
+const btVector3 GRAVITY(0.0f, -9.8f, 0.0f);
+
+// Bodies without MotionStates: the engine steps them, but has nothing to synchronize them with.
+class TestScene {
+public:
+    TestScene(int numBoxes) : _engine(glm::vec3(0.0f)) {
+        _engine.init();
+
+        _groundShape.reset(new btBoxShape(btVector3(50.0f, 0.5f, 50.0f)));
+        addBody(_groundShape.get(), 0.0f, btVector3(0.0f, -0.5f, 0.0f));
+
+        _boxShape.reset(new btBoxShape(btVector3(0.25f, 0.25f, 0.25f)));
+        const int BOXES_PER_ROW = 10;
+        for (int i = 0; i < numBoxes; i++) {
+            btVector3 position((float)(i % BOXES_PER_ROW) - 5.0f, 1.0f + (float)(i / (BOXES_PER_ROW * BOXES_PER_ROW)),
+                (float)((i / BOXES_PER_ROW) % BOXES_PER_ROW) - 5.0f);
+            btRigidBody* body = addBody(_boxShape.get(), 1.0f, position);
+            body->setGravity(GRAVITY);
+            body->setActivationState(DISABLE_DEACTIVATION);
+        }
+    }
+
+    ~TestScene() {
+        btDiscreteDynamicsWorld* world = _engine.getDynamicsWorld();
+        for (auto& body : _bodies) {
+            world->removeRigidBody(body.get());
+        }
+    }
+
+    PhysicsEngine& getEngine() { return _engine; }
+    btRigidBody* getBox(int i) { return _bodies[i + 1].get(); }
+
+private:
+    btRigidBody* addBody(btCollisionShape* shape, float mass, const btVector3& position) {
+        btVector3 inertia(0.0f, 0.0f, 0.0f);
+        if (mass > 0.0f) {
+            shape->calculateLocalInertia(mass, inertia);
+        }
+        btRigidBody::btRigidBodyConstructionInfo info(mass, nullptr, shape, inertia);
+        info.m_startWorldTransform.setOrigin(position);
+        _bodies.emplace_back(new btRigidBody(info));
+        _engine.getDynamicsWorld()->addRigidBody(_bodies.back().get());
+        return _bodies.back().get();
+    }
+
+    PhysicsEngine _engine;
+    std::unique_ptr<btCollisionShape> _groundShape;
+    std::unique_ptr<btCollisionShape> _boxShape;
+    std::vector<std::unique_ptr<btRigidBody>> _bodies;
+};
+
+// steps a fixed time, whatever the time it takes
+void step(PhysicsEngine& engine, int numSteps) {
+    const float FIXED_STEP = 1.0f / 60.0f;
+    ThreadSafeDynamicsWorld* world = static_cast<ThreadSafeDynamicsWorld*>(engine.getDynamicsWorld());
+    for (int i = 0; i < numSteps; i++) {
+        world->stepSimulationWithSubstepCallback(FIXED_STEP, 1, FIXED_STEP);
+    }
+}
+
+}
+
+void PhysicsStepTests::testSimulationThreads() {
+    const int NUM_BOXES = 300;
+    TestScene scene(NUM_BOXES);
+    PhysicsEngine& engine = scene.getEngine();
+    engine.setNumSimulationThreads(4);
+    QVERIFY(engine.getNumSimulationThreads() >= 1);
+
+    // the boxes fall into stacks, each stack an island
+    const int NUM_STEPS = 180;
+    step(engine, NUM_STEPS);
+    for (int i = 0; i < NUM_BOXES; i++) {
+        float height = scene.getBox(i)->getWorldTransform().getOrigin().getY();
+        QVERIFY(height > 0.0f);
+        QVERIFY(height < 5.5f);
+    }
+    engine.setNumSimulationThreads(1);
+    QCOMPARE(engine.getNumSimulationThreads(), 1);
+}
+
+// Prints the time a step of a few thousand boxes in stacks takes by number of threads.
+void PhysicsStepTests::benchmarkSimulationThreads() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    const int NUM_BOXES = 2000;
+    const int NUM_SETTLING_STEPS = 30;
+    const int NUM_STEPS = 120;
+
+    for (int numThreads : { 1, 2, 4, 8 }) {
+        TestScene scene(NUM_BOXES);
+        PhysicsEngine& engine = scene.getEngine();
+        engine.setNumSimulationThreads(numThreads);
+        // the stacks form before the timing starts
+        step(engine, NUM_SETTLING_STEPS);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        step(engine, NUM_STEPS);
+        std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+        qDebug() << engine.getNumSimulationThreads() << "threads:" << NUM_BOXES << "boxes, step"
+            << duration.count() / NUM_STEPS << "ms";
+        // the number is shared by all engines
+        engine.setNumSimulationThreads(1);
+    }
+}
@@ -0,0 +1,308 @@
+//
+//  ShapeCacheTests.cpp
+//  tests/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ShapeCacheTests.h"
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+#include <QtCore/QTemporaryDir>
+
+#include <ShapeCache.h>
+#include <ShapeFactory.h>
+
+QTEST_MAIN(ShapeCacheTests)
+
+namespace {
+
+const std::string SHAPE_CACHE_EXT = "shape";
+
+// a bumpy grid of numQuads x numQuads quads
+void makeMeshInfo(ShapeInfo& info, int numQuads) {
+    ShapeInfo::PointList points;
+    ShapeInfo::TriangleIndices& indices = info.getTriangleIndices();
+    for (int i = 0; i <= numQuads; ++i) {
+        for (int j = 0; j <= numQuads; ++j) {
+            points.push_back(glm::vec3((float)i, 0.5f * sinf((float)(i * j)), (float)j));
+        }
+    }
+    for (int i = 0; i < numQuads; ++i) {
+        for (int j = 0; j < numQuads; ++j) {
+            int32_t corner = i * (numQuads + 1) + j;
+            indices << corner << corner + 1 << corner + numQuads + 1;
+            indices << corner + 1 << corner + numQuads + 2 << corner + numQuads + 1;
+        }
+    }
+    info.setParams(SHAPE_TYPE_STATIC_MESH, glm::vec3(0.5f * (float)numQuads), "http://test/mesh.fbx");
+    info.setPointCollection(ShapeInfo::PointCollection({ points }));
+}
+
+void makeCompoundInfo(ShapeInfo& info, int numHulls) {
+    ShapeInfo::PointCollection pointCollection;
+    for (int i = 0; i < numHulls; ++i) {
+        ShapeInfo::PointList points;
+        float radius = (float)(i + 1);
+        glm::vec3 offset((float)i, 0.0f, 0.0f);
+        points << radius * glm::vec3(1.0f, 1.0f, 1.0f) + offset << radius * glm::vec3(1.0f, -1.0f, -1.0f) + offset
+            << radius * glm::vec3(-1.0f, 1.0f, -1.0f) + offset << radius * glm::vec3(-1.0f, -1.0f, 1.0f) + offset;
+        pointCollection.push_back(points);
+    }
+    info.setParams(SHAPE_TYPE_COMPOUND, glm::vec3((float)numHulls), "http://test/hulls.obj");
+    info.setPointCollection(pointCollection);
+    info.setOffset(glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+std::shared_ptr<ShapeCache> makeCache(const QTemporaryDir& dir) {
+    auto cache = std::make_shared<ShapeCache>(dir.path().toStdString(), SHAPE_CACHE_EXT);
+    cache->initialize();
+    return cache;
+}
+
+class TriangleCounter : public btTriangleCallback {
+public:
+    void processTriangle(btVector3* triangle, int partId, int triangleIndex) override { ++numTriangles; }
+    int numTriangles { 0 };
+};
+
+// the bvh of a static mesh, serialized as the ShapeCache does
+void* serializeBvh(const btCollisionShape* shape, uint32_t& size) {
+    const btOptimizedBvh* bvh = const_cast<btBvhTriangleMeshShape*>(
+        static_cast<const btBvhTriangleMeshShape*>(shape))->getOptimizedBvh();
+    size = bvh->calculateSerializeBufferSize();
+    const int BVH_BUFFER_ALIGNMENT = 16;
+    void* buffer = btAlignedAlloc(size, BVH_BUFFER_ALIGNMENT);
+    if (!bvh->serializeInPlace(buffer, size, false)) {
+        btAlignedFree(buffer);
+        return nullptr;
+    }
+    return buffer;
+}
+
+// the triangles a mesh finds through its bvh
+int countTrianglesInAabb(const btCollisionShape* shape, const btVector3& minimum, const btVector3& maximum) {
+    TriangleCounter counter;
+    static_cast<const btConcaveShape*>(shape)->processAllTriangles(&counter, minimum, maximum);
+    return counter.numTriangles;
+}
+
+}
+
+void ShapeCacheTests::testKeyCoversContent() {
+    ShapeInfo info;
+    makeCompoundInfo(info, 3);
+    std::string key = ShapeCache::getKey(info);
+
+    // the same url and dimensions with other geometry must not share the entry
+    ShapeInfo changedInfo;
+    makeCompoundInfo(changedInfo, 3);
+    changedInfo.getPointCollection()[1][2] += glm::vec3(0.0001f, 0.0f, 0.0f);
+    QCOMPARE(changedInfo.getHash(), info.getHash());
+    QVERIFY(ShapeCache::getKey(changedInfo) != key);
+
+    ShapeInfo sameInfo;
+    makeCompoundInfo(sameInfo, 3);
+    QCOMPARE(ShapeCache::getKey(sameInfo), key);
+}
+
+void ShapeCacheTests::testCompoundShape() {
+    QTemporaryDir dir;
+    auto cache = makeCache(dir);
+
+    const int NUM_HULLS = 5;
+    ShapeInfo info;
+    makeCompoundInfo(info, NUM_HULLS);
+    QVERIFY(cache->loadShape(info) == nullptr);
+    QCOMPARE(cache->getNumMisses(), (uint32_t)1);
+
+    const btCollisionShape* shape = ShapeFactory::createShapeFromInfo(info);
+    QVERIFY(cache->saveShape(info, shape));
+
+    const btCollisionShape* loadedShape = cache->loadShape(info);
+    QVERIFY(loadedShape != nullptr);
+    QCOMPARE(cache->getNumHits(), (uint32_t)1);
+    QCOMPARE(loadedShape->getShapeType(), (int)COMPOUND_SHAPE_PROXYTYPE);
+
+    const btCompoundShape* compound = static_cast<const btCompoundShape*>(shape);
+    const btCompoundShape* loadedCompound = static_cast<const btCompoundShape*>(loadedShape);
+    QCOMPARE(loadedCompound->getNumChildShapes(), NUM_HULLS);
+    for (int i = 0; i < NUM_HULLS; ++i) {
+        QCOMPARE(loadedCompound->getChildTransform(i).getOrigin(), compound->getChildTransform(i).getOrigin());
+        const btConvexHullShape* hull = static_cast<const btConvexHullShape*>(compound->getChildShape(i));
+        const btConvexHullShape* loadedHull = static_cast<const btConvexHullShape*>(loadedCompound->getChildShape(i));
+        QCOMPARE(loadedHull->getShapeType(), (int)CONVEX_HULL_SHAPE_PROXYTYPE);
+        QCOMPARE(loadedHull->getMargin(), hull->getMargin());
+        QCOMPARE(loadedHull->getNumPoints(), hull->getNumPoints());
+        for (int j = 0; j < hull->getNumPoints(); ++j) {
+            QCOMPARE(loadedHull->getUnscaledPoints()[j], hull->getUnscaledPoints()[j]);
+        }
+    }
+
+    ShapeFactory::deleteShape(shape);
+    ShapeFactory::deleteShape(loadedShape);
+}
+
+void ShapeCacheTests::testStaticMeshShape() {
+    QTemporaryDir dir;
+    const int NUM_QUADS = 20;
+    ShapeInfo info;
+    makeMeshInfo(info, NUM_QUADS);
+
+    const btCollisionShape* shape = ShapeFactory::createShapeFromInfo(info);
+    QVERIFY(shape != nullptr);
+    {
+        auto cache = makeCache(dir);
+        QVERIFY(cache->saveShape(info, shape));
+    }
+
+    // entries persist for the next session
+    auto cache = makeCache(dir);
+    const btCollisionShape* loadedShape = cache->loadShape(info);
+    QVERIFY(loadedShape != nullptr);
+    QCOMPARE(loadedShape->getShapeType(), (int)TRIANGLE_MESH_SHAPE_PROXYTYPE);
+
+    btVector3 minimum, maximum, loadedMinimum, loadedMaximum;
+    btTransform identity;
+    identity.setIdentity();
+    shape->getAabb(identity, minimum, maximum);
+    loadedShape->getAabb(identity, loadedMinimum, loadedMaximum);
+    QCOMPARE(loadedMinimum, minimum);
+    QCOMPARE(loadedMaximum, maximum);
+
+    // the loaded bvh finds the same triangles
+    QCOMPARE(countTrianglesInAabb(loadedShape, minimum, maximum), 2 * NUM_QUADS * NUM_QUADS);
+    btVector3 corner(2.5f, -1.0f, 2.5f);
+    btVector3 oppositeCorner(7.5f, 1.0f, 4.5f);
+    QCOMPARE(countTrianglesInAabb(loadedShape, corner, oppositeCorner), countTrianglesInAabb(shape, corner, oppositeCorner));
+
+    ShapeFactory::deleteShape(shape);
+    ShapeFactory::deleteShape(loadedShape);
+}
+
+void ShapeCacheTests::testInvalidEntry() {
+    QTemporaryDir dir;
+    auto cache = makeCache(dir);
+
+    ShapeInfo info;
+    makeMeshInfo(info, 4);
+    QByteArray garbage("not a shape");
+    cache->writeFile(garbage.constData(), cache::FileCache::Metadata(ShapeCache::getKey(info), garbage.size()));
+    QVERIFY(cache->loadShape(info) == nullptr);
+    QCOMPARE(cache->getNumMisses(), (uint32_t)1);
+
+    // a valid entry for other geometry is rejected too
+    const btCollisionShape* shape = ShapeFactory::createShapeFromInfo(info);
+    QVERIFY(cache->saveShape(info, shape));
+    QByteArray entry;
+    {
+        QFile file(QString::fromStdString(cache->getFile(ShapeCache::getKey(info))->getFilepath()));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        entry = file.readAll();
+    }
+    ShapeInfo otherInfo;
+    makeMeshInfo(otherInfo, 5);
+    cache->writeFile(entry.constData(), cache::FileCache::Metadata(ShapeCache::getKey(otherInfo), entry.size()));
+    QVERIFY(cache->loadShape(otherInfo) == nullptr);
+    QCOMPARE(cache->getNumMisses(), (uint32_t)2);
+
+    // and the rebuilt shape replaces the invalid entry
+    const btCollisionShape* loadedShape = cache->loadShape(info);
+    QVERIFY(loadedShape != nullptr);
+
+    ShapeFactory::deleteShape(shape);
+    ShapeFactory::deleteShape(loadedShape);
+}
+
+void ShapeCacheTests::testCorruptEntry() {
+    QTemporaryDir dir;
+    auto cache = makeCache(dir);
+
+    ShapeInfo info;
+    makeMeshInfo(info, 4);
+    const btCollisionShape* shape = ShapeFactory::createShapeFromInfo(info);
+    QVERIFY(cache->saveShape(info, shape));
+    QByteArray entry;
+    {
+        QFile file(QString::fromStdString(cache->getFile(ShapeCache::getKey(info))->getFilepath()));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        entry = file.readAll();
+    }
+
+    // a file cut short
+    QByteArray truncated = entry.left(entry.size() / 2);
+    cache->writeFile(truncated.constData(), cache::FileCache::Metadata(ShapeCache::getKey(info), truncated.size()), true);
+    QVERIFY(cache->loadShape(info) == nullptr);
+
+    // a changed byte in the middle of the bvh, which still has the right size and header
+    QByteArray damaged = entry;
+    damaged[damaged.size() / 2] = damaged[damaged.size() / 2] ^ 0x5a;
+    cache->writeFile(damaged.constData(), cache::FileCache::Metadata(ShapeCache::getKey(info), damaged.size()), true);
+    QVERIFY(cache->loadShape(info) == nullptr);
+    QCOMPARE(cache->getNumMisses(), (uint32_t)2);
+
+    cache->writeFile(entry.constData(), cache::FileCache::Metadata(ShapeCache::getKey(info), entry.size()), true);
+    const btCollisionShape* loadedShape = cache->loadShape(info);
+    QVERIFY(loadedShape != nullptr);
+
+    ShapeFactory::deleteShape(shape);
+    ShapeFactory::deleteShape(loadedShape);
+}
+
+void ShapeCacheTests::testInvalidBvh() {
+    ShapeInfo info;
+    makeMeshInfo(info, 8);
+    const btCollisionShape* shape = ShapeFactory::createShapeFromInfo(info);
+    QVERIFY(shape != nullptr);
+    uint32_t size = 0;
+
+    // a buffer shorter than its nodes
+    void* buffer = serializeBvh(shape, size);
+    QVERIFY(buffer != nullptr);
+    QVERIFY(ShapeFactory::createStaticMeshShape(info, buffer, size - 16) == nullptr);
+    btAlignedFree(buffer);
+
+    // the bvh of a larger mesh points at triangles the mesh doesn't have
+    ShapeInfo smallerInfo;
+    makeMeshInfo(smallerInfo, 4);
+    buffer = serializeBvh(shape, size);
+    QVERIFY(ShapeFactory::createStaticMeshShape(smallerInfo, buffer, size) == nullptr);
+    btAlignedFree(buffer);
+
+    // the shape owns the buffer of a valid bvh
+    buffer = serializeBvh(shape, size);
+    const btCollisionShape* loadedShape = ShapeFactory::createStaticMeshShape(info, buffer, size);
+    QVERIFY(loadedShape != nullptr);
+
+    ShapeFactory::deleteShape(shape);
+    ShapeFactory::deleteShape(loadedShape);
+}
+
+void ShapeCacheTests::benchmarkStaticMeshShape() {
+    QTemporaryDir dir;
+    auto cache = makeCache(dir);
+    const int NUM_QUADS = 300;
+    ShapeInfo info;
+    makeMeshInfo(info, NUM_QUADS);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    const btCollisionShape* shape = ShapeFactory::createShapeFromInfo(info);
+    std::chrono::duration<double, std::milli> buildDuration = std::chrono::high_resolution_clock::now() - start;
+    QVERIFY(cache->saveShape(info, shape));
+
+    start = std::chrono::high_resolution_clock::now();
+    const btCollisionShape* loadedShape = cache->loadShape(info);
+    std::chrono::duration<double, std::milli> loadDuration = std::chrono::high_resolution_clock::now() - start;
+    QVERIFY(loadedShape != nullptr);
+    qDebug() << 2 * NUM_QUADS * NUM_QUADS << "triangles: build" << buildDuration.count() << "ms, load"
+        << loadDuration.count() << "ms";
+
+    ShapeFactory::deleteShape(shape);
+    ShapeFactory::deleteShape(loadedShape);
+}
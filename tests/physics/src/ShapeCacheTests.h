@@ -0,0 +1,29 @@
+//
+//  ShapeCacheTests.h
+//  tests/physics/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ShapeCacheTests_h
+#define hifi_ShapeCacheTests_h
+
+#include <QtTest/QtTest>
+
+class ShapeCacheTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testKeyCoversContent();
+    void testCompoundShape();
+    void testStaticMeshShape();
+    void testInvalidEntry();
+    void testCorruptEntry();
+    void testInvalidBvh();
+    void benchmarkStaticMeshShape();
+};
+
+#endif // hifi_ShapeCacheTests_h
@@ -15,19 +15,10 @@
 
 #include <test-utils/QTestExtensions.h>
 
+#include <BlendshapePacking.h>
 #include <GLMHelpers.h>
 #include <glm/gtc/random.hpp>
 
-struct BlendshapeOffsetUnpacked {
-    glm::vec3 positionOffset;
-    glm::vec3 normalOffset;
-    glm::vec3 tangentOffset;
-};
-
-struct BlendshapeOffsetPacked {
-    glm::uvec4 packedPosNorTan;
-};
-
 QTEST_MAIN(BlendshapePackingTests)
 
 static void packBlendshapeOffsetTo_Pos_F32_3xSN10_Nor_3xSN10_Tan_3xSN10(glm::uvec4& packed, const BlendshapeOffsetUnpacked& unpacked) {
@@ -61,6 +52,8 @@ static void packBlendshapeOffsets_ref(BlendshapeOffsetUnpacked* unpacked, Blends
 //
 #include <CPUDetect.h>
 
+#include <test-utils/Benchmarks.h>
+
 void packBlendshapeOffsets_AVX2(float (*unpacked)[9], uint32_t (*packed)[4], int size);
 
 static void packBlendshapeOffsets(BlendshapeOffsetUnpacked* unpacked, BlendshapeOffsetPacked* packed, int size) {
@@ -146,3 +139,179 @@ void BlendshapePackingTests::testAVX2() {
         }
     }
 }
+
+// SoA copy of unpacked, nine streams of stride floats
+static std::vector<float> toSoA(const std::vector<BlendshapeOffsetUnpacked>& unpacked, int stride) {
+    std::vector<float> streams(9 * stride, 0.0f);
+    for (int i = 0; i < (int)unpacked.size(); ++i) {
+        const float* offset = &unpacked[i].positionOffset.x;
+        for (int s = 0; s < 9; ++s) {
+            streams[s * stride + i] = offset[s];
+        }
+    }
+    return streams;
+}
+
+void BlendshapePackingTests::testSoA() {
+
+    for (int numBlendshapeOffsets = 0; numBlendshapeOffsets < 300; ++numBlendshapeOffsets) {
+
+        std::vector<BlendshapeOffsetUnpacked> unpackedBlendshapeOffsets(numBlendshapeOffsets);
+        std::vector<BlendshapeOffsetUnpacked> accumulatedBlendshapeOffsets(numBlendshapeOffsets);
+        std::vector<BlendshapeOffsetPacked> packedBlendshapeOffsets1(numBlendshapeOffsets);
+        std::vector<BlendshapeOffsetPacked> packedBlendshapeOffsets2(numBlendshapeOffsets);
+
+        for (int i = 0; i < numBlendshapeOffsets; ++i) {
+            unpackedBlendshapeOffsets[i] = {
+                glm::linearRand(glm::vec3(-2.0f, -2.0f, -2.0f), glm::vec3(2.0f, 2.0f, 2.0f)),
+                glm::linearRand(glm::vec3(-2.0f, -2.0f, -2.0f), glm::vec3(2.0f, 2.0f, 2.0f)),
+                glm::linearRand(glm::vec3(-2.0f, -2.0f, -2.0f), glm::vec3(2.0f, 2.0f, 2.0f)),
+            };
+        }
+
+        // accumulate twice into zeroed offsets, with a stride that doesn't match the source
+        const float VERTEX_COEFFICIENT = 0.75f;
+        const float NORMAL_COEFFICIENT = 0.25f;
+        int stride = numBlendshapeOffsets + 5;
+        std::vector<float> src = toSoA(unpackedBlendshapeOffsets, numBlendshapeOffsets);
+        std::vector<float> dst(9 * stride, 0.0f);
+        for (int pass = 0; pass < 2; ++pass) {
+            accumulateBlendshapeOffsets(dst.data(), stride, src.data(), numBlendshapeOffsets,
+                                        VERTEX_COEFFICIENT, NORMAL_COEFFICIENT, numBlendshapeOffsets);
+        }
+        for (int i = 0; i < numBlendshapeOffsets; ++i) {
+            const auto& offset = unpackedBlendshapeOffsets[i];
+            accumulatedBlendshapeOffsets[i] = {
+                offset.positionOffset * (2.0f * VERTEX_COEFFICIENT),
+                offset.normalOffset * (2.0f * NORMAL_COEFFICIENT),
+                offset.tangentOffset * (2.0f * NORMAL_COEFFICIENT),
+            };
+            const float* expected = &accumulatedBlendshapeOffsets[i].positionOffset.x;
+            for (int s = 0; s < 9; ++s) {
+                QCOMPARE_WITH_ABS_ERROR(dst[s * stride + i], expected[s], 1.0e-5f);
+            }
+        }
+        // nothing past the end is touched
+        for (int s = 0; s < 9; ++s) {
+            for (int i = numBlendshapeOffsets; i < stride; ++i) {
+                QCOMPARE(dst[s * stride + i], 0.0f);
+            }
+        }
+
+        // pack
+        packBlendshapeOffsets_ref(accumulatedBlendshapeOffsets.data(), packedBlendshapeOffsets1.data(), numBlendshapeOffsets);
+        packBlendshapeOffsetsSoA(dst.data(), stride, packedBlendshapeOffsets2.data(), numBlendshapeOffsets);
+
+        for (int i = 0; i < numBlendshapeOffsets; ++i) {
+            auto ref = packedBlendshapeOffsets1.at(i);
+            auto tst = packedBlendshapeOffsets2.at(i);
+            comparePacked(ref, tst);
+        }
+    }
+}
+
+//
+// Synthetic stand-in for an avatar face: an ARKit style rig of 52 blendshapes on a 30k vertex head,
+// each blendshape moving a few thousand vertices around one region, with about a third of them active.
+//
+static const int FACE_NUM_VERTICES = 30000;
+static const int FACE_NUM_BLENDSHAPES = 52;
+static const int FACE_REGION_SIZE = 4000;
+
+struct FaceBlendshape {
+    // sparse AoS, as stored in HFMBlendshape
+    std::vector<int> indices;
+    std::vector<BlendshapeOffsetUnpacked> offsets;
+
+    // a single span of SoA offsets, as built by HFMBlendshape::buildSparseOffsets()
+    int spanStart { 0 };
+    int spanCount { 0 };
+    std::vector<float> streams;
+};
+
+static const std::vector<FaceBlendshape>& getFaceBlendshapes() {
+    static std::vector<FaceBlendshape> blendshapes;
+    if (blendshapes.empty()) {
+        blendshapes.resize(FACE_NUM_BLENDSHAPES);
+        for (int b = 0; b < FACE_NUM_BLENDSHAPES; ++b) {
+            auto& blendshape = blendshapes[b];
+            blendshape.spanStart = (b * 997) % (FACE_NUM_VERTICES - FACE_REGION_SIZE);
+            blendshape.spanCount = FACE_REGION_SIZE;
+            std::vector<BlendshapeOffsetUnpacked> dense(FACE_REGION_SIZE, { glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f) });
+            for (int i = 0; i < FACE_REGION_SIZE; ++i) {
+                if (((i * 7 + b) % 3) == 0) {
+                    continue;   // leave gaps
+                }
+                BlendshapeOffsetUnpacked offset = {
+                    glm::linearRand(glm::vec3(-0.01f), glm::vec3(0.01f)),
+                    glm::linearRand(glm::vec3(-1.0f), glm::vec3(1.0f)),
+                    glm::linearRand(glm::vec3(-1.0f), glm::vec3(1.0f)),
+                };
+                blendshape.indices.push_back(blendshape.spanStart + i);
+                blendshape.offsets.push_back(offset);
+                dense[i] = offset;
+            }
+            blendshape.streams = toSoA(dense, FACE_REGION_SIZE);
+        }
+    }
+    return blendshapes;
+}
+
+static std::vector<float> getFaceCoefficients() {
+    std::vector<float> coefficients(FACE_NUM_BLENDSHAPES, 0.0f);
+    for (int b = 0; b < FACE_NUM_BLENDSHAPES; b += 3) {
+        coefficients[b] = 0.5f;
+    }
+    return coefficients;
+}
+
+void BlendshapePackingTests::benchmarkBlendAoS() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    const auto& blendshapes = getFaceBlendshapes();
+    auto coefficients = getFaceCoefficients();
+    std::vector<BlendshapeOffsetUnpacked> unpacked(FACE_NUM_VERTICES);
+    std::vector<BlendshapeOffsetPacked> packed(FACE_NUM_VERTICES);
+
+    QBENCHMARK {
+        memset(unpacked.data(), 0, unpacked.size() * sizeof(BlendshapeOffsetUnpacked));
+        for (int b = 0; b < FACE_NUM_BLENDSHAPES; ++b) {
+            float vertexCoefficient = coefficients[b];
+            if (vertexCoefficient < 0.0001f) {
+                continue;
+            }
+            float normalCoefficient = vertexCoefficient * 0.01f;
+            const auto& blendshape = blendshapes[b];
+            for (size_t j = 0; j < blendshape.indices.size(); ++j) {
+                auto& offset = unpacked[blendshape.indices[j]];
+                offset.positionOffset += blendshape.offsets[j].positionOffset * vertexCoefficient;
+                offset.normalOffset += blendshape.offsets[j].normalOffset * normalCoefficient;
+                offset.tangentOffset += blendshape.offsets[j].tangentOffset * normalCoefficient;
+            }
+        }
+        packBlendshapeOffsets(unpacked.data(), packed.data(), FACE_NUM_VERTICES);
+    }
+}
+
+void BlendshapePackingTests::benchmarkBlendSoA() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    const auto& blendshapes = getFaceBlendshapes();
+    auto coefficients = getFaceCoefficients();
+    std::vector<float> unpacked(9 * FACE_NUM_VERTICES);
+    std::vector<BlendshapeOffsetPacked> packed(FACE_NUM_VERTICES);
+
+    QBENCHMARK {
+        memset(unpacked.data(), 0, unpacked.size() * sizeof(float));
+        for (int b = 0; b < FACE_NUM_BLENDSHAPES; ++b) {
+            float vertexCoefficient = coefficients[b];
+            if (vertexCoefficient < 0.0001f) {
+                continue;
+            }
+            const auto& blendshape = blendshapes[b];
+            accumulateBlendshapeOffsets(unpacked.data() + blendshape.spanStart, FACE_NUM_VERTICES, blendshape.streams.data(),
+                                        blendshape.spanCount, vertexCoefficient, vertexCoefficient * 0.01f, blendshape.spanCount);
+        }
+        packBlendshapeOffsetsSoA(unpacked.data(), FACE_NUM_VERTICES, packed.data(), FACE_NUM_VERTICES);
+    }
+}
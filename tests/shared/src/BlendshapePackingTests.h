@@ -18,6 +18,9 @@ class BlendshapePackingTests : public QObject {
     Q_OBJECT
 private slots:
     void testAVX2();
+    void testSoA();
+    void benchmarkBlendAoS();
+    void benchmarkBlendSoA();
 };
 
 #endif // hifi_BlendshapePackingTests_h
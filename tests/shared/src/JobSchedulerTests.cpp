@@ -0,0 +1,233 @@
+//
+//  JobSchedulerTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "JobSchedulerTests.h"
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtTest/QtTest>
+
+#include <JobScheduler.h>
+#include <NumericalConstants.h>
+
+QTEST_MAIN(JobSchedulerTests)
+
+using Category = JobScheduler::Category;
+using Priority = JobScheduler::Priority;
+
+class TestRunnable : public QRunnable {
+public:
+    TestRunnable(std::atomic<int>& numRuns, std::atomic<int>& numDeleted) : _numRuns(numRuns), _numDeleted(numDeleted) {}
+    ~TestRunnable() { _numDeleted++; }
+
+    void run() override {
+        _numRuns++;
+        // like QThreadPool, the scheduler decided who owns the runnable when it was submitted
+        setAutoDelete(!autoDelete());
+    }
+
+private:
+    std::atomic<int>& _numRuns;
+    std::atomic<int>& _numDeleted;
+};
+
+void JobSchedulerTests::testRunAll() {
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+    JobScheduler scheduler(&pool);
+
+    const int NUM_JOBS = 1000;
+    std::atomic<int> count { 0 };
+    for (int i = 0; i < NUM_JOBS; i++) {
+        scheduler.submit((Category)(i % JobScheduler::NUM_CATEGORIES), [&] { count++; });
+    }
+    QVERIFY(scheduler.waitForDone(10000));
+    QCOMPARE(count.load(), NUM_JOBS);
+
+    uint64_t completed = 0;
+    for (int c = 0; c < JobScheduler::NUM_CATEGORIES; c++) {
+        auto stats = scheduler.getStats((Category)c);
+        QCOMPARE(stats.queued, 0);
+        QCOMPARE(stats.running, 0);
+        completed += stats.completed;
+    }
+    QCOMPARE(completed, (uint64_t)NUM_JOBS);
+}
+
+void JobSchedulerTests::testPriorities() {
+    // a single thread, blocked until every job has been queued, so the run order is deterministic.
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    JobScheduler scheduler(&pool);
+
+    QSemaphore gate;
+    scheduler.submit(Category::General, [&] { gate.acquire(); });
+
+    std::mutex orderMutex;
+    std::vector<int> order;
+    auto record = [&](int value) {
+        return [&, value] {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order.push_back(value);
+        };
+    };
+    scheduler.submit(Category::Texture, record(2));
+    scheduler.submit(Category::Model, record(1));
+    scheduler.submit(Category::Blendshape, record(0));
+    scheduler.submit(Category::Texture, Priority::High, record(0));
+
+    gate.release();
+    QVERIFY(scheduler.waitForDone(10000));
+    QCOMPARE((int)order.size(), 4);
+    QVERIFY(std::is_sorted(order.begin(), order.end()));
+}
+
+void JobSchedulerTests::testConcurrencyLimit() {
+    QThreadPool pool;
+    pool.setMaxThreadCount(8);
+    JobScheduler scheduler(&pool);
+    scheduler.setConcurrencyLimit(Category::Texture, 2);
+
+    std::atomic<int> running { 0 };
+    std::atomic<int> maxRunning { 0 };
+    for (int i = 0; i < 50; i++) {
+        scheduler.submit(Category::Texture, [&] {
+            int now = ++running;
+            int prevMax = maxRunning;
+            while (now > prevMax && !maxRunning.compare_exchange_weak(prevMax, now)) {}
+            QThread::msleep(2);
+            running--;
+        });
+    }
+    QVERIFY(scheduler.waitForDone(10000));
+    QVERIFY(maxRunning <= 2);
+    QCOMPARE(scheduler.getStats(Category::Texture).completed, (uint64_t)50);
+}
+
+void JobSchedulerTests::testCancel() {
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    JobScheduler scheduler(&pool);
+
+    QSemaphore gate;
+    auto blocker = scheduler.submit(Category::General, [&] { gate.acquire(); });
+
+    std::atomic<int> count { 0 };
+    auto cancelled = scheduler.submit(Category::Texture, [&] { count++; });
+    auto kept = scheduler.submit(Category::Texture, [&] { count++; });
+    auto captured = std::make_shared<int>(0);
+    std::weak_ptr<int> weakCaptured = captured;
+    auto releasing = scheduler.submit(Category::Texture, [captured] { (*captured)++; });
+    captured.reset();
+    QVERIFY(cancelled->cancel());
+    QVERIFY(cancelled->isCancelled());
+
+    // what a cancelled job captured goes away on cancel, not when the job would have reached the front of the queue
+    QVERIFY(!weakCaptured.expired());
+    QVERIFY(releasing->cancel());
+    QVERIFY(weakCaptured.expired());
+
+    gate.release();
+    QVERIFY(scheduler.waitForDone(10000));
+    QCOMPARE(count.load(), 1);
+    QVERIFY(kept->isFinished());
+    QVERIFY(!blocker->cancel());
+    QCOMPARE(scheduler.getStats(Category::Texture).cancelled, (uint64_t)2);
+}
+
+void JobSchedulerTests::testLoadingPriority() {
+    // nearby models and avatars first, distant ones last
+    QVERIFY(JobScheduler::getLoadingPriority(Category::Model, PI) == Priority::High);
+    QVERIFY(JobScheduler::getLoadingPriority(Category::Model, atan2f(2.0f, 5.0f)) == Priority::High);
+    QVERIFY(JobScheduler::getLoadingPriority(Category::Model, atan2f(2.0f, 50.0f)) == Priority::Normal);
+    QVERIFY(JobScheduler::getLoadingPriority(Category::Model, atan2f(2.0f, 500.0f)) == Priority::Low);
+    QVERIFY(JobScheduler::getLoadingPriority(Category::Model, 0.0f) == Priority::Low);
+
+    // only models are ordered by distance
+    QVERIFY(JobScheduler::getLoadingPriority(Category::Texture, PI) == Priority::Low);
+    QVERIFY(JobScheduler::getLoadingPriority(Category::Blendshape, 0.0f) == Priority::High);
+}
+
+void JobSchedulerTests::testDependencies() {
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+    JobScheduler scheduler(&pool);
+
+    std::atomic<int> stage { 0 };
+    std::atomic<bool> ordered { true };
+    auto first = scheduler.submit(Category::Model, [&] {
+        QThread::msleep(20);
+        stage = 1;
+    });
+    auto second = scheduler.submit(Category::Texture, [&] {
+        if (stage != 1) {
+            ordered = false;
+        }
+        stage = 2;
+    }, { first });
+
+    // cancelling a job cancels everything that depends on it
+    QSemaphore gate;
+    auto blocked = scheduler.submit(Category::General, [&] { gate.acquire(); });
+    auto cancelledRoot = scheduler.submit(Category::General, [] {}, { blocked });
+    std::atomic<bool> cancelledRan { false };
+    auto cancelledChild = scheduler.submit(Category::General, [&] { cancelledRan = true; }, { cancelledRoot });
+    QVERIFY(cancelledRoot->cancel());
+    gate.release();
+
+    QVERIFY(scheduler.waitForDone(10000));
+    QVERIFY(ordered);
+    QCOMPARE(stage.load(), 2);
+    QVERIFY(second->isFinished());
+    QVERIFY(cancelledChild->isCancelled());
+    QVERIFY(!cancelledRan);
+}
+
+void JobSchedulerTests::testRunnables() {
+    QThreadPool pool;
+    pool.setMaxThreadCount(2);
+    JobScheduler scheduler(&pool);
+    std::atomic<int> numRuns { 0 };
+    std::atomic<int> numDeleted { 0 };
+
+    // auto deleted runnables belong to the scheduler
+    scheduler.submit(Category::General, new TestRunnable(numRuns, numDeleted));
+    QVERIFY(scheduler.waitForDone(10000));
+    QCOMPARE(numRuns.load(), 1);
+    QCOMPARE(numDeleted.load(), 1);
+
+    // the others to the caller, which can delete them as soon as they have run
+    TestRunnable* runnable = new TestRunnable(numRuns, numDeleted);
+    runnable->setAutoDelete(false);
+    auto job = scheduler.submit(Category::General, runnable);
+    QVERIFY(scheduler.waitForDone(10000));
+    QCOMPARE(numRuns.load(), 2);
+    QCOMPARE(numDeleted.load(), 1);
+    delete runnable;
+    job.reset();
+    QCOMPARE(numDeleted.load(), 2);
+
+    // cancelled auto deleted runnables are deleted without running
+    QSemaphore gate;
+    pool.setMaxThreadCount(1);
+    scheduler.submit(Category::General, [&] { gate.acquire(); });
+    scheduler.submit(Category::General, new TestRunnable(numRuns, numDeleted))->cancel();
+    gate.release();
+    QVERIFY(scheduler.waitForDone(10000));
+    QCOMPARE(numRuns.load(), 2);
+    QCOMPARE(numDeleted.load(), 3);
+}
@@ -0,0 +1,28 @@
+//
+//  JobSchedulerTests.h
+//  tests/shared/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_JobSchedulerTests_h
+#define hifi_JobSchedulerTests_h
+
+#include <QtCore/QObject>
+
+class JobSchedulerTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testRunAll();
+    void testPriorities();
+    void testConcurrencyLimit();
+    void testCancel();
+    void testDependencies();
+    void testRunnables();
+    void testLoadingPriority();
+};
+
+#endif // hifi_JobSchedulerTests_h
@@ -0,0 +1,238 @@
+//
+//  TimerWheelTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TimerWheelTests.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QtTest>
+
+#include <NumericalConstants.h>
+#include <TimerWheel.h>
+
+#include <test-utils/Benchmarks.h>
+
+QTEST_MAIN(TimerWheelTests)
+
+using Keys = std::vector<TimerWheel::Key>;
+
+static Keys advance(TimerWheel& wheel, int64_t nowMsecs) {
+    Keys dueKeys;
+    wheel.advance(nowMsecs, dueKeys);
+    return dueKeys;
+}
+
+void TimerWheelTests::testSingleShot() {
+    TimerWheel wheel(1000);
+    wheel.start(1, 10, true, 1000);
+    QCOMPARE(wheel.getNumTimers(), 1);
+    QCOMPARE(wheel.getNextExpiry(), (int64_t)1010);
+
+    QVERIFY(advance(wheel, 1009).empty());
+    QCOMPARE(advance(wheel, 1010), Keys({ 1 }));
+    QCOMPARE(wheel.getLastMaxLatenessMsecs(), (int64_t)0);
+    QCOMPARE(wheel.getNumTimers(), 0);
+    QCOMPARE(wheel.getNextExpiry(), (int64_t)-1);
+    QVERIFY(advance(wheel, 2000).empty());
+
+    // a late advance reports how late the timer fired
+    wheel.start(2, 5, true, 2000);
+    QCOMPARE(advance(wheel, 2012), Keys({ 2 }));
+    QCOMPARE(wheel.getLastMaxLatenessMsecs(), (int64_t)7);
+
+    // zero timeouts fire on the next millisecond
+    wheel.start(3, 0, true, 2012);
+    QVERIFY(advance(wheel, 2012).empty());
+    QCOMPARE(advance(wheel, 2013), Keys({ 3 }));
+}
+
+void TimerWheelTests::testInterval() {
+    TimerWheel wheel;
+    wheel.start(1, 100, false, 0);
+    for (int64_t i = 1; i <= 10; i++) {
+        QVERIFY(advance(wheel, 100 * i - 1).empty());
+        QCOMPARE(advance(wheel, 100 * i), Keys({ 1 }));
+    }
+    QCOMPARE(wheel.getNumTimers(), 1);
+
+    // a timer that is late by less than an interval keeps its phase, one late by more starts over from now
+    QCOMPARE(advance(wheel, 1150), Keys({ 1 }));
+    QCOMPARE(wheel.getNextExpiry(), (int64_t)1200);
+    QCOMPARE(advance(wheel, 1450), Keys({ 1 }));
+    QVERIFY(advance(wheel, 1549).empty());
+    QCOMPARE(advance(wheel, 1550), Keys({ 1 }));
+}
+
+void TimerWheelTests::testOrdering() {
+    TimerWheel wheel;
+    wheel.start(1, 30, true, 0);
+    wheel.start(2, 10, true, 0);
+    wheel.start(3, 20, true, 0);
+    wheel.start(4, 10, true, 0);
+    wheel.start(5, 5, false, 0);
+
+    // one batch, in the order of expiry, then of start
+    QCOMPARE(advance(wheel, 30), Keys({ 5, 2, 4, 3, 1 }));
+    QCOMPARE(wheel.getNumTimers(), 1);
+}
+
+void TimerWheelTests::testStop() {
+    TimerWheel wheel;
+    wheel.start(1, 10, true, 0);
+    wheel.start(2, 10, false, 0);
+    QVERIFY(wheel.isActive(1));
+    QVERIFY(wheel.stop(1));
+    QVERIFY(!wheel.isActive(1));
+    QVERIFY(!wheel.stop(1));
+    QCOMPARE(advance(wheel, 10), Keys({ 2 }));
+
+    // restarting a timer replaces it
+    wheel.start(2, 50, true, 10);
+    QVERIFY(advance(wheel, 20).empty());
+    QCOMPARE(advance(wheel, 60), Keys({ 2 }));
+
+    wheel.start(3, 10, true, 60);
+    wheel.clear();
+    QCOMPARE(wheel.getNumTimers(), 0);
+    QVERIFY(advance(wheel, 100).empty());
+}
+
+void TimerWheelTests::testLongTimers() {
+    // timers on every level of the wheel, and beyond it, fire on time when the wheel is only advanced to its next expiry
+    const int64_t START = 123;
+    const int64_t intervals[] = { 1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 300000, 16777215, 16777216, 40000000 };
+    TimerWheel wheel(START);
+    std::map<TimerWheel::Key, int64_t> expiries;
+    TimerWheel::Key key = 0;
+    for (int64_t interval : intervals) {
+        wheel.start(key, interval, true, START);
+        expiries[key++] = START + interval;
+    }
+
+    int numWakeUps = 0;
+    while (wheel.getNumTimers() > 0) {
+        int64_t nextExpiry = wheel.getNextExpiry();
+        QVERIFY(nextExpiry > 0);
+        for (auto dueKey : advance(wheel, nextExpiry)) {
+            QCOMPARE(nextExpiry, expiries[dueKey]);
+            expiries.erase(dueKey);
+        }
+        numWakeUps++;
+    }
+    QVERIFY(expiries.empty());
+    // the higher levels cascade a few times on the way down
+    QVERIFY(numWakeUps < 10 * (int)(sizeof(intervals) / sizeof(intervals[0])));
+}
+
+void TimerWheelTests::testRandomSchedule() {
+    // compare the wheel to a plain list of timers
+    class Timer {
+    public:
+        int64_t expiry;
+        int64_t earliest;
+        int64_t interval;
+        uint64_t sequence;
+        bool isSingleShot;
+    };
+    std::map<TimerWheel::Key, Timer> timers;
+    uint64_t sequence = 0;
+
+    std::mt19937 random(7);
+    int64_t now = 1000;
+    TimerWheel wheel(now);
+    TimerWheel::Key nextKey = 0;
+    for (int step = 0; step < 5000; step++) {
+        int operation = random() % 10;
+        if (operation < 3) {
+            const int64_t MAX_INTERVALS[] = { 5, 200, 10000, 20000000 };
+            int64_t interval = random() % MAX_INTERVALS[random() % 4];
+            bool isSingleShot = random() % 2;
+            wheel.start(nextKey, interval, isSingleShot, now);
+            timers[nextKey++] = { now + interval, now + 1, interval, sequence++, isSingleShot };
+        } else if (operation < 4 && !timers.empty()) {
+            auto itr = timers.begin();
+            std::advance(itr, random() % timers.size());
+            QVERIFY(wheel.stop(itr->first));
+            timers.erase(itr);
+        } else {
+            int64_t nextExpiry = wheel.getNextExpiry();
+            int64_t to = (random() % 3 == 0 && nextExpiry > now) ? nextExpiry : now + random() % 50;
+
+            std::vector<std::pair<std::pair<int64_t, uint64_t>, TimerWheel::Key>> expected;
+            for (const auto& timer : timers) {
+                if (std::max(timer.second.expiry, timer.second.earliest) <= to) {
+                    expected.push_back({ { timer.second.expiry, timer.second.sequence }, timer.first });
+                }
+                // the wheel never wakes up later than the first expiry
+                QVERIFY(nextExpiry <= std::max(timer.second.expiry, timer.second.earliest));
+            }
+            std::sort(expected.begin(), expected.end());
+
+            Keys dueKeys = advance(wheel, to);
+            QCOMPARE(dueKeys.size(), expected.size());
+            for (size_t i = 0; i < dueKeys.size(); i++) {
+                QCOMPARE(dueKeys[i], expected[i].second);
+                Timer& timer = timers[dueKeys[i]];
+                if (timer.isSingleShot) {
+                    timers.erase(dueKeys[i]);
+                } else {
+                    timer.expiry += timer.interval;
+                    if (timer.expiry <= to) {
+                        timer.expiry = to + timer.interval;
+                    }
+                    timer.earliest = to + 1;
+                    timer.sequence = sequence++;
+                }
+            }
+            now = to;
+        }
+        QCOMPARE(wheel.getNumTimers(), (int)timers.size());
+    }
+}
+
+void TimerWheelTests::benchmarkTimers() {
+    QSKIP_UNLESS_BENCHMARKING();
+
+    // the timers of a busy entity script server: many intervals, and timeouts started and stopped all the time
+    const int NUM_INTERVALS = 10000;
+    const int NUM_MSECS = 10000;
+    std::mt19937 random(11);
+    TimerWheel wheel;
+    for (int i = 0; i < NUM_INTERVALS; i++) {
+        wheel.start(i, 16 + random() % 1000, false, 0);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    Keys dueKeys;
+    uint64_t numFired = 0;
+    TimerWheel::Key nextKey = NUM_INTERVALS;
+    for (int64_t now = 1; now <= NUM_MSECS; now++) {
+        dueKeys.clear();
+        wheel.advance(now, dueKeys);
+        numFired += dueKeys.size();
+        for (auto key : dueKeys) {
+            if (key >= (TimerWheel::Key)NUM_INTERVALS) {
+                continue;
+            }
+            // every interval starts a timeout, and stops the one before
+            if (nextKey > (TimerWheel::Key)NUM_INTERVALS) {
+                wheel.stop(nextKey - 1);
+            }
+            wheel.start(nextKey++, random() % 5000, true, now);
+        }
+    }
+    qint64 nsecs = timer.nsecsElapsed();
+    qDebug() << "fired" << numFired << "timers in" << nsecs / NSECS_PER_MSEC << "msecs,"
+        << (double)nsecs / (numFired + nextKey) << "nsecs per timer";
+}
@@ -0,0 +1,28 @@
+//
+//  TimerWheelTests.h
+//  tests/shared/src
+//
+//  Copyright 2021 Vircadia contributors.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TimerWheelTests_h
+#define hifi_TimerWheelTests_h
+
+#include <QtCore/QObject>
+
+class TimerWheelTests : public QObject {
+    Q_OBJECT
+private slots:
+    void testSingleShot();
+    void testInterval();
+    void testOrdering();
+    void testStop();
+    void testLongTimers();
+    void testRandomSchedule();
+    void benchmarkTimers();
+};
+
+#endif // hifi_TimerWheelTests_h
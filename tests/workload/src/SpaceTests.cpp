@@ -22,85 +22,102 @@ const float INV_SQRT_3 = 1.0f / sqrtf(3.0f);
 
 QTEST_MAIN(SpaceTests)
 
+static workload::View makeView(const glm::vec3& center, float near, float mid, float far) {
+    workload::View view;
+    view.origin = center;
+    view.regions[workload::Region::R1] = workload::Sphere(center, near);
+    view.regions[workload::Region::R2] = workload::Sphere(center, mid);
+    view.regions[workload::Region::R3] = workload::Sphere(center, far);
+    return view;
+}
+
+static void moveProxy(workload::Space& space, int32_t proxyId, const workload::Sphere& sphere) {
+    workload::Transaction transaction;
+    transaction.update(proxyId, sphere);
+    space.enqueueTransaction(transaction);
+    space.enqueueFrame();
+    space.processTransactionQueue();
+}
+
 void SpaceTests::testOverlaps() {
     workload::Space space;
     using Changes = std::vector<workload::Space::Change>;
-    using Views = std::vector<workload::Space::View>;
 
     glm::vec3 viewCenter(0.0f, 0.0f, 0.0f);
     float near = 1.0f;
     float mid = 2.0f;
     float far = 3.0f;
 
-    Views views;
-    views.push_back(workload::Space::View(viewCenter, near, mid, far));
+    workload::Views views;
+    views.push_back(makeView(viewCenter, near, mid, far));
     space.setViews(views);
 
     int32_t proxyId = 0;
     const float DELTA = 0.001f;
     float proxyRadius = 0.5f;
     glm::vec3 proxyPosition = viewCenter + glm::vec3(0.0f, 0.0f, far + proxyRadius + DELTA);
-    workload::Space::Sphere proxySphere(proxyPosition, proxyRadius);
+    workload::Sphere proxySphere(proxyPosition, proxyRadius);
 
     { // create very_far proxy
-        proxyId = space.createProxy(proxySphere);
+        proxyId = space.allocateID();
+        workload::Transaction transaction;
+        transaction.reset(proxyId, proxySphere, workload::Owner());
+        space.enqueueTransaction(transaction);
+        space.enqueueFrame();
+        space.processTransactionQueue();
         QVERIFY(space.getNumObjects() == 1);
 
         Changes changes;
         space.categorizeAndGetChanges(changes);
-        QVERIFY(changes.size() == 0);
+        QVERIFY(changes.size() == 1);
+        QVERIFY(changes[0].proxyId == proxyId);
+        QVERIFY(changes[0].region == workload::Region::R4);
+        QVERIFY(changes[0].prevRegion == workload::Region::UNKNOWN);
     }
 
     { // move proxy far
         float newRadius = 1.0f;
         glm::vec3 newPosition = viewCenter + glm::vec3(0.0f, 0.0f, far + newRadius - DELTA);
-        workload::Space::Sphere newSphere(newPosition, newRadius);
-        std::vector<workload::Space::ProxyUpdate> updates;
-        updates.push_back(workload::Space::ProxyUpdate(proxyId, newSphere));
-        space.updateProxies(updates);
+        moveProxy(space, proxyId, workload::Sphere(newPosition, newRadius));
         Changes changes;
         space.categorizeAndGetChanges(changes);
         QVERIFY(changes.size() == 1);
         QVERIFY(changes[0].proxyId == proxyId);
-        QVERIFY(changes[0].region == workload::Space::REGION_FAR);
-        QVERIFY(changes[0].prevRegion == workload::Space::REGION_UNKNOWN);
+        QVERIFY(changes[0].region == workload::Region::R3);
+        QVERIFY(changes[0].prevRegion == workload::Region::R4);
     }
 
     { // move proxy mid
         float newRadius = 1.0f;
         glm::vec3 newPosition = viewCenter + glm::vec3(0.0f, 0.0f, mid + newRadius - DELTA);
-        workload::Space::Sphere newSphere(newPosition, newRadius);
-        std::vector<workload::Space::ProxyUpdate> updates;
-        updates.push_back(workload::Space::ProxyUpdate(proxyId, newSphere));
-        space.updateProxies(updates);
+        moveProxy(space, proxyId, workload::Sphere(newPosition, newRadius));
         Changes changes;
         space.categorizeAndGetChanges(changes);
         QVERIFY(changes.size() == 1);
         QVERIFY(changes[0].proxyId == proxyId);
-        QVERIFY(changes[0].region == workload::Space::REGION_MIDDLE);
-        QVERIFY(changes[0].prevRegion == workload::Space::REGION_FAR);
+        QVERIFY(changes[0].region == workload::Region::R2);
+        QVERIFY(changes[0].prevRegion == workload::Region::R3);
     }
 
     { // move proxy near
         float newRadius = 1.0f;
         glm::vec3 newPosition = viewCenter + glm::vec3(0.0f, 0.0f, near + newRadius - DELTA);
-        workload::Space::Sphere newSphere(newPosition, newRadius);
-        std::vector<workload::Space::ProxyUpdate> updates;
-        updates.push_back(workload::Space::ProxyUpdate(proxyId, newSphere));
-        space.updateProxies(updates);
+        moveProxy(space, proxyId, workload::Sphere(newPosition, newRadius));
         Changes changes;
         space.categorizeAndGetChanges(changes);
         QVERIFY(changes.size() == 1);
         QVERIFY(changes[0].proxyId == proxyId);
-        QVERIFY(changes[0].region == workload::Space::REGION_NEAR);
-        QVERIFY(changes[0].prevRegion == workload::Space::REGION_MIDDLE);
+        QVERIFY(changes[0].region == workload::Region::R1);
+        QVERIFY(changes[0].prevRegion == workload::Region::R2);
     }
 
     { // delete proxy
         // NOTE: atm deleting a proxy doesn't result in a "Change"
-        std::vector<int32_t> deadProxies;
-        deadProxies.push_back(proxyId);
-        space.deleteProxies(deadProxies);
+        workload::Transaction transaction;
+        transaction.remove(proxyId);
+        space.enqueueTransaction(transaction);
+        space.enqueueFrame();
+        space.processTransactionQueue();
         Changes changes;
         space.categorizeAndGetChanges(changes);
         QVERIFY(changes.size() == 0);
@@ -108,173 +125,156 @@ void SpaceTests::testOverlaps() {
     }
 }
 
-#ifdef MANUAL_TEST
-
-const float WORLD_WIDTH = 1000.0f;
-const float MIN_RADIUS = 1.0f;
-const float MAX_RADIUS = 100.0f;
-
-float randomFloat() {
+static float randomUnitFloat() {
     return 2.0f * ((float)rand() / (float)RAND_MAX) - 1.0f;
 }
 
-glm::vec3 randomVec3() {
-    glm::vec3 v(randomFloat(), randomFloat(), randomFloat());
-    return v;
-}
-
-void generateSpheres(uint32_t numProxies, std::vector<workload::Space::Sphere>& spheres) {
-    spheres.reserve(numProxies);
-    for (uint32_t i = 0; i < numProxies; ++i) {
-        workload::Space::Sphere sphere(
-                WORLD_WIDTH * randomFloat(),
-                WORLD_WIDTH * randomFloat(),
-                WORLD_WIDTH * randomFloat(),
-                (MIN_RADIUS + (MAX_RADIUS - MIN_RADIUS)) * randomFloat());
-        spheres.push_back(sphere);
-    }
-}
-
-void generatePositions(uint32_t numProxies, std::vector<glm::vec3>& positions) {
-    positions.reserve(numProxies);
-    for (uint32_t i = 0; i < numProxies; ++i) {
-        positions.push_back(WORLD_WIDTH * randomVec3());
+void SpaceTests::testGrid() {
+    // the same proxies and views in a Space with and without the grid must end up in the same regions, with the same
+    // changes, frame after frame
+    const int32_t NUM_PROXIES = 5000;
+    const float WIDTH = 200.0f;
+    const float MAX_RADIUS = 5.0f;
+    const int32_t NUM_FRAMES = 10;
+
+    workload::Space gridSpace;
+    workload::Space plainSpace;
+    gridSpace.setGridCellSize(8.0f);
+    plainSpace.setGridCellSize(0.0f);
+    QCOMPARE(gridSpace.getGridCellSize(), 8.0f);
+    QCOMPARE(plainSpace.getGridCellSize(), 0.0f);
+
+    srand(0);
+    std::vector<workload::Sphere> spheres;
+    workload::Transaction transaction;
+    for (int32_t i = 0; i < NUM_PROXIES; ++i) {
+        glm::vec3 position = WIDTH * glm::vec3(randomUnitFloat(), randomUnitFloat(), randomUnitFloat());
+        spheres.push_back(workload::Sphere(position, MAX_RADIUS * 0.5f * (randomUnitFloat() + 1.0f)));
+        int32_t gridID = gridSpace.allocateID();
+        int32_t plainID = plainSpace.allocateID();
+        QCOMPARE(gridID, plainID);
+        transaction.reset(gridID, spheres.back(), workload::Owner());
     }
-}
-
-void generateRadiuses(uint32_t numRadiuses, std::vector<float>& radiuses) {
-    radiuses.reserve(numRadiuses);
-    for (uint32_t i = 0; i < numRadiuses; ++i) {
-        radiuses.push_back(MIN_RADIUS + (MAX_RADIUS - MIN_RADIUS) * randomFloat());
-    }
-}
-
-void SpaceTests::benchmark() {
-    uint32_t numProxies[] = { 100, 1000, 10000, 100000 };
-    uint32_t numTests = 4;
-    std::vector<uint64_t> timeToAddAll;
-    std::vector<uint64_t> timeToMoveView;
-    std::vector<uint64_t> timeToMoveProxies;
-    std::vector<uint64_t> timeToRemoveAll;
-    for (uint32_t i = 0; i < numTests; ++i) {
-
-        workload::Space space;
-
-        { // build the views
-            std::vector<glm::vec3> viewPositions;
-            viewPositions.push_back(glm::vec3(0.0f, 0.0f, 0.0f));
-            viewPositions.push_back(glm::vec3(0.0f, 0.0f, 0.1f * WORLD_WIDTH));
-            float radius0 = 0.25f * WORLD_WIDTH;
-            float radius1 = 0.50f * WORLD_WIDTH;
-            float radius2 = 0.75f * WORLD_WIDTH;
-            std::vector<workload::Space::View> views;
-            views.push_back(workload::Space::View(viewPositions[0], radius0, radius1, radius2));
-            views.push_back(workload::Space::View(viewPositions[1], radius0, radius1, radius2));
-            space.setViews(views);
+    gridSpace.enqueueTransaction(transaction);
+    plainSpace.enqueueTransaction(transaction);
+
+    for (int32_t frame = 0; frame < NUM_FRAMES; ++frame) {
+        // move the views and a tenth of the proxies, some of them out of their cells
+        glm::vec3 viewCenter = 0.1f * (float)frame * WIDTH * glm::vec3(1.0f, 0.5f, 0.0f);
+        workload::Views views;
+        views.push_back(makeView(viewCenter, 20.0f, 50.0f, 100.0f));
+        views.push_back(makeView(-viewCenter, 10.0f, 30.0f, 60.0f));
+        gridSpace.setViews(views);
+        plainSpace.setViews(views);
+
+        if (frame > 0) {
+            workload::Transaction updates;
+            for (int32_t i = frame; i < NUM_PROXIES; i += 10) {
+                glm::vec3 offset = 2.0f * glm::vec3(randomUnitFloat(), randomUnitFloat(), randomUnitFloat());
+                spheres[i] = workload::Sphere(glm::vec3(spheres[i]) + offset, spheres[i].w);
+                updates.update(i, spheres[i]);
+            }
+            gridSpace.enqueueTransaction(updates);
+            plainSpace.enqueueTransaction(updates);
         }
-
-        // build the proxies
-        uint32_t n = numProxies[i];
-        std::vector<workload::Space::Sphere> proxySpheres;
-        generateSpheres(n, proxySpheres);
-        std::vector<int32_t> proxyKeys;
-        proxyKeys.reserve(n);
-
-        // measure time to put proxies in the space
-        uint64_t startTime = usecTimestampNow();
-        for (uint32_t j = 0; j < n; ++j) {
-            int32_t key = space.createProxy(proxySpheres[j]);
-            proxyKeys.push_back(key);
-        }
-        uint64_t usec = usecTimestampNow() - startTime;
-        timeToAddAll.push_back(usec);
-
-        {
-            // build the views
-            std::vector<glm::vec3> viewPositions;
-            viewPositions.push_back(glm::vec3(1.0f, 2.0f, 3.0f));
-            viewPositions.push_back(glm::vec3(1.0f, 2.0f, 3.0f + 0.1f * WORLD_WIDTH));
-            float radius0 = 0.25f * WORLD_WIDTH;
-            float radius1 = 0.50f * WORLD_WIDTH;
-            float radius2 = 0.75f * WORLD_WIDTH;
-            std::vector<workload::Space::View> views;
-            views.push_back(workload::Space::View(viewPositions[0], radius0, radius1, radius2));
-            views.push_back(workload::Space::View(viewPositions[1], radius0, radius1, radius2));
-            space.setViews(views);
+        gridSpace.enqueueFrame();
+        gridSpace.processTransactionQueue();
+        plainSpace.enqueueFrame();
+        plainSpace.processTransactionQueue();
+
+        workload::Changes gridChanges;
+        workload::Changes plainChanges;
+        gridSpace.categorizeAndGetChanges(gridChanges);
+        plainSpace.categorizeAndGetChanges(plainChanges);
+
+        QCOMPARE(gridChanges.size(), plainChanges.size());
+        for (size_t i = 0; i < gridChanges.size(); ++i) {
+            QCOMPARE(gridChanges[i].proxyId, plainChanges[i].proxyId);
+            QCOMPARE(gridChanges[i].region, plainChanges[i].region);
+            QCOMPARE(gridChanges[i].prevRegion, plainChanges[i].prevRegion);
         }
-
-        // measure time to categorizeAndGetChanges everything
-        std::vector<workload::Space::Change> changes;
-        startTime = usecTimestampNow();
-        space.categorizeAndGetChanges(changes);
-        usec = usecTimestampNow() - startTime;
-        timeToMoveView.push_back(usec);
-
-        // move every 10th proxy around
-        const float proxySpeed = 1.0f;
-        std::vector<workload::Space::Sphere> newSpheres;
-        uint32_t numMovingProxies = n / 10;
-        uint32_t jstep = n / numMovingProxies;
-        uint32_t maxJ = numMovingProxies * jstep - 1;
-        glm::vec3 direction;
-        for (uint32_t j = 0; j < maxJ - jstep; j += jstep) {
-            glm::vec3 position = (glm::vec3)proxySpheres[j];
-            glm::vec3 destination = (glm::vec3)proxySpheres[j + jstep];
-            direction = glm::normalize(destination - position);
-            glm::vec3 newPosition = position + proxySpeed * direction;
-            newSpheres.push_back(workload::Space::Sphere(newPosition, proxySpheres[j].w));
-        }
-        glm::vec3 position = (glm::vec3)proxySpheres[maxJ = jstep];
-        glm::vec3 destination = (glm::vec3)proxySpheres[0];
-        direction = glm::normalize(destination - position);
-        direction = position + proxySpeed * direction;
-        newSpheres.push_back(workload::Space::Sphere(direction, proxySpheres[0].w));
-        uint32_t k = 0;
-        startTime = usecTimestampNow();
-        for (uint32_t j = 0; j < maxJ; j += jstep) {
-            space.updateProxy(proxyKeys[j], newSpheres[k++]);
-        }
-        changes.clear();
-        space.categorizeAndGetChanges(changes);
-        usec = usecTimestampNow() - startTime;
-        timeToMoveProxies.push_back(usec);
-
-        // measure time to remove proxies from space
-        startTime = usecTimestampNow();
-        for (uint32_t j = 0; j < n; ++j) {
-            space.deleteProxy(proxyKeys[j]);
+        for (int32_t i = 0; i < NUM_PROXIES; ++i) {
+            QCOMPARE(gridSpace.getRegion(i), plainSpace.getRegion(i));
         }
-        usec = usecTimestampNow() - startTime;
-        timeToRemoveAll.push_back(usec);
     }
 
-    std::cout << "[numProxies, timeToAddAll] = [" << std::endl;
-    for (uint32_t i = 0; i < timeToAddAll.size(); ++i) {
-        uint32_t n = numProxies[i];
-        std::cout << "    " << n << ", " << timeToAddAll[i] << std::endl;
-    }
-    std::cout << "];" << std::endl;
+    // turning the grid off and on again keeps the regions
+    gridSpace.setGridCellSize(0.0f);
+    gridSpace.setGridCellSize(32.0f);
+    workload::Changes changes;
+    gridSpace.categorizeAndGetChanges(changes);
+    QVERIFY(changes.empty());
+}
 
-    std::cout << "[numProxies, timeToMoveView] = [" << std::endl;
-    for (uint32_t i = 0; i < timeToMoveView.size(); ++i) {
-        uint32_t n = numProxies[i];
-        std::cout << "    " << n << ", " << timeToMoveView[i] << std::endl;
-    }
-    std::cout << "];" << std::endl;
+#ifdef MANUAL_TEST
 
-    std::cout << "[numProxies, timeToMoveProxies] = [" << std::endl;
-    for (uint32_t i = 0; i < timeToMoveProxies.size(); ++i) {
-        uint32_t n = numProxies[i];
-        std::cout << "    " << n << "/10, " << timeToMoveProxies[i] << std::endl;
-    }
-    std::cout << "];" << std::endl;
+const float WORLD_WIDTH = 1000.0f;
+const float MIN_RADIUS = 1.0f;
+const float MAX_RADIUS = 10.0f;
 
-    std::cout << "[numProxies, timeToRemoveAll] = [" << std::endl;
-    for (uint32_t i = 0; i < timeToRemoveAll.size(); ++i) {
-        uint32_t n = numProxies[i];
-        std::cout << "    " << n << ", " << timeToRemoveAll[i] << std::endl;
+void SpaceTests::benchmark() {
+    uint32_t numProxies[] = { 100, 1000, 10000, 100000 };
+    float cellSizes[] = { 0.0f, workload::Space::DEFAULT_GRID_CELL_SIZE };
+    const int32_t NUM_FRAMES = 100;
+
+    for (float cellSize : cellSizes) {
+        std::cout << "cellSize = " << cellSize << std::endl;
+        std::cout << "[numProxies, timeToAddAll, timeToMoveView, timeToMoveProxies] = [" << std::endl;
+        for (uint32_t n : numProxies) {
+            srand(0);
+            workload::Space space;
+            space.setGridCellSize(cellSize);
+
+            std::vector<workload::Sphere> spheres;
+            workload::Transaction transaction;
+            for (uint32_t j = 0; j < n; ++j) {
+                glm::vec3 position = WORLD_WIDTH * glm::vec3(randomUnitFloat(), randomUnitFloat(), randomUnitFloat());
+                float radius = MIN_RADIUS + (MAX_RADIUS - MIN_RADIUS) * 0.5f * (randomUnitFloat() + 1.0f);
+                spheres.push_back(workload::Sphere(position, radius));
+                transaction.reset(space.allocateID(), spheres.back(), workload::Owner());
+            }
+
+            // measure time to put proxies in the space
+            uint64_t startTime = usecTimestampNow();
+            space.enqueueTransaction(transaction);
+            space.enqueueFrame();
+            space.processTransactionQueue();
+            uint64_t timeToAddAll = usecTimestampNow() - startTime;
+
+            // measure time to categorize everything while the views move
+            workload::Changes changes;
+            startTime = usecTimestampNow();
+            for (int32_t frame = 0; frame < NUM_FRAMES; ++frame) {
+                glm::vec3 viewCenter = (float)frame * glm::vec3(1.0f, 0.0f, 0.5f);
+                workload::Views views;
+                views.push_back(makeView(viewCenter, 0.05f * WORLD_WIDTH, 0.1f * WORLD_WIDTH, 0.2f * WORLD_WIDTH));
+                views.push_back(makeView(-viewCenter, 0.05f * WORLD_WIDTH, 0.1f * WORLD_WIDTH, 0.2f * WORLD_WIDTH));
+                space.setViews(views);
+                changes.clear();
+                space.categorizeAndGetChanges(changes);
+            }
+            uint64_t timeToMoveView = (usecTimestampNow() - startTime) / NUM_FRAMES;
+
+            // measure time to move every 10th proxy and categorize everything
+            startTime = usecTimestampNow();
+            for (int32_t frame = 0; frame < NUM_FRAMES; ++frame) {
+                workload::Transaction updates;
+                for (uint32_t j = frame % 10; j < n; j += 10) {
+                    spheres[j] += glm::vec4(randomUnitFloat(), randomUnitFloat(), randomUnitFloat(), 0.0f);
+                    updates.update((int32_t)j, spheres[j]);
+                }
+                space.enqueueTransaction(updates);
+                space.enqueueFrame();
+                space.processTransactionQueue();
+                changes.clear();
+                space.categorizeAndGetChanges(changes);
+            }
+            uint64_t timeToMoveProxies = (usecTimestampNow() - startTime) / NUM_FRAMES;
+
+            std::cout << "    " << n << ", " << timeToAddAll << ", " << timeToMoveView << ", " << timeToMoveProxies << std::endl;
+        }
+        std::cout << "];" << std::endl;
     }
-    std::cout << "];" << std::endl;
 }
 
 #endif // MANUAL_TEST